@@ -0,0 +1,490 @@
+// **********************************************************************
+// bench_sequelizer.c - Throughput Benchmarks on Reproducible Workloads
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Times the hot paths of seqgen and the Fast5 readers on fixed-seed inputs
+// and the bundled k-mer models, and writes one JSON report:
+//   model_load            seqgen_kmer_context_create (both bundled models)
+//   kmer_encode           encode_bases_to_integers, 9-mers of 1 Mb
+//   squiggle_kmer         [n_kmers × 3] squiggle of the same 1 Mb
+//   squiggle_to_raw       raw samples from that squiggle
+//   text_write            "index\tvalue" lines through seq_output
+//   fast5_write           multi-read Fast5 of generated reads
+//   fast5_metadata_scan   read_fast5_metadata_with_enhancer on that file
+//   fast5_signal_read     fast5_reader_next() loading every signal
+// Each benchmark repeats its body until min_time has passed and reports
+// rates (samples/s, MB/s, reads/s, null where they do not apply),
+// allocations per iteration and peak RSS.
+//
+// cmake --build . --target bench        (runs from the source tree, writes bench.json)
+// ./bench_sequelizer -o out.json -t 2   (longer runs; -q for a quick smoke run)
+//
+// Allocation counts come from wrapping malloc() and friends at link time
+// (-Wl,--wrap, GNU linkers only); they cover Sequelizer's own allocations,
+// not those made inside HDF5. Without the wrappers they are reported as null.
+
+#include "../src/core/seqgen_models.h"
+#include "../src/core/seqgen_utils.h"
+#include "../src/core/seq_utils.h"
+#include "../src/core/seq_output.h"
+#include "../src/core/seq_rng.h"
+#include "../src/core/fast5_io.h"
+#include <err.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_SEED 20260914
+#define BENCH_DNA_MODEL "dna_r10.4.1_e8.2_400bps"
+#define BENCH_RNA_MODEL "rna_r9.4_180mv_70bps"
+#define BENCH_SAMPLE_RATE_KHZ 4.0f
+
+// **********************************************************************
+// Allocation Counting
+// **********************************************************************
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+static atomic_ullong allocation_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+int   __real_posix_memalign(void **ptr, size_t alignment, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+char *__real_strdup(const char *s);
+
+void *__wrap_malloc(size_t size) {
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  return __real_malloc(size);
+}
+void *__wrap_calloc(size_t count, size_t size) {
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  return __real_calloc(count, size);
+}
+void *__wrap_realloc(void *ptr, size_t size) {
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  return __real_realloc(ptr, size);
+}
+int __wrap_posix_memalign(void **ptr, size_t alignment, size_t size) {
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  return __real_posix_memalign(ptr, alignment, size);
+}
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  return __real_aligned_alloc(alignment, size);
+}
+char *__wrap_strdup(const char *s) {
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  return __real_strdup(s);
+}
+
+static unsigned long long allocations(void) {
+  return atomic_load_explicit(&allocation_count, memory_order_relaxed);
+}
+#else
+static unsigned long long allocations(void) {
+  return 0;
+}
+#endif
+
+// **********************************************************************
+// Timing and Memory
+// **********************************************************************
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Linux can reset the peak (VmHWM) between benchmarks; elsewhere the peak is
+// the process's so far
+static bool reset_peak_rss(void) {
+  FILE *f = fopen("/proc/self/clear_refs", "w");
+  if (!f) return false;
+  bool ok = fputs("5", f) >= 0;
+  return fclose(f) == 0 && ok;
+}
+
+static long peak_rss_kb(void) {
+  FILE *f = fopen("/proc/self/status", "r");
+  if (f) {
+    char line[256];
+    long kb = -1;
+    while (fgets(line, sizeof(line), f)) {
+      if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) break;
+    }
+    fclose(f);
+    if (kb >= 0) return kb;
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;   // Bytes on macOS
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+// **********************************************************************
+// Benchmark Runner
+// **********************************************************************
+
+// Per-iteration work, filled in by the body for the rates
+typedef struct {
+  double items;              // In the benchmark's own unit (models, k-mers, lines...)
+  double samples;
+  double bytes;
+  double reads;
+} bench_work_t;
+
+typedef struct {
+  const char *models_dir;
+  const char *work_dir;
+  double min_time;
+  bool quick;
+
+  char *dna;                 // Random 1 Mb reference (fixed seed)
+  size_t dna_length;
+  int *bases;                // dna as base ints for squiggle_kmer
+  seqgen_kmer_context *dna_model;
+  struct seqgen_model_params dna_params;
+  seq_tensor *squiggle;      // squiggle_kmer of dna
+  seq_tensor *raw;           // squiggle_to_raw of squiggle
+  seq_tensor **reads;        // Generated reads for the Fast5 benchmarks
+  const char **read_names;
+  int num_reads;
+  char fast5_path[1024];
+  char text_path[1024];
+  double checksum;           // Reported by the body of the running benchmark (0 = none)
+} bench_state_t;
+
+typedef bool (*bench_body_t)(bench_state_t *state, bench_work_t *work);
+
+typedef struct {
+  FILE *json;
+  bool first;
+} bench_report_t;
+
+static void json_rate(FILE *json, const char *key, double value, double seconds) {
+  if (value > 0) fprintf(json, ", \"%s\": %.6g", key, value / seconds);
+  else fprintf(json, ", \"%s\": null", key);
+}
+
+// One untimed warm-up, then iterations until min_time; false if the body failed
+static bool run_benchmark(bench_report_t *report, bench_state_t *state, const char *name,
+                          const char *workload, const char *unit, bench_body_t body) {
+  bench_work_t work = {0};
+  state->checksum = 0;
+  if (!body(state, &work)) {
+    warnx("Benchmark %s failed", name);
+    return false;
+  }
+
+  reset_peak_rss();
+  unsigned long long allocations_before = allocations();
+  size_t iterations = 0;
+  double start = now_seconds(), elapsed = 0;
+  do {
+    if (!body(state, &work)) {
+      warnx("Benchmark %s failed", name);
+      return false;
+    }
+    iterations++;
+    elapsed = now_seconds() - start;
+  } while (elapsed < state->min_time);
+  unsigned long long allocations_used = allocations() - allocations_before;
+
+  double n = (double)iterations;
+  fprintf(report->json, "%s\n    {\"name\": \"%s\", \"workload\": \"%s\", \"iterations\": %zu, \"seconds\": %.6f",
+          report->first ? "" : ",", name, workload, iterations, elapsed);
+  fprintf(report->json, ", \"unit\": \"%s\"", unit);
+  json_rate(report->json, "items_per_s", work.items * n, elapsed);
+  json_rate(report->json, "samples_per_s", work.samples * n, elapsed);
+  json_rate(report->json, "mb_per_s", work.bytes * n / 1e6, elapsed);
+  json_rate(report->json, "reads_per_s", work.reads * n, elapsed);
+  fprintf(report->json, ", \"seconds_per_iteration\": %.9f", elapsed / n);
+#ifdef BENCH_COUNT_ALLOCATIONS
+  fprintf(report->json, ", \"allocations_per_iteration\": %.1f", (double)allocations_used / n);
+#else
+  (void)allocations_used;
+  fprintf(report->json, ", \"allocations_per_iteration\": null");
+#endif
+  fprintf(report->json, ", \"peak_rss_kb\": %ld", peak_rss_kb());
+  if (state->checksum != 0) fprintf(report->json, ", \"checksum\": %.6f", state->checksum);
+  fprintf(report->json, "}");
+  report->first = false;
+
+  fprintf(stderr, "  %-20s %8zu iterations in %.3f s\n", name, iterations, elapsed);
+  return true;
+}
+
+// **********************************************************************
+// Benchmarks
+// **********************************************************************
+
+static bool bench_model_load(bench_state_t *state, bench_work_t *work) {
+  const char *names[2] = {BENCH_DNA_MODEL, BENCH_RNA_MODEL};
+  for (int i = 0; i < 2; i++) {
+    seqgen_kmer_context *context = seqgen_kmer_context_create(state->models_dir, names[i]);
+    if (!context) return false;
+    seqgen_kmer_context_free(context);
+  }
+  work->items = 2;
+  return true;
+}
+
+static bool bench_kmer_encode(bench_state_t *state, bench_work_t *work) {
+  int *kmers = encode_bases_to_integers(state->dna, state->dna_length, 9);
+  if (!kmers) return false;
+  free(kmers);
+  work->items = (double)(state->dna_length - 8);
+  work->bytes = (double)state->dna_length;
+  return true;
+}
+
+static bool bench_squiggle_kmer(bench_state_t *state, bench_work_t *work) {
+  seq_tensor *squiggle = squiggle_kmer(state->bases, state->dna_length, true, &state->dna_params);
+  if (!squiggle) return false;
+  work->items = (double)squiggle->shape[0];
+  work->bytes = (double)state->dna_length;
+  seq_tensor_free(state->squiggle);
+  state->squiggle = squiggle;
+  return true;
+}
+
+static bool bench_squiggle_to_raw(bench_state_t *state, bench_work_t *work) {
+  seq_rng rng;
+  seq_rng_init(&rng, BENCH_SEED, 0);
+  seq_tensor *raw = squiggle_to_raw(state->squiggle, BENCH_SAMPLE_RATE_KHZ, &rng);
+  if (!raw) return false;
+  work->items = work->samples = (double)raw->shape[0];
+  work->bytes = (double)raw->shape[0] * sizeof(float);
+  double sum = 0;
+  const float *values = seq_tensor_data_float(raw);
+  for (size_t i = 0; i < raw->shape[0]; i++) sum += values[i];
+  state->checksum = sum / (double)raw->shape[0];
+  seq_tensor_free(state->raw);
+  state->raw = raw;
+  return true;
+}
+
+static bool bench_text_write(bench_state_t *state, bench_work_t *work) {
+  FILE *file = fopen(state->text_path, "w");
+  if (!file) return false;
+  seq_output_t out;
+  if (!seq_output_init(&out, file, 0)) {
+    fclose(file);
+    return false;
+  }
+  const float *values = seq_tensor_data_float(state->raw);
+  size_t n = state->raw->shape[0];
+  seq_output_str(&out, "# benchmark\n");
+  for (size_t i = 0; i < n; i++) {
+    seq_output_uint(&out, i);
+    seq_output_char(&out, '\t');
+    seq_output_fixed6(&out, values[i]);
+    seq_output_char(&out, '\n');
+  }
+  int status = seq_output_close(&out);
+  long bytes = ftell(file);
+  if (fclose(file) != 0 || status < 0) return false;
+  work->items = work->samples = (double)n;
+  work->bytes = (double)bytes;
+  return true;
+}
+
+static bool bench_fast5_write(bench_state_t *state, bench_work_t *work) {
+  fast5_write_options_t options;
+  fast5_write_options_init(&options);
+  fast5_write_stats_t stats = {0};
+  if (seq_write_fast5_multi_ex(state->fast5_path, state->reads, state->read_names, state->num_reads,
+                               BENCH_SAMPLE_RATE_KHZ, &options, &stats) != 0) {
+    return false;
+  }
+  work->samples = (double)stats.samples_written;
+  work->bytes = (double)stats.file_bytes;
+  work->items = work->reads = (double)stats.reads_written;
+  return true;
+}
+
+static bool bench_fast5_metadata_scan(bench_state_t *state, bench_work_t *work) {
+  size_t count = 0;
+  fast5_metadata_t *metadata = read_fast5_metadata_with_enhancer(state->fast5_path, &count, NULL);
+  if (!metadata || count != (size_t)state->num_reads) {
+    free_fast5_metadata(metadata, count);
+    return false;
+  }
+  double samples = 0;
+  for (size_t i = 0; i < count; i++) samples += metadata[i].signal_length;
+  free_fast5_metadata(metadata, count);
+  work->items = work->reads = (double)count;
+  state->checksum = samples;
+  return true;
+}
+
+static bool bench_fast5_signal_read(bench_state_t *state, bench_work_t *work) {
+  fast5_reader_t *reader = fast5_reader_open(state->fast5_path, NULL);
+  if (!reader) return false;
+  fast5_metadata_t metadata = {0};
+  size_t reads = 0, samples = 0;
+  int status;
+  while ((status = fast5_reader_next(reader, &metadata, true)) > 0) {
+    size_t length = 0;
+    if (fast5_reader_signal(reader, &length)) {
+      reads++;
+      samples += length;
+    }
+    clear_fast5_metadata(&metadata);
+  }
+  fast5_reader_close(reader);
+  if (status < 0 || reads != (size_t)state->num_reads) return false;
+  work->items = work->reads = (double)reads;
+  work->samples = (double)samples;
+  work->bytes = (double)samples * sizeof(int16_t);
+  return true;
+}
+
+// **********************************************************************
+// Workloads
+// **********************************************************************
+
+static void build_workloads(bench_state_t *state) {
+  seq_rng rng;
+  seq_rng_init(&rng, BENCH_SEED, 0);
+  state->dna_length = state->quick ? 100000 : 1000000;
+  state->dna = malloc(state->dna_length + 1);
+  state->bases = malloc(state->dna_length * sizeof(int));
+  if (!state->dna || !state->bases) errx(EXIT_FAILURE, "Memory allocation failed for benchmark workloads");
+  for (size_t i = 0; i < state->dna_length; i++) {
+    state->bases[i] = (int)seq_rng_below(&rng, 4);
+    state->dna[i] = "ACGT"[state->bases[i]];
+  }
+  state->dna[state->dna_length] = '\0';
+
+  state->dna_model = seqgen_kmer_context_create(state->models_dir, BENCH_DNA_MODEL);
+  if (!state->dna_model) {
+    errx(EXIT_FAILURE, "Cannot load %s from %s (run from the source tree or pass -d)", BENCH_DNA_MODEL,
+         state->models_dir);
+  }
+  state->dna_params = (struct seqgen_model_params){
+    .model_type = SEQGEN_MODEL_KMER,
+    .params.kmer = {
+      .model_name = BENCH_DNA_MODEL,
+      .models_dir = state->models_dir,
+      .kmer_size = 9,
+      .sample_rate_khz = BENCH_SAMPLE_RATE_KHZ,
+      .context = state->dna_model
+    }
+  };
+
+  // Reads of 2-10 kb sampled from the reference, each from its own stream
+  state->num_reads = state->quick ? 20 : 200;
+  state->reads = calloc((size_t)state->num_reads, sizeof(seq_tensor*));
+  state->read_names = calloc((size_t)state->num_reads, sizeof(char*));
+  if (!state->reads || !state->read_names) errx(EXIT_FAILURE, "Memory allocation failed for benchmark reads");
+  for (int r = 0; r < state->num_reads; r++) {
+    seq_rng read_rng;
+    seq_rng_init(&read_rng, BENCH_SEED, (uint64_t)r + 1);
+    size_t length = 2000 + seq_rng_below(&read_rng, 8001);
+    size_t start = seq_rng_below(&read_rng, (uint32_t)(state->dna_length - length));
+    state->reads[r] = sequence_to_raw(state->dna + start, length, true, &state->dna_params,
+                                      BENCH_SAMPLE_RATE_KHZ, &read_rng);
+    char *name = malloc(32);
+    if (!state->reads[r] || !name) errx(EXIT_FAILURE, "Cannot generate benchmark read %d", r);
+    snprintf(name, 32, "bench_%04d", r);
+    state->read_names[r] = name;
+  }
+
+  snprintf(state->fast5_path, sizeof(state->fast5_path), "%s/bench_%ld.fast5", state->work_dir, (long)getpid());
+  snprintf(state->text_path, sizeof(state->text_path), "%s/bench_%ld.txt", state->work_dir, (long)getpid());
+}
+
+static void free_workloads(bench_state_t *state) {
+  for (int r = 0; r < state->num_reads; r++) {
+    seq_tensor_free(state->reads[r]);
+    free((char*)state->read_names[r]);
+  }
+  free(state->reads);
+  free(state->read_names);
+  seq_tensor_free(state->squiggle);
+  seq_tensor_free(state->raw);
+  seqgen_kmer_context_free(state->dna_model);
+  free(state->bases);
+  free(state->dna);
+  unlink(state->fast5_path);
+  unlink(state->text_path);
+}
+
+// **********************************************************************
+// Main
+// **********************************************************************
+
+static void usage(const char *program) {
+  fprintf(stderr, "Usage: %s [-o FILE.json] [-t MIN_SECONDS] [-d MODELS_DIR] [-w WORK_DIR] [-q]\n"
+                  "  -o  JSON report (default: stdout)\n"
+                  "  -t  Minimum time per benchmark (default: 0.5)\n"
+                  "  -d  k-mer models directory (default: kmer_models)\n"
+                  "  -w  Directory for the temporary text and Fast5 files (default: /tmp)\n"
+                  "  -q  Quick run: 100 kb reference, 20 reads, one iteration each\n", program);
+}
+
+int main(int argc, char *argv[]) {
+  bench_state_t state = {.models_dir = "kmer_models", .work_dir = "/tmp", .min_time = 0.5};
+  const char *output_path = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:t:d:w:qh")) != -1) {
+    switch (opt) {
+      case 'o': output_path = optarg; break;
+      case 't': state.min_time = atof(optarg); break;
+      case 'd': state.models_dir = optarg; break;
+      case 'w': state.work_dir = optarg; break;
+      case 'q': state.quick = true; break;
+      default:
+        usage(argv[0]);
+        return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+  if (state.quick) state.min_time = 0;
+
+  FILE *json = output_path ? fopen(output_path, "w") : stdout;
+  if (!json) err(EXIT_FAILURE, "Cannot create %s", output_path);
+
+  fprintf(stderr, "Building workloads (seed %d)...\n", BENCH_SEED);
+  build_workloads(&state);
+
+  fprintf(json, "{\n  \"benchmark\": \"sequelizer\",\n  \"seed\": %d,\n  \"min_time_s\": %.3f,\n"
+                "  \"reference_bases\": %zu,\n  \"fast5_reads\": %d,\n  \"allocation_counting\": %s,\n"
+                "  \"results\": [",
+          BENCH_SEED, state.min_time, state.dna_length, state.num_reads,
+#ifdef BENCH_COUNT_ALLOCATIONS
+          "true"
+#else
+          "false"
+#endif
+          );
+
+  bench_report_t report = {json, true};
+  bool ok =
+    run_benchmark(&report, &state, "model_load", BENCH_DNA_MODEL "+" BENCH_RNA_MODEL, "models", bench_model_load) &&
+    run_benchmark(&report, &state, "kmer_encode", "9-mers", "kmers", bench_kmer_encode) &&
+    run_benchmark(&report, &state, "squiggle_kmer", BENCH_DNA_MODEL, "kmers", bench_squiggle_kmer) &&
+    run_benchmark(&report, &state, "squiggle_to_raw", "4 kHz", "samples", bench_squiggle_to_raw) &&
+    run_benchmark(&report, &state, "text_write", "index\\tvalue", "lines", bench_text_write) &&
+    run_benchmark(&report, &state, "fast5_write", "multi-read int16 deflate-1", "reads", bench_fast5_write) &&
+    run_benchmark(&report, &state, "fast5_metadata_scan", "multi-read", "reads", bench_fast5_metadata_scan) &&
+    run_benchmark(&report, &state, "fast5_signal_read", "multi-read", "reads", bench_fast5_signal_read);
+  fprintf(json, "\n  ]\n}\n");
+
+  free_workloads(&state);
+  if (json != stdout && fclose(json) != 0) err(EXIT_FAILURE, "Cannot write %s", output_path);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,438 @@
+// **********************************************************************
+// core/columnar_writer.c - Fixed-Width Binary Columnar Tables
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "columnar_writer.h"
+#include <err.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COLUMNAR_DEFAULT_GROUP_ROWS (1u << 18)
+
+typedef struct {
+  char *name;
+  columnar_type_t type;
+  size_t width;              // Bytes per value (0 for STRING: set per row group)
+  uint8_t *values;           // group_rows values, little-endian
+
+  // STRING: this row group's values, packed
+  char *arena;
+  size_t arena_size;
+  size_t arena_capacity;
+  size_t *string_offsets;
+  uint32_t *string_lengths;
+  uint32_t max_length;
+
+  // DICT: entries in code order, and an open-addressing table of code + 1 (0 = empty)
+  char **entries;
+  uint32_t num_entries;
+  size_t entry_capacity;
+  uint32_t *slots;
+  size_t slot_capacity;
+} column_state_t;
+
+struct columnar_writer {
+  FILE *file;
+  column_state_t *columns;
+  size_t num_columns;
+  size_t group_rows;
+  size_t rows;               // Rows in the current row group
+  uint64_t total_rows;
+  uint64_t offset;           // Bytes written so far
+  bool failed;
+
+  // Written row groups: rows, and per column block offset and value width
+  uint64_t *group_sizes;
+  uint64_t *block_offsets;
+  uint32_t *block_widths;
+  size_t num_groups;
+  size_t group_capacity;
+};
+
+// **********************************************************************
+// Byte Output
+// **********************************************************************
+
+static void write_bytes(columnar_writer_t *writer, const void *data, size_t n) {
+  if (writer->failed || n == 0) return;
+  if (fwrite(data, 1, n, writer->file) != n) {
+    writer->failed = true;
+    return;
+  }
+  writer->offset += n;
+}
+
+static void put_le(uint8_t *p, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; i++) {
+    p[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static void write_le(columnar_writer_t *writer, uint64_t value, size_t bytes) {
+  uint8_t buffer[8];
+  put_le(buffer, value, bytes);
+  write_bytes(writer, buffer, bytes);
+}
+
+static void write_padding(columnar_writer_t *writer) {
+  static const uint8_t zeros[8] = {0};
+  write_bytes(writer, zeros, (8 - writer->offset % 8) % 8);
+}
+
+// **********************************************************************
+// Dictionaries
+// **********************************************************************
+
+// FNV-1a, as for the read-id index
+static uint64_t hash_string(const char *s) {
+  uint64_t hash = 1469598103934665603ULL;
+  for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+    hash ^= *p;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static void slot_insert(uint32_t *slots, size_t slot_capacity, char **entries, uint32_t code) {
+  size_t mask = slot_capacity - 1;
+  size_t slot = (size_t)hash_string(entries[code]) & mask;
+  while (slots[slot] != 0) slot = (slot + 1) & mask;
+  slots[slot] = code + 1;
+}
+
+// COLUMNAR_MISSING_CODE (and the writer failed) if the value cannot be added
+static uint32_t dictionary_code(columnar_writer_t *writer, column_state_t *column, const char *value) {
+  if (column->slot_capacity > 0) {
+    size_t mask = column->slot_capacity - 1;
+    size_t slot = (size_t)hash_string(value) & mask;
+    while (column->slots[slot] != 0) {
+      uint32_t code = column->slots[slot] - 1;
+      if (strcmp(column->entries[code], value) == 0) return code;
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  if (writer->failed) return COLUMNAR_MISSING_CODE;
+  if (column->num_entries == COLUMNAR_MISSING_CODE - 1) {
+    warnx("Too many distinct values in column %s", column->name);
+    writer->failed = true;
+    return COLUMNAR_MISSING_CODE;
+  }
+  if (column->num_entries == column->entry_capacity) {
+    size_t capacity = column->entry_capacity ? column->entry_capacity * 2 : 64;
+    char **entries = realloc(column->entries, capacity * sizeof(char*));
+    if (!entries) {
+      warnx("Memory allocation failed for column dictionary");
+      writer->failed = true;
+      return COLUMNAR_MISSING_CODE;
+    }
+    column->entries = entries;
+    column->entry_capacity = capacity;
+  }
+  // Keep the table at most half full
+  if (2 * ((size_t)column->num_entries + 1) > column->slot_capacity) {
+    size_t capacity = column->slot_capacity ? column->slot_capacity * 2 : 128;
+    uint32_t *slots = calloc(capacity, sizeof(uint32_t));
+    if (!slots) {
+      warnx("Memory allocation failed for column dictionary");
+      writer->failed = true;
+      return COLUMNAR_MISSING_CODE;
+    }
+    for (uint32_t code = 0; code < column->num_entries; code++) {
+      slot_insert(slots, capacity, column->entries, code);
+    }
+    free(column->slots);
+    column->slots = slots;
+    column->slot_capacity = capacity;
+  }
+
+  uint32_t code = column->num_entries;
+  column->entries[code] = strdup(value);
+  if (!column->entries[code]) {
+    warnx("Memory allocation failed for column dictionary");
+    writer->failed = true;
+    return COLUMNAR_MISSING_CODE;
+  }
+  column->num_entries++;
+  slot_insert(column->slots, column->slot_capacity, column->entries, code);
+  return code;
+}
+
+// **********************************************************************
+// Rows and Row Groups
+// **********************************************************************
+
+static size_t type_width(columnar_type_t type) {
+  switch (type) {
+    case COLUMNAR_U8:     return 1;
+    case COLUMNAR_U32:    return 4;
+    case COLUMNAR_DICT:   return 4;
+    case COLUMNAR_U64:    return 8;
+    case COLUMNAR_F64:    return 8;
+    case COLUMNAR_STRING: return 0;
+  }
+  return 0;
+}
+
+static void set_f64_bits(uint8_t *p, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  put_le(p, bits, sizeof(bits));
+}
+
+// Defaults for the row about to be filled
+static void reset_row(columnar_writer_t *writer) {
+  for (size_t c = 0; c < writer->num_columns; c++) {
+    column_state_t *column = &writer->columns[c];
+    uint8_t *value = column->values + writer->rows * column->width;
+    switch (column->type) {
+      case COLUMNAR_F64:
+        set_f64_bits(value, NAN);
+        break;
+      case COLUMNAR_DICT:
+        put_le(value, COLUMNAR_MISSING_CODE, 4);
+        break;
+      case COLUMNAR_STRING:
+        column->string_offsets[writer->rows] = column->arena_size;
+        column->string_lengths[writer->rows] = 0;
+        break;
+      default:
+        memset(value, 0, column->width);
+        break;
+    }
+  }
+}
+
+// The row group's buffers are emptied whether or not it could be written
+static void discard_row_group(columnar_writer_t *writer) {
+  for (size_t c = 0; c < writer->num_columns; c++) {
+    writer->columns[c].arena_size = 0;
+    writer->columns[c].max_length = 0;
+  }
+  writer->rows = 0;
+}
+
+static void write_row_group(columnar_writer_t *writer) {
+  if (writer->rows == 0) return;
+
+  if (writer->num_groups == writer->group_capacity) {
+    size_t capacity = writer->group_capacity ? writer->group_capacity * 2 : 16;
+    uint64_t *sizes = realloc(writer->group_sizes, capacity * sizeof(uint64_t));
+    if (sizes) writer->group_sizes = sizes;
+    uint64_t *offsets = realloc(writer->block_offsets, capacity * writer->num_columns * sizeof(uint64_t));
+    if (offsets) writer->block_offsets = offsets;
+    uint32_t *widths = realloc(writer->block_widths, capacity * writer->num_columns * sizeof(uint32_t));
+    if (widths) writer->block_widths = widths;
+    if (!sizes || !offsets || !widths) {
+      warnx("Memory allocation failed for row groups");
+      writer->failed = true;
+      discard_row_group(writer);
+      return;
+    }
+    writer->group_capacity = capacity;
+  }
+
+  size_t group = writer->num_groups++;
+  writer->group_sizes[group] = writer->rows;
+  for (size_t c = 0; c < writer->num_columns; c++) {
+    column_state_t *column = &writer->columns[c];
+    write_padding(writer);
+    writer->block_offsets[group * writer->num_columns + c] = writer->offset;
+
+    if (column->type != COLUMNAR_STRING) {
+      writer->block_widths[group * writer->num_columns + c] = (uint32_t)column->width;
+      write_bytes(writer, column->values, writer->rows * column->width);
+      continue;
+    }
+
+    // Strings: NUL-padded to this group's longest value
+    uint32_t width = column->max_length;
+    writer->block_widths[group * writer->num_columns + c] = width;
+    char *padded = width > 0 ? malloc(width) : NULL;
+    if (width > 0 && !padded) {
+      warnx("Memory allocation failed for string column");
+      writer->failed = true;
+    } else if (width > 0) {
+      for (size_t r = 0; r < writer->rows; r++) {
+        memset(padded, 0, width);
+        memcpy(padded, column->arena + column->string_offsets[r], column->string_lengths[r]);
+        write_bytes(writer, padded, width);
+      }
+      free(padded);
+    }
+  }
+
+  discard_row_group(writer);
+}
+
+// **********************************************************************
+// Public Interface
+// **********************************************************************
+
+static void free_writer(columnar_writer_t *writer) {
+  for (size_t c = 0; c < writer->num_columns; c++) {
+    column_state_t *column = &writer->columns[c];
+    free(column->name);
+    free(column->values);
+    free(column->arena);
+    free(column->string_offsets);
+    free(column->string_lengths);
+    for (uint32_t e = 0; e < column->num_entries; e++) free(column->entries[e]);
+    free(column->entries);
+    free(column->slots);
+  }
+  free(writer->columns);
+  free(writer->group_sizes);
+  free(writer->block_offsets);
+  free(writer->block_widths);
+  free(writer);
+}
+
+columnar_writer_t* columnar_writer_open(const char *filename, const columnar_column_t *columns,
+                                        size_t num_columns, size_t group_rows) {
+  if (!filename || !columns || num_columns == 0) return NULL;
+
+  columnar_writer_t *writer = calloc(1, sizeof(columnar_writer_t));
+  if (writer) writer->columns = calloc(num_columns, sizeof(column_state_t));
+  if (!writer || !writer->columns) {
+    warnx("Memory allocation failed for columnar writer");
+    free(writer);
+    return NULL;
+  }
+  writer->group_rows = group_rows ? group_rows : COLUMNAR_DEFAULT_GROUP_ROWS;
+  writer->num_columns = num_columns;
+
+  for (size_t c = 0; c < num_columns; c++) {
+    column_state_t *column = &writer->columns[c];
+    column->name = strndup(columns[c].name, 255);
+    column->type = columns[c].type;
+    column->width = type_width(column->type);
+    if (column->type == COLUMNAR_STRING) {
+      column->string_offsets = malloc(writer->group_rows * sizeof(size_t));
+      column->string_lengths = malloc(writer->group_rows * sizeof(uint32_t));
+    } else {
+      column->values = malloc(writer->group_rows * column->width);
+    }
+    if (!column->name || (column->type == COLUMNAR_STRING ? !column->string_offsets || !column->string_lengths
+                                                          : !column->values)) {
+      warnx("Memory allocation failed for columnar writer");
+      free_writer(writer);
+      return NULL;
+    }
+  }
+
+  writer->file = fopen(filename, "wb");
+  if (!writer->file) {
+    warnx("Cannot create output file: %s", filename);
+    free_writer(writer);
+    return NULL;
+  }
+  write_bytes(writer, COLUMNAR_MAGIC, 8);
+  reset_row(writer);
+  return writer;
+}
+
+void columnar_writer_set_u8(columnar_writer_t *writer, size_t column, uint8_t value) {
+  column_state_t *state = &writer->columns[column];
+  state->values[writer->rows] = value;
+}
+
+void columnar_writer_set_u32(columnar_writer_t *writer, size_t column, uint32_t value) {
+  column_state_t *state = &writer->columns[column];
+  put_le(state->values + writer->rows * 4, value, 4);
+}
+
+void columnar_writer_set_u64(columnar_writer_t *writer, size_t column, uint64_t value) {
+  column_state_t *state = &writer->columns[column];
+  put_le(state->values + writer->rows * 8, value, 8);
+}
+
+void columnar_writer_set_f64(columnar_writer_t *writer, size_t column, double value) {
+  column_state_t *state = &writer->columns[column];
+  set_f64_bits(state->values + writer->rows * 8, value);
+}
+
+void columnar_writer_set_string(columnar_writer_t *writer, size_t column, const char *value) {
+  column_state_t *state = &writer->columns[column];
+  if (state->type == COLUMNAR_DICT) {
+    put_le(state->values + writer->rows * 4, value ? dictionary_code(writer, state, value) : COLUMNAR_MISSING_CODE, 4);
+    return;
+  }
+  if (!value) return;
+
+  size_t length = strlen(value);
+  if (length > UINT32_MAX) length = UINT32_MAX;
+  // Setting a row twice keeps the last value; the arena only grows until the group is written
+  if (state->arena_size + length > state->arena_capacity) {
+    size_t capacity = state->arena_capacity ? state->arena_capacity : 4096;
+    while (capacity < state->arena_size + length) capacity *= 2;
+    char *arena = realloc(state->arena, capacity);
+    if (!arena) {
+      // The row keeps its empty default; end_row() reports the failure
+      if (!writer->failed) warnx("Memory allocation failed for string column");
+      writer->failed = true;
+      return;
+    }
+    state->arena = arena;
+    state->arena_capacity = capacity;
+  }
+  memcpy(state->arena + state->arena_size, value, length);
+  state->string_offsets[writer->rows] = state->arena_size;
+  state->string_lengths[writer->rows] = (uint32_t)length;
+  state->arena_size += length;
+  if (length > state->max_length) state->max_length = (uint32_t)length;
+}
+
+bool columnar_writer_end_row(columnar_writer_t *writer) {
+  writer->rows++;
+  writer->total_rows++;
+  if (writer->rows == writer->group_rows) write_row_group(writer);
+  reset_row(writer);
+  return !writer->failed;
+}
+
+int columnar_writer_close(columnar_writer_t *writer, uint64_t *num_rows) {
+  if (!writer) return -1;
+  write_row_group(writer);
+
+  write_padding(writer);
+  uint64_t footer_offset = writer->offset;
+  write_le(writer, writer->num_columns, 4);
+  write_le(writer, writer->num_groups, 4);
+  write_le(writer, writer->total_rows, 8);
+  for (size_t c = 0; c < writer->num_columns; c++) {
+    const column_state_t *column = &writer->columns[c];
+    size_t length = strlen(column->name);
+    write_le(writer, column->type, 1);
+    write_le(writer, length, 1);
+    write_bytes(writer, column->name, length);
+  }
+  for (size_t g = 0; g < writer->num_groups; g++) {
+    write_le(writer, writer->group_sizes[g], 8);
+    for (size_t c = 0; c < writer->num_columns; c++) {
+      write_le(writer, writer->block_offsets[g * writer->num_columns + c], 8);
+      write_le(writer, writer->block_widths[g * writer->num_columns + c], 4);
+    }
+  }
+  for (size_t c = 0; c < writer->num_columns; c++) {
+    const column_state_t *column = &writer->columns[c];
+    if (column->type != COLUMNAR_DICT) continue;
+    write_le(writer, column->num_entries, 4);
+    for (uint32_t e = 0; e < column->num_entries; e++) {
+      size_t length = strlen(column->entries[e]);
+      write_le(writer, length, 4);
+      write_bytes(writer, column->entries[e], length);
+    }
+  }
+  write_le(writer, footer_offset, 8);
+  write_bytes(writer, COLUMNAR_MAGIC, 8);
+
+  int status = writer->failed ? -1 : 0;
+  if (fclose(writer->file) != 0) status = -1;
+  if (num_rows) *num_rows = writer->total_rows;
+  free_writer(writer);
+  return status;
+}
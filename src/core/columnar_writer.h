@@ -0,0 +1,74 @@
+// **********************************************************************
+// core/columnar_writer.h - Fixed-Width Binary Columnar Tables
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// A small column store for read-level tables too large to parse as text
+// (10M-read metadata exports). Rows are buffered into row groups; each row
+// group is written as one fixed-width block per column, so a reader can
+// mmap a column and index it directly, and repeated strings (run_id,
+// channel_number, file paths) are dictionary-encoded once per file.
+//
+// Layout (every integer little-endian, every column block 8-byte aligned):
+//
+//   "SQCOLMN1"                                      magic
+//   row group 0 .. row group G-1                    column blocks back to back
+//   footer:
+//     uint32 num_columns, uint32 num_row_groups, uint64 num_rows
+//     per column:    uint8 type, uint8 name_length, name bytes
+//     per row group: uint64 rows, then per column uint64 block offset, uint32 value width
+//     per DICT column, in column order: uint32 entries, then per entry uint32 length, bytes
+//   uint64 footer offset, "SQCOLMN1"                last 16 bytes
+//
+// Missing values are NaN (F64) and UINT32_MAX (DICT codes); STRING values
+// are NUL-padded to the longest value of their row group.
+#ifndef SEQUELIZER_COLUMNAR_WRITER_H
+#define SEQUELIZER_COLUMNAR_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define COLUMNAR_MAGIC "SQCOLMN1"
+#define COLUMNAR_MISSING_CODE UINT32_MAX
+
+// Values are the on-disk type codes
+typedef enum {
+  COLUMNAR_U8 = 1,
+  COLUMNAR_U32 = 2,
+  COLUMNAR_U64 = 3,
+  COLUMNAR_F64 = 4,
+  COLUMNAR_DICT = 5,       // uint32 code into the column's dictionary
+  COLUMNAR_STRING = 6      // Fixed width per row group
+} columnar_type_t;
+
+typedef struct {
+  const char *name;        // At most 255 bytes
+  columnar_type_t type;
+} columnar_column_t;
+
+typedef struct columnar_writer columnar_writer_t;
+
+// Create filename for the given columns, flushing a row group every group_rows
+// rows (0 = 262144). NULL (with a warning) if the file cannot be created or
+// memory runs out
+columnar_writer_t* columnar_writer_open(const char *filename, const columnar_column_t *columns,
+                                        size_t num_columns, size_t group_rows);
+
+// Values of the current row, by column index; columns left unset read as 0,
+// NaN, missing or "". set_string takes DICT and STRING columns (NULL = missing)
+void columnar_writer_set_u8(columnar_writer_t *writer, size_t column, uint8_t value);
+void columnar_writer_set_u32(columnar_writer_t *writer, size_t column, uint32_t value);
+void columnar_writer_set_u64(columnar_writer_t *writer, size_t column, uint64_t value);
+void columnar_writer_set_f64(columnar_writer_t *writer, size_t column, double value);
+void columnar_writer_set_string(columnar_writer_t *writer, size_t column, const char *value);
+
+// Finish the current row (writing its row group once full); false once a write
+// has failed, memory has run out or a DICT column has outgrown its 32-bit codes
+bool columnar_writer_end_row(columnar_writer_t *writer);
+
+// Write the last row group, dictionaries and footer and close; 0 on success, -1 if
+// any write failed. Rows written so far are reported in *num_rows (may be NULL)
+int columnar_writer_close(columnar_writer_t *writer, uint64_t *num_rows);
+
+#endif // SEQUELIZER_COLUMNAR_WRITER_H
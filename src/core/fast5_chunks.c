@@ -0,0 +1,327 @@
+// **********************************************************************
+// core/fast5_chunks.c - Raw Signal Chunk Reads and Off-Lock Decompression
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "fast5_chunks.h"
+#include "seq_profile.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+// Registered HDF5 filter id of ONT's VBZ (zstd + StreamVByte) plugin
+#define FAST5_FILTER_VBZ 32020
+
+// Chunks each decode thread should have at least, so short reads stay on one thread
+#define FAST5_CHUNKS_PER_THREAD 2
+
+// **********************************************************************
+// Fetch (HDF5)
+// **********************************************************************
+
+// Name the filter pipeline and note where shuffle and deflate sit in it;
+// true if nothing else is in it
+static bool classify_pipeline(hid_t dcpl, fast5_raw_signal_t *raw) {
+  raw->compression = "none";
+  raw->shuffle_filter = -1;
+  raw->deflate_filter = -1;
+  raw->deflate_level = 0;
+
+  bool decodable = true;
+  int num_filters = H5Pget_nfilters(dcpl);
+  for (int f = 0; f < num_filters; f++) {
+    unsigned int flags = 0;
+    unsigned int values[8] = {0};
+    size_t num_values = 8;
+    H5Z_filter_t filter = H5Pget_filter2(dcpl, (unsigned)f, &flags, &num_values, values, 0, NULL, NULL);
+    if (filter == H5Z_FILTER_SHUFFLE && raw->shuffle_filter < 0 && raw->deflate_filter < 0) {
+      raw->shuffle_filter = f;
+    } else if (filter == H5Z_FILTER_DEFLATE && raw->deflate_filter < 0) {
+      raw->deflate_filter = f;
+      raw->deflate_level = num_values > 0 ? (int)values[0] : 1;
+      raw->compression = "deflate-gzip";
+    } else {
+      if (filter == FAST5_FILTER_VBZ) raw->compression = "vbz";
+      else if (filter == H5Z_FILTER_SZIP) raw->compression = "szip";
+      decodable = false;
+    }
+  }
+  return decodable;
+}
+
+static bool reserve_chunks(fast5_raw_signal_t *raw, size_t num_chunks) {
+  if (num_chunks <= raw->chunk_capacity) return true;
+  size_t *offsets = realloc(raw->offsets, (num_chunks + 1) * sizeof(size_t));
+  if (offsets) raw->offsets = offsets;
+  uint32_t *masks = realloc(raw->filter_masks, num_chunks * sizeof(uint32_t));
+  if (masks) raw->filter_masks = masks;
+  if (!offsets || !masks) return false;
+  raw->chunk_capacity = num_chunks;
+  return true;
+}
+
+static bool reserve_data(fast5_raw_signal_t *raw, size_t bytes) {
+  if (bytes <= raw->data_capacity) return true;
+  size_t capacity = raw->data_capacity ? raw->data_capacity : 64 * 1024;
+  while (capacity < bytes) capacity *= 2;
+  uint8_t *grown = realloc(raw->data, capacity);
+  if (!grown) return false;
+  raw->data = grown;
+  raw->data_capacity = capacity;
+  return true;
+}
+
+bool fast5_raw_signal_fetch(hid_t dataset_id, size_t length, fast5_raw_signal_t *raw) {
+  raw->num_chunks = 0;
+  raw->length = length;
+
+  hid_t dcpl = H5Dget_create_plist(dataset_id);
+  if (dcpl < 0) {
+    raw->compression = "none";
+    return false;
+  }
+  bool decodable = classify_pipeline(dcpl, raw);
+  hsize_t chunk_dim = 0;
+  if (H5Pget_layout(dcpl) != H5D_CHUNKED || H5Pget_chunk(dcpl, 1, &chunk_dim) != 1 || chunk_dim == 0) {
+    decodable = false;
+  }
+  H5Pclose(dcpl);
+
+  // Chunks hold the file's bytes and decode_chunk() reads them little-endian: only
+  // little-endian int16 on a little-endian host is fetched (big-endian hosts use H5Dread)
+  hid_t type_id = H5Dget_type(dataset_id);
+  if (type_id < 0) return false;
+  if (H5Tequal(type_id, H5T_NATIVE_INT16) <= 0 || H5Tequal(type_id, H5T_STD_I16LE) <= 0) decodable = false;
+  H5Tclose(type_id);
+
+#if H5_VERSION_GE(1, 10, 3)
+  if (!decodable || length == 0) return false;
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  raw->chunk_samples = (size_t)chunk_dim;
+  size_t num_chunks = (length + raw->chunk_samples - 1) / raw->chunk_samples;
+  if (!reserve_chunks(raw, num_chunks)) return false;
+
+  bool ok = true;
+  size_t used = 0;
+  for (size_t i = 0; i < num_chunks && ok; i++) {
+    hsize_t offset = (hsize_t)(i * raw->chunk_samples);
+    hsize_t stored = 0;
+    // Unallocated chunks (fill value only) have no bytes to copy; H5Dread handles them
+    if (H5Dget_chunk_storage_size(dataset_id, &offset, &stored) < 0 || stored == 0 ||
+        !reserve_data(raw, used + (size_t)stored)) {
+      ok = false;
+      break;
+    }
+    raw->offsets[i] = used;
+    ok = H5Dread_chunk(dataset_id, H5P_DEFAULT, &offset, &raw->filter_masks[i], raw->data + used) >= 0;
+    used += (size_t)stored;
+  }
+  raw->offsets[num_chunks] = used;
+  SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, profile_start);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 2 * num_chunks);
+  if (!ok) return false;
+  raw->num_chunks = num_chunks;
+  return true;
+#else
+  (void)decodable;
+  return false;
+#endif
+}
+
+hid_t fast5_raw_signal_create_plist(const fast5_raw_signal_t *raw) {
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  if (dcpl < 0) return -1;
+  hsize_t chunk_dim = (hsize_t)raw->chunk_samples;
+  bool ok = H5Pset_chunk(dcpl, 1, &chunk_dim) >= 0;
+  // Same filter order as classify_pipeline accepts, so the chunks' filter masks still apply
+  if (ok && raw->shuffle_filter >= 0) ok = H5Pset_shuffle(dcpl) >= 0;
+  if (ok && raw->deflate_filter >= 0) ok = H5Pset_deflate(dcpl, (unsigned)raw->deflate_level) >= 0;
+  if (!ok) {
+    H5Pclose(dcpl);
+    return -1;
+  }
+  return dcpl;
+}
+
+bool fast5_raw_signal_write(hid_t dataset_id, const fast5_raw_signal_t *raw) {
+#if H5_VERSION_GE(1, 10, 3)
+  for (size_t i = 0; i < raw->num_chunks; i++) {
+    hsize_t offset = (hsize_t)(i * raw->chunk_samples);
+    if (H5Dwrite_chunk(dataset_id, H5P_DEFAULT, raw->filter_masks[i], &offset,
+                       raw->offsets[i + 1] - raw->offsets[i], raw->data + raw->offsets[i]) < 0) {
+      return false;
+    }
+  }
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, raw->num_chunks);
+  return true;
+#else
+  (void)dataset_id;
+  (void)raw;
+  return false;
+#endif
+}
+
+// **********************************************************************
+// Decode and Encode (no HDF5)
+// **********************************************************************
+
+static bool host_little_endian(void) {
+  const uint16_t probe = 1;
+  return *(const uint8_t*)&probe == 1;
+}
+
+// Chunk i into signal; scratch holds one uncompressed chunk (little-endian, see fetch)
+static bool decode_chunk(const fast5_raw_signal_t *raw, size_t i, int16_t *signal, uint8_t *scratch) {
+  const uint8_t *bytes = raw->data + raw->offsets[i];
+  size_t stored = raw->offsets[i + 1] - raw->offsets[i];
+  size_t chunk_bytes = raw->chunk_samples * sizeof(int16_t);
+  uint32_t mask = raw->filter_masks[i];
+
+  // Edge chunks are stored at full size; only the samples inside the dataset are kept
+  size_t first = i * raw->chunk_samples;
+  size_t count = raw->length - first < raw->chunk_samples ? raw->length - first : raw->chunk_samples;
+
+  if (raw->deflate_filter >= 0 && !(mask & (1u << raw->deflate_filter))) {
+    uLongf inflated = (uLongf)chunk_bytes;
+    if (uncompress(scratch, &inflated, bytes, (uLong)stored) != Z_OK || inflated != chunk_bytes) return false;
+    bytes = scratch;
+  } else if (stored != chunk_bytes) {
+    return false;
+  }
+
+  // Shuffled chunks store every sample's low bytes, then every high byte (little-endian)
+  if (raw->shuffle_filter >= 0 && !(mask & (1u << raw->shuffle_filter))) {
+    const uint8_t *low = bytes;
+    const uint8_t *high = bytes + raw->chunk_samples;
+    int16_t *out = signal + first;
+    for (size_t j = 0; j < count; j++) {
+      out[j] = (int16_t)(uint16_t)(low[j] | (uint16_t)high[j] << 8);
+    }
+  } else {
+    memcpy(signal + first, bytes, count * sizeof(int16_t));
+  }
+  return true;
+}
+
+typedef struct {
+  const fast5_raw_signal_t *raw;
+  int16_t *signal;
+  atomic_size_t next_chunk;
+  atomic_bool failed;
+} decode_job_t;
+
+static void* decode_worker(void *arg) {
+  decode_job_t *job = arg;
+  uint8_t *scratch = malloc(job->raw->chunk_samples * sizeof(int16_t));
+  if (!scratch) {
+    atomic_store(&job->failed, true);
+    return NULL;
+  }
+  size_t i;
+  while (!atomic_load_explicit(&job->failed, memory_order_relaxed) &&
+         (i = atomic_fetch_add(&job->next_chunk, 1)) < job->raw->num_chunks) {
+    if (!decode_chunk(job->raw, i, job->signal, scratch)) atomic_store(&job->failed, true);
+  }
+  free(scratch);
+  return NULL;
+}
+
+bool fast5_raw_signal_decode(const fast5_raw_signal_t *raw, int16_t *signal, int threads) {
+  if (raw->num_chunks == 0) return false;
+  uint64_t profile_start = SEQ_PROFILE_START();
+
+  decode_job_t job = {.raw = raw, .signal = signal};
+  atomic_init(&job.next_chunk, 0);
+  atomic_init(&job.failed, false);
+
+  size_t max_threads = raw->num_chunks / FAST5_CHUNKS_PER_THREAD;
+  size_t num_threads = threads > 1 ? (size_t)threads : 1;
+  if (num_threads > max_threads) num_threads = max_threads > 0 ? max_threads : 1;
+
+  // The calling thread decodes alongside the helpers (a helper that cannot start is not needed)
+  pthread_t helpers[num_threads > 1 ? num_threads - 1 : 1];
+  size_t started = 0;
+  for (; started + 1 < num_threads; started++) {
+    if (pthread_create(&helpers[started], NULL, decode_worker, &job) != 0) break;
+  }
+  decode_worker(&job);
+  for (size_t t = 0; t < started; t++) pthread_join(helpers[t], NULL);
+
+  SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, profile_start);
+  return !atomic_load(&job.failed);
+}
+
+bool fast5_raw_signal_encode(const int16_t *signal, size_t length, size_t chunk_samples, bool shuffle, int level,
+                             fast5_raw_signal_t *raw) {
+  raw->num_chunks = 0;
+  if (length == 0 || level < 1 || level > 9) return false;
+
+  // Chunks longer than the read are not allowed on fixed-size datasets
+  raw->chunk_samples = chunk_samples > 0 && chunk_samples < length ? chunk_samples : length;
+  raw->length = length;
+  raw->shuffle_filter = shuffle ? 0 : -1;
+  raw->deflate_filter = shuffle ? 1 : 0;
+  raw->deflate_level = level;
+  raw->compression = "deflate-gzip";
+
+  size_t num_chunks = (length + raw->chunk_samples - 1) / raw->chunk_samples;
+  size_t chunk_bytes = raw->chunk_samples * sizeof(int16_t);
+  uint8_t *scratch = malloc(chunk_bytes);
+  if (!scratch || !reserve_chunks(raw, num_chunks)) {
+    free(scratch);
+    return false;
+  }
+
+  bool ok = true;
+  size_t used = 0;
+  for (size_t i = 0; i < num_chunks && ok; i++) {
+    // Edge chunks are stored full size (HDF5 pads them with the fill value, 0)
+    size_t first = i * raw->chunk_samples;
+    size_t count = length - first < raw->chunk_samples ? length - first : raw->chunk_samples;
+    if (shuffle) {
+      uint8_t *low = scratch;
+      uint8_t *high = scratch + raw->chunk_samples;
+      for (size_t j = 0; j < count; j++) {
+        uint16_t sample = (uint16_t)signal[first + j];
+        low[j] = (uint8_t)sample;
+        high[j] = (uint8_t)(sample >> 8);
+      }
+      memset(low + count, 0, raw->chunk_samples - count);
+      memset(high + count, 0, raw->chunk_samples - count);
+    } else if (host_little_endian()) {
+      memcpy(scratch, signal + first, count * sizeof(int16_t));
+      memset(scratch + count * sizeof(int16_t), 0, chunk_bytes - count * sizeof(int16_t));
+    } else {
+      // Written to little-endian datasets (H5T_STD_I16LE) whatever the host
+      for (size_t j = 0; j < count; j++) {
+        uint16_t sample = (uint16_t)signal[first + j];
+        scratch[2 * j] = (uint8_t)sample;
+        scratch[2 * j + 1] = (uint8_t)(sample >> 8);
+      }
+      memset(scratch + count * sizeof(int16_t), 0, chunk_bytes - count * sizeof(int16_t));
+    }
+
+    uLongf compressed = compressBound((uLong)chunk_bytes);
+    ok = reserve_data(raw, used + compressed) &&
+         compress2(raw->data + used, &compressed, scratch, (uLong)chunk_bytes, level) == Z_OK;
+    raw->offsets[i] = used;
+    raw->filter_masks[i] = 0;
+    used += compressed;
+  }
+  raw->offsets[num_chunks] = used;
+  free(scratch);
+  if (!ok) return false;
+  raw->num_chunks = num_chunks;
+  return true;
+}
+
+void fast5_raw_signal_free(fast5_raw_signal_t *raw) {
+  if (!raw) return;
+  free(raw->data);
+  free(raw->offsets);
+  free(raw->filter_masks);
+  memset(raw, 0, sizeof(*raw));
+}
@@ -0,0 +1,67 @@
+// **********************************************************************
+// core/fast5_chunks.h - Raw Signal Chunk Reads and Off-Lock Decompression
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// H5Dread inflates compressed chunks inside the library, under HDF5's global
+// lock in thread-safe builds (and under the caller's own HDF5 mutex
+// otherwise), so signal extraction stays on one core however many threads
+// ask. Here a Signal dataset's chunks are copied out still compressed with
+// H5Dread_chunk, one short library call per chunk, and decoded later with no
+// HDF5 calls at all, on as many threads as the caller likes.
+//
+// Decoded pipelines: int16 chunked Signals compressed with deflate, with or
+// without the byte shuffle in front (what MinKNOW wrote before VBZ, and what
+// sequelizer writes). Others (VBZ, szip, Fletcher32, contiguous storage) are
+// not fetched and stay with H5Dread, which needs their filter plugin anyway,
+// as does every Signal on a big-endian host. Encoded chunks are little-endian.
+#ifndef SEQUELIZER_FAST5_CHUNKS_H
+#define SEQUELIZER_FAST5_CHUNKS_H
+
+#include <hdf5.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Compressed chunks of one Signal, end to end; zero-initialise before the first
+// fetch and reuse across reads (buffers only grow)
+typedef struct {
+  const char *compression;   // fast5_metadata_t compression_method name ("deflate-gzip", "vbz", ...)
+  int shuffle_filter;        // Pipeline position of the byte shuffle, -1 if none
+  int deflate_filter;        // Pipeline position of deflate, -1 if none
+  int deflate_level;
+  size_t length;             // Samples in the dataset
+  size_t chunk_samples;
+  size_t num_chunks;
+
+  uint8_t *data;             // Chunk i is data[offsets[i], offsets[i + 1])
+  size_t data_capacity;
+  size_t *offsets;           // num_chunks + 1 entries
+  uint32_t *filter_masks;    // Per chunk: bit f set = filter f was skipped when writing
+  size_t chunk_capacity;
+} fast5_raw_signal_t;
+
+// Copy the chunks of a length-sample Signal dataset into raw (HDF5 calls; hold the
+// caller's HDF5 lock). raw->compression is set either way; false when the
+// pipeline is not one decoded here (read it with H5Dread) or the chunks cannot be read
+bool fast5_raw_signal_fetch(hid_t dataset_id, size_t length, fast5_raw_signal_t *raw);
+
+// Dataset creation properties reproducing raw's chunking and filters (caller closes), and
+// the direct write of its chunks into a dataset created with them (HDF5 calls; false on error)
+hid_t fast5_raw_signal_create_plist(const fast5_raw_signal_t *raw);
+bool  fast5_raw_signal_write(hid_t dataset_id, const fast5_raw_signal_t *raw);
+
+// Decode every fetched chunk into signal (raw->length int16 samples), splitting
+// the chunks across up to threads threads. No HDF5 calls, so no lock is needed;
+// false on corrupt chunks or out of memory
+bool fast5_raw_signal_decode(const fast5_raw_signal_t *raw, int16_t *signal, int threads);
+
+// The reverse, also without HDF5: compress length samples into chunk_samples-sample
+// chunks (clamped to the read; 0 = one chunk) with deflate at level 1-9, byte-shuffled
+// first if asked, ready for fast5_raw_signal_write. False if out of memory
+bool fast5_raw_signal_encode(const int16_t *signal, size_t length, size_t chunk_samples, bool shuffle, int level,
+                             fast5_raw_signal_t *raw);
+
+void fast5_raw_signal_free(fast5_raw_signal_t *raw);
+
+#endif // SEQUELIZER_FAST5_CHUNKS_H
@@ -6,7 +6,17 @@
 
 #include "fast5_convert.h"
 #include "fast5_io.h"
+#include "fast5_index.h"
 #include "util.h"
+#include "seq_output.h"
+#include "seq_chunk.h"
+#include "seq_memory.h"
+#include "seq_pipeline.h"
+#include "seq_profile.h"
+#include "columnar_writer.h"
+#include <inttypes.h>
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,6 +24,7 @@
 #include <errno.h>
 #include <err.h>
 #include <hdf5.h>
+#include <pthread.h>
 
 // **********************************************************************
 // Utility Functions
@@ -40,42 +51,18 @@ static void try_filename_channel_extraction(const char *filename, fast5_metadata
 }
 
 // Simple enhancer to extract channel number from Fast5 files
-static void extract_channel_number(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
+static void extract_channel_number(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
   // Initialize
   metadata->channel_number = NULL;
-  
-  if (signal_dataset_id < 0) return;
-  
-  // Get the dataset path to determine format
-  char obj_name[256];
-  ssize_t name_len = H5Iget_name(signal_dataset_id, obj_name, sizeof(obj_name));
-  if (name_len <= 0) return;
-  
-  
-  
-  hid_t channel_group_id = -1;
-  
-  if (strstr(obj_name, "/Raw/Reads/")) {
-    // Single-read format: /Raw/Reads/Read_xxx/Signal -> /UniqueGlobalKey/channel_id
-    channel_group_id = H5Gopen2(file_id, "/UniqueGlobalKey/channel_id", H5P_DEFAULT);
-  } else if (strstr(obj_name, "/Raw/Signal")) {
-    // Multi-read format: /read_<UUID>/Raw/Signal -> /read_<UUID>/channel_id
-    char channel_path[512];
-    char *read_part = strstr(obj_name, "/read_");
-    if (read_part) {
-      char *raw_part = strstr(read_part, "/Raw");
-      if (raw_part) {
-        size_t read_len = raw_part - obj_name;
-        snprintf(channel_path, sizeof(channel_path), "%.*s/channel_id", (int)read_len, obj_name);
-        channel_group_id = H5Gopen2(file_id, channel_path, H5P_DEFAULT);
-      }
-    }
-  }
+
+  // Single-read: /UniqueGlobalKey/channel_id; multi-read: /read_<UUID>/channel_id
+  hid_t channel_group_id = read->channel_group_id;
   
   if (channel_group_id >= 0) {
     // Try to read channel_number attribute
     hid_t attr_id = H5Aopen(channel_group_id, "channel_number", H5P_DEFAULT);
     if (attr_id >= 0) {
+      SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);   // One H5Aread whichever encoding it has
       hid_t attr_type = H5Aget_type(attr_id);
       H5T_class_t type_class = H5Tget_class(attr_type);
       
@@ -144,64 +131,93 @@ static void extract_channel_number(hid_t file_id, hid_t signal_dataset_id, fast5
       H5Tclose(attr_type);
       H5Aclose(attr_id);
     }
-    H5Gclose(channel_group_id);
   }
 }
 
 // Combined enhancer that extracts both channel number and calibration parameters
-static void extract_channel_and_calibration_combined(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
+// (both read the read's channel_id group, opened once by the reader)
+static void extract_channel_and_calibration_combined(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
   // First extract channel number using existing function
-  extract_channel_number(file_id, signal_dataset_id, metadata);
+  extract_channel_number(read, metadata);
   
   // Then extract calibration parameters using the new function from fast5_io.c
-  extract_calibration_parameters(file_id, signal_dataset_id, metadata);
+  extract_calibration_parameters(read, metadata);
 }
 
-int write_signal_to_file(const char *filename, float *signal, size_t signal_length, const fast5_metadata_t *metadata) {
+// Per-file output buffer: sized to the signal so small reads don't allocate a full block
+static size_t signal_buffer_size(size_t signal_length) {
+  size_t estimate = signal_length * 16 + 4096;   // "<index>\t<sample>\n" plus header
+  return estimate < SEQ_OUTPUT_BUFFER_SIZE ? estimate : SEQ_OUTPUT_BUFFER_SIZE;
+}
+
+int write_signal_to_file(const char *filename, const int16_t *signal, size_t signal_length,
+                         const fast5_metadata_t *metadata, seq_output_format format) {
   FILE *f = fopen(filename, "w");
   if (!f) {
     warnx("Cannot create output file: %s", filename);
     return EXIT_FAILURE;
   }
-  
-  // Write metadata header if available
-  if (metadata) {
-    // Channel information
-    if (metadata->channel_number) {
-      fprintf(f, "# Channel: %s\n", metadata->channel_number);
-    }
-    
-    // Calibration parameters (if available)
-    if (metadata->calibration_available) {
-      fprintf(f, "# Offset: %.6f\n", metadata->offset);
-      fprintf(f, "# Range: %.6f\n", metadata->range);
-      fprintf(f, "# Digitisation: %.6f\n", metadata->digitisation);
-      fprintf(f, "# Conversion: signal_pA = (raw_signal + offset) * range / digitisation\n");
-    }
-    
-    // Additional metadata
-    if (metadata->sample_rate > 0) {
-      fprintf(f, "# Sample Rate: %.1f\n", metadata->sample_rate);
+
+  seq_output_t out;
+  if (!seq_output_init(&out, f, signal_buffer_size(signal_length))) {
+    warnx("Memory allocation failed for output buffer: %s", filename);
+    fclose(f);
+    return EXIT_FAILURE;
+  }
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  if (format == SEQ_OUTPUT_BIN) {
+    // Binary: the raw int16 ADC samples, little-endian, nothing else
+    seq_output_i16le(&out, signal, signal_length);
+  } else {
+    // Write metadata header if available
+    if (metadata) {
+      // Channel information
+      if (metadata->channel_number) {
+        seq_output_printf(&out, "# Channel: %s\n", metadata->channel_number);
+      }
+
+      // Calibration parameters (if available)
+      if (metadata->calibration_available) {
+        seq_output_printf(&out, "# Offset: %.6f\n", metadata->offset);
+        seq_output_printf(&out, "# Range: %.6f\n", metadata->range);
+        seq_output_printf(&out, "# Digitisation: %.6f\n", metadata->digitisation);
+        seq_output_str(&out, "# Conversion: signal_pA = (raw_signal + offset) * range / digitisation\n");
+      }
+
+      // Additional metadata
+      if (metadata->sample_rate > 0) {
+        seq_output_printf(&out, "# Sample Rate: %.1f\n", metadata->sample_rate);
+      }
+
+      if (metadata->read_id) {
+        seq_output_printf(&out, "# Read ID: %s\n", metadata->read_id);
+      }
+
+      // Separator line
+      seq_output_str(&out, "#\n");
     }
-    
-    if (metadata->read_id) {
-      fprintf(f, "# Read ID: %s\n", metadata->read_id);
+
+    // Write column headers
+    seq_output_str(&out, "sample_index\traw_sample\n");
+
+    // Write signal data in two-column format
+    for (size_t i = 0; i < signal_length; i++) {
+      // Raw ADC values are read natively as int16, no float round trip
+      seq_output_uint(&out, i);
+      seq_output_char(&out, '\t');
+      seq_output_int(&out, signal[i]);
+      seq_output_char(&out, '\n');
     }
-    
-    // Separator line
-    fprintf(f, "#\n");
   }
-  
-  // Write column headers
-  fprintf(f, "sample_index\traw_sample\n");
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FORMAT, profile_start);
 
-  // Write signal data in two-column format
-  for (size_t i = 0; i < signal_length; i++) {
-    // Raw ADC values are integers, so cast and print without decimals
-    fprintf(f, "%zu\t%d\n", i, (int)signal[i]);
+  int status = seq_output_close(&out);
+  if (fclose(f) != 0) status = -1;
+  if (status < 0) {
+    warnx("Failed to write output file: %s", filename);
+    return EXIT_FAILURE;
   }
-  
-  fclose(f);
   return EXIT_SUCCESS;
 }
 
@@ -222,12 +238,75 @@ int create_directory(const char *path) {
   return EXIT_SUCCESS;
 }
 
+// Attribute name/value pairs of Fast5 groups as text (first occurrence of a name wins)
+typedef struct {
+  char **keys;
+  char **values;
+  size_t count;
+} text_attrs_t;
+
+static void free_text_attrs(text_attrs_t *attrs) {
+  for (size_t a = 0; a < attrs->count; a++) {
+    free(attrs->keys[a]);
+    free(attrs->values[a]);
+  }
+  free(attrs->keys);
+  free(attrs->values);
+  memset(attrs, 0, sizeof(*attrs));
+}
+
+// H5Aiterate callback: keep each attribute (first occurrence of a key wins)
+static herr_t collect_text_attribute(hid_t location, const char *name, const H5A_info_t *info, void *data) {
+  (void)info;
+  text_attrs_t *attrs = data;
+  for (size_t i = 0; i < attrs->count; i++) {
+    if (strcmp(attrs->keys[i], name) == 0) return 0;
+  }
+  char *value = fast5_attribute_text(location, name);
+  if (!value) return 0;
+
+  char **keys = realloc(attrs->keys, (attrs->count + 1) * sizeof(char*));
+  char **values = keys ? realloc(attrs->values, (attrs->count + 1) * sizeof(char*)) : NULL;
+  if (keys) attrs->keys = keys;
+  if (values) attrs->values = values;
+  char *key = strdup(name);
+  if (!keys || !values || !key) {
+    errx(EXIT_FAILURE, "Memory allocation failed for Fast5 attributes");
+  }
+  attrs->keys[attrs->count] = key;
+  attrs->values[attrs->count++] = value;
+  return 0;
+}
+
+static void collect_group_attributes(hid_t parent_id, const char *name, text_attrs_t *attrs) {
+  if (parent_id < 0 || H5Lexists(parent_id, name, H5P_DEFAULT) <= 0) return;
+  hid_t group_id = H5Gopen2(parent_id, name, H5P_DEFAULT);
+  if (group_id < 0) return;
+  hsize_t position = 0;
+  H5Aiterate2(group_id, H5_INDEX_NAME, H5_ITER_INC, &position, collect_text_attribute, attrs);
+  H5Gclose(group_id);
+}
+
+// Attributes of the named key group (tracking_id, context_tags) of the read last returned by
+// the reader: /read_<id>/<name> (multi-read) or /UniqueGlobalKey/<name> (single-read)
+static void collect_read_attributes(fast5_reader_t *reader, const char *name, text_attrs_t *attrs) {
+  hid_t file_id = fast5_reader_file_id(reader);
+  const char *parent = fast5_reader_is_multi_read(reader) ? fast5_reader_location(reader, NULL) : "/UniqueGlobalKey";
+  fast5_hdf5_quiet_begin();
+  hid_t parent_id = parent && H5Lexists(file_id, parent, H5P_DEFAULT) > 0 ? H5Gopen2(file_id, parent, H5P_DEFAULT) : -1;
+  collect_group_attributes(parent_id, name, attrs);
+  if (parent_id >= 0) H5Gclose(parent_id);
+  fast5_hdf5_quiet_end();
+}
+
 // **********************************************************************
 // Signal Extraction Functions
 // **********************************************************************
 
-int extract_raw_signals(char **files, size_t file_count, const char *output_file, 
-                         bool all_reads, bool verbose) {
+int extract_raw_signals(char **files, size_t file_count, const char *output_file,
+                        bool all_reads, seq_output_format format, bool verbose) {
+  const char *ext = seq_output_format_extension(format);
+
   if (verbose) {
     printf("Converting %zu files to raw format...\n", file_count);
   }
@@ -242,31 +321,25 @@ int extract_raw_signals(char **files, size_t file_count, const char *output_file
       printf("Processing file: %s\n", files[i]);
     }
     
-    // Read metadata to determine format and get read IDs with channel numbers and calibration
-    size_t metadata_count = 0;
-    fast5_metadata_t *metadata = read_fast5_metadata_with_enhancer(files[i], &metadata_count, extract_channel_and_calibration_combined);
-    
-    if (!metadata || metadata_count == 0) {
+    // Open once: metadata (with channel numbers and calibration) and signal come from one pass
+    fast5_reader_t *reader = fast5_reader_open(files[i], extract_channel_and_calibration_combined);
+    size_t read_count = fast5_reader_num_reads(reader);
+
+    if (!reader || read_count == 0) {
       warnx("Cannot read metadata from file: %s", files[i]);
+      fast5_reader_close(reader);
       continue;
     }
     
-    // Try filename extraction as fallback for any missing channel numbers
-    for (size_t j = 0; j < metadata_count; j++) {
-      if (!metadata[j].channel_number) {
-        try_filename_channel_extraction(files[i], &metadata[j]);
-      }
-    }
-    
     // Handle single-read vs multi-read files
-    bool is_multi_read = metadata[0].is_multi_read;
-    size_t reads_to_process = metadata_count;
+    bool is_multi_read = fast5_reader_is_multi_read(reader);
+    size_t reads_to_process = read_count;
     
     // For multi-read files, limit to first 3 reads unless --all specified
-    if (is_multi_read && !all_reads && metadata_count > 3) {
+    if (is_multi_read && !all_reads && read_count > 3) {
       reads_to_process = 3;
       if (verbose) {
-        printf("  Multi-read file: processing first 3 of %zu reads (use --all for all)\n", metadata_count);
+        printf("  Multi-read file: processing first 3 of %zu reads (use --all for all)\n", read_count);
       }
     }
     
@@ -284,22 +357,29 @@ int extract_raw_signals(char **files, size_t file_count, const char *output_file
       // Don't create directory for single single-read files (they use exact filename)
       if (file_count > 1 || (file_count == 1 && is_multi_read)) {
         if (create_directory(output_file) != EXIT_SUCCESS) {
-          free_fast5_metadata(metadata, metadata_count);
+          fast5_reader_close(reader);
           continue;
         }
       }
     }
     
     // Extract signals
-    for (size_t j = 0; j < reads_to_process; j++) {
+    fast5_metadata_t metadata = {0};
+    for (size_t j = 0; j < reads_to_process && fast5_reader_next(reader, &metadata, true) > 0; j++) {
+      // Try filename extraction as fallback for a missing channel number
+      if (!metadata.channel_number) {
+        try_filename_channel_extraction(files[i], &metadata);
+      }
+
       size_t signal_length = 0;
-      float *signal = read_fast5_signal(files[i], metadata[j].read_id, &signal_length);
+      const int16_t *signal = fast5_reader_signal(reader, &signal_length);
       
       if (!signal || signal_length == 0) {
         if (verbose) {
           printf("  Failed to extract signal for read: %s\n", 
-                 metadata[j].read_id ? metadata[j].read_id : "unknown");
+                 metadata.read_id ? metadata.read_id : "unknown");
         }
+        clear_fast5_metadata(&metadata);
         continue;
       }
       
@@ -315,46 +395,46 @@ int extract_raw_signals(char **files, size_t file_count, const char *output_file
         if (output_file) {
           if (is_multi_read) {
             // Single multi-read file: treat output as directory
-            snprintf(output_filename, sizeof(output_filename), "%s/read_ch%s_rd%u.txt",
+            snprintf(output_filename, sizeof(output_filename), "%s/read_ch%s_rd%u%s",
                      output_file,
-                     metadata[j].channel_number ? metadata[j].channel_number : "unknown",
-                     metadata[j].read_number);
+                     metadata.channel_number ? metadata.channel_number : "unknown",
+                     metadata.read_number, ext);
           } else {
             // Single single-read file: treat output as exact filename
             snprintf(output_filename, sizeof(output_filename), "%s", output_file);
           }
         } else {
           // No output specified: simple naming
-          snprintf(output_filename, sizeof(output_filename), "read_ch%s_rd%u.txt",
-                   metadata[j].channel_number ? metadata[j].channel_number : "unknown",
-                   metadata[j].read_number);
+          snprintf(output_filename, sizeof(output_filename), "read_ch%s_rd%u%s",
+                   metadata.channel_number ? metadata.channel_number : "unknown",
+                   metadata.read_number, ext);
         }
       } else {
         // Multiple file processing: always add filename prefix for traceability
         if (output_file) {
           // Multiple files to output directory: output_dir/originalfile_read_ch228_rd123.txt
-          snprintf(output_filename, sizeof(output_filename), "%s/%.*s_read_ch%s_rd%u.txt",
+          snprintf(output_filename, sizeof(output_filename), "%s/%.*s_read_ch%s_rd%u%s",
                    output_file,
                    (int)(strstr(basename, ".fast5") - basename), basename,
-                   metadata[j].channel_number ? metadata[j].channel_number : "unknown",
-                   metadata[j].read_number);
+                   metadata.channel_number ? metadata.channel_number : "unknown",
+                   metadata.read_number, ext);
         } else {
           // Multiple files to current directory: originalfile_read_ch228_rd123.txt
-          snprintf(output_filename, sizeof(output_filename), "%.*s_read_ch%s_rd%u.txt",
+          snprintf(output_filename, sizeof(output_filename), "%.*s_read_ch%s_rd%u%s",
                    (int)(strstr(basename, ".fast5") - basename), basename,
-                   metadata[j].channel_number ? metadata[j].channel_number : "unknown",
-                   metadata[j].read_number);
+                   metadata.channel_number ? metadata.channel_number : "unknown",
+                   metadata.read_number, ext);
         }
       }
       
       // Write signal to file with metadata header
-      if (write_signal_to_file(output_filename, signal, signal_length, &metadata[j]) == EXIT_SUCCESS) {
+      if (write_signal_to_file(output_filename, signal, signal_length, &metadata, format) == EXIT_SUCCESS) {
         if (verbose) {
           printf("  Wrote %zu samples to: %s\n", signal_length, output_filename);
         }
       }
       
-      free_fast5_signal(signal);
+      clear_fast5_metadata(&metadata);
       
       // Update read progress for single multi-read file
       if (show_read_progress) {
@@ -367,7 +447,7 @@ int extract_raw_signals(char **files, size_t file_count, const char *output_file
       printf("\n");
     }
     
-    free_fast5_metadata(metadata, metadata_count);
+    fast5_reader_close(reader);
     
     // Update progress bar (only for multiple files)
     if (file_count > 1) {
@@ -383,60 +463,1383 @@ int extract_raw_signals(char **files, size_t file_count, const char *output_file
   return EXIT_SUCCESS;
 }
 
+// Extract a single read by id using the read-id index (sidecar reused for directory inputs)
+int extract_raw_signal_by_id(char **files, size_t file_count, const char *input_path,
+                             const char *read_id, const char *output_file,
+                             seq_output_format format, bool verbose) {
+  char *sidecar_path = fast5_index_sidecar_path(input_path);
+  fast5_index_t *index = fast5_index_build(files, file_count, sidecar_path, verbose);
+  free(sidecar_path);
+  if (!index) {
+    warnx("Cannot build read index for: %s", input_path);
+    return EXIT_FAILURE;
+  }
+
+  const fast5_index_entry_t *entry = fast5_index_lookup(index, read_id);
+  if (!entry) {
+    warnx("Read not found: %s", read_id);
+    fast5_index_free(index);
+    return EXIT_FAILURE;
+  }
+
+  seq_tensor *signal = fast5_index_read_signal(index, read_id);
+  size_t signal_length = signal ? seq_tensor_dim(signal, 0) : 0;
+  if (!signal || signal_length == 0) {
+    seq_tensor_free(signal);
+    warnx("Failed to extract signal for read: %s", read_id);
+    fast5_index_free(index);
+    return EXIT_FAILURE;
+  }
+
+  // Default output name: <read_id>.txt (.bin for binary output)
+  char output_filename[512];
+  if (output_file) {
+    snprintf(output_filename, sizeof(output_filename), "%s", output_file);
+  } else {
+    snprintf(output_filename, sizeof(output_filename), "%s%s", read_id, seq_output_format_extension(format));
+  }
+
+  fast5_metadata_t metadata = {0};
+  metadata.read_id = (char *)read_id;
+
+  int result = write_signal_to_file(output_filename, seq_tensor_data_int16(signal), signal_length, &metadata, format);
+  if (result == EXIT_SUCCESS && verbose) {
+    printf("  Wrote %zu samples from %s%s to: %s\n", signal_length,
+           index->files[entry->file_index].path, entry->group_path, output_filename);
+  }
+
+  seq_tensor_free(signal);
+  fast5_index_free(index);
+  return result;
+}
+
 // **********************************************************************
-// Metadata Extraction Functions
+// SLOW5/BLOW5 Export
 // **********************************************************************
 
-int extract_metadata(char **files, size_t file_count, const char *output_file, bool verbose) {
+// Encoded bytes handed to the writer at a time, and the most allowed to wait
+// for it (files ahead of the one being written stall past this, or past a
+// smaller --max-memory budget)
+#define SLOW5_BATCH_BYTES (4u << 20)
+#define SLOW5_MAX_PENDING_BYTES (256u << 20)
+
+static size_t slow5_pending_limit(void) {
+  size_t budget = seq_memory_budget();
+  return budget > 0 && budget < SLOW5_MAX_PENDING_BYTES ? budget : SLOW5_MAX_PENDING_BYTES;
+}
+
+// Records encoded by one worker, in read order
+typedef struct slow5_batch {
+  slow5_buffer_t records;
+  char **read_ids;
+  size_t *sizes;
+  size_t count;
+  size_t capacity;
+  struct slow5_batch *next;
+} slow5_batch_t;
+
+// Per input file: header attributes (first pass), then its queue of batches
+typedef struct {
+  bool probed;             // First read found by the header pass
+  char *run_id;
+  text_attrs_t attrs;      // tracking_id and context_tags
+  uint32_t read_group;
+  slow5_batch_t *head;
+  slow5_batch_t *tail;
+  bool done;               // Worker has published the file's last batch
+  size_t reads;
+  size_t failed;
+} slow5_file_slot_t;
+
+typedef struct {
+  char **files;
+  size_t file_count;
+  slow5_file_slot_t *slots;
+  const slow5_options_t *options;
+  char **group_run_ids;    // run_id of each read group (NULL for reads without one)
+  uint32_t num_groups;
+  size_t next_file;        // Next file for a worker to claim
+  size_t writer_file;      // File the writer is draining; its worker never waits
+  size_t pending_bytes;
+  pthread_mutex_t lock;
+  pthread_cond_t batch_ready;
+  pthread_cond_t space_ready;
+  pthread_mutex_t *hdf5_mutex;   // Non-NULL only when HDF5 is not thread-safe
+} slow5_export_t;
+
+// Channel number, calibration, run_id, median_before and start_time in one visit
+static void extract_slow5_fields(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
+  extract_channel_number(read, metadata);
+  extract_calibration_parameters(read, metadata);
+  extract_tracking_id(read, metadata);
+  extract_raw(read, metadata);
+}
+
+static void hdf5_lock(slow5_export_t *export) {
+  if (export->hdf5_mutex) pthread_mutex_lock(export->hdf5_mutex);
+}
+
+static void hdf5_unlock(slow5_export_t *export) {
+  if (export->hdf5_mutex) pthread_mutex_unlock(export->hdf5_mutex);
+}
+
+static size_t claim_file(slow5_export_t *export) {
+  pthread_mutex_lock(&export->lock);
+  size_t index = export->next_file < export->file_count ? export->next_file++ : SIZE_MAX;
+  pthread_mutex_unlock(&export->lock);
+  return index;
+}
+
+// First pass: run_id and tracking_id/context_tags attributes of each file's first
+// read. Runs are per file in MinKNOW output, so these seed the read groups
+static void* slow5_header_worker(void *arg) {
+  slow5_export_t *export = arg;
+  size_t index;
+  while ((index = claim_file(export)) != SIZE_MAX) {
+    slow5_file_slot_t *slot = &export->slots[index];
+
+    hdf5_lock(export);
+    fast5_reader_t *reader = fast5_reader_open(export->files[index], extract_tracking_id);
+    fast5_metadata_t metadata = {0};
+    if (reader && fast5_reader_next(reader, &metadata, false) > 0) {
+      slot->probed = true;
+      slot->run_id = metadata.run_id;
+      metadata.run_id = NULL;
+
+      collect_read_attributes(reader, "tracking_id", &slot->attrs);
+      collect_read_attributes(reader, "context_tags", &slot->attrs);
+      clear_fast5_metadata(&metadata);
+    }
+    fast5_reader_close(reader);
+    hdf5_unlock(export);
+  }
+  return NULL;
+}
+
+// Read groups in first-seen order of run_id; group attributes come from the
+// first file of each run. Unreadable files join group 0 rather than adding one
+static slow5_header_t* build_slow5_header(slow5_export_t *export) {
+  slow5_header_t *header = slow5_header_create();
+  if (!header) {
+    errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 header");
+  }
+  export->group_run_ids = calloc(export->file_count, sizeof(char*));
+  if (!export->group_run_ids) {
+    errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 header");
+  }
+
+  for (size_t i = 0; i < export->file_count; i++) {
+    slow5_file_slot_t *slot = &export->slots[i];
+    if (!slot->probed) continue;
+    uint32_t group = 0;
+    while (group < export->num_groups &&
+           !(slot->run_id ? export->group_run_ids[group] && strcmp(export->group_run_ids[group], slot->run_id) == 0
+                          : export->group_run_ids[group] == NULL)) {
+      group++;
+    }
+    if (group == export->num_groups) {
+      group = slow5_header_add_group(header);
+      if (group == SLOW5_NO_GROUP) {
+        errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 header");
+      }
+      export->group_run_ids[group] = slot->run_id;
+      export->num_groups++;
+      for (size_t a = 0; a < slot->attrs.count; a++) {
+        slow5_header_set(header, group, slot->attrs.keys[a], slot->attrs.values[a]);
+      }
+    }
+    slot->read_group = group;
+  }
+
+  // A run of files none of which could be read still needs one group
+  if (export->num_groups == 0) {
+    if (slow5_header_add_group(header) == SLOW5_NO_GROUP) {
+      errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 header");
+    }
+    export->num_groups = 1;
+  }
+  return header;
+}
+
+static uint32_t find_read_group(const slow5_export_t *export, const char *run_id, uint32_t fallback) {
+  if (!run_id) return fallback;
+  for (uint32_t group = 0; group < export->num_groups; group++) {
+    if (export->group_run_ids[group] && strcmp(export->group_run_ids[group], run_id) == 0) return group;
+  }
+  return fallback;
+}
+
+static void free_batch(slow5_batch_t *batch) {
+  if (!batch) return;
+  for (size_t i = 0; i < batch->count; i++) {
+    free(batch->read_ids[i]);
+  }
+  free(batch->read_ids);
+  free(batch->sizes);
+  slow5_buffer_free(&batch->records);
+  free(batch);
+}
+
+static slow5_batch_t* new_batch(void) {
+  slow5_batch_t *batch = calloc(1, sizeof(slow5_batch_t));
+  if (!batch) {
+    errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 records");
+  }
+  return batch;
+}
+
+static void batch_add(slow5_batch_t *batch, const char *read_id, size_t size) {
+  if (batch->count == batch->capacity) {
+    size_t capacity = batch->capacity ? batch->capacity * 2 : 64;
+    char **ids = realloc(batch->read_ids, capacity * sizeof(char*));
+    size_t *sizes = ids ? realloc(batch->sizes, capacity * sizeof(size_t)) : NULL;
+    if (ids) batch->read_ids = ids;
+    if (sizes) batch->sizes = sizes;
+    if (!ids || !sizes) {
+      errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 records");
+    }
+    batch->capacity = capacity;
+  }
+  batch->read_ids[batch->count] = strdup(read_id);
+  if (!batch->read_ids[batch->count]) {
+    errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 records");
+  }
+  batch->sizes[batch->count++] = size;
+}
+
+// Hand a batch to the writer. Files ahead of the writer wait while too much is
+// queued; the file being written never does, so the pipeline cannot deadlock
+static void publish_batch(slow5_export_t *export, size_t index, slow5_batch_t *batch, bool last) {
+  pthread_mutex_lock(&export->lock);
+  if (batch) {
+    if (index != export->writer_file && export->pending_bytes >= slow5_pending_limit()) {
+      uint64_t stall_start = seq_profile_now_ns();
+      while (index != export->writer_file && export->pending_bytes >= slow5_pending_limit()) {
+        pthread_cond_wait(&export->space_ready, &export->lock);
+      }
+      seq_memory_record_stall(seq_profile_now_ns() - stall_start);
+    }
+    slow5_file_slot_t *slot = &export->slots[index];
+    if (slot->tail) {
+      slot->tail->next = batch;
+    } else {
+      slot->head = batch;
+    }
+    slot->tail = batch;
+    export->pending_bytes += batch->records.size;
+    seq_memory_reserve(batch->records.size);
+  }
+  if (last) export->slots[index].done = true;
+  pthread_cond_broadcast(&export->batch_ready);
+  pthread_mutex_unlock(&export->lock);
+}
+
+// Second pass: read (under the HDF5 lock if needed), decompress and encode every read
+static void* slow5_record_worker(void *arg) {
+  slow5_export_t *export = arg;
+  size_t index;
+  while ((index = claim_file(export)) != SIZE_MAX) {
+    slow5_file_slot_t *slot = &export->slots[index];
+    const char *filename = export->files[index];
+    bool warned_run = false;
+
+    hdf5_lock(export);
+    fast5_reader_t *reader = fast5_reader_open(filename, extract_slow5_fields);
+    hdf5_unlock(export);
+    if (!reader) {
+      warnx("Cannot read metadata from file: %s", filename);
+      publish_batch(export, index, NULL, true);
+      continue;
+    }
+
+    // Only the raw chunk fetch holds the HDF5 lock; inflating runs in parallel
+    fast5_reader_defer_decode(reader, true);
+
+    slow5_batch_t *batch = new_batch();
+    fast5_metadata_t metadata = {0};
+    while (true) {
+      hdf5_lock(export);
+      int status = fast5_reader_next(reader, &metadata, true);
+      hdf5_unlock(export);
+      if (status <= 0) break;
+      if (!fast5_reader_decode_signal(reader)) {
+        warnx("Cannot decompress the signal of read %s in %s", metadata.read_id ? metadata.read_id : "unknown",
+              filename);
+      }
+
+      if (!metadata.channel_number) {
+        try_filename_channel_extraction(filename, &metadata);
+      }
+      size_t signal_length = 0;
+      const int16_t *signal = fast5_reader_signal(reader, &signal_length);
+
+      uint32_t read_group = find_read_group(export, metadata.run_id, slot->read_group);
+      if (metadata.run_id && read_group == slot->read_group && slot->run_id &&
+          strcmp(metadata.run_id, slot->run_id) != 0 && !warned_run) {
+        warnx("%s mixes runs: reads of run %s are labelled with read group %u", filename, metadata.run_id, read_group);
+        warned_run = true;
+      }
+
+      slow5_record_t record = {
+        .read_id = metadata.read_id,
+        .read_group = read_group,
+        .digitisation = metadata.digitisation,
+        .offset = metadata.offset,
+        .range = metadata.range,
+        .sampling_rate = metadata.sample_rate,
+        .signal = signal,
+        .signal_length = signal ? signal_length : 0,
+        .channel_number = metadata.channel_number,
+        .has_median_before = metadata.pore_level_available,
+        .median_before = metadata.median_before,
+        .has_read_number = true,
+        .read_number = (int32_t)metadata.read_number,
+        .has_start_time = true,
+        .start_time = metadata.start_time
+      };
+      size_t size = 0;
+      if (!metadata.read_id || slow5_encode_record(export->options, &record, &batch->records, &size) < 0) {
+        slot->failed++;
+      } else {
+        batch_add(batch, metadata.read_id, size);
+        slot->reads++;
+      }
+      clear_fast5_metadata(&metadata);
+
+      if (batch->records.size >= SLOW5_BATCH_BYTES) {
+        publish_batch(export, index, batch, false);
+        batch = new_batch();
+      }
+    }
+
+    hdf5_lock(export);
+    fast5_reader_close(reader);
+    hdf5_unlock(export);
+
+    if (batch->count > 0) {
+      publish_batch(export, index, batch, true);
+    } else {
+      free_batch(batch);
+      publish_batch(export, index, NULL, true);
+    }
+  }
+  return NULL;
+}
+
+static void start_workers(pthread_t *threads, int num_threads, void *(*worker)(void*), slow5_export_t *export) {
+  for (int t = 0; t < num_threads; t++) {
+    if (pthread_create(&threads[t], NULL, worker, export) != 0) {
+      errx(EXIT_FAILURE, "Failed to create worker thread %d", t);
+    }
+  }
+}
+
+static void join_workers(pthread_t *threads, int num_threads) {
+  for (int t = 0; t < num_threads; t++) {
+    pthread_join(threads[t], NULL);
+  }
+}
+
+// Drain the batches file by file, in input order, into the writer
+static int write_slow5_records(slow5_export_t *export, slow5_writer_t *writer, bool verbose) {
+  int status = 0;
+  for (size_t i = 0; i < export->file_count; i++) {
+    slow5_file_slot_t *slot = &export->slots[i];
+    while (true) {
+      pthread_mutex_lock(&export->lock);
+      while (!slot->head && !slot->done) {
+        pthread_cond_wait(&export->batch_ready, &export->lock);
+      }
+      slow5_batch_t *batch = slot->head;
+      if (batch) {
+        slot->head = batch->next;
+        if (!slot->head) slot->tail = NULL;
+      }
+      pthread_mutex_unlock(&export->lock);
+      if (!batch) break;
+
+      const uint8_t *record = batch->records.data;
+      for (size_t r = 0; r < batch->count; r++) {
+        if (slow5_writer_write(writer, batch->read_ids[r], record, batch->sizes[r]) < 0) status = -1;
+        record += batch->sizes[r];
+      }
+
+      pthread_mutex_lock(&export->lock);
+      export->pending_bytes -= batch->records.size;
+      pthread_cond_broadcast(&export->space_ready);
+      pthread_mutex_unlock(&export->lock);
+      seq_memory_release(batch->records.size);
+      free_batch(batch);
+    }
+
+    if (verbose) {
+      printf("  %s: %zu reads", export->files[i], slot->reads);
+      if (slot->failed > 0) printf(" (%zu failed)", slot->failed);
+      printf("\n");
+    }
+
+    // Release the next file's worker from any wait for space
+    pthread_mutex_lock(&export->lock);
+    export->writer_file = i + 1;
+    pthread_cond_broadcast(&export->space_ready);
+    pthread_mutex_unlock(&export->lock);
+
+    if (export->file_count > 1) {
+      display_progress_simple((int)(i + 1), (int)export->file_count, verbose, "converting files");
+    }
+  }
+  if (export->file_count > 1) {
+    printf("\n");
+  }
+  return status;
+}
+
+int export_slow5(char **files, size_t file_count, const char *output_file,
+                 const slow5_options_t *options, int num_threads, bool verbose) {
+  if (!files || file_count == 0 || !output_file || !options) return EXIT_FAILURE;
+  if (num_threads < 1) num_threads = 1;
+  if ((size_t)num_threads > file_count) num_threads = (int)file_count;
+
+  slow5_export_t export = {0};
+  export.files = files;
+  export.file_count = file_count;
+  export.options = options;
+  export.slots = calloc(file_count, sizeof(slow5_file_slot_t));
+  pthread_t *threads = calloc((size_t)num_threads, sizeof(pthread_t));
+  if (!export.slots || !threads) {
+    errx(EXIT_FAILURE, "Memory allocation failed for SLOW5 export");
+  }
+  pthread_mutex_init(&export.lock, NULL);
+  pthread_cond_init(&export.batch_ready, NULL);
+  pthread_cond_init(&export.space_ready, NULL);
+
+  // Non-thread-safe HDF5 builds: serialise only the HDF5 calls, encoding runs in parallel
+  pthread_mutex_t hdf5_mutex;
+  if (num_threads > 1 && !fast5_hdf5_is_threadsafe()) {
+    pthread_mutex_init(&hdf5_mutex, NULL);
+    export.hdf5_mutex = &hdf5_mutex;
+  }
+
   if (verbose) {
-    printf("Converting %zu files to metadata format...\n", file_count);
+    printf("Converting %zu files to %s with %d worker thread%s...\n", file_count,
+           options->format == SLOW5_FORMAT_BINARY ? "BLOW5" : "SLOW5", num_threads, num_threads == 1 ? "" : "s");
   }
-  
-  FILE *output = stdout;
-  if (output_file) {
-    output = fopen(output_file, "w");
-    if (!output) {
-      warnx("Cannot create output file: %s", output_file);
-      return EXIT_FAILURE;
+
+  // Pass 1: header attributes and read groups
+  start_workers(threads, num_threads, slow5_header_worker, &export);
+  join_workers(threads, num_threads);
+  slow5_header_t *header = build_slow5_header(&export);
+
+  int result = EXIT_FAILURE;
+  slow5_writer_t *writer = slow5_writer_open(output_file, options, header);
+  if (writer) {
+    // Pass 2: workers decode and encode, this thread writes in input order
+    export.next_file = 0;
+    if (file_count > 1) {
+      display_progress_simple(0, (int)file_count, verbose, "converting files");
+    }
+    start_workers(threads, num_threads, slow5_record_worker, &export);
+    int status = write_slow5_records(&export, writer, verbose);
+    join_workers(threads, num_threads);
+
+    size_t records = slow5_writer_records_written(writer);
+    if (slow5_writer_close(writer) < 0) status = -1;
+    if (status == 0) {
+      result = EXIT_SUCCESS;
+      if (verbose) {
+        printf("Wrote %zu reads in %u read group%s to %s (index: %s.idx)\n", records,
+               export.num_groups, export.num_groups == 1 ? "" : "s", output_file, output_file);
+      }
     }
   }
-  
-  // Write header
-  fprintf(output, "# Fast5 Metadata Export\n");
-  fprintf(output, "# file_path\tread_id\tsignal_length\tsample_rate\tduration\tread_number\tis_multi_read\n");
-  
+
+  slow5_header_free(header);
+  for (size_t i = 0; i < file_count; i++) {
+    slow5_file_slot_t *slot = &export.slots[i];
+    free_text_attrs(&slot->attrs);
+    free(slot->run_id);
+    while (slot->head) {
+      slow5_batch_t *next = slot->head->next;
+      seq_memory_release(slot->head->records.size);
+      free_batch(slot->head);
+      slot->head = next;
+    }
+  }
+  free(export.group_run_ids);
+  free(export.slots);
+  free(threads);
+  if (export.hdf5_mutex) {
+    pthread_mutex_destroy(export.hdf5_mutex);
+  }
+  pthread_cond_destroy(&export.space_ready);
+  pthread_cond_destroy(&export.batch_ready);
+  pthread_mutex_destroy(&export.lock);
+  return result;
+}
+
+// **********************************************************************
+// Basecaller Chunk Export
+// **********************************************************************
+
+static void write_chunk_batch(seq_output_t *signal_out, seq_output_t *index_out, const seq_chunk_batch *batch,
+                              uint64_t batch_number, char **read_ids) {
+  seq_output_f32le(signal_out, seq_tensor_data_float(batch->signal), batch->signal->size);
+  for (size_t row = 0; row < batch->count; row++) {
+    seq_output_printf(index_out, "%" PRIu64 "\t%zu\t%s\t%zu\n", batch_number, row,
+                      read_ids[batch->origins[row].read], batch->origins[row].start);
+  }
+}
+
+int export_chunks(char **files, size_t file_count, const char *output_file,
+                  const seq_chunker_options *options, bool verbose) {
+  seq_chunker *chunker = seq_chunker_create(options);
+  if (!chunker) return EXIT_FAILURE;
+
+  char index_file[4096];
+  if (snprintf(index_file, sizeof(index_file), "%s.tsv", output_file) >= (int)sizeof(index_file)) {
+    warnx("Output path too long: %s", output_file);
+    seq_chunker_free(chunker);
+    return EXIT_FAILURE;
+  }
+  FILE *signal_file = fopen(output_file, "wb");
+  FILE *index = signal_file ? fopen(index_file, "w") : NULL;
+  seq_output_t signal_out = {0}, index_out = {0};
+  if (!signal_file || !index) {
+    warnx("Cannot create output file: %s", signal_file ? index_file : output_file);
+    if (signal_file) fclose(signal_file);
+    seq_chunker_free(chunker);
+    return EXIT_FAILURE;
+  }
+  if (!seq_output_init(&signal_out, signal_file, 0) || !seq_output_init(&index_out, index, 0)) {
+    errx(EXIT_FAILURE, "Memory allocation failed for output buffer");
+  }
+  seq_output_str(&index_out, "batch\trow\tread_id\tstart\n");
+
+  // Read ids by the chunker's read number (every read is numbered, kept or not)
+  char **read_ids = NULL;
+  size_t num_reads = 0, read_capacity = 0;
+  uint64_t batch_number = 0;
+  bool warned_uncalibrated = false;
+
+  if (file_count > 1) {
+    display_progress_simple(0, (int)file_count, verbose, "chunking files");
+  }
+
   for (size_t i = 0; i < file_count; i++) {
     if (verbose) {
       printf("Processing file: %s\n", files[i]);
     }
-    
-    // Read metadata
-    size_t metadata_count = 0;
-    fast5_metadata_t *metadata = read_fast5_metadata_with_enhancer(files[i], &metadata_count, NULL);
-    
-    if (!metadata || metadata_count == 0) {
+    fast5_reader_t *reader = fast5_reader_open(files[i], extract_channel_and_calibration_combined);
+    if (!reader || fast5_reader_num_reads(reader) == 0) {
       warnx("Cannot read metadata from file: %s", files[i]);
+      fast5_reader_close(reader);
       continue;
     }
-    
-    // Write metadata for each read
-    for (size_t j = 0; j < metadata_count; j++) {
-      fprintf(output, "%s\t%s\t%u\t%.0f\t%u\t%u\t%s\n",
-              files[i],
-              metadata[j].read_id ? metadata[j].read_id : "unknown",
-              metadata[j].signal_length,
-              metadata[j].sample_rate,
-              metadata[j].duration,
-              metadata[j].read_number,
-              metadata[j].is_multi_read ? "true" : "false");
+
+    fast5_metadata_t metadata = {0};
+    while (fast5_reader_next(reader, &metadata, true) > 0) {
+      size_t signal_length = 0;
+      const int16_t *signal = fast5_reader_signal(reader, &signal_length);
+      if (!signal || signal_length == 0) {
+        if (verbose) {
+          printf("  Failed to extract signal for read: %s\n", metadata.read_id ? metadata.read_id : "unknown");
+        }
+        clear_fast5_metadata(&metadata);
+        continue;
+      }
+
+      // Windows are in pA; without calibration the raw ADC values pass through
+      float scale = 1.0f, offset = 0.0f;
+      if (metadata.calibration_available && metadata.digitisation > 0) {
+        scale = (float)(metadata.range / metadata.digitisation);
+        offset = (float)metadata.offset;
+      } else if (!warned_uncalibrated) {
+        warnx("No calibration in %s: chunking raw ADC values", files[i]);
+        warned_uncalibrated = true;
+      }
+
+      if (num_reads == read_capacity) {
+        read_capacity = read_capacity ? 2 * read_capacity : 1024;
+        char **grown = realloc(read_ids, read_capacity * sizeof(char*));
+        if (!grown) errx(EXIT_FAILURE, "Memory allocation failed for read ids");
+        read_ids = grown;
+      }
+      read_ids[num_reads] = strdup(metadata.read_id ? metadata.read_id : "unknown");
+      if (!read_ids[num_reads] ||
+          !seq_chunker_add_read_int16(chunker, num_reads, signal, signal_length, scale, offset)) {
+        errx(EXIT_FAILURE, "Memory allocation failed for signal chunks");
+      }
+      num_reads++;
+      clear_fast5_metadata(&metadata);
+
+      const seq_chunk_batch *batch;
+      while ((batch = seq_chunker_next(chunker))) {
+        write_chunk_batch(&signal_out, &index_out, batch, batch_number++, read_ids);
+      }
+    }
+    fast5_reader_close(reader);
+
+    if (file_count > 1) {
+      display_progress_simple((int)(i + 1), (int)file_count, verbose, "chunking files");
     }
-    
-    free_fast5_metadata(metadata, metadata_count);
   }
-  
-  if (output != stdout) {
-    fclose(output);
+  if (file_count > 1) {
+    printf("\n");
   }
-  
+
+  // Only complete batches are written; the windows of a last partial one are dropped
+  seq_chunker_stats stats;
+  seq_chunker_get_stats(chunker, &stats);
+  const seq_chunk_batch *partial = seq_chunker_finish(chunker);
+  size_t leftover = partial ? partial->count : 0;
+
+  int status = seq_output_close(&signal_out);
+  if (seq_output_close(&index_out) < 0) status = -1;
+  if (fclose(signal_file) != 0 || fclose(index) != 0) status = -1;
+  for (size_t r = 0; r < num_reads; r++) free(read_ids[r]);
+  free(read_ids);
+  seq_chunker_free(chunker);
+  if (status < 0) {
+    warnx("Failed to write chunk output");
+    return EXIT_FAILURE;
+  }
+
+  printf("Wrote %" PRIu64 " batches of %zu x %zu float32 windows to %s (index: %s)\n",
+         batch_number, options->batch_size, options->chunk_length, output_file, index_file);
+  printf("  %" PRIu64 " reads chunked, %" PRIu64 " shorter than one window, %zu windows left over\n",
+         stats.reads, stats.reads_too_short, leftover);
   return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
+
+// **********************************************************************
+// Fast5 Repack
+// **********************************************************************
+
+void fast5_repack_options_init(fast5_repack_options_t *options) {
+  options->layout = FAST5_REPACK_MULTI;
+  options->reads_per_file = 4000;
+  options->recompress = false;
+  options->compression_level = 1;
+  options->shuffle = true;
+  options->num_threads = 1;
+}
+
+// tracking_id and context_tags of one input file (first read), shared by its reads
+// in flight; the source and every queued read hold a reference
+typedef struct {
+  text_attrs_t tracking;
+  text_attrs_t context;
+  atomic_int references;
+} repack_file_attrs_t;
+
+static void release_file_attrs(repack_file_attrs_t *attrs) {
+  if (attrs && atomic_fetch_sub(&attrs->references, 1) == 1) {
+    free_text_attrs(&attrs->tracking);
+    free_text_attrs(&attrs->context);
+    free(attrs);
+  }
+}
+
+// One read between the stages: compressed chunks, or samples to encode
+typedef struct {
+  fast5_metadata_t metadata;
+  repack_file_attrs_t *attrs;
+  fast5_raw_signal_t chunks;
+  bool has_chunks;
+  int16_t *signal;
+  size_t signal_length;
+  bool ok;
+  size_t reserved;         // Bytes of chunks and samples counted against --max-memory
+} repack_item_t;
+
+// Bring the item's --max-memory reservation up to date with what it now holds,
+// so the pipeline source stops reading while the queued reads are over budget
+static void repack_account(repack_item_t *item) {
+  size_t bytes = item->chunks.data_capacity + (item->signal ? item->signal_length * sizeof(int16_t) : 0);
+  if (bytes > item->reserved) {
+    seq_memory_reserve(bytes - item->reserved);
+  } else {
+    seq_memory_release(item->reserved - bytes);
+  }
+  item->reserved = bytes;
+}
+
+typedef struct {
+  char **files;
+  size_t file_count;
+  const fast5_repack_options_t *options;
+  fast5_repack_layout_t layout;
+  const char *output;
+  fast5_write_options_t write_options;
+  pthread_mutex_t *hdf5_mutex;   // Source and sink both call HDF5; non-NULL when it is not thread-safe
+
+  // Source
+  size_t next_file;
+  fast5_reader_t *reader;
+  const char *filename;
+  repack_file_attrs_t *attrs;
+
+  // Sink
+  fast5_writer_t *writer;        // Multi-read layout
+  fast5_write_stats_t stats;     // Single-read layout (the writer keeps its own)
+  size_t files_written;
+  size_t reads;
+  size_t failed;
+} fast5_repack_t;
+
+static void repack_lock(fast5_repack_t *repack) {
+  if (repack->hdf5_mutex) pthread_mutex_lock(repack->hdf5_mutex);
+}
+
+static void repack_unlock(fast5_repack_t *repack) {
+  if (repack->hdf5_mutex) pthread_mutex_unlock(repack->hdf5_mutex);
+}
+
+static void repack_close_file(fast5_repack_t *repack) {
+  repack_lock(repack);
+  fast5_reader_close(repack->reader);
+  repack_unlock(repack);
+  repack->reader = NULL;
+  release_file_attrs(repack->attrs);
+  repack->attrs = NULL;
+}
+
+// Source: next read in input order, its Signal still compressed where possible
+static bool repack_source(void *context, void *data) {
+  fast5_repack_t *repack = context;
+  repack_item_t *item = data;
+  memset(item, 0, sizeof(*item));
+
+  while (true) {
+    if (!repack->reader) {
+      if (repack->next_file >= repack->file_count) return false;
+      repack->filename = repack->files[repack->next_file++];
+      repack_lock(repack);
+      repack->reader = fast5_reader_open(repack->filename, extract_slow5_fields);
+      repack_unlock(repack);
+      if (!repack->reader) {
+        warnx("Cannot read metadata from file: %s", repack->filename);
+        continue;
+      }
+      fast5_reader_defer_decode(repack->reader, true);
+    }
+
+    repack_lock(repack);
+    int status = fast5_reader_next(repack->reader, &item->metadata, true);
+    if (status > 0 && !repack->attrs) {
+      repack->attrs = calloc(1, sizeof(repack_file_attrs_t));
+      if (!repack->attrs) errx(EXIT_FAILURE, "Memory allocation failed for Fast5 attributes");
+      atomic_init(&repack->attrs->references, 1);
+      collect_read_attributes(repack->reader, "tracking_id", &repack->attrs->tracking);
+      collect_read_attributes(repack->reader, "context_tags", &repack->attrs->context);
+    }
+    repack_unlock(repack);
+    if (status <= 0) {
+      repack_close_file(repack);
+      continue;
+    }
+
+    if (!item->metadata.channel_number) {
+      try_filename_channel_extraction(repack->filename, &item->metadata);
+    }
+    atomic_fetch_add(&repack->attrs->references, 1);
+    item->attrs = repack->attrs;
+
+    item->has_chunks = fast5_reader_take_chunks(repack->reader, &item->chunks);
+    if (!item->has_chunks) {
+      size_t signal_length = 0;
+      const int16_t *signal = fast5_reader_signal(repack->reader, &signal_length);
+      if (signal && signal_length > 0) {
+        item->signal = malloc(signal_length * sizeof(int16_t));
+        if (!item->signal) errx(EXIT_FAILURE, "Memory allocation failed for read signal");
+        memcpy(item->signal, signal, signal_length * sizeof(int16_t));
+        item->signal_length = signal_length;
+      }
+    }
+    item->ok = item->metadata.read_id && (item->has_chunks || item->signal);
+    repack_account(item);
+    return true;
+  }
+}
+
+// Workers: decode (only when recompressing) and encode, both without HDF5
+static void repack_transform(void *context, void *data) {
+  fast5_repack_t *repack = context;
+  repack_item_t *item = data;
+  if (!item->ok) return;
+  if (item->has_chunks && !repack->options->recompress) return;  // Copied chunk for chunk
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  if (item->has_chunks) {
+    item->signal_length = item->chunks.length;
+    item->signal = malloc(item->signal_length * sizeof(int16_t));
+    if (!item->signal || !fast5_raw_signal_decode(&item->chunks, item->signal, 1)) {
+      item->ok = false;
+      repack_account(item);
+      return;
+    }
+    item->has_chunks = false;
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, profile_start);
+
+  // Level 0 leaves the samples to an unfiltered H5Dwrite
+  const fast5_write_options_t *options = &repack->write_options;
+  if (options->compression_level > 0) {
+    profile_start = SEQ_PROFILE_START();
+    item->has_chunks = fast5_raw_signal_encode(item->signal, item->signal_length, options->chunk_samples,
+                                               options->shuffle, options->compression_level, &item->chunks);
+    SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+    item->ok = item->has_chunks;
+  }
+  repack_account(item);
+}
+
+static void free_repack_item(repack_item_t *item) {
+  clear_fast5_metadata(&item->metadata);
+  fast5_raw_signal_free(&item->chunks);
+  free(item->signal);
+  release_file_attrs(item->attrs);
+  seq_memory_release(item->reserved);
+  item->reserved = 0;
+}
+
+// Sink: write reads strictly in input order
+static void repack_sink(void *context, void *data) {
+  fast5_repack_t *repack = context;
+  repack_item_t *item = data;
+  const fast5_metadata_t *metadata = &item->metadata;
+
+  if (!item->ok) {
+    warnx("Cannot repack read %s from %s", metadata->read_id ? metadata->read_id : "unknown",
+          metadata->file_path ? metadata->file_path : "unknown file");
+    repack->failed++;
+    free_repack_item(item);
+    return;
+  }
+
+  fast5_native_read_t read = {
+    .read_id = metadata->read_id,
+    .run_id = metadata->run_id,
+    .channel_number = metadata->channel_number,
+    .digitisation = metadata->digitisation,
+    .offset = metadata->offset,
+    .range = metadata->range,
+    .sampling_rate = metadata->sample_rate,
+    .read_number = metadata->read_number,
+    .duration = metadata->duration,
+    .start_time = metadata->start_time,
+    .has_median_before = metadata->pore_level_available,
+    .median_before = metadata->median_before,
+    .tracking_keys = (const char *const *)item->attrs->tracking.keys,
+    .tracking_values = (const char *const *)item->attrs->tracking.values,
+    .num_tracking = item->attrs->tracking.count,
+    .context_keys = (const char *const *)item->attrs->context.keys,
+    .context_values = (const char *const *)item->attrs->context.values,
+    .num_context = item->attrs->context.count,
+    .chunks = item->has_chunks ? &item->chunks : NULL,
+    .signal = item->signal,
+    .signal_length = item->signal_length
+  };
+
+  int status;
+  repack_lock(repack);
+  if (repack->layout == FAST5_REPACK_SINGLE) {
+    char filename[PATH_MAX];
+    snprintf(filename, sizeof(filename), "%s/%s.fast5", repack->output, metadata->read_id);
+    fast5_write_stats_t stats;
+    status = seq_write_fast5_single_native(filename, &read, &repack->write_options, &stats);
+    if (status == 0) {
+      repack->stats.reads_written += stats.reads_written;
+      repack->stats.logical_bytes += stats.logical_bytes;
+      repack->stats.stored_bytes += stats.stored_bytes;
+      repack->stats.file_bytes += stats.file_bytes;
+      repack->files_written++;
+    }
+  } else {
+    status = fast5_writer_append_native(repack->writer, &read);
+  }
+  repack_unlock(repack);
+
+  if (status == 0) {
+    repack->reads++;
+  } else {
+    repack->failed++;
+  }
+  free_repack_item(item);
+}
+
+// Layout of the first readable input (for FAST5_REPACK_KEEP)
+static fast5_repack_layout_t input_layout(char **files, size_t file_count) {
+  for (size_t i = 0; i < file_count; i++) {
+    fast5_reader_t *reader = fast5_reader_open(files[i], NULL);
+    if (!reader) continue;
+    bool multi = fast5_reader_is_multi_read(reader);
+    fast5_reader_close(reader);
+    return multi ? FAST5_REPACK_MULTI : FAST5_REPACK_SINGLE;
+  }
+  return FAST5_REPACK_MULTI;
+}
+
+int repack_fast5(char **files, size_t file_count, const char *output,
+                 const fast5_repack_options_t *options, bool verbose) {
+  if (!files || file_count == 0 || !output || !options) return EXIT_FAILURE;
+
+  // The output is created with truncation: never let it be one of the inputs
+  char output_path[PATH_MAX], input_path[PATH_MAX];
+  if (realpath(output, output_path)) {
+    for (size_t i = 0; i < file_count; i++) {
+      if (realpath(files[i], input_path) && strcmp(input_path, output_path) == 0) {
+        warnx("Output %s is also an input file", output);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  fast5_repack_t repack = {
+    .files = files,
+    .file_count = file_count,
+    .options = options,
+    .layout = options->layout == FAST5_REPACK_KEEP ? input_layout(files, file_count) : options->layout,
+    .output = output
+  };
+  fast5_write_options_init(&repack.write_options);
+  repack.write_options.compression_level = options->compression_level;
+  repack.write_options.shuffle = options->shuffle;
+
+  pthread_mutex_t hdf5_mutex = PTHREAD_MUTEX_INITIALIZER;
+  if (options->num_threads > 1 && !fast5_hdf5_is_threadsafe()) {
+    repack.hdf5_mutex = &hdf5_mutex;
+  }
+
+  if (repack.layout == FAST5_REPACK_SINGLE) {
+    if (create_directory(output) != EXIT_SUCCESS) return EXIT_FAILURE;
+  } else {
+    repack.writer = fast5_writer_open(output, 0.0f, &repack.write_options, options->reads_per_file);
+    if (!repack.writer) {
+      warnx("Cannot create Fast5 file: %s", output);
+      return EXIT_FAILURE;
+    }
+  }
+
+  seq_pipeline_config config = {
+    .source = repack_source,
+    .transform = repack_transform,
+    .sink = repack_sink,
+    .context = &repack,
+    .item_size = sizeof(repack_item_t),
+    .num_workers = options->num_threads,
+    .max_in_flight = 4 * (size_t)(options->num_threads > 0 ? options->num_threads : 1)
+  };
+  bool ran = seq_pipeline_run(&config);
+
+  fast5_write_stats_t stats = repack.stats;
+  int result = ran ? EXIT_SUCCESS : EXIT_FAILURE;
+  if (repack.writer) {
+    repack.files_written = fast5_writer_files_written(repack.writer);
+    if (fast5_writer_close(repack.writer, &stats) < 0) result = EXIT_FAILURE;
+  }
+  pthread_mutex_destroy(&hdf5_mutex);
+
+  if (repack.failed > 0) {
+    warnx("%zu read%s could not be repacked", repack.failed, repack.failed == 1 ? "" : "s");
+  }
+  if (repack.reads == 0) result = EXIT_FAILURE;
+  if (verbose) {
+    printf("Repacked %zu reads into %zu %s file%s (%s): %.1f MB of signal stored in %.1f MB\n", repack.reads,
+           repack.files_written, repack.layout == FAST5_REPACK_SINGLE ? "single-read" : "multi-read",
+           repack.files_written == 1 ? "" : "s", output, stats.logical_bytes / 1e6, stats.stored_bytes / 1e6);
+  }
+  return result;
+}
+
+// **********************************************************************
+// Metadata Extraction Functions
+// **********************************************************************
+
+// Columns of every metadata format, in output order (the TSV's first seven are its historical ones)
+enum {
+  METADATA_FILE_PATH, METADATA_READ_ID, METADATA_SIGNAL_LENGTH, METADATA_SAMPLE_RATE, METADATA_DURATION,
+  METADATA_READ_NUMBER, METADATA_IS_MULTI_READ, METADATA_RUN_ID, METADATA_CHANNEL_NUMBER, METADATA_START_TIME,
+  METADATA_DIGITISATION, METADATA_OFFSET, METADATA_RANGE, METADATA_MEDIAN_BEFORE, METADATA_NUM_COLUMNS
+};
+
+static const columnar_column_t metadata_columns[METADATA_NUM_COLUMNS] = {
+  {"file_path", COLUMNAR_DICT},
+  {"read_id", COLUMNAR_STRING},
+  {"signal_length", COLUMNAR_U32},
+  {"sample_rate", COLUMNAR_F64},
+  {"duration", COLUMNAR_U32},
+  {"read_number", COLUMNAR_U32},
+  {"is_multi_read", COLUMNAR_U8},
+  {"run_id", COLUMNAR_DICT},
+  {"channel_number", COLUMNAR_DICT},
+  {"start_time", COLUMNAR_U64},
+  {"digitisation", COLUMNAR_F64},
+  {"offset", COLUMNAR_F64},
+  {"range", COLUMNAR_F64},
+  {"median_before", COLUMNAR_F64}
+};
+
+bool fast5_parse_metadata_format(const char *name, fast5_metadata_format_t *format) {
+  if (!name || !format) return false;
+  if (strcmp(name, "tsv") == 0) {
+    *format = FAST5_METADATA_TSV;
+  } else if (strcmp(name, "csv") == 0) {
+    *format = FAST5_METADATA_CSV;
+  } else if (strcmp(name, "json") == 0) {
+    *format = FAST5_METADATA_JSON;
+  } else if (strcmp(name, "bin-columnar") == 0) {
+    *format = FAST5_METADATA_COLUMNAR;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* fast5_metadata_format_extension(fast5_metadata_format_t format) {
+  switch (format) {
+    case FAST5_METADATA_CSV:      return ".csv";
+    case FAST5_METADATA_JSON:     return ".json";
+    case FAST5_METADATA_COLUMNAR: return ".col";
+    default:                      return ".tsv";
+  }
+}
+
+// One input file between the stages: its reads, and for text formats their rows
+typedef struct {
+  size_t file_index;
+  fast5_metadata_t *reads;
+  size_t count;
+  char *text;
+  size_t text_size;
+  size_t reserved;         // Rows (or reads, for bin-columnar) counted against --max-memory
+} metadata_item_t;
+
+typedef struct {
+  char **files;
+  size_t file_count;
+  fast5_metadata_format_t format;
+  const char *output;
+  bool per_file;                 // One output per input, in the output directory
+  bool verbose;
+  pthread_mutex_t *hdf5_mutex;   // Workers all call HDF5; non-NULL when it is not thread-safe
+  size_t next_file;
+
+  // Sink: the open output
+  FILE *stream;
+  seq_output_t out;
+  columnar_writer_t *table;
+  size_t output_rows;
+  size_t outputs;
+  size_t reads;
+  size_t failed_files;
+  bool write_failed;
+} metadata_export_t;
+
+// Shortest of %.15g and %.17g that reads back as the same double
+static void metadata_double(seq_output_t *out, double value) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.15g", value);
+  if (strtod(text, NULL) != value) snprintf(text, sizeof(text), "%.17g", value);
+  seq_output_str(out, text);
+}
+
+static void metadata_string(seq_output_t *out, fast5_metadata_format_t format, const char *value) {
+  if (!value) {
+    if (format == FAST5_METADATA_JSON) seq_output_str(out, "null");
+    return;
+  }
+
+  if (format == FAST5_METADATA_JSON) {
+    seq_output_char(out, '"');
+    for (const unsigned char *p = (const unsigned char *)value; *p; p++) {
+      if (*p == '"' || *p == '\\') {
+        seq_output_char(out, '\\');
+        seq_output_char(out, (char)*p);
+      } else if (*p < 0x20) {
+        seq_output_printf(out, "\\u%04x", *p);
+      } else {
+        seq_output_char(out, (char)*p);
+      }
+    }
+    seq_output_char(out, '"');
+  } else if (format == FAST5_METADATA_CSV && strpbrk(value, ",\"\r\n")) {
+    seq_output_char(out, '"');
+    for (const char *p = value; *p; p++) {
+      if (*p == '"') seq_output_char(out, '"');
+      seq_output_char(out, *p);
+    }
+    seq_output_char(out, '"');
+  } else {
+    seq_output_str(out, value);
+  }
+}
+
+// A row of one read; JSON rows start with their ",\n" separator (dropped before an output's first row)
+static void format_metadata_row(seq_output_t *out, fast5_metadata_format_t format, const fast5_metadata_t *read) {
+  bool json = format == FAST5_METADATA_JSON;
+  if (json) seq_output_str(out, ",\n{");
+
+  for (int column = 0; column < METADATA_NUM_COLUMNS; column++) {
+    if (column > 0) seq_output_str(out, json ? ", " : format == FAST5_METADATA_CSV ? "," : "\t");
+    if (json) seq_output_printf(out, "\"%s\": ", metadata_columns[column].name);
+
+    // Values the enhancers did not find are empty (null in JSON)
+    bool available = true;
+    double value = 0.0;
+    switch (column) {
+      case METADATA_FILE_PATH:      metadata_string(out, format, read->file_path); continue;
+      case METADATA_READ_ID:        metadata_string(out, format, read->read_id); continue;
+      case METADATA_RUN_ID:         metadata_string(out, format, read->run_id); continue;
+      case METADATA_CHANNEL_NUMBER: metadata_string(out, format, read->channel_number); continue;
+      case METADATA_SIGNAL_LENGTH:  seq_output_uint(out, read->signal_length); continue;
+      case METADATA_DURATION:       seq_output_uint(out, read->duration); continue;
+      case METADATA_READ_NUMBER:    seq_output_uint(out, read->read_number); continue;
+      case METADATA_START_TIME:     seq_output_uint(out, read->start_time); continue;
+      case METADATA_IS_MULTI_READ:  seq_output_str(out, read->is_multi_read ? "true" : "false"); continue;
+      case METADATA_SAMPLE_RATE:    value = read->sample_rate; break;
+      case METADATA_DIGITISATION:   value = read->digitisation; available = read->calibration_available; break;
+      case METADATA_OFFSET:         value = read->offset; available = read->calibration_available; break;
+      case METADATA_RANGE:          value = read->range; available = read->calibration_available; break;
+      case METADATA_MEDIAN_BEFORE:  value = read->median_before; available = read->pore_level_available; break;
+    }
+    if (available) {
+      metadata_double(out, value);
+    } else if (json) {
+      seq_output_str(out, "null");
+    }
+  }
+  seq_output_str(out, json ? "}" : "\n");
+}
+
+static void append_metadata_row(columnar_writer_t *table, const fast5_metadata_t *read) {
+  columnar_writer_set_string(table, METADATA_FILE_PATH, read->file_path);
+  columnar_writer_set_string(table, METADATA_READ_ID, read->read_id);
+  columnar_writer_set_u32(table, METADATA_SIGNAL_LENGTH, read->signal_length);
+  columnar_writer_set_f64(table, METADATA_SAMPLE_RATE, read->sample_rate);
+  columnar_writer_set_u32(table, METADATA_DURATION, read->duration);
+  columnar_writer_set_u32(table, METADATA_READ_NUMBER, read->read_number);
+  columnar_writer_set_u8(table, METADATA_IS_MULTI_READ, read->is_multi_read);
+  columnar_writer_set_string(table, METADATA_RUN_ID, read->run_id);
+  columnar_writer_set_string(table, METADATA_CHANNEL_NUMBER, read->channel_number);
+  columnar_writer_set_u64(table, METADATA_START_TIME, read->start_time);
+  if (read->calibration_available) {
+    columnar_writer_set_f64(table, METADATA_DIGITISATION, read->digitisation);
+    columnar_writer_set_f64(table, METADATA_OFFSET, read->offset);
+    columnar_writer_set_f64(table, METADATA_RANGE, read->range);
+  }
+  if (read->pore_level_available) columnar_writer_set_f64(table, METADATA_MEDIAN_BEFORE, read->median_before);
+}
+
+// Source: the next file, in input order
+static bool metadata_source(void *context, void *data) {
+  metadata_export_t *export = context;
+  metadata_item_t *item = data;
+  if (export->next_file >= export->file_count) return false;
+  memset(item, 0, sizeof(*item));
+  item->file_index = export->next_file++;
+  return true;
+}
+
+// Workers: read every read's metadata under the HDF5 lock, then format text rows without it
+static void metadata_transform(void *context, void *data) {
+  metadata_export_t *export = context;
+  metadata_item_t *item = data;
+  const char *filename = export->files[item->file_index];
+
+  if (export->hdf5_mutex) pthread_mutex_lock(export->hdf5_mutex);
+  fast5_reader_t *reader = fast5_reader_open(filename, extract_slow5_fields);
+  if (reader) {
+    size_t capacity = fast5_reader_num_reads(reader);
+    item->reads = capacity ? calloc(capacity, sizeof(fast5_metadata_t)) : NULL;
+    if (capacity && !item->reads) errx(EXIT_FAILURE, "Memory allocation failed for metadata");
+    while (item->count < capacity && fast5_reader_next(reader, &item->reads[item->count], false) > 0) {
+      if (!item->reads[item->count].channel_number) {
+        try_filename_channel_extraction(filename, &item->reads[item->count]);
+      }
+      item->count++;
+    }
+    fast5_reader_close(reader);
+  }
+  if (export->hdf5_mutex) pthread_mutex_unlock(export->hdf5_mutex);
+  if (item->count == 0 || export->format == FAST5_METADATA_COLUMNAR) {
+    item->reserved = item->count * sizeof(fast5_metadata_t);
+    seq_memory_reserve(item->reserved);
+    return;
+  }
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  FILE *stream = open_memstream(&item->text, &item->text_size);
+  seq_output_t out;
+  if (!stream || !seq_output_init(&out, stream, 1u << 16)) {
+    errx(EXIT_FAILURE, "Memory allocation failed for metadata rows");
+  }
+  for (size_t i = 0; i < item->count; i++) {
+    format_metadata_row(&out, export->format, &item->reads[i]);
+  }
+  if (seq_output_close(&out) < 0 || fclose(stream) != 0) {
+    errx(EXIT_FAILURE, "Memory allocation failed for metadata rows");
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FORMAT, profile_start);
+  free_fast5_metadata(item->reads, item->count);
+  item->reads = NULL;
+  item->reserved = item->text_size;
+  seq_memory_reserve(item->reserved);
+}
+
+// stdout when path is NULL; text outputs get their header here
+static bool open_metadata_output(metadata_export_t *export, const char *path) {
+  export->output_rows = 0;
+  if (export->format == FAST5_METADATA_COLUMNAR) {
+    export->table = columnar_writer_open(path, metadata_columns, METADATA_NUM_COLUMNS, 0);
+    return export->table != NULL;
+  }
+
+  export->stream = path ? fopen(path, "w") : stdout;
+  if (!export->stream) {
+    warnx("Cannot create output file: %s", path);
+    return false;
+  }
+  if (!seq_output_init(&export->out, export->stream, 0)) {
+    errx(EXIT_FAILURE, "Memory allocation failed for output buffer");
+  }
+
+  const char *separator = export->format == FAST5_METADATA_CSV ? "," : "\t";
+  if (export->format == FAST5_METADATA_JSON) {
+    seq_output_char(&export->out, '[');
+  } else {
+    if (export->format == FAST5_METADATA_TSV) seq_output_str(&export->out, "# Fast5 Metadata Export\n# ");
+    for (int column = 0; column < METADATA_NUM_COLUMNS; column++) {
+      if (column > 0) seq_output_str(&export->out, separator);
+      seq_output_str(&export->out, metadata_columns[column].name);
+    }
+    seq_output_char(&export->out, '\n');
+  }
+  return true;
+}
+
+static void close_metadata_output(metadata_export_t *export) {
+  int status = 0;
+  if (export->table) {
+    status = columnar_writer_close(export->table, NULL);
+    export->table = NULL;
+  } else if (export->stream) {
+    if (export->format == FAST5_METADATA_JSON) seq_output_str(&export->out, export->output_rows ? "\n]\n" : "]\n");
+    status = seq_output_close(&export->out);
+    if (export->stream != stdout && fclose(export->stream) != 0) status = -1;
+    export->stream = NULL;
+  }
+  if (status < 0) export->write_failed = true;
+  export->outputs++;
+}
+
+// <directory>/<input base name without .fast5><extension>
+static void per_file_metadata_name(const char *directory, const char *input, fast5_metadata_format_t format,
+                                   char *name, size_t size) {
+  const char *base = strrchr(input, '/');
+  base = base ? base + 1 : input;
+  size_t base_length = strlen(base);
+  if (base_length > 6 && strcmp(base + base_length - 6, ".fast5") == 0) base_length -= 6;
+  snprintf(name, size, "%s/%.*s%s", directory, (int)base_length, base, fast5_metadata_format_extension(format));
+}
+
+// Sink: rows strictly in input order
+static void metadata_sink(void *context, void *data) {
+  metadata_export_t *export = context;
+  metadata_item_t *item = data;
+  const char *filename = export->files[item->file_index];
+
+  if (export->verbose) printf("Processing file: %s\n", filename);
+  if (item->count == 0) {
+    warnx("Cannot read metadata from file: %s", filename);
+    export->failed_files++;
+    free(item->text);
+    seq_memory_release(item->reserved);
+    return;
+  }
+
+  bool open = !export->per_file;
+  if (export->per_file) {
+    char path[PATH_MAX];
+    per_file_metadata_name(export->output, filename, export->format, path, sizeof(path));
+    open = open_metadata_output(export, path);
+    if (!open) export->write_failed = true;
+  }
+
+  if (open && export->format == FAST5_METADATA_COLUMNAR) {
+    for (size_t i = 0; i < item->count; i++) {
+      append_metadata_row(export->table, &item->reads[i]);
+      if (!columnar_writer_end_row(export->table)) export->write_failed = true;
+    }
+  } else if (open) {
+    // Drop the leading JSON separator before an output's first row
+    size_t skip = export->format == FAST5_METADATA_JSON && export->output_rows == 0 ? 1 : 0;
+    seq_output_write(&export->out, item->text + skip, item->text_size - skip);
+    // Keep stdout rows ahead of the next file's progress lines
+    if (export->verbose && export->stream == stdout) seq_output_flush(&export->out);
+  }
+  export->output_rows += item->count;
+  export->reads += item->count;
+
+  if (export->per_file && open) close_metadata_output(export);
+  free_fast5_metadata(item->reads, item->count);
+  free(item->text);
+  seq_memory_release(item->reserved);
+}
+
+int extract_metadata(char **files, size_t file_count, const char *output_file,
+                     fast5_metadata_format_t format, bool combine, int num_threads, bool verbose) {
+  if (!files || file_count == 0) return EXIT_FAILURE;
+  if (!output_file && format == FAST5_METADATA_COLUMNAR) {
+    warnx("The bin-columnar format needs an output file (-o)");
+    return EXIT_FAILURE;
+  }
+  if (verbose) {
+    printf("Converting %zu files to metadata format...\n", file_count);
+  }
+
+  metadata_export_t export = {
+    .files = files,
+    .file_count = file_count,
+    .format = format,
+    .output = output_file,
+    .per_file = output_file && !combine && file_count > 1,
+    .verbose = verbose
+  };
+
+  pthread_mutex_t hdf5_mutex = PTHREAD_MUTEX_INITIALIZER;
+  if (num_threads > 1 && !fast5_hdf5_is_threadsafe()) {
+    export.hdf5_mutex = &hdf5_mutex;
+  }
+
+  if (export.per_file) {
+    if (create_directory(output_file) != EXIT_SUCCESS) return EXIT_FAILURE;
+  } else if (!open_metadata_output(&export, output_file)) {
+    return EXIT_FAILURE;
+  }
+
+  seq_pipeline_config config = {
+    .source = metadata_source,
+    .transform = metadata_transform,
+    .sink = metadata_sink,
+    .context = &export,
+    .item_size = sizeof(metadata_item_t),
+    .num_workers = num_threads,
+    .max_in_flight = 2 * (size_t)(num_threads > 0 ? num_threads : 1)
+  };
+  bool ran = seq_pipeline_run(&config);
+
+  if (!export.per_file) close_metadata_output(&export);
+  pthread_mutex_destroy(&hdf5_mutex);
+
+  if (!ran) return EXIT_FAILURE;
+  if (export.write_failed) {
+    warnx("Failed to write metadata output");
+    return EXIT_FAILURE;
+  }
+  if (verbose) {
+    printf("Exported metadata for %zu reads from %zu files into %zu output%s\n", export.reads,
+           file_count - export.failed_files, export.outputs, export.outputs == 1 ? "" : "s");
+  }
+  return EXIT_SUCCESS;
+}
@@ -12,16 +12,19 @@
  Convert to raw:      sequelizer convert data.fast5 --to raw
  Wordy convert:       sequelizer convert data.fast5 --to raw --verbose
  Extract *all* reads: sequelizer convert multi-read.fast4 --to raw --all
+ Binary samples:      sequelizer convert data.fast5 --to raw --format bin -o signal.bin   # raw int16 LE, no header (.bin names)
 
- TODO:
- sequelizer convert input.fast5 --to slow5 -o output.slow5                      # to slow5 format
- sequelizer convert input.fast5 --to metadata --format json -o metadata.json    # extract metadata to JSON
- sequelizer convert input.fast5 --to metadata --format csv -o metadata.csv      # extract metadata to CSV
- sequelizer convert single_read_files/ --to multi-read -o combined.fast5        # single to multi
- sequelizer convert multi_read.fast5 --to single-read -o extracted              # multi to single
- sequelizer convert input.fast5 --recompress --compression gzip -o optim.fast5  # compression optimization
- sequelizer convert data/ --recursive --to slow5 --output-dir conv/             # dir conv w/ filt
- sequelizer convert data/ --to metadata --format csv --combine -o data_meta.csv # dir conv w/ filt
+ SLOW5/BLOW5:         sequelizer convert data/ --recursive --to blow5 -o reads.blow5    # plus reads.blow5.idx
+                      sequelizer convert input.fast5 --to slow5 -o output.slow5
+
+ Repack:              sequelizer convert single_read_files/ --to multi-read -o combined.fast5   # 4000 reads per file
+                      sequelizer convert multi_read.fast5 --to single-read -o extracted          # one file per read
+                      sequelizer convert input.fast5 --recompress --compression gzip -o optim.fast5
+
+ Metadata:            sequelizer convert input.fast5 --to metadata --format json -o metadata.json
+                      sequelizer convert input.fast5 --to metadata --format csv -o metadata.csv
+                      sequelizer convert data/ --to metadata --format csv --combine -o data_meta.csv   # one table
+                      sequelizer convert data/ --to metadata --format bin-columnar -o meta/           # one per file
 */
 
 #ifndef SEQUELIZER_FAST5_CONVERT_H
@@ -29,27 +32,104 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "fast5_utils.h"
+#include "seq_chunk.h"
+#include "seq_output.h"
+#include "slow5_writer.h"
 
 // **********************************************************************
 // Signal Extraction Functions
 // **********************************************************************
 
-// Write signal data to text file with metadata header (one sample per line)
-int write_signal_to_file(const char *filename, float *signal, size_t signal_length, const fast5_metadata_t *metadata);
+// Write native int16 signal data to a file: text with metadata header (one sample per line),
+// or SEQ_OUTPUT_BIN for the bare little-endian int16 samples
+int write_signal_to_file(const char *filename, const int16_t *signal, size_t signal_length,
+                         const fast5_metadata_t *metadata, seq_output_format format);
 
 // Create output directory if it doesn't exist
 int create_directory(const char *path);
 
 // Extract raw signals from Fast5 files
-int extract_raw_signals(char **files, size_t file_count, const char *output_file, 
-                        bool all_reads, bool verbose);
+int extract_raw_signals(char **files, size_t file_count, const char *output_file,
+                        bool all_reads, seq_output_format format, bool verbose);
+
+// Extract one read by read_id via the read-id index (O(1) lookup, no group scan)
+int extract_raw_signal_by_id(char **files, size_t file_count, const char *input_path,
+                             const char *read_id, const char *output_file,
+                             seq_output_format format, bool verbose);
+
+// **********************************************************************
+// SLOW5/BLOW5 Export
+// **********************************************************************
+
+// Convert every read of every file into one SLOW5/BLOW5 file and its <output_file>.idx.
+// num_threads workers read and encode files in parallel while the calling thread
+// writes the records in input order; each run_id becomes one read group
+int export_slow5(char **files, size_t file_count, const char *output_file,
+                 const slow5_options_t *options, int num_threads, bool verbose);
+
+// **********************************************************************
+// Basecaller Chunk Export
+// **********************************************************************
+
+// Cut every read into overlapping pA windows (seq_chunker) and write the complete
+// [batch_size × chunk_length] batches as little-endian float32 to output_file, with
+// <output_file>.tsv mapping each row to its read_id and start sample
+int export_chunks(char **files, size_t file_count, const char *output_file,
+                  const seq_chunker_options *options, bool verbose);
+
+// **********************************************************************
+// Fast5 Repack
+// **********************************************************************
+
+typedef enum {
+  FAST5_REPACK_MULTI,      // Multi-read files of reads_per_file reads (numbered _0, _1... past the first)
+  FAST5_REPACK_SINGLE,     // One single-read <read_id>.fast5 per read in an output directory
+  FAST5_REPACK_KEEP        // Whichever layout the first input file has
+} fast5_repack_layout_t;
+
+typedef struct {
+  fast5_repack_layout_t layout;
+  size_t reads_per_file;   // Multi-read output rollover (0 = one file)
+  bool recompress;         // Decode and re-encode every Signal; otherwise deflate chunks are copied as stored
+  int compression_level;   // Deflate level 0-9 for re-encoded Signals (0 = uncompressed)
+  bool shuffle;            // Byte shuffle ahead of deflate
+  int num_threads;         // Workers re-encoding Signals
+} fast5_repack_options_t;
+
+// Defaults: multi-read files of 4000 reads, chunks copied, shuffle + deflate level 1 where re-encoded
+void fast5_repack_options_init(fast5_repack_options_t *options);
+
+// Rewrite every read of every file into the chosen layout, in input order, keeping the
+// int16 samples, calibration, read attributes and tracking_id/context_tags (those of each
+// input file's first read). One thread reads and one writes; Signals the source stored in
+// another pipeline (VBZ, uncompressed contiguous...), or every Signal with recompress, are
+// re-encoded on num_threads workers and written as precompressed chunks
+int repack_fast5(char **files, size_t file_count, const char *output,
+                 const fast5_repack_options_t *options, bool verbose);
 
 // **********************************************************************
 // Metadata Extraction Functions  
 // **********************************************************************
 
-// Extract metadata to text format
-int extract_metadata(char **files, size_t file_count, const char *output_file, bool verbose);
+typedef enum {
+  FAST5_METADATA_TSV,      // Tab-separated with "# " header lines
+  FAST5_METADATA_CSV,      // Header row, RFC 4180 quoting
+  FAST5_METADATA_JSON,     // One array of objects, one read per line
+  FAST5_METADATA_COLUMNAR  // columnar_writer table: fixed-width columns, dictionary-encoded strings
+} fast5_metadata_format_t;
+
+// "tsv" / "csv" / "json" / "bin-columnar" -> format; false for anything else
+bool        fast5_parse_metadata_format(const char *name, fast5_metadata_format_t *format);
+const char* fast5_metadata_format_extension(fast5_metadata_format_t format);   // ".tsv" ... ".col"
+
+// One row per read: file_path, read_id, signal_length, sample_rate, duration, read_number,
+// is_multi_read, run_id, channel_number, start_time, digitisation, offset, range, median_before.
+// num_threads workers read and format files in parallel; the calling thread writes them in
+// input order into output_file (stdout when NULL, text formats only), or with several files
+// and combine false, into one <name><extension> per input in the output_file directory
+int extract_metadata(char **files, size_t file_count, const char *output_file,
+                     fast5_metadata_format_t format, bool combine, int num_threads, bool verbose);
 
 #endif // SEQUELIZER_FAST5_CONVERT_H
\ No newline at end of file
@@ -0,0 +1,371 @@
+// **********************************************************************
+// core/fast5_discovery.c - Parallel, Streaming Fast5 File Discovery
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "fast5_discovery.h"
+#include "fast5_io.h"
+#include "seq_profile.h"
+#include <dirent.h>
+#include <err.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Queued directories keep the descriptor openat() gave them while few are
+// waiting; past this many they are queued by path and reopened when scanned,
+// so a directory with thousands of subdirectories cannot exhaust descriptors
+#define DISCOVERY_MAX_QUEUED_FDS 64
+
+typedef struct dir_task {
+  char *path;
+  int fd;                  // Open directory descriptor, or -1 to open path when scanned
+  struct dir_task *next;
+} dir_task_t;
+
+struct fast5_discovery {
+  bool recursive;
+  bool check_signature;
+
+  // Directory work queue (a stack: walkers go depth-first, keeping it short)
+  dir_task_t *dirs;
+  size_t dirs_pending;     // Queued plus being scanned; the walk is over when this reaches 0
+  size_t queued_fds;
+  bool stop;               // Set by close() to abandon the walk early
+
+  // Result stream (append-only; consumers take from head)
+  char **found;
+  size_t found_head;
+  size_t found_count;
+  size_t found_capacity;
+  size_t rejected;
+  bool finished;
+  bool incomplete;         // Memory or threads ran out: some entries were dropped
+
+  pthread_mutex_t lock;
+  pthread_cond_t work_ready;      // A directory was queued, or the walk finished
+  pthread_cond_t results_ready;   // A path was found, or the walk finished
+  pthread_t *threads;
+  int thread_count;
+};
+
+// **********************************************************************
+// Work Queue and Result Stream (callers hold discovery->lock)
+// **********************************************************************
+// Out of memory, the directory or path is dropped (and freed) and the walk
+// goes on; fast5_discovery_incomplete() tells the consumer afterwards
+static void push_directory(fast5_discovery_t *d, char *path, int fd) {
+  dir_task_t *task = malloc(sizeof(dir_task_t));
+  if (!task) {
+    warnx("Memory allocation failed, skipping directory: %s", path);
+    if (fd >= 0) close(fd);
+    free(path);
+    d->incomplete = true;
+    return;
+  }
+  task->path = path;
+  task->fd = fd;
+  task->next = d->dirs;
+  d->dirs = task;
+  d->dirs_pending++;
+  if (fd >= 0) d->queued_fds++;
+  pthread_cond_signal(&d->work_ready);
+}
+
+static void push_result(fast5_discovery_t *d, char *path) {
+  if (d->found_count == d->found_capacity) {
+    // Start with 1024: typical nanopore runs have thousands of files
+    size_t capacity = d->found_capacity ? d->found_capacity * 2 : 1024;
+    char **grown = realloc(d->found, capacity * sizeof(char*));
+    if (!grown) {
+      warnx("Memory allocation failed, skipping file: %s", path);
+      free(path);
+      d->incomplete = true;
+      return;
+    }
+    d->found = grown;
+    d->found_capacity = capacity;
+  }
+  d->found[d->found_count++] = path;
+  pthread_cond_signal(&d->results_ready);
+}
+
+// **********************************************************************
+// Directory Walkers
+// **********************************************************************
+static char* join_path(const char *directory, const char *name) {
+  char path[PATH_MAX];
+  int len = snprintf(path, sizeof(path), "%s/%s", directory, name);
+  if (len < 0 || (size_t)len >= sizeof(path)) {
+    warnx("Path too long: %s/%s", directory, name);
+    return NULL;
+  }
+  char *copy = strdup(path);
+  if (!copy) warnx("Memory allocation failed, skipping: %s", path);
+  return copy;
+}
+
+// List one directory: queue its subdirectories and publish its Fast5 files
+static void scan_directory(fast5_discovery_t *d, dir_task_t *task) {
+  int fd = task->fd >= 0 ? task->fd : open(task->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  DIR *dir = fd >= 0 ? fdopendir(fd) : NULL;
+  if (!dir) {
+    if (fd >= 0) close(fd);
+    warnx("Cannot open directory: %s", task->path);
+    return;
+  }
+  int dir_fd = dirfd(dir);
+
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') continue; // Skip hidden files and . ..
+
+    // d_type saves a stat per entry; symlinks and file systems that report
+    // DT_UNKNOWN are resolved with fstatat relative to the open directory
+    bool is_dir = entry->d_type == DT_DIR;
+    bool is_reg = entry->d_type == DT_REG;
+    if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+      struct stat file_stat;
+      if (fstatat(dir_fd, entry->d_name, &file_stat, 0) != 0) {
+        warnx("Cannot stat file: %s/%s", task->path, entry->d_name);
+        continue;
+      }
+      is_dir = S_ISDIR(file_stat.st_mode);
+      is_reg = S_ISREG(file_stat.st_mode);
+    }
+
+    if (is_dir && d->recursive) {
+      char *path = join_path(task->path, entry->d_name);
+      if (!path) {
+        pthread_mutex_lock(&d->lock);
+        d->incomplete = true;
+        pthread_mutex_unlock(&d->lock);
+        continue;
+      }
+
+      pthread_mutex_lock(&d->lock);
+      bool keep_fd = d->queued_fds < DISCOVERY_MAX_QUEUED_FDS;
+      pthread_mutex_unlock(&d->lock);
+      int sub_fd = keep_fd ? openat(dir_fd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+
+      pthread_mutex_lock(&d->lock);
+      push_directory(d, path, sub_fd);
+      pthread_mutex_unlock(&d->lock);
+    } else if (is_reg && is_fast5_file(entry->d_name)) {
+      bool accepted = true;
+      if (d->check_signature) {
+        int file_fd = openat(dir_fd, entry->d_name, O_RDONLY | O_CLOEXEC);
+        accepted = file_fd >= 0 && has_hdf5_signature_fd(file_fd);
+        if (file_fd >= 0) close(file_fd);
+      }
+      char *path = accepted ? join_path(task->path, entry->d_name) : NULL;
+
+      pthread_mutex_lock(&d->lock);
+      if (path) {
+        push_result(d, path);
+      } else if (accepted) {
+        d->incomplete = true;      // join_path ran out of memory
+      } else {
+        d->rejected++;
+      }
+      bool stop = d->stop;
+      pthread_mutex_unlock(&d->lock);
+      if (stop) break;
+    }
+  }
+
+  closedir(dir);
+}
+
+static void* discovery_walker(void *arg) {
+  fast5_discovery_t *d = arg;
+
+  pthread_mutex_lock(&d->lock);
+  while (true) {
+    while (!d->dirs && d->dirs_pending > 0 && !d->stop) {
+      pthread_cond_wait(&d->work_ready, &d->lock);
+    }
+    if (!d->dirs || d->stop) break;
+
+    dir_task_t *task = d->dirs;
+    d->dirs = task->next;
+    if (task->fd >= 0) d->queued_fds--;
+    pthread_mutex_unlock(&d->lock);
+
+    uint64_t profile_start = SEQ_PROFILE_START();
+    scan_directory(d, task);
+    SEQ_PROFILE_STOP(SEQ_PROFILE_DISCOVERY, profile_start);
+    free(task->path);
+    free(task);
+
+    pthread_mutex_lock(&d->lock);
+    if (--d->dirs_pending == 0) {
+      d->finished = true;
+      pthread_cond_broadcast(&d->work_ready);
+      pthread_cond_broadcast(&d->results_ready);
+    }
+  }
+  pthread_mutex_unlock(&d->lock);
+  return NULL;
+}
+
+// **********************************************************************
+// Public API
+// **********************************************************************
+static fast5_discovery_t* discovery_create(const fast5_discovery_options_t *options) {
+  fast5_discovery_t *d = calloc(1, sizeof(fast5_discovery_t));
+  if (!d) {
+    warnx("Memory allocation failed for file discovery");
+    return NULL;
+  }
+  d->recursive = options ? options->recursive : false;
+  d->check_signature = options ? options->check_signature : false;
+  pthread_mutex_init(&d->lock, NULL);
+  pthread_cond_init(&d->work_ready, NULL);
+  pthread_cond_init(&d->results_ready, NULL);
+  return d;
+}
+
+fast5_discovery_t* fast5_discovery_start(const char *input_path, const fast5_discovery_options_t *options) {
+  struct stat path_stat;
+  if (!input_path || stat(input_path, &path_stat) != 0) {
+    warnx("Input path does not exist: %s", input_path ? input_path : "(null)");
+    return NULL;
+  }
+
+  // A single file is the whole stream
+  if (S_ISREG(path_stat.st_mode)) {
+    if (!is_fast5_file(input_path)) {
+      warnx("Input file is not a Fast5 file: %s", input_path);
+      return NULL;
+    }
+    fast5_discovery_t *d = discovery_create(options);
+    if (!d) return NULL;
+    if (d->check_signature && !has_hdf5_signature(input_path)) {
+      d->rejected = 1;
+    } else {
+      char *path = strdup(input_path);
+      if (!path) {
+        warnx("Memory allocation failed for file discovery");
+        fast5_discovery_close(d);
+        return NULL;
+      }
+      push_result(d, path);
+    }
+    d->finished = true;
+    return d;
+  }
+  if (!S_ISDIR(path_stat.st_mode)) {
+    warnx("Input path is neither a file nor a directory: %s", input_path);
+    return NULL;
+  }
+
+  int root_fd = open(input_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (root_fd < 0) {
+    warnx("Cannot open directory: %s", input_path);
+    return NULL;
+  }
+  char *root = strdup(input_path);
+  fast5_discovery_t *d = root ? discovery_create(options) : NULL;
+  if (!d) {
+    if (!root) warnx("Memory allocation failed for file discovery");
+    close(root_fd);
+    free(root);
+    return NULL;
+  }
+  push_directory(d, root, root_fd);
+  if (d->incomplete) {
+    fast5_discovery_close(d);
+    return NULL;
+  }
+
+  // A flat listing is one directory: extra walkers would only sit idle
+  int threads = options && options->threads > 0 ? options->threads : FAST5_DISCOVERY_DEFAULT_THREADS;
+  if (!d->recursive) threads = 1;
+
+  // Fewer walkers than asked for only slows the walk; none at all fails it
+  d->threads = calloc((size_t)threads, sizeof(pthread_t));
+  for (int t = 0; d->threads && t < threads; t++) {
+    if (pthread_create(&d->threads[t], NULL, discovery_walker, d) != 0) break;
+    d->thread_count++;
+  }
+  if (d->thread_count == 0) {
+    warnx("Cannot start file discovery threads");
+    fast5_discovery_close(d);
+    return NULL;
+  }
+  return d;
+}
+
+char* fast5_discovery_next(fast5_discovery_t *d) {
+  pthread_mutex_lock(&d->lock);
+  while (d->found_head == d->found_count && !d->finished && !d->stop) {
+    pthread_cond_wait(&d->results_ready, &d->lock);
+  }
+  char *path = NULL;
+  if (d->found_head < d->found_count) {
+    path = d->found[d->found_head];
+    d->found[d->found_head++] = NULL;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return path;
+}
+
+size_t fast5_discovery_found(fast5_discovery_t *d) {
+  pthread_mutex_lock(&d->lock);
+  size_t found = d->found_count;
+  pthread_mutex_unlock(&d->lock);
+  return found;
+}
+
+size_t fast5_discovery_rejected(fast5_discovery_t *d) {
+  pthread_mutex_lock(&d->lock);
+  size_t rejected = d->rejected;
+  pthread_mutex_unlock(&d->lock);
+  return rejected;
+}
+
+bool fast5_discovery_incomplete(fast5_discovery_t *d) {
+  pthread_mutex_lock(&d->lock);
+  bool incomplete = d->incomplete;
+  pthread_mutex_unlock(&d->lock);
+  return incomplete;
+}
+
+void fast5_discovery_close(fast5_discovery_t *d) {
+  if (!d) return;
+
+  pthread_mutex_lock(&d->lock);
+  d->stop = true;
+  pthread_cond_broadcast(&d->work_ready);
+  pthread_cond_broadcast(&d->results_ready);
+  pthread_mutex_unlock(&d->lock);
+
+  for (int t = 0; t < d->thread_count; t++) {
+    pthread_join(d->threads[t], NULL);
+  }
+  free(d->threads);
+
+  // Directories left behind by an early stop
+  while (d->dirs) {
+    dir_task_t *task = d->dirs;
+    d->dirs = task->next;
+    if (task->fd >= 0) close(task->fd);
+    free(task->path);
+    free(task);
+  }
+  for (size_t i = d->found_head; i < d->found_count; i++) {
+    free(d->found[i]);
+  }
+  free(d->found);
+
+  pthread_cond_destroy(&d->results_ready);
+  pthread_cond_destroy(&d->work_ready);
+  pthread_mutex_destroy(&d->lock);
+  free(d);
+}
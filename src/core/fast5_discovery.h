@@ -0,0 +1,49 @@
+// **********************************************************************
+// core/fast5_discovery.h - Parallel, Streaming Fast5 File Discovery
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// A pool of walker threads shares a queue of directories. Each walker lists
+// one directory at a time, classifies entries by d_type (falling back to
+// fstatat() only when the file system does not report it), queues
+// subdirectories opened with openat() and pushes every Fast5 file it finds
+// onto a result stream. Consumers pull paths from that stream with
+// fast5_discovery_next() while the walk is still in progress, so analysis
+// can start long before a large run folder has been fully listed.
+#ifndef SEQUELIZER_FAST5_DISCOVERY_H
+#define SEQUELIZER_FAST5_DISCOVERY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FAST5_DISCOVERY_DEFAULT_THREADS 8
+
+typedef struct {
+  bool recursive;          // Descend into subdirectories
+  bool check_signature;    // Drop .fast5 files that do not start with an HDF5 superblock signature
+  int threads;             // Directory walkers (0 = FAST5_DISCOVERY_DEFAULT_THREADS)
+} fast5_discovery_options_t;
+
+typedef struct fast5_discovery fast5_discovery_t;
+
+// Start discovering under input_path (a directory, or a single .fast5 file);
+// NULL with a warning if the path cannot be used
+fast5_discovery_t* fast5_discovery_start(const char *input_path, const fast5_discovery_options_t *options);
+
+// Next discovered path in discovery order (caller must free); blocks until one is
+// available and returns NULL once the walk has finished and the stream is drained.
+// Safe to call from several consumer threads at once
+char* fast5_discovery_next(fast5_discovery_t *discovery);
+
+// Progress counters (files accepted and files dropped by the signature check so far)
+size_t fast5_discovery_found(fast5_discovery_t *discovery);
+size_t fast5_discovery_rejected(fast5_discovery_t *discovery);
+
+// True once an entry was dropped because memory ran out (each one is warned about);
+// the stream still ends normally, without it
+bool   fast5_discovery_incomplete(fast5_discovery_t *discovery);
+
+// Stop the walkers (if still running) and release everything not yet consumed
+void fast5_discovery_close(fast5_discovery_t *discovery);
+
+#endif // SEQUELIZER_FAST5_DISCOVERY_H
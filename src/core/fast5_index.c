@@ -0,0 +1,434 @@
+// **********************************************************************
+// core/fast5_index.c - Read-ID Index for Fast5 Files
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Replaces the per-lookup group scan in read_fast5_signal() with an O(1)
+// hash lookup followed by a direct H5Dopen2 of the indexed group.
+//
+// Sidecar format (tab-separated text, one record per line):
+//   # sequelizer fast5 index v1
+//   F <file_index> <mtime> <size> <path>
+//   R <file_index> <signal_length> <dataset_offset> <group_path> <read_id>
+
+#include "fast5_index.h"
+#include "fast5_io.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <err.h>
+
+#define FAST5_INDEX_HEADER "# sequelizer fast5 index v1"
+
+// **********************************************************************
+// Hash Table Helpers
+// **********************************************************************
+
+// FNV-1a: read ids are UUID strings, so a simple byte hash distributes well
+static uint64_t hash_read_id(const char *read_id) {
+  uint64_t hash = 1469598103934665603ULL;
+  for (const unsigned char *p = (const unsigned char *)read_id; *p; p++) {
+    hash ^= *p;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Insert entry_index into the slot table (table must have a free slot)
+static void slot_insert(size_t *slots, size_t slot_capacity, const fast5_index_entry_t *entries, size_t entry_index) {
+  size_t mask = slot_capacity - 1;
+  size_t slot = (size_t)hash_read_id(entries[entry_index].read_id) & mask;
+  while (slots[slot] != 0) {
+    slot = (slot + 1) & mask;
+  }
+  slots[slot] = entry_index + 1;
+}
+
+// Keep load factor below 1/2
+static bool ensure_slot_capacity(fast5_index_t *index, size_t needed_entries) {
+  if (needed_entries * 2 < index->slot_capacity) return true;
+
+  size_t new_capacity = index->slot_capacity == 0 ? 1024 : index->slot_capacity;
+  while (needed_entries * 2 >= new_capacity) new_capacity *= 2;
+
+  size_t *slots = calloc(new_capacity, sizeof(size_t));
+  if (!slots) return false;
+  for (size_t i = 0; i < index->entry_count; i++) {
+    slot_insert(slots, new_capacity, index->entries, i);
+  }
+  free(index->slots);
+  index->slots = slots;
+  index->slot_capacity = new_capacity;
+  return true;
+}
+
+// **********************************************************************
+// Index Construction and Cleanup
+// **********************************************************************
+
+fast5_index_t* fast5_index_create(void) {
+  return calloc(1, sizeof(fast5_index_t));
+}
+
+void fast5_index_free(fast5_index_t *index) {
+  if (!index) return;
+  for (size_t i = 0; i < index->file_count; i++) {
+    free(index->files[i].path);
+  }
+  for (size_t i = 0; i < index->entry_count; i++) {
+    free(index->entries[i].read_id);
+    free(index->entries[i].group_path);
+  }
+  free(index->files);
+  free(index->entries);
+  free(index->slots);
+  free(index);
+}
+
+// Register a file and return its index (SIZE_MAX on failure)
+static size_t index_push_file(fast5_index_t *index, const char *path, int64_t mtime, int64_t size) {
+  if (index->file_count >= index->file_capacity) {
+    size_t new_capacity = index->file_capacity == 0 ? 64 : index->file_capacity * 2;
+    fast5_index_file_t *files = realloc(index->files, new_capacity * sizeof(fast5_index_file_t));
+    if (!files) return SIZE_MAX;
+    index->files = files;
+    index->file_capacity = new_capacity;
+  }
+  fast5_index_file_t *file = &index->files[index->file_count];
+  file->path = strdup(path);
+  if (!file->path) return SIZE_MAX;
+  file->mtime = mtime;
+  file->size = size;
+  return index->file_count++;
+}
+
+// Add one read (duplicate read ids keep the first occurrence)
+static bool index_push_entry(fast5_index_t *index, const char *read_id, size_t file_index,
+                             const char *group_path, uint32_t signal_length, uint64_t dataset_offset) {
+  if (!read_id || !group_path) return false;
+  if (fast5_index_lookup(index, read_id)) return true;
+
+  if (index->entry_count >= index->entry_capacity) {
+    size_t new_capacity = index->entry_capacity == 0 ? 1024 : index->entry_capacity * 2;
+    fast5_index_entry_t *entries = realloc(index->entries, new_capacity * sizeof(fast5_index_entry_t));
+    if (!entries) return false;
+    index->entries = entries;
+    index->entry_capacity = new_capacity;
+  }
+  if (!ensure_slot_capacity(index, index->entry_count + 1)) return false;
+
+  fast5_index_entry_t *entry = &index->entries[index->entry_count];
+  entry->read_id = strdup(read_id);
+  entry->group_path = strdup(group_path);
+  if (!entry->read_id || !entry->group_path) {
+    free(entry->read_id);
+    free(entry->group_path);
+    return false;
+  }
+  entry->file_index = file_index;
+  entry->signal_length = signal_length;
+  entry->dataset_offset = dataset_offset;
+
+  slot_insert(index->slots, index->slot_capacity, index->entries, index->entry_count);
+  index->entry_count++;
+  return true;
+}
+
+static bool stat_file(const char *path, int64_t *mtime, int64_t *size) {
+  struct stat file_stat;
+  if (stat(path, &file_stat) != 0) return false;
+  *mtime = (int64_t)file_stat.st_mtime;
+  *size = (int64_t)file_stat.st_size;
+  return true;
+}
+
+int fast5_index_add_file(fast5_index_t *index, const char *path) {
+  if (!index || !path) return -1;
+
+  int64_t mtime, size;
+  if (!stat_file(path, &mtime, &size)) return -1;
+
+  fast5_reader_t *reader = fast5_reader_open(path, NULL);
+  if (!reader) return -1;
+
+  size_t file_index = index_push_file(index, path, mtime, size);
+  if (file_index == SIZE_MAX) {
+    fast5_reader_close(reader);
+    return -1;
+  }
+
+  // Metadata-only pass: read_id, signal length and location of every read
+  int added = 0;
+  fast5_metadata_t metadata = {0};
+  while (fast5_reader_next(reader, &metadata, false) > 0) {
+    uint64_t dataset_offset;
+    const char *group_path = fast5_reader_location(reader, &dataset_offset);
+    if (index_push_entry(index, metadata.read_id, file_index, group_path,
+                         metadata.signal_length, dataset_offset)) {
+      added++;
+    }
+    clear_fast5_metadata(&metadata);
+  }
+
+  fast5_reader_close(reader);
+  return added;
+}
+
+// **********************************************************************
+// Lookup Functions
+// **********************************************************************
+
+const fast5_index_entry_t* fast5_index_lookup(const fast5_index_t *index, const char *read_id) {
+  if (!index || !read_id || index->slot_capacity == 0) return NULL;
+
+  size_t mask = index->slot_capacity - 1;
+  size_t slot = (size_t)hash_read_id(read_id) & mask;
+  while (index->slots[slot] != 0) {
+    const fast5_index_entry_t *entry = &index->entries[index->slots[slot] - 1];
+    if (strcmp(entry->read_id, read_id) == 0) return entry;
+    slot = (slot + 1) & mask;
+  }
+  return NULL;
+}
+
+bool fast5_index_file_is_stale(const fast5_index_t *index, size_t file_index) {
+  if (!index || file_index >= index->file_count) return true;
+
+  const fast5_index_file_t *file = &index->files[file_index];
+  int64_t mtime, size;
+  if (!stat_file(file->path, &mtime, &size)) return true;
+  return mtime != file->mtime || size != file->size;
+}
+
+seq_tensor* fast5_index_read_signal(const fast5_index_t *index, const char *read_id) {
+  const fast5_index_entry_t *entry = fast5_index_lookup(index, read_id);
+  if (!entry) return NULL;
+
+  const char *path = index->files[entry->file_index].path;
+
+  // File changed since indexing: group paths may have moved, fall back to a scan
+  if (fast5_index_file_is_stale(index, entry->file_index)) {
+    return read_fast5_signal_raw(path, read_id);
+  }
+  return read_fast5_signal_raw_at(path, entry->group_path);
+}
+
+// **********************************************************************
+// Sidecar Persistence
+// **********************************************************************
+
+char* fast5_index_sidecar_path(const char *input_path) {
+  if (!input_path) return NULL;
+
+  struct stat path_stat;
+  if (stat(input_path, &path_stat) != 0 || !S_ISDIR(path_stat.st_mode)) return NULL;
+
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/%s", input_path, FAST5_INDEX_SIDECAR_NAME);
+  return strdup(path);
+}
+
+int fast5_index_save(const fast5_index_t *index, const char *path) {
+  if (!index || !path) return -1;
+
+  // Write to a temporary file and rename so readers never see a partial sidecar
+  char tmp_path[PATH_MAX];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+  FILE *out = fopen(tmp_path, "w");
+  if (!out) {
+    warnx("Cannot create index file: %s", tmp_path);
+    return -1;
+  }
+
+  fprintf(out, "%s\n", FAST5_INDEX_HEADER);
+  for (size_t i = 0; i < index->file_count; i++) {
+    const fast5_index_file_t *file = &index->files[i];
+    fprintf(out, "F\t%zu\t%" PRId64 "\t%" PRId64 "\t%s\n", i, file->mtime, file->size, file->path);
+  }
+  for (size_t i = 0; i < index->entry_count; i++) {
+    const fast5_index_entry_t *entry = &index->entries[i];
+    fprintf(out, "R\t%zu\t%u\t%" PRIu64 "\t%s\t%s\n", entry->file_index, entry->signal_length,
+            entry->dataset_offset, entry->group_path, entry->read_id);
+  }
+
+  if (fclose(out) != 0 || rename(tmp_path, path) != 0) {
+    warnx("Cannot write index file: %s", path);
+    remove(tmp_path);
+    return -1;
+  }
+  return 0;
+}
+
+fast5_index_t* fast5_index_load(const char *path) {
+  if (!path) return NULL;
+
+  FILE *in = fopen(path, "r");
+  if (!in) return NULL;
+
+  char line[2 * PATH_MAX];
+  if (!fgets(line, sizeof(line), in) || strncmp(line, FAST5_INDEX_HEADER, strlen(FAST5_INDEX_HEADER)) != 0) {
+    fclose(in);
+    return NULL;
+  }
+
+  fast5_index_t *index = fast5_index_create();
+  if (!index) {
+    fclose(in);
+    return NULL;
+  }
+
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), in)) {
+    line[strcspn(line, "\r\n")] = '\0';
+
+    if (line[0] == 'F') {
+      size_t file_index;
+      int64_t mtime, size;
+      int consumed = 0;
+      if (sscanf(line, "F\t%zu\t%" SCNd64 "\t%" SCNd64 "\t%n", &file_index, &mtime, &size, &consumed) != 3 ||
+          consumed == 0 || file_index != index->file_count) {
+        ok = false;
+        break;
+      }
+      ok = index_push_file(index, line + consumed, mtime, size) != SIZE_MAX;
+    } else if (line[0] == 'R') {
+      size_t file_index;
+      uint32_t signal_length;
+      uint64_t dataset_offset;
+      int consumed = 0;
+      if (sscanf(line, "R\t%zu\t%" SCNu32 "\t%" SCNu64 "\t%n", &file_index, &signal_length, &dataset_offset, &consumed) != 3 ||
+          consumed == 0 || file_index >= index->file_count) {
+        ok = false;
+        break;
+      }
+      char *group_path = line + consumed;
+      char *read_id = strchr(group_path, '\t');
+      if (!read_id) {
+        ok = false;
+        break;
+      }
+      *read_id++ = '\0';
+      ok = index_push_entry(index, read_id, file_index, group_path, signal_length, dataset_offset);
+    }
+  }
+  fclose(in);
+
+  if (!ok) {
+    warnx("Ignoring malformed index file: %s", path);
+    fast5_index_free(index);
+    return NULL;
+  }
+  return index;
+}
+
+// **********************************************************************
+// Incremental Build (sidecar reuse with mtime invalidation)
+// **********************************************************************
+
+// Copy every entry of cached file cached_index into index under a new file slot
+static bool copy_cached_file(fast5_index_t *index, const fast5_index_t *cached, size_t cached_index,
+                             const size_t *first_entry, const size_t *next_entry) {
+  const fast5_index_file_t *file = &cached->files[cached_index];
+  size_t file_index = index_push_file(index, file->path, file->mtime, file->size);
+  if (file_index == SIZE_MAX) return false;
+
+  for (size_t e = first_entry[cached_index]; e != SIZE_MAX; e = next_entry[e]) {
+    const fast5_index_entry_t *entry = &cached->entries[e];
+    if (!index_push_entry(index, entry->read_id, file_index, entry->group_path,
+                          entry->signal_length, entry->dataset_offset)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int compare_file_paths(const void *a, const void *b) {
+  return strcmp((*(const fast5_index_file_t *const *)a)->path, (*(const fast5_index_file_t *const *)b)->path);
+}
+
+static int compare_path_to_file(const void *key, const void *file) {
+  return strcmp((const char *)key, (*(const fast5_index_file_t *const *)file)->path);
+}
+
+fast5_index_t* fast5_index_build(char **files, size_t file_count, const char *sidecar_path, bool verbose) {
+  fast5_index_t *index = fast5_index_create();
+  if (!index) return NULL;
+
+  fast5_index_t *cached = sidecar_path ? fast5_index_load(sidecar_path) : NULL;
+
+  // Per-file entry chains for the cached index (entries are stored file-ordered,
+  // but chaining keeps this correct for any order), and its files sorted by path
+  // so each listed file finds its cached entries wherever it used to be listed
+  size_t *first_entry = NULL;
+  size_t *next_entry = NULL;
+  const fast5_index_file_t **by_path = NULL;
+  if (cached) {
+    first_entry = malloc((cached->file_count + 1) * sizeof(size_t));
+    next_entry = malloc((cached->entry_count + 1) * sizeof(size_t));
+    by_path = malloc((cached->file_count + 1) * sizeof(*by_path));
+    if (!first_entry || !next_entry || !by_path) {
+      fast5_index_free(cached);
+      cached = NULL;
+    } else {
+      for (size_t f = 0; f < cached->file_count; f++) by_path[f] = &cached->files[f];
+      qsort(by_path, cached->file_count, sizeof(*by_path), compare_file_paths);
+      for (size_t f = 0; f < cached->file_count; f++) first_entry[f] = SIZE_MAX;
+      for (size_t e = cached->entry_count; e-- > 0;) {
+        next_entry[e] = first_entry[cached->entries[e].file_index];
+        first_entry[cached->entries[e].file_index] = e;
+      }
+    }
+  }
+
+  bool changed = !cached || cached->file_count != file_count;
+  size_t rescanned = 0;
+
+  for (size_t i = 0; i < file_count; i++) {
+    // Reuse cached entries when the file was indexed before (at any position) with the same stat
+    bool reused = false;
+    const fast5_index_file_t **match = cached ?
+        bsearch(files[i], by_path, cached->file_count, sizeof(*by_path), compare_path_to_file) : NULL;
+    if (match) {
+      size_t cached_index = (size_t)(*match - cached->files);
+      if (!fast5_index_file_is_stale(cached, cached_index)) {
+        reused = copy_cached_file(index, cached, cached_index, first_entry, next_entry);
+        changed |= reused && cached_index != i;   // Same files, new order: the sidecar is rewritten
+      }
+    }
+
+    if (!reused) {
+      changed = true;
+      rescanned++;
+      if (fast5_index_add_file(index, files[i]) < 0) {
+        warnx("Cannot index file: %s", files[i]);
+      }
+    }
+
+    if (file_count > 1) {
+      display_progress_simple((int)(i + 1), (int)file_count, verbose, "indexing files");
+    }
+  }
+  if (file_count > 1) {
+    printf("\n");
+  }
+
+  if (verbose) {
+    printf("Index: %zu reads in %zu files (%zu rescanned)\n",
+           index->entry_count, index->file_count, rescanned);
+  }
+
+  if (sidecar_path && changed) {
+    fast5_index_save(index, sidecar_path);
+  }
+
+  free(first_entry);
+  free(next_entry);
+  free(by_path);
+  fast5_index_free(cached);
+  return index;
+}
@@ -0,0 +1,83 @@
+// **********************************************************************
+// core/fast5_index.h - Read-ID Index for Fast5 Files
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// In-memory hash map from read_id to (file, HDF5 group path, signal length,
+// dataset offset), optionally persisted as a per-directory sidecar file.
+// Entries are invalidated by file mtime/size so a stale sidecar is rebuilt
+// file-by-file rather than trusted.
+#ifndef SEQUELIZER_FAST5_INDEX_H
+#define SEQUELIZER_FAST5_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "seq_tensor.h"
+
+// Sidecar written next to the Fast5 files of a directory
+#define FAST5_INDEX_SIDECAR_NAME ".sequelizer_fast5.idx"
+
+// One indexed read
+typedef struct {
+  char *read_id;
+  size_t file_index;        // Index into fast5_index_t.files
+  char *group_path;         // "/read_<id>" (multi-read) or "/Raw/Reads/Read_N" (single-read)
+  uint32_t signal_length;
+  uint64_t dataset_offset;  // FAST5_OFFSET_UNDEFINED when chunked/compressed
+} fast5_index_entry_t;
+
+// One indexed file with the stat values the entries were built from
+typedef struct {
+  char *path;
+  int64_t mtime;
+  int64_t size;
+} fast5_index_file_t;
+
+typedef struct {
+  fast5_index_file_t *files;
+  size_t file_count;
+  size_t file_capacity;
+
+  fast5_index_entry_t *entries;
+  size_t entry_count;
+  size_t entry_capacity;
+
+  // Open-addressing hash table: slot holds entry index + 1 (0 = empty)
+  size_t *slots;
+  size_t slot_capacity;
+} fast5_index_t;
+
+// Construction and cleanup
+fast5_index_t* fast5_index_create(void);
+void           fast5_index_free(fast5_index_t *index);
+
+// Scan one Fast5 file (single open via fast5_reader_t) and add all of its reads
+// Returns number of reads added, or -1 on failure
+int fast5_index_add_file(fast5_index_t *index, const char *path);
+
+// Build an index for files, reusing entries from sidecar_path for files whose
+// mtime/size are unchanged and rescanning the rest; the sidecar is rewritten
+// when anything changed (pass sidecar_path = NULL for a purely in-memory index)
+fast5_index_t* fast5_index_build(char **files, size_t file_count, const char *sidecar_path, bool verbose);
+
+// Sidecar path for an input path (directory inputs only; NULL for single files)
+// Caller must free returned string
+char* fast5_index_sidecar_path(const char *input_path);
+
+// Sidecar persistence
+int            fast5_index_save(const fast5_index_t *index, const char *path);
+fast5_index_t* fast5_index_load(const char *path);
+
+// Lookup (O(1) average); returns NULL if read_id is not indexed
+const fast5_index_entry_t* fast5_index_lookup(const fast5_index_t *index, const char *read_id);
+
+// True if the file changed on disk since it was indexed
+bool fast5_index_file_is_stale(const fast5_index_t *index, size_t file_index);
+
+// Random access by read id: direct group open, with a scan fallback if the file went stale
+// Returns native int16 [n_samples × 1] tensor with calibration (see read_fast5_signal_raw)
+// Caller must free returned tensor with seq_tensor_free()
+seq_tensor* fast5_index_read_signal(const fast5_index_t *index, const char *read_id);
+
+#endif // SEQUELIZER_FAST5_INDEX_H
@@ -10,15 +10,94 @@
 // Used by sequelizer fast5 subcommand and future signal processing.
 
 #include "fast5_io.h"
+#include "fast5_chunks.h"
+#include "fast5_discovery.h"
+#include "fast5_paged_vfd.h"
+#include "seq_kernels.h"
+#include "seq_profile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <hdf5.h>
-#include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <limits.h>
+#include <math.h>
 #include <err.h>
 
+// **********************************************************************
+// Fast5 File Access Modes
+// **********************************************************************
+static fast5_io_options_t io_options = {FAST5_IO_POSIX, FAST5_IO_DEFAULT_PAGE_SIZE, FAST5_IO_DEFAULT_PREFETCH_PAGES, 1};
+
+// Page cache per open file in paged mode (at least FAST5_IO_MIN_CACHE_PAGES pages)
+#define FAST5_IO_CACHE_BYTES (16 * 1024 * 1024)
+#define FAST5_IO_MIN_CACHE_PAGES 16
+
+bool fast5_parse_io_mode(const char *name, fast5_io_mode_t *mode) {
+  if (!name) return false;
+  if (strcmp(name, "posix") == 0) {
+    *mode = FAST5_IO_POSIX;
+  } else if (strcmp(name, "core") == 0) {
+    *mode = FAST5_IO_CORE;
+  } else if (strcmp(name, "paged") == 0) {
+    *mode = FAST5_IO_PAGED;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void fast5_set_io_options(const fast5_io_options_t *options) {
+  io_options = *options;
+  if (io_options.page_size == 0) io_options.page_size = FAST5_IO_DEFAULT_PAGE_SIZE;
+}
+
+// H5Aread, counted for --profile
+static herr_t read_attribute(hid_t attr_id, hid_t type_id, void *buffer) {
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  return H5Aread(attr_id, type_id, buffer);
+}
+
+// H5Fopen read-only with the given access properties, timed for --profile
+static hid_t profiled_open(const char *filename, hid_t fapl) {
+  uint64_t profile_start = SEQ_PROFILE_START();
+  hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, fapl);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_H5FOPEN, profile_start);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  return file_id;
+}
+
+// Every read-only open of a file being read (not just classified) goes through
+// here so the access mode applies to metadata scans and signal loads alike
+static hid_t open_fast5_readonly(const char *filename) {
+  if (io_options.mode == FAST5_IO_POSIX) {
+    return profiled_open(filename, H5P_DEFAULT);
+  }
+
+  hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+  if (fapl < 0) return profiled_open(filename, H5P_DEFAULT);
+
+  hid_t file_id = -1;
+  if (io_options.mode == FAST5_IO_CORE) {
+    // Read-only core files are loaded with one read at open; every later
+    // metadata or Signal access is a memcpy (no backing store is written)
+    H5Pset_fapl_core(fapl, io_options.page_size, 0);
+    file_id = profiled_open(filename, fapl);
+  } else {
+    // Every HDF5 request is served from a per-file page cache (see fast5_paged_vfd.h)
+    size_t cache_pages = FAST5_IO_CACHE_BYTES / io_options.page_size;
+    if (cache_pages < FAST5_IO_MIN_CACHE_PAGES) cache_pages = FAST5_IO_MIN_CACHE_PAGES;
+    if (fast5_paged_vfd_set_fapl(fapl, io_options.page_size, cache_pages,
+                                 io_options.prefetch_pages) >= 0) {
+      file_id = profiled_open(filename, fapl);
+    }
+  }
+  H5Pclose(fapl);
+  return file_id;
+}
+
 // **********************************************************************
 // Fast5 File Discovery and Validation Functions
 // **********************************************************************
@@ -42,15 +121,37 @@ bool is_likely_fast5_file(const char *filename) {
   return len >= 6 && strcmp(filename + len - 6, ".fast5") == 0;
 }
 
+// Every HDF5 file starts its superblock with this signature, at offset 0 or,
+// after a user block, at 512, 1024, 2048, ... bytes
+static const unsigned char hdf5_signature[8] = {0x89, 'H', 'D', 'F', '\r', '\n', 0x1a, '\n'};
+#define HDF5_SIGNATURE_MAX_OFFSET ((off_t)1 << 30)
+
+bool has_hdf5_signature_fd(int fd) {
+  unsigned char bytes[sizeof(hdf5_signature)];
+  for (off_t offset = 0; offset <= HDF5_SIGNATURE_MAX_OFFSET; offset = offset ? offset * 2 : 512) {
+    if (pread(fd, bytes, sizeof(bytes), offset) != (ssize_t)sizeof(bytes)) return false;
+    if (memcmp(bytes, hdf5_signature, sizeof(bytes)) == 0) return true;
+  }
+  return false;
+}
+
+bool has_hdf5_signature(const char *filename) {
+  int fd = open(filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  bool found = has_hdf5_signature_fd(fd);
+  close(fd);
+  return found;
+}
+
 bool is_valid_hdf5_file(const char *filename) {
+  // Reject non-HDF5 files from their first bytes, before paying for an H5Fopen
+  if (!has_hdf5_signature(filename)) return false;
+
   // Suppress HDF5 error messages temporarily
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+  fast5_hdf5_quiet_begin();
   
   // Simple HDF5 file validation
-  hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = profiled_open(filename, H5P_DEFAULT);
   bool is_valid = (file_id >= 0);
   
   if (is_valid) {
@@ -58,19 +159,21 @@ bool is_valid_hdf5_file(const char *filename) {
   }
   
   // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
+  fast5_hdf5_quiet_end();
   
   return is_valid;
 }
 
 bool has_fast5_structure(const char *filename) {
+  if (!has_hdf5_signature(filename)) return false;
+
   // Create thread-local error stack for thread safety
   hid_t error_stack = H5Ecreate_stack();
   if (error_stack >= 0) {
     H5Eset_auto2(error_stack, NULL, NULL);
   }
   
-  hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = profiled_open(filename, H5P_DEFAULT);
   if (file_id < 0) {
     if (error_stack >= 0) {
       H5Eclose_stack(error_stack);
@@ -118,92 +221,74 @@ bool has_fast5_structure(const char *filename) {
   return has_structure;
 }
 
-// Recursive directory traversal
-char** find_fast5_files_recursive(const char *directory, size_t *count) {
-  DIR *dir;
-  struct dirent *entry;
-  struct stat file_stat;
-  char path[PATH_MAX];
-  char **files = NULL;
-  size_t files_capacity = 0;
+static int compare_file_paths(const void *a, const void *b) {
+  return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+// Drain a discovery stream into a sorted list, reporting progress on slow scans.
+// An empty listing is an allocated array with *count 0; NULL means the scan failed
+static char** collect_discovered_files(fast5_discovery_t *discovery, size_t *count) {
+  // Start with 1024 instead of 16 to reduce realloc() calls for large directories
+  // Typical nanopore runs have thousands of files, so this avoids multiple reallocations
+  size_t files_capacity = 1024;
+  char **files = malloc(files_capacity * sizeof(char*));
   *count = 0;
-  
-  dir = opendir(directory);
-  if (!dir) {
-    warnx("Cannot open directory: %s", directory);
-    return NULL;
-  }
-  
-  while ((entry = readdir(dir)) != NULL) {
-    if (entry->d_name[0] == '.') continue; // Skip hidden files and . ..
-    
-    snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
-    
-    if (stat(path, &file_stat) != 0) {
-      warnx("Cannot stat file: %s", path);
-      continue;
-    }
-    
-    if (S_ISDIR(file_stat.st_mode)) {
-      // Recursively search subdirectories
-      size_t subdir_count;
-      char **subdir_files = find_fast5_files_recursive(path, &subdir_count);
-      
-      if (subdir_files && subdir_count > 0) {
-        // Ensure capacity is sufficient for new files
-        size_t new_total = *count + subdir_count;
-        if (new_total > files_capacity) {
-          files_capacity = new_total;
-          files = realloc(files, files_capacity * sizeof(char*));
-          if (!files) {
-            errx(EXIT_FAILURE, "Memory allocation failed");
-          }
-        }
-        
-        // Copy subdirectory files to main array
-        for (size_t i = 0; i < subdir_count; i++) {
-          files[*count + i] = subdir_files[i];
-        }
-        *count += subdir_count;
-        free(subdir_files); // Free the array, but not the strings
-      }
-    } else if (S_ISREG(file_stat.st_mode) && is_fast5_file(entry->d_name)) {
-      // Add Fast5 file to list
-      if (*count >= files_capacity) {
-        // Start with 1024 instead of 16 to reduce realloc() calls for large directories
-        // Typical nanopore runs have thousands of files, so this avoids multiple reallocations
-        files_capacity = files_capacity == 0 ? 1024 : files_capacity * 2;
-        files = realloc(files, files_capacity * sizeof(char*));
-        if (!files) {
-          errx(EXIT_FAILURE, "Memory allocation failed");
-        }
-      }
-      
-      files[*count] = strdup(path);
-      if (!files[*count]) {
-        errx(EXIT_FAILURE, "Memory allocation failed");
-      }
-      (*count)++;
 
-      // Show progress every 500 files to give feedback during slow directory scans
-      if (*count % 500 == 0) {
-        printf("\rDiscovered %zu Fast5 files...", *count);
-        fflush(stdout);
+  char *path;
+  while (files && (path = fast5_discovery_next(discovery)) != NULL) {
+    if (*count >= files_capacity) {
+      files_capacity *= 2;
+      char **grown = realloc(files, files_capacity * sizeof(char*));
+      if (!grown) {
+        free(path);
+        free_file_list(files, *count);
+        files = NULL;
+        break;
       }
+      files = grown;
     }
-  }
+    files[(*count)++] = path;
 
-  closedir(dir);
+    // Show progress every 500 files to give feedback during slow directory scans
+    if (*count % 500 == 0) {
+      printf("\rDiscovered %zu Fast5 files...", *count);
+      fflush(stdout);
+    }
+  }
+  if (files && fast5_discovery_incomplete(discovery)) {
+    free_file_list(files, *count);
+    files = NULL;
+  }
+  fast5_discovery_close(discovery);
 
   // Clear the progress line if we showed any updates
   if (*count >= 500) {
     printf("\r");
     fflush(stdout);
   }
+  if (!files) {
+    warnx("Memory allocation failed while listing Fast5 files");
+    *count = 0;
+    return NULL;
+  }
 
+  // Walkers finish directories in no fixed order; sort so listings (and index
+  // sidecars keyed on file order) are identical from run to run
+  if (*count > 1) {
+    qsort(files, *count, sizeof(char*), compare_file_paths);
+  }
   return files;
 }
 
+// Recursive directory traversal (parallel walkers, see fast5_discovery.h)
+char** find_fast5_files_recursive(const char *directory, size_t *count) {
+  *count = 0;
+  fast5_discovery_options_t options = {.recursive = true, .check_signature = false, .threads = 0};
+  fast5_discovery_t *discovery = fast5_discovery_start(directory, &options);
+  if (!discovery) return NULL;
+  return collect_discovered_files(discovery, count);
+}
+
 // Main discovery function handling files/directories
 char** find_fast5_files(const char *input_path, bool recursive, size_t *count) {
   struct stat path_stat;
@@ -211,86 +296,28 @@ char** find_fast5_files(const char *input_path, bool recursive, size_t *count) {
   
   // Check if input path exists
   if (stat(input_path, &path_stat) != 0) {
-    errx(EXIT_FAILURE, "Input path does not exist: %s", input_path);
+    warnx("Input path does not exist: %s", input_path);
+    return NULL;
   }
   
   if (S_ISREG(path_stat.st_mode)) {
     // Single file
-    if (is_fast5_file(input_path)) {
-      char **files = malloc(sizeof(char*));
-      if (!files) {
-        errx(EXIT_FAILURE, "Memory allocation failed");
-      }
-      files[0] = strdup(input_path);
-      if (!files[0]) {
-        errx(EXIT_FAILURE, "Memory allocation failed");
-      }
-      *count = 1;
-      return files;
-    } else {
-      errx(EXIT_FAILURE, "Input file is not a Fast5 file: %s", input_path);
+    if (!is_fast5_file(input_path)) {
+      warnx("Input file is not a Fast5 file: %s", input_path);
+      return NULL;
     }
-  } else if (S_ISDIR(path_stat.st_mode)) {
-    // Directory
-    if (recursive) {
-      return find_fast5_files_recursive(input_path, count);
-    } else {
-      // Non-recursive directory search
-      DIR *dir;
-      struct dirent *entry;
-      char **files = NULL;
-      size_t files_capacity = 0;
-
-      dir = opendir(input_path);
-      if (!dir) {
-        errx(EXIT_FAILURE, "Cannot open directory: %s", input_path);
-      }
-
-      while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_name[0] == '.') continue; // Skip hidden files
-
-        if (is_fast5_file(entry->d_name)) {
-          if (*count >= files_capacity) {
-            // Start with 1024 instead of 16 to reduce realloc() calls for large directories
-            // Typical nanopore runs have thousands of files, so this avoids multiple reallocations
-            files_capacity = files_capacity == 0 ? 1024 : files_capacity * 2;
-            files = realloc(files, files_capacity * sizeof(char*));
-            if (!files) {
-              errx(EXIT_FAILURE, "Memory allocation failed");
-            }
-          }
-          
-          char path[PATH_MAX];
-          snprintf(path, sizeof(path), "%s/%s", input_path, entry->d_name);
-          files[*count] = strdup(path);
-          if (!files[*count]) {
-            errx(EXIT_FAILURE, "Memory allocation failed");
-          }
-          (*count)++;
-
-          // Show progress every 500 files to give feedback during slow directory scans
-          if (*count % 500 == 0) {
-            printf("\rDiscovered %zu Fast5 files...", *count);
-            fflush(stdout);
-          }
-        }
-      }
-
-      closedir(dir);
-
-      // Clear the progress line if we showed any updates
-      if (*count >= 500) {
-        printf("\r");
-        fflush(stdout);
-      }
+  } else if (!S_ISDIR(path_stat.st_mode)) {
+    warnx("Input path is neither a file nor a directory: %s", input_path);
+    return NULL;
+  }
 
-      return files;
-    }
-  } else {
-    errx(EXIT_FAILURE, "Input path is neither a file nor a directory: %s", input_path);
+  fast5_discovery_options_t options = {.recursive = recursive, .check_signature = false, .threads = 0};
+  fast5_discovery_t *discovery = fast5_discovery_start(input_path, &options);
+  if (!discovery) {
+    warnx("Cannot open directory: %s", input_path);
+    return NULL;
   }
-  
-  return NULL;
+  return collect_discovered_files(discovery, count);
 }
 
 // Memory cleanup
@@ -322,7 +349,7 @@ static char* read_string_attribute(hid_t obj_id, const char *attr_name) {
     return NULL;
   }
   
-  if (H5Aread(attr_id, type_id, buffer) < 0) {
+  if (read_attribute(attr_id, type_id, buffer) < 0) {
     free(buffer);
     buffer = NULL;
   } else {
@@ -339,7 +366,7 @@ static bool read_uint32_attribute(hid_t obj_id, const char *attr_name, uint32_t
   hid_t attr_id = H5Aopen(obj_id, attr_name, H5P_DEFAULT);
   if (attr_id < 0) return false;
   
-  bool success = (H5Aread(attr_id, H5T_NATIVE_UINT32, value) >= 0);
+  bool success = (read_attribute(attr_id, H5T_NATIVE_UINT32, value) >= 0);
   H5Aclose(attr_id);
   return success;
 }
@@ -349,7 +376,7 @@ static bool read_double_attribute(hid_t obj_id, const char *attr_name, double *v
   hid_t attr_id = H5Aopen(obj_id, attr_name, H5P_DEFAULT);
   if (attr_id < 0) return false;
   
-  bool success = (H5Aread(attr_id, H5T_NATIVE_DOUBLE, value) >= 0);
+  bool success = (read_attribute(attr_id, H5T_NATIVE_DOUBLE, value) >= 0);
   H5Aclose(attr_id);
   return success;
 }
@@ -370,17 +397,25 @@ static hsize_t get_signal_length(hid_t signal_dataset_id) {
 // Fast5 Metadata Reading Functions
 // **********************************************************************
 
+// Release the strings owned by a single metadata entry (the struct itself is caller-owned)
+void clear_fast5_metadata(fast5_metadata_t *metadata) {
+  if (!metadata) return;
+
+  free(metadata->read_id);
+  free(metadata->file_path);
+  // Only free if it exists (safe for both basic and enhanced)
+  free(metadata->compression_method);
+  free(metadata->run_id);
+  free(metadata->channel_number);
+  memset(metadata, 0, sizeof(*metadata));
+}
+
 // Free Fast5 metadata
 void free_fast5_metadata(fast5_metadata_t *metadata, size_t count) {
   if (!metadata) return;
   
   for (size_t i = 0; i < count; i++) {
-    free(metadata[i].read_id);
-    free(metadata[i].file_path);
-    // Only free if it exists (safe for both basic and enhanced)
-    free(metadata[i].compression_method);
-    free(metadata[i].run_id);
-    free(metadata[i].channel_number);
+    clear_fast5_metadata(&metadata[i]);
   }
   free(metadata);
 }
@@ -402,857 +437,938 @@ static bool is_valid_text_string(const char *str, size_t max_len) {
   return true;
 }
 
-// Enhancer function to extract tracking_id metadata (run_id, etc.)
-void extract_tracking_id(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
-  // Initialize field
-  metadata->run_id = NULL;
+// Helper function to read a printable string attribute (fixed or variable length)
+static char* read_text_attribute(hid_t obj_id, const char *attr_name) {
+  hid_t attr_id = H5Aopen(obj_id, attr_name, H5P_DEFAULT);
+  if (attr_id < 0) return NULL;
 
-  if (signal_dataset_id < 0) return;
+  char *text = NULL;
+  hid_t type_id = H5Aget_type(attr_id);
+  if (H5Tis_variable_str(type_id) > 0) {
+    // Variable-length string: HDF5 allocates, we copy and free its memory
+    char *vlen_str = NULL;
+    if (read_attribute(attr_id, type_id, &vlen_str) >= 0 && vlen_str) {
+      if (is_valid_text_string(vlen_str, strlen(vlen_str))) {
+        text = strdup(vlen_str);
+      }
+      H5free_memory(vlen_str);
+    }
+  } else {
+    // Fixed-length string: read into a NUL-terminated buffer
+    size_t size = H5Tget_size(type_id);
+    text = calloc(size + 1, 1);
+    if (text && (read_attribute(attr_id, type_id, text) < 0 || !is_valid_text_string(text, size))) {
+      free(text);
+      text = NULL;
+    }
+  }
+  H5Tclose(type_id);
+  H5Aclose(attr_id);
+  return text;
+}
 
-  // Suppress HDF5 error messages for missing groups/attributes
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+// Any scalar attribute as text: strings as stored, integers in decimal, floats
+// as the shortest "%g" form that reads back unchanged
+char* fast5_attribute_text(hid_t obj_id, const char *attr_name) {
+  hid_t attr_id = H5Aopen(obj_id, attr_name, H5P_DEFAULT);
+  if (attr_id < 0) return NULL;
 
-  // Get the dataset path to determine format
-  char obj_name[256];
-  ssize_t name_len = H5Iget_name(signal_dataset_id, obj_name, sizeof(obj_name));
-  if (name_len <= 0) {
-    H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-    return;
-  }
+  hid_t type_id = H5Aget_type(attr_id);
+  hid_t space_id = H5Aget_space(attr_id);
+  H5T_class_t type_class = H5Tget_class(type_id);
+  bool scalar = space_id >= 0 && H5Sget_simple_extent_npoints(space_id) == 1;
+  H5Sclose(space_id);
+  H5Tclose(type_id);
 
-  // Parse path to determine format and extract run_id
-  if (strstr(obj_name, "/Raw/Reads/")) {
-    // Single-read format: /Raw/Reads/Read_xxx/Signal
-    // Get run_id from /UniqueGlobalKey/tracking_id/run_id
-    hid_t tracking_group_id = H5Gopen2(file_id, "/UniqueGlobalKey/tracking_id", H5P_DEFAULT);
-    if (tracking_group_id >= 0) {
-      hid_t attr_id = H5Aopen(tracking_group_id, "run_id", H5P_DEFAULT);
-      if (attr_id >= 0) {
-        hid_t type_id = H5Aget_type(attr_id);
-        htri_t is_vlen = H5Tis_variable_str(type_id);
-
-        if (is_vlen > 0) {
-          // Variable-length string: read pointer to string
-          char *vlen_str = NULL;
-          herr_t status = H5Aread(attr_id, type_id, &vlen_str);
-          if (status >= 0 && vlen_str) {
-            // Validate the string
-            size_t len = strlen(vlen_str);
-            if (is_valid_text_string(vlen_str, len)) {
-              metadata->run_id = strdup(vlen_str);
-            }
-            // Free HDF5's memory
-            H5free_memory(vlen_str);
-          }
-        } else {
-          // Fixed-length string: read into buffer
-          size_t size = H5Tget_size(type_id);
-          char *temp_str = malloc(size + 1);
-          if (temp_str) {
-            memset(temp_str, 0, size + 1);
-            H5Aread(attr_id, type_id, temp_str);
-            temp_str[size] = '\0';
-
-            // Validate that the string contains printable characters
-            if (is_valid_text_string(temp_str, size)) {
-              metadata->run_id = temp_str;
-            } else {
-              free(temp_str);
-              metadata->run_id = NULL;
-            }
-          }
-        }
-        H5Tclose(type_id);
-        H5Aclose(attr_id);
-      }
-      H5Gclose(tracking_group_id);
+  char text[32];
+  char *result = NULL;
+  if (type_class == H5T_STRING) {
+    H5Aclose(attr_id);
+    return read_text_attribute(obj_id, attr_name);
+  } else if (scalar && type_class == H5T_INTEGER) {
+    long long value;
+    if (read_attribute(attr_id, H5T_NATIVE_LLONG, &value) >= 0) {
+      snprintf(text, sizeof(text), "%lld", value);
+      result = strdup(text);
     }
-  } else if (strstr(obj_name, "/read_")) {
-    // Multi-read format: /read_xxx/Raw/Signal
-    // Find the read group (extract read_xxx path)
-    char read_path[256];
-    strncpy(read_path, obj_name, sizeof(read_path));
-    char *raw_pos = strstr(read_path, "/Raw/Signal");
-    if (raw_pos) {
-      *raw_pos = '\0'; // Get read_xxx path
-
-      // Get run_id from read_xxx/tracking_id/run_id
-      char tracking_path[512];
-      snprintf(tracking_path, sizeof(tracking_path), "%s/tracking_id", read_path);
-      hid_t tracking_group_id = H5Gopen2(file_id, tracking_path, H5P_DEFAULT);
-      if (tracking_group_id >= 0) {
-        hid_t attr_id = H5Aopen(tracking_group_id, "run_id", H5P_DEFAULT);
-        if (attr_id >= 0) {
-          hid_t type_id = H5Aget_type(attr_id);
-          htri_t is_vlen = H5Tis_variable_str(type_id);
-
-          if (is_vlen > 0) {
-            // Variable-length string: read pointer to string
-            char *vlen_str = NULL;
-            herr_t status = H5Aread(attr_id, type_id, &vlen_str);
-            if (status >= 0 && vlen_str) {
-              // Validate the string
-              size_t len = strlen(vlen_str);
-              if (is_valid_text_string(vlen_str, len)) {
-                metadata->run_id = strdup(vlen_str);
-              }
-              // Free HDF5's memory
-              H5free_memory(vlen_str);
-            }
-          } else {
-            // Fixed-length string: read into buffer
-            size_t size = H5Tget_size(type_id);
-            char *temp_str = malloc(size + 1);
-            if (temp_str) {
-              memset(temp_str, 0, size + 1);
-              H5Aread(attr_id, type_id, temp_str);
-              temp_str[size] = '\0';
-
-              // Validate that the string contains printable characters
-              if (is_valid_text_string(temp_str, size)) {
-                metadata->run_id = temp_str;
-              } else {
-                free(temp_str);
-                metadata->run_id = NULL;
-              }
-            }
-          }
-          H5Tclose(type_id);
-          H5Aclose(attr_id);
-        }
-        H5Gclose(tracking_group_id);
+  } else if (scalar && type_class == H5T_FLOAT) {
+    double value;
+    if (read_attribute(attr_id, H5T_NATIVE_DOUBLE, &value) >= 0) {
+      for (int precision = 6; precision <= 17; precision++) {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, NULL) == value) break;
       }
+      result = strdup(text);
     }
   }
+  H5Aclose(attr_id);
+  return result;
+}
 
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
+// Identity of an HDF5 object, so hard-linked groups compare equal (ONT multi-read
+// files link every read's tracking_id to one shared group)
+typedef struct {
+  unsigned long fileno;
+#if H5_VERSION_GE(1, 12, 0)
+  H5O_token_t token;
+#else
+  haddr_t addr;
+#endif
+} object_identity_t;
+
+static bool get_object_identity(hid_t obj_id, object_identity_t *identity) {
+  H5O_info_t info;
+#if H5_VERSION_GE(1, 12, 0)
+  if (H5Oget_info3(obj_id, &info, H5O_INFO_BASIC) < 0) return false;
+  identity->token = info.token;
+#else
+  if (H5Oget_info2(obj_id, &info, H5O_INFO_BASIC) < 0) return false;
+  identity->addr = info.addr;
+#endif
+  identity->fileno = info.fileno;
+  return true;
 }
 
-// Enhancer function to extract channel_number from channel_id group
-void extract_channel_id(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
-  // Initialize field
-  metadata->channel_number = NULL;
+static bool same_object(const object_identity_t *a, const object_identity_t *b) {
+#if H5_VERSION_GE(1, 12, 0)
+  return a->fileno == b->fileno && memcmp(&a->token, &b->token, sizeof(a->token)) == 0;
+#else
+  return a->fileno == b->fileno && a->addr == b->addr;
+#endif
+}
 
-  if (signal_dataset_id < 0) return;
+// Attribute values of shared groups, read once per reader: the file-level
+// tracking_id of single-read files, or a tracking_id hard-linked across reads
+struct fast5_attribute_cache {
+  bool has_run_id;
+  object_identity_t run_id_source;
+  char *run_id;
+};
+
+static void attribute_cache_clear(fast5_attribute_cache_t *cache) {
+  free(cache->run_id);
+  memset(cache, 0, sizeof(*cache));
+}
 
-  // Suppress HDF5 error messages for missing groups/attributes
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+// Enhancer function to extract tracking_id metadata (run_id, etc.)
+void extract_tracking_id(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
+  // Initialize field
+  metadata->run_id = NULL;
 
-  // Get the dataset path to determine format
-  char obj_name[256];
-  ssize_t name_len = H5Iget_name(signal_dataset_id, obj_name, sizeof(obj_name));
-  if (name_len <= 0) {
-    H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
+  if (read->tracking_group_id < 0) return;
+
+  // Reuse the value read from this very group for an earlier read
+  fast5_attribute_cache_t *cache = read->cache;
+  object_identity_t identity;
+  bool known = cache && get_object_identity(read->tracking_group_id, &identity);
+  if (known && cache->has_run_id && same_object(&identity, &cache->run_id_source)) {
+    metadata->run_id = cache->run_id ? strdup(cache->run_id) : NULL;
     return;
   }
 
-  // Parse path to determine format and extract channel_number
-  if (strstr(obj_name, "/Raw/Reads/")) {
-    // Single-read format: /Raw/Reads/Read_xxx/Signal
-    // Get channel_number from /UniqueGlobalKey/channel_id/channel_number
-    hid_t channel_group_id = H5Gopen2(file_id, "/UniqueGlobalKey/channel_id", H5P_DEFAULT);
-    if (channel_group_id >= 0) {
-      hid_t attr_id = H5Aopen(channel_group_id, "channel_number", H5P_DEFAULT);
-      if (attr_id >= 0) {
-        hid_t type_id = H5Aget_type(attr_id);
-        htri_t is_vlen = H5Tis_variable_str(type_id);
-
-        if (is_vlen > 0) {
-          // Variable-length string: read pointer to string
-          char *vlen_str = NULL;
-          herr_t status = H5Aread(attr_id, type_id, &vlen_str);
-          if (status >= 0 && vlen_str) {
-            // Validate the string
-            size_t len = strlen(vlen_str);
-            if (is_valid_text_string(vlen_str, len)) {
-              metadata->channel_number = strdup(vlen_str);
-            }
-            // Free HDF5's memory
-            H5free_memory(vlen_str);
-          }
-        } else {
-          // Fixed-length string: read into buffer
-          size_t size = H5Tget_size(type_id);
-          char *temp_str = malloc(size + 1);
-          if (temp_str) {
-            memset(temp_str, 0, size + 1);
-            H5Aread(attr_id, type_id, temp_str);
-            temp_str[size] = '\0';
-
-            // Validate that the string contains printable characters
-            if (is_valid_text_string(temp_str, size)) {
-              metadata->channel_number = temp_str;
-            } else {
-              free(temp_str);
-              metadata->channel_number = NULL;
-            }
-          }
-        }
-        H5Tclose(type_id);
-        H5Aclose(attr_id);
-      }
-      H5Gclose(channel_group_id);
-    }
-  } else if (strstr(obj_name, "/read_")) {
-    // Multi-read format: /read_xxx/Raw/Signal
-    // Find the read group (extract read_xxx path)
-    char read_path[256];
-    strncpy(read_path, obj_name, sizeof(read_path));
-    char *raw_pos = strstr(read_path, "/Raw/Signal");
-    if (raw_pos) {
-      *raw_pos = '\0'; // Get read_xxx path
-
-      // Get channel_number from read_xxx/channel_id/channel_number
-      char channel_path[512];
-      snprintf(channel_path, sizeof(channel_path), "%s/channel_id", read_path);
-      hid_t channel_group_id = H5Gopen2(file_id, channel_path, H5P_DEFAULT);
-      if (channel_group_id >= 0) {
-        hid_t attr_id = H5Aopen(channel_group_id, "channel_number", H5P_DEFAULT);
-        if (attr_id >= 0) {
-          hid_t type_id = H5Aget_type(attr_id);
-          htri_t is_vlen = H5Tis_variable_str(type_id);
-
-          if (is_vlen > 0) {
-            // Variable-length string: read pointer to string
-            char *vlen_str = NULL;
-            herr_t status = H5Aread(attr_id, type_id, &vlen_str);
-            if (status >= 0 && vlen_str) {
-              // Validate the string
-              size_t len = strlen(vlen_str);
-              if (is_valid_text_string(vlen_str, len)) {
-                metadata->channel_number = strdup(vlen_str);
-              }
-              // Free HDF5's memory
-              H5free_memory(vlen_str);
-            }
-          } else {
-            // Fixed-length string: read into buffer
-            size_t size = H5Tget_size(type_id);
-            char *temp_str = malloc(size + 1);
-            if (temp_str) {
-              memset(temp_str, 0, size + 1);
-              H5Aread(attr_id, type_id, temp_str);
-              temp_str[size] = '\0';
-
-              // Validate that the string contains printable characters
-              if (is_valid_text_string(temp_str, size)) {
-                metadata->channel_number = temp_str;
-              } else {
-                free(temp_str);
-                metadata->channel_number = NULL;
-              }
-            }
-          }
-          H5Tclose(type_id);
-          H5Aclose(attr_id);
-        }
-        H5Gclose(channel_group_id);
-      }
-    }
+  // Single-read: /UniqueGlobalKey/tracking_id; multi-read: read_xxx/tracking_id
+  metadata->run_id = read_text_attribute(read->tracking_group_id, "run_id");
+  if (known) {
+    free(cache->run_id);
+    cache->run_id = metadata->run_id ? strdup(metadata->run_id) : NULL;
+    cache->run_id_source = identity;
+    cache->has_run_id = true;
   }
+}
 
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
+// Enhancer function to extract channel_number from channel_id group
+void extract_channel_id(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
+  // Initialize field
+  metadata->channel_number = NULL;
+
+  // Single-read: /UniqueGlobalKey/channel_id; multi-read: read_xxx/channel_id
+  if (read->channel_group_id >= 0) {
+    metadata->channel_number = read_text_attribute(read->channel_group_id, "channel_number");
+  }
 }
 
 // Enhancer function to extract calibration parameters from Fast5 files
-void extract_calibration_parameters(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
+void extract_calibration_parameters(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
   // Initialize calibration fields
   metadata->offset = 0.0;
   metadata->range = 0.0;
   metadata->digitisation = 0.0;
   metadata->calibration_available = false;
 
-  if (signal_dataset_id < 0) return;
-
-  // Suppress HDF5 error messages for missing groups/attributes
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
-  
-  // Get the dataset path to determine read location
-  char obj_name[256];
-  ssize_t name_len = H5Iget_name(signal_dataset_id, obj_name, sizeof(obj_name));
-  if (name_len <= 0) return;
-  
-  hid_t channel_group_id = -1;
-  
-  if (strstr(obj_name, "/Raw/Reads/")) {
-    // Single-read format: /Raw/Reads/Read_xxx/Signal -> /UniqueGlobalKey/channel_id
-    channel_group_id = H5Gopen2(file_id, "/UniqueGlobalKey/channel_id", H5P_DEFAULT);
-  } else if (strstr(obj_name, "/Raw/Signal")) {
-    // Multi-read format: /read_<UUID>/Raw/Signal -> /read_<UUID>/channel_id
-    char channel_path[512];
-    char *read_part = strstr(obj_name, "/read_");
-    if (read_part) {
-      char *raw_part = strstr(read_part, "/Raw");
-      if (raw_part) {
-        size_t read_len = raw_part - obj_name;
-        snprintf(channel_path, sizeof(channel_path), "%.*s/channel_id", (int)read_len, obj_name);
-        channel_group_id = H5Gopen2(file_id, channel_path, H5P_DEFAULT);
-      }
-    }
-  }
-  
-  if (channel_group_id >= 0) {
-    bool got_offset = false, got_range = false, got_digitisation = false;
-    
-    // Extract offset
-    hid_t offset_attr = H5Aopen(channel_group_id, "offset", H5P_DEFAULT);
-    if (offset_attr >= 0) {
-      if (H5Aread(offset_attr, H5T_NATIVE_DOUBLE, &metadata->offset) >= 0) {
-        got_offset = true;
-      }
-      H5Aclose(offset_attr);
-    }
-    
-    // Extract range
-    hid_t range_attr = H5Aopen(channel_group_id, "range", H5P_DEFAULT);
-    if (range_attr >= 0) {
-      if (H5Aread(range_attr, H5T_NATIVE_DOUBLE, &metadata->range) >= 0) {
-        got_range = true;
-      }
-      H5Aclose(range_attr);
-    }
-    
-    // Extract digitisation
-    hid_t digitisation_attr = H5Aopen(channel_group_id, "digitisation", H5P_DEFAULT);
-    if (digitisation_attr >= 0) {
-      if (H5Aread(digitisation_attr, H5T_NATIVE_DOUBLE, &metadata->digitisation) >= 0) {
-        got_digitisation = true;
-      }
-      H5Aclose(digitisation_attr);
-    }
-    
-    // Mark calibration as available if we got all three parameters
-    metadata->calibration_available = got_offset && got_range && got_digitisation;
-
-    H5Gclose(channel_group_id);
-  }
+  if (read->channel_group_id < 0) return;
 
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
+  // Mark calibration as available if we got all three parameters
+  bool got_offset = read_double_attribute(read->channel_group_id, "offset", &metadata->offset);
+  bool got_range = read_double_attribute(read->channel_group_id, "range", &metadata->range);
+  bool got_digitisation = read_double_attribute(read->channel_group_id, "digitisation", &metadata->digitisation);
+  metadata->calibration_available = got_offset && got_range && got_digitisation;
 }
 
 // Enhancer function to extract raw signal metadata (median_before and start_time)
-void extract_raw(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
+void extract_raw(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
   // Initialize fields
   metadata->median_before = 0.0;
   metadata->pore_level_available = false;
   metadata->start_time = 0;
 
-  if (signal_dataset_id < 0) return;
+  // Both live on the parent of the Signal dataset:
+  // single-read /Raw/Reads/Read_X, multi-read /read_X/Raw
+  if (read->raw_group_id < 0) return;
 
-  // Suppress HDF5 error messages
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+  metadata->pore_level_available = read_double_attribute(read->raw_group_id, "median_before",
+                                                         &metadata->median_before);
 
-  // Get the parent group of the signal dataset (the Raw group)
-  char obj_name[256];
-  ssize_t name_len = H5Iget_name(signal_dataset_id, obj_name, sizeof(obj_name));
-  if (name_len <= 0) {
-    H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-    return;
+  hid_t time_attr = H5Aopen(read->raw_group_id, "start_time", H5P_DEFAULT);
+  if (time_attr >= 0) {
+    read_attribute(time_attr, H5T_NATIVE_UINT64, &metadata->start_time);
+    H5Aclose(time_attr);
   }
+}
 
-  // Parse the path to find the Raw group
-  // For single-read: /Raw/Reads/Read_X/Signal -> /Raw/Reads/Read_X/
-  // For multi-read: /read_X/Raw/Signal -> /read_X/Raw/
-  char *last_slash = strrchr(obj_name, '/');
-  if (!last_slash) {
-    H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-    return;
+// **********************************************************************
+// Fast5 Format Detection
+// **********************************************************************
+// Multi-read files carry file_type="multi-read" or root-level read_* groups;
+// seqgen's single-read files also carry file_type, so the value is checked.
+static bool detect_multi_read_format(hid_t file_id) {
+  htri_t attr_exists = H5Aexists(file_id, "file_type");
+  if (attr_exists > 0) {
+    hid_t attr_id = H5Aopen(file_id, "file_type", H5P_DEFAULT);
+    if (attr_id >= 0) {
+      bool is_single = false;
+      hid_t type_id = H5Aget_type(attr_id);
+      if (H5Tis_variable_str(type_id) > 0) {
+        char *value = NULL;
+        if (read_attribute(attr_id, type_id, &value) >= 0 && value) {
+          is_single = (strcmp(value, "single-read") == 0);
+          H5free_memory(value);
+        }
+      } else {
+        char value[64] = {0};
+        if (H5Tget_size(type_id) < sizeof(value) && read_attribute(attr_id, type_id, value) >= 0) {
+          is_single = (strcmp(value, "single-read") == 0);
+        }
+      }
+      H5Tclose(type_id);
+      H5Aclose(attr_id);
+      if (is_single) return false;
+    }
+    return true;
   }
 
-  // Null terminate at last slash to get parent group path
-  *last_slash = '\0';
-
-  // Open the Raw group (parent of Signal dataset)
-  hid_t raw_group_id = H5Gopen2(file_id, obj_name, H5P_DEFAULT);
-  if (raw_group_id >= 0) {
-    // Try to read median_before attribute
-    hid_t median_attr = H5Aopen(raw_group_id, "median_before", H5P_DEFAULT);
-    if (median_attr >= 0) {
-      if (H5Aread(median_attr, H5T_NATIVE_DOUBLE, &metadata->median_before) >= 0) {
-        metadata->pore_level_available = true;
+  // No file_type attribute - check first few root objects for read_ pattern
+  hsize_t num_objs;
+  if (H5Gget_num_objs(file_id, &num_objs) >= 0 && num_objs > 0) {
+    for (hsize_t i = 0; i < num_objs && i < 5; i++) {
+      char obj_name[256];
+      if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) >= 0) {
+        if (strncmp(obj_name, "read_", 5) == 0) {
+          return true;
+        }
       }
-      H5Aclose(median_attr);
     }
+  }
+  return false;
+}
 
-    // Try to read start_time attribute
-    hid_t time_attr = H5Aopen(raw_group_id, "start_time", H5P_DEFAULT);
-    if (time_attr >= 0) {
-      H5Aread(time_attr, H5T_NATIVE_UINT64, &metadata->start_time);
-      H5Aclose(time_attr);
-    }
+// **********************************************************************
+// Fast5 Reader Handle (single open, single pass)
+// **********************************************************************
 
-    H5Gclose(raw_group_id);
+struct fast5_reader {
+  hid_t file_id;
+  char *filename;
+  bool is_multi_read;
+  metadata_enhancer_t enhancer;
+
+  // Read groups enumerated once at open: "/read_<id>" (multi) or "/Raw/Reads/<name>" (single)
+  char **read_paths;
+  size_t num_reads;
+  size_t cursor;
+
+  // Location of the read last returned by fast5_reader_next()
+  const char *current_path;
+  uint64_t current_offset;
+
+  // File-level groups and sample rate (single-read files keep them in /UniqueGlobalKey)
+  hid_t file_channel_group_id;
+  hid_t file_tracking_group_id;
+  double file_sample_rate;
+  fast5_attribute_cache_t cache;
+
+  // Reusable native int16 signal buffer, grown as needed and never shrunk
+  int16_t *signal;
+  size_t signal_length;
+  size_t signal_capacity;
+
+  // Compressed chunks of the current Signal; pending until decoded (deferred mode)
+  fast5_raw_signal_t raw;
+  bool raw_pending;
+  bool defer_decode;
+};
+
+// Append a group path to the reader's read list
+static bool reader_push_path(fast5_reader_t *reader, size_t *capacity, const char *path) {
+  if (reader->num_reads >= *capacity) {
+    size_t new_capacity = *capacity == 0 ? 64 : *capacity * 2;
+    char **paths = realloc(reader->read_paths, new_capacity * sizeof(char*));
+    if (!paths) return false;
+    reader->read_paths = paths;
+    *capacity = new_capacity;
   }
+  reader->read_paths[reader->num_reads] = strdup(path);
+  if (!reader->read_paths[reader->num_reads]) return false;
+  reader->num_reads++;
+  return true;
+}
 
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
+// H5Literate visitor: record each read group under the iterated group. One
+// pass over the links; by-index name lookups rebuild the link index on every
+// call and made enumerating a 4000-read file quadratic
+typedef struct {
+  fast5_reader_t *reader;
+  size_t *capacity;
+  const char *parent;      // "" (file root) or "/Raw/Reads"
+  bool reads_only;         // Keep only read_* links (multi-read root)
+} enumerate_state_t;
+
+static herr_t enumerate_read_link(hid_t group_id, const char *name, const H5L_info_t *info, void *op_data) {
+  (void)group_id;
+  (void)info;
+  enumerate_state_t *state = op_data;
+  if (state->reads_only && strncmp(name, "read_", 5) != 0) return 0;
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", state->parent, name);
+  return reader_push_path(state->reader, state->capacity, path) ? 0 : -1;
 }
 
-// **********************************************************************
-// Fast5 Metadata Reading Functions (ENHANCED)
-// **********************************************************************
-// Enhanced single-read metadata function with enhancer support
-static fast5_metadata_t* read_single_read_metadata_with_enhancer(hid_t file_id, const char *filename, size_t *count, metadata_enhancer_t enhancer) {
-  *count = 0;
-  
+// Enumerate read groups for either layout (one group-listing pass, no per-read opens)
+static bool reader_enumerate_reads(fast5_reader_t *reader) {
+  size_t capacity = 0;
+
+  // Name order, as the by-index listing gave
+  if (reader->is_multi_read) {
+    enumerate_state_t state = {reader, &capacity, "", true};
+    return H5Literate(reader->file_id, H5_INDEX_NAME, H5_ITER_INC, NULL, enumerate_read_link, &state) >= 0;
+  }
+
+  if (H5Lexists(reader->file_id, "/Raw/Reads", H5P_DEFAULT) <= 0) return true;
+  hid_t reads_group_id = H5Gopen2(reader->file_id, "/Raw/Reads", H5P_DEFAULT);
+  if (reads_group_id < 0) return false;
+
+  enumerate_state_t state = {reader, &capacity, "/Raw/Reads", false};
+  bool ok = H5Literate(reads_group_id, H5_INDEX_NAME, H5_ITER_INC, NULL, enumerate_read_link, &state) >= 0;
+  H5Gclose(reads_group_id);
+
+  // Channel and tracking groups are file-level for single-read files: open them
+  // once here and hand the same handles to every read's enhancers
+  reader->file_channel_group_id = H5Gopen2(reader->file_id, "/UniqueGlobalKey/channel_id", H5P_DEFAULT);
+  if (reader->file_channel_group_id >= 0) {
+    read_double_attribute(reader->file_channel_group_id, "sampling_rate", &reader->file_sample_rate);
+  }
+  if (reader->enhancer) {
+    reader->file_tracking_group_id = H5Gopen2(reader->file_id, "/UniqueGlobalKey/tracking_id", H5P_DEFAULT);
+  }
+  return ok;
+}
+
+fast5_reader_t* fast5_reader_open(const char *filename, metadata_enhancer_t enhancer) {
+  if (!filename) return NULL;
+
   // Suppress HDF5 error messages temporarily
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
-  
-  // Check if /Raw/Reads group exists
-  htri_t exists = H5Lexists(file_id, "/Raw/Reads", H5P_DEFAULT);
-  
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-  
-  if (exists <= 0) return NULL;
-  
-  hid_t reads_group_id = H5Gopen2(file_id, "/Raw/Reads", H5P_DEFAULT);
-  if (reads_group_id < 0) return NULL;
-  
-  // Get number of reads in the group
-  hsize_t num_objs;
-  if (H5Gget_num_objs(reads_group_id, &num_objs) < 0) {
-    H5Gclose(reads_group_id);
+  fast5_hdf5_quiet_begin();
+
+  hid_t file_id = open_fast5_readonly(filename);
+  if (file_id < 0) {
+    fast5_hdf5_quiet_end();
+    warnx("Failed to open Fast5 file: %s", filename);
     return NULL;
   }
-  
-  if (num_objs == 0) {
-    H5Gclose(reads_group_id);
+
+  fast5_reader_t *reader = calloc(1, sizeof(fast5_reader_t));
+  if (!reader) {
+    H5Fclose(file_id);
+    fast5_hdf5_quiet_end();
     return NULL;
   }
-  
-  fast5_metadata_t *metadata = calloc(num_objs, sizeof(fast5_metadata_t)); // allocate space for file metadata
-  if (!metadata) {
-    H5Gclose(reads_group_id);
+  reader->file_id = file_id;
+  reader->file_channel_group_id = -1;
+  reader->file_tracking_group_id = -1;
+  reader->filename = strdup(filename);
+  reader->enhancer = enhancer;
+  reader->is_multi_read = detect_multi_read_format(file_id);
+
+  bool ok = reader->filename && reader_enumerate_reads(reader);
+
+  // Restore HDF5 error reporting
+  fast5_hdf5_quiet_end();
+
+  if (!ok) {
+    fast5_reader_close(reader);
     return NULL;
   }
-  
-  // Process each read
-  for (hsize_t i = 0; i < num_objs; i++) {
-    char read_name[256];
-    if (H5Gget_objname_by_idx(reads_group_id, i, read_name, sizeof(read_name)) < 0) continue;
-    
-    char read_path[512];
-    snprintf(read_path, sizeof(read_path), "/Raw/Reads/%s", read_name);
-    
-    hid_t read_group_id = H5Gopen2(file_id, read_path, H5P_DEFAULT);
-    if (read_group_id < 0) continue;
-    
-    // Initialize metadata
-    metadata[*count].file_path = strdup(filename);
-    metadata[*count].is_multi_read = false;
-    
-    // Read attributes
-    metadata[*count].read_id = read_string_attribute(read_group_id, "read_id");
-    read_uint32_attribute(read_group_id, "duration", &metadata[*count].duration);
-    read_uint32_attribute(read_group_id, "read_number", &metadata[*count].read_number);
-    
-    // Get signal length from Signal dataset
-    hid_t signal_dataset_id = H5Dopen2(read_group_id, "Signal", H5P_DEFAULT);
-    if (signal_dataset_id >= 0) {
-      metadata[*count].signal_length = (uint32_t)get_signal_length(signal_dataset_id);
-      
-      // *** CALL ENHANCER HERE - while signal dataset is open ***
-      if (enhancer) {
-        enhancer(file_id, signal_dataset_id, &metadata[*count]);
-      }
-      
-      H5Dclose(signal_dataset_id);
-    }
-    
-    H5Gclose(read_group_id);
-    (*count)++;
-  }
-  
-  // Get sample rate from channel_id group
-  hid_t channel_group_id = H5Gopen2(file_id, "/UniqueGlobalKey/channel_id", H5P_DEFAULT);
-  if (channel_group_id >= 0) {
-    double sample_rate;
-    if (read_double_attribute(channel_group_id, "sampling_rate", &sample_rate)) {
-      for (size_t i = 0; i < *count; i++) {
-        metadata[i].sample_rate = sample_rate;
-      }
-    }
-    H5Gclose(channel_group_id);
-  }
-  
-  H5Gclose(reads_group_id);
-  return metadata;
+  return reader;
 }
 
-// Enhanced multi-read metadata function with enhancer support
-static fast5_metadata_t* read_multi_read_metadata_with_enhancer(hid_t file_id, const char *filename, size_t *count, metadata_enhancer_t enhancer) {
-  *count = 0;
-  
-  // Get number of root-level objects
-  hsize_t num_objs;
-  if (H5Gget_num_objs(file_id, &num_objs) < 0) return NULL;
-  
-  // Count read_ groups
-  size_t read_count = 0;
-  for (hsize_t i = 0; i < num_objs; i++) {
-    char obj_name[256];
-    if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) < 0) continue;
-    
-    if (strncmp(obj_name, "read_", 5) == 0) {
-      read_count++;
-    }
+void fast5_reader_close(fast5_reader_t *reader) {
+  if (!reader) return;
+  if (reader->file_channel_group_id >= 0) H5Gclose(reader->file_channel_group_id);
+  if (reader->file_tracking_group_id >= 0) H5Gclose(reader->file_tracking_group_id);
+  if (reader->file_id >= 0) H5Fclose(reader->file_id);
+  attribute_cache_clear(&reader->cache);
+  for (size_t i = 0; i < reader->num_reads; i++) {
+    free(reader->read_paths[i]);
   }
-  
-  if (read_count == 0) return NULL;
-  
-  fast5_metadata_t *metadata = calloc(read_count, sizeof(fast5_metadata_t));
-  if (!metadata) return NULL;
-  
-  // Process each read_ group
-  for (hsize_t i = 0; i < num_objs; i++) {
-    char obj_name[256];
-    if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) < 0) continue;
-    
-    if (strncmp(obj_name, "read_", 5) != 0) continue;
-    
-    hid_t read_group_id = H5Gopen2(file_id, obj_name, H5P_DEFAULT);
+  free(reader->read_paths);
+  free(reader->filename);
+  free(reader->signal);
+  fast5_raw_signal_free(&reader->raw);
+  free(reader);
+}
+
+size_t fast5_reader_num_reads(const fast5_reader_t *reader) {
+  return reader ? reader->num_reads : 0;
+}
+
+bool fast5_reader_is_multi_read(const fast5_reader_t *reader) {
+  return reader ? reader->is_multi_read : false;
+}
+
+hid_t fast5_reader_file_id(const fast5_reader_t *reader) {
+  return reader ? reader->file_id : -1;
+}
+
+void fast5_reader_rewind(fast5_reader_t *reader) {
+  if (reader) reader->cursor = 0;
+}
+
+static bool reserve_signal(fast5_reader_t *reader, size_t length) {
+  if (length <= reader->signal_capacity) return true;
+  int16_t *grown = realloc(reader->signal, length * sizeof(int16_t));
+  if (!grown) return false;
+  reader->signal = grown;
+  reader->signal_capacity = length;
+  return true;
+}
+
+// Read the signal of an open dataset into the reader's reusable buffer: deflate
+// chunks are fetched raw and inflated here (or, deferred, by fast5_reader_decode_signal),
+// anything else goes through H5Dread
+static bool reader_load_signal(fast5_reader_t *reader, hid_t signal_dataset_id, size_t length) {
+  reader->signal_length = 0;
+  reader->raw_pending = false;
+  reader->raw.compression = NULL;
+  if (length == 0) return false;
+  if (!reserve_signal(reader, length)) return false;
+
+  if (fast5_raw_signal_fetch(signal_dataset_id, length, &reader->raw)) {
+    SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_READ, length * sizeof(int16_t));
+    reader->raw_pending = true;
+    return reader->defer_decode || fast5_reader_decode_signal(reader);
+  }
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  herr_t status = H5Dread(signal_dataset_id, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, reader->signal);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, profile_start);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  if (status < 0) return false;
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_READ, length * sizeof(int16_t));
+  reader->signal_length = length;
+  return true;
+}
+
+void fast5_reader_defer_decode(fast5_reader_t *reader, bool defer) {
+  if (reader) reader->defer_decode = defer;
+}
+
+bool fast5_reader_take_chunks(fast5_reader_t *reader, fast5_raw_signal_t *chunks) {
+  if (!reader || !chunks || !reader->raw_pending) return false;
+  fast5_raw_signal_t fetched = reader->raw;
+  reader->raw = *chunks;
+  *chunks = fetched;
+  reader->raw_pending = false;
+  return true;
+}
+
+bool fast5_reader_decode_signal(fast5_reader_t *reader) {
+  if (!reader || !reader->raw_pending) return true;
+  reader->raw_pending = false;
+  if (!fast5_raw_signal_decode(&reader->raw, reader->signal, io_options.decode_threads)) return false;
+  reader->signal_length = reader->raw.length;
+  return true;
+}
+
+int fast5_reader_next(fast5_reader_t *reader, fast5_metadata_t *metadata, bool load_signal) {
+  if (!reader || !metadata) return -1;
+
+  // Suppress HDF5 error messages for malformed read groups (they are skipped)
+  fast5_hdf5_quiet_begin();
+
+  int status = 0;
+  reader->signal_length = 0;
+  reader->raw_pending = false;
+
+  while (reader->cursor < reader->num_reads) {
+    const char *read_path = reader->read_paths[reader->cursor++];
+    reader->current_path = read_path;
+    reader->current_offset = FAST5_OFFSET_UNDEFINED;
+
+    hid_t read_group_id = H5Gopen2(reader->file_id, read_path, H5P_DEFAULT);
     if (read_group_id < 0) continue;
-    
-    // Open Raw subgroup
-    hid_t raw_group_id = H5Gopen2(read_group_id, "Raw", H5P_DEFAULT);
-    if (raw_group_id < 0) {
-      H5Gclose(read_group_id);
-      continue;
+
+    // Read attributes live on read_xxx/Raw (multi) or on the read group itself (single)
+    hid_t attr_group_id = read_group_id;
+    if (reader->is_multi_read) {
+      attr_group_id = H5Gopen2(read_group_id, "Raw", H5P_DEFAULT);
+      if (attr_group_id < 0) {
+        H5Gclose(read_group_id);
+        continue;
+      }
     }
-    
-    // Initialize metadata
-    metadata[*count].file_path = strdup(filename);
-    metadata[*count].is_multi_read = true;
-    
-    // Read attributes from Raw group
-    metadata[*count].read_id = read_string_attribute(raw_group_id, "read_id");
-    read_uint32_attribute(raw_group_id, "duration", &metadata[*count].duration);
-    read_uint32_attribute(raw_group_id, "read_number", &metadata[*count].read_number);
-    
-    // Get signal length from Signal dataset
-    hid_t signal_dataset_id = H5Dopen2(raw_group_id, "Signal", H5P_DEFAULT);
+
+    memset(metadata, 0, sizeof(*metadata));
+    metadata->file_path = strdup(reader->filename);
+    metadata->is_multi_read = reader->is_multi_read;
+    metadata->read_id = read_string_attribute(attr_group_id, "read_id");
+    read_uint32_attribute(attr_group_id, "duration", &metadata->duration);
+    read_uint32_attribute(attr_group_id, "read_number", &metadata->read_number);
+
+    // Per-read channel_id (sample rate, and for enhancers channel number and
+    // calibration) and, only when an enhancer may want them, tracking_id
+    hid_t channel_group_id = reader->file_channel_group_id;
+    hid_t tracking_group_id = reader->file_tracking_group_id;
+    if (reader->is_multi_read) {
+      channel_group_id = H5Gopen2(read_group_id, "channel_id", H5P_DEFAULT);
+      tracking_group_id = reader->enhancer ? H5Gopen2(read_group_id, "tracking_id", H5P_DEFAULT) : -1;
+      if (channel_group_id >= 0) {
+        read_double_attribute(channel_group_id, "sampling_rate", &metadata->sample_rate);
+      }
+    } else {
+      metadata->sample_rate = reader->file_sample_rate;
+    }
+
+    hid_t signal_dataset_id = H5Dopen2(attr_group_id, "Signal", H5P_DEFAULT);
     if (signal_dataset_id >= 0) {
-      metadata[*count].signal_length = (uint32_t)get_signal_length(signal_dataset_id);
-      
-      // *** CALL ENHANCER HERE - while signal dataset is open ***
-      if (enhancer) {
-        enhancer(file_id, signal_dataset_id, &metadata[*count]);
+      metadata->signal_length = (uint32_t)get_signal_length(signal_dataset_id);
+
+      // File offset is only defined for contiguous (uncompressed, unchunked) storage
+      haddr_t offset = H5Dget_offset(signal_dataset_id);
+      if (offset != HADDR_UNDEF) reader->current_offset = (uint64_t)offset;
+
+      if (load_signal) {
+        reader_load_signal(reader, signal_dataset_id, metadata->signal_length);
+        metadata->compression_method = strdup(reader->raw.compression ? reader->raw.compression : "none");
+      }
+
+      // Enhancers run while the signal dataset and the read's groups are open
+      if (reader->enhancer) {
+        fast5_read_handles_t handles = {
+          .file_id = reader->file_id,
+          .read_group_id = read_group_id,
+          .raw_group_id = attr_group_id,
+          .signal_dataset_id = signal_dataset_id,
+          .channel_group_id = channel_group_id,
+          .tracking_group_id = tracking_group_id,
+          .is_multi_read = reader->is_multi_read,
+          .cache = &reader->cache
+        };
+        uint64_t profile_start = SEQ_PROFILE_START();
+        reader->enhancer(&handles, metadata);
+        SEQ_PROFILE_STOP(SEQ_PROFILE_METADATA, profile_start);
       }
-      
       H5Dclose(signal_dataset_id);
     }
-    
-    // Get sample rate from channel_id group
-    hid_t channel_group_id = H5Gopen2(read_group_id, "channel_id", H5P_DEFAULT);
-    if (channel_group_id >= 0) {
-      read_double_attribute(channel_group_id, "sampling_rate", &metadata[*count].sample_rate);
-      H5Gclose(channel_group_id);
+
+    if (reader->is_multi_read) {
+      if (tracking_group_id >= 0) H5Gclose(tracking_group_id);
+      if (channel_group_id >= 0) H5Gclose(channel_group_id);
+      H5Gclose(attr_group_id);
     }
-    
-    H5Gclose(raw_group_id);
     H5Gclose(read_group_id);
-    (*count)++;
+
+    status = 1;
+    break;
   }
-  
-  return metadata;
+
+  // Restore HDF5 error reporting
+  fast5_hdf5_quiet_end();
+  return status;
+}
+
+const char* fast5_reader_location(const fast5_reader_t *reader, uint64_t *dataset_offset) {
+  if (!reader || !reader->current_path) {
+    if (dataset_offset) *dataset_offset = FAST5_OFFSET_UNDEFINED;
+    return NULL;
+  }
+  if (dataset_offset) *dataset_offset = reader->current_offset;
+  return reader->current_path;
+}
+
+const int16_t* fast5_reader_signal(const fast5_reader_t *reader, size_t *signal_length) {
+  if (!reader || reader->signal_length == 0) {
+    if (signal_length) *signal_length = 0;
+    return NULL;
+  }
+  if (signal_length) *signal_length = reader->signal_length;
+  return reader->signal;
 }
 
+// **********************************************************************
+// Fast5 Metadata Reading Functions (ENHANCED)
+// **********************************************************************
+
 // Main function to read Fast5 metadata with enhancer support
 fast5_metadata_t* read_fast5_metadata_with_enhancer(const char *filename, size_t *metadata_count, metadata_enhancer_t enhancer) {
   if (!filename || !metadata_count) return NULL;
-  
+
   *metadata_count = 0;
-  
-  // Suppress HDF5 error messages temporarily
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
-  
-  // Open the Fast5 file
-  hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-  
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-  
-  if (file_id < 0) {
-    warnx("Failed to open Fast5 file: %s", filename);
+
+  fast5_reader_t *reader = fast5_reader_open(filename, enhancer);
+  if (!reader) return NULL;
+
+  size_t num_reads = fast5_reader_num_reads(reader);
+  if (num_reads == 0) {
+    fast5_reader_close(reader);
     return NULL;
   }
-  
-  fast5_metadata_t *metadata = NULL;
-  
-  // Format detection (same logic as original)
-  bool is_multi_read = false;
-  
-  // Check for file_type attribute first
-  htri_t attr_exists = H5Aexists(file_id, "file_type");
-  if (attr_exists > 0) {
-    is_multi_read = true;
-  } else {
-    // No file_type attribute - check for read_* groups at root level
-    hsize_t num_objs;
-    if (H5Gget_num_objs(file_id, &num_objs) >= 0 && num_objs > 0) {
-      // Check first few objects for read_ pattern
-      for (hsize_t i = 0; i < num_objs && i < 5; i++) {
-        char obj_name[256];
-        if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) >= 0) {
-          if (strncmp(obj_name, "read_", 5) == 0) {
-            is_multi_read = true;
-            break;
-          }
-        }
-      }
-    }
+
+  fast5_metadata_t *metadata = calloc(num_reads, sizeof(fast5_metadata_t)); // allocate space for file metadata
+  if (!metadata) {
+    fast5_reader_close(reader);
+    return NULL;
   }
-  
-  // Call the appropriate enhanced helper function
-  if (is_multi_read) {
-    metadata = read_multi_read_metadata_with_enhancer(file_id, filename, metadata_count, enhancer);
-  } else {
-    metadata = read_single_read_metadata_with_enhancer(file_id, filename, metadata_count, enhancer);
+
+  // Metadata only: the signal buffer is never touched
+  while (*metadata_count < num_reads &&
+         fast5_reader_next(reader, &metadata[*metadata_count], false) > 0) {
+    (*metadata_count)++;
   }
-  
-  H5Fclose(file_id);
+
+  fast5_reader_close(reader);
+
+  if (*metadata_count == 0) {
+    free(metadata);
+    return NULL;
+  }
+  return metadata;
+}
+
+// Report whether the linked HDF5 library was built with --enable-threadsafe
+bool fast5_hdf5_is_threadsafe(void) {
+  hbool_t is_ts = 0;
+  if (H5is_library_threadsafe(&is_ts) < 0) return false;
+  return is_ts > 0;
+}
+
+// Automatic error printing of the calling thread's default stack, saved by the
+// outermost quiet scope. Thread-safe HDF5 keeps one default stack per thread, so
+// one thread's scope never switches another's (or the host's) handler
+static _Thread_local int quiet_depth = 0;
+static _Thread_local H5E_auto2_t quiet_saved_func = NULL;
+static _Thread_local void *quiet_saved_data = NULL;
+
+void fast5_hdf5_quiet_begin(void) {
+  if (quiet_depth++ > 0) return;
+  H5Eget_auto2(H5E_DEFAULT, &quiet_saved_func, &quiet_saved_data);
+  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+}
+
+void fast5_hdf5_quiet_end(void) {
+  if (quiet_depth == 0 || --quiet_depth > 0) return;
+  H5Eset_auto2(H5E_DEFAULT, quiet_saved_func, quiet_saved_data);
+  quiet_saved_func = NULL;
+  quiet_saved_data = NULL;
+}
+
+// Thread-safe metadata read: take hdf5_mutex around the whole HDF5 session
+// (open, traversal, enhancers, close) so non-thread-safe builds never see two
+// callers at once.  Thread-safe builds can pass NULL and skip the lock.
+fast5_metadata_t* read_fast5_metadata_thread_safe(const char *filename, size_t *metadata_count,
+                                                  metadata_enhancer_t enhancer, pthread_mutex_t *hdf5_mutex) {
+  if (hdf5_mutex) pthread_mutex_lock(hdf5_mutex);
+  fast5_metadata_t *metadata = read_fast5_metadata_with_enhancer(filename, metadata_count, enhancer);
+  if (hdf5_mutex) pthread_mutex_unlock(hdf5_mutex);
   return metadata;
 }
 
 // **********************************************************************
 // Fast5 Signal Extraction Functions
 // **********************************************************************
-// Extract signal data from single-read Fast5 format
-static float* read_single_read_signal(hid_t file_id, const char *read_id, size_t *signal_length) {
-  *signal_length = 0;
-  
-  // Suppress HDF5 error messages temporarily
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
-  
-  // Check if /Raw/Reads group exists
-  htri_t exists = H5Lexists(file_id, "/Raw/Reads", H5P_DEFAULT);
-  
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-  
-  if (exists <= 0) return NULL;
-  
-  hid_t reads_group_id = H5Gopen2(file_id, "/Raw/Reads", H5P_DEFAULT);
-  if (reads_group_id < 0) return NULL;
-  
-  // Get number of reads in the group
-  hsize_t num_objs;
-  if (H5Gget_num_objs(reads_group_id, &num_objs) < 0) {
-    H5Gclose(reads_group_id);
-    return NULL;
-  }
-  
-  float *signal = NULL;
-  
-  // Search for the read
-  for (hsize_t i = 0; i < num_objs; i++) {
-    char read_name[256];
-    if (H5Gget_objname_by_idx(reads_group_id, i, read_name, sizeof(read_name)) < 0) continue;
-    
-    char read_path[512];
-    snprintf(read_path, sizeof(read_path), "/Raw/Reads/%s", read_name);
-    
-    hid_t read_group_id = H5Gopen2(file_id, read_path, H5P_DEFAULT);
-    if (read_group_id < 0) continue;
-    
-    // Check if this is the read we want (if read_id is specified)
+// Locate the group holding the Signal dataset of read_id (NULL = first read)
+// Writes "/read_<id>/Raw" (multi-read) or "/Raw/Reads/Read_N" (single-read) to group_path
+static bool find_signal_group(hid_t file_id, bool is_multi_read, const char *read_id,
+                              char *group_path, size_t group_path_size) {
+  char candidate[512];
+
+  if (is_multi_read) {
+    // Multi-read groups are conventionally named read_<read_id>: try that before scanning
     if (read_id) {
-      char *current_read_id = read_string_attribute(read_group_id, "read_id");
-      if (!current_read_id || strcmp(current_read_id, read_id) != 0) {
+      snprintf(candidate, sizeof(candidate), "/read_%s/Raw/Signal", read_id);
+      if (H5Lexists(file_id, candidate, H5P_DEFAULT) > 0) {
+        snprintf(group_path, group_path_size, "/read_%s/Raw", read_id);
+        return true;
+      }
+    }
+
+    hsize_t num_objs;
+    if (H5Gget_num_objs(file_id, &num_objs) < 0) return false;
+    for (hsize_t i = 0; i < num_objs; i++) {
+      char obj_name[256];
+      if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) < 0) continue;
+      if (strncmp(obj_name, "read_", 5) != 0) continue;
+
+      snprintf(candidate, sizeof(candidate), "/%s/Raw", obj_name);
+      if (H5Lexists(file_id, candidate, H5P_DEFAULT) <= 0) continue;
+
+      hid_t raw_group_id = H5Gopen2(file_id, candidate, H5P_DEFAULT);
+      if (raw_group_id < 0) continue;
+
+      // Check if this is the read we want (if read_id is specified)
+      bool match = true;
+      if (read_id) {
+        char *current_read_id = read_string_attribute(raw_group_id, "read_id");
+        match = current_read_id && strcmp(current_read_id, read_id) == 0;
         free(current_read_id);
-        H5Gclose(read_group_id);
-        continue;
       }
-      free(current_read_id);
+      bool has_signal = match && H5Lexists(raw_group_id, "Signal", H5P_DEFAULT) > 0;
+      H5Gclose(raw_group_id);
+
+      if (has_signal) {
+        snprintf(group_path, group_path_size, "%s", candidate);
+        return true;
+      }
     }
-    
-    // Open Signal dataset
-    hid_t signal_dataset_id = H5Dopen2(read_group_id, "Signal", H5P_DEFAULT);
-    if (signal_dataset_id >= 0) {
-      hsize_t dims[1];
-      hid_t space_id = H5Dget_space(signal_dataset_id);
-      int ndims = H5Sget_simple_extent_dims(space_id, dims, NULL);
-      H5Sclose(space_id);
-      
-      if (ndims == 1 && dims[0] > 0) {
-        *signal_length = dims[0];
-        signal = malloc(dims[0] * sizeof(float));
-        if (signal) {
-          if (H5Dread(signal_dataset_id, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, signal) < 0) {
-            free(signal);
-            signal = NULL;
-            *signal_length = 0;
-          }
-        }
+    return false;
+  }
+
+  if (H5Lexists(file_id, "/Raw/Reads", H5P_DEFAULT) <= 0) return false;
+  hid_t reads_group_id = H5Gopen2(file_id, "/Raw/Reads", H5P_DEFAULT);
+  if (reads_group_id < 0) return false;
+
+  bool found = false;
+  hsize_t num_objs;
+  if (H5Gget_num_objs(reads_group_id, &num_objs) >= 0) {
+    for (hsize_t i = 0; i < num_objs && !found; i++) {
+      char read_name[256];
+      if (H5Gget_objname_by_idx(reads_group_id, i, read_name, sizeof(read_name)) < 0) continue;
+
+      snprintf(candidate, sizeof(candidate), "/Raw/Reads/%s", read_name);
+      hid_t read_group_id = H5Gopen2(file_id, candidate, H5P_DEFAULT);
+      if (read_group_id < 0) continue;
+
+      bool match = true;
+      if (read_id) {
+        char *current_read_id = read_string_attribute(read_group_id, "read_id");
+        match = current_read_id && strcmp(current_read_id, read_id) == 0;
+        free(current_read_id);
       }
-      H5Dclose(signal_dataset_id);
+      found = match && H5Lexists(read_group_id, "Signal", H5P_DEFAULT) > 0;
+      H5Gclose(read_group_id);
+
+      if (found) snprintf(group_path, group_path_size, "%s", candidate);
     }
-    
-    H5Gclose(read_group_id);
-    
-    // If we found a signal, break (unless read_id was NULL, in which case we take the first one)
-    if (signal) break;
   }
-  
   H5Gclose(reads_group_id);
-  return signal;
+  return found;
+}
+
+// Resolve an index group path ("/read_<id>", "/read_<id>/Raw" or "/Raw/Reads/Read_N")
+// to the group that directly holds Signal
+static bool resolve_signal_group(hid_t file_id, const char *path, char *group_path, size_t group_path_size) {
+  char candidate[600];
+  snprintf(candidate, sizeof(candidate), "%s/Raw/Signal", path);
+  if (H5Lexists(file_id, path, H5P_DEFAULT) <= 0) return false;
+  if (H5Lexists(file_id, candidate, H5P_DEFAULT) > 0) {
+    snprintf(group_path, group_path_size, "%s/Raw", path);
+    return true;
+  }
+  snprintf(candidate, sizeof(candidate), "%s/Signal", path);
+  if (H5Lexists(file_id, candidate, H5P_DEFAULT) > 0) {
+    snprintf(group_path, group_path_size, "%s", path);
+    return true;
+  }
+  return false;
+}
+
+// Read calibration for the read at group_path from its channel_id group
+// (read_<id>/channel_id for multi-read, /UniqueGlobalKey/channel_id for single-read)
+static bool read_signal_calibration(hid_t file_id, const char *group_path,
+                                    double *offset, double *range, double *digitisation) {
+  char channel_path[600];
+  size_t len = strlen(group_path);
+  if (len >= 4 && strcmp(group_path + len - 4, "/Raw") == 0) {
+    snprintf(channel_path, sizeof(channel_path), "%.*s/channel_id", (int)(len - 4), group_path);
+  } else {
+    snprintf(channel_path, sizeof(channel_path), "/UniqueGlobalKey/channel_id");
+  }
+
+  if (H5Lexists(file_id, channel_path, H5P_DEFAULT) <= 0) return false;
+  hid_t channel_group_id = H5Gopen2(file_id, channel_path, H5P_DEFAULT);
+  if (channel_group_id < 0) return false;
+
+  bool ok = read_double_attribute(channel_group_id, "offset", offset) &&
+            read_double_attribute(channel_group_id, "range", range) &&
+            read_double_attribute(channel_group_id, "digitisation", digitisation) &&
+            *digitisation != 0.0;
+  H5Gclose(channel_group_id);
+  return ok;
+}
+
+// Open the file and locate the read's Signal group (by read_id scan or by explicit path)
+// HDF5 error reporting must already be suppressed by the caller
+static hid_t open_signal_group(const char *filename, const char *read_id, const char *path,
+                               char *group_path, size_t group_path_size) {
+  hid_t file_id = open_fast5_readonly(filename);
+  if (file_id < 0) return -1;
+
+  bool found = path ? resolve_signal_group(file_id, path, group_path, group_path_size)
+                    : find_signal_group(file_id, detect_multi_read_format(file_id), read_id,
+                                        group_path, group_path_size);
+  if (!found) {
+    H5Fclose(file_id);
+    return -2;
+  }
+  return file_id;
 }
 
-// Extract signal data from multi-read Fast5 format
-static float* read_multi_read_signal(hid_t file_id, const char *read_id, size_t *signal_length) {
+// Shared float32 loader for read_fast5_signal() and read_fast5_signal_at()
+static float* load_signal_float(const char *filename, const char *read_id, const char *path, size_t *signal_length) {
   *signal_length = 0;
-  
-  // Get number of root-level objects
-  hsize_t num_objs;
-  if (H5Gget_num_objs(file_id, &num_objs) < 0) return NULL;
-  
+
+  // Suppress HDF5 error messages temporarily
+  fast5_hdf5_quiet_begin();
+
+  char group_path[600];
   float *signal = NULL;
-  
-  // Process each read_ group
-  for (hsize_t i = 0; i < num_objs; i++) {
-    char obj_name[256];
-    if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) < 0) continue;
-    
-    if (strncmp(obj_name, "read_", 5) != 0) continue;
-    
-    hid_t read_group_id = H5Gopen2(file_id, obj_name, H5P_DEFAULT);
-    if (read_group_id < 0) continue;
-    
-    // Open Raw subgroup
-    hid_t raw_group_id = H5Gopen2(read_group_id, "Raw", H5P_DEFAULT);
-    if (raw_group_id < 0) {
-      H5Gclose(read_group_id);
-      continue;
-    }
-    
-    // Check if this is the read we want (if read_id is specified)
-    if (read_id) {
-      char *current_read_id = read_string_attribute(raw_group_id, "read_id");
-      if (!current_read_id || strcmp(current_read_id, read_id) != 0) {
-        free(current_read_id);
-        H5Gclose(raw_group_id);
-        H5Gclose(read_group_id);
-        continue;
-      }
-      free(current_read_id);
-    }
-    
-    // Open Signal dataset
-    hid_t signal_dataset_id = H5Dopen2(raw_group_id, "Signal", H5P_DEFAULT);
+  hid_t file_id = open_signal_group(filename, read_id, path, group_path, sizeof(group_path));
+  if (file_id >= 0) {
+    char dataset_path[640];
+    snprintf(dataset_path, sizeof(dataset_path), "%s/Signal", group_path);
+    hid_t signal_dataset_id = H5Dopen2(file_id, dataset_path, H5P_DEFAULT);
     if (signal_dataset_id >= 0) {
-      hsize_t dims[1];
-      hid_t space_id = H5Dget_space(signal_dataset_id);
-      int ndims = H5Sget_simple_extent_dims(space_id, dims, NULL);
-      H5Sclose(space_id);
-      
-      if (ndims == 1 && dims[0] > 0) {
-        *signal_length = dims[0];
-        signal = malloc(dims[0] * sizeof(float));
-        if (signal) {
-          if (H5Dread(signal_dataset_id, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, signal) < 0) {
-            free(signal);
-            signal = NULL;
-            *signal_length = 0;
-          }
-        }
+      size_t length = get_signal_length(signal_dataset_id);
+      signal = length > 0 ? malloc(length * sizeof(float)) : NULL;
+      uint64_t profile_start = SEQ_PROFILE_START();
+      herr_t status = signal ? H5Dread(signal_dataset_id, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, signal) : -1;
+      SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, profile_start);
+      SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+      if (status >= 0) {
+        SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_READ, length * sizeof(float));
+        *signal_length = length;
+      } else {
+        free(signal);
+        signal = NULL;
       }
       H5Dclose(signal_dataset_id);
     }
-    
-    H5Gclose(raw_group_id);
-    H5Gclose(read_group_id);
-    
-    // If we found a signal, break (unless read_id was NULL, in which case we take the first one)
-    if (signal) break;
+    H5Fclose(file_id);
   }
-  
+
+  // Restore HDF5 error reporting
+  fast5_hdf5_quiet_end();
+
+  if (file_id == -1) warnx("Failed to open Fast5 file: %s", filename);
   return signal;
 }
 
-// Main function to read Fast5 signal data
-float* read_fast5_signal(const char *filename, const char *read_id, size_t *signal_length) {
-  if (!filename || !signal_length) return NULL;
-  
-  *signal_length = 0;
-  
+// Shared native int16 loader for read_fast5_signal_raw(), read_fast5_signal_raw_at() and
+// read_fast5_signal_raw_window_at(); samples [start, start + count) clipped to the signal
+// (count = SIZE_MAX reads to the end) are selected with a hyperslab, so only that window is read
+static seq_tensor* load_signal_int16(const char *filename, const char *read_id, const char *path,
+                                     size_t start, size_t count) {
   // Suppress HDF5 error messages temporarily
-  H5E_auto2_t old_func;
-  void *old_client_data;
-  H5Eget_auto2(H5E_DEFAULT, &old_func, &old_client_data);
-  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
-  
-  // Open the Fast5 file
-  hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-  
-  // Restore HDF5 error reporting
-  H5Eset_auto2(H5E_DEFAULT, old_func, old_client_data);
-  
-  if (file_id < 0) {
-    warnx("Failed to open Fast5 file: %s", filename);
-    return NULL;
-  }
-  
-  float *signal = NULL;
-  
-  // Improved format detection - check multiple indicators
-  bool is_multi_read = false;
-  
-  // Check for file_type attribute first
-  htri_t attr_exists = H5Aexists(file_id, "file_type");
-  if (attr_exists > 0) {
-    is_multi_read = true;
-  } else {
-    // No file_type attribute - check for read_* groups at root level
-    hsize_t num_objs;
-    if (H5Gget_num_objs(file_id, &num_objs) >= 0 && num_objs > 0) {
-      // Check first few objects for read_ pattern
-      for (hsize_t i = 0; i < num_objs && i < 5; i++) {
-        char obj_name[256];
-        if (H5Gget_objname_by_idx(file_id, i, obj_name, sizeof(obj_name)) >= 0) {
-          if (strncmp(obj_name, "read_", 5) == 0) {
-            is_multi_read = true;
-            break;
-          }
+  fast5_hdf5_quiet_begin();
+
+  char group_path[600];
+  seq_tensor *signal = NULL;
+  hid_t file_id = open_signal_group(filename, read_id, path, group_path, sizeof(group_path));
+  if (file_id >= 0) {
+    char dataset_path[640];
+    snprintf(dataset_path, sizeof(dataset_path), "%s/Signal", group_path);
+    hid_t signal_dataset_id = H5Dopen2(file_id, dataset_path, H5P_DEFAULT);
+    if (signal_dataset_id >= 0) {
+      size_t total = get_signal_length(signal_dataset_id);
+      size_t length = start < total ? total - start : 0;
+      if (count < length) length = count;
+
+      // real_value = scale * (raw - zero_point - zero_point_frac) with scale = range / digitisation
+      // and zero_point + zero_point_frac = -offset (offsets are usually, not always, whole ADC counts)
+      float scale = 1.0f;
+      int32_t zero_point = 0;
+      float zero_point_frac = 0.0f;
+      double offset, range, digitisation;
+      if (read_signal_calibration(file_id, group_path, &offset, &range, &digitisation)) {
+        scale = (float)(range / digitisation);
+        zero_point = (int32_t)lround(-offset);
+        zero_point_frac = (float)(-offset - zero_point);
+      }
+
+      signal = length > 0 ? seq_tensor_create_int16_uninit(2, (size_t[]){length, 1}, scale, zero_point) : NULL;
+      if (signal) {
+        signal->zero_point_frac = zero_point_frac;
+        uint64_t profile_start = SEQ_PROFILE_START();
+        herr_t status;
+        if (length == total) {
+          status = H5Dread(signal_dataset_id, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, signal->data);
+        } else {
+          hsize_t offset_dims[1] = {start}, count_dims[1] = {length};
+          hid_t file_space = H5Dget_space(signal_dataset_id);
+          hid_t mem_space = H5Screate_simple(1, count_dims, NULL);
+          status = (file_space < 0 || mem_space < 0 ||
+                    H5Sselect_hyperslab(file_space, H5S_SELECT_SET, offset_dims, NULL, count_dims, NULL) < 0) ? -1 :
+                   H5Dread(signal_dataset_id, H5T_NATIVE_INT16, mem_space, file_space, H5P_DEFAULT, signal->data);
+          if (mem_space >= 0) H5Sclose(mem_space);
+          if (file_space >= 0) H5Sclose(file_space);
+        }
+        SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, profile_start);
+        SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+        if (status >= 0) SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_READ, length * sizeof(int16_t));
+        if (status < 0) {
+          seq_tensor_free(signal);
+          signal = NULL;
         }
       }
+      H5Dclose(signal_dataset_id);
     }
+    H5Fclose(file_id);
   }
-  
-  if (is_multi_read) {
-    signal = read_multi_read_signal(file_id, read_id, signal_length);
-  } else {
-    signal = read_single_read_signal(file_id, read_id, signal_length);
-  }
-  
-  H5Fclose(file_id);
+
+  // Restore HDF5 error reporting
+  fast5_hdf5_quiet_end();
+
+  if (file_id == -1) warnx("Failed to open Fast5 file: %s", filename);
   return signal;
 }
 
+// Main function to read Fast5 signal data
+float* read_fast5_signal(const char *filename, const char *read_id, size_t *signal_length) {
+  if (!filename || !signal_length) return NULL;
+  return load_signal_float(filename, read_id, NULL, signal_length);
+}
+
+// Direct read by HDF5 group path (no group scan; used by the read-id index)
+float* read_fast5_signal_at(const char *filename, const char *group_path, size_t *signal_length) {
+  if (!filename || !group_path || !signal_length) return NULL;
+  return load_signal_float(filename, NULL, group_path, signal_length);
+}
+
+// Native int16 read: no float conversion inside HDF5, calibration carried as scale/zero_point
+seq_tensor* read_fast5_signal_raw(const char *filename, const char *read_id) {
+  if (!filename) return NULL;
+  return load_signal_int16(filename, read_id, NULL, 0, SIZE_MAX);
+}
+
+seq_tensor* read_fast5_signal_raw_at(const char *filename, const char *group_path) {
+  if (!filename || !group_path) return NULL;
+  return load_signal_int16(filename, NULL, group_path, 0, SIZE_MAX);
+}
+
+seq_tensor* read_fast5_signal_raw_window_at(const char *filename, const char *group_path, size_t start, size_t count) {
+  if (!filename || !group_path || count == 0) return NULL;
+  return load_signal_int16(filename, NULL, group_path, start, count);
+}
+
 // Free Fast5 signal data
 void free_fast5_signal(float *signal) {
   if (signal) {
@@ -1264,498 +1380,814 @@ void free_fast5_signal(float *signal) {
 // Fast5 File Writing Functions
 // **********************************************************************
 
+// Per-file ADC calibration written to channel_id: pA = (raw + offset) * range / digitisation
+typedef struct {
+  double digitisation;
+  double range;
+  double offset;
+} fast5_calibration_t;
+
+// Reusable HDF5 objects shared by every read in one file (avoids ~10 scalar
+// dataspaces and several string types per read)
+typedef struct {
+  hid_t scalar_space;
+  hid_t fixed_str_type;     // Fixed-length C string, resized per attribute
+  hid_t vlen_str_type;      // Variable-length ASCII string
+  hid_t signal_dcpl;        // Chunked/filtered dataset creation properties
+  hid_t signal_file_type;   // int16 or float32 on disk
+  const fast5_write_options_t *options;
+  fast5_calibration_t calibration;
+  int16_t *quantised;       // Reusable int16 conversion buffer
+  size_t quantised_capacity;
+  fast5_write_stats_t *stats;
+} fast5_write_context_t;
+
+void fast5_write_options_init(fast5_write_options_t *options) {
+  if (!options) return;
+  options->quantise_int16 = true;
+  options->compression_level = 1;
+  options->shuffle = true;
+  options->chunk_samples = 16384;
+}
+
+// File access properties tuned for writing many small groups: 1.8+ object formats
+// (indexed link storage for large root groups), aggregated metadata blocks and a
+// larger initial metadata cache
+static hid_t create_write_fapl(void) {
+  hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+  if (fapl < 0) return H5P_DEFAULT;
+
+  H5Pset_libver_bounds(fapl, H5F_LIBVER_V18, H5F_LIBVER_LATEST);
+  H5Pset_meta_block_size(fapl, 64 * 1024);
+
+  H5AC_cache_config_t mdc_config;
+  mdc_config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+  if (H5Pget_mdc_config(fapl, &mdc_config) >= 0) {
+    mdc_config.set_initial_size = true;
+    mdc_config.initial_size = 16 * 1024 * 1024;
+    if (mdc_config.max_size < mdc_config.initial_size) mdc_config.max_size = mdc_config.initial_size;
+    H5Pset_mdc_config(fapl, &mdc_config);
+  }
+  return fapl;
+}
+
+// Account a finished output file's on-disk size in the write statistics
+static void add_file_bytes(fast5_write_stats_t *stats, const char *filename) {
+  struct stat file_stat;
+  if (stats && stat(filename, &file_stat) == 0) {
+    stats->file_bytes += (size_t)file_stat.st_size;
+  }
+}
+
+// Choose calibration so quantised samples span 13 bits (0..8191) over the given signals' range
+static fast5_calibration_t compute_signal_calibration(const seq_tensor *const *raw_signals, int num_reads, bool quantise) {
+  fast5_calibration_t calibration = {8192.0, 1517.25, 0.0};
+  if (!quantise) return calibration;
+
+  float min_value = 0.0f, max_value = 0.0f;
+  bool seen = false;
+  for (int r = 0; r < num_reads; r++) {
+    if (!raw_signals[r]) continue;
+    size_t length = seq_tensor_dim(raw_signals[r], 0);
+    if (length == 0) continue;
+    float read_min, read_max;
+    seq_kernel_minmax_f32((const float *)raw_signals[r]->data, length, &read_min, &read_max);
+    if (!seen || read_min < min_value) min_value = read_min;
+    if (!seen || read_max > max_value) max_value = read_max;
+    seen = true;
+  }
+
+  double span = (double)max_value - (double)min_value;
+  if (seen && span > 0.0) {
+    calibration.range = span * calibration.digitisation / (calibration.digitisation - 1.0);
+  }
+  double scale = calibration.range / calibration.digitisation;
+  calibration.offset = round((double)min_value / scale);
+  return calibration;
+}
+
+// raw_signals = NULL defers calibration to each read (multi-read files carry a channel_id per read)
+static bool init_write_context(fast5_write_context_t *ctx, seq_tensor **raw_signals, int num_reads,
+                               const fast5_write_options_t *options, fast5_write_stats_t *stats) {
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->options = options;
+  ctx->stats = stats;
+  ctx->calibration = compute_signal_calibration((const seq_tensor *const *)raw_signals,
+                                                raw_signals ? num_reads : 0, options->quantise_int16);
+  ctx->signal_file_type = options->quantise_int16 ? H5T_STD_I16LE : H5T_IEEE_F32LE;
+
+  ctx->scalar_space = H5Screate(H5S_SCALAR);
+  ctx->fixed_str_type = H5Tcopy(H5T_C_S1);
+  ctx->vlen_str_type = H5Tcopy(H5T_C_S1);
+  H5Tset_size(ctx->vlen_str_type, H5T_VARIABLE);
+  H5Tset_cset(ctx->vlen_str_type, H5T_CSET_ASCII);
+  H5Tset_strpad(ctx->vlen_str_type, H5T_STR_NULLTERM);
+
+  ctx->signal_dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  if (options->shuffle && options->compression_level > 0) {
+    H5Pset_shuffle(ctx->signal_dcpl);
+  }
+  if (options->compression_level > 0) {
+    if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) {
+      H5Pset_deflate(ctx->signal_dcpl, (unsigned)options->compression_level);
+    } else {
+      warnx("Deflate filter not available in this HDF5 build, writing uncompressed signals");
+    }
+  }
+
+  return ctx->scalar_space >= 0 && ctx->fixed_str_type >= 0 && ctx->vlen_str_type >= 0 && ctx->signal_dcpl >= 0;
+}
+
+static void free_write_context(fast5_write_context_t *ctx) {
+  if (ctx->signal_dcpl >= 0) H5Pclose(ctx->signal_dcpl);
+  if (ctx->vlen_str_type >= 0) H5Tclose(ctx->vlen_str_type);
+  if (ctx->fixed_str_type >= 0) H5Tclose(ctx->fixed_str_type);
+  if (ctx->scalar_space >= 0) H5Sclose(ctx->scalar_space);
+  free(ctx->quantised);
+}
+
+static void write_scalar_attr(hid_t loc_id, const char *name, hid_t mem_type, hid_t space, const void *value) {
+  hid_t attr_id = H5Acreate2(loc_id, name, mem_type, space, H5P_DEFAULT, H5P_DEFAULT);
+  if (attr_id < 0) return;
+  H5Awrite(attr_id, mem_type, value);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  H5Aclose(attr_id);
+}
+
+// Fixed-length string attribute of size bytes (the shared type is copied on attribute creation)
+static void write_fixed_string_attr(fast5_write_context_t *ctx, hid_t loc_id, const char *name,
+                                    const char *value, size_t size) {
+  H5Tset_size(ctx->fixed_str_type, size);
+  write_scalar_attr(loc_id, name, ctx->fixed_str_type, ctx->scalar_space, value);
+}
+
+static void write_vlen_string_attr(fast5_write_context_t *ctx, hid_t loc_id, const char *name, const char *value) {
+  write_scalar_attr(loc_id, name, ctx->vlen_str_type, ctx->scalar_space, &value);
+}
+
+// Create and write one Signal dataset: chunked (chunk clamped to the read length),
+// filtered per the options, int16-quantised with the file calibration or float32
+static int write_signal_dataset(fast5_write_context_t *ctx, hid_t group_id, const seq_tensor *signal) {
+  const float *signal_data = (const float *)signal->data;
+  size_t signal_length = seq_tensor_dim(signal, 0);
+
+  hsize_t signal_dims[1] = {signal_length};
+  hsize_t chunk_dims[1] = {ctx->options->chunk_samples > 0 && ctx->options->chunk_samples < signal_length
+                           ? ctx->options->chunk_samples : signal_length};
+  H5Pset_chunk(ctx->signal_dcpl, 1, chunk_dims);
+
+  const void *buffer = signal_data;
+  hid_t mem_type = H5T_NATIVE_FLOAT;
+  size_t element_size = sizeof(float);
+
+  if (ctx->options->quantise_int16) {
+    if (signal_length > ctx->quantised_capacity) {
+      int16_t *grown = realloc(ctx->quantised, signal_length * sizeof(int16_t));
+      if (!grown) return -1;
+      ctx->quantised = grown;
+      ctx->quantised_capacity = signal_length;
+    }
+    // raw = pA / scale - offset, rounded and saturated to int16
+    const float inv_scale = (float)(ctx->calibration.digitisation / ctx->calibration.range);
+    const float offset = (float)ctx->calibration.offset;
+    seq_kernel_quantise_f32_i16(signal_data, ctx->quantised, signal_length, inv_scale, -offset);
+    buffer = ctx->quantised;
+    mem_type = H5T_NATIVE_INT16;
+    element_size = sizeof(int16_t);
+  }
+
+  hid_t signal_space_id = H5Screate_simple(1, signal_dims, NULL);
+  hid_t signal_dataset_id = H5Dcreate2(group_id, "Signal", ctx->signal_file_type, signal_space_id,
+                                      H5P_DEFAULT, ctx->signal_dcpl, H5P_DEFAULT);
+  int status = 0;
+  if (signal_dataset_id < 0 ||
+      H5Dwrite(signal_dataset_id, mem_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer) < 0) {
+    status = -1;
+  }
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  if (status == 0) SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_WRITTEN, signal_length * element_size);
+
+  if (status == 0 && ctx->stats) {
+    ctx->stats->reads_written++;
+    ctx->stats->samples_written += signal_length;
+    ctx->stats->logical_bytes += signal_length * element_size;
+    ctx->stats->stored_bytes += (size_t)H5Dget_storage_size(signal_dataset_id);
+  }
+
+  if (signal_dataset_id >= 0) H5Dclose(signal_dataset_id);
+  H5Sclose(signal_space_id);
+  return status;
+}
+
+// Root file_version / file_type attributes
+static void write_file_attributes(fast5_write_context_t *ctx, hid_t file_id, const char *file_type) {
+  double version = 1.0;
+  write_scalar_attr(file_id, "file_version", H5T_NATIVE_DOUBLE, ctx->scalar_space, &version);
+  write_vlen_string_attr(ctx, file_id, "file_type", file_type);
+}
+
+// Per-read attributes (on /Raw/Reads/Read_N or read_<id>/Raw)
+static void write_read_attributes(fast5_write_context_t *ctx, hid_t group_id, const char *read_name,
+                                  uint32_t duration, uint32_t read_number) {
+  write_scalar_attr(group_id, "duration", H5T_NATIVE_UINT32, ctx->scalar_space, &duration);
+  write_fixed_string_attr(ctx, group_id, "read_id", read_name, strlen(read_name) + 1);
+  write_scalar_attr(group_id, "read_number", H5T_NATIVE_UINT32, ctx->scalar_space, &read_number);
+  int32_t start_mux = 2;
+  write_scalar_attr(group_id, "start_mux", H5T_NATIVE_INT32, ctx->scalar_space, &start_mux);
+  uint64_t start_time = 0;
+  write_scalar_attr(group_id, "start_time", H5T_NATIVE_UINT64, ctx->scalar_space, &start_time);
+}
+
+// channel_id, context_tags and tracking_id groups below parent_id
+static void write_global_key_groups(fast5_write_context_t *ctx, hid_t parent_id, const char *filename,
+                                    float sample_rate_khz) {
+  hid_t channel_group_id = H5Gcreate2(parent_id, "channel_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  write_fixed_string_attr(ctx, channel_group_id, "channel_number", "1", 2);
+  write_scalar_attr(channel_group_id, "digitisation", H5T_NATIVE_DOUBLE, ctx->scalar_space, &ctx->calibration.digitisation);
+  write_scalar_attr(channel_group_id, "offset", H5T_NATIVE_DOUBLE, ctx->scalar_space, &ctx->calibration.offset);
+  write_scalar_attr(channel_group_id, "range", H5T_NATIVE_DOUBLE, ctx->scalar_space, &ctx->calibration.range);
+  double sampling_rate = sample_rate_khz * 1000.0;
+  write_scalar_attr(channel_group_id, "sampling_rate", H5T_NATIVE_DOUBLE, ctx->scalar_space, &sampling_rate);
+  H5Gclose(channel_group_id);
+
+  hid_t context_group_id = H5Gcreate2(parent_id, "context_tags", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  const char* basename = strrchr(filename, '/') ? strrchr(filename, '/') + 1 : filename;
+  write_fixed_string_attr(ctx, context_group_id, "filename", basename, strlen(basename) + 1);
+  H5Gclose(context_group_id);
+
+  hid_t tracking_group_id = H5Gcreate2(parent_id, "tracking_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  write_fixed_string_attr(ctx, tracking_group_id, "exp_start_time", "2025-01-01T00:00:00", 20);
+  write_fixed_string_attr(ctx, tracking_group_id, "run_id", "sequelizer_synthetic_run_001", 40);
+  write_vlen_string_attr(ctx, tracking_group_id, "flow_cell_id", "FAKE_FC_001");
+  write_vlen_string_attr(ctx, tracking_group_id, "device_id", "SM001");
+  H5Gclose(tracking_group_id);
+}
+
 // Write a single-read Fast5 file
 int seq_write_fast5_single(const char* filename, seq_tensor** raw_signals,
                            const char** read_names, int num_reads,
                            float sample_rate_khz) {
+  fast5_write_options_t options;
+  fast5_write_options_init(&options);
+  return seq_write_fast5_single_ex(filename, raw_signals, read_names, num_reads,
+                                   sample_rate_khz, &options, NULL);
+}
+
+int seq_write_fast5_single_ex(const char* filename, seq_tensor** raw_signals,
+                              const char** read_names, int num_reads,
+                              float sample_rate_khz, const fast5_write_options_t *options,
+                              fast5_write_stats_t *stats) {
   // Validate parameters
-  if (!filename || !raw_signals || !read_names || num_reads <= 0) {
+  if (!filename || !raw_signals || !read_names || num_reads <= 0 || !options) {
     warnx("Invalid parameters to seq_write_fast5_single");
     return -1;
   }
+  if (stats) memset(stats, 0, sizeof(*stats));
 
-  hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  uint64_t profile_start = SEQ_PROFILE_START();
+  hid_t fapl = create_write_fapl();
+  hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  if (fapl != H5P_DEFAULT) H5Pclose(fapl);
   if (file_id < 0) {
-    errx(EXIT_FAILURE, "Failed to create Fast5 file: %s", filename);
+    warnx("Failed to create Fast5 file: %s", filename);
+    return -1;
   }
 
-  double version = 1.0;
-  hid_t attr_space = H5Screate(H5S_SCALAR);
-  hid_t attr = H5Acreate2(file_id, "file_version", H5T_NATIVE_DOUBLE, attr_space, H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(attr, H5T_NATIVE_DOUBLE, &version);
-  H5Aclose(attr);
-  H5Sclose(attr_space);
+  fast5_write_context_t ctx;
+  if (!init_write_context(&ctx, raw_signals, num_reads, options, stats)) {
+    warnx("Failed to initialise Fast5 writer for: %s", filename);
+    free_write_context(&ctx);
+    H5Fclose(file_id);
+    return -1;
+  }
 
   // Add file_type attribute for single-read format
-  hid_t file_type_str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(file_type_str_type, H5T_VARIABLE);
-  H5Tset_cset(file_type_str_type, H5T_CSET_ASCII);
-  H5Tset_strpad(file_type_str_type, H5T_STR_NULLTERM);
-  hid_t file_type_space_id = H5Screate(H5S_SCALAR);
-  hid_t file_type_attr_id = H5Acreate2(file_id, "file_type", file_type_str_type, file_type_space_id, H5P_DEFAULT, H5P_DEFAULT);
-  const char* file_type_value = "single-read";
-  H5Awrite(file_type_attr_id, file_type_str_type, &file_type_value);
-  H5Aclose(file_type_attr_id);
-  H5Sclose(file_type_space_id);
-  H5Tclose(file_type_str_type);
+  write_file_attributes(&ctx, file_id, "single-read");
 
   // Create parent groups first
+  int status = -1;
   hid_t raw_group_id = H5Gcreate2(file_id, "/Raw", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t reads_group_id = raw_group_id < 0 ? -1 :
+                         H5Gcreate2(file_id, "/Raw/Reads", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t ugk_group_id = reads_group_id < 0 ? -1 :
+                       H5Gcreate2(file_id, "/UniqueGlobalKey", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
   if (raw_group_id < 0) {
-    errx(EXIT_FAILURE, "Failed to create /Raw group");
-  }
-
-  hid_t reads_group_id = H5Gcreate2(file_id, "/Raw/Reads", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  if (reads_group_id < 0) {
-    errx(EXIT_FAILURE, "Failed to create /Raw/Reads group");
-  }
-
-  hid_t ugk_group_id = H5Gcreate2(file_id, "/UniqueGlobalKey", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  if (ugk_group_id < 0) {
-    errx(EXIT_FAILURE, "Failed to create /UniqueGlobalKey group");
+    warnx("Failed to create /Raw group");
+  } else if (reads_group_id < 0) {
+    warnx("Failed to create /Raw/Reads group");
+  } else if (ugk_group_id < 0) {
+    warnx("Failed to create /UniqueGlobalKey group");
+  } else {
+    status = 0;
   }
 
-  H5Gclose(reads_group_id);
-  H5Gclose(raw_group_id);
-  H5Gclose(ugk_group_id);
-
-  for (int read_idx = 0; read_idx < num_reads; read_idx++) {
+  for (int read_idx = 0; read_idx < num_reads && status == 0; read_idx++) {
     if (NULL == raw_signals[read_idx]) continue;
 
     char read_group_path[256];
     snprintf(read_group_path, sizeof(read_group_path), "/Raw/Reads/Read_%d", read_idx);
 
     hid_t read_group_id = H5Gcreate2(file_id, read_group_path, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
     if (read_group_id < 0) {
-      errx(EXIT_FAILURE, "Failed to create read group: %s", read_group_path);
+      warnx("Failed to create read group: %s", read_group_path);
+      status = -1;
+      break;
     }
 
-    // Get signal data and length from seq_tensor
-    float *signal_data = seq_tensor_data_float(raw_signals[read_idx]);
-    size_t signal_length = seq_tensor_dim(raw_signals[read_idx], 0);
-
-    hsize_t signal_dims[1] = {signal_length};
-    hid_t signal_space_id = H5Screate_simple(1, signal_dims, NULL);
-    hid_t signal_dataset_id = H5Dcreate2(read_group_id, "Signal", H5T_NATIVE_FLOAT, signal_space_id,
-                                        H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    if (H5Dwrite(signal_dataset_id, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT,
-                 signal_data) < 0) {
-      errx(EXIT_FAILURE, "Failed to write signal data for read %d", read_idx);
+    if (write_signal_dataset(&ctx, read_group_id, raw_signals[read_idx]) < 0) {
+      warnx("Failed to write signal data for read %d", read_idx);
+      status = -1;
+    } else {
+      write_read_attributes(&ctx, read_group_id, read_names[read_idx],
+                            (uint32_t)seq_tensor_dim(raw_signals[read_idx], 0), (uint32_t)read_idx);
     }
-
-    uint32_t duration = (uint32_t)signal_length;
-    hid_t duration_space_id = H5Screate(H5S_SCALAR);
-    hid_t duration_attr_id = H5Acreate2(read_group_id, "duration", H5T_NATIVE_UINT32, duration_space_id,
-                                       H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(duration_attr_id, H5T_NATIVE_UINT32, &duration);
-
-    hid_t str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(str_type, strlen(read_names[read_idx]) + 1);
-    hid_t read_id_space_id = H5Screate(H5S_SCALAR);
-    hid_t read_id_attr_id = H5Acreate2(read_group_id, "read_id", str_type, read_id_space_id,
-                                      H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(read_id_attr_id, str_type, read_names[read_idx]);
-
-    uint32_t read_number = read_idx;
-    hid_t read_number_space_id = H5Screate(H5S_SCALAR);
-    hid_t read_number_attr_id = H5Acreate2(read_group_id, "read_number", H5T_NATIVE_UINT32, read_number_space_id,
-                                          H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(read_number_attr_id, H5T_NATIVE_UINT32, &read_number);
-
-    int32_t start_mux = 2;
-    hid_t start_mux_space_id = H5Screate(H5S_SCALAR);
-    hid_t start_mux_attr_id = H5Acreate2(read_group_id, "start_mux", H5T_NATIVE_INT32, start_mux_space_id,
-                                        H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(start_mux_attr_id, H5T_NATIVE_INT32, &start_mux);
-
-    uint64_t start_time = 0;
-    hid_t start_time_space_id = H5Screate(H5S_SCALAR);
-    hid_t start_time_attr_id = H5Acreate2(read_group_id, "start_time", H5T_NATIVE_UINT64, start_time_space_id,
-                                         H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(start_time_attr_id, H5T_NATIVE_UINT64, &start_time);
-
-    H5Aclose(start_time_attr_id);
-    H5Sclose(start_time_space_id);
-    H5Aclose(start_mux_attr_id);
-    H5Sclose(start_mux_space_id);
-    H5Aclose(read_number_attr_id);
-    H5Sclose(read_number_space_id);
-    H5Aclose(read_id_attr_id);
-    H5Sclose(read_id_space_id);
-    H5Tclose(str_type);
-    H5Aclose(duration_attr_id);
-    H5Sclose(duration_space_id);
-    H5Dclose(signal_dataset_id);
-    H5Sclose(signal_space_id);
     H5Gclose(read_group_id);
   }
 
-  hid_t channel_group_id = H5Gcreate2(file_id, "/UniqueGlobalKey/channel_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (status == 0) write_global_key_groups(&ctx, ugk_group_id, filename, sample_rate_khz);
 
-  hid_t str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(str_type, 2);
-  hid_t channel_number_space_id = H5Screate(H5S_SCALAR);
-  hid_t channel_number_attr_id = H5Acreate2(channel_group_id, "channel_number", str_type, channel_number_space_id,
-                                           H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(channel_number_attr_id, str_type, "1");
+  if (ugk_group_id >= 0) H5Gclose(ugk_group_id);
+  if (reads_group_id >= 0) H5Gclose(reads_group_id);
+  if (raw_group_id >= 0) H5Gclose(raw_group_id);
+  free_write_context(&ctx);
 
-  double digitisation = 8192.0;
-  hid_t digitisation_space_id = H5Screate(H5S_SCALAR);
-  hid_t digitisation_attr_id = H5Acreate2(channel_group_id, "digitisation", H5T_NATIVE_DOUBLE, digitisation_space_id,
-                                         H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(digitisation_attr_id, H5T_NATIVE_DOUBLE, &digitisation);
+  H5Fclose(file_id);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+  if (status == 0) add_file_bytes(stats, filename);
+  return status;
+}
 
-  double offset = 0.0;
-  hid_t offset_space_id = H5Screate(H5S_SCALAR);
-  hid_t offset_attr_id = H5Acreate2(channel_group_id, "offset", H5T_NATIVE_DOUBLE, offset_space_id,
-                                   H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(offset_attr_id, H5T_NATIVE_DOUBLE, &offset);
+// Add one read_<name> group (Raw/Signal, read attributes, per-read channel calibration)
+static int append_multi_read(fast5_write_context_t *ctx, hid_t file_id, const char *filename,
+                             const seq_tensor *raw_signal, const char *read_name,
+                             uint32_t read_number, float sample_rate_khz) {
+  // Calibration per read: quantisation stays tight without seeing the whole run up front
+  ctx->calibration = compute_signal_calibration(&raw_signal, 1, ctx->options->quantise_int16);
 
-  double range = 1517.25;
-  hid_t range_space_id = H5Screate(H5S_SCALAR);
-  hid_t range_attr_id = H5Acreate2(channel_group_id, "range", H5T_NATIVE_DOUBLE, range_space_id,
-                                  H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(range_attr_id, H5T_NATIVE_DOUBLE, &range);
+  // Create read group path as read_<read_name>
+  char read_group_path[256];
+  snprintf(read_group_path, sizeof(read_group_path), "read_%s", read_name);
 
-  double sampling_rate = sample_rate_khz * 1000.0;
-  hid_t sampling_rate_space_id = H5Screate(H5S_SCALAR);
-  hid_t sampling_rate_attr_id = H5Acreate2(channel_group_id, "sampling_rate", H5T_NATIVE_DOUBLE, sampling_rate_space_id,
-                                          H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(sampling_rate_attr_id, H5T_NATIVE_DOUBLE, &sampling_rate);
-
-  H5Aclose(sampling_rate_attr_id);
-  H5Sclose(sampling_rate_space_id);
-  H5Aclose(range_attr_id);
-  H5Sclose(range_space_id);
-  H5Aclose(offset_attr_id);
-  H5Sclose(offset_space_id);
-  H5Aclose(digitisation_attr_id);
-  H5Sclose(digitisation_space_id);
-  H5Aclose(channel_number_attr_id);
-  H5Sclose(channel_number_space_id);
-  H5Tclose(str_type);
-  H5Gclose(channel_group_id);
+  hid_t read_group_id = H5Gcreate2(file_id, read_group_path, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (read_group_id < 0) {
+    warnx("Failed to create read group: %s", read_group_path);
+    return -1;
+  }
 
-  hid_t context_group_id = H5Gcreate2(file_id, "/UniqueGlobalKey/context_tags", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  // Create Raw subgroup under the read group
+  hid_t read_raw_group_id = H5Gcreate2(read_group_id, "Raw", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (read_raw_group_id < 0) {
+    warnx("Failed to create Raw subgroup for read: %s", read_name);
+    H5Gclose(read_group_id);
+    return -1;
+  }
 
-  str_type = H5Tcopy(H5T_C_S1);
-  const char* basename = strrchr(filename, '/') ? strrchr(filename, '/') + 1 : filename;
-  H5Tset_size(str_type, strlen(basename) + 1);
-  hid_t filename_space_id = H5Screate(H5S_SCALAR);
-  hid_t filename_attr_id = H5Acreate2(context_group_id, "filename", str_type, filename_space_id,
-                                     H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(filename_attr_id, str_type, basename);
-
-  H5Aclose(filename_attr_id);
-  H5Sclose(filename_space_id);
-  H5Tclose(str_type);
-  H5Gclose(context_group_id);
+  // Create Signal dataset in the Raw subgroup
+  int status = write_signal_dataset(ctx, read_raw_group_id, raw_signal);
+  if (status < 0) {
+    warnx("Failed to write signal data for read %s", read_name);
+  } else {
+    // Add read attributes to the Raw subgroup (not the read group)
+    write_read_attributes(ctx, read_raw_group_id, read_name,
+                          (uint32_t)seq_tensor_dim(raw_signal, 0), read_number);
 
-  hid_t tracking_group_id = H5Gcreate2(file_id, "/UniqueGlobalKey/tracking_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-  str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(str_type, 20);
-  hid_t exp_start_time_space_id = H5Screate(H5S_SCALAR);
-  hid_t exp_start_time_attr_id = H5Acreate2(tracking_group_id, "exp_start_time", str_type, exp_start_time_space_id,
-                                           H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(exp_start_time_attr_id, str_type, "2025-01-01T00:00:00");
-
-  // Add required run_id attribute
-  hid_t run_id_str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(run_id_str_type, 40);
-  hid_t run_id_space_id = H5Screate(H5S_SCALAR);
-  hid_t run_id_attr_id = H5Acreate2(tracking_group_id, "run_id", run_id_str_type, run_id_space_id,
-                                   H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(run_id_attr_id, run_id_str_type, "sequelizer_synthetic_run_001");
-
-  // Add flow_cell_id (length = variable, regular string, not byte string)
-  hid_t flowcell_id_str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(flowcell_id_str_type, H5T_VARIABLE);  // Variable length
-  H5Tset_cset(flowcell_id_str_type, H5T_CSET_ASCII); // ASCII, not UTF8
-  H5Tset_strpad(flowcell_id_str_type, H5T_STR_NULLTERM);
-  hid_t flowcell_id_space_id = H5Screate(H5S_SCALAR);
-  hid_t flowcell_id_attr_id = H5Acreate2(tracking_group_id, "flow_cell_id", flowcell_id_str_type, flowcell_id_space_id, H5P_DEFAULT, H5P_DEFAULT);
-  // For variable-length strings, you need to write a pointer to the string
-  const char* flowcell_value = "FAKE_FC_001";
-  H5Awrite(flowcell_id_attr_id, flowcell_id_str_type, &flowcell_value); // Note the &
-
-  // Add device_id (length = variable, regular string, not byte string)
-  hid_t device_id_str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(device_id_str_type, H5T_VARIABLE);  // Variable length
-  H5Tset_cset(device_id_str_type, H5T_CSET_ASCII); // ASCII, not UTF8
-  H5Tset_strpad(device_id_str_type, H5T_STR_NULLTERM);
-  hid_t device_id_space_id = H5Screate(H5S_SCALAR);
-  hid_t device_id_attr_id = H5Acreate2(tracking_group_id, "device_id", device_id_str_type, device_id_space_id, H5P_DEFAULT, H5P_DEFAULT);
-  // For variable-length strings, you need to write a pointer to the string
-  const char* device_value = "SM001";
-  H5Awrite(device_id_attr_id, device_id_str_type, &device_value); // Note the &
-
-  H5Aclose(device_id_attr_id);
-  H5Sclose(device_id_space_id);
-  H5Tclose(device_id_str_type);
-  H5Aclose(flowcell_id_attr_id);
-  H5Sclose(flowcell_id_space_id);
-  H5Tclose(flowcell_id_str_type);
-  H5Aclose(run_id_attr_id);
-  H5Sclose(run_id_space_id);
-  H5Tclose(run_id_str_type);
-  H5Aclose(exp_start_time_attr_id);
-  H5Sclose(exp_start_time_space_id);
-  H5Tclose(str_type);
-  H5Gclose(tracking_group_id);
+    // Add run_id attribute directly to the read group
+    write_fixed_string_attr(ctx, read_group_id, "run_id", "sequelizer_synthetic_run_001", 40);
 
-  H5Fclose(file_id);
-  return 0;
+    // channel_id, context_tags and tracking_id groups under this read
+    write_global_key_groups(ctx, read_group_id, filename, sample_rate_khz);
+  }
+
+  H5Gclose(read_raw_group_id);
+  H5Gclose(read_group_id);
+  return status;
+}
+
+// Create a multi-read file with its root attributes
+static hid_t create_multi_read_file(fast5_write_context_t *ctx, const char *filename) {
+  hid_t fapl = create_write_fapl();
+  hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  if (fapl != H5P_DEFAULT) H5Pclose(fapl);
+  if (file_id < 0) {
+    warnx("Failed to create Fast5 file: %s", filename);
+    return -1;
+  }
+
+  // Add file_type attribute for multi-read format
+  write_file_attributes(ctx, file_id, "multi-read");
+  return file_id;
 }
 
 // Write a multi-read Fast5 file
 int seq_write_fast5_multi(const char* filename, seq_tensor** raw_signals,
                           const char** read_names, int num_reads,
                           float sample_rate_khz) {
+  fast5_write_options_t options;
+  fast5_write_options_init(&options);
+  return seq_write_fast5_multi_ex(filename, raw_signals, read_names, num_reads,
+                                  sample_rate_khz, &options, NULL);
+}
+
+int seq_write_fast5_multi_ex(const char* filename, seq_tensor** raw_signals,
+                             const char** read_names, int num_reads,
+                             float sample_rate_khz, const fast5_write_options_t *options,
+                             fast5_write_stats_t *stats) {
   // Validate parameters
-  if (!filename || !raw_signals || !read_names || num_reads <= 0) {
+  if (!filename || !raw_signals || !read_names || num_reads <= 0 || !options) {
     warnx("Invalid parameters to seq_write_fast5_multi");
     return -1;
   }
+  if (stats) memset(stats, 0, sizeof(*stats));
 
-  hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-  if (file_id < 0) {
-    errx(EXIT_FAILURE, "Failed to create Fast5 file: %s", filename);
+  uint64_t profile_start = SEQ_PROFILE_START();
+  fast5_write_context_t ctx;
+  if (!init_write_context(&ctx, NULL, 0, options, stats)) {
+    warnx("Failed to initialise Fast5 writer for: %s", filename);
+    free_write_context(&ctx);
+    return -1;
   }
 
-  // Add file_version attribute
-  double version = 1.0;
-  hid_t attr_space = H5Screate(H5S_SCALAR);
-  hid_t attr = H5Acreate2(file_id, "file_version", H5T_NATIVE_DOUBLE, attr_space, H5P_DEFAULT, H5P_DEFAULT);
-  H5Awrite(attr, H5T_NATIVE_DOUBLE, &version);
-  H5Aclose(attr);
-  H5Sclose(attr_space);
-
-  // Add file_type attribute for multi-read format
-  hid_t file_type_str_type = H5Tcopy(H5T_C_S1);
-  H5Tset_size(file_type_str_type, H5T_VARIABLE);
-  H5Tset_cset(file_type_str_type, H5T_CSET_ASCII);
-  H5Tset_strpad(file_type_str_type, H5T_STR_NULLTERM);
-  hid_t file_type_space_id = H5Screate(H5S_SCALAR);
-  hid_t file_type_attr_id = H5Acreate2(file_id, "file_type", file_type_str_type, file_type_space_id, H5P_DEFAULT, H5P_DEFAULT);
-  const char* file_type_value = "multi-read";
-  H5Awrite(file_type_attr_id, file_type_str_type, &file_type_value);
-  H5Aclose(file_type_attr_id);
-  H5Sclose(file_type_space_id);
-  H5Tclose(file_type_str_type);
+  // create_multi_read_file() warns on failure
+  hid_t file_id = create_multi_read_file(&ctx, filename);
+  if (file_id < 0) {
+    free_write_context(&ctx);
+    return -1;
+  }
 
   // Process each read - create root-level read_<read_name> groups
-  for (int read_idx = 0; read_idx < num_reads; read_idx++) {
+  int status = 0;
+  for (int read_idx = 0; read_idx < num_reads && status == 0; read_idx++) {
     if (NULL == raw_signals[read_idx]) continue;
+    status = append_multi_read(&ctx, file_id, filename, raw_signals[read_idx], read_names[read_idx],
+                               (uint32_t)read_idx, sample_rate_khz);
+  }
 
-    // Create read group path as read_<read_name>
-    char read_group_path[256];
-    snprintf(read_group_path, sizeof(read_group_path), "read_%s", read_names[read_idx]);
+  free_write_context(&ctx);
 
-    hid_t read_group_id = H5Gcreate2(file_id, read_group_path, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    if (read_group_id < 0) {
-      errx(EXIT_FAILURE, "Failed to create read group: %s", read_group_path);
-    }
+  H5Fclose(file_id);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+  if (status == 0) add_file_bytes(stats, filename);
+  return status;
+}
 
-    // Create Raw subgroup under the read group
-    hid_t read_raw_group_id = H5Gcreate2(read_group_id, "Raw", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    if (read_raw_group_id < 0) {
-      errx(EXIT_FAILURE, "Failed to create Raw subgroup for read: %s", read_names[read_idx]);
-    }
+// **********************************************************************
+// Streaming Fast5 Writer
+// **********************************************************************
 
-    // Get signal data and length from seq_tensor
-    float *signal_data = seq_tensor_data_float(raw_signals[read_idx]);
-    size_t signal_length = seq_tensor_dim(raw_signals[read_idx], 0);
+struct fast5_writer {
+  char *base_filename;          // Name given to fast5_writer_open()
+  float sample_rate_khz;
+  fast5_write_options_t options;
+  size_t reads_per_file;        // 0 = never roll over
+
+  fast5_write_context_t ctx;    // Shared spaces/types/dcpl, reused across files
+  fast5_write_stats_t stats;
+
+  hid_t file_id;                // Current multi-read file (-1 if none open)
+  char current_filename[PATH_MAX];
+  size_t reads_in_file;
+  size_t file_index;            // Number of files opened so far
+  size_t reads_appended;
+
+  // A stream of exactly one read is written as a single-read file (as seqgen always
+  // did), so the first read is held back until a second one arrives or the stream closes
+  seq_tensor *pending_signal;
+  char *pending_name;
+};
+
+// Numbered name for file index: out.fast5 -> out_<index>.fast5
+static void numbered_filename(const char *base, size_t index, char *out, size_t out_size) {
+  const char *ext = strrchr(base, '.');
+  const char *slash = strrchr(base, '/');
+  if (!ext || (slash && ext < slash)) ext = base + strlen(base);
+  snprintf(out, out_size, "%.*s_%zu%s", (int)(ext - base), base, index, ext);
+}
+
+fast5_writer_t* fast5_writer_open(const char *filename, float sample_rate_khz,
+                                  const fast5_write_options_t *options, size_t reads_per_file) {
+  if (!filename) return NULL;
 
-    // Create Signal dataset in the Raw subgroup
-    hsize_t signal_dims[1] = {signal_length};
-    hid_t signal_space_id = H5Screate_simple(1, signal_dims, NULL);
-    hid_t signal_dataset_id = H5Dcreate2(read_raw_group_id, "Signal", H5T_NATIVE_FLOAT, signal_space_id,
-                                        H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  fast5_writer_t *writer = calloc(1, sizeof(fast5_writer_t));
+  if (!writer) return NULL;
 
-    if (H5Dwrite(signal_dataset_id, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT,
-                 signal_data) < 0) {
-      errx(EXIT_FAILURE, "Failed to write signal data for read %s", read_names[read_idx]);
+  writer->base_filename = strdup(filename);
+  writer->sample_rate_khz = sample_rate_khz;
+  writer->reads_per_file = reads_per_file;
+  writer->file_id = -1;
+  if (options) {
+    writer->options = *options;
+  } else {
+    fast5_write_options_init(&writer->options);
+  }
+
+  if (!writer->base_filename || !init_write_context(&writer->ctx, NULL, 0, &writer->options, &writer->stats)) {
+    free(writer->base_filename);
+    free(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+// Close the current multi-read file (if any)
+static void writer_close_file(fast5_writer_t *writer) {
+  if (writer->file_id >= 0) {
+    uint64_t profile_start = SEQ_PROFILE_START();
+    H5Fclose(writer->file_id);
+    SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+    writer->file_id = -1;
+    add_file_bytes(&writer->stats, writer->current_filename);
+  }
+}
+
+// Open the next multi-read file; with rollover the first file is renamed to _0 once a second is needed
+static int writer_open_next_file(fast5_writer_t *writer) {
+  writer_close_file(writer);
+
+  if (writer->file_index == 0) {
+    snprintf(writer->current_filename, sizeof(writer->current_filename), "%s", writer->base_filename);
+  } else {
+    if (writer->file_index == 1) {
+      char first_filename[PATH_MAX];
+      numbered_filename(writer->base_filename, 0, first_filename, sizeof(first_filename));
+      if (rename(writer->base_filename, first_filename) != 0) {
+        warnx("Failed to rename %s to %s", writer->base_filename, first_filename);
+      }
     }
+    numbered_filename(writer->base_filename, writer->file_index, writer->current_filename,
+                      sizeof(writer->current_filename));
+  }
 
-    // Add read attributes to the Raw subgroup (not the read group)
-    uint32_t duration = (uint32_t)signal_length;
-    hid_t duration_space_id = H5Screate(H5S_SCALAR);
-    hid_t duration_attr_id = H5Acreate2(read_raw_group_id, "duration", H5T_NATIVE_UINT32, duration_space_id,
-                                       H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(duration_attr_id, H5T_NATIVE_UINT32, &duration);
-
-    hid_t str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(str_type, strlen(read_names[read_idx]) + 1);
-    hid_t read_id_space_id = H5Screate(H5S_SCALAR);
-    hid_t read_id_attr_id = H5Acreate2(read_raw_group_id, "read_id", str_type, read_id_space_id,
-                                      H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(read_id_attr_id, str_type, read_names[read_idx]);
-
-    uint32_t read_number = read_idx;
-    hid_t read_number_space_id = H5Screate(H5S_SCALAR);
-    hid_t read_number_attr_id = H5Acreate2(read_raw_group_id, "read_number", H5T_NATIVE_UINT32, read_number_space_id,
-                                          H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(read_number_attr_id, H5T_NATIVE_UINT32, &read_number);
-
-    int32_t start_mux = 2;
-    hid_t start_mux_space_id = H5Screate(H5S_SCALAR);
-    hid_t start_mux_attr_id = H5Acreate2(read_raw_group_id, "start_mux", H5T_NATIVE_INT32, start_mux_space_id,
-                                        H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(start_mux_attr_id, H5T_NATIVE_INT32, &start_mux);
-
-    uint64_t start_time = 0;
-    hid_t start_time_space_id = H5Screate(H5S_SCALAR);
-    hid_t start_time_attr_id = H5Acreate2(read_raw_group_id, "start_time", H5T_NATIVE_UINT64, start_time_space_id,
-                                         H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(start_time_attr_id, H5T_NATIVE_UINT64, &start_time);
+  writer->file_id = create_multi_read_file(&writer->ctx, writer->current_filename);
+  if (writer->file_id < 0) return -1;
+  writer->file_index++;
+  writer->reads_in_file = 0;
+  return 0;
+}
 
-    // Add run_id attribute directly to the read group
-    hid_t read_run_id_str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(read_run_id_str_type, 40);
-    hid_t read_run_id_space_id = H5Screate(H5S_SCALAR);
-    hid_t read_run_id_attr_id = H5Acreate2(read_group_id, "run_id", read_run_id_str_type, read_run_id_space_id,
-                                          H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(read_run_id_attr_id, read_run_id_str_type, "sequelizer_synthetic_run_001");
-
-    // Create channel_id group under this read
-    hid_t channel_group_id = H5Gcreate2(read_group_id, "channel_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    hid_t channel_str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(channel_str_type, 2);
-    hid_t channel_number_space_id = H5Screate(H5S_SCALAR);
-    hid_t channel_number_attr_id = H5Acreate2(channel_group_id, "channel_number", channel_str_type, channel_number_space_id,
-                                             H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(channel_number_attr_id, channel_str_type, "1");
-
-    double digitisation = 8192.0;
-    hid_t digitisation_space_id = H5Screate(H5S_SCALAR);
-    hid_t digitisation_attr_id = H5Acreate2(channel_group_id, "digitisation", H5T_NATIVE_DOUBLE, digitisation_space_id,
-                                           H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(digitisation_attr_id, H5T_NATIVE_DOUBLE, &digitisation);
-
-    double offset = 0.0;
-    hid_t offset_space_id = H5Screate(H5S_SCALAR);
-    hid_t offset_attr_id = H5Acreate2(channel_group_id, "offset", H5T_NATIVE_DOUBLE, offset_space_id,
-                                     H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(offset_attr_id, H5T_NATIVE_DOUBLE, &offset);
-
-    double range = 1517.25;
-    hid_t range_space_id = H5Screate(H5S_SCALAR);
-    hid_t range_attr_id = H5Acreate2(channel_group_id, "range", H5T_NATIVE_DOUBLE, range_space_id,
-                                    H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(range_attr_id, H5T_NATIVE_DOUBLE, &range);
-
-    double sampling_rate = sample_rate_khz * 1000.0;
-    hid_t sampling_rate_space_id = H5Screate(H5S_SCALAR);
-    hid_t sampling_rate_attr_id = H5Acreate2(channel_group_id, "sampling_rate", H5T_NATIVE_DOUBLE, sampling_rate_space_id,
-                                            H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(sampling_rate_attr_id, H5T_NATIVE_DOUBLE, &sampling_rate);
-
-    // Create context_tags group under this read
-    hid_t context_group_id = H5Gcreate2(read_group_id, "context_tags", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    hid_t context_str_type = H5Tcopy(H5T_C_S1);
-    const char* basename = strrchr(filename, '/') ? strrchr(filename, '/') + 1 : filename;
-    H5Tset_size(context_str_type, strlen(basename) + 1);
-    hid_t filename_space_id = H5Screate(H5S_SCALAR);
-    hid_t filename_attr_id = H5Acreate2(context_group_id, "filename", context_str_type, filename_space_id,
-                                       H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(filename_attr_id, context_str_type, basename);
-
-    // Create tracking_id group under this read
-    hid_t tracking_group_id = H5Gcreate2(read_group_id, "tracking_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    hid_t tracking_str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(tracking_str_type, 20);
-    hid_t exp_start_time_space_id = H5Screate(H5S_SCALAR);
-    hid_t exp_start_time_attr_id = H5Acreate2(tracking_group_id, "exp_start_time", tracking_str_type, exp_start_time_space_id,
-                                             H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(exp_start_time_attr_id, tracking_str_type, "2025-01-01T00:00:00");
-
-    // Add required run_id attribute
-    hid_t run_id_str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(run_id_str_type, 40);
-    hid_t run_id_space_id = H5Screate(H5S_SCALAR);
-    hid_t run_id_attr_id = H5Acreate2(tracking_group_id, "run_id", run_id_str_type, run_id_space_id,
-                                     H5P_DEFAULT, H5P_DEFAULT);
-    H5Awrite(run_id_attr_id, run_id_str_type, "sequelizer_synthetic_run_001");
-
-    // Add flow_cell_id (variable length string)
-    hid_t flowcell_id_str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(flowcell_id_str_type, H5T_VARIABLE);
-    H5Tset_cset(flowcell_id_str_type, H5T_CSET_ASCII);
-    H5Tset_strpad(flowcell_id_str_type, H5T_STR_NULLTERM);
-    hid_t flowcell_id_space_id = H5Screate(H5S_SCALAR);
-    hid_t flowcell_id_attr_id = H5Acreate2(tracking_group_id, "flow_cell_id", flowcell_id_str_type, flowcell_id_space_id, H5P_DEFAULT, H5P_DEFAULT);
-    const char* flowcell_value = "FAKE_FC_001";
-    H5Awrite(flowcell_id_attr_id, flowcell_id_str_type, &flowcell_value);
-
-    // Add device_id (variable length string)
-    hid_t device_id_str_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(device_id_str_type, H5T_VARIABLE);
-    H5Tset_cset(device_id_str_type, H5T_CSET_ASCII);
-    H5Tset_strpad(device_id_str_type, H5T_STR_NULLTERM);
-    hid_t device_id_space_id = H5Screate(H5S_SCALAR);
-    hid_t device_id_attr_id = H5Acreate2(tracking_group_id, "device_id", device_id_str_type, device_id_space_id, H5P_DEFAULT, H5P_DEFAULT);
-    const char* device_value = "SM001";
-    H5Awrite(device_id_attr_id, device_id_str_type, &device_value);
-
-    // Clean up all resources for this read
-    H5Aclose(device_id_attr_id);
-    H5Sclose(device_id_space_id);
-    H5Tclose(device_id_str_type);
-    H5Aclose(flowcell_id_attr_id);
-    H5Sclose(flowcell_id_space_id);
-    H5Tclose(flowcell_id_str_type);
-    H5Aclose(run_id_attr_id);
-    H5Sclose(run_id_space_id);
-    H5Tclose(run_id_str_type);
-    H5Aclose(exp_start_time_attr_id);
-    H5Sclose(exp_start_time_space_id);
-    H5Tclose(tracking_str_type);
-    H5Gclose(tracking_group_id);
-
-    H5Aclose(filename_attr_id);
-    H5Sclose(filename_space_id);
-    H5Tclose(context_str_type);
-    H5Gclose(context_group_id);
-
-    H5Aclose(sampling_rate_attr_id);
-    H5Sclose(sampling_rate_space_id);
-    H5Aclose(range_attr_id);
-    H5Sclose(range_space_id);
-    H5Aclose(offset_attr_id);
-    H5Sclose(offset_space_id);
-    H5Aclose(digitisation_attr_id);
-    H5Sclose(digitisation_space_id);
-    H5Aclose(channel_number_attr_id);
-    H5Sclose(channel_number_space_id);
-    H5Tclose(channel_str_type);
+// Make sure a multi-read file with room for one more read is open
+static int writer_prepare_file(fast5_writer_t *writer) {
+  if (writer->file_id < 0 || (writer->reads_per_file > 0 && writer->reads_in_file >= writer->reads_per_file)) {
+    return writer_open_next_file(writer);
+  }
+  return 0;
+}
+
+static int writer_write_read(fast5_writer_t *writer, const seq_tensor *raw_signal, const char *read_name) {
+  if (writer_prepare_file(writer) < 0) return -1;
+  uint64_t profile_start = SEQ_PROFILE_START();
+  int status = append_multi_read(&writer->ctx, writer->file_id, writer->current_filename, raw_signal, read_name,
+                                 (uint32_t)writer->reads_appended, writer->sample_rate_khz);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+  if (status < 0) return -1;
+  writer->reads_in_file++;
+  writer->reads_appended++;
+  return 0;
+}
+
+// Write the held-back first read, if any, now that the stream is known to be multi-read
+static int writer_flush_pending(fast5_writer_t *writer) {
+  if (!writer->pending_signal) return 0;
+  int status = writer_write_read(writer, writer->pending_signal, writer->pending_name);
+  seq_tensor_free(writer->pending_signal);
+  free(writer->pending_name);
+  writer->pending_signal = NULL;
+  writer->pending_name = NULL;
+  return status;
+}
+
+int fast5_writer_append_read(fast5_writer_t *writer, seq_tensor *raw_signal, const char *read_name) {
+  if (!writer || !raw_signal || !read_name) return -1;
+
+  // First read: hold it (ownership moves to the writer)
+  if (writer->reads_appended == 0 && !writer->pending_signal) {
+    writer->pending_name = strdup(read_name);
+    if (!writer->pending_name) return -1;
+    writer->pending_signal = raw_signal;
+    return 0;
+  }
+
+  // Second read: the stream is multi-read, flush the held read first
+  if (writer_flush_pending(writer) < 0) {
+    seq_tensor_free(raw_signal);
+    return -1;
+  }
+
+  int status = writer_write_read(writer, raw_signal, read_name);
+  seq_tensor_free(raw_signal);
+  return status;
+}
+
+size_t fast5_writer_files_written(const fast5_writer_t *writer) {
+  if (!writer) return 0;
+  return writer->file_index + (writer->pending_signal ? 1 : 0);
+}
+
+const char* fast5_writer_current_filename(const fast5_writer_t *writer) {
+  if (!writer) return NULL;
+  return writer->file_index > 0 ? writer->current_filename : writer->base_filename;
+}
+
+int fast5_writer_close(fast5_writer_t *writer, fast5_write_stats_t *stats) {
+  if (!writer) return -1;
+
+  int status = 0;
+  if (writer->pending_signal) {
+    // Exactly one read in the whole stream: single-read file as before
+    fast5_write_stats_t single_stats;
+    status = seq_write_fast5_single_ex(writer->base_filename, &writer->pending_signal,
+                                       (const char **)&writer->pending_name, 1,
+                                       writer->sample_rate_khz, &writer->options, &single_stats);
+    writer->stats = single_stats;
+    seq_tensor_free(writer->pending_signal);
+    free(writer->pending_name);
+  }
+
+  writer_close_file(writer);
+  if (stats) *stats = writer->stats;
+
+  free_write_context(&writer->ctx);
+  free(writer->base_filename);
+  free(writer);
+  return status;
+}
+
+// **********************************************************************
+// Native Reads (Repack)
+// **********************************************************************
+
+// int16 Signal of a native read: its compressed chunks written directly, or its
+// samples through the context's filters (chunk clamped to the read length)
+static int write_native_signal(fast5_write_context_t *ctx, hid_t group_id, const fast5_native_read_t *read) {
+  size_t signal_length = read->chunks ? read->chunks->length : read->signal_length;
+  if (signal_length == 0 || (!read->chunks && !read->signal)) return -1;
+
+  hid_t dcpl = ctx->signal_dcpl;
+  if (read->chunks) {
+    dcpl = fast5_raw_signal_create_plist(read->chunks);
+    if (dcpl < 0) return -1;
+  } else {
+    hsize_t chunk_dims[1] = {ctx->options->chunk_samples > 0 && ctx->options->chunk_samples < signal_length
+                             ? ctx->options->chunk_samples : signal_length};
+    H5Pset_chunk(ctx->signal_dcpl, 1, chunk_dims);
+  }
+
+  hsize_t signal_dims[1] = {signal_length};
+  hid_t signal_space_id = H5Screate_simple(1, signal_dims, NULL);
+  hid_t signal_dataset_id = H5Dcreate2(group_id, "Signal", H5T_STD_I16LE, signal_space_id,
+                                      H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  if (dcpl != ctx->signal_dcpl) H5Pclose(dcpl);
+
+  int status = 0;
+  if (signal_dataset_id < 0) {
+    status = -1;
+  } else if (read->chunks) {
+    if (!fast5_raw_signal_write(signal_dataset_id, read->chunks)) status = -1;
+  } else {
+    if (H5Dwrite(signal_dataset_id, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, read->signal) < 0) status = -1;
+    SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  }
+  if (status == 0) SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_WRITTEN, signal_length * sizeof(int16_t));
+
+  if (status == 0 && ctx->stats) {
+    ctx->stats->reads_written++;
+    ctx->stats->samples_written += signal_length;
+    ctx->stats->logical_bytes += signal_length * sizeof(int16_t);
+    ctx->stats->stored_bytes += (size_t)H5Dget_storage_size(signal_dataset_id);
+  }
+
+  if (signal_dataset_id >= 0) H5Dclose(signal_dataset_id);
+  H5Sclose(signal_space_id);
+  return status;
+}
+
+// Read attributes as recorded (on /Raw/Reads/Read_N or read_<id>/Raw)
+static void write_native_read_attributes(fast5_write_context_t *ctx, hid_t group_id, const fast5_native_read_t *read) {
+  write_scalar_attr(group_id, "duration", H5T_NATIVE_UINT32, ctx->scalar_space, &read->duration);
+  write_fixed_string_attr(ctx, group_id, "read_id", read->read_id, strlen(read->read_id) + 1);
+  write_scalar_attr(group_id, "read_number", H5T_NATIVE_UINT32, ctx->scalar_space, &read->read_number);
+  write_scalar_attr(group_id, "start_time", H5T_NATIVE_UINT64, ctx->scalar_space, &read->start_time);
+  if (read->has_median_before) {
+    write_scalar_attr(group_id, "median_before", H5T_NATIVE_DOUBLE, ctx->scalar_space, &read->median_before);
+  }
+}
+
+static void write_text_group(fast5_write_context_t *ctx, hid_t parent_id, const char *name,
+                             const char *const *keys, const char *const *values, size_t count) {
+  hid_t group_id = H5Gcreate2(parent_id, name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (group_id < 0) return;
+  for (size_t i = 0; i < count; i++) {
+    write_vlen_string_attr(ctx, group_id, keys[i], values[i]);
+  }
+  H5Gclose(group_id);
+}
+
+// channel_id (the source calibration), context_tags and tracking_id below parent_id
+static void write_native_key_groups(fast5_write_context_t *ctx, hid_t parent_id, const fast5_native_read_t *read) {
+  hid_t channel_group_id = H5Gcreate2(parent_id, "channel_id", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (channel_group_id >= 0) {
+    const char *channel_number = read->channel_number ? read->channel_number : "1";
+    write_fixed_string_attr(ctx, channel_group_id, "channel_number", channel_number, strlen(channel_number) + 1);
+    write_scalar_attr(channel_group_id, "digitisation", H5T_NATIVE_DOUBLE, ctx->scalar_space, &read->digitisation);
+    write_scalar_attr(channel_group_id, "offset", H5T_NATIVE_DOUBLE, ctx->scalar_space, &read->offset);
+    write_scalar_attr(channel_group_id, "range", H5T_NATIVE_DOUBLE, ctx->scalar_space, &read->range);
+    write_scalar_attr(channel_group_id, "sampling_rate", H5T_NATIVE_DOUBLE, ctx->scalar_space, &read->sampling_rate);
     H5Gclose(channel_group_id);
+  }
+  write_text_group(ctx, parent_id, "context_tags", read->context_keys, read->context_values, read->num_context);
+  write_text_group(ctx, parent_id, "tracking_id", read->tracking_keys, read->tracking_values, read->num_tracking);
+}
 
-    H5Aclose(start_time_attr_id);
-    H5Sclose(start_time_space_id);
-    H5Aclose(start_mux_attr_id);
-    H5Sclose(start_mux_space_id);
-    H5Aclose(read_number_attr_id);
-    H5Sclose(read_number_space_id);
-    H5Aclose(read_id_attr_id);
-    H5Sclose(read_id_space_id);
-    H5Tclose(str_type);
-    H5Aclose(duration_attr_id);
-    H5Sclose(duration_space_id);
-    H5Aclose(read_run_id_attr_id);
-    H5Sclose(read_run_id_space_id);
-    H5Tclose(read_run_id_str_type);
-    H5Dclose(signal_dataset_id);
-    H5Sclose(signal_space_id);
-    H5Gclose(read_raw_group_id);
-    H5Gclose(read_group_id);
+// One read_<read_id> group (Raw/Signal plus its attributes and key groups)
+static int append_native_read(fast5_write_context_t *ctx, hid_t file_id, const fast5_native_read_t *read) {
+  char read_group_path[256];
+  snprintf(read_group_path, sizeof(read_group_path), "read_%s", read->read_id);
+  if (H5Lexists(file_id, read_group_path, H5P_DEFAULT) > 0) {
+    warnx("Duplicate read_id %s: already in this file", read->read_id);
+    return -1;
   }
 
-  H5Fclose(file_id);
+  hid_t read_group_id = H5Gcreate2(file_id, read_group_path, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (read_group_id < 0) {
+    warnx("Failed to create read group: %s", read_group_path);
+    return -1;
+  }
+  hid_t read_raw_group_id = H5Gcreate2(read_group_id, "Raw", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  int status = read_raw_group_id >= 0 ? write_native_signal(ctx, read_raw_group_id, read) : -1;
+  if (status < 0) {
+    warnx("Failed to write signal data for read %s", read->read_id);
+  } else {
+    write_native_read_attributes(ctx, read_raw_group_id, read);
+    if (read->run_id) {
+      write_fixed_string_attr(ctx, read_group_id, "run_id", read->run_id, strlen(read->run_id) + 1);
+    }
+    write_native_key_groups(ctx, read_group_id, read);
+  }
+
+  if (read_raw_group_id >= 0) H5Gclose(read_raw_group_id);
+  H5Gclose(read_group_id);
+  return status;
+}
+
+int fast5_writer_append_native(fast5_writer_t *writer, const fast5_native_read_t *read) {
+  if (!writer || !read || !read->read_id) return -1;
+  if (writer_flush_pending(writer) < 0 || writer_prepare_file(writer) < 0) return -1;
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  int status = append_native_read(&writer->ctx, writer->file_id, read);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+  if (status < 0) return -1;
+  writer->reads_in_file++;
+  writer->reads_appended++;
   return 0;
 }
+
+int seq_write_fast5_single_native(const char *filename, const fast5_native_read_t *read,
+                                  const fast5_write_options_t *options, fast5_write_stats_t *stats) {
+  if (!filename || !read || !read->read_id || !options) {
+    warnx("Invalid parameters to seq_write_fast5_single_native");
+    return -1;
+  }
+  if (stats) memset(stats, 0, sizeof(*stats));
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  hid_t fapl = create_write_fapl();
+  hid_t file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_HDF5_CALLS, 1);
+  if (fapl != H5P_DEFAULT) H5Pclose(fapl);
+  if (file_id < 0) {
+    warnx("Failed to create Fast5 file: %s", filename);
+    return -1;
+  }
+
+  fast5_write_context_t ctx;
+  int status = init_write_context(&ctx, NULL, 0, options, stats) ? 0 : -1;
+  if (status == 0) {
+    write_file_attributes(&ctx, file_id, "single-read");
+
+    char read_group_path[256];
+    snprintf(read_group_path, sizeof(read_group_path), "/Raw/Reads/Read_%u", read->read_number);
+    hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+    H5Pset_create_intermediate_group(lcpl, 1);
+    hid_t read_group_id = H5Gcreate2(file_id, read_group_path, lcpl, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t ugk_group_id = H5Gcreate2(file_id, "/UniqueGlobalKey", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Pclose(lcpl);
+
+    status = read_group_id >= 0 && ugk_group_id >= 0 ? write_native_signal(&ctx, read_group_id, read) : -1;
+    if (status == 0) {
+      write_native_read_attributes(&ctx, read_group_id, read);
+      write_native_key_groups(&ctx, ugk_group_id, read);
+    } else {
+      warnx("Failed to write signal data for read %s", read->read_id);
+    }
+    if (ugk_group_id >= 0) H5Gclose(ugk_group_id);
+    if (read_group_id >= 0) H5Gclose(read_group_id);
+  }
+  free_write_context(&ctx);
+
+  H5Fclose(file_id);
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FAST5_WRITE, profile_start);
+  add_file_bytes(stats, filename);
+  return status;
+}
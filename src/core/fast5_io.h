@@ -7,13 +7,16 @@
 #define SEQUELIZER_FAST5_IO_H
 
 #include <hdf5.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "fast5_chunks.h"
 #include "fast5_utils.h"
 #include "seq_tensor.h"
 
-// Fast5 file discovery functions
+// Fast5 file discovery functions. The finders return NULL (after a warning) when the
+// path is unusable or memory runs out, and an empty list when nothing matched
 bool   is_fast5_file(const char *filename);
 char** find_fast5_files_recursive(const char *directory, size_t *count);
 char** find_fast5_files(const char *input_path, bool recursive, size_t *count);
@@ -25,25 +28,153 @@ bool is_likely_fast5_file(const char *filename);
 bool is_valid_hdf5_file(const char *filename);
 bool has_fast5_structure(const char *filename);
 
+// HDF5 superblock signature check (8 bytes, no HDF5 calls): a cheap pre-filter
+// before H5Fopen for files that merely carry a .fast5 extension
+bool has_hdf5_signature(const char *filename);
+bool has_hdf5_signature_fd(int fd);
+
+// How Fast5 files are opened for reading. Process-wide: set it once (from the
+// command line) before any file is opened; every read path honours it.
+//   POSIX  default sec2 driver, one small read per HDF5 metadata/data access
+//   CORE   whole file read into memory at open (one large sequential read)
+//   PAGED  page-caching driver: misses load page_size bytes plus prefetch_pages
+//          following pages in one read (remote and FUSE-mounted storage)
+// decode_threads applies whatever the mode: deflate Signals are fetched as raw
+// chunks and inflated outside HDF5 (fast5_chunks.h), a read's chunks split
+// across that many threads
+typedef enum {
+  FAST5_IO_POSIX,
+  FAST5_IO_CORE,
+  FAST5_IO_PAGED
+} fast5_io_mode_t;
+
+#define FAST5_IO_DEFAULT_PAGE_SIZE (256 * 1024)
+#define FAST5_IO_DEFAULT_PREFETCH_PAGES 4
+
+typedef struct {
+  fast5_io_mode_t mode;
+  size_t page_size;          // Paged: bytes per cache page; core: allocation increment (0 = default)
+  size_t prefetch_pages;     // Paged: pages read ahead on each cache miss
+  int decode_threads;        // Threads inflating one read's Signal chunks (0 or 1 = the reading thread)
+} fast5_io_options_t;
+
+bool fast5_parse_io_mode(const char *name, fast5_io_mode_t *mode);
+void fast5_set_io_options(const fast5_io_options_t *options);
+
 // Fast5 file reading functions
-typedef void (*metadata_enhancer_t)(hid_t file_id, hid_t signal_dataset, fast5_metadata_t *metadata);
+// Enhancers see the groups of the read being visited already open: each group is
+// opened once per read (once per file for the /UniqueGlobalKey groups of single-read
+// files) and shared by every enhancer, inside the reader's HDF5 error suppression.
+// Groups a file lacks are -1; handles are only valid during the enhancer call
+typedef struct fast5_attribute_cache fast5_attribute_cache_t;
+typedef struct {
+  hid_t file_id;
+  hid_t read_group_id;       // "/read_<id>" (multi-read) or "/Raw/Reads/Read_N" (single-read)
+  hid_t raw_group_id;        // Group holding Signal, median_before and start_time
+  hid_t signal_dataset_id;
+  hid_t channel_group_id;    // Read's channel_id (multi-read) or /UniqueGlobalKey/channel_id
+  hid_t tracking_group_id;   // Read's tracking_id (multi-read) or /UniqueGlobalKey/tracking_id
+  bool is_multi_read;
+  fast5_attribute_cache_t *cache;   // Attribute values already read from shared groups (reader-owned)
+} fast5_read_handles_t;
+typedef void (*metadata_enhancer_t)(const fast5_read_handles_t *read, fast5_metadata_t *metadata);
 fast5_metadata_t* read_fast5_metadata_with_enhancer(const char *filename, size_t *metadata_count, metadata_enhancer_t enhancer);
 void free_fast5_metadata(fast5_metadata_t *metadata, size_t count);
+void clear_fast5_metadata(fast5_metadata_t *metadata);
+
+// Single-open reader: the file is opened once, read groups are enumerated once, and
+// fast5_reader_next() walks them in order, optionally loading each signal (native int16
+// ADC samples) into a reusable buffer owned by the reader (valid until the next call or close)
+typedef struct fast5_reader fast5_reader_t;
+fast5_reader_t* fast5_reader_open(const char *filename, metadata_enhancer_t enhancer);
+void         fast5_reader_close(fast5_reader_t *reader);
+size_t       fast5_reader_num_reads(const fast5_reader_t *reader);
+bool         fast5_reader_is_multi_read(const fast5_reader_t *reader);
+hid_t        fast5_reader_file_id(const fast5_reader_t *reader);
+void         fast5_reader_rewind(fast5_reader_t *reader);
+int          fast5_reader_next(fast5_reader_t *reader, fast5_metadata_t *metadata, bool load_signal); // 1 = read, 0 = done, -1 = error
+const int16_t* fast5_reader_signal(const fast5_reader_t *reader, size_t *signal_length);
+
+// Deferred decoding, for callers serialising HDF5 behind their own lock: fast5_reader_next()
+// then only fetches a deflate Signal's compressed chunks, and fast5_reader_decode_signal()
+// (no HDF5 calls; run it after dropping the lock) inflates them before fast5_reader_signal().
+// Signals in other pipelines are read whole by fast5_reader_next() as before, and decoding
+// them is a no-op. False if the chunks would not decode
+void         fast5_reader_defer_decode(fast5_reader_t *reader, bool defer);
+bool         fast5_reader_decode_signal(fast5_reader_t *reader);
+
+// Deferred mode, instead of decoding: swap the fetched chunks with *chunks (whose buffers
+// the reader reuses) to carry them elsewhere still compressed. False if fast5_reader_next()
+// fetched none, in which case the samples are at fast5_reader_signal()
+bool         fast5_reader_take_chunks(fast5_reader_t *reader, fast5_raw_signal_t *chunks);
+
+// HDF5 group path and Signal dataset file offset of the read last returned by
+// fast5_reader_next() (offset is FAST5_OFFSET_UNDEFINED for chunked/compressed data)
+#define FAST5_OFFSET_UNDEFINED UINT64_MAX
+const char*  fast5_reader_location(const fast5_reader_t *reader, uint64_t *dataset_offset);
+
+// Read a Signal dataset by its HDF5 group path (as reported by fast5_reader_location)
+float* read_fast5_signal_at(const char *filename, const char *group_path, size_t *signal_length);
+
+// Thread-safe wrapper: serialises the HDF5 calls behind hdf5_mutex when the linked
+// HDF5 build is not thread-safe (pass NULL to skip locking entirely)
+fast5_metadata_t* read_fast5_metadata_thread_safe(const char *filename, size_t *metadata_count,
+                                                  metadata_enhancer_t enhancer, pthread_mutex_t *hdf5_mutex);
+bool   fast5_hdf5_is_threadsafe(void);
+
+// Silence HDF5's automatic error printing on the calling thread until the matching
+// end; scopes nest, and only the outermost saves and restores the handler
+void   fast5_hdf5_quiet_begin(void);
+void   fast5_hdf5_quiet_end(void);
+
+// Scalar attribute of an HDF5 object as text (strings, integers, floats); caller frees, NULL if absent
+char*  fast5_attribute_text(hid_t obj_id, const char *attr_name);
 
 // Enhancer functions
-void extract_tracking_id(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata);
-void extract_channel_id(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata);
-void extract_calibration_parameters(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata);
-void extract_raw(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata);
+void extract_tracking_id(const fast5_read_handles_t *read, fast5_metadata_t *metadata);
+void extract_channel_id(const fast5_read_handles_t *read, fast5_metadata_t *metadata);
+void extract_calibration_parameters(const fast5_read_handles_t *read, fast5_metadata_t *metadata);
+void extract_raw(const fast5_read_handles_t *read, fast5_metadata_t *metadata);
 
 // Signal extraction functions
 float* read_fast5_signal(const char *filename, const char *read_id, size_t *signal_length);
 void   free_fast5_signal(float *signal);
 
+// Native int16 signal extraction: samples are read without float conversion and returned
+// as an int16 [n_samples × 1] seq_tensor whose scale/zero_point carry the channel
+// calibration (pA = scale * (raw - zero_point)); convert lazily with seq_tensor_dequantize()
+seq_tensor* read_fast5_signal_raw(const char *filename, const char *read_id);
+seq_tensor* read_fast5_signal_raw_at(const char *filename, const char *group_path);
+
+// Samples [start, start + count) only (clipped to the read; NULL if the window is empty),
+// read through an HDF5 hyperslab so zooming into a long read never loads all of it
+seq_tensor* read_fast5_signal_raw_window_at(const char *filename, const char *group_path, size_t start, size_t count);
+
 // **********************************************************************
 // Fast5 File Writing Functions
 // **********************************************************************
 
+// Signal storage options for the _ex writers (fast5_write_options_init gives the
+// defaults used by the plain writers: int16 quantised, 16384-sample chunks,
+// shuffle + deflate level 1)
+typedef struct {
+  bool quantise_int16;     // Store Signal as int16 ADC samples with per-file calibration (else float32)
+  int compression_level;   // Deflate level 0-9 (0 = uncompressed)
+  bool shuffle;            // Byte-shuffle filter ahead of deflate
+  size_t chunk_samples;    // Signal chunk length (clamped to each read's length)
+} fast5_write_options_t;
+
+// Optional write statistics filled by the _ex writers
+typedef struct {
+  size_t reads_written;
+  size_t samples_written;
+  size_t logical_bytes;    // Uncompressed Signal bytes in the stored dtype
+  size_t stored_bytes;     // Signal bytes on disk after filters
+  size_t file_bytes;       // Total size of the output file(s)
+} fast5_write_stats_t;
+
+void fast5_write_options_init(fast5_write_options_t *options);
+
 // Write a single-read Fast5 file
 // Parameters:
 //   filename: Output Fast5 filename
@@ -62,4 +193,79 @@ int seq_write_fast5_multi(const char* filename, seq_tensor** raw_signals,
                           const char** read_names, int num_reads,
                           float sample_rate_khz);
 
+// Variants taking explicit storage options and returning write statistics (stats may be NULL)
+int seq_write_fast5_single_ex(const char* filename, seq_tensor** raw_signals,
+                              const char** read_names, int num_reads,
+                              float sample_rate_khz, const fast5_write_options_t *options,
+                              fast5_write_stats_t *stats);
+int seq_write_fast5_multi_ex(const char* filename, seq_tensor** raw_signals,
+                             const char** read_names, int num_reads,
+                             float sample_rate_khz, const fast5_write_options_t *options,
+                             fast5_write_stats_t *stats);
+
+// **********************************************************************
+// Streaming Fast5 Writer
+// **********************************************************************
+
+// Incremental multi-read writer: reads are written as they are appended, so peak
+// memory is one read regardless of run size. With reads_per_file > 0 output rolls
+// over every reads_per_file reads (4000 matches real runs): a run that fits in one
+// file keeps the given name, otherwise files are numbered out_0.fast5, out_1.fast5...
+// A stream of exactly one read is written as a single-read file.
+typedef struct fast5_writer fast5_writer_t;
+
+// options may be NULL for defaults; returns NULL on failure
+fast5_writer_t* fast5_writer_open(const char *filename, float sample_rate_khz,
+                                  const fast5_write_options_t *options, size_t reads_per_file);
+
+// Takes ownership of raw_signal (freed once written); returns 0 on success, -1 on failure
+int fast5_writer_append_read(fast5_writer_t *writer, seq_tensor *raw_signal, const char *read_name);
+
+// Number of output files (so far) and the file currently being written
+size_t      fast5_writer_files_written(const fast5_writer_t *writer);
+const char* fast5_writer_current_filename(const fast5_writer_t *writer);
+
+// Flush, close and free the writer; stats (may be NULL) receives totals for the run
+int fast5_writer_close(fast5_writer_t *writer, fast5_write_stats_t *stats);
+
+// **********************************************************************
+// Native Reads (Repack)
+// **********************************************************************
+
+// A read carried over from another Fast5 file: int16 ADC samples as recorded, with
+// the source's calibration and attributes, written in the seq_write_fast5_* layouts.
+// A Signal already compressed (by fast5_raw_signal_encode, or fetched from the source)
+// is written chunk by chunk as it is; bare samples go through the writer's filters
+typedef struct {
+  const char *read_id;
+  const char *run_id;              // Read group attribute (multi-read; NULL to omit)
+  const char *channel_number;
+  double digitisation;
+  double offset;
+  double range;
+  double sampling_rate;            // Hz
+  uint32_t read_number;
+  uint32_t duration;
+  uint64_t start_time;
+  bool has_median_before;
+  double median_before;
+  const char *const *tracking_keys;   // tracking_id attributes (written as strings)
+  const char *const *tracking_values;
+  size_t num_tracking;
+  const char *const *context_keys;    // context_tags attributes
+  const char *const *context_values;
+  size_t num_context;
+  const fast5_raw_signal_t *chunks;   // Compressed Signal, or NULL for signal/signal_length
+  const int16_t *signal;
+  size_t signal_length;
+} fast5_native_read_t;
+
+// Append to the writer's current multi-read file (rolling over as usual; native reads are
+// never held back for the single-read case). 0 on success, -1 on failure
+int fast5_writer_append_native(fast5_writer_t *writer, const fast5_native_read_t *read);
+
+// One single-read file holding read; options give the filters for bare samples
+int seq_write_fast5_single_native(const char *filename, const fast5_native_read_t *read,
+                                  const fast5_write_options_t *options, fast5_write_stats_t *stats);
+
 #endif // SEQUELIZER_FAST5_IO_H
\ No newline at end of file
@@ -0,0 +1,292 @@
+// **********************************************************************
+// core/fast5_paged_vfd.c - Read-Only Page-Caching HDF5 File Driver
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "fast5_paged_vfd.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Driver settings carried on the file access property list
+typedef struct {
+  size_t page_size;
+  size_t cache_pages;
+  size_t prefetch_pages;
+} paged_config_t;
+
+// Per-file state; pub must come first (HDF5 hands us H5FD_t pointers)
+typedef struct {
+  H5FD_t pub;
+  int fd;
+  dev_t device;
+  ino_t inode;
+  haddr_t eoa;
+  haddr_t eof;
+  paged_config_t config;
+
+  // Direct-mapped cache: page p lives in slot p % cache_pages, so a run of
+  // consecutive pages fills consecutive slots and one preadv can load them
+  uint8_t *pages;
+  haddr_t *slot_page;          // Page held by each slot (HADDR_UNDEF = empty)
+  struct iovec *iov;           // Scratch for one run (1 + prefetch_pages entries)
+} paged_file_t;
+
+// **********************************************************************
+// Page Cache
+// **********************************************************************
+static uint8_t* slot_data(paged_file_t *file, size_t slot) {
+  return file->pages + slot * file->config.page_size;
+}
+
+// Load page (and up to prefetch_pages following pages not yet cached) with one preadv
+static bool fill_pages(paged_file_t *file, haddr_t page) {
+  size_t page_size = file->config.page_size;
+  haddr_t last_page = file->eof ? (file->eof - 1) / page_size : 0;
+
+  size_t run = 0;
+  size_t max_run = file->config.prefetch_pages + 1;
+  if (max_run > file->config.cache_pages) max_run = file->config.cache_pages;
+  while (run < max_run && page + run <= last_page) {
+    size_t slot = (size_t)((page + run) % file->config.cache_pages);
+    if (run > 0 && file->slot_page[slot] == page + run) break;   // Already cached: stop the run
+    file->iov[run].iov_base = slot_data(file, slot);
+    file->iov[run].iov_len = page_size;
+    run++;
+  }
+  if (run == 0) return false;
+
+  // Mark the slots empty until the read has landed
+  for (size_t i = 0; i < run; i++) {
+    file->slot_page[(page + i) % file->config.cache_pages] = HADDR_UNDEF;
+  }
+
+  size_t wanted = run * page_size;
+  size_t got = 0;
+  off_t offset = (off_t)(page * page_size);
+  while (got < wanted) {
+    // Skip the iovecs already satisfied by a short read
+    size_t skip = got / page_size;
+    size_t partial = got % page_size;
+    struct iovec first = file->iov[skip];
+    file->iov[skip].iov_base = (uint8_t*)first.iov_base + partial;
+    file->iov[skip].iov_len = first.iov_len - partial;
+    ssize_t n = preadv(file->fd, &file->iov[skip], (int)(run - skip), offset + (off_t)got);
+    file->iov[skip] = first;
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (n == 0) break;   // End of file: the remainder reads as zeros, as with sec2
+    got += (size_t)n;
+  }
+  if (got < wanted) {
+    for (size_t i = got / page_size; i < run; i++) {
+      size_t from = i == got / page_size ? got % page_size : 0;
+      memset((uint8_t*)file->iov[i].iov_base + from, 0, page_size - from);
+    }
+  }
+
+  for (size_t i = 0; i < run; i++) {
+    file->slot_page[(page + i) % file->config.cache_pages] = page + i;
+  }
+  return true;
+}
+
+// **********************************************************************
+// Driver Callbacks
+// **********************************************************************
+static hid_t paged_driver_id = -1;
+
+static H5FD_t* paged_open(const char *name, unsigned flags, hid_t fapl, haddr_t maxaddr) {
+  (void)maxaddr;
+  if (flags & (H5F_ACC_RDWR | H5F_ACC_TRUNC | H5F_ACC_CREAT)) return NULL;   // Read-only driver
+
+  const paged_config_t *config = H5Pget_driver_info(fapl);
+  if (!config || config->page_size == 0 || config->cache_pages == 0) return NULL;
+
+  int fd = open(name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return NULL;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  paged_file_t *file = calloc(1, sizeof(paged_file_t));
+  if (!file) {
+    close(fd);
+    return NULL;
+  }
+  file->fd = fd;
+  file->device = file_stat.st_dev;
+  file->inode = file_stat.st_ino;
+  file->eof = (haddr_t)file_stat.st_size;
+  file->config = *config;
+  file->pages = malloc(config->cache_pages * config->page_size);
+  file->slot_page = malloc(config->cache_pages * sizeof(haddr_t));
+  file->iov = malloc((config->prefetch_pages + 1) * sizeof(struct iovec));
+  if (!file->pages || !file->slot_page || !file->iov) {
+    free(file->pages);
+    free(file->slot_page);
+    free(file->iov);
+    free(file);
+    close(fd);
+    return NULL;
+  }
+  for (size_t i = 0; i < config->cache_pages; i++) {
+    file->slot_page[i] = HADDR_UNDEF;
+  }
+  return &file->pub;
+}
+
+static herr_t paged_close(H5FD_t *_file) {
+  paged_file_t *file = (paged_file_t*)_file;
+  int status = close(file->fd);
+  free(file->pages);
+  free(file->slot_page);
+  free(file->iov);
+  free(file);
+  return status == 0 ? 0 : -1;
+}
+
+static int paged_cmp(const H5FD_t *_a, const H5FD_t *_b) {
+  const paged_file_t *a = (const paged_file_t*)_a;
+  const paged_file_t *b = (const paged_file_t*)_b;
+  if (a->device != b->device) return a->device < b->device ? -1 : 1;
+  if (a->inode != b->inode) return a->inode < b->inode ? -1 : 1;
+  return 0;
+}
+
+static herr_t paged_query(const H5FD_t *file, unsigned long *flags) {
+  (void)file;
+  // Same metadata/raw-data handling as the default sec2 driver
+  *flags = H5FD_FEAT_AGGREGATE_METADATA | H5FD_FEAT_ACCUMULATE_METADATA |
+           H5FD_FEAT_DATA_SIEVE | H5FD_FEAT_AGGREGATE_SMALLDATA;
+  return 0;
+}
+
+static haddr_t paged_get_eoa(const H5FD_t *file, H5FD_mem_t type) {
+  (void)type;
+  return ((const paged_file_t*)file)->eoa;
+}
+
+static herr_t paged_set_eoa(H5FD_t *file, H5FD_mem_t type, haddr_t addr) {
+  (void)type;
+  ((paged_file_t*)file)->eoa = addr;
+  return 0;
+}
+
+static haddr_t paged_get_eof(const H5FD_t *file, H5FD_mem_t type) {
+  (void)type;
+  return ((const paged_file_t*)file)->eof;
+}
+
+static herr_t paged_read(H5FD_t *_file, H5FD_mem_t type, hid_t dxpl, haddr_t addr, size_t size, void *buffer) {
+  (void)type;
+  (void)dxpl;
+  paged_file_t *file = (paged_file_t*)_file;
+  size_t page_size = file->config.page_size;
+  uint8_t *out = buffer;
+
+  // Bytes past the end of the file read as zeros
+  if (addr >= file->eof) {
+    memset(out, 0, size);
+    return 0;
+  }
+  if (addr + size > file->eof) {
+    size_t tail = (size_t)(addr + size - file->eof);
+    memset(out + size - tail, 0, tail);
+    size -= tail;
+  }
+
+  while (size > 0) {
+    haddr_t page = addr / page_size;
+    size_t within = (size_t)(addr % page_size);
+
+    // Whole pages beyond what the cache holds (bulk Signal reads) go straight through
+    if (within == 0 && size >= page_size * file->config.cache_pages) {
+      size_t direct = size - size % page_size;
+      size_t got = 0;
+      while (got < direct) {
+        ssize_t n = pread(file->fd, out + got, direct - got, (off_t)(addr + got));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        got += (size_t)n;
+      }
+      addr += direct;
+      out += direct;
+      size -= direct;
+      continue;
+    }
+
+    size_t slot = (size_t)(page % file->config.cache_pages);
+    if (file->slot_page[slot] != page && !fill_pages(file, page)) return -1;
+
+    size_t chunk = page_size - within;
+    if (chunk > size) chunk = size;
+    memcpy(out, slot_data(file, slot) + within, chunk);
+    addr += chunk;
+    out += chunk;
+    size -= chunk;
+  }
+  return 0;
+}
+
+static herr_t paged_write(H5FD_t *file, H5FD_mem_t type, hid_t dxpl, haddr_t addr, size_t size, const void *buffer) {
+  (void)file;
+  (void)type;
+  (void)dxpl;
+  (void)addr;
+  (void)size;
+  (void)buffer;
+  return -1;   // Read-only driver
+}
+
+static const H5FD_class_t paged_class = {
+#ifdef H5FD_CLASS_VERSION
+  .version = H5FD_CLASS_VERSION,
+  .value = (H5FD_class_value_t)601,
+#endif
+  .name = "sequelizer_paged",
+  .maxaddr = (haddr_t)INT64_MAX,
+  .fc_degree = H5F_CLOSE_WEAK,
+  .fapl_size = sizeof(paged_config_t),
+  .open = paged_open,
+  .close = paged_close,
+  .cmp = paged_cmp,
+  .query = paged_query,
+  .get_eoa = paged_get_eoa,
+  .set_eoa = paged_set_eoa,
+  .get_eof = paged_get_eof,
+  .read = paged_read,
+  .write = paged_write,
+  .fl_map = H5FD_FLMAP_DICHOTOMY
+};
+
+// **********************************************************************
+// Public API
+// **********************************************************************
+static pthread_mutex_t paged_register_lock = PTHREAD_MUTEX_INITIALIZER;
+
+herr_t fast5_paged_vfd_set_fapl(hid_t fapl, size_t page_size, size_t cache_pages, size_t prefetch_pages) {
+  if (page_size == 0 || cache_pages == 0) return -1;
+
+  pthread_mutex_lock(&paged_register_lock);
+  if (paged_driver_id < 0 || H5Iis_valid(paged_driver_id) <= 0) {
+    paged_driver_id = H5FDregister(&paged_class);
+  }
+  hid_t driver_id = paged_driver_id;
+  pthread_mutex_unlock(&paged_register_lock);
+  if (driver_id < 0) return -1;
+
+  paged_config_t config = {page_size, cache_pages, prefetch_pages};
+  return H5Pset_driver(fapl, driver_id, &config);
+}
@@ -0,0 +1,23 @@
+// **********************************************************************
+// core/fast5_paged_vfd.h - Read-Only Page-Caching HDF5 File Driver
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// A virtual file driver for reading Fast5 files from remote or FUSE-mounted
+// storage, where every pread is a network round trip. HDF5's own page buffer
+// only works on files written with paged aggregation, which nanopore files
+// never are; this driver instead serves every HDF5 request from a per-file
+// cache of fixed-size pages, filling misses with one preadv of the missing
+// page plus the next prefetch_pages pages. The many small metadata reads of
+// a Fast5 scan become a handful of large sequential ones.
+#ifndef SEQUELIZER_FAST5_PAGED_VFD_H
+#define SEQUELIZER_FAST5_PAGED_VFD_H
+
+#include <hdf5.h>
+#include <stddef.h>
+
+// Select the driver on a file access property list (read-only opens only);
+// cache_pages pages of page_size bytes are held per open file. 0 or -1
+herr_t fast5_paged_vfd_set_fapl(hid_t fapl, size_t page_size, size_t cache_pages, size_t prefetch_pages);
+
+#endif // SEQUELIZER_FAST5_PAGED_VFD_H
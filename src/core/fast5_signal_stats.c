@@ -0,0 +1,265 @@
+// **********************************************************************
+// core/fast5_signal_stats.c - One-Pass Signal QC for Fast5 Reads
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "fast5_signal_stats.h"
+#include "seq_kernels.h"
+#include <err.h>
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Samples per block: the summary kernel, histogram and t-test each walk a
+// block while it is still in L1
+#define SCAN_BLOCK 4096
+#define HISTOGRAM_BINS 65536
+
+// Added to the t-test's pooled variance (ADC codes squared) so flat,
+// quantised stretches do not divide by zero
+#define EVENT_VARIANCE_FLOOR 1e-2
+
+struct fast5_signal_scan {
+  uint32_t *histogram;     // Samples per ADC code, bin = code ^ 0x8000; all zero between reads
+  double *sum;             // Prefix sums of one block's samples (plus a window either side)
+  double *sum_sq;          // ... and of their squares
+  double *t2;              // Squared t statistic at each boundary in the block
+};
+
+// Most recent local maximum of t not yet a window behind the scan
+typedef struct {
+  bool armed;
+  double value;
+  size_t position;
+  uint32_t peaks;
+} peak_tracker_t;
+
+fast5_signal_scan_t* fast5_signal_scan_create(void) {
+  fast5_signal_scan_t *scan = calloc(1, sizeof(fast5_signal_scan_t));
+  if (!scan) return NULL;
+  size_t span = SCAN_BLOCK + 2 * FAST5_EVENT_WINDOW;
+  scan->histogram = calloc(HISTOGRAM_BINS, sizeof(uint32_t));
+  scan->sum = malloc(span * sizeof(double));
+  scan->sum_sq = malloc(span * sizeof(double));
+  scan->t2 = malloc(SCAN_BLOCK * sizeof(double));
+  if (!scan->histogram || !scan->sum || !scan->sum_sq || !scan->t2) {
+    fast5_signal_scan_free(scan);
+    return NULL;
+  }
+  return scan;
+}
+
+void fast5_signal_scan_free(fast5_signal_scan_t *scan) {
+  if (!scan) return;
+  free(scan->histogram);
+  free(scan->sum);
+  free(scan->sum_sq);
+  free(scan->t2);
+  free(scan);
+}
+
+static inline size_t histogram_bin(int32_t code) {
+  return (uint16_t)code ^ 0x8000u;
+}
+
+// t-test over the boundaries of [start, start + count) that have a full window
+// on both sides. Squaring t keeps sqrt out of the loop (peaks are unchanged)
+static void detect_events(fast5_signal_scan_t *scan, const int16_t *signal, size_t length,
+                          size_t start, size_t count, peak_tracker_t *tracker) {
+  const size_t w = FAST5_EVENT_WINDOW;
+  if (length < 2 * w) return;
+  size_t first = start > w ? start : w;
+  size_t last = start + count < length - w + 1 ? start + count : length - w + 1;
+  if (first >= last) return;
+  size_t boundaries = last - first;
+
+  // Block-local sums stay exact in double (at most ~2^43)
+  const int16_t *x = signal + first - w;
+  double *restrict sum = scan->sum, *restrict sum_sq = scan->sum_sq, *restrict t2 = scan->t2;
+  sum[0] = sum_sq[0] = 0.0;
+  for (size_t k = 0; k < boundaries + 2 * w - 1; k++) {
+    double v = x[k];
+    sum[k + 1] = sum[k] + v;
+    sum_sq[k + 1] = sum_sq[k] + v * v;
+  }
+
+  const double inv_w = 1.0 / (double)w;
+  const double threshold2 = FAST5_EVENT_THRESHOLD * FAST5_EVENT_THRESHOLD;
+  for (size_t j = 0; j < boundaries; j++) {
+    double m1 = (sum[j + w] - sum[j]) * inv_w;
+    double m2 = (sum[j + 2 * w] - sum[j + w]) * inv_w;
+    double v1 = (sum_sq[j + w] - sum_sq[j]) * inv_w - m1 * m1;
+    double v2 = (sum_sq[j + 2 * w] - sum_sq[j + w]) * inv_w - m2 * m2;
+    double d = m2 - m1;
+    t2[j] = d * d / ((v1 + v2) * inv_w + EVENT_VARIANCE_FLOOR);
+  }
+
+  // A peak counts once the scan is a window past it without finding a higher one
+  for (size_t j = 0; j < boundaries; j++) {
+    size_t position = first + j;
+    if (tracker->armed && position - tracker->position >= w) {
+      tracker->peaks++;
+      tracker->armed = false;
+    }
+    if (t2[j] > threshold2 && (!tracker->armed || t2[j] > tracker->value)) {
+      tracker->armed = true;
+      tracker->value = t2[j];
+      tracker->position = position;
+    }
+  }
+}
+
+// Code at 0-based rank k of the histogram over [lo, hi]
+static int32_t histogram_rank(const uint32_t *histogram, int32_t lo, int32_t hi, uint64_t k) {
+  uint64_t seen = 0;
+  for (int32_t code = lo; code < hi; code++) {
+    seen += histogram[histogram_bin(code)];
+    if (seen > k) return code;
+  }
+  return hi;
+}
+
+// Twice the median absolute deviation about median2 / 2: deviations come in
+// increasing order by walking outwards from the median on both sides
+static int64_t histogram_mad2(const uint32_t *histogram, int32_t lo, int32_t hi, int32_t median2, uint64_t n) {
+  uint64_t k1 = (n - 1) / 2, k2 = n / 2, seen = 0;
+  int64_t d1 = 0;
+  int32_t below = median2 >> 1, above = below + 1;   // Floor, then the codes past it
+  while (below >= lo || above <= hi) {
+    int64_t left = below >= lo ? (int64_t)median2 - 2 * (int64_t)below : INT64_MAX;
+    int64_t right = above <= hi ? 2 * (int64_t)above - median2 : INT64_MAX;
+    int64_t deviation;
+    uint32_t c;
+    if (left <= right) {
+      deviation = left;
+      c = histogram[histogram_bin(below--)];
+    } else {
+      deviation = right;
+      c = histogram[histogram_bin(above++)];
+    }
+    if (c == 0) continue;
+    if (seen <= k1 && seen + c > k1) d1 = deviation;
+    if (seen + c > k2) return d1 + deviation;   // Both ranks found: twice their mean
+    seen += c;
+  }
+  return 2 * d1;
+}
+
+void fast5_signal_scan_read(fast5_signal_scan_t *scan, const int16_t *signal, size_t length,
+                            fast5_metadata_t *metadata) {
+  metadata->signal_stats_available = false;
+  if (!scan || !signal || length == 0) return;
+
+  double scale = 1.0, offset = 0.0;
+  int16_t rail_low = INT16_MIN, rail_high = INT16_MAX;
+  if (metadata->calibration_available && metadata->digitisation > 0) {
+    scale = metadata->range / metadata->digitisation;
+    offset = metadata->offset;
+    if (metadata->digitisation <= 32768.0) {
+      rail_low = 0;
+      rail_high = (int16_t)(metadata->digitisation - 1.0);
+    }
+  }
+
+  seq_kernel_i16_summary total = {0, 0, INT16_MAX, INT16_MIN, 0, 0};
+  peak_tracker_t tracker = {0};
+  uint32_t *histogram = scan->histogram;
+  for (size_t start = 0; start < length; start += SCAN_BLOCK) {
+    size_t count = length - start < SCAN_BLOCK ? length - start : SCAN_BLOCK;
+    const int16_t *block = signal + start;
+    seq_kernel_i16_summary summary;
+    seq_kernel_summary_i16(block, count, rail_low, rail_high, &summary);
+    seq_kernel_summary_merge(&total, &summary);
+    for (size_t i = 0; i < count; i++) histogram[histogram_bin(block[i])]++;
+    detect_events(scan, signal, length, start, count, &tracker);
+  }
+  if (tracker.armed) tracker.peaks++;
+
+  // The median sits between ranks (n - 1) / 2 and n / 2
+  int32_t lo = total.min, hi = total.max;
+  int32_t median_low = histogram_rank(histogram, lo, hi, (length - 1) / 2);
+  int32_t median_high = histogram_rank(histogram, lo, hi, length / 2);
+  int32_t median2 = median_low + median_high;
+  int64_t mad2 = histogram_mad2(histogram, lo, hi, median2, length);
+  memset(histogram + histogram_bin(lo), 0, (size_t)(hi - lo + 1) * sizeof(uint32_t));
+
+  double n = (double)length;
+  double mean = (double)total.sum / n;
+  double variance = ((double)total.sum_sq - (double)total.sum * mean) / n;
+  metadata->signal_mean = (mean + offset) * scale;
+  metadata->signal_stddev = variance > 0.0 ? sqrt(variance) * scale : 0.0;
+  metadata->signal_median = (0.5 * median2 + offset) * scale;
+  metadata->signal_mad = 0.25 * (double)mad2 * scale;
+  metadata->clipped_low = (uint32_t)total.below;
+  metadata->clipped_high = (uint32_t)total.above;
+  metadata->event_count = tracker.peaks + 1;
+  metadata->signal_stats_available = true;
+}
+
+// **********************************************************************
+// File Reading
+// **********************************************************************
+
+static void hdf5_lock(pthread_mutex_t *hdf5_mutex) {
+  if (hdf5_mutex) pthread_mutex_lock(hdf5_mutex);
+}
+
+static void hdf5_unlock(pthread_mutex_t *hdf5_mutex) {
+  if (hdf5_mutex) pthread_mutex_unlock(hdf5_mutex);
+}
+
+fast5_metadata_t* read_fast5_metadata_with_signal_stats(const char *filename, size_t *metadata_count,
+                                                        metadata_enhancer_t enhancer, pthread_mutex_t *hdf5_mutex,
+                                                        fast5_signal_scan_t *scan) {
+  if (!filename || !metadata_count) return NULL;
+  *metadata_count = 0;
+
+  fast5_signal_scan_t *own_scan = NULL;
+  if (!scan) {
+    scan = own_scan = fast5_signal_scan_create();
+    if (!scan) return NULL;
+  }
+
+  hdf5_lock(hdf5_mutex);
+  fast5_reader_t *reader = fast5_reader_open(filename, enhancer);
+  hdf5_unlock(hdf5_mutex);
+  if (!reader) {
+    fast5_signal_scan_free(own_scan);
+    return NULL;
+  }
+
+  // Only the raw chunk fetch holds the HDF5 lock; inflating and scanning run in parallel
+  fast5_reader_defer_decode(reader, true);
+
+  size_t num_reads = fast5_reader_num_reads(reader);
+  fast5_metadata_t *metadata = num_reads > 0 ? calloc(num_reads, sizeof(fast5_metadata_t)) : NULL;
+  while (metadata && *metadata_count < num_reads) {
+    fast5_metadata_t *read = &metadata[*metadata_count];
+    hdf5_lock(hdf5_mutex);
+    int status = fast5_reader_next(reader, read, true);
+    hdf5_unlock(hdf5_mutex);
+    if (status <= 0) break;
+    (*metadata_count)++;
+
+    if (!fast5_reader_decode_signal(reader)) {
+      warnx("Cannot decompress the signal of read %s in %s", read->read_id ? read->read_id : "unknown", filename);
+      continue;
+    }
+    size_t signal_length = 0;
+    const int16_t *signal = fast5_reader_signal(reader, &signal_length);
+    fast5_signal_scan_read(scan, signal, signal_length, read);
+  }
+
+  hdf5_lock(hdf5_mutex);
+  fast5_reader_close(reader);
+  hdf5_unlock(hdf5_mutex);
+  fast5_signal_scan_free(own_scan);
+
+  if (*metadata_count == 0) {
+    free(metadata);
+    return NULL;
+  }
+  return metadata;
+}
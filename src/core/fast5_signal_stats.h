@@ -0,0 +1,53 @@
+// **********************************************************************
+// core/fast5_signal_stats.h - One-Pass Signal QC for Fast5 Reads
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Per-read signal summaries for `sequelizer fast5 --signal-stats`: mean and
+// standard deviation, median and median absolute deviation, samples pinned
+// at the ADC rails, and a count of the steps a two-window t-test finds. The
+// raw int16 samples are walked once, a block at a time, by the dispatched
+// summary kernel (seq_kernels.h), a histogram and the t-test, so a read is
+// never converted to float or sorted.
+//
+// Medians come from the histogram of ADC codes and are exact to the code;
+// results are in pA (pA = scale * (raw + offset), scale = range / digitisation)
+// when the read carries calibration and in ADC units otherwise. The rails are
+// 0 and digitisation - 1 for calibrated reads, the int16 limits otherwise.
+#ifndef SEQUELIZER_FAST5_SIGNAL_STATS_H
+#define SEQUELIZER_FAST5_SIGNAL_STATS_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "fast5_io.h"
+#include "fast5_utils.h"
+
+// t-test event detector: windows of FAST5_EVENT_WINDOW samples either side of
+// each boundary; local maxima of t above FAST5_EVENT_THRESHOLD at least a
+// window apart split the read into events
+#define FAST5_EVENT_WINDOW 6
+#define FAST5_EVENT_THRESHOLD 4.0
+
+// Scratch space (a 64K-bin histogram and block buffers), reused across reads;
+// one per thread
+typedef struct fast5_signal_scan fast5_signal_scan_t;
+
+fast5_signal_scan_t* fast5_signal_scan_create(void);
+void fast5_signal_scan_free(fast5_signal_scan_t *scan);
+
+// Fill the signal QC fields of metadata (calibration taken from it) from its
+// length samples; signal_stats_available stays false for an empty signal
+void fast5_signal_scan_read(fast5_signal_scan_t *scan, const int16_t *signal, size_t length,
+                            fast5_metadata_t *metadata);
+
+// Metadata of every read in filename with the signal QC fields filled in. Like
+// read_fast5_metadata_thread_safe(), HDF5 calls are serialised behind hdf5_mutex
+// (NULL: no locking), but only the open, each Signal fetch and the close hold
+// it: decoding and scanning run unlocked. The enhancer should extract the
+// calibration. scan may be NULL (one is made for the call)
+fast5_metadata_t* read_fast5_metadata_with_signal_stats(const char *filename, size_t *metadata_count,
+                                                        metadata_enhancer_t enhancer, pthread_mutex_t *hdf5_mutex,
+                                                        fast5_signal_scan_t *scan);
+
+#endif // SEQUELIZER_FAST5_SIGNAL_STATS_H
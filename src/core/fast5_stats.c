@@ -4,10 +4,1108 @@
 // Sebastian Claudiusz Magierowski Aug 14 2025
 
 #include "fast5_stats.h"
+#include <err.h>
+#include <math.h>
 #include <stdlib.h> // calloc
 #include <string.h>
+#include <unistd.h> // getpid
 
-// Main calculation function that orchestrates all statistics
+// **********************************************************************
+// Moments and Quantile Sketches
+// **********************************************************************
+
+void fast5_moments_add(fast5_moments_t *moments, double value) {
+  moments->count++;
+  double delta = value - moments->mean;
+  moments->mean += delta / moments->count;
+  moments->m2 += delta * (value - moments->mean);
+  if (moments->count == 1 || value < moments->min) moments->min = value;
+  if (moments->count == 1 || value > moments->max) moments->max = value;
+}
+
+// Pairwise combination of two partial (count, mean, M2), after Chan et al.
+void fast5_moments_merge(fast5_moments_t *dst, const fast5_moments_t *src) {
+  if (src->count == 0) return;
+  if (dst->count == 0) {
+    *dst = *src;
+    return;
+  }
+  double n = (double)(dst->count + src->count);
+  double delta = src->mean - dst->mean;
+  dst->mean += delta * src->count / n;
+  dst->m2 += src->m2 + delta * delta * ((double)dst->count * src->count / n);
+  dst->count += src->count;
+  if (src->min < dst->min) dst->min = src->min;
+  if (src->max > dst->max) dst->max = src->max;
+}
+
+double fast5_moments_stddev(const fast5_moments_t *moments) {
+  return moments->count > 1 ? sqrt(moments->m2 / (moments->count - 1)) : 0.0;
+}
+
+// Bucket i holds (MIN * gamma^(i-1), MIN * gamma^i]
+static double sketch_gamma(void) {
+  return (1.0 + FAST5_SKETCH_ALPHA) / (1.0 - FAST5_SKETCH_ALPHA);
+}
+
+void fast5_sketch_add(fast5_sketch_t *sketch, double value) {
+  sketch->count++;
+  if (!(value >= FAST5_SKETCH_MIN_VALUE)) {
+    sketch->below_min++;
+    return;
+  }
+  double index = ceil(log(value / FAST5_SKETCH_MIN_VALUE) / log(sketch_gamma()));
+  sketch->buckets[index < FAST5_SKETCH_BUCKETS ? (size_t)index : FAST5_SKETCH_BUCKETS - 1]++;
+}
+
+void fast5_sketch_merge(fast5_sketch_t *dst, const fast5_sketch_t *src) {
+  dst->count += src->count;
+  dst->below_min += src->below_min;
+  for (size_t i = 0; i < FAST5_SKETCH_BUCKETS; i++) {
+    dst->buckets[i] += src->buckets[i];
+  }
+}
+
+double fast5_sketch_quantile(const fast5_sketch_t *sketch, double q) {
+  if (sketch->count == 0) return 0.0;
+  if (q < 0.0) q = 0.0;
+  if (q > 1.0) q = 1.0;
+  uint64_t rank = (uint64_t)(q * (sketch->count - 1));
+
+  uint64_t seen = sketch->below_min;
+  if (rank < seen) return 0.0;
+  double gamma = sketch_gamma();
+  for (size_t i = 0; i < FAST5_SKETCH_BUCKETS; i++) {
+    seen += sketch->buckets[i];
+    if (rank < seen) {
+      // Midpoint (in relative terms) of the bucket
+      return FAST5_SKETCH_MIN_VALUE * 2.0 * pow(gamma, (double)i) / (gamma + 1.0);
+    }
+  }
+  return FAST5_SKETCH_MIN_VALUE * pow(gamma, FAST5_SKETCH_BUCKETS - 1);
+}
+
+// **********************************************************************
+// String Hash Map (experiments by run_id, channels by channel_number)
+// **********************************************************************
+
+typedef struct {
+  char *key;               // NULL: empty slot
+  uint64_t hash;
+  union {
+    void *pointer;
+    uint64_t count;
+  } value;
+} stats_map_entry_t;
+
+struct fast5_stats_map {
+  stats_map_entry_t *entries;
+  size_t capacity;         // Power of two
+  size_t count;
+};
+
+// FNV-1a
+static uint64_t hash_key(const char *key) {
+  uint64_t hash = 1469598103934665603ULL;
+  for (const unsigned char *p = (const unsigned char*)key; *p; p++) {
+    hash = (hash ^ *p) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+// The map functions return NULL out of memory; their callers record the failure
+static fast5_stats_map_t* map_create(void) {
+  return calloc(1, sizeof(fast5_stats_map_t));
+}
+
+static stats_map_entry_t* map_slot(stats_map_entry_t *entries, size_t capacity, const char *key, uint64_t hash) {
+  size_t i = (size_t)hash & (capacity - 1);
+  while (entries[i].key && (entries[i].hash != hash || strcmp(entries[i].key, key) != 0)) {
+    i = (i + 1) & (capacity - 1);
+  }
+  return &entries[i];
+}
+
+// Entry for key, inserted (zero value) if missing; *inserted says which.
+// NULL if map is NULL or the entry cannot be added
+static stats_map_entry_t* map_find_or_insert(fast5_stats_map_t *map, const char *key, bool *inserted) {
+  *inserted = false;
+  if (!map) return NULL;
+  // Keep the load factor under 1/2
+  if (2 * (map->count + 1) > map->capacity) {
+    size_t capacity = map->capacity ? map->capacity * 2 : 16;
+    stats_map_entry_t *entries = calloc(capacity, sizeof(stats_map_entry_t));
+    if (!entries) return NULL;
+    for (size_t i = 0; i < map->capacity; i++) {
+      if (map->entries[i].key) {
+        *map_slot(entries, capacity, map->entries[i].key, map->entries[i].hash) = map->entries[i];
+      }
+    }
+    free(map->entries);
+    map->entries = entries;
+    map->capacity = capacity;
+  }
+
+  uint64_t hash = hash_key(key);
+  stats_map_entry_t *entry = map_slot(map->entries, map->capacity, key, hash);
+  if (entry->key == NULL) {
+    entry->key = strdup(key);
+    if (!entry->key) return NULL;
+    *inserted = true;
+    entry->hash = hash;
+    map->count++;
+  }
+  return entry;
+}
+
+static void map_free(fast5_stats_map_t *map, void (*free_value)(void*)) {
+  if (!map) return;
+  for (size_t i = 0; i < map->capacity; i++) {
+    if (map->entries[i].key) {
+      free(map->entries[i].key);
+      if (free_value) free_value(map->entries[i].value.pointer);
+    }
+  }
+  free(map->entries);
+  free(map);
+}
+
+// **********************************************************************
+// Dataset Accumulators
+// **********************************************************************
+
+// One experiment's share of an accumulator
+typedef struct {
+  int file_count;
+  int total_reads;
+  uint64_t min_start_time;
+  uint64_t max_start_time;
+  double sample_rate_sum;
+  int sample_rate_count;
+  int last_file;               // Serial of the file that last counted here (-1: none)
+  fast5_stats_map_t *channels; // channel_number -> read count
+} experiment_partial_t;
+
+static void experiment_partial_free(void *pointer) {
+  experiment_partial_t *experiment = (experiment_partial_t*)pointer;
+  if (!experiment) return;
+  map_free(experiment->channels, NULL);
+  free(experiment);
+}
+
+// NULL (and acc->failed) out of memory. The entry of an experiment that could
+// not be created keeps a NULL value, which every walk over the map skips
+static experiment_partial_t* find_experiment(fast5_stats_accumulator_t *acc, const char *run_id) {
+  bool inserted;
+  stats_map_entry_t *entry = map_find_or_insert(acc->experiments, run_id, &inserted);
+  if (entry && !entry->value.pointer) {
+    experiment_partial_t *experiment = calloc(1, sizeof(experiment_partial_t));
+    if (experiment) experiment->channels = map_create();
+    if (experiment && experiment->channels) {
+      experiment->min_start_time = UINT64_MAX;
+      experiment->last_file = -1;
+      entry->value.pointer = experiment;
+    } else {
+      free(experiment);
+    }
+  }
+  if (!entry || !entry->value.pointer) {
+    if (!acc->failed) warnx("Memory allocation failed for experiment statistics");
+    acc->failed = true;
+    return NULL;
+  }
+  return (experiment_partial_t*)entry->value.pointer;
+}
+
+void fast5_stats_accumulator_init(fast5_stats_accumulator_t *acc) {
+  memset(acc, 0, sizeof(*acc));
+  acc->experiments = map_create();
+  if (!acc->experiments) {
+    warnx("Memory allocation failed for experiment statistics");
+    acc->failed = true;
+  }
+}
+
+void fast5_stats_accumulator_free(fast5_stats_accumulator_t *acc) {
+  if (!acc) return;
+  map_free(acc->experiments, experiment_partial_free);
+  acc->experiments = NULL;
+}
+
+void fast5_stats_accumulator_add_file(fast5_stats_accumulator_t *acc, const char *filename,
+                                      const fast5_metadata_t *metadata, int count) {
+  if (!metadata || count <= 0) return;
+  int serial = acc->successful_files++;
+  acc->total_reads += count;
+  acc->total_file_size_mb += get_file_size_mb(filename);
+
+  bool temporal = false, scanned = false;
+  double file_min_rate = 0.0, file_max_rate = 0.0;
+  for (int j = 0; j < count; j++) {
+    const fast5_metadata_t *read = &metadata[j];
+    acc->total_samples += read->signal_length;
+    if (read->signal_stats_available) {
+      scanned = true;
+      fast5_moments_add(&acc->signal_mean, read->signal_mean);
+      fast5_moments_add(&acc->signal_stddev, read->signal_stddev);
+      fast5_moments_add(&acc->signal_median, read->signal_median);
+      fast5_moments_add(&acc->signal_mad, read->signal_mad);
+      if (read->sample_rate > 0 && read->signal_length > 0) {
+        fast5_moments_add(&acc->events_per_second, read->event_count * read->sample_rate / read->signal_length);
+      }
+      uint64_t clipped = (uint64_t)read->clipped_low + read->clipped_high;
+      acc->scanned_samples += read->signal_length;
+      acc->clipped_samples += clipped;
+      acc->signal_events += read->event_count;
+      if (clipped > 0) acc->reads_with_clipping++;
+    }
+    if (read->signal_length > 0) {
+      fast5_moments_add(&acc->signal_length, read->signal_length);
+      fast5_sketch_add(&acc->signal_length_sketch, read->signal_length);
+    }
+
+    // Convert duration from samples to seconds using sample rate
+    if (read->sample_rate > 0) {
+      double seconds = (double)read->duration / read->sample_rate;
+      acc->total_duration_seconds += seconds;
+      fast5_moments_add(&acc->duration, seconds);
+      fast5_sketch_add(&acc->duration_sketch, seconds);
+      fast5_moments_add(&acc->sampling_rate, read->sample_rate);
+      if (file_max_rate == 0.0 || read->sample_rate < file_min_rate) file_min_rate = read->sample_rate;
+      if (read->sample_rate > file_max_rate) file_max_rate = read->sample_rate;
+    }
+
+    if (read->run_id) {
+      temporal = true;
+      experiment_partial_t *experiment = find_experiment(acc, read->run_id);
+      if (!experiment) continue;
+      if (experiment->last_file != serial) {
+        experiment->last_file = serial;
+        experiment->file_count++;
+      }
+      experiment->total_reads++;
+      if (read->start_time < experiment->min_start_time) experiment->min_start_time = read->start_time;
+      if (read->start_time > experiment->max_start_time) experiment->max_start_time = read->start_time;
+      if (read->sample_rate > 0) {
+        experiment->sample_rate_sum += read->sample_rate;
+        experiment->sample_rate_count++;
+      }
+      if (read->channel_number) {
+        bool inserted;
+        stats_map_entry_t *channel = map_find_or_insert(experiment->channels, read->channel_number, &inserted);
+        if (channel) {
+          channel->value.count++;
+        } else {
+          if (!acc->failed) warnx("Memory allocation failed for experiment statistics");
+          acc->failed = true;
+        }
+      }
+    }
+  }
+  if (temporal) acc->files_with_temporal_data++;
+  if (scanned) acc->files_with_signal_stats++;
+  if (file_min_rate != file_max_rate) acc->files_with_rate_variation++;
+}
+
+void fast5_stats_accumulator_merge(fast5_stats_accumulator_t *dst, const fast5_stats_accumulator_t *src) {
+  dst->successful_files += src->successful_files;
+  dst->total_reads += src->total_reads;
+  dst->total_samples += src->total_samples;
+  dst->total_duration_seconds += src->total_duration_seconds;
+  dst->total_file_size_mb += src->total_file_size_mb;
+  fast5_moments_merge(&dst->signal_length, &src->signal_length);
+  fast5_sketch_merge(&dst->signal_length_sketch, &src->signal_length_sketch);
+  fast5_moments_merge(&dst->duration, &src->duration);
+  fast5_sketch_merge(&dst->duration_sketch, &src->duration_sketch);
+  fast5_moments_merge(&dst->sampling_rate, &src->sampling_rate);
+  dst->files_with_rate_variation += src->files_with_rate_variation;
+  dst->files_with_temporal_data += src->files_with_temporal_data;
+  dst->files_with_signal_stats += src->files_with_signal_stats;
+  fast5_moments_merge(&dst->signal_mean, &src->signal_mean);
+  fast5_moments_merge(&dst->signal_stddev, &src->signal_stddev);
+  fast5_moments_merge(&dst->signal_median, &src->signal_median);
+  fast5_moments_merge(&dst->signal_mad, &src->signal_mad);
+  fast5_moments_merge(&dst->events_per_second, &src->events_per_second);
+  dst->scanned_samples += src->scanned_samples;
+  dst->clipped_samples += src->clipped_samples;
+  dst->signal_events += src->signal_events;
+  dst->reads_with_clipping += src->reads_with_clipping;
+  if (src->failed) dst->failed = true;
+  if (!src->experiments) return;
+
+  // Workers see disjoint files, so per-experiment file counts simply add
+  for (size_t i = 0; i < src->experiments->capacity; i++) {
+    const stats_map_entry_t *entry = &src->experiments->entries[i];
+    if (!entry->key || !entry->value.pointer) continue;
+    const experiment_partial_t *from = (const experiment_partial_t*)entry->value.pointer;
+    experiment_partial_t *to = find_experiment(dst, entry->key);
+    if (!to) continue;
+    to->file_count += from->file_count;
+    to->total_reads += from->total_reads;
+    if (from->min_start_time < to->min_start_time) to->min_start_time = from->min_start_time;
+    if (from->max_start_time > to->max_start_time) to->max_start_time = from->max_start_time;
+    to->sample_rate_sum += from->sample_rate_sum;
+    to->sample_rate_count += from->sample_rate_count;
+    for (size_t c = 0; c < from->channels->capacity; c++) {
+      const stats_map_entry_t *channel = &from->channels->entries[c];
+      if (!channel->key) continue;
+      bool inserted;
+      stats_map_entry_t *merged = map_find_or_insert(to->channels, channel->key, &inserted);
+      if (merged) {
+        merged->value.count += channel->value.count;
+      } else {
+        if (!dst->failed) warnx("Memory allocation failed for experiment statistics");
+        dst->failed = true;
+      }
+    }
+  }
+}
+
+// **********************************************************************
+// Accumulator Serialisation (for the summary cache)
+// **********************************************************************
+// Fields in order, host byte order; sketches keep only non-empty buckets,
+// so one file's partial is a few hundred bytes rather than the full sketch
+
+typedef struct {
+  uint8_t *data;
+  size_t length;
+  size_t capacity;
+  bool failed;             // Out of memory: the blob is incomplete
+} blob_writer_t;
+
+typedef struct {
+  const uint8_t *data;
+  size_t length;
+  size_t position;
+  bool ok;                 // False once a read ran past the end
+} blob_reader_t;
+
+static void put_bytes(blob_writer_t *w, const void *bytes, size_t size) {
+  if (w->failed) return;
+  if (w->length + size > w->capacity) {
+    size_t capacity = w->capacity ? w->capacity : 256;
+    while (capacity < w->length + size) capacity *= 2;
+    uint8_t *grown = realloc(w->data, capacity);
+    if (!grown) {
+      w->failed = true;
+      return;
+    }
+    w->data = grown;
+    w->capacity = capacity;
+  }
+  memcpy(w->data + w->length, bytes, size);
+  w->length += size;
+}
+
+static bool get_bytes(blob_reader_t *r, void *bytes, size_t size) {
+  if (!r->ok || r->length - r->position < size) {
+    r->ok = false;
+    memset(bytes, 0, size);
+    return false;
+  }
+  memcpy(bytes, r->data + r->position, size);
+  r->position += size;
+  return true;
+}
+
+#define PUT(w, value) put_bytes((w), &(value), sizeof(value))
+#define GET(r, value) get_bytes((r), &(value), sizeof(value))
+
+static void put_string(blob_writer_t *w, const char *s) {
+  uint32_t length = (uint32_t)strlen(s);
+  PUT(w, length);
+  put_bytes(w, s, length);
+}
+
+// Caller frees; NULL (and r->ok false) if truncated or out of memory
+static char* get_string(blob_reader_t *r) {
+  uint32_t length;
+  if (!GET(r, length) || r->length - r->position < length) {
+    r->ok = false;
+    return NULL;
+  }
+  char *s = malloc((size_t)length + 1);
+  if (!s) {
+    r->ok = false;
+    return NULL;
+  }
+  get_bytes(r, s, length);
+  s[length] = '\0';
+  return s;
+}
+
+static void put_moments(blob_writer_t *w, const fast5_moments_t *m) {
+  PUT(w, m->count);
+  PUT(w, m->mean);
+  PUT(w, m->m2);
+  PUT(w, m->min);
+  PUT(w, m->max);
+}
+
+static void get_moments(blob_reader_t *r, fast5_moments_t *m) {
+  GET(r, m->count);
+  GET(r, m->mean);
+  GET(r, m->m2);
+  GET(r, m->min);
+  GET(r, m->max);
+}
+
+static void put_sketch(blob_writer_t *w, const fast5_sketch_t *sketch) {
+  PUT(w, sketch->count);
+  PUT(w, sketch->below_min);
+  uint32_t used = 0;
+  for (size_t i = 0; i < FAST5_SKETCH_BUCKETS; i++) {
+    if (sketch->buckets[i]) used++;
+  }
+  PUT(w, used);
+  for (uint16_t i = 0; i < FAST5_SKETCH_BUCKETS; i++) {
+    if (!sketch->buckets[i]) continue;
+    PUT(w, i);
+    PUT(w, sketch->buckets[i]);
+  }
+}
+
+// Adds the serialised buckets into sketch
+static void merge_sketch(blob_reader_t *r, fast5_sketch_t *sketch) {
+  uint64_t count, below_min;
+  uint32_t used;
+  GET(r, count);
+  GET(r, below_min);
+  GET(r, used);
+  sketch->count += count;
+  sketch->below_min += below_min;
+  for (uint32_t b = 0; b < used && r->ok; b++) {
+    uint16_t index;
+    uint64_t n;
+    GET(r, index);
+    GET(r, n);
+    if (index >= FAST5_SKETCH_BUCKETS) {
+      r->ok = false;
+      break;
+    }
+    sketch->buckets[index] += n;
+  }
+}
+
+// An accumulator that lost entries is not worth keeping: w->failed
+static void serialise_accumulator(blob_writer_t *w, const fast5_stats_accumulator_t *acc) {
+  if (acc->failed) {
+    w->failed = true;
+    return;
+  }
+  PUT(w, acc->successful_files);
+  PUT(w, acc->total_reads);
+  PUT(w, acc->total_samples);
+  PUT(w, acc->total_duration_seconds);
+  PUT(w, acc->total_file_size_mb);
+  put_moments(w, &acc->signal_length);
+  put_sketch(w, &acc->signal_length_sketch);
+  put_moments(w, &acc->duration);
+  put_sketch(w, &acc->duration_sketch);
+  put_moments(w, &acc->sampling_rate);
+  PUT(w, acc->files_with_rate_variation);
+  PUT(w, acc->files_with_temporal_data);
+  PUT(w, acc->files_with_signal_stats);
+  put_moments(w, &acc->signal_mean);
+  put_moments(w, &acc->signal_stddev);
+  put_moments(w, &acc->signal_median);
+  put_moments(w, &acc->signal_mad);
+  put_moments(w, &acc->events_per_second);
+  PUT(w, acc->scanned_samples);
+  PUT(w, acc->clipped_samples);
+  PUT(w, acc->signal_events);
+  PUT(w, acc->reads_with_clipping);
+
+  uint32_t experiments = (uint32_t)acc->experiments->count;
+  PUT(w, experiments);
+  for (size_t i = 0; i < acc->experiments->capacity; i++) {
+    const stats_map_entry_t *entry = &acc->experiments->entries[i];
+    if (!entry->key) continue;
+    const experiment_partial_t *experiment = (const experiment_partial_t*)entry->value.pointer;
+    put_string(w, entry->key);
+    PUT(w, experiment->file_count);
+    PUT(w, experiment->total_reads);
+    PUT(w, experiment->min_start_time);
+    PUT(w, experiment->max_start_time);
+    PUT(w, experiment->sample_rate_sum);
+    PUT(w, experiment->sample_rate_count);
+    uint32_t channels = (uint32_t)experiment->channels->count;
+    PUT(w, channels);
+    for (size_t c = 0; c < experiment->channels->capacity; c++) {
+      const stats_map_entry_t *channel = &experiment->channels->entries[c];
+      if (!channel->key) continue;
+      put_string(w, channel->key);
+      PUT(w, channel->value.count);
+    }
+  }
+}
+
+// dst += the serialised accumulator (dst NULL: only check it); false if the
+// blob is malformed, or if signal QC is required and the file was read without it
+static bool merge_serialised(fast5_stats_accumulator_t *dst, const uint8_t *data, size_t length,
+                             bool need_signal_stats) {
+  blob_reader_t r = {data, length, 0, true};
+  fast5_stats_accumulator_t *src = malloc(sizeof(fast5_stats_accumulator_t));
+  if (!src) return false;
+  fast5_stats_accumulator_init(src);
+
+  GET(&r, src->successful_files);
+  GET(&r, src->total_reads);
+  GET(&r, src->total_samples);
+  GET(&r, src->total_duration_seconds);
+  GET(&r, src->total_file_size_mb);
+  get_moments(&r, &src->signal_length);
+  merge_sketch(&r, &src->signal_length_sketch);
+  get_moments(&r, &src->duration);
+  merge_sketch(&r, &src->duration_sketch);
+  get_moments(&r, &src->sampling_rate);
+  GET(&r, src->files_with_rate_variation);
+  GET(&r, src->files_with_temporal_data);
+  GET(&r, src->files_with_signal_stats);
+  get_moments(&r, &src->signal_mean);
+  get_moments(&r, &src->signal_stddev);
+  get_moments(&r, &src->signal_median);
+  get_moments(&r, &src->signal_mad);
+  get_moments(&r, &src->events_per_second);
+  GET(&r, src->scanned_samples);
+  GET(&r, src->clipped_samples);
+  GET(&r, src->signal_events);
+  GET(&r, src->reads_with_clipping);
+
+  uint32_t experiments = 0;
+  GET(&r, experiments);
+  for (uint32_t e = 0; e < experiments && r.ok; e++) {
+    char *run_id = get_string(&r);
+    if (!run_id) break;
+    experiment_partial_t *experiment = find_experiment(src, run_id);
+    free(run_id);
+    if (!experiment) break;
+    GET(&r, experiment->file_count);
+    GET(&r, experiment->total_reads);
+    GET(&r, experiment->min_start_time);
+    GET(&r, experiment->max_start_time);
+    GET(&r, experiment->sample_rate_sum);
+    GET(&r, experiment->sample_rate_count);
+    uint32_t channels = 0;
+    GET(&r, channels);
+    for (uint32_t c = 0; c < channels && r.ok; c++) {
+      char *channel = get_string(&r);
+      if (!channel) break;
+      bool inserted;
+      stats_map_entry_t *entry = map_find_or_insert(experiment->channels, channel, &inserted);
+      free(channel);
+      if (!entry) {
+        src->failed = true;
+        break;
+      }
+      GET(&r, entry->value.count);
+    }
+  }
+
+  bool ok = r.ok && r.position == r.length && !src->failed;
+  if (need_signal_stats && src->successful_files > src->files_with_signal_stats) ok = false;
+  if (ok && dst) {
+    fast5_stats_accumulator_merge(dst, src);
+  }
+  fast5_stats_accumulator_free(src);
+  free(src);
+  return ok;
+}
+
+// **********************************************************************
+// Per-File Summary Cache
+// **********************************************************************
+
+#define FAST5_STATS_CACHE_MAGIC "S5SC"
+#define FAST5_STATS_CACHE_VERSION 2
+
+typedef struct {
+  int64_t size;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  int32_t reads;
+  uint8_t *blob;           // Serialised accumulator for this one file
+  uint32_t blob_length;
+  bool removed;            // Forgotten; the map slot stays until the cache is freed
+  unsigned generation;     // Last scan that saw the file
+} cache_entry_t;
+
+struct fast5_stats_cache {
+  fast5_stats_map_t *files;  // path -> cache_entry_t
+  size_t live;
+  unsigned generation;
+  bool need_signal_stats;    // Entries without signal QC are stale
+};
+
+static void cache_entry_free(void *pointer) {
+  cache_entry_t *entry = (cache_entry_t*)pointer;
+  if (entry) free(entry->blob);
+  free(entry);
+}
+
+// NULL out of memory (a slot left without an entry reads as not cached)
+static cache_entry_t* cache_entry(fast5_stats_cache_t *cache, const char *filename) {
+  bool inserted;
+  stats_map_entry_t *slot = map_find_or_insert(cache->files, filename, &inserted);
+  if (!slot) return NULL;
+  if (!slot->value.pointer) {
+    slot->value.pointer = calloc(1, sizeof(cache_entry_t));
+    if (!slot->value.pointer) return NULL;
+    ((cache_entry_t*)slot->value.pointer)->removed = true;
+  }
+  return (cache_entry_t*)slot->value.pointer;
+}
+
+// Existing live entry or NULL, without inserting
+static cache_entry_t* cache_find(const fast5_stats_cache_t *cache, const char *filename) {
+  if (cache->files->count == 0) return NULL;
+  stats_map_entry_t *slot = map_slot(cache->files->entries, cache->files->capacity, filename, hash_key(filename));
+  cache_entry_t *entry = slot->key ? (cache_entry_t*)slot->value.pointer : NULL;
+  return entry && !entry->removed ? entry : NULL;
+}
+
+#ifdef __APPLE__
+#define FILE_MTIME(st) ((st)->st_mtimespec)
+#else
+#define FILE_MTIME(st) ((st)->st_mtim)
+#endif
+
+static void set_file_version(cache_entry_t *entry, const struct stat *st) {
+  entry->size = (int64_t)st->st_size;
+  entry->mtime_sec = (int64_t)FILE_MTIME(st).tv_sec;
+  entry->mtime_nsec = (int64_t)FILE_MTIME(st).tv_nsec;
+}
+
+static bool same_file_version(const cache_entry_t *entry, const struct stat *st) {
+  return entry->size == (int64_t)st->st_size && entry->mtime_sec == (int64_t)FILE_MTIME(st).tv_sec &&
+         entry->mtime_nsec == (int64_t)FILE_MTIME(st).tv_nsec;
+}
+
+static fast5_stats_cache_t* cache_create(void) {
+  fast5_stats_cache_t *cache = calloc(1, sizeof(fast5_stats_cache_t));
+  if (cache) cache->files = map_create();
+  if (!cache || !cache->files) {
+    warnx("Memory allocation failed for statistics cache");
+    free(cache);
+    return NULL;
+  }
+  return cache;
+}
+
+fast5_stats_cache_t* fast5_stats_cache_load(const char *path) {
+  fast5_stats_cache_t *cache = cache_create();
+  if (!cache) return NULL;
+  FILE *file = fopen(path, "rb");
+  if (!file) return cache;  // First run
+
+  // Small enough (hundreds of bytes per file) to parse from memory
+  uint8_t *data = NULL;
+  size_t length = 0;
+  struct stat st;
+  if (fstat(fileno(file), &st) == 0 && st.st_size > 0) {
+    length = (size_t)st.st_size;
+    data = malloc(length);
+    if (!data) {
+      warnx("Memory allocation failed for statistics cache");
+      fclose(file);
+      fast5_stats_cache_free(cache);
+      return NULL;
+    }
+    if (fread(data, 1, length, file) != length) length = 0;
+  }
+  fclose(file);
+
+  blob_reader_t r = {data, length, 0, true};
+  char magic[4];
+  uint32_t version = 0;
+  uint64_t count = 0;
+  bool ok = get_bytes(&r, magic, sizeof(magic)) && memcmp(magic, FAST5_STATS_CACHE_MAGIC, 4) == 0 &&
+            GET(&r, version) && version == FAST5_STATS_CACHE_VERSION && GET(&r, count);
+  bool out_of_memory = false;
+  for (uint64_t i = 0; ok && i < count; i++) {
+    char *filename = get_string(&r);
+    if (!filename) break;
+    cache_entry_t *entry = cache_entry(cache, filename);
+    free(filename);
+    if (!entry) {
+      out_of_memory = true;
+      break;
+    }
+    GET(&r, entry->size);
+    GET(&r, entry->mtime_sec);
+    GET(&r, entry->mtime_nsec);
+    GET(&r, entry->reads);
+    GET(&r, entry->blob_length);
+    if (!r.ok || r.length - r.position < entry->blob_length) {
+      r.ok = false;
+      break;
+    }
+    free(entry->blob);
+    entry->blob = malloc(entry->blob_length ? entry->blob_length : 1);
+    if (!entry->blob) {
+      out_of_memory = true;
+      break;
+    }
+    get_bytes(&r, entry->blob, entry->blob_length);
+    if (entry->removed) cache->live++;
+    entry->removed = false;
+  }
+  free(data);
+
+  if (out_of_memory) {
+    warnx("Memory allocation failed for statistics cache");
+    fast5_stats_cache_free(cache);
+    return NULL;
+  }
+  if (!ok || !r.ok) {
+    warnx("Ignoring unreadable statistics cache %s", path);
+    fast5_stats_cache_free(cache);
+    return cache_create();
+  }
+  return cache;
+}
+
+bool fast5_stats_cache_save(const fast5_stats_cache_t *cache, const char *path) {
+  blob_writer_t w = {0};
+  put_bytes(&w, FAST5_STATS_CACHE_MAGIC, 4);
+  uint32_t version = FAST5_STATS_CACHE_VERSION;
+  uint64_t count = cache->live;
+  PUT(&w, version);
+  PUT(&w, count);
+  for (size_t i = 0; i < cache->files->capacity; i++) {
+    const stats_map_entry_t *slot = &cache->files->entries[i];
+    const cache_entry_t *entry = slot->key ? (const cache_entry_t*)slot->value.pointer : NULL;
+    if (!entry || entry->removed) continue;
+    put_string(&w, slot->key);
+    PUT(&w, entry->size);
+    PUT(&w, entry->mtime_sec);
+    PUT(&w, entry->mtime_nsec);
+    PUT(&w, entry->reads);
+    PUT(&w, entry->blob_length);
+    put_bytes(&w, entry->blob, entry->blob_length);
+  }
+
+  // Write beside the target and rename over it, so readers never see half a cache
+  size_t tmp_length = strlen(path) + 32;
+  char *tmp = w.failed ? NULL : malloc(tmp_length);
+  if (!tmp) {
+    warnx("Memory allocation failed for statistics cache, not writing %s", path);
+    free(w.data);
+    return false;
+  }
+  snprintf(tmp, tmp_length, "%s.%ld.tmp", path, (long)getpid());
+  FILE *file = fopen(tmp, "wb");
+  bool ok = file && fwrite(w.data, 1, w.length, file) == w.length;
+  if (file && fclose(file) != 0) ok = false;
+  ok = ok && rename(tmp, path) == 0;
+  if (!ok) {
+    warnx("Failed to write statistics cache %s", path);
+    remove(tmp);
+  }
+  free(tmp);
+  free(w.data);
+  return ok;
+}
+
+void fast5_stats_cache_free(fast5_stats_cache_t *cache) {
+  if (!cache) return;
+  map_free(cache->files, cache_entry_free);
+  free(cache);
+}
+
+fast5_cache_status_t fast5_stats_cache_lookup(fast5_stats_cache_t *cache, const char *filename,
+                                              const struct stat *st, fast5_stats_accumulator_t *acc, int *reads) {
+  cache_entry_t *entry = cache_find(cache, filename);
+  if (!entry) return FAST5_CACHE_MISS;
+  entry->generation = cache->generation;
+  if (!same_file_version(entry, st)) return FAST5_CACHE_STALE;
+
+  // A corrupt entry just means reading the file again
+  if ((acc || cache->need_signal_stats) &&
+      !merge_serialised(acc, entry->blob, entry->blob_length, cache->need_signal_stats)) {
+    return FAST5_CACHE_STALE;
+  }
+  if (reads) *reads = entry->reads;
+  return FAST5_CACHE_HIT;
+}
+
+void fast5_stats_cache_require_signal_stats(fast5_stats_cache_t *cache, bool required) {
+  cache->need_signal_stats = required;
+}
+
+void fast5_stats_cache_store(fast5_stats_cache_t *cache, const char *filename, const struct stat *st,
+                             const fast5_stats_accumulator_t *file_stats) {
+  blob_writer_t w = {0};
+  serialise_accumulator(&w, file_stats);
+
+  cache_entry_t *entry = w.failed ? NULL : cache_entry(cache, filename);
+  if (!entry) {
+    warnx("Memory allocation failed for statistics cache, not caching %s", filename);
+    free(w.data);
+    return;
+  }
+  if (entry->removed) cache->live++;
+  entry->removed = false;
+  set_file_version(entry, st);
+  entry->reads = file_stats->total_reads;
+  free(entry->blob);
+  entry->blob = w.data;
+  entry->blob_length = (uint32_t)w.length;
+  entry->generation = cache->generation;
+}
+
+bool fast5_stats_cache_remove(fast5_stats_cache_t *cache, const char *filename) {
+  cache_entry_t *entry = cache_find(cache, filename);
+  if (!entry) return false;
+  entry->removed = true;
+  free(entry->blob);
+  entry->blob = NULL;
+  entry->blob_length = 0;
+  cache->live--;
+  return true;
+}
+
+void fast5_stats_cache_begin_scan(fast5_stats_cache_t *cache) {
+  cache->generation++;
+}
+
+size_t fast5_stats_cache_sweep(fast5_stats_cache_t *cache) {
+  size_t swept = 0;
+  for (size_t i = 0; i < cache->files->capacity; i++) {
+    const stats_map_entry_t *slot = &cache->files->entries[i];
+    cache_entry_t *entry = slot->key ? (cache_entry_t*)slot->value.pointer : NULL;
+    if (!entry || entry->removed || entry->generation == cache->generation) continue;
+    fast5_stats_cache_remove(cache, slot->key);
+    swept++;
+  }
+  return swept;
+}
+
+void fast5_stats_cache_merge_all(const fast5_stats_cache_t *cache, fast5_stats_accumulator_t *acc) {
+  for (size_t i = 0; i < cache->files->capacity; i++) {
+    const stats_map_entry_t *slot = &cache->files->entries[i];
+    const cache_entry_t *entry = slot->key ? (const cache_entry_t*)slot->value.pointer : NULL;
+    if (!entry || entry->removed) continue;
+    if (!merge_serialised(acc, entry->blob, entry->blob_length, false)) {
+      warnx("Skipping corrupt statistics cache entry for %s", slot->key);
+    }
+  }
+}
+
+size_t fast5_stats_cache_count(const fast5_stats_cache_t *cache) {
+  return cache->live;
+}
+
+// **********************************************************************
+// Dataset Statistics
+// **********************************************************************
+
+
+// Channels in numeric order ("2" before "10"), then by name
+static int compare_sensors(const void *a, const void *b) {
+  const sensor_summary_t *x = (const sensor_summary_t*)a;
+  const sensor_summary_t *y = (const sensor_summary_t*)b;
+  long cx = atol(x->channel_number), cy = atol(y->channel_number);
+  if (cx != cy) return cx < cy ? -1 : 1;
+  return strcmp(x->channel_number, y->channel_number);
+}
+
+static int compare_experiments(const void *a, const void *b) {
+  return strcmp(((const experiment_summary_t*)a)->run_id, ((const experiment_summary_t*)b)->run_id);
+}
+
+// False out of memory; free_fast5_dataset_stats() releases what was filled in
+static bool summarise_experiment(experiment_summary_t *summary, const char *run_id,
+                                 const experiment_partial_t *experiment) {
+  summary->run_id = strdup(run_id);
+  summary->file_count = experiment->file_count;
+  summary->total_reads = experiment->total_reads;
+  summary->file_paths = NULL;  // Not kept: would grow with the dataset
+
+  // Sensors
+  size_t sensor_count = experiment->channels->count;
+  if (sensor_count > 0) {
+    summary->sensors = calloc(sensor_count, sizeof(sensor_summary_t));
+    if (!summary->sensors) return false;
+    size_t n = 0;
+    for (size_t i = 0; i < experiment->channels->capacity; i++) {
+      const stats_map_entry_t *channel = &experiment->channels->entries[i];
+      if (!channel->key) continue;
+      summary->sensors[n].channel_number = strdup(channel->key);
+      summary->sensors[n].read_count = (int)channel->value.count;
+      summary->sensors[n].experiment_id = strdup(run_id);
+      summary->sensor_count = (int)++n;
+      if (!summary->sensors[n - 1].channel_number || !summary->sensors[n - 1].experiment_id) return false;
+    }
+    qsort(summary->sensors, sensor_count, sizeof(sensor_summary_t), compare_sensors);
+
+    int total = 0;
+    const sensor_summary_t *most = &summary->sensors[0];
+    summary->min_reads_per_sensor = summary->sensors[0].read_count;
+    for (size_t i = 0; i < sensor_count; i++) {
+      int reads = summary->sensors[i].read_count;
+      total += reads;
+      if (reads < summary->min_reads_per_sensor) summary->min_reads_per_sensor = reads;
+      if (reads > most->read_count) most = &summary->sensors[i];
+    }
+    summary->sensor_count = (int)sensor_count;
+    summary->max_reads_per_sensor = most->read_count;
+    summary->avg_reads_per_sensor = (double)total / sensor_count;
+    summary->most_productive_sensor = strdup(most->channel_number);
+    if (!summary->most_productive_sensor) return false;
+    summary->sensor_efficiency_score = summary->avg_reads_per_sensor / summary->max_reads_per_sensor;
+  }
+
+  // Experimental duration from the spread of read start times
+  summary->min_start_time = experiment->min_start_time == UINT64_MAX ? 0 : experiment->min_start_time;
+  summary->max_start_time = experiment->max_start_time;
+  if (experiment->sample_rate_count > 0) {
+    summary->avg_sample_rate = experiment->sample_rate_sum / experiment->sample_rate_count;
+    summary->duration_seconds = (summary->max_start_time - summary->min_start_time) / summary->avg_sample_rate;
+    summary->duration_minutes = summary->duration_seconds / 60.0;
+  }
+
+  // Throughput
+  if (summary->duration_minutes > 0) {
+    summary->total_reads_per_minute = summary->total_reads / summary->duration_minutes;
+    if (summary->sensor_count > 0) {
+      summary->reads_per_sensor_per_minute = summary->total_reads_per_minute / summary->sensor_count;
+    }
+  }
+  return summary->run_id != NULL;
+}
+
+// Fill the signal statistics fields from acc
+static void apply_signal_stats(fast5_dataset_statistics_t *stats, const fast5_stats_accumulator_t *acc) {
+  stats->successful_files = acc->successful_files;
+  stats->total_reads = acc->total_reads;
+  stats->total_file_size_mb = acc->total_file_size_mb;
+  stats->total_samples = acc->total_samples;
+  stats->min_signal_length = acc->signal_length.count > 0 ? (uint32_t)acc->signal_length.min : UINT32_MAX;
+  stats->max_signal_length = acc->signal_length.count > 0 ? (uint32_t)acc->signal_length.max : 0;
+  stats->total_duration_seconds = acc->total_duration_seconds;
+
+  // Sketch values are clamped to the exact range
+  const fast5_moments_t *length = &acc->signal_length;
+  const fast5_moments_t *duration = &acc->duration;
+  stats->signal_length_mean = length->mean;
+  stats->signal_length_stddev = fast5_moments_stddev(length);
+  stats->signal_length_p10 = fmin(fmax(fast5_sketch_quantile(&acc->signal_length_sketch, 0.1), length->min), length->max);
+  stats->signal_length_median = fmin(fmax(fast5_sketch_quantile(&acc->signal_length_sketch, 0.5), length->min), length->max);
+  stats->signal_length_p90 = fmin(fmax(fast5_sketch_quantile(&acc->signal_length_sketch, 0.9), length->min), length->max);
+  stats->duration_stddev = fast5_moments_stddev(duration);
+  stats->duration_p10 = fmin(fmax(fast5_sketch_quantile(&acc->duration_sketch, 0.1), duration->min), duration->max);
+  stats->duration_median = fmin(fmax(fast5_sketch_quantile(&acc->duration_sketch, 0.5), duration->min), duration->max);
+  stats->duration_p90 = fmin(fmax(fast5_sketch_quantile(&acc->duration_sketch, 0.9), duration->min), duration->max);
+
+  // Signal QC, where the reads were scanned
+  stats->files_with_signal_stats = acc->files_with_signal_stats;
+  stats->reads_with_signal_stats = (int)acc->signal_mean.count;
+  if (acc->signal_mean.count > 0) {
+    stats->signal_mean = acc->signal_mean.mean;
+    stats->signal_mean_stddev = fast5_moments_stddev(&acc->signal_mean);
+    stats->signal_stddev = acc->signal_stddev.mean;
+    stats->signal_median = acc->signal_median.mean;
+    stats->signal_mad = acc->signal_mad.mean;
+    stats->events_per_second = acc->events_per_second.mean;
+    stats->events_per_read = (double)acc->signal_events / acc->signal_mean.count;
+    stats->clipped_samples = acc->clipped_samples;
+    stats->clipped_fraction = acc->scanned_samples > 0 ? (double)acc->clipped_samples / acc->scanned_samples : 0.0;
+    stats->reads_with_clipping = acc->reads_with_clipping;
+  }
+}
+
+fast5_dataset_statistics_t* calc_fast5_dataset_stats_from_accumulator(const fast5_stats_accumulator_t *acc) {
+  RETURN_NULL_IF(NULL == acc, NULL);
+  if (acc->failed) {
+    warnx("Dataset statistics are incomplete: memory ran out while gathering them");
+    return NULL;
+  }
+
+  fast5_dataset_statistics_t *stats = calloc(1, sizeof(fast5_dataset_statistics_t));
+  RETURN_NULL_IF(NULL == stats, NULL);
+
+  apply_signal_stats(stats, acc);
+  if (stats->total_reads == 0) {
+    stats->min_signal_length = 0;
+  }
+
+  // Sample rates
+  if (acc->sampling_rate.count > 0) {
+    stats->avg_sampling_rate = acc->sampling_rate.mean;
+    stats->min_sampling_rate = acc->sampling_rate.min;
+    stats->max_sampling_rate = acc->sampling_rate.max;
+    stats->has_uniform_rates = acc->sampling_rate.min == acc->sampling_rate.max;
+  }
+  stats->files_with_rate_variation = acc->files_with_rate_variation;
+
+  // Experiments, in run_id order
+  stats->total_files_with_temporal_data = acc->files_with_temporal_data;
+  size_t experiment_count = acc->experiments ? acc->experiments->count : 0;
+  if (experiment_count > 0) {
+    stats->experiments = calloc(experiment_count, sizeof(experiment_summary_t));
+    bool ok = stats->experiments != NULL;
+    for (size_t i = 0; ok && i < acc->experiments->capacity; i++) {
+      const stats_map_entry_t *entry = &acc->experiments->entries[i];
+      if (!entry->key) continue;
+      ok = summarise_experiment(&stats->experiments[stats->experiment_count++], entry->key,
+                                (const experiment_partial_t*)entry->value.pointer);
+    }
+    if (!ok) {
+      warnx("Memory allocation failed for experiment statistics");
+      free_fast5_dataset_stats(stats);
+      return NULL;
+    }
+    qsort(stats->experiments, experiment_count, sizeof(experiment_summary_t), compare_experiments);
+  }
+
+  const experiment_summary_t *peak = NULL;
+  double throughput_sum = 0.0;
+  for (int i = 0; i < stats->experiment_count; i++) {
+    const experiment_summary_t *experiment = &stats->experiments[i];
+    stats->total_experimental_time_minutes += experiment->duration_minutes;
+    if (experiment->sensor_count > 0) stats->experiments_with_sensor_data++;
+    if (experiment->reads_per_sensor_per_minute > 0) {
+      stats->experiments_with_throughput_data++;
+      throughput_sum += experiment->reads_per_sensor_per_minute;
+      if (!peak || experiment->reads_per_sensor_per_minute > peak->reads_per_sensor_per_minute) peak = experiment;
+    }
+  }
+  if (stats->total_experimental_time_minutes > 0) {
+    stats->global_reads_per_minute = stats->total_reads / stats->total_experimental_time_minutes;
+  }
+  if (peak) {
+    stats->avg_reads_per_sensor_per_minute = throughput_sum / stats->experiments_with_throughput_data;
+    stats->peak_throughput = peak->reads_per_sensor_per_minute;
+    stats->peak_throughput_experiment = strdup(peak->run_id);
+    if (!stats->peak_throughput_experiment) {
+      warnx("Memory allocation failed for experiment statistics");
+      free_fast5_dataset_stats(stats);
+      return NULL;
+    }
+  }
+  return stats;
+}
+
+void free_fast5_dataset_stats(fast5_dataset_statistics_t *stats) {
+  if (!stats) return;
+  for (int i = 0; i < stats->experiment_count; i++) {
+    experiment_summary_t *experiment = &stats->experiments[i];
+    for (int s = 0; s < experiment->sensor_count; s++) {
+      free(experiment->sensors[s].channel_number);
+      free(experiment->sensors[s].experiment_id);
+    }
+    free(experiment->sensors);
+    free(experiment->most_productive_sensor);
+    free(experiment->run_id);
+  }
+  free(stats->experiments);
+  free(stats->peak_throughput_experiment);
+  free(stats);
+}
+
+// Main calculation function that orchestrates all statistics (results already in memory)
 fast5_dataset_statistics_t* calc_fast5_dataset_stats_with_enhancer(fast5_metadata_t **results, 
                                                             int *results_count, 
                                                             char **filenames,
@@ -16,26 +1114,19 @@ fast5_dataset_statistics_t* calc_fast5_dataset_stats_with_enhancer(fast5_metadat
   RETURN_NULL_IF(NULL == results_count, NULL);
   RETURN_NULL_IF(NULL == filenames, NULL);
 
-  // Allocate statistics structure
-  fast5_dataset_statistics_t *stats = calloc(1, sizeof(fast5_dataset_statistics_t));
+  fast5_stats_accumulator_t acc;
+  fast5_stats_accumulator_init(&acc);
+  for (size_t i = 0; i < file_count; i++) {
+    fast5_stats_accumulator_add_file(&acc, filenames[i], results[i], results_count[i]);
+  }
+  fast5_dataset_statistics_t *stats = calc_fast5_dataset_stats_from_accumulator(&acc);
+  fast5_stats_accumulator_free(&acc);
   RETURN_NULL_IF(NULL == stats, NULL);
-  
-  // Initialize min_signal_length to handle edge case
-  stats->min_signal_length = UINT32_MAX;
-
-  // sequelizer enhancer
-  calc_signal_stats(stats, results, results_count, filenames, file_count);
 
   // *** CALL ENHANCER HERE - while signal dataset is open ***
   if (enhancer) {
     enhancer(stats, results, results_count, filenames, file_count);
   }
-
-  // Handle edge case where no reads were found
-  if (stats->total_reads == 0) {
-    stats->min_signal_length = 0;
-  }
-  
   return stats;  
 }
 
@@ -43,45 +1134,14 @@ fast5_dataset_statistics_t* calc_fast5_dataset_stats_with_enhancer(fast5_metadat
 void calc_signal_stats(fast5_dataset_statistics_t *stats, fast5_metadata_t **results, 
                                 int *results_count, char **filenames, size_t file_count) {
   if (!stats || !results || !results_count || !filenames) return;
-  
-  // Initialize statistical counters
-  stats->successful_files = 0;
-  stats->total_reads = 0;
-  stats->total_file_size_mb = 0.0;
-  stats->total_samples = 0;
-  stats->min_signal_length = UINT32_MAX;
-  stats->max_signal_length = 0;
-  stats->total_duration_seconds = 0.0;
-  
-  // Iterate through all results to calculate dataset-wide statistics
+
+  fast5_stats_accumulator_t acc;
+  fast5_stats_accumulator_init(&acc);
   for (size_t i = 0; i < file_count; i++) {
-    if (results[i] && results_count[i] > 0) { // File processed successfully
-      stats->successful_files++;
-      stats->total_reads += results_count[i];
-      stats->total_file_size_mb += get_file_size_mb(filenames[i]);
-      
-      // Calculate per-read signal statistics
-      for (int j = 0; j < results_count[i]; j++) {
-        uint32_t signal_length = results[i][j].signal_length;
-        stats->total_samples += signal_length;
-        
-        // Track signal length range
-        if (signal_length > 0) {
-          if (signal_length < stats->min_signal_length) {
-            stats->min_signal_length = signal_length;
-          }
-          if (signal_length > stats->max_signal_length) {
-            stats->max_signal_length = signal_length;
-          }
-        }
-        
-        // Convert duration from samples to seconds using sample rate
-        if (results[i][j].sample_rate > 0) {
-          stats->total_duration_seconds += (double)results[i][j].duration / results[i][j].sample_rate;
-        }
-      }
-    }
+    fast5_stats_accumulator_add_file(&acc, filenames[i], results[i], results_count[i]);
   }
+  apply_signal_stats(stats, &acc);
+  fast5_stats_accumulator_free(&acc);
 }
 
 // Calculate comprehensive summary with basic statistics (sequelizer level)
@@ -104,30 +1164,50 @@ fast5_analysis_summary_t* calc_analysis_summary_with_enhancer(fast5_dataset_stat
   summary->processing_time_ms     = processing_time_ms;
   summary->avg_duration_seconds   = stats->total_reads > 0 ? stats->total_duration_seconds / stats->total_reads : 0.0;
 
+  summary->signal_length_stddev   = stats->signal_length_stddev;
+  summary->signal_length_p10      = stats->signal_length_p10;
+  summary->signal_length_median   = stats->signal_length_median;
+  summary->signal_length_p90      = stats->signal_length_p90;
+  summary->duration_stddev        = stats->duration_stddev;
+  summary->duration_p10           = stats->duration_p10;
+  summary->duration_median        = stats->duration_median;
+  summary->duration_p90           = stats->duration_p90;
+
+  summary->reads_with_signal_stats = stats->reads_with_signal_stats;
+  summary->signal_mean            = stats->signal_mean;
+  summary->signal_mean_stddev     = stats->signal_mean_stddev;
+  summary->signal_stddev          = stats->signal_stddev;
+  summary->signal_median          = stats->signal_median;
+  summary->signal_mad             = stats->signal_mad;
+  summary->events_per_second      = stats->events_per_second;
+  summary->events_per_read        = stats->events_per_read;
+  summary->clipped_fraction       = stats->clipped_fraction;
+  summary->reads_with_clipping    = stats->reads_with_clipping;
+
   if (enhancer) {
     enhancer(summary, stats);
   } else {
-    // Initialize advanced fields to defaults (can be enhanced later)
+    // Compression and pore level need an enhancer; the rest comes from the accumulators
     summary->avg_compression_ratio = 0.0;
     summary->avg_effective_bits_per_sample = 0.0;
     summary->files_with_compression_stats = 0;
     summary->avg_median_before = 0.0;
     summary->files_with_pore_level_stats = 0;
-    summary->avg_sampling_rate = 0.0;
-    summary->min_sampling_rate = 0.0;
-    summary->max_sampling_rate = 0.0;
-    summary->files_with_rate_variation = 0;
-    summary->has_uniform_rates = false;
-    summary->experiment_count = 0;
-    summary->total_files_with_temporal_data = 0;
-    summary->total_experimental_time_minutes = 0.0;
-    summary->experiments_with_sensor_data = 0;
-    summary->experiments = NULL;
-    summary->global_reads_per_minute = 0.0;
-    summary->avg_reads_per_sensor_per_minute = 0.0;
-    summary->peak_throughput = 0.0;
-    summary->peak_throughput_experiment = NULL;
-    summary->experiments_with_throughput_data = 0;
+    summary->avg_sampling_rate = stats->avg_sampling_rate;
+    summary->min_sampling_rate = stats->min_sampling_rate;
+    summary->max_sampling_rate = stats->max_sampling_rate;
+    summary->files_with_rate_variation = stats->files_with_rate_variation;
+    summary->has_uniform_rates = stats->has_uniform_rates;
+    summary->experiment_count = stats->experiment_count;
+    summary->total_files_with_temporal_data = stats->total_files_with_temporal_data;
+    summary->total_experimental_time_minutes = stats->total_experimental_time_minutes;
+    summary->experiments_with_sensor_data = stats->experiments_with_sensor_data;
+    summary->experiments = stats->experiments;  // Still owned by stats
+    summary->global_reads_per_minute = stats->global_reads_per_minute;
+    summary->avg_reads_per_sensor_per_minute = stats->avg_reads_per_sensor_per_minute;
+    summary->peak_throughput = stats->peak_throughput;
+    summary->peak_throughput_experiment = stats->peak_throughput_experiment ? strdup(stats->peak_throughput_experiment) : NULL;
+    summary->experiments_with_throughput_data = stats->experiments_with_throughput_data;
   }
   return summary;
 }
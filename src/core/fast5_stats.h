@@ -8,6 +8,8 @@
 
 #include "../../include/sequelizer.h"
 #include "fast5_utils.h"  // fast5_metadata_t fast5_analysis_summary_t
+#include <stdint.h>
+#include <sys/stat.h>
 
 // Sensor analysis structure
 typedef struct {
@@ -87,10 +89,122 @@ typedef struct {
   double peak_throughput;                // Highest reads/sensor/minute found
   char *peak_throughput_experiment;      // run_id of most productive experiment
   int experiments_with_throughput_data;  // Experiments with valid duration > 0
+
+  // Distributions (from the streaming accumulators; quantiles within FAST5_SKETCH_ALPHA)
+  double signal_length_mean;             // Over reads with signal_length > 0
+  double signal_length_stddev;
+  double signal_length_p10;
+  double signal_length_median;
+  double signal_length_p90;
+  double duration_stddev;                // Seconds, over reads with a sample rate
+  double duration_p10;
+  double duration_median;
+  double duration_p90;
+
+  // Signal QC (--signal-stats): means over scanned reads of each read's value
+  int files_with_signal_stats;
+  int reads_with_signal_stats;
+  double signal_mean;                    // pA (ADC units for uncalibrated reads)
+  double signal_mean_stddev;             // Spread of the per-read means
+  double signal_stddev;
+  double signal_median;
+  double signal_mad;
+  double events_per_second;              // Over reads with a sample rate
+  double events_per_read;
+  uint64_t clipped_samples;
+  double clipped_fraction;               // Of all scanned samples
+  int reads_with_clipping;
   
   // Future statistics can be added here
 } fast5_dataset_statistics_t;
 
+// **********************************************************************
+// Streaming Accumulators
+// **********************************************************************
+// Each worker folds a file into its own accumulator as soon as it has been
+// read, so the metadata can be dropped straight away, and the partials are
+// merged once scanning ends. Memory is fixed per accumulator (plus one entry
+// per experiment and channel), whatever the number of reads.
+
+// Count, mean and variance (Welford), min and max
+typedef struct {
+  uint64_t count;
+  double mean;
+  double m2;               // Sum of squared deviations from the mean
+  double min;
+  double max;
+} fast5_moments_t;
+
+// Log-spaced buckets covering FAST5_SKETCH_MIN_VALUE up to ~1e12: any quantile
+// comes back within relative error FAST5_SKETCH_ALPHA, and two sketches merge
+// by adding buckets
+#define FAST5_SKETCH_ALPHA 0.01
+#define FAST5_SKETCH_MIN_VALUE 1e-4
+#define FAST5_SKETCH_BUCKETS 2048
+
+typedef struct {
+  uint64_t count;
+  uint64_t below_min;      // Values under FAST5_SKETCH_MIN_VALUE (reported as 0)
+  uint64_t buckets[FAST5_SKETCH_BUCKETS];
+} fast5_sketch_t;
+
+typedef struct fast5_stats_map fast5_stats_map_t;  // run_id -> experiment partial
+
+typedef struct {
+  int successful_files;    // Files with at least one read
+  int total_reads;
+  uint64_t total_samples;
+  double total_duration_seconds;
+  double total_file_size_mb;   // stat() of each file, taken by the worker that read it
+
+  fast5_moments_t signal_length;
+  fast5_sketch_t signal_length_sketch;
+  fast5_moments_t duration;
+  fast5_sketch_t duration_sketch;
+  fast5_moments_t sampling_rate;
+  int files_with_rate_variation;
+
+  int files_with_temporal_data;
+  fast5_stats_map_t *experiments;
+
+  // Signal QC of the reads that were scanned (--signal-stats)
+  int files_with_signal_stats;
+  fast5_moments_t signal_mean;
+  fast5_moments_t signal_stddev;
+  fast5_moments_t signal_median;
+  fast5_moments_t signal_mad;
+  fast5_moments_t events_per_second;
+  uint64_t scanned_samples;
+  uint64_t clipped_samples;
+  uint64_t signal_events;
+  int reads_with_clipping;
+
+  bool failed;             // Memory ran out: experiments or channels are missing
+} fast5_stats_accumulator_t;
+
+void fast5_moments_add(fast5_moments_t *moments, double value);
+void fast5_moments_merge(fast5_moments_t *dst, const fast5_moments_t *src);
+double fast5_moments_stddev(const fast5_moments_t *moments);
+
+void fast5_sketch_add(fast5_sketch_t *sketch, double value);
+void fast5_sketch_merge(fast5_sketch_t *dst, const fast5_sketch_t *src);
+double fast5_sketch_quantile(const fast5_sketch_t *sketch, double q);  // q in [0, 1]; 0 if empty
+
+void fast5_stats_accumulator_init(fast5_stats_accumulator_t *acc);
+void fast5_stats_accumulator_free(fast5_stats_accumulator_t *acc);
+
+// Fold in one file's reads (count <= 0 or NULL metadata: a failed file)
+void fast5_stats_accumulator_add_file(fast5_stats_accumulator_t *acc, const char *filename,
+                                      const fast5_metadata_t *metadata, int count);
+
+// dst += src; src is left as it was
+void fast5_stats_accumulator_merge(fast5_stats_accumulator_t *dst, const fast5_stats_accumulator_t *src);
+
+// Dataset statistics from a (merged) accumulator; free with free_fast5_dataset_stats().
+// NULL (with a warning) if the accumulator failed or memory runs out
+fast5_dataset_statistics_t* calc_fast5_dataset_stats_from_accumulator(const fast5_stats_accumulator_t *acc);
+
+void free_fast5_dataset_stats(fast5_dataset_statistics_t *stats);
 
 // enhancer function template for stats calculation
 typedef void (*stats_enhancer_t)(fast5_dataset_statistics_t *stats, fast5_metadata_t **results, 
@@ -114,4 +228,54 @@ void calc_signal_stats(fast5_dataset_statistics_t *stats, fast5_metadata_t **res
 // Main analysis summary calculation function
 fast5_analysis_summary_t* calc_analysis_summary_with_enhancer(fast5_dataset_statistics_t *stats, int file_count, double processing_time_ms, summary_enhancer_t enhancer);
 
+// **********************************************************************
+// Per-File Summary Cache
+// **********************************************************************
+// Each file's accumulator, serialised compactly and keyed by path + size +
+// mtime, so a rescan of a run folder only opens files that are new or have
+// changed since the cache was written. The file is in host byte order (it is
+// a local speed-up, not an interchange format) and is replaced atomically on
+// save.
+
+#define FAST5_STATS_CACHE_DEFAULT_PATH "sequelizer_fast5.cache"
+
+typedef struct fast5_stats_cache fast5_stats_cache_t;
+
+typedef enum {
+  FAST5_CACHE_MISS,        // Never seen (or removed)
+  FAST5_CACHE_STALE,       // Seen with a different size or mtime
+  FAST5_CACHE_HIT          // Unchanged; its statistics were merged
+} fast5_cache_status_t;
+
+// Entries from path if it exists (an unreadable cache is ignored with a warning);
+// NULL (with a warning) if memory runs out
+fast5_stats_cache_t* fast5_stats_cache_load(const char *path);
+bool fast5_stats_cache_save(const fast5_stats_cache_t *cache, const char *path);
+void fast5_stats_cache_free(fast5_stats_cache_t *cache);
+
+// On a hit, merge the cached partial into acc and set *reads. Hit or stale,
+// the file counts as seen by the current scan. Once signal QC is required,
+// entries stored without it are stale
+fast5_cache_status_t fast5_stats_cache_lookup(fast5_stats_cache_t *cache, const char *filename,
+                                              const struct stat *st, fast5_stats_accumulator_t *acc, int *reads);
+
+void fast5_stats_cache_require_signal_stats(fast5_stats_cache_t *cache, bool required);
+
+// Remember file_stats (one file's accumulator) for filename as of st; out of memory
+// (with a warning) it is left uncached and simply read again next time
+void fast5_stats_cache_store(fast5_stats_cache_t *cache, const char *filename, const struct stat *st,
+                             const fast5_stats_accumulator_t *file_stats);
+
+// Forget filename; false if it was not cached
+bool fast5_stats_cache_remove(fast5_stats_cache_t *cache, const char *filename);
+
+// Full rescans: begin, look up or store every file found, then sweep away
+// (and count) the entries of files that were not seen
+void fast5_stats_cache_begin_scan(fast5_stats_cache_t *cache);
+size_t fast5_stats_cache_sweep(fast5_stats_cache_t *cache);
+
+// Merge every cached file into acc (rebuilds totals after a change or removal)
+void fast5_stats_cache_merge_all(const fast5_stats_cache_t *cache, fast5_stats_accumulator_t *acc);
+size_t fast5_stats_cache_count(const fast5_stats_cache_t *cache);
+
 #endif //SEQUELIZER_FAST5_STATS_H
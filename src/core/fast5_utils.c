@@ -61,14 +61,45 @@ void print_comprehensive_summary_human(fast5_analysis_summary_t *summary) {
     if (summary->min_signal_length > 0 && summary->max_signal_length > 0) {
       printf("  Range: %u - %u samples\n", summary->min_signal_length, summary->max_signal_length);
     }
+    if (summary->signal_length_median > 0) {
+      printf("  Length p10 / median / p90: %.0f / %.0f / %.0f samples (std dev %.0f)\n",
+             summary->signal_length_p10, summary->signal_length_median, summary->signal_length_p90,
+             summary->signal_length_stddev);
+    }
     if (summary->avg_bits_per_sample > 0) {
       printf("  Average bits per sample: %.2f\n", summary->avg_bits_per_sample);
     }
     if (summary->total_duration_seconds > 0) {
       printf("  Total duration: %.1f minutes\n", summary->total_duration_seconds/60);
       printf("  Avg duration: %.1f seconds\n", summary->avg_duration_seconds);
+      printf("  Duration p10 / median / p90: %.2f / %.2f / %.2f seconds (std dev %.2f)\n",
+             summary->duration_p10, summary->duration_median, summary->duration_p90,
+             summary->duration_stddev);
     }
   }
+
+  if (summary->reads_with_signal_stats > 0) {
+    printf("Signal QC (%d reads scanned):\n", summary->reads_with_signal_stats);
+    printf("  Mean: %.2f pA (std dev %.2f within reads, %.2f across reads)\n",
+           summary->signal_mean, summary->signal_stddev, summary->signal_mean_stddev);
+    printf("  Median: %.2f pA (MAD %.2f)\n", summary->signal_median, summary->signal_mad);
+    printf("  Events: %.0f per read", summary->events_per_read);
+    if (summary->events_per_second > 0) {
+      printf(" (%.1f per second)", summary->events_per_second);
+    }
+    printf("\n");
+    printf("  Clipped samples: %.4f%% (%d reads clipped)\n",
+           summary->clipped_fraction * 100.0, summary->reads_with_clipping);
+  }
+
+  if (summary->experiment_count > 0) {
+    printf("Experiments: %d", summary->experiment_count);
+    if (summary->total_experimental_time_minutes > 0) {
+      printf(" (%.1f minutes of acquisition, %.1f reads/minute)",
+             summary->total_experimental_time_minutes, summary->global_reads_per_minute);
+    }
+    printf("\n");
+  }
   
   if (summary->processing_time_ms > 0) {
     printf("Processing time: %.2f seconds", summary->processing_time_ms / 1000.0);
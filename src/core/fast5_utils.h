@@ -24,7 +24,7 @@ typedef struct {
     bool is_multi_read;
     char *file_path;
     // Storage analysis fields
-    char *compression_method;        // "deflate-gzip", "szip", "none"
+    char *compression_method;        // "deflate-gzip", "vbz", "szip", "none" (set when the signal is loaded)
     size_t logical_bytes;            // Uncompressed size of signal data  
     size_t datatype_size;            // Bytes per sample (2 for int16)
     double logical_bits_per_sample;  // logical_bytes * 8 / signal_length
@@ -43,6 +43,15 @@ typedef struct {
     double range;                    // Full scale range in picoamperes
     double digitisation;             // ADC resolution (typically 8192)
     bool calibration_available;      // Whether calibration data was found
+    // Signal QC fields (--signal-stats; pA when calibration_available, else ADC units)
+    double signal_mean;
+    double signal_stddev;
+    double signal_median;
+    double signal_mad;               // Median absolute deviation (not scaled to a stddev)
+    uint32_t clipped_low;            // Samples on or below the ADC's lower rail
+    uint32_t clipped_high;           // Samples on or above the upper rail
+    uint32_t event_count;            // Segments found by the t-test event detector
+    bool signal_stats_available;     // Whether the signal was scanned
 } fast5_metadata_t;
 
 // Basic summary for simple reporting (no compression analysis)
@@ -75,6 +84,26 @@ typedef struct {
   double total_duration_seconds;
   double avg_duration_seconds;
   double avg_bits_per_sample;
+  // Distributions (streaming sketches, ~1% relative error)
+  double signal_length_stddev;
+  double signal_length_p10;
+  double signal_length_median;
+  double signal_length_p90;
+  double duration_stddev;
+  double duration_p10;
+  double duration_median;
+  double duration_p90;
+  // Signal QC (--signal-stats): per-read values averaged over scanned reads
+  int reads_with_signal_stats;
+  double signal_mean;
+  double signal_mean_stddev;
+  double signal_stddev;
+  double signal_median;
+  double signal_mad;
+  double events_per_second;
+  double events_per_read;
+  double clipped_fraction;
+  int reads_with_clipping;
   // Compression statistics
   double avg_compression_ratio;
   double avg_effective_bits_per_sample;
@@ -10,32 +10,18 @@
 #include <string.h>
 #include <math.h>     // for pow()
 #include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>    // for open()
+#include <unistd.h>   // for close(), getpid()
+#include <sys/mman.h> // for mmap()
+#include <sys/stat.h>
 
-kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name) {
-    // Try each filename in order
-    const char *filenames[] = {
-        "9mer_levels_v1.txt",
-        "5mer_levels_v1.txt",
-        "template_median68pA.model",
-        "template_median69pA.model",
-        NULL
-    };
-
-    char filepath[1024];
-    FILE *fp = NULL;
-
-    for (int i = 0; filenames[i] != NULL; i++) {
-        snprintf(filepath, sizeof(filepath), "%s/%s/%s",
-                 models_dir, model_name, filenames[i]);
-        fp = fopen(filepath, "r");
-        if (fp) break;
-    }
-
-    if (!fp) {
-        warnx("Could not find k-mer model in %s/%s", models_dir, model_name);
-        return NULL;
-    }
+// **********************************************************************
+// Text Model Parsing
+// **********************************************************************
 
+// Parse an open text model file (modern "kmer level" or legacy 7-column format)
+static kmer_model_t* parse_kmer_model_file(FILE *fp, const char *model_name) {
     // Allocate struct
     kmer_model_t *model = calloc(1, sizeof(kmer_model_t));
     if (!model) {
@@ -60,6 +46,8 @@ kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name) {
     }
 
     bool is_legacy = (strncmp(line, "kmer", 4) == 0);
+    // Some legacy tables (r9.4 450 bps) leave ig_lambda out: kmer level_mean level_stdv sd_mean sd_stdv weight
+    bool has_ig_lambda = is_legacy && strstr(line, "ig_lambda") != NULL;
 
     // Read first k-mer to determine size
     char first_kmer[32];
@@ -148,8 +136,10 @@ kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name) {
         char kmer_str[32];
         size_t i = 0;
         while (fgets(line, sizeof(line), fp) && i < num_kmers) {
-            // Try full 7-column parse
-            int n = sscanf(line, "%s %f %f %f %f %f %f",
+            int n;
+            if (has_ig_lambda) {
+                // Try full 7-column parse
+                n = sscanf(line, "%s %f %f %f %f %f %f",
                            kmer_str,
                            &model->level_mean[i],
                            &model->level_stddev[i],
@@ -157,6 +147,20 @@ kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name) {
                            &model->sd_stdv[i],
                            &model->ig_lambda[i],
                            &model->weight[i]);
+            } else {
+                n = sscanf(line, "%s %f %f %f %f %f",
+                           kmer_str,
+                           &model->level_mean[i],
+                           &model->level_stddev[i],
+                           &model->sd_mean[i],
+                           &model->sd_stdv[i],
+                           &model->weight[i]);
+                // Inverse Gaussian shape from its mean and stddev: sd_stdv^2 = sd_mean^3 / ig_lambda
+                if (model->sd_stdv[i] > 0.0f) {
+                    model->ig_lambda[i] = model->sd_mean[i] * model->sd_mean[i] * model->sd_mean[i] /
+                                          (model->sd_stdv[i] * model->sd_stdv[i]);
+                }
+            }
 
             if (n < 3) {  // Minimum: kmer, level_mean, level_stddev
                 warnx("Parse error at legacy line %zu (got %d columns)", i + 1, n);
@@ -179,10 +183,238 @@ kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name) {
     return model;
 }
 
+// **********************************************************************
+// Binary Model Cache
+// **********************************************************************
+
+#define KMER_CACHE_MAGIC     "SQKMODEL"
+#define KMER_CACHE_VERSION   2   // 2: ig_lambda derived for tables without the column
+#define KMER_CACHE_ALIGNMENT 64
+#define KMER_CACHE_ARRAYS    6   // level_mean, level_stddev, sd_mean, sd_stdv, ig_lambda, weight
+
+// Header at the start of the cache file; every array starts on a 64-byte boundary
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;                       // 0x01020304 as written by the host
+    uint32_t kmer_size;
+    uint32_t flags;                            // Bit i set: array i present
+    uint64_t num_kmers;
+    float default_stddev;
+    uint32_t reserved;
+    int64_t source_mtime;                      // Text model the cache was compiled from
+    int64_t source_size;
+    uint64_t source_hash;                      // FNV-1a of the text model contents
+    uint64_t offsets[KMER_CACHE_ARRAYS];       // File offset of each array (0 = absent)
+} kmer_cache_header_t;
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Array slot i of a model (same order as the header offsets)
+static float** model_array(kmer_model_t *model, int i) {
+    switch (i) {
+        case 0: return &model->level_mean;
+        case 1: return &model->level_stddev;
+        case 2: return &model->sd_mean;
+        case 3: return &model->sd_stdv;
+        case 4: return &model->ig_lambda;
+        default: return &model->weight;
+    }
+}
+
+// FNV-1a over the whole file (only needed when mtime/size no longer match)
+static bool hash_file(const char *path, uint64_t *hash) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+
+    unsigned char buffer[65536];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            h ^= buffer[i];
+            h *= 0x100000001b3ULL;
+        }
+    }
+    bool ok = !ferror(fp);
+    fclose(fp);
+    *hash = h;
+    return ok;
+}
+
+// Map a cache file and point the model arrays into it; NULL if missing, stale or corrupt
+static kmer_model_t* map_kmer_model_cache(const char *cache_path, const char *source_path,
+                                          const struct stat *source_stat, const char *model_name) {
+    int fd = open(cache_path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat cache_stat;
+    if (fstat(fd, &cache_stat) != 0 || (size_t)cache_stat.st_size < sizeof(kmer_cache_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t mapping_size = (size_t)cache_stat.st_size;
+    void *mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return NULL;
+
+    const kmer_cache_header_t *header = (const kmer_cache_header_t*)mapping;
+    bool valid = memcmp(header->magic, KMER_CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == KMER_CACHE_VERSION &&
+                 header->byte_order == 0x01020304 &&
+                 header->kmer_size > 0 && header->kmer_size <= 12 &&
+                 header->num_kmers == ((uint64_t)1 << (2 * header->kmer_size)) &&
+                 (header->flags & 1) &&
+                 header->source_size == (int64_t)source_stat->st_size;
+
+    // Unchanged mtime is trusted; a touched or copied model is accepted if its contents hash the same
+    if (valid && header->source_mtime != (int64_t)source_stat->st_mtime) {
+        uint64_t hash;
+        valid = hash_file(source_path, &hash) && hash == header->source_hash;
+    }
+
+    size_t array_bytes = header->num_kmers * sizeof(float);
+    for (int i = 0; valid && i < KMER_CACHE_ARRAYS; i++) {
+        if (!(header->flags & (1u << i))) continue;
+        uint64_t offset = header->offsets[i];
+        valid = offset % KMER_CACHE_ALIGNMENT == 0 && offset >= sizeof(kmer_cache_header_t) &&
+                offset + array_bytes <= mapping_size;
+    }
+
+    kmer_model_t *model = valid ? calloc(1, sizeof(kmer_model_t)) : NULL;
+    if (model) model->name = strdup(model_name);
+    if (!model || !model->name) {
+        free(model);
+        munmap(mapping, mapping_size);
+        return NULL;
+    }
+
+    model->kmer_size = (int)header->kmer_size;
+    model->num_kmers = (size_t)header->num_kmers;
+    model->default_stddev = header->default_stddev;
+    for (int i = 0; i < KMER_CACHE_ARRAYS; i++) {
+        if (header->flags & (1u << i)) {
+            *model_array(model, i) = (float*)((char*)mapping + header->offsets[i]);
+        }
+    }
+    model->mapping = mapping;
+    model->mapping_size = mapping_size;
+    return model;
+}
+
+// Compile a parsed model to cache_path (tmp file + rename so readers never see a partial file)
+static int write_kmer_model_cache(const kmer_model_t *model, const char *cache_path,
+                                  const char *source_path, const struct stat *source_stat) {
+    kmer_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, KMER_CACHE_MAGIC, sizeof(header.magic));
+    header.version = KMER_CACHE_VERSION;
+    header.byte_order = 0x01020304;
+    header.kmer_size = (uint32_t)model->kmer_size;
+    header.num_kmers = model->num_kmers;
+    header.default_stddev = model->default_stddev;
+    header.source_mtime = (int64_t)source_stat->st_mtime;
+    header.source_size = (int64_t)source_stat->st_size;
+    if (!hash_file(source_path, &header.source_hash)) return -1;
+
+    size_t array_bytes = model->num_kmers * sizeof(float);
+    size_t offset = align_up(sizeof(header), KMER_CACHE_ALIGNMENT);
+    for (int i = 0; i < KMER_CACHE_ARRAYS; i++) {
+        if (*model_array((kmer_model_t*)model, i)) {
+            header.flags |= 1u << i;
+            header.offsets[i] = offset;
+            offset = align_up(offset + array_bytes, KMER_CACHE_ALIGNMENT);
+        }
+    }
+
+    char tmp_path[1100];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%d", cache_path, (int)getpid());
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) return -1;
+
+    static const char padding[KMER_CACHE_ALIGNMENT] = {0};
+    size_t position = fwrite(&header, 1, sizeof(header), fp);
+    bool ok = position == sizeof(header);
+    for (int i = 0; ok && i < KMER_CACHE_ARRAYS; i++) {
+        if (!header.offsets[i]) continue;
+        ok = fwrite(padding, 1, header.offsets[i] - position, fp) == header.offsets[i] - position &&
+             fwrite(*model_array((kmer_model_t*)model, i), sizeof(float), model->num_kmers, fp) == model->num_kmers;
+        position = header.offsets[i] + array_bytes;
+    }
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp_path, cache_path) != 0) {
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// **********************************************************************
+// Public API
+// **********************************************************************
+
+kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name) {
+    // Try each filename in order
+    const char *filenames[] = {
+        "9mer_levels_v1.txt",
+        "5mer_levels_v1.txt",
+        "template_median68pA.model",
+        "template_median69pA.model",
+        NULL
+    };
+
+    char filepath[1024];
+    FILE *fp = NULL;
+
+    for (int i = 0; filenames[i] != NULL; i++) {
+        snprintf(filepath, sizeof(filepath), "%s/%s/%s",
+                 models_dir, model_name, filenames[i]);
+        fp = fopen(filepath, "r");
+        if (fp) break;
+    }
+
+    if (!fp) {
+        warnx("Could not find k-mer model in %s/%s", models_dir, model_name);
+        return NULL;
+    }
+
+    // Compiled cache next to the text model: mmap it when it still matches the source
+    char cache_path[1024];
+    snprintf(cache_path, sizeof(cache_path), "%s/%s/%s", models_dir, model_name, KMER_MODEL_CACHE_NAME);
+
+    struct stat source_stat;
+    bool have_stat = fstat(fileno(fp), &source_stat) == 0;
+    if (have_stat) {
+        kmer_model_t *cached = map_kmer_model_cache(cache_path, filepath, &source_stat, model_name);
+        if (cached) {
+            fclose(fp);
+            return cached;
+        }
+    }
+
+    kmer_model_t *model = parse_kmer_model_file(fp, model_name);
+
+    // Compile for the next load; failure (e.g. read-only models dir) just means parsing again next time
+    if (model && have_stat) {
+        write_kmer_model_cache(model, cache_path, filepath, &source_stat);
+    }
+    return model;
+}
+
 void free_kmer_model(kmer_model_t *model) {
     if (!model) return;
 
     free(model->name);
+    if (model->mapping) {
+        // Arrays point into the shared mapping
+        munmap(model->mapping, model->mapping_size);
+        free(model);
+        return;
+    }
     free(model->level_mean);
     free(model->level_stddev);
     free(model->sd_mean);
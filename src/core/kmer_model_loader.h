@@ -9,6 +9,10 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+// Compiled binary copy of a text model, written next to it on first load and
+// mmap'd on later loads (shared across processes) while the source is unchanged
+#define KMER_MODEL_CACHE_NAME ".sequelizer_kmer_model.bin"
+
 // LOAD k-mer model data structure
 typedef struct {
   char *name;                // Model identifier
@@ -21,17 +25,22 @@ typedef struct {
   float *level_stddev;       // Array[num_kmers] or NULL if not in file
   float default_stddev;      // Used when level_stddev == NULL (1.5)
     
-  // Legacy extras (parsed but unused initially)
+  // Legacy extras: the per-event noise level is inverse Gaussian, IG(sd_mean, ig_lambda)
   float *sd_mean;            // NULL if not present
   float *sd_stdv;
-  float *ig_lambda;
+  float *ig_lambda;          // sd_mean^3 / sd_stdv^2 when the file has no ig_lambda column
   float *weight;
     
   size_t num_kmers;          // 4^kmer_size
+
+  // Set when the arrays live in a read-only mapping of the binary cache
+  void *mapping;
+  size_t mapping_size;
 } kmer_model_t;
 
 // Load model given base directory and model name
-// Constructs full path and auto-detects file format
+// Constructs full path and auto-detects file format; uses the binary cache when valid
+// (arrays are then read-only)
 kmer_model_t* load_kmer_model(const char *models_dir, const char *model_name);
 
 // Free a loaded model
@@ -5,9 +5,17 @@
 //
 
 #include "plot_utils.h"
+#include "fast5_index.h"
+#include "fast5_io.h"
+#include "signal_pyramid.h"
+#include "seq_memory.h"
+#include <err.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // **********************************************************************
 // File Format Detection
@@ -97,138 +105,557 @@ file_format_t detect_plot_file_format(FILE *fp) {
   return FILE_FORMAT_UNKNOWN;
 }
 
+// **********************************************************************
+// Input Mapping
+// **********************************************************************
+// The unread part of a stream as one contiguous block of text
+typedef struct {
+  const char *data;
+  size_t length;
+  void *map;          // mmap'd region (regular files)
+  size_t map_length;
+  char *copy;         // Heap copy (pipes and other non-mappable streams)
+  size_t copy_capacity;
+} text_view_t;
+
+// Over the --max-memory budget: move the copy so far and the rest of the stream
+// to an (already unlinked) temporary file and map that instead
+static bool spill_view(FILE *fp, text_view_t *view) {
+  FILE *spill = tmpfile();
+  if (!spill) return false;
+  bool ok = fwrite(view->copy, 1, view->length, spill) == view->length;
+  size_t got;
+  while (ok && (got = fread(view->copy, 1, view->copy_capacity, fp)) > 0) {
+    ok = fwrite(view->copy, 1, got, spill) == got;
+    view->length += got;
+  }
+  ok = ok && fflush(spill) == 0;
+  free(view->copy);
+  seq_memory_release(view->copy_capacity);
+  view->copy = NULL;
+  view->copy_capacity = 0;
+
+  void *map = MAP_FAILED;
+  if (ok && view->length > 0) {
+    map = mmap(NULL, view->length, PROT_READ, MAP_PRIVATE, fileno(spill), 0);
+  }
+  fclose(spill);   // The mapping keeps the data
+  if (view->length == 0) {
+    view->data = "";
+    return ok;
+  }
+  if (map == MAP_FAILED) return false;
+  madvise(map, view->length, MADV_SEQUENTIAL);
+  view->map = map;
+  view->map_length = view->length;
+  view->data = map;
+  return true;
+}
+
+// Map the stream from its current position (falls back to reading it into
+// memory, or into a temporary file once that would pass the memory budget)
+static bool view_stream(FILE *fp, text_view_t *view) {
+  memset(view, 0, sizeof(*view));
+  long offset = ftell(fp);
+  struct stat st;
+
+  if (offset >= 0 && fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode)) {
+    if ((off_t)offset >= st.st_size) {
+      view->data = "";
+      return true;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (map != MAP_FAILED) {
+      madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+      view->map = map;
+      view->map_length = (size_t)st.st_size;
+      view->data = (const char *)map + offset;
+      view->length = (size_t)st.st_size - (size_t)offset;
+      return true;
+    }
+  }
+
+  size_t capacity = 1 << 16;
+  view->copy = malloc(capacity);
+  if (!view->copy) return false;
+  view->copy_capacity = capacity;
+  seq_memory_reserve(capacity);
+  size_t got;
+  while ((got = fread(view->copy + view->length, 1, capacity - view->length, fp)) > 0) {
+    view->length += got;
+    if (view->length == capacity) {
+      if (seq_memory_available() < capacity) return spill_view(fp, view);
+      char *grown = realloc(view->copy, capacity * 2);
+      if (!grown) {
+        free(view->copy);
+        seq_memory_release(view->copy_capacity);
+        return false;
+      }
+      seq_memory_reserve(capacity);
+      view->copy = grown;
+      view->copy_capacity = capacity *= 2;
+    }
+  }
+  view->data = view->copy;
+  return true;
+}
+
+static void release_view(text_view_t *view) {
+  if (view->map) munmap(view->map, view->map_length);
+  free(view->copy);
+  seq_memory_release(view->copy_capacity);
+}
+
+// Upper bound on the number of lines (used to size arrays and buckets up front)
+static size_t count_lines(const char *p, const char *end) {
+  size_t lines = 0;
+  while (p < end && (p = memchr(p, '\n', (size_t)(end - p)))) {
+    lines++;
+    p++;
+  }
+  return lines + 1;
+}
+
+// **********************************************************************
+// Numeric Scanning
+// **********************************************************************
+static inline bool is_blank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool is_digit(char c) {
+  return (unsigned)(c - '0') < 10;
+}
+
+static inline const char* skip_blanks(const char *p, const char *end) {
+  while (p < end && is_blank(*p)) p++;
+  return p;
+}
+
+// Lines whose first field is not a number are comments, headers or console output
+static inline bool starts_number(const char *p, const char *end) {
+  return p < end && (is_digit(*p) || *p == '-' || *p == '+' || *p == '.');
+}
+
+// Unsigned decimal integer
+static bool scan_size(const char **pp, const char *end, size_t *out) {
+  const char *p = *pp;
+  size_t value = 0;
+  if (p == end || !is_digit(*p)) return false;
+  for (; p < end && is_digit(*p); p++) value = value * 10 + (size_t)(*p - '0');
+  *out = value;
+  *pp = p;
+  return true;
+}
+
+// Decimal float. With up to 15 significant digits and |exponent| <= 22 the
+// double conversion is correctly rounded; anything longer goes through strtof
+static bool scan_float(const char **pp, const char *end, float *out) {
+  static const double powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const char *p = *pp;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+  uint64_t mantissa = 0;
+  int significant = 0, exponent = 0;
+  bool any_digits = false;
+  for (; p < end && is_digit(*p); p++, any_digits = true) {
+    if (mantissa || *p != '0') significant++;
+    mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && is_digit(*p); p++, any_digits = true) {
+      if (mantissa || *p != '0') significant++;
+      mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+      exponent--;
+    }
+  }
+  if (!any_digits) return false;
+  bool simple = significant <= 15;
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *q = p + 1;
+    bool exp_negative = false;
+    if (q < end && (*q == '-' || *q == '+')) exp_negative = (*q++ == '-');
+    if (q < end && is_digit(*q)) {
+      int e = 0;
+      for (; q < end && is_digit(*q); q++) {
+        if (e < 10000) e = e * 10 + (*q - '0');
+      }
+      exponent += exp_negative ? -e : e;
+      p = q;
+    }
+  }
+
+  if (simple && exponent >= -22 && exponent <= 22) {
+    double value = (double)mantissa;
+    value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+    *out = (float)(negative ? -value : value);
+  } else {
+    char token[64];
+    size_t len = (size_t)(p - *pp);
+    if (len >= sizeof(token)) return false;
+    memcpy(token, *pp, len);
+    token[len] = '\0';
+    *out = strtof(token, NULL);
+  }
+  *pp = p;
+  return true;
+}
+
+// One raw line: "index<TAB or space>value" or a bare value (indexed by position)
+static bool parse_raw_line(const char *p, const char *eol, size_t auto_index, size_t *index, float *value) {
+  p = skip_blanks(p, eol);
+  if (!starts_number(p, eol)) return false;
+
+  const char *q = p;
+  if (scan_size(&q, eol, index) && q < eol && is_blank(*q)) {
+    const char *r = skip_blanks(q, eol);
+    if (starts_number(r, eol) && scan_float(&r, eol, value)) return true;
+  }
+
+  q = p;
+  if (!scan_float(&q, eol, value)) return false;
+  *index = auto_index;
+  return true;
+}
+
+// One squiggle line: pos, base, current, sd, dwell
+static bool parse_squiggle_line(const char *p, const char *eol, squiggle_data_t *row) {
+  p = skip_blanks(p, eol);
+  if (!scan_size(&p, eol, &row->pos)) return false;
+  p = skip_blanks(p, eol);
+  if (p == eol) return false;
+  row->base = *p++;
+  float *fields[3] = {&row->current, &row->sd, &row->dwell};
+  for (int f = 0; f < 3; f++) {
+    p = skip_blanks(p, eol);
+    if (!scan_float(&p, eol, fields[f])) return false;
+  }
+  return true;
+}
+
+// **********************************************************************
+// Min/Max Decimation
+// **********************************************************************
+size_t plot_bucket_size(size_t total_points, size_t buckets) {
+  if (buckets == 0 || total_points <= 2 * buckets) return 1;
+  return (total_points + buckets - 1) / buckets;
+}
+
+bool plot_decimator_init(plot_decimator_t *dec, size_t bucket_size, size_t expected_points) {
+  memset(dec, 0, sizeof(*dec));
+  dec->bucket_size = bucket_size;
+  if (bucket_size > 1) {
+    expected_points = 2 * ((expected_points + bucket_size - 1) / bucket_size) + 2;
+  }
+  dec->capacity = expected_points > 16 ? expected_points : 16;
+  dec->points = malloc(dec->capacity * sizeof(raw_data_t));
+  return dec->points != NULL;
+}
+
+static bool append_point(plot_decimator_t *dec, raw_data_t point) {
+  if (dec->count == dec->capacity) {
+    raw_data_t *grown = realloc(dec->points, dec->capacity * 2 * sizeof(raw_data_t));
+    if (!grown) return false;
+    dec->points = grown;
+    dec->capacity *= 2;
+  }
+  dec->points[dec->count++] = point;
+  return true;
+}
+
+static bool flush_bucket(plot_decimator_t *dec) {
+  if (dec->in_bucket == 0) return true;
+  dec->in_bucket = 0;
+  raw_data_t first = dec->lo, second = dec->hi;
+  if (second.sample_index < first.sample_index) {
+    first = dec->hi;
+    second = dec->lo;
+  }
+  if (!append_point(dec, first)) return false;
+  return first.sample_index == second.sample_index || append_point(dec, second);
+}
+
+bool plot_decimator_push(plot_decimator_t *dec, size_t index, float value) {
+  raw_data_t point = {index, value};
+  if (dec->bucket_size <= 1) return append_point(dec, point);
+
+  if (dec->in_bucket == 0) {
+    dec->lo = dec->hi = point;
+  } else if (value < dec->lo.raw_value) {
+    dec->lo = point;
+  } else if (value > dec->hi.raw_value) {
+    dec->hi = point;
+  }
+  if (++dec->in_bucket == dec->bucket_size) return flush_bucket(dec);
+  return true;
+}
+
+bool plot_decimator_finish(plot_decimator_t *dec) {
+  return flush_bucket(dec);
+}
+
 // **********************************************************************
 // Data Parsing
 // **********************************************************************
-// Read text file line-by-line, converts text to raw_data_t in mem, handles multiple formats, returns array of raw_data_t structs
+// Scan mapped text into raw_data_t points, handles multiple formats, returns the point count
 // can handle: 2-col tab-separated (0\t356\n1\t260\n2\t258), 2-col space-separted, 1-col w/ auto-indexing (356\n260\n258)
-int parse_raw_file(FILE *fp, raw_data_t **out_data) {
+ssize_t parse_raw_file_decimated(FILE *fp, size_t buckets, raw_data_t **out_data, size_t *total_points) {
   // ========================================================================
-  // STEP 1: ALLOCATE INITIAL DATA ARRAY WITH DYNAMIC CAPACITY
+  // STEP 1: MAP INPUT AND SIZE THE OUTPUT (ONE ALLOCATION, NO REGROWTH)
   // ========================================================================
-  char line[1024];
-  int data_count = 0;
-  int capacity = 10000;
-  raw_data_t *data = malloc(capacity * sizeof(raw_data_t));
+  text_view_t view;
+  if (!view_stream(fp, &view)) {
+    fprintf(stderr, "Memory allocation failed\n");
+    return -1;
+  }
+  const char *p = view.data;
+  const char *end = view.data + view.length;
+  size_t lines = count_lines(p, end);
+
+  // Every point would not fit the memory budget: keep min/max pairs that do
+  size_t fit_points = seq_memory_available() / sizeof(raw_data_t);
+  if (buckets == 0 && lines > fit_points) {
+    buckets = fit_points / 2 > 0 ? fit_points / 2 : 1;
+    warnx("%zu points exceed the memory budget; decimating to %zu min/max pairs", lines, buckets);
+  }
 
-  if (!data) {
+  plot_decimator_t dec;
+  if (!plot_decimator_init(&dec, plot_bucket_size(lines, buckets), lines)) {
     fprintf(stderr, "Memory allocation failed\n");
+    release_view(&view);
     return -1;
   }
 
   // ========================================================================
-  // STEP 2: READ FILE LINE-BY-LINE AND PARSE NUMERIC DATA
+  // STEP 2: SCAN LINES IN PLACE (SKIPPING COMMENTS AND HEADERS)
   // ========================================================================
-  while (fgets(line, sizeof(line), fp)) {
-    // Skip comments and headers
-    if (line[0] == '#' || strstr(line, "Channel:") ||
-        strstr(line, "Sample Rate:") || strstr(line, "Read ID:") ||
-        strstr(line, "sample_index") || strstr(line, "Sample Index")) {
-      continue;
-    }
-
-    // Skip empty lines
-    if (line[0] == '\n') {
-      continue;
-    }
-
-    // ========================================================================
-    // STEP 3: TRY MULTIPLE PARSING STRATEGIES (TAB, SPACE, SINGLE-COLUMN)
-    // ========================================================================
-    // Try to parse as tab-separated values first
-    if (sscanf(line, "%d\t%f", &data[data_count].sample_index, &data[data_count].raw_value) == 2) {
-      data_count++;
-    }
-    // If tab-separated fails, try space-separated or just raw values
-    else if (sscanf(line, "%d %f", &data[data_count].sample_index, &data[data_count].raw_value) == 2) {
-      data_count++;
-    }
-    // If no index, assume sequential indexing (just raw values)
-    else if (sscanf(line, "%f", &data[data_count].raw_value) == 1) {
-      data[data_count].sample_index = data_count;
-      data_count++;
+  size_t parsed = 0;
+  bool ok = true;
+  while (ok && p < end) {
+    const char *eol = memchr(p, '\n', (size_t)(end - p));
+    if (!eol) eol = end;
+
+    size_t index;
+    float value;
+    if (parse_raw_line(p, eol, parsed, &index, &value)) {
+      ok = plot_decimator_push(&dec, index, value);
+      parsed++;
     }
+    p = eol + 1;
+  }
+  ok = ok && plot_decimator_finish(&dec);
+  release_view(&view);
 
-    // ========================================================================
-    // STEP 4: DYNAMICALLY RESIZE ARRAY IF CAPACITY IS EXCEEDED
-    // ========================================================================
-    if (data_count >= capacity) {
-      capacity *= 2;
-      data = realloc(data, capacity * sizeof(raw_data_t));
-      if (!data) {
-        fprintf(stderr, "Memory reallocation failed\n");
-        return -1;
-      }
-    }
+  if (!ok) {
+    fprintf(stderr, "Memory reallocation failed\n");
+    free(dec.points);
+    return -1;
   }
 
   // ========================================================================
-  // STEP 5: RETURN PARSED DATA ARRAY AND COUNT
+  // STEP 3: RETURN PARSED DATA ARRAY AND COUNT
   // ========================================================================
-  *out_data = data;
-  return data_count;
+  if (total_points) *total_points = parsed;
+  *out_data = dec.points;
+  return (ssize_t)dec.count;
+}
+
+ssize_t parse_raw_file(FILE *fp, raw_data_t **out_data) {
+  return parse_raw_file_decimated(fp, 0, out_data, NULL);
 }
 
 // Parse squiggle format file (pos base current sd dwell) into memory structure
-int parse_squiggle_file(FILE *fp, squiggle_data_t **out_data) {
+ssize_t parse_squiggle_file(FILE *fp, squiggle_data_t **out_data) {
   // ========================================================================
-  // STEP 1: ALLOCATE INITIAL DATA ARRAY WITH DYNAMIC CAPACITY
+  // STEP 1: MAP INPUT AND SIZE THE OUTPUT ARRAY
   // ========================================================================
-  char line[1024];
-  int data_count = 0;
-  int capacity = 1000;
-  squiggle_data_t *data = malloc(capacity * sizeof(squiggle_data_t));
+  text_view_t view;
+  if (!view_stream(fp, &view)) {
+    fprintf(stderr, "Memory allocation failed\n");
+    return -1;
+  }
+  const char *p = view.data;
+  const char *end = view.data + view.length;
+  squiggle_data_t *data = malloc(count_lines(p, end) * sizeof(squiggle_data_t));
 
   if (!data) {
     fprintf(stderr, "Memory allocation failed\n");
+    release_view(&view);
     return -1;
   }
 
   // ========================================================================
-  // STEP 2: READ FILE LINE-BY-LINE AND PARSE SQUIGGLE DATA
+  // STEP 2: PARSE SQUIGGLE DATA LINES (CONSOLE OUTPUT AND HEADERS DON'T SCAN)
   // ========================================================================
-  while (fgets(line, sizeof(line), fp)) {
-    // Skip console output and comments
-    if (line[0] == '\n' || strncmp(line, "Executing", 9) == 0 ||
-        strstr(line, ": ") || strncmp(line, "Processed", 9) == 0 ||
-        line[0] == '#') {
-      continue;
+  size_t data_count = 0;
+  while (p < end) {
+    const char *eol = memchr(p, '\n', (size_t)(end - p));
+    if (!eol) eol = end;
+    if (parse_squiggle_line(p, eol, &data[data_count])) {
+      data_count++;
     }
+    p = eol + 1;
+  }
+  release_view(&view);
 
-    // Skip header line
-    if (strstr(line, "pos\tbase\tcurrent") || strstr(line, "pos") && strstr(line, "base")) {
-      continue;
+  // ========================================================================
+  // STEP 3: RETURN PARSED DATA ARRAY AND COUNT
+  // ========================================================================
+  *out_data = data;
+  return (ssize_t)data_count;
+}
+
+// **********************************************************************
+// Direct Fast5 Plotting
+// **********************************************************************
+// Hand raw points to the interactive or PNG callback
+static void plot_raw_points(raw_data_t *points, size_t count, const char *title, const char *png_filename,
+                            plot_config_t *config, plot_callbacks_t *callbacks) {
+  if (config->png_mode) {
+    if (callbacks && callbacks->plot_raw_png) {
+      if (config->verbose) {
+        printf("  -> Creating PNG: %s\n", png_filename);
+      }
+      callbacks->plot_raw_png(points, count, png_filename);
+    } else if (config->verbose) {
+      printf("  -> Warning: No raw PNG callback provided\n");
     }
+  } else if (callbacks && callbacks->plot_raw) {
+    if (config->verbose) {
+      printf("  -> Creating interactive plot...\n");
+    }
+    callbacks->plot_raw(points, count, title);
+  } else if (config->verbose) {
+    printf("  -> Warning: No raw plotting callback provided\n");
+  }
+}
 
-    // ========================================================================
-    // STEP 3: PARSE SQUIGGLE DATA LINE (pos, base, current, sd, dwell)
-    // ========================================================================
-    if (sscanf(line, "%d\t%c\t%f\t%f\t%f",
-               &data[data_count].pos, &data[data_count].base,
-               &data[data_count].current, &data[data_count].sd,
-               &data[data_count].dwell) == 5) {
+// Column envelopes from a pyramid level: (x, min), (x, max) at each column's first sample
+static raw_data_t* pyramid_points(const signal_pyramid_t *pyramid, int level, size_t start, size_t count,
+                                  size_t columns, size_t *point_count) {
+  int16_t *lo = malloc(columns * sizeof(int16_t));
+  int16_t *hi = malloc(columns * sizeof(int16_t));
+  raw_data_t *points = malloc(2 * columns * sizeof(raw_data_t));
+  *point_count = 0;
+  if (lo && hi && points) {
+    size_t written = signal_pyramid_window(pyramid, level, start, count, columns, lo, hi);
+    for (size_t c = 0; c < written; c++) {
+      size_t x = start + count * c / written;
+      points[(*point_count)++] = (raw_data_t){x, (float)lo[c]};
+      if (hi[c] != lo[c]) points[(*point_count)++] = (raw_data_t){x, (float)hi[c]};
+    }
+  } else {
+    free(points);
+    points = NULL;
+  }
+  free(lo);
+  free(hi);
+  return points;
+}
 
-      data_count++;
+ssize_t plot_fast5(const char *fast5_file, plot_config_t *config, plot_callbacks_t *callbacks) {
+  // ========================================================================
+  // STEP 1: LOCATE THE READ THROUGH THE READ-ID INDEX
+  // ========================================================================
+  fast5_index_t *index = fast5_index_create();
+  if (!index || fast5_index_add_file(index, fast5_file) < 0) {
+    warnx("Cannot index Fast5 file: %s", fast5_file);
+    fast5_index_free(index);
+    return -1;
+  }
+  const fast5_index_entry_t *entry = config->read_id ? fast5_index_lookup(index, config->read_id)
+                                   : (index->entry_count > 0 ? &index->entries[0] : NULL);
+  if (!entry) {
+    fast5_index_free(index);
+    return 0;
+  }
 
-      // ========================================================================
-      // STEP 4: DYNAMICALLY RESIZE ARRAY IF CAPACITY IS EXCEEDED
-      // ========================================================================
-      if (data_count >= capacity) {
-        capacity *= 2;
-        data = realloc(data, capacity * sizeof(squiggle_data_t));
-        if (!data) {
-          fprintf(stderr, "Memory reallocation failed\n");
-          return -1;
-        }
+  size_t signal_length = entry->signal_length;
+  size_t start = config->window_start;
+  if (start >= signal_length) {
+    warnx("Window start %zu is past the end of read %s (%zu samples)", start, entry->read_id, signal_length);
+    fast5_index_free(index);
+    return 0;
+  }
+  size_t count = signal_length - start;
+  if (config->window_length > 0 && config->window_length < count) count = config->window_length;
+  size_t columns = config->width;
+
+  if (config->verbose) {
+    printf("  -> Read %s (%s): %zu samples, plotting [%zu, %zu)\n",
+           entry->read_id, entry->group_path, signal_length, start, start + count);
+  }
+
+  // ========================================================================
+  // STEP 2: BUILD POINTS (PYRAMID LEVEL, OR THE WINDOW'S SAMPLES DECIMATED)
+  // ========================================================================
+  raw_data_t *points = NULL;
+  size_t point_count = 0;
+  int level = (config->use_pyramid && columns > 0) ? signal_pyramid_level_for(count / columns) : -1;
+
+  if (level >= 0) {
+    signal_pyramid_t *pyramid = signal_pyramid_load(fast5_file, entry->read_id);
+    if (!pyramid) {
+      // First view of this read: one full read builds the ladder for every later zoom
+      seq_tensor *signal = read_fast5_signal_raw_at(fast5_file, entry->group_path);
+      pyramid = signal ? signal_pyramid_build(seq_tensor_data_int16(signal), seq_tensor_dim(signal, 0)) : NULL;
+      seq_tensor_free(signal);
+      if (pyramid && signal_pyramid_save(fast5_file, entry->read_id, pyramid) == 0 && config->verbose) {
+        printf("  -> Cached min/max pyramid in %s%s\n", fast5_file, SIGNAL_PYRAMID_SIDECAR_SUFFIX);
       }
     }
+    if (pyramid) {
+      if (config->verbose) {
+        printf("  -> Using pyramid level %d (1/%zu)\n", level, signal_pyramid_bucket_size(level));
+      }
+      points = pyramid_points(pyramid, level, start, count, columns, &point_count);
+      signal_pyramid_free(pyramid);
+    }
+  }
+
+  if (!points) {
+    // Only [start, start + count) is read from the file
+    seq_tensor *window = read_fast5_signal_raw_window_at(fast5_file, entry->group_path, start, count);
+    plot_decimator_t dec;
+    if (window && plot_decimator_init(&dec, plot_bucket_size(count, columns), count)) {
+      const int16_t *samples = seq_tensor_data_int16(window);
+      size_t n = seq_tensor_dim(window, 0);
+      bool ok = true;
+      for (size_t i = 0; ok && i < n; i++) ok = plot_decimator_push(&dec, start + i, (float)samples[i]);
+      if (ok && plot_decimator_finish(&dec)) {
+        points = dec.points;
+        point_count = dec.count;
+      } else {
+        free(dec.points);
+      }
+    }
+    seq_tensor_free(window);
+  }
+
+  if (!points) {
+    warnx("Failed to read signal for read %s in %s", entry->read_id, fast5_file);
+    fast5_index_free(index);
+    return -1;
   }
 
   // ========================================================================
-  // STEP 5: RETURN PARSED DATA ARRAY AND COUNT
+  // STEP 3: INVOKE RAW PLOTTING CALLBACK
   // ========================================================================
-  *out_data = data;
-  return data_count;
+  if (config->verbose) {
+    printf("  -> %zu points\n", point_count);
+  }
+  char title[512], png_filename[512];
+  snprintf(title, sizeof(title), "%s:%s", fast5_file, entry->read_id);
+  snprintf(png_filename, sizeof(png_filename), "%s_%s_raw.png", fast5_file, entry->read_id);
+  plot_raw_points(points, point_count, config->title ? config->title : title, png_filename, config, callbacks);
+
+  free(points);
+  fast5_index_free(index);
+  return (ssize_t)point_count;
 }
 
 // **********************************************************************
@@ -240,7 +667,7 @@ int plot_signals(char **files, int file_count, plot_config_t *config, plot_callb
   // ========================================================================
   // STEP 1: INITIALIZE TRACKING VARIABLES
   // ========================================================================
-  int total_data_points = 0;
+  size_t total_data_points = 0;
 
   if (config->verbose) {
     printf("Processing %d files for plotting...\n", file_count);
@@ -249,7 +676,21 @@ int plot_signals(char **files, int file_count, plot_config_t *config, plot_callb
   // ========================================================================
   // STEP 2: ITERATE THROUGH ALL INPUT FILES
   // ========================================================================
+  bool read_found = false;
   for (int fn = 0; fn < file_count; fn++) {
+    // Fast5 inputs are plotted straight from the file
+    if (is_fast5_file(files[fn])) {
+      if (config->verbose) {
+        printf("Processing Fast5 file: %s\n", files[fn]);
+      }
+      ssize_t plotted = plot_fast5(files[fn], config, callbacks);
+      if (plotted > 0) {
+        total_data_points += (size_t)plotted;
+        read_found = true;
+      }
+      continue;
+    }
+
     FILE *fh = fopen(files[fn], "r");
     if (!fh) {
       fprintf(stderr, "Failed to open \"%s\" for input.\n", files[fn]);
@@ -264,7 +705,7 @@ int plot_signals(char **files, int file_count, plot_config_t *config, plot_callb
     // STEP 3: AUTO-DETECT FILE FORMAT (RAW, SQUIGGLE, OR UNKNOWN)
     // ========================================================================
     file_format_t format = detect_plot_file_format(fh);
-    int data_count = 0;
+    ssize_t data_count = 0;
 
     // ========================================================================
     // STEP 4: PROCESS FILE BASED ON DETECTED FORMAT
@@ -276,11 +717,15 @@ int plot_signals(char **files, int file_count, plot_config_t *config, plot_callb
         }
 
         raw_data_t *raw_data = NULL;
-        data_count = parse_raw_file(fh, &raw_data);
+        size_t total_points = 0;
+        data_count = parse_raw_file_decimated(fh, config->width, &raw_data, &total_points);
 
         if (data_count > 0) {
           if (config->verbose) {
-            printf("  -> Parsed %d raw signal points\n", data_count);
+            printf("  -> Parsed %zu raw signal points\n", total_points);
+            if ((size_t)data_count < total_points) {
+              printf("  -> Decimated to %zd min/max points (%zu pixel columns)\n", data_count, config->width);
+            }
           }
           // ========================================================================
           // STEP 4.1: INVOKE RAW PLOTTING CALLBACK WITH PARSED DATA
@@ -329,7 +774,7 @@ int plot_signals(char **files, int file_count, plot_config_t *config, plot_callb
 
         if (data_count > 0) {
           if (config->verbose) {
-            printf("  -> Parsed %d squiggle data points\n", data_count);
+            printf("  -> Parsed %zd squiggle data points\n", data_count);
           }
           // ========================================================================
           // STEP 4.2: INVOKE SQUIGGLE PLOTTING CALLBACK WITH PARSED DATA
@@ -377,15 +822,19 @@ int plot_signals(char **files, int file_count, plot_config_t *config, plot_callb
     // ========================================================================
     // STEP 6: ACCUMULATE STATISTICS AND CLEAN UP FILE HANDLE
     // ========================================================================
-    total_data_points += data_count;
+    if (data_count > 0) total_data_points += (size_t)data_count;
     fclose(fh);
   }
 
+  if (config->read_id && !read_found) {
+    warnx("Read not found: %s", config->read_id);
+  }
+
   // ========================================================================
   // STEP 7: REPORT FINAL STATISTICS
   // ========================================================================
   if (config->verbose) {
-    printf("Processed %d files with %d total data points.\n", file_count, total_data_points);
+    printf("Processed %d files with %zu total data points.\n", file_count, total_data_points);
   }
 
   return 0; // Changed from EXIT_SUCCESS to 0 for consistency
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <sys/types.h>
 
 // **********************************************************************
 // Data Structures
@@ -24,19 +25,32 @@ typedef enum {
 
 // Raw signal data structure (sample_index, raw_sample)
 typedef struct {
-  int sample_index;
+  size_t sample_index;
   float raw_value;
 } raw_data_t;
 
 // Squiggle data structure (pos, base, current, std_dev, dwell)
 typedef struct {
-  int pos;
+  size_t pos;
   char base;
   float current;
   float sd;
   float dwell;
 } squiggle_data_t;
 
+// Streaming min/max decimation: every bucket of bucket_size consecutive points
+// is reduced to its minimum and maximum (kept in their original order), so a
+// trace of any length becomes at most two points per output pixel column with
+// every peak preserved
+typedef struct {
+  size_t bucket_size;     // Input points per bucket (0 or 1 keeps every point)
+  size_t in_bucket;       // Points seen in the current bucket
+  raw_data_t lo, hi;      // Current bucket extremes
+  raw_data_t *points;     // Decimated output
+  size_t count;
+  size_t capacity;
+} plot_decimator_t;
+
 // **********************************************************************
 // Configuration and Callback Structures for Extensible Plotting
 // **********************************************************************
@@ -48,8 +62,13 @@ typedef struct {
   bool png_mode;          // Generate PNG files instead of interactive plots
   const char *title;      // Optional title for plots (NULL uses filename)
   const char *output_file; // Optional output file path
+  size_t width;           // Decimate raw traces to min/max per pixel column (0 = every point)
+  // Fast5 inputs (plotted directly, no text conversion)
+  const char *read_id;    // Read to plot (NULL = first read of each file)
+  size_t window_start;    // First sample of the plotted window
+  size_t window_length;   // Samples in the window (0 = to the end of the read)
+  bool use_pyramid;       // Build/reuse cached min/max pyramids (<file>.pyr sidecars)
   // Future options can be added here without changing function signatures:
-  // int width;           // Plot width in pixels
   // int height;          // Plot height in pixels
   // bool log_scale;      // Use logarithmic scale
 } plot_config_t;
@@ -64,15 +83,14 @@ typedef struct {
 // PNG callbacks: Use gnuplot to generate static PNG files
 typedef struct {
   // Interactive plotting callbacks (feedgnuplot)
-  int (*plot_raw)(raw_data_t *data, int count, const char *title);
-  int (*plot_squiggle)(squiggle_data_t *data, int count, const char *title);
+  int (*plot_raw)(raw_data_t *data, size_t count, const char *title);
+  int (*plot_squiggle)(squiggle_data_t *data, size_t count, const char *title);
 
   // PNG export callbacks (gnuplot)
-  int (*plot_raw_png)(raw_data_t *data, int count, const char *output_path);
-  int (*plot_squiggle_png)(squiggle_data_t *data, int count, const char *output_path);
+  int (*plot_raw_png)(raw_data_t *data, size_t count, const char *output_path);
+  int (*plot_squiggle_png)(squiggle_data_t *data, size_t count, const char *output_path);
 
   // Future callbacks can be added here:
-  // int (*plot_fast5)(const char *fast5_file, const char *read_id);
   // int (*plot_multi_panel)(raw_data_t **data_arrays, int array_count, const char *title);
 } plot_callbacks_t;
 
@@ -83,9 +101,28 @@ typedef struct {
 // File format detection
 file_format_t detect_plot_file_format(FILE *fp);
 
-// Data parsing
-int parse_raw_file(FILE *fp, raw_data_t **out_data);
-int parse_squiggle_file(FILE *fp, squiggle_data_t **out_data);
+// Data parsing: the rest of the stream (from its current position) is memory-mapped
+// when it is a regular file and scanned in place (pipes are copied, to a temporary
+// file past the --max-memory budget); returns the point count or -1. Raw points that
+// would not fit the budget are decimated as by parse_raw_file_decimated
+ssize_t parse_raw_file(FILE *fp, raw_data_t **out_data);
+ssize_t parse_squiggle_file(FILE *fp, squiggle_data_t **out_data);
+
+// Raw parsing with streaming min/max decimation to about 2 * buckets points;
+// total_points (optional) receives the number of samples scanned
+ssize_t parse_raw_file_decimated(FILE *fp, size_t buckets, raw_data_t **out_data, size_t *total_points);
+
+// Min/max decimation (bucket_size from plot_bucket_size; points freed by the caller)
+size_t plot_bucket_size(size_t total_points, size_t buckets);   // 1 when no reduction is needed
+bool plot_decimator_init(plot_decimator_t *dec, size_t bucket_size, size_t expected_points);
+bool plot_decimator_push(plot_decimator_t *dec, size_t index, float value);
+bool plot_decimator_finish(plot_decimator_t *dec);              // Emits the final partial bucket
+
+// Plot one read of a Fast5 file through the raw callbacks: the read is located with the
+// read-id index, only the requested window is read (or a cached pyramid level is used)
+// and it is decimated to config->width columns. Returns points plotted, 0 if the read is
+// not in this file, -1 on error
+ssize_t plot_fast5(const char *fast5_file, plot_config_t *config, plot_callbacks_t *callbacks);
 
 // Main plotting function (takes config and callback structs for extensible plotting)
 // Uses struct-based parameters for scalability - add new options to structs, not function signature
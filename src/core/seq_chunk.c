@@ -0,0 +1,331 @@
+// **********************************************************************
+// core/seq_chunk.c - Ragged Read Batches and Fixed-Length Signal Windows
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_chunk.h"
+#include "seq_kernels.h"
+#include <err.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// MAD of a normal distribution is 0.6745 sigma; this scales it back to sigma
+#define SEQ_CHUNK_MAD_TO_SD 1.4826f
+
+// **********************************************************************
+// Ragged Batches
+// **********************************************************************
+
+seq_ragged* seq_ragged_create(size_t width) {
+  if (width == 0) return NULL;
+  seq_ragged *ragged = calloc(1, sizeof(seq_ragged));
+  if (!ragged) return NULL;
+  ragged->width = width;
+  ragged->item_capacity = 16;
+  ragged->offsets = calloc(ragged->item_capacity + 1, sizeof(size_t));
+  if (!ragged->offsets) {
+    free(ragged);
+    return NULL;
+  }
+  return ragged;
+}
+
+void seq_ragged_free(seq_ragged *ragged) {
+  if (!ragged) return;
+  free(ragged->data);
+  free(ragged->offsets);
+  free(ragged);
+}
+
+void seq_ragged_clear(seq_ragged *ragged) {
+  ragged->count = 0;
+  ragged->offsets[0] = 0;
+}
+
+bool seq_ragged_append(seq_ragged *ragged, const float *rows, size_t num_rows) {
+  size_t used = ragged->offsets[ragged->count];
+  if (used + num_rows > ragged->row_capacity) {
+    size_t capacity = ragged->row_capacity ? ragged->row_capacity : 4096;
+    while (capacity < used + num_rows) capacity *= 2;
+    float *grown = realloc(ragged->data, capacity * ragged->width * sizeof(float));
+    if (!grown) return false;
+    ragged->data = grown;
+    ragged->row_capacity = capacity;
+  }
+  if (ragged->count == ragged->item_capacity) {
+    size_t *grown = realloc(ragged->offsets, (2 * ragged->item_capacity + 1) * sizeof(size_t));
+    if (!grown) return false;
+    ragged->offsets = grown;
+    ragged->item_capacity *= 2;
+  }
+
+  memcpy(ragged->data + used * ragged->width, rows, num_rows * ragged->width * sizeof(float));
+  ragged->offsets[++ragged->count] = used + num_rows;
+  return true;
+}
+
+bool seq_ragged_append_tensor(seq_ragged *ragged, const seq_tensor *tensor) {
+  if (!tensor || tensor->dtype != SEQ_TENSOR_FLT32 || !seq_tensor_is_dense(tensor) ||
+      tensor->ndim == 0 || tensor->size != tensor->shape[0] * ragged->width) {
+    warnx("Ragged batch of width %zu takes dense float tensors [rows × %zu]", ragged->width, ragged->width);
+    return false;
+  }
+  return seq_ragged_append(ragged, (const float*)tensor->data, tensor->shape[0]);
+}
+
+seq_tensor* seq_ragged_view(const seq_ragged *ragged, size_t i) {
+  if (i >= ragged->count) return NULL;
+  return seq_tensor_wrap(seq_ragged_item(ragged, i), SEQ_TENSOR_FLT32, 2,
+                         (size_t[]){seq_ragged_length(ragged, i), ragged->width});
+}
+
+// **********************************************************************
+// Chunker
+// **********************************************************************
+
+// A batch plus its place in the ready queue or spare list (batch comes first,
+// so the public pointer converts back)
+typedef struct batch_node {
+  seq_chunk_batch batch;
+  struct batch_node *next;
+} batch_node_t;
+
+struct seq_chunker {
+  seq_chunker_options options;
+  seq_chunker_stats stats;
+
+  batch_node_t *filling;   // Batch receiving windows (NULL until the next window)
+  batch_node_t *ready;     // Complete batches, oldest first
+  batch_node_t *ready_tail;
+  batch_node_t *handed;    // Last batch returned (recycled on the next call)
+  batch_node_t *spare;
+
+  float *normalised;       // Per-read scratch: calibrated/normalised samples
+  float *select;           // Per-read scratch: median and MAD selection
+  size_t scratch_capacity;
+};
+
+void seq_chunker_options_init(seq_chunker_options *options) {
+  options->chunk_length = 4000;
+  options->overlap = 500;
+  options->batch_size = 64;
+  options->normalise = false;
+}
+
+seq_chunker* seq_chunker_create(const seq_chunker_options *options) {
+  if (!options || options->chunk_length == 0 || options->batch_size == 0 ||
+      options->overlap >= options->chunk_length) {
+    warnx("Invalid chunking: windows need a positive length larger than their overlap and a positive batch size");
+    return NULL;
+  }
+  seq_chunker *chunker = calloc(1, sizeof(seq_chunker));
+  if (!chunker) return NULL;
+  chunker->options = *options;
+  return chunker;
+}
+
+static void free_nodes(batch_node_t *node) {
+  while (node) {
+    batch_node_t *next = node->next;
+    seq_tensor_free(node->batch.signal);
+    free(node->batch.origins);
+    free(node);
+    node = next;
+  }
+}
+
+void seq_chunker_free(seq_chunker *chunker) {
+  if (!chunker) return;
+  free_nodes(chunker->filling);
+  free_nodes(chunker->ready);
+  free_nodes(chunker->handed);
+  free_nodes(chunker->spare);
+  free(chunker->normalised);
+  free(chunker->select);
+  free(chunker);
+}
+
+void seq_chunker_get_stats(const seq_chunker *chunker, seq_chunker_stats *stats) {
+  *stats = chunker->stats;
+}
+
+static batch_node_t* take_batch(seq_chunker *chunker) {
+  batch_node_t *node = chunker->spare;
+  if (node) {
+    chunker->spare = node->next;
+  } else {
+    node = calloc(1, sizeof(batch_node_t));
+    if (!node) return NULL;
+    node->batch.signal = seq_tensor_create_float_uninit(2, (size_t[]){chunker->options.batch_size,
+                                                                       chunker->options.chunk_length});
+    node->batch.origins = malloc(chunker->options.batch_size * sizeof(seq_chunk_origin));
+    if (!node->batch.signal || !node->batch.origins) {
+      free_nodes(node);
+      return NULL;
+    }
+  }
+  node->next = NULL;
+  node->batch.count = 0;
+  return node;
+}
+
+static void recycle_handed(seq_chunker *chunker) {
+  if (chunker->handed) {
+    chunker->handed->next = chunker->spare;
+    chunker->spare = chunker->handed;
+    chunker->handed = NULL;
+  }
+}
+
+// Copy one window into the filling batch, queueing the batch once it is full
+static bool emit_window(seq_chunker *chunker, uint64_t read, const float *samples, size_t start) {
+  if (!chunker->filling) {
+    chunker->filling = take_batch(chunker);
+    if (!chunker->filling) return false;
+  }
+  seq_chunk_batch *batch = &chunker->filling->batch;
+  size_t chunk_length = chunker->options.chunk_length;
+  memcpy(seq_tensor_data_float(batch->signal) + batch->count * chunk_length, samples + start,
+         chunk_length * sizeof(float));
+  batch->origins[batch->count++] = (seq_chunk_origin){read, start};
+  chunker->stats.windows++;
+
+  if (batch->count == chunker->options.batch_size) {
+    if (chunker->ready_tail) chunker->ready_tail->next = chunker->filling;
+    else chunker->ready = chunker->filling;
+    chunker->ready_tail = chunker->filling;
+    chunker->filling = NULL;
+  }
+  return true;
+}
+
+static bool reserve_scratch(seq_chunker *chunker, size_t length) {
+  if (length <= chunker->scratch_capacity) return true;
+  float *normalised = realloc(chunker->normalised, length * sizeof(float));
+  if (normalised) chunker->normalised = normalised;
+  float *select = realloc(chunker->select, length * sizeof(float));
+  if (select) chunker->select = select;
+  if (!normalised || !select) return false;
+  chunker->scratch_capacity = length;
+  return true;
+}
+
+// k-th smallest of values[0, n) (reorders values; Hoare selection, expected O(n))
+static float select_kth(float *values, size_t n, size_t k) {
+  ptrdiff_t lo = 0, hi = (ptrdiff_t)n - 1, target = (ptrdiff_t)k;
+  while (lo < hi) {
+    float pivot = values[lo + (hi - lo) / 2];
+    ptrdiff_t i = lo, j = hi;
+    while (i <= j) {
+      while (values[i] < pivot) i++;
+      while (values[j] > pivot) j--;
+      if (i <= j) {
+        float t = values[i];
+        values[i++] = values[j];
+        values[j--] = t;
+      }
+    }
+    if (target <= j) hi = j;
+    else if (target >= i) lo = i;
+    else break;
+  }
+  return values[k];
+}
+
+// out = (signal - median) / (1.4826 * MAD); a flat read only has its median removed
+static void normalise_read(seq_chunker *chunker, const float *signal, size_t length, float *out) {
+  float *select = chunker->select;
+  memcpy(select, signal, length * sizeof(float));
+  float median = select_kth(select, length, length / 2);
+  for (size_t i = 0; i < length; i++) select[i] = fabsf(signal[i] - median);
+  float mad = select_kth(select, length, length / 2) * SEQ_CHUNK_MAD_TO_SD;
+  float inverse = mad > 0.0f ? 1.0f / mad : 1.0f;
+  seq_kernel_affine_f32_f32(signal, out, length, inverse, -median * inverse);
+}
+
+// Windows at 0, step, 2 step, ... plus one aligned to the end if the last misses it
+static bool cut_read(seq_chunker *chunker, uint64_t read, const float *samples, size_t length) {
+  size_t chunk_length = chunker->options.chunk_length;
+  size_t step = chunk_length - chunker->options.overlap;
+  size_t start = 0;
+  for (; start + chunk_length <= length; start += step) {
+    if (!emit_window(chunker, read, samples, start)) return false;
+  }
+  if (start - step + chunk_length < length) {
+    if (!emit_window(chunker, read, samples, length - chunk_length)) return false;
+  }
+  chunker->stats.reads++;
+  chunker->stats.samples += length;
+  return true;
+}
+
+bool seq_chunker_add_read(seq_chunker *chunker, uint64_t read, const float *signal, size_t length) {
+  if (length < chunker->options.chunk_length) {
+    chunker->stats.reads_too_short++;
+    return true;
+  }
+  if (!chunker->options.normalise) {
+    return cut_read(chunker, read, signal, length);
+  }
+  if (!reserve_scratch(chunker, length)) return false;
+  normalise_read(chunker, signal, length, chunker->normalised);
+  return cut_read(chunker, read, chunker->normalised, length);
+}
+
+bool seq_chunker_add_read_int16(seq_chunker *chunker, uint64_t read, const int16_t *adc, size_t length,
+                                float scale, float offset) {
+  if (length < chunker->options.chunk_length) {
+    chunker->stats.reads_too_short++;
+    return true;
+  }
+  if (!reserve_scratch(chunker, length)) return false;
+  float *pa = chunker->normalised;
+  seq_kernel_affine_i16_f32(adc, pa, length, scale, offset * scale);
+  if (chunker->options.normalise) {
+    normalise_read(chunker, pa, length, pa);  // The selection works on its own copy
+  }
+  return cut_read(chunker, read, pa, length);
+}
+
+bool seq_chunker_add_ragged(seq_chunker *chunker, const seq_ragged *reads, uint64_t first_read) {
+  if (reads->width != 1) {
+    warnx("Signal chunking takes one sample per row (the batch has %zu columns)", reads->width);
+    return false;
+  }
+  for (size_t i = 0; i < reads->count; i++) {
+    if (!seq_chunker_add_read(chunker, first_read + i, seq_ragged_item(reads, i), seq_ragged_length(reads, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const seq_chunk_batch* seq_chunker_next(seq_chunker *chunker) {
+  recycle_handed(chunker);
+  batch_node_t *node = chunker->ready;
+  if (!node) return NULL;
+  chunker->ready = node->next;
+  if (!chunker->ready) chunker->ready_tail = NULL;
+  node->next = NULL;
+  chunker->handed = node;
+  chunker->stats.batches++;
+  return &node->batch;
+}
+
+const seq_chunk_batch* seq_chunker_finish(seq_chunker *chunker) {
+  if (chunker->ready) return seq_chunker_next(chunker);
+  recycle_handed(chunker);
+
+  batch_node_t *node = chunker->filling;
+  if (!node || node->batch.count == 0) return NULL;
+  size_t chunk_length = chunker->options.chunk_length;
+  size_t filled = node->batch.count * chunk_length;
+  memset(seq_tensor_data_float(node->batch.signal) + filled, 0,
+         (chunker->options.batch_size * chunk_length - filled) * sizeof(float));
+  chunker->filling = NULL;
+  chunker->handed = node;
+  chunker->stats.batches++;
+  return &node->batch;
+}
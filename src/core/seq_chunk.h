@@ -0,0 +1,124 @@
+// **********************************************************************
+// core/seq_chunk.h - Ragged Read Batches and Fixed-Length Signal Windows
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// seq_ragged holds many variable-length reads in one buffer: rows of every
+// read end to end plus an offsets array, so a batch of signals ([samples × 1])
+// or squiggles ([kmers × 3]) is one allocation rather than one tensor each.
+//
+// seq_chunker cuts reads (Fast5 ADC samples, seqgen signals, any float pA
+// source) into fixed-length overlapping windows and packs them into dense
+// [batch_size × chunk_length] FLT32 batches for a basecaller. Windows never
+// cross reads and are never padded: the last window of a read is aligned to
+// its end (overlapping its neighbour by more), and reads shorter than one
+// window are skipped and counted. Only complete batches are handed out until
+// seq_chunker_finish() releases the remainder.
+#ifndef SEQUELIZER_SEQ_CHUNK_H
+#define SEQUELIZER_SEQ_CHUNK_H
+
+#include "seq_tensor.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// **********************************************************************
+// Ragged Batches
+// **********************************************************************
+
+typedef struct {
+  float *data;             // Rows of every item end to end, width floats each
+  size_t width;            // Columns per row (1 for signals, 3 for squiggles)
+  size_t *offsets;         // count + 1 entries: item i is rows [offsets[i], offsets[i + 1])
+  size_t count;
+  size_t row_capacity;     // Rows allocated at data
+  size_t item_capacity;    // Items allocated at offsets (less the trailing entry)
+} seq_ragged;
+
+// Empty batch of width-column rows; NULL if out of memory
+seq_ragged* seq_ragged_create(size_t width);
+void        seq_ragged_free(seq_ragged *ragged);
+
+// Drop every item, keeping the buffers
+void seq_ragged_clear(seq_ragged *ragged);
+
+// Append a copy of num_rows rows (num_rows * width floats); false if out of memory
+bool seq_ragged_append(seq_ragged *ragged, const float *rows, size_t num_rows);
+
+// Append a dense FLT32 tensor [rows × width] (e.g. squiggle_to_raw or squiggle output)
+bool seq_ragged_append_tensor(seq_ragged *ragged, const seq_tensor *tensor);
+
+// Rows in item i and a pointer to its first row
+static inline size_t seq_ragged_length(const seq_ragged *ragged, size_t i) {
+  return ragged->offsets[i + 1] - ragged->offsets[i];
+}
+static inline float* seq_ragged_item(const seq_ragged *ragged, size_t i) {
+  return ragged->data + ragged->offsets[i] * ragged->width;
+}
+
+// Non-owning [rows × width] tensor over item i (valid until the batch next grows);
+// NULL for an empty item, as tensors have no zero-length axes
+seq_tensor* seq_ragged_view(const seq_ragged *ragged, size_t i);
+
+// **********************************************************************
+// Chunker
+// **********************************************************************
+
+typedef struct {
+  size_t chunk_length;     // Samples per window
+  size_t overlap;          // Samples shared by consecutive windows (< chunk_length)
+  size_t batch_size;       // Windows per batch
+  bool normalise;          // (x - median) / (1.4826 * MAD) over each whole read before cutting
+} seq_chunker_options;
+
+// Defaults: 4000-sample windows overlapping by 500, 64 per batch, no normalisation
+void seq_chunker_options_init(seq_chunker_options *options);
+
+// Where a window came from
+typedef struct {
+  uint64_t read;           // Caller's read number
+  size_t start;            // First sample of the window within the read
+} seq_chunk_origin;
+
+typedef struct {
+  seq_tensor *signal;      // [batch_size × chunk_length] FLT32
+  seq_chunk_origin *origins;  // batch_size entries
+  size_t count;            // Windows filled: batch_size, except for seq_chunker_finish()
+} seq_chunk_batch;
+
+typedef struct {
+  uint64_t reads;          // Reads cut into windows
+  uint64_t reads_too_short;  // Reads shorter than chunk_length (skipped)
+  uint64_t windows;
+  uint64_t batches;        // Batches handed out
+  uint64_t samples;        // Samples of the reads that were cut
+} seq_chunker_stats;
+
+typedef struct seq_chunker seq_chunker;
+
+// NULL (with a warning) on invalid options or out of memory
+seq_chunker* seq_chunker_create(const seq_chunker_options *options);
+void         seq_chunker_free(seq_chunker *chunker);
+
+// Cut one read into windows; false if out of memory. Drain seq_chunker_next()
+// after each read: completed batches queue up until they are taken
+bool seq_chunker_add_read(seq_chunker *chunker, uint64_t read, const float *signal, size_t length);
+
+// Fast5 ADC samples, calibrated on the way in: pA = (adc + offset) * scale
+// (scale = range / digitisation)
+bool seq_chunker_add_read_int16(seq_chunker *chunker, uint64_t read, const int16_t *adc, size_t length,
+                                float scale, float offset);
+
+// Every item of a width-1 ragged batch, as reads first_read, first_read + 1, ...
+bool seq_chunker_add_ragged(seq_chunker *chunker, const seq_ragged *reads, uint64_t first_read);
+
+// Next complete batch, or NULL. The batch stays valid until the next call
+const seq_chunk_batch* seq_chunker_next(seq_chunker *chunker);
+
+// At the end of input, call until NULL: any complete batches still queued, then
+// the last partial one (count < batch_size, remaining rows zero). Valid until the next call
+const seq_chunk_batch* seq_chunker_finish(seq_chunker *chunker);
+
+void seq_chunker_get_stats(const seq_chunker *chunker, seq_chunker_stats *stats);
+
+#endif // SEQUELIZER_SEQ_CHUNK_H
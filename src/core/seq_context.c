@@ -0,0 +1,359 @@
+// **********************************************************************
+// core/seq_context.c - Reentrant Library Context
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+//
+#include "seq_context.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One cached model: a k-mer context or a network
+typedef struct {
+  char *key;               // Model name (k-mer) or weights path (network)
+  bool network;
+  bool int8;
+  void *model;
+  size_t users;            // Outstanding acquires
+  uint64_t last_used;      // Tick of the last release, for dropping idle models
+} context_model_t;
+
+struct seq_context {
+  uint64_t seed;
+  char *models_dir;
+  size_t max_idle_models;
+
+  pthread_mutex_t models_mutex;  // Guards models, model_count and tick
+  context_model_t *models;
+  size_t model_count;
+  size_t model_capacity;
+  uint64_t tick;
+
+  pthread_mutex_t rng_mutex;
+  uint64_t next_stream;
+
+  pthread_mutex_t error_mutex;   // Guards the error ring
+  char errors[SEQ_CONTEXT_MAX_ERRORS][SEQ_CONTEXT_ERROR_LENGTH];
+  size_t error_first;
+  size_t error_count;
+};
+
+// HDF5 is process-global: a build that is not thread-safe needs one lock for every context
+static pthread_mutex_t hdf5_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t hdf5_once = PTHREAD_ONCE_INIT;
+static bool hdf5_needs_lock = true;
+
+static void detect_hdf5_threadsafety(void) {
+  hdf5_needs_lock = !fast5_hdf5_is_threadsafe();
+}
+
+static void hdf5_lock(void) {
+  pthread_once(&hdf5_once, detect_hdf5_threadsafety);
+  if (hdf5_needs_lock) pthread_mutex_lock(&hdf5_mutex);
+}
+
+static void hdf5_unlock(void) {
+  if (hdf5_needs_lock) pthread_mutex_unlock(&hdf5_mutex);
+}
+
+seq_context* seq_context_create(const seq_context_options *options) {
+  seq_context_options defaults = {0, NULL, 0};
+  if (!options) options = &defaults;
+
+  seq_context *ctx = calloc(1, sizeof(seq_context));
+  if (!ctx) return NULL;
+  ctx->seed = options->seed ? options->seed : seq_rng_entropy_seed();
+  ctx->models_dir = strdup(options->models_dir ? options->models_dir : "kmer_models");
+  if (!ctx->models_dir) {
+    free(ctx);
+    return NULL;
+  }
+  ctx->max_idle_models = options->max_idle_models;
+  ctx->next_stream = UINT64_C(1) << 63;
+  pthread_mutex_init(&ctx->models_mutex, NULL);
+  pthread_mutex_init(&ctx->rng_mutex, NULL);
+  pthread_mutex_init(&ctx->error_mutex, NULL);
+  return ctx;
+}
+
+static void free_model(context_model_t *entry) {
+  if (entry->network) {
+    seq_nn_model_free((seq_nn_model*)entry->model);
+  } else {
+    seqgen_kmer_context_free((seqgen_kmer_context*)entry->model);
+  }
+  free(entry->key);
+}
+
+void seq_context_free(seq_context *ctx) {
+  if (!ctx) return;
+  for (size_t i = 0; i < ctx->model_count; i++) {
+    free_model(&ctx->models[i]);
+  }
+  free(ctx->models);
+  free(ctx->models_dir);
+  pthread_mutex_destroy(&ctx->models_mutex);
+  pthread_mutex_destroy(&ctx->rng_mutex);
+  pthread_mutex_destroy(&ctx->error_mutex);
+  free(ctx);
+}
+
+uint64_t seq_context_seed(const seq_context *ctx) {
+  return ctx->seed;
+}
+
+const char* seq_context_models_dir(const seq_context *ctx) {
+  return ctx->models_dir;
+}
+
+// **********************************************************************
+// Models
+// **********************************************************************
+
+// Cached entry for (key, network, int8) or NULL; models_mutex held
+static context_model_t* find_model(seq_context *ctx, const char *key, bool network, bool int8) {
+  for (size_t i = 0; i < ctx->model_count; i++) {
+    context_model_t *entry = &ctx->models[i];
+    if (entry->network == network && entry->int8 == int8 && strcmp(entry->key, key) == 0) return entry;
+  }
+  return NULL;
+}
+
+// Drop the least recently released idle models until at most keep are idle; models_mutex held
+static size_t drop_idle_models(seq_context *ctx, size_t keep) {
+  size_t freed = 0;
+  for (;;) {
+    size_t idle = 0, oldest = SIZE_MAX;
+    for (size_t i = 0; i < ctx->model_count; i++) {
+      if (ctx->models[i].users > 0) continue;
+      idle++;
+      if (oldest == SIZE_MAX || ctx->models[i].last_used < ctx->models[oldest].last_used) oldest = i;
+    }
+    if (idle <= keep) return freed;
+    free_model(&ctx->models[oldest]);
+    ctx->models[oldest] = ctx->models[--ctx->model_count];
+    freed++;
+  }
+}
+
+static void* load_model(const char *models_dir, const char *key, bool network, bool int8) {
+  if (!network) return seqgen_kmer_context_create(models_dir, key);
+
+  seq_nn_model *model = seq_nn_model_load(key);
+  if (model && int8 && !seq_nn_model_quantise(model)) {
+    seq_nn_model_free(model);
+    model = NULL;
+  }
+  return model;
+}
+
+// Loading runs unlocked, so one slow model never stalls other threads' lookups;
+// when two threads load the same model at once, the second copy is thrown away
+static const void* acquire_model(seq_context *ctx, const char *key, bool network, bool int8) {
+  if (!ctx || !key) return NULL;
+
+  pthread_mutex_lock(&ctx->models_mutex);
+  context_model_t *entry = find_model(ctx, key, network, int8);
+  if (entry) {
+    entry->users++;
+    void *model = entry->model;
+    pthread_mutex_unlock(&ctx->models_mutex);
+    return model;
+  }
+  pthread_mutex_unlock(&ctx->models_mutex);
+
+  void *model = load_model(ctx->models_dir, key, network, int8);
+  if (!model) {
+    seq_context_error(ctx, "Cannot load %s \"%s\"", network ? "network" : "k-mer model", key);
+    return NULL;
+  }
+  char *key_copy = strdup(key);
+
+  pthread_mutex_lock(&ctx->models_mutex);
+  entry = find_model(ctx, key, network, int8);
+  if (!entry && key_copy && ctx->model_count == ctx->model_capacity) {
+    size_t capacity = ctx->model_capacity ? ctx->model_capacity * 2 : 8;
+    context_model_t *grown = realloc(ctx->models, capacity * sizeof(context_model_t));
+    if (grown) {
+      ctx->models = grown;
+      ctx->model_capacity = capacity;
+    }
+  }
+  void *result = NULL;
+  if (entry) {
+    entry->users++;
+    result = entry->model;
+  } else if (key_copy && ctx->model_count < ctx->model_capacity) {
+    ctx->models[ctx->model_count++] = (context_model_t){key_copy, network, int8, model, 1, ctx->tick};
+    result = model;
+    key_copy = NULL;
+    model = NULL;
+  }
+  pthread_mutex_unlock(&ctx->models_mutex);
+
+  // Lost the race, or out of memory for the cache
+  if (model) {
+    context_model_t unused = {key_copy, network, int8, model, 0, 0};
+    key_copy = NULL;
+    free_model(&unused);
+  }
+  free(key_copy);
+  if (!result) seq_context_error(ctx, "Out of memory caching \"%s\"", key);
+  return result;
+}
+
+const seqgen_kmer_context* seq_context_acquire_kmer_model(seq_context *ctx, const char *model_name) {
+  return (const seqgen_kmer_context*)acquire_model(ctx, model_name, false, false);
+}
+
+const seq_nn_model* seq_context_acquire_network(seq_context *ctx, const char *path, bool int8) {
+  return (const seq_nn_model*)acquire_model(ctx, path, true, int8);
+}
+
+void seq_context_release_model(seq_context *ctx, const void *model) {
+  if (!ctx || !model) return;
+
+  pthread_mutex_lock(&ctx->models_mutex);
+  for (size_t i = 0; i < ctx->model_count; i++) {
+    context_model_t *entry = &ctx->models[i];
+    if (entry->model != model || entry->users == 0) continue;
+    entry->users--;
+    entry->last_used = ++ctx->tick;
+    if (entry->users == 0 && ctx->max_idle_models > 0) {
+      drop_idle_models(ctx, ctx->max_idle_models);
+    }
+    break;
+  }
+  pthread_mutex_unlock(&ctx->models_mutex);
+}
+
+size_t seq_context_trim(seq_context *ctx, size_t keep) {
+  if (!ctx) return 0;
+  pthread_mutex_lock(&ctx->models_mutex);
+  size_t freed = drop_idle_models(ctx, keep);
+  pthread_mutex_unlock(&ctx->models_mutex);
+  return freed;
+}
+
+size_t seq_context_cached_models(seq_context *ctx) {
+  pthread_mutex_lock(&ctx->models_mutex);
+  size_t count = ctx->model_count;
+  pthread_mutex_unlock(&ctx->models_mutex);
+  return count;
+}
+
+// **********************************************************************
+// Random Number Streams
+// **********************************************************************
+
+void seq_context_rng(const seq_context *ctx, uint64_t stream, seq_rng *rng) {
+  seq_rng_init(rng, ctx->seed, stream);
+}
+
+void seq_context_new_rng(seq_context *ctx, seq_rng *rng) {
+  pthread_mutex_lock(&ctx->rng_mutex);
+  uint64_t stream = ctx->next_stream++;
+  pthread_mutex_unlock(&ctx->rng_mutex);
+  seq_rng_init(rng, ctx->seed, stream);
+}
+
+// **********************************************************************
+// Fast5 Handles
+// **********************************************************************
+
+fast5_reader_t* seq_context_reader_open(seq_context *ctx, const char *filename, metadata_enhancer_t enhancer) {
+  hdf5_lock();
+  fast5_reader_t *reader = fast5_reader_open(filename, enhancer);
+  hdf5_unlock();
+  if (!reader) seq_context_error(ctx, "Cannot open Fast5 file %s", filename ? filename : "(null)");
+  return reader;
+}
+
+int seq_context_reader_next(seq_context *ctx, fast5_reader_t *reader, fast5_metadata_t *metadata, bool load_signal) {
+  hdf5_lock();
+  int status = fast5_reader_next(reader, metadata, load_signal);
+  hdf5_unlock();
+  if (status < 0) seq_context_error(ctx, "Cannot read the next read group");
+  return status;
+}
+
+void seq_context_reader_close(seq_context *ctx, fast5_reader_t *reader) {
+  (void)ctx;
+  hdf5_lock();
+  fast5_reader_close(reader);
+  hdf5_unlock();
+}
+
+fast5_writer_t* seq_context_writer_open(seq_context *ctx, const char *filename, float sample_rate_khz,
+                                        const fast5_write_options_t *options, size_t reads_per_file) {
+  hdf5_lock();
+  fast5_writer_t *writer = fast5_writer_open(filename, sample_rate_khz, options, reads_per_file);
+  hdf5_unlock();
+  if (!writer) seq_context_error(ctx, "Cannot create Fast5 file %s", filename ? filename : "(null)");
+  return writer;
+}
+
+int seq_context_writer_append(seq_context *ctx, fast5_writer_t *writer, seq_tensor *raw_signal, const char *read_name) {
+  hdf5_lock();
+  int status = fast5_writer_append_read(writer, raw_signal, read_name);
+  hdf5_unlock();
+  if (status != 0) seq_context_error(ctx, "Cannot write read %s", read_name ? read_name : "(unnamed)");
+  return status;
+}
+
+int seq_context_writer_close(seq_context *ctx, fast5_writer_t *writer, fast5_write_stats_t *stats) {
+  hdf5_lock();
+  int status = fast5_writer_close(writer, stats);
+  hdf5_unlock();
+  if (status != 0) seq_context_error(ctx, "Cannot finish Fast5 output");
+  return status;
+}
+
+// **********************************************************************
+// Error Stack
+// **********************************************************************
+
+void seq_context_error(seq_context *ctx, const char *format, ...) {
+  if (!ctx) return;
+  char message[SEQ_CONTEXT_ERROR_LENGTH];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+
+  pthread_mutex_lock(&ctx->error_mutex);
+  if (ctx->error_count == SEQ_CONTEXT_MAX_ERRORS) {
+    ctx->error_first = (ctx->error_first + 1) % SEQ_CONTEXT_MAX_ERRORS;
+    ctx->error_count--;
+  }
+  size_t slot = (ctx->error_first + ctx->error_count++) % SEQ_CONTEXT_MAX_ERRORS;
+  memcpy(ctx->errors[slot], message, sizeof(message));
+  pthread_mutex_unlock(&ctx->error_mutex);
+}
+
+size_t seq_context_error_count(seq_context *ctx) {
+  pthread_mutex_lock(&ctx->error_mutex);
+  size_t count = ctx->error_count;
+  pthread_mutex_unlock(&ctx->error_mutex);
+  return count;
+}
+
+bool seq_context_error_pop(seq_context *ctx, char *buffer, size_t size) {
+  pthread_mutex_lock(&ctx->error_mutex);
+  bool found = ctx->error_count > 0;
+  if (found) {
+    size_t slot = (ctx->error_first + --ctx->error_count) % SEQ_CONTEXT_MAX_ERRORS;
+    if (buffer && size > 0) snprintf(buffer, size, "%s", ctx->errors[slot]);
+  }
+  pthread_mutex_unlock(&ctx->error_mutex);
+  return found;
+}
+
+void seq_context_error_clear(seq_context *ctx) {
+  pthread_mutex_lock(&ctx->error_mutex);
+  ctx->error_first = 0;
+  ctx->error_count = 0;
+  pthread_mutex_unlock(&ctx->error_mutex);
+}
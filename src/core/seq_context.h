@@ -0,0 +1,120 @@
+// **********************************************************************
+// core/seq_context.h - Reentrant Library Context
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+//
+// Everything a long-running service needs from libsequelizer without
+// process-global state: a model cache whose lifetime the caller controls,
+// RNG streams derived from the context's seed, Fast5 reader/writer handles,
+// and an error stack the context's calls report into instead of stderr.
+// Contexts are independent; one context may be used from many threads at
+// once (the cache and the error stack are locked, the rest is per handle).
+//
+// Models are reference counted: acquire returns a model that stays valid
+// until the matching release, and released models stay cached (idle) so the
+// next job starts warm. seq_context_trim() and max_idle_models bound the
+// idle set; seq_context_free() frees everything. Pass an acquired k-mer model
+// as params.kmer.context (or a network as params.neural.model) so generation
+// never touches the process-wide fallback caches in seqgen_models.c.
+//
+// Nothing reached through a context exits the process: failures (out of
+// memory or threads included) come back as return values, the wrappers push
+// a message here, and the library call underneath also warns on stderr. A
+// service linking libsequelizer directly should know that these still exit:
+// the whole-dataset drivers in fast5_convert.h (extract_*, export_*,
+// repack_fast5), seq_input_open() and seq_reference_open() when memory or
+// threads run out, and seqgen_models.c's squiggle dispatch on an invalid
+// model enum (a bug check).
+#ifndef SEQUELIZER_SEQ_CONTEXT_H
+#define SEQUELIZER_SEQ_CONTEXT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "seq_rng.h"
+#include "seq_nn.h"
+#include "seqgen_models.h"
+#include "fast5_io.h"
+
+typedef struct seq_context seq_context;
+
+typedef struct {
+  uint64_t seed;            // Base of every RNG stream (0: seq_rng_entropy_seed())
+  const char *models_dir;   // Where models are looked up by name (NULL: "kmer_models")
+  size_t max_idle_models;   // Released models kept cached, least recently used dropped first (0: no limit)
+} seq_context_options;
+
+// options may be NULL for the defaults; NULL on allocation failure
+seq_context* seq_context_create(const seq_context_options *options);
+
+// Frees every cached model, acquired or not
+void seq_context_free(seq_context *ctx);
+
+uint64_t    seq_context_seed(const seq_context *ctx);
+const char* seq_context_models_dir(const seq_context *ctx);
+
+// **********************************************************************
+// Models
+// **********************************************************************
+
+// K-mer model model_name from the context's models_dir, loaded on first use
+const seqgen_kmer_context* seq_context_acquire_kmer_model(seq_context *ctx, const char *model_name);
+
+// Network from a .sqnn weights file, quantised to INT8 when int8 (cached per path and int8)
+const seq_nn_model* seq_context_acquire_network(seq_context *ctx, const char *path, bool int8);
+
+// Give back a model from either acquire; it stays cached while the idle limit allows
+void seq_context_release_model(seq_context *ctx, const void *model);
+
+// Free idle models until at most keep remain; returns how many were freed
+size_t seq_context_trim(seq_context *ctx, size_t keep);
+
+// Models cached (acquired + idle)
+size_t seq_context_cached_models(seq_context *ctx);
+
+// **********************************************************************
+// Random Number Streams
+// **********************************************************************
+
+// Stream `stream` of the context's seed: the same (seed, stream) always gives the
+// same draws, whichever thread asks. Number streams after the work item (read i ->
+// stream i) for results that do not depend on scheduling
+void seq_context_rng(const seq_context *ctx, uint64_t stream, seq_rng *rng);
+
+// A stream no other caller of this function gets (from 2^63 up, clear of
+// explicitly numbered streams), for work that only needs independence
+void seq_context_new_rng(seq_context *ctx, seq_rng *rng);
+
+// **********************************************************************
+// Fast5 Handles
+// **********************************************************************
+// Thin wrappers over fast5_reader_* and fast5_writer_* that report failures to the
+// context's error stack. When the linked HDF5 is not thread-safe every call holds
+// one process-wide lock (HDF5 itself is process-global); otherwise none is taken.
+
+fast5_reader_t* seq_context_reader_open(seq_context *ctx, const char *filename, metadata_enhancer_t enhancer);
+int  seq_context_reader_next(seq_context *ctx, fast5_reader_t *reader, fast5_metadata_t *metadata, bool load_signal);
+void seq_context_reader_close(seq_context *ctx, fast5_reader_t *reader);
+
+fast5_writer_t* seq_context_writer_open(seq_context *ctx, const char *filename, float sample_rate_khz,
+                                        const fast5_write_options_t *options, size_t reads_per_file);
+int  seq_context_writer_append(seq_context *ctx, fast5_writer_t *writer, seq_tensor *raw_signal, const char *read_name);
+int  seq_context_writer_close(seq_context *ctx, fast5_writer_t *writer, fast5_write_stats_t *stats);
+
+// **********************************************************************
+// Error Stack
+// **********************************************************************
+
+// Messages kept; older ones are dropped once the stack is full
+#define SEQ_CONTEXT_MAX_ERRORS 16
+#define SEQ_CONTEXT_ERROR_LENGTH 256
+
+// Push a printf-style message (truncated to SEQ_CONTEXT_ERROR_LENGTH - 1 characters)
+void   seq_context_error(seq_context *ctx, const char *format, ...) __attribute__((format(printf, 2, 3)));
+size_t seq_context_error_count(seq_context *ctx);
+
+// Copy the newest message into buffer[size] and remove it; false when the stack is empty
+bool   seq_context_error_pop(seq_context *ctx, char *buffer, size_t size);
+void   seq_context_error_clear(seq_context *ctx);
+
+#endif // SEQUELIZER_SEQ_CONTEXT_H
@@ -0,0 +1,456 @@
+// **********************************************************************
+// core/seq_input.c - Plain, gzip and BGZF Sequence Input Streams
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_input.h"
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// BGZF blocks are at most 64 KiB compressed and uncompressed; gzip streams are
+// inflated in slots of the same size
+#define SEQ_INPUT_SLOT_SIZE 65536
+#define SEQ_INPUT_GZIP_SLOTS 4
+#define SEQ_INPUT_GZIP_READ_SIZE (256 * 1024)
+
+typedef enum {
+  SLOT_FREE,               // Waiting for the reader
+  SLOT_LOADED,             // BGZF block read, waiting for a worker
+  SLOT_READY               // Decompressed bytes ready for seq_input_read
+} slot_state_t;
+
+typedef struct {
+  uint8_t *block;          // Whole BGZF block (header, deflate data, CRC32, ISIZE)
+  size_t block_size;
+  size_t data_offset;      // Start of the deflate data within block
+  uint8_t *data;
+  size_t size;
+  size_t used;             // Bytes already returned to the consumer
+  bool failed;
+  slot_state_t state;
+} input_slot_t;
+
+struct seq_input {
+  int fd;
+  char *path;
+  seq_input_format format;
+
+  // Slot ring, in file order: reader fills loaded % capacity, workers inflate
+  // claimed % capacity, the consumer drains consumed % capacity
+  input_slot_t *slots;
+  size_t capacity;
+  size_t loaded;
+  size_t claimed;
+  size_t consumed;
+  bool end_of_input;       // Reader has loaded its last slot
+  bool read_error;         // ...because of an error (truncated or corrupt input)
+  bool stop;               // Set by close
+
+  pthread_mutex_t lock;
+  pthread_cond_t slot_loaded;
+  pthread_cond_t slot_ready;
+  pthread_cond_t slot_free;
+  pthread_t reader;
+  bool reader_started;
+  pthread_t *workers;
+  int num_workers;
+};
+
+// **********************************************************************
+// Raw File Reads
+// **********************************************************************
+
+// Read exactly size bytes unless the file ends first; bytes read or -1
+static ssize_t read_full(int fd, void *buffer, size_t size) {
+  size_t got = 0;
+  while (got < size) {
+    ssize_t n = read(fd, (uint8_t*)buffer + got, size - got);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) return -1;
+    if (n == 0) break;
+    got += (size_t)n;
+  }
+  return (ssize_t)got;
+}
+
+static uint16_t le16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// gzip member whose extra field carries the BGZF "BC" block-size subfield
+static bool is_bgzf_header(const uint8_t *header, size_t size) {
+  if (size < 18 || header[0] != 0x1f || header[1] != 0x8b || header[2] != 8 || !(header[3] & 4)) return false;
+  return le16(header + 10) >= 6 && header[12] == 'B' && header[13] == 'C' && le16(header + 14) == 2;
+}
+
+// **********************************************************************
+// Slot Ring (callers hold input->lock)
+// **********************************************************************
+
+// Wait for the next slot to fill; NULL if input is closing
+static input_slot_t* wait_free_slot(seq_input_t *input) {
+  while (input->loaded - input->consumed >= input->capacity && !input->stop) {
+    pthread_cond_wait(&input->slot_free, &input->lock);
+  }
+  return input->stop ? NULL : &input->slots[input->loaded % input->capacity];
+}
+
+static void finish_input(seq_input_t *input, bool error) {
+  input->end_of_input = true;
+  input->read_error = error;
+  pthread_cond_broadcast(&input->slot_loaded);
+  pthread_cond_broadcast(&input->slot_ready);
+}
+
+// **********************************************************************
+// BGZF Blocks
+// **********************************************************************
+
+// Raw-deflate the block's payload into slot->data and check its CRC32 and length
+static void inflate_block(input_slot_t *slot) {
+  slot->size = 0;
+  slot->failed = true;
+  if (slot->block_size < slot->data_offset + 8) return;
+
+  const uint8_t *footer = slot->block + slot->block_size - 8;
+  uint32_t expected_crc = le32(footer);
+  uint32_t expected_size = le32(footer + 4);
+  if (expected_size > SEQ_INPUT_SLOT_SIZE) return;
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -15) != Z_OK) return;
+  stream.next_in = slot->block + slot->data_offset;
+  stream.avail_in = (uInt)(slot->block_size - slot->data_offset - 8);
+  stream.next_out = slot->data;
+  stream.avail_out = SEQ_INPUT_SLOT_SIZE;
+  int status = inflate(&stream, Z_FINISH);
+  size_t size = SEQ_INPUT_SLOT_SIZE - stream.avail_out;
+  inflateEnd(&stream);
+
+  if (status != Z_STREAM_END || size != expected_size) return;
+  if (crc32(crc32(0L, Z_NULL, 0), slot->data, (uInt)size) != expected_crc) return;
+  slot->size = size;
+  slot->failed = false;
+}
+
+// Read one whole block into slot; 1 = loaded, 0 = clean end of file, -1 = error
+static int load_block(seq_input_t *input, input_slot_t *slot) {
+  uint8_t *block = slot->block;
+  ssize_t n = read_full(input->fd, block, 12);
+  if (n == 0) return 0;
+  if (n != 12 || block[0] != 0x1f || block[1] != 0x8b || block[2] != 8 || !(block[3] & 4)) return -1;
+
+  // Extra field: find the BC subfield holding the block size minus one
+  size_t extra_length = le16(block + 10);
+  if (12 + extra_length > SEQ_INPUT_SLOT_SIZE || read_full(input->fd, block + 12, extra_length) != (ssize_t)extra_length) {
+    return -1;
+  }
+  size_t block_size = 0;
+  for (size_t p = 12; p + 4 <= 12 + extra_length; ) {
+    size_t field_length = le16(block + p + 2);
+    if (block[p] == 'B' && block[p + 1] == 'C' && field_length == 2 && p + 6 <= 12 + extra_length) {
+      block_size = (size_t)le16(block + p + 4) + 1;
+    }
+    p += 4 + field_length;
+  }
+  if (block_size < 12 + extra_length + 8 || block_size > SEQ_INPUT_SLOT_SIZE) return -1;
+
+  size_t rest = block_size - 12 - extra_length;
+  if (read_full(input->fd, block + 12 + extra_length, rest) != (ssize_t)rest) return -1;
+  slot->block_size = block_size;
+  slot->data_offset = 12 + extra_length;
+  return 1;
+}
+
+// Reader: blocks go to the workers (or are inflated here without any)
+static void read_bgzf_blocks(seq_input_t *input) {
+  pthread_mutex_lock(&input->lock);
+  while (true) {
+    input_slot_t *slot = wait_free_slot(input);
+    if (!slot) break;
+    pthread_mutex_unlock(&input->lock);
+
+    int status = load_block(input, slot);
+    if (status > 0 && input->num_workers == 0) inflate_block(slot);
+
+    pthread_mutex_lock(&input->lock);
+    if (status <= 0) {
+      finish_input(input, status < 0);
+      break;
+    }
+    slot->used = 0;
+    slot->state = input->num_workers == 0 ? SLOT_READY : SLOT_LOADED;
+    input->loaded++;
+    pthread_cond_signal(input->num_workers == 0 ? &input->slot_ready : &input->slot_loaded);
+  }
+  pthread_mutex_unlock(&input->lock);
+}
+
+static void* bgzf_worker(void *arg) {
+  seq_input_t *input = arg;
+  pthread_mutex_lock(&input->lock);
+  while (true) {
+    while (input->claimed == input->loaded && !input->end_of_input && !input->stop) {
+      pthread_cond_wait(&input->slot_loaded, &input->lock);
+    }
+    if (input->stop || input->claimed == input->loaded) break;
+    input_slot_t *slot = &input->slots[input->claimed % input->capacity];
+    input->claimed++;
+    pthread_mutex_unlock(&input->lock);
+
+    inflate_block(slot);
+
+    pthread_mutex_lock(&input->lock);
+    slot->state = SLOT_READY;
+    pthread_cond_broadcast(&input->slot_ready);
+  }
+  pthread_mutex_unlock(&input->lock);
+  return NULL;
+}
+
+// **********************************************************************
+// gzip Streams
+// **********************************************************************
+
+// One inflate stream on the reader thread, filling slots ahead of the parser;
+// concatenated members (as written by cat a.gz b.gz) are read back to back
+static void read_gzip_stream(seq_input_t *input) {
+  uint8_t *compressed = malloc(SEQ_INPUT_GZIP_READ_SIZE);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (!compressed || inflateInit2(&stream, 15 + 32) != Z_OK) {
+    free(compressed);
+    pthread_mutex_lock(&input->lock);
+    finish_input(input, true);
+    pthread_mutex_unlock(&input->lock);
+    return;
+  }
+
+  bool error = false;
+  bool input_done = false;
+  bool member_complete = false;  // Last inflate call ended a gzip member
+  pthread_mutex_lock(&input->lock);
+  while (true) {
+    input_slot_t *slot = wait_free_slot(input);
+    if (!slot) break;
+    pthread_mutex_unlock(&input->lock);
+
+    stream.next_out = slot->data;
+    stream.avail_out = SEQ_INPUT_SLOT_SIZE;
+    while (stream.avail_out > 0) {
+      if (stream.avail_in == 0 && !input_done) {
+        ssize_t n = read_full(input->fd, compressed, SEQ_INPUT_GZIP_READ_SIZE);
+        if (n < 0) {
+          error = true;
+          break;
+        }
+        input_done = n == 0;
+        stream.next_in = compressed;
+        stream.avail_in = (uInt)n;
+      }
+      if (member_complete && stream.avail_in == 0) break;   // Clean end of the last member
+
+      // Called even without new input: inflate may still hold output
+      uInt avail_out = stream.avail_out;
+      int status = inflate(&stream, Z_NO_FLUSH);
+      if (status == Z_STREAM_END) {
+        member_complete = true;
+        inflateReset(&stream);
+      } else if (status == Z_OK || (status == Z_BUF_ERROR && stream.avail_in > 0)) {
+        member_complete = false;
+      } else if (status == Z_BUF_ERROR && input_done) {
+        error = stream.avail_out == avail_out;   // No progress and no input left: truncated
+        if (error) break;
+      } else if (status != Z_BUF_ERROR) {
+        error = true;
+        break;
+      }
+    }
+    size_t size = SEQ_INPUT_SLOT_SIZE - stream.avail_out;
+
+    pthread_mutex_lock(&input->lock);
+    if (size > 0) {
+      slot->size = size;
+      slot->used = 0;
+      slot->failed = false;
+      slot->state = SLOT_READY;
+      input->loaded++;
+      pthread_cond_signal(&input->slot_ready);
+    }
+    if (error || size < SEQ_INPUT_SLOT_SIZE) {
+      finish_input(input, error);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&input->lock);
+
+  inflateEnd(&stream);
+  free(compressed);
+}
+
+static void* input_reader(void *arg) {
+  seq_input_t *input = arg;
+  if (input->format == SEQ_INPUT_BGZF) {
+    read_bgzf_blocks(input);
+  } else {
+    read_gzip_stream(input);
+  }
+  return NULL;
+}
+
+// **********************************************************************
+// Public API
+// **********************************************************************
+seq_input_t* seq_input_open(const char *path, int threads) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    warnx("Failed to open \"%s\" for input", path);
+    return NULL;
+  }
+
+  seq_input_t *input = calloc(1, sizeof(seq_input_t));
+  if (!input || !(input->path = strdup(path))) {
+    errx(EXIT_FAILURE, "Memory allocation failed for input stream");
+  }
+  input->fd = fd;
+
+  // Sniff the format without consuming anything (pipes cannot be sniffed: plain)
+  uint8_t header[18];
+  ssize_t n = pread(fd, header, sizeof(header), 0);
+  input->format = SEQ_INPUT_PLAIN;
+  if (n >= 2 && header[0] == 0x1f && header[1] == 0x8b) {
+    input->format = is_bgzf_header(header, (size_t)n) ? SEQ_INPUT_BGZF : SEQ_INPUT_GZIP;
+  }
+  if (input->format == SEQ_INPUT_PLAIN) return input;
+
+  input->num_workers = input->format == SEQ_INPUT_BGZF && threads > 1 ? threads : 0;
+  input->capacity = input->format == SEQ_INPUT_BGZF ? 4 * (size_t)input->num_workers + 4 : SEQ_INPUT_GZIP_SLOTS;
+  input->slots = calloc(input->capacity, sizeof(input_slot_t));
+  if (!input->slots) {
+    errx(EXIT_FAILURE, "Memory allocation failed for input stream");
+  }
+  for (size_t i = 0; i < input->capacity; i++) {
+    input->slots[i].data = malloc(SEQ_INPUT_SLOT_SIZE);
+    if (input->format == SEQ_INPUT_BGZF) input->slots[i].block = malloc(SEQ_INPUT_SLOT_SIZE);
+    if (!input->slots[i].data || (input->format == SEQ_INPUT_BGZF && !input->slots[i].block)) {
+      errx(EXIT_FAILURE, "Memory allocation failed for input stream");
+    }
+  }
+
+  pthread_mutex_init(&input->lock, NULL);
+  pthread_cond_init(&input->slot_loaded, NULL);
+  pthread_cond_init(&input->slot_ready, NULL);
+  pthread_cond_init(&input->slot_free, NULL);
+  if (input->num_workers > 0) {
+    input->workers = calloc((size_t)input->num_workers, sizeof(pthread_t));
+    if (!input->workers) {
+      errx(EXIT_FAILURE, "Memory allocation failed for input stream");
+    }
+    for (int t = 0; t < input->num_workers; t++) {
+      if (pthread_create(&input->workers[t], NULL, bgzf_worker, input) != 0) {
+        errx(EXIT_FAILURE, "Failed to create decompression thread %d", t);
+      }
+    }
+  }
+  if (pthread_create(&input->reader, NULL, input_reader, input) != 0) {
+    errx(EXIT_FAILURE, "Failed to create input reader thread");
+  }
+  input->reader_started = true;
+  return input;
+}
+
+int seq_input_read(seq_input_t *input, void *buffer, int size) {
+  if (!input || size <= 0) return -1;
+
+  if (input->format == SEQ_INPUT_PLAIN) {
+    ssize_t n;
+    do {
+      n = read(input->fd, buffer, (size_t)size);
+    } while (n < 0 && errno == EINTR);
+    return (int)n;
+  }
+
+  pthread_mutex_lock(&input->lock);
+  input_slot_t *slot = &input->slots[input->consumed % input->capacity];
+  while (!(input->consumed < input->loaded && slot->state == SLOT_READY) &&
+         !(input->consumed == input->loaded && input->end_of_input)) {
+    pthread_cond_wait(&input->slot_ready, &input->lock);
+  }
+  if (input->consumed == input->loaded) {
+    bool error = input->read_error;
+    pthread_mutex_unlock(&input->lock);
+    if (error) warnx("Truncated or corrupt compressed input: %s", input->path);
+    return error ? -1 : 0;
+  }
+  pthread_mutex_unlock(&input->lock);
+
+  if (slot->failed) {
+    warnx("Corrupt compressed block in %s", input->path);
+    return -1;
+  }
+
+  // The slot is ours until it is released below
+  size_t n = slot->size - slot->used;
+  if (n > (size_t)size) n = (size_t)size;
+  memcpy(buffer, slot->data + slot->used, n);
+  slot->used += n;
+
+  if (slot->used == slot->size) {
+    pthread_mutex_lock(&input->lock);
+    slot->state = SLOT_FREE;
+    input->consumed++;
+    pthread_cond_signal(&input->slot_free);
+    pthread_mutex_unlock(&input->lock);
+  }
+
+  // An empty block (the BGZF end-of-file marker) carries no bytes: move on
+  return n > 0 ? (int)n : seq_input_read(input, buffer, size);
+}
+
+seq_input_format seq_input_get_format(const seq_input_t *input) {
+  return input ? input->format : SEQ_INPUT_PLAIN;
+}
+
+void seq_input_close(seq_input_t *input) {
+  if (!input) return;
+
+  if (input->format != SEQ_INPUT_PLAIN) {
+    pthread_mutex_lock(&input->lock);
+    input->stop = true;
+    pthread_cond_broadcast(&input->slot_free);
+    pthread_cond_broadcast(&input->slot_loaded);
+    pthread_mutex_unlock(&input->lock);
+
+    if (input->reader_started) pthread_join(input->reader, NULL);
+    for (int t = 0; t < input->num_workers; t++) {
+      pthread_join(input->workers[t], NULL);
+    }
+    free(input->workers);
+    for (size_t i = 0; i < input->capacity; i++) {
+      free(input->slots[i].data);
+      free(input->slots[i].block);
+    }
+    free(input->slots);
+    pthread_cond_destroy(&input->slot_free);
+    pthread_cond_destroy(&input->slot_ready);
+    pthread_cond_destroy(&input->slot_loaded);
+    pthread_mutex_destroy(&input->lock);
+  }
+
+  close(input->fd);
+  free(input->path);
+  free(input);
+}
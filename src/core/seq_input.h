@@ -0,0 +1,39 @@
+// **********************************************************************
+// core/seq_input.h - Plain, gzip and BGZF Sequence Input Streams
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Byte source for the kseq FASTA/FASTQ parser. The format is detected from
+// the file's first bytes: plain files are read directly, gzip streams are
+// inflated on a background thread (so decompression overlaps parsing), and
+// BGZF files (bgzip/samtools output: independent gzip blocks of <= 64 KiB
+// that record their own size) have their blocks inflated by a pool of
+// threads and handed back strictly in file order.
+//
+// Use with kseq as: KSEQ_INIT(seq_input_t*, seq_input_read)
+#ifndef SEQUELIZER_SEQ_INPUT_H
+#define SEQUELIZER_SEQ_INPUT_H
+
+#include <stddef.h>
+
+typedef enum {
+  SEQ_INPUT_PLAIN,
+  SEQ_INPUT_GZIP,
+  SEQ_INPUT_BGZF
+} seq_input_format;
+
+typedef struct seq_input seq_input_t;
+
+// Open path for reading; threads is the number of BGZF inflate workers (<= 1
+// inflates on the read-ahead thread). NULL with a warning on failure
+seq_input_t* seq_input_open(const char *path, int threads);
+
+// Up to size decompressed bytes into buffer: bytes read, 0 at end of input, -1 on a
+// read or decompression error (kseq's read() contract)
+int seq_input_read(seq_input_t *input, void *buffer, int size);
+
+seq_input_format seq_input_get_format(const seq_input_t *input);
+
+void seq_input_close(seq_input_t *input);
+
+#endif // SEQUELIZER_SEQ_INPUT_H
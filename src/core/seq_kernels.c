@@ -0,0 +1,784 @@
+// **********************************************************************
+// core/seq_kernels.c - Dispatched Numeric Kernels for seq_tensor Data
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+
+#include "seq_kernels.h"
+#include <err.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SEQ_KERNELS_HAVE_AVX2 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define SEQ_KERNELS_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Saturation bounds as floats (INT32_MAX is not representable; use the largest float below it)
+#define I8_LO  -128.0f
+#define I8_HI   127.0f
+#define I16_LO -32768.0f
+#define I16_HI  32767.0f
+#define I32_LO -2147483648.0f
+#define I32_HI  2147483520.0f
+
+typedef struct {
+  void (*affine_i8_f32)(const int8_t *, float *, size_t, float, float);
+  void (*affine_i16_f32)(const int16_t *, float *, size_t, float, float);
+  void (*affine_i32_f32)(const int32_t *, float *, size_t, float, float);
+  void (*affine_f32_f32)(const float *, float *, size_t, float, float);
+  void (*quantise_f32_i8)(const float *, int8_t *, size_t, float, float);
+  void (*quantise_f32_i16)(const float *, int16_t *, size_t, float, float);
+  void (*quantise_f32_i32)(const float *, int32_t *, size_t, float, float);
+  void (*moments_f32)(const float *, size_t, double *, double *);
+  void (*moments_i16)(const int16_t *, size_t, double *, double *);
+  void (*minmax_f32)(const float *, size_t, float *, float *);
+  void (*summary_i16)(const int16_t *, size_t, int16_t, int16_t, seq_kernel_i16_summary *);
+} seq_kernel_table;
+
+// **********************************************************************
+// Scalar Kernels (reference semantics; also used for vector tails)
+// **********************************************************************
+
+#define DEFINE_AFFINE_SCALAR(name, in_type)                                                     \
+  static void name(const in_type *restrict in, float *restrict out, size_t n, float a, float b) { \
+    for (size_t i = 0; i < n; i++) out[i] = (float)in[i] * a + b;                                 \
+  }
+DEFINE_AFFINE_SCALAR(affine_i8_f32_scalar, int8_t)
+DEFINE_AFFINE_SCALAR(affine_i16_f32_scalar, int16_t)
+DEFINE_AFFINE_SCALAR(affine_i32_f32_scalar, int32_t)
+DEFINE_AFFINE_SCALAR(affine_f32_f32_scalar, float)
+
+// Clamp written so that NaN takes the lower bound (matches maxps/vmaxnm)
+static inline float saturate(float v, float lo, float hi) {
+  v = (v >= lo) ? v : lo;
+  return (v <= hi) ? v : hi;
+}
+
+#define DEFINE_QUANTISE_SCALAR(name, out_type, lo, hi)                                          \
+  static void name(const float *restrict in, out_type *restrict out, size_t n, float a, float b) { \
+    for (size_t i = 0; i < n; i++) out[i] = (out_type)lrintf(saturate(in[i] * a + b, lo, hi));    \
+  }
+DEFINE_QUANTISE_SCALAR(quantise_f32_i8_scalar, int8_t, I8_LO, I8_HI)
+DEFINE_QUANTISE_SCALAR(quantise_f32_i16_scalar, int16_t, I16_LO, I16_HI)
+DEFINE_QUANTISE_SCALAR(quantise_f32_i32_scalar, int32_t, I32_LO, I32_HI)
+
+// Two passes (mean, then squared deviations) to avoid cancellation
+static void moments_f32_scalar(const float *in, size_t n, double *mean, double *m2) {
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++) sum += in[i];
+  double mu = sum / (double)n;
+  double acc = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    double d = (double)in[i] - mu;
+    acc += d * d;
+  }
+  *mean = mu;
+  *m2 = acc;
+}
+
+// Exact integer sums, so every backend agrees
+static void moments_from_sums(int64_t sum, uint64_t sum_sq, size_t n, double *mean, double *m2) {
+  double mu = (double)sum / (double)n;
+  *mean = mu;
+  *m2 = (double)sum_sq - (double)sum * mu;
+  if (*m2 < 0.0) *m2 = 0.0;
+}
+
+static void moments_i16_scalar(const int16_t *in, size_t n, double *mean, double *m2) {
+  int64_t sum = 0;
+  uint64_t sum_sq = 0;
+  for (size_t i = 0; i < n; i++) {
+    int32_t v = in[i];
+    sum += v;
+    sum_sq += (uint64_t)(v * v);
+  }
+  moments_from_sums(sum, sum_sq, n, mean, m2);
+}
+
+static void minmax_f32_scalar(const float *in, size_t n, float *min, float *max) {
+  float lo = in[0], hi = in[0];
+  for (size_t i = 1; i < n; i++) {
+    if (in[i] < lo) lo = in[i];
+    if (in[i] > hi) hi = in[i];
+  }
+  *min = lo;
+  *max = hi;
+}
+
+static void summary_i16_scalar(const int16_t *in, size_t n, int16_t lo, int16_t hi, seq_kernel_i16_summary *s) {
+  int64_t sum = 0;
+  uint64_t sum_sq = 0, below = 0, above = 0;
+  int16_t mn = INT16_MAX, mx = INT16_MIN;
+  for (size_t i = 0; i < n; i++) {
+    int32_t v = in[i];
+    sum += v;
+    sum_sq += (uint64_t)(v * v);
+    if (in[i] < mn) mn = in[i];
+    if (in[i] > mx) mx = in[i];
+    below += in[i] <= lo;
+    above += in[i] >= hi;
+  }
+  s->sum = sum;
+  s->sum_sq = sum_sq;
+  s->min = mn;
+  s->max = mx;
+  s->below = below;
+  s->above = above;
+}
+
+static const seq_kernel_table scalar_kernels = {
+  affine_i8_f32_scalar, affine_i16_f32_scalar, affine_i32_f32_scalar, affine_f32_f32_scalar,
+  quantise_f32_i8_scalar, quantise_f32_i16_scalar, quantise_f32_i32_scalar,
+  moments_f32_scalar, moments_i16_scalar, minmax_f32_scalar, summary_i16_scalar
+};
+
+// Vector rail counters are 16-bit lanes; fold them into 64-bit totals this often
+#define SUMMARY_FLUSH_VECTORS 4096
+
+// **********************************************************************
+// AVX2 Kernels (8 floats per vector)
+// **********************************************************************
+#ifdef SEQ_KERNELS_HAVE_AVX2
+
+AVX2_TARGET static void affine_i8_f32_avx2(const int8_t *in, float *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i q = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(in + i)));
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(q), va), vb));
+  }
+  affine_i8_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+AVX2_TARGET static void affine_i16_f32_avx2(const int16_t *in, float *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i q = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in + i)));
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(q), va), vb));
+  }
+  affine_i16_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+AVX2_TARGET static void affine_i32_f32_avx2(const int32_t *in, float *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i q = _mm256_loadu_si256((const __m256i *)(in + i));
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(q), va), vb));
+  }
+  affine_i32_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+AVX2_TARGET static void affine_f32_f32_avx2(const float *in, float *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), va), vb));
+  }
+  affine_f32_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+// in * a + b, saturated in float then rounded (MXCSR default: nearest even)
+AVX2_TARGET static inline __m256i quantise8_avx2(const float *in, __m256 va, __m256 vb, __m256 lo, __m256 hi) {
+  __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in), va), vb);
+  v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);   // max_ps returns lo for NaN
+  return _mm256_cvtps_epi32(v);
+}
+
+AVX2_TARGET static void quantise_f32_i8_avx2(const float *in, int8_t *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  const __m256 lo = _mm256_set1_ps(I8_LO), hi = _mm256_set1_ps(I8_HI);
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i p01 = _mm256_packs_epi32(quantise8_avx2(in + i, va, vb, lo, hi),
+                                     quantise8_avx2(in + i + 8, va, vb, lo, hi));
+    __m256i p23 = _mm256_packs_epi32(quantise8_avx2(in + i + 16, va, vb, lo, hi),
+                                     quantise8_avx2(in + i + 24, va, vb, lo, hi));
+    // Packs work per 128-bit lane; restore element order across lanes
+    __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(p01, p23), order);
+    _mm256_storeu_si256((__m256i *)(out + i), bytes);
+  }
+  quantise_f32_i8_scalar(in + i, out + i, n - i, a, b);
+}
+
+AVX2_TARGET static void quantise_f32_i16_avx2(const float *in, int16_t *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  const __m256 lo = _mm256_set1_ps(I16_LO), hi = _mm256_set1_ps(I16_HI);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i packed = _mm256_packs_epi32(quantise8_avx2(in + i, va, vb, lo, hi),
+                                        quantise8_avx2(in + i + 8, va, vb, lo, hi));
+    _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+  }
+  quantise_f32_i16_scalar(in + i, out + i, n - i, a, b);
+}
+
+AVX2_TARGET static void quantise_f32_i32_avx2(const float *in, int32_t *out, size_t n, float a, float b) {
+  const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+  const __m256 lo = _mm256_set1_ps(I32_LO), hi = _mm256_set1_ps(I32_HI);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_si256((__m256i *)(out + i), quantise8_avx2(in + i, va, vb, lo, hi));
+  }
+  quantise_f32_i32_scalar(in + i, out + i, n - i, a, b);
+}
+
+AVX2_TARGET static inline double hsum_pd_avx2(__m256d v) {
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+AVX2_TARGET static void moments_f32_avx2(const float *in, size_t n, double *mean, double *m2) {
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(in + i);
+    s0 = _mm256_add_pd(s0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+    s1 = _mm256_add_pd(s1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+  }
+  double sum = hsum_pd_avx2(_mm256_add_pd(s0, s1));
+  for (size_t j = i; j < n; j++) sum += in[j];
+  double mu = sum / (double)n;
+
+  const __m256d vmu = _mm256_set1_pd(mu);
+  s0 = _mm256_setzero_pd();
+  s1 = _mm256_setzero_pd();
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(in + i);
+    __m256d d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), vmu);
+    __m256d d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), vmu);
+    s0 = _mm256_add_pd(s0, _mm256_mul_pd(d0, d0));
+    s1 = _mm256_add_pd(s1, _mm256_mul_pd(d1, d1));
+  }
+  double acc = hsum_pd_avx2(_mm256_add_pd(s0, s1));
+  for (; i < n; i++) {
+    double d = (double)in[i] - mu;
+    acc += d * d;
+  }
+  *mean = mu;
+  *m2 = acc;
+}
+
+AVX2_TARGET static inline uint64_t hsum_epi64_avx2(__m256i v) {
+  __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  return (uint64_t)_mm_cvtsi128_si64(s) + (uint64_t)_mm_extract_epi64(s, 1);
+}
+
+AVX2_TARGET static void moments_i16_avx2(const int16_t *in, size_t n, double *mean, double *m2) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i sum = _mm256_setzero_si256(), sum_sq = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+    // Pair sums fit int32; pair sums of squares fit uint32 (at most 2 * 2^30)
+    __m256i pairs = _mm256_madd_epi16(v, ones);
+    __m256i squares = _mm256_madd_epi16(v, v);
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    sum_sq = _mm256_add_epi64(sum_sq, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(squares)));
+    sum_sq = _mm256_add_epi64(sum_sq, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(squares, 1)));
+  }
+  int64_t total = (int64_t)hsum_epi64_avx2(sum);
+  uint64_t total_sq = hsum_epi64_avx2(sum_sq);
+  for (; i < n; i++) {
+    int32_t v = in[i];
+    total += v;
+    total_sq += (uint64_t)(v * v);
+  }
+  moments_from_sums(total, total_sq, n, mean, m2);
+}
+
+AVX2_TARGET static void minmax_f32_avx2(const float *in, size_t n, float *min, float *max) {
+  if (n < 8) {
+    minmax_f32_scalar(in, n, min, max);
+    return;
+  }
+  __m256 lo = _mm256_loadu_ps(in), hi = lo;
+  size_t i = 8;
+  for (; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(in + i);
+    lo = _mm256_min_ps(lo, v);
+    hi = _mm256_max_ps(hi, v);
+  }
+  float lanes_lo[8], lanes_hi[8];
+  _mm256_storeu_ps(lanes_lo, lo);
+  _mm256_storeu_ps(lanes_hi, hi);
+  float rlo = lanes_lo[0], rhi = lanes_hi[0];
+  for (int k = 1; k < 8; k++) {
+    if (lanes_lo[k] < rlo) rlo = lanes_lo[k];
+    if (lanes_hi[k] > rhi) rhi = lanes_hi[k];
+  }
+  for (; i < n; i++) {
+    if (in[i] < rlo) rlo = in[i];
+    if (in[i] > rhi) rhi = in[i];
+  }
+  *min = rlo;
+  *max = rhi;
+}
+
+AVX2_TARGET static inline int16_t hmin_epi16_avx2(__m256i v) {
+  __m128i m = _mm_min_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  // minpos works on unsigned words: bias by 0x8000 and back
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  return (int16_t)(_mm_cvtsi128_si32(_mm_minpos_epu16(_mm_xor_si128(m, bias))) ^ 0x8000);
+}
+
+AVX2_TARGET static inline int16_t hmax_epi16_avx2(__m256i v) {
+  __m128i m = _mm_max_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  const __m128i flip = _mm_set1_epi16(0x7FFF);
+  return (int16_t)(_mm_cvtsi128_si32(_mm_minpos_epu16(_mm_xor_si128(m, flip))) ^ 0x7FFF);
+}
+
+// Each count lane holds at most SUMMARY_FLUSH_VECTORS, so pair sums fit int32
+AVX2_TARGET static inline __m256i widen_counts_avx2(__m256i total, __m256i counts) {
+  __m256i pairs = _mm256_madd_epi16(counts, _mm256_set1_epi16(1));
+  total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+  return _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+}
+
+AVX2_TARGET static void summary_i16_avx2(const int16_t *in, size_t n, int16_t lo, int16_t hi,
+                                         seq_kernel_i16_summary *s) {
+  if (n < 16) {
+    summary_i16_scalar(in, n, lo, hi, s);
+    return;
+  }
+  const __m256i ones = _mm256_set1_epi16(1);
+  const __m256i vlo = _mm256_set1_epi16(lo), vhi = _mm256_set1_epi16(hi);
+  __m256i sum = _mm256_setzero_si256(), sum_sq = _mm256_setzero_si256();
+  __m256i below = _mm256_setzero_si256(), above = _mm256_setzero_si256();
+  __m256i nbelow = _mm256_setzero_si256(), nabove = _mm256_setzero_si256();
+  __m256i mn = _mm256_set1_epi16(INT16_MAX), mx = _mm256_set1_epi16(INT16_MIN);
+  size_t i = 0, pending = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+    __m256i pairs = _mm256_madd_epi16(v, ones);
+    __m256i squares = _mm256_madd_epi16(v, v);
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    sum_sq = _mm256_add_epi64(sum_sq, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(squares)));
+    sum_sq = _mm256_add_epi64(sum_sq, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(squares, 1)));
+    mn = _mm256_min_epi16(mn, v);
+    mx = _mm256_max_epi16(mx, v);
+    // v <= lo exactly when min(v, lo) == v; the all-ones mask is -1 per lane
+    nbelow = _mm256_sub_epi16(nbelow, _mm256_cmpeq_epi16(_mm256_min_epi16(v, vlo), v));
+    nabove = _mm256_sub_epi16(nabove, _mm256_cmpeq_epi16(_mm256_max_epi16(v, vhi), v));
+    if (++pending == SUMMARY_FLUSH_VECTORS) {
+      below = widen_counts_avx2(below, nbelow);
+      above = widen_counts_avx2(above, nabove);
+      nbelow = nabove = _mm256_setzero_si256();
+      pending = 0;
+    }
+  }
+  below = widen_counts_avx2(below, nbelow);
+  above = widen_counts_avx2(above, nabove);
+
+  seq_kernel_i16_summary tail;
+  summary_i16_scalar(in + i, n - i, lo, hi, &tail);
+  s->sum = (int64_t)hsum_epi64_avx2(sum);
+  s->sum_sq = hsum_epi64_avx2(sum_sq);
+  s->min = hmin_epi16_avx2(mn);
+  s->max = hmax_epi16_avx2(mx);
+  s->below = hsum_epi64_avx2(below);
+  s->above = hsum_epi64_avx2(above);
+  seq_kernel_summary_merge(s, &tail);
+}
+
+static const seq_kernel_table avx2_kernels = {
+  affine_i8_f32_avx2, affine_i16_f32_avx2, affine_i32_f32_avx2, affine_f32_f32_avx2,
+  quantise_f32_i8_avx2, quantise_f32_i16_avx2, quantise_f32_i32_avx2,
+  moments_f32_avx2, moments_i16_avx2, minmax_f32_avx2, summary_i16_avx2
+};
+
+#endif // SEQ_KERNELS_HAVE_AVX2
+
+// **********************************************************************
+// NEON Kernels (AArch64, 4 floats per vector)
+// **********************************************************************
+#ifdef SEQ_KERNELS_HAVE_NEON
+
+static inline void affine4_neon(int32x4_t q, float *out, float32x4_t va, float32x4_t vb) {
+  vst1q_f32(out, vaddq_f32(vmulq_f32(vcvtq_f32_s32(q), va), vb));
+}
+
+static void affine_i8_f32_neon(const int8_t *in, float *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t q = vmovl_s8(vld1_s8(in + i));
+    affine4_neon(vmovl_s16(vget_low_s16(q)), out + i, va, vb);
+    affine4_neon(vmovl_s16(vget_high_s16(q)), out + i + 4, va, vb);
+  }
+  affine_i8_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+static void affine_i16_f32_neon(const int16_t *in, float *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t q = vld1q_s16(in + i);
+    affine4_neon(vmovl_s16(vget_low_s16(q)), out + i, va, vb);
+    affine4_neon(vmovl_s16(vget_high_s16(q)), out + i + 4, va, vb);
+  }
+  affine_i16_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+static void affine_i32_f32_neon(const int32_t *in, float *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    affine4_neon(vld1q_s32(in + i), out + i, va, vb);
+  }
+  affine_i32_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+static void affine_f32_f32_neon(const float *in, float *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(out + i, vaddq_f32(vmulq_f32(vld1q_f32(in + i), va), vb));
+  }
+  affine_f32_f32_scalar(in + i, out + i, n - i, a, b);
+}
+
+// in * a + b, saturated (vmaxnm returns lo for NaN) and rounded to nearest even
+static inline int32x4_t quantise4_neon(const float *in, float32x4_t va, float32x4_t vb,
+                                       float32x4_t lo, float32x4_t hi) {
+  float32x4_t v = vaddq_f32(vmulq_f32(vld1q_f32(in), va), vb);
+  return vcvtnq_s32_f32(vminnmq_f32(vmaxnmq_f32(v, lo), hi));
+}
+
+static void quantise_f32_i8_neon(const float *in, int8_t *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  const float32x4_t lo = vdupq_n_f32(I8_LO), hi = vdupq_n_f32(I8_HI);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t q = vcombine_s16(vqmovn_s32(quantise4_neon(in + i, va, vb, lo, hi)),
+                               vqmovn_s32(quantise4_neon(in + i + 4, va, vb, lo, hi)));
+    vst1_s8(out + i, vqmovn_s16(q));
+  }
+  quantise_f32_i8_scalar(in + i, out + i, n - i, a, b);
+}
+
+static void quantise_f32_i16_neon(const float *in, int16_t *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  const float32x4_t lo = vdupq_n_f32(I16_LO), hi = vdupq_n_f32(I16_HI);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_s16(out + i, vcombine_s16(vqmovn_s32(quantise4_neon(in + i, va, vb, lo, hi)),
+                                    vqmovn_s32(quantise4_neon(in + i + 4, va, vb, lo, hi))));
+  }
+  quantise_f32_i16_scalar(in + i, out + i, n - i, a, b);
+}
+
+static void quantise_f32_i32_neon(const float *in, int32_t *out, size_t n, float a, float b) {
+  const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+  const float32x4_t lo = vdupq_n_f32(I32_LO), hi = vdupq_n_f32(I32_HI);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_s32(out + i, quantise4_neon(in + i, va, vb, lo, hi));
+  }
+  quantise_f32_i32_scalar(in + i, out + i, n - i, a, b);
+}
+
+static void moments_f32_neon(const float *in, size_t n, double *mean, double *m2) {
+  float64x2_t s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t v = vld1q_f32(in + i);
+    s0 = vaddq_f64(s0, vcvt_f64_f32(vget_low_f32(v)));
+    s1 = vaddq_f64(s1, vcvt_high_f64_f32(v));
+  }
+  double sum = vaddvq_f64(vaddq_f64(s0, s1));
+  for (size_t j = i; j < n; j++) sum += in[j];
+  double mu = sum / (double)n;
+
+  const float64x2_t vmu = vdupq_n_f64(mu);
+  s0 = vdupq_n_f64(0.0);
+  s1 = vdupq_n_f64(0.0);
+  for (i = 0; i + 4 <= n; i += 4) {
+    float32x4_t v = vld1q_f32(in + i);
+    float64x2_t d0 = vsubq_f64(vcvt_f64_f32(vget_low_f32(v)), vmu);
+    float64x2_t d1 = vsubq_f64(vcvt_high_f64_f32(v), vmu);
+    s0 = vaddq_f64(s0, vmulq_f64(d0, d0));
+    s1 = vaddq_f64(s1, vmulq_f64(d1, d1));
+  }
+  double acc = vaddvq_f64(vaddq_f64(s0, s1));
+  for (; i < n; i++) {
+    double d = (double)in[i] - mu;
+    acc += d * d;
+  }
+  *mean = mu;
+  *m2 = acc;
+}
+
+static void moments_i16_neon(const int16_t *in, size_t n, double *mean, double *m2) {
+  int64x2_t sum = vdupq_n_s64(0);
+  uint64x2_t sum_sq = vdupq_n_u64(0);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t v = vld1q_s16(in + i);
+    int16x4_t lo = vget_low_s16(v), hi = vget_high_s16(v);
+    sum = vpadalq_s32(sum, vaddl_s16(lo, hi));
+    // Squares fit int32 (at most 2^30) and are non-negative
+    sum_sq = vpadalq_u32(sum_sq, vreinterpretq_u32_s32(vmull_s16(lo, lo)));
+    sum_sq = vpadalq_u32(sum_sq, vreinterpretq_u32_s32(vmull_s16(hi, hi)));
+  }
+  int64_t total = vaddvq_s64(sum);
+  uint64_t total_sq = vaddvq_u64(sum_sq);
+  for (; i < n; i++) {
+    int32_t v = in[i];
+    total += v;
+    total_sq += (uint64_t)(v * v);
+  }
+  moments_from_sums(total, total_sq, n, mean, m2);
+}
+
+static void minmax_f32_neon(const float *in, size_t n, float *min, float *max) {
+  if (n < 4) {
+    minmax_f32_scalar(in, n, min, max);
+    return;
+  }
+  float32x4_t lo = vld1q_f32(in), hi = lo;
+  size_t i = 4;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t v = vld1q_f32(in + i);
+    lo = vminq_f32(lo, v);
+    hi = vmaxq_f32(hi, v);
+  }
+  float rlo = vminvq_f32(lo), rhi = vmaxvq_f32(hi);
+  for (; i < n; i++) {
+    if (in[i] < rlo) rlo = in[i];
+    if (in[i] > rhi) rhi = in[i];
+  }
+  *min = rlo;
+  *max = rhi;
+}
+
+static void summary_i16_neon(const int16_t *in, size_t n, int16_t lo, int16_t hi, seq_kernel_i16_summary *s) {
+  if (n < 8) {
+    summary_i16_scalar(in, n, lo, hi, s);
+    return;
+  }
+  const int16x8_t vlo = vdupq_n_s16(lo), vhi = vdupq_n_s16(hi);
+  int64x2_t sum = vdupq_n_s64(0);
+  uint64x2_t sum_sq = vdupq_n_u64(0), below = vdupq_n_u64(0), above = vdupq_n_u64(0);
+  uint16x8_t nbelow = vdupq_n_u16(0), nabove = vdupq_n_u16(0);
+  int16x8_t mn = vdupq_n_s16(INT16_MAX), mx = vdupq_n_s16(INT16_MIN);
+  size_t i = 0, pending = 0;
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t v = vld1q_s16(in + i);
+    int16x4_t vl = vget_low_s16(v), vh = vget_high_s16(v);
+    sum = vpadalq_s32(sum, vaddl_s16(vl, vh));
+    sum_sq = vpadalq_u32(sum_sq, vreinterpretq_u32_s32(vmull_s16(vl, vl)));
+    sum_sq = vpadalq_u32(sum_sq, vreinterpretq_u32_s32(vmull_s16(vh, vh)));
+    mn = vminq_s16(mn, v);
+    mx = vmaxq_s16(mx, v);
+    // Comparison masks are all ones (-1 as a count) per matching lane
+    nbelow = vsubq_u16(nbelow, vcleq_s16(v, vlo));
+    nabove = vsubq_u16(nabove, vcgeq_s16(v, vhi));
+    if (++pending == SUMMARY_FLUSH_VECTORS) {
+      below = vpadalq_u32(below, vpaddlq_u16(nbelow));
+      above = vpadalq_u32(above, vpaddlq_u16(nabove));
+      nbelow = nabove = vdupq_n_u16(0);
+      pending = 0;
+    }
+  }
+  below = vpadalq_u32(below, vpaddlq_u16(nbelow));
+  above = vpadalq_u32(above, vpaddlq_u16(nabove));
+
+  seq_kernel_i16_summary tail;
+  summary_i16_scalar(in + i, n - i, lo, hi, &tail);
+  s->sum = vaddvq_s64(sum);
+  s->sum_sq = vaddvq_u64(sum_sq);
+  s->min = vminvq_s16(mn);
+  s->max = vmaxvq_s16(mx);
+  s->below = vaddvq_u64(below);
+  s->above = vaddvq_u64(above);
+  seq_kernel_summary_merge(s, &tail);
+}
+
+static const seq_kernel_table neon_kernels = {
+  affine_i8_f32_neon, affine_i16_f32_neon, affine_i32_f32_neon, affine_f32_f32_neon,
+  quantise_f32_i8_neon, quantise_f32_i16_neon, quantise_f32_i32_neon,
+  moments_f32_neon, moments_i16_neon, minmax_f32_neon, summary_i16_neon
+};
+
+#endif // SEQ_KERNELS_HAVE_NEON
+
+// **********************************************************************
+// Dispatch
+// **********************************************************************
+
+static const seq_kernel_table *active_kernels = &scalar_kernels;
+static seq_kernel_backend active_backend = SEQ_KERNEL_SCALAR;
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+bool seq_kernel_backend_supported(seq_kernel_backend backend) {
+  switch (backend) {
+    case SEQ_KERNEL_SCALAR:
+      return true;
+    case SEQ_KERNEL_AVX2:
+#ifdef SEQ_KERNELS_HAVE_AVX2
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    case SEQ_KERNEL_NEON:
+#ifdef SEQ_KERNELS_HAVE_NEON
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+static void use_backend(seq_kernel_backend backend) {
+  active_backend = backend;
+  switch (backend) {
+#ifdef SEQ_KERNELS_HAVE_AVX2
+    case SEQ_KERNEL_AVX2: active_kernels = &avx2_kernels; break;
+#endif
+#ifdef SEQ_KERNELS_HAVE_NEON
+    case SEQ_KERNEL_NEON: active_kernels = &neon_kernels; break;
+#endif
+    default:
+      active_kernels = &scalar_kernels;
+      active_backend = SEQ_KERNEL_SCALAR;
+      break;
+  }
+}
+
+// Best supported backend, unless SEQUELIZER_KERNELS names another supported one
+static void select_backend(void) {
+  seq_kernel_backend backend = SEQ_KERNEL_SCALAR;
+  if (seq_kernel_backend_supported(SEQ_KERNEL_AVX2)) backend = SEQ_KERNEL_AVX2;
+  if (seq_kernel_backend_supported(SEQ_KERNEL_NEON)) backend = SEQ_KERNEL_NEON;
+
+  const char *requested = getenv("SEQUELIZER_KERNELS");
+  if (requested && *requested) {
+    bool matched = false;
+    for (int b = SEQ_KERNEL_SCALAR; b <= SEQ_KERNEL_NEON; b++) {
+      if (strcmp(requested, seq_kernel_backend_name((seq_kernel_backend)b)) == 0) {
+        matched = true;
+        if (seq_kernel_backend_supported((seq_kernel_backend)b)) {
+          backend = (seq_kernel_backend)b;
+        } else {
+          warnx("SEQUELIZER_KERNELS=%s is not supported on this CPU, using %s",
+                requested, seq_kernel_backend_name(backend));
+        }
+      }
+    }
+    if (!matched) {
+      warnx("Unknown SEQUELIZER_KERNELS=%s (expected scalar, avx2 or neon), using %s",
+            requested, seq_kernel_backend_name(backend));
+    }
+  }
+  use_backend(backend);
+}
+
+static inline const seq_kernel_table* kernels(void) {
+  pthread_once(&dispatch_once, select_backend);
+  return active_kernels;
+}
+
+seq_kernel_backend seq_kernel_backend_active(void) {
+  kernels();
+  return active_backend;
+}
+
+bool seq_kernel_set_backend(seq_kernel_backend backend) {
+  kernels();
+  if (!seq_kernel_backend_supported(backend)) return false;
+  use_backend(backend);
+  return true;
+}
+
+const char* seq_kernel_backend_name(seq_kernel_backend backend) {
+  switch (backend) {
+    case SEQ_KERNEL_SCALAR: return "scalar";
+    case SEQ_KERNEL_AVX2:   return "avx2";
+    case SEQ_KERNEL_NEON:   return "neon";
+  }
+  return "unknown";
+}
+
+// **********************************************************************
+// Public Entry Points
+// **********************************************************************
+
+void seq_kernel_affine_i8_f32(const int8_t *in, float *out, size_t n, float a, float b) {
+  kernels()->affine_i8_f32(in, out, n, a, b);
+}
+
+void seq_kernel_affine_i16_f32(const int16_t *in, float *out, size_t n, float a, float b) {
+  kernels()->affine_i16_f32(in, out, n, a, b);
+}
+
+void seq_kernel_affine_i32_f32(const int32_t *in, float *out, size_t n, float a, float b) {
+  kernels()->affine_i32_f32(in, out, n, a, b);
+}
+
+void seq_kernel_affine_f32_f32(const float *in, float *out, size_t n, float a, float b) {
+  kernels()->affine_f32_f32(in, out, n, a, b);
+}
+
+void seq_kernel_quantise_f32_i8(const float *in, int8_t *out, size_t n, float a, float b) {
+  kernels()->quantise_f32_i8(in, out, n, a, b);
+}
+
+void seq_kernel_quantise_f32_i16(const float *in, int16_t *out, size_t n, float a, float b) {
+  kernels()->quantise_f32_i16(in, out, n, a, b);
+}
+
+void seq_kernel_quantise_f32_i32(const float *in, int32_t *out, size_t n, float a, float b) {
+  kernels()->quantise_f32_i32(in, out, n, a, b);
+}
+
+void seq_kernel_moments_f32(const float *in, size_t n, double *mean, double *m2) {
+  if (n == 0) {
+    *mean = *m2 = 0.0;
+    return;
+  }
+  kernels()->moments_f32(in, n, mean, m2);
+}
+
+void seq_kernel_moments_i16(const int16_t *in, size_t n, double *mean, double *m2) {
+  if (n == 0) {
+    *mean = *m2 = 0.0;
+    return;
+  }
+  kernels()->moments_i16(in, n, mean, m2);
+}
+
+void seq_kernel_minmax_f32(const float *in, size_t n, float *min, float *max) {
+  if (n == 0) {
+    *min = *max = 0.0f;
+    return;
+  }
+  kernels()->minmax_f32(in, n, min, max);
+}
+
+void seq_kernel_summary_i16(const int16_t *in, size_t n, int16_t lo, int16_t hi, seq_kernel_i16_summary *summary) {
+  kernels()->summary_i16(in, n, lo, hi, summary);
+}
+
+void seq_kernel_summary_merge(seq_kernel_i16_summary *into, const seq_kernel_i16_summary *from) {
+  into->sum += from->sum;
+  into->sum_sq += from->sum_sq;
+  if (from->min < into->min) into->min = from->min;
+  if (from->max > into->max) into->max = from->max;
+  into->below += from->below;
+  into->above += from->above;
+}
@@ -0,0 +1,69 @@
+// **********************************************************************
+// core/seq_kernels.h - Dispatched Numeric Kernels for seq_tensor Data
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Elementwise and reduction kernels over contiguous arrays, with AVX2 (x86)
+// and NEON (AArch64) implementations and a portable scalar fallback. The
+// backend is picked once from the running CPU; SEQUELIZER_KERNELS=scalar,
+// avx2 or neon in the environment overrides it (unsupported values are
+// ignored with a warning).
+//
+// Every backend performs the same IEEE operations in the same order per
+// element (multiply then add, no fused multiply-add; round-to-nearest-even;
+// saturation to the target range), so elementwise results are bit-identical
+// across backends. Float reductions accumulate in double and may differ in
+// the last bits between backends; int16 reductions are exact.
+#ifndef SEQUELIZER_SEQ_KERNELS_H
+#define SEQUELIZER_SEQ_KERNELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  SEQ_KERNEL_SCALAR = 0,
+  SEQ_KERNEL_AVX2,
+  SEQ_KERNEL_NEON
+} seq_kernel_backend;
+
+// Backend selection
+seq_kernel_backend seq_kernel_backend_active(void);
+bool        seq_kernel_backend_supported(seq_kernel_backend backend);
+bool        seq_kernel_set_backend(seq_kernel_backend backend);   // false if unsupported here
+const char* seq_kernel_backend_name(seq_kernel_backend backend);
+
+// Affine conversion to float: out[i] = in[i] * a + b
+// (pA calibration and dequantisation: a = scale, b = -scale * zero_point)
+void seq_kernel_affine_i8_f32(const int8_t *in, float *out, size_t n, float a, float b);
+void seq_kernel_affine_i16_f32(const int16_t *in, float *out, size_t n, float a, float b);
+void seq_kernel_affine_i32_f32(const int32_t *in, float *out, size_t n, float a, float b);
+void seq_kernel_affine_f32_f32(const float *in, float *out, size_t n, float a, float b);
+
+// Quantisation: out[i] = saturate(round_half_even(in[i] * a + b))
+// (a = 1 / scale, b = zero_point; NaN saturates to the minimum)
+void seq_kernel_quantise_f32_i8(const float *in, int8_t *out, size_t n, float a, float b);
+void seq_kernel_quantise_f32_i16(const float *in, int16_t *out, size_t n, float a, float b);
+void seq_kernel_quantise_f32_i32(const float *in, int32_t *out, size_t n, float a, float b);
+
+// Reductions: mean and sum of squared deviations (variance = m2 / n) of n > 0 values
+void seq_kernel_moments_f32(const float *in, size_t n, double *mean, double *m2);
+void seq_kernel_moments_i16(const int16_t *in, size_t n, double *mean, double *m2);
+
+// Minimum and maximum of n > 0 values
+void seq_kernel_minmax_f32(const float *in, size_t n, float *min, float *max);
+
+// One-pass summary of n int16 samples (raw ADC codes): exact sums, extremes and
+// the counts at or beyond two rails. Blocks combine with seq_kernel_summary_merge
+typedef struct {
+  int64_t sum;
+  uint64_t sum_sq;
+  int16_t min, max;        // INT16_MAX, INT16_MIN for n = 0
+  uint64_t below;          // Samples <= lo
+  uint64_t above;          // Samples >= hi
+} seq_kernel_i16_summary;
+
+void seq_kernel_summary_i16(const int16_t *in, size_t n, int16_t lo, int16_t hi, seq_kernel_i16_summary *summary);
+void seq_kernel_summary_merge(seq_kernel_i16_summary *into, const seq_kernel_i16_summary *from);
+
+#endif // SEQUELIZER_SEQ_KERNELS_H
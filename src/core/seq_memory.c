@@ -0,0 +1,98 @@
+// **********************************************************************
+// core/seq_memory.c - Process-Wide Memory Budget (--max-memory)
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+//
+#include "seq_memory.h"
+#include <ctype.h>
+#include <err.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+static size_t budget;
+static atomic_size_t used;
+static atomic_size_t peak;
+static atomic_uint_fast64_t stalls;
+static atomic_uint_fast64_t stall_ns;
+
+void seq_memory_set_budget(size_t bytes) {
+  budget = bytes;
+}
+
+size_t seq_memory_budget(void) {
+  return budget;
+}
+
+bool seq_memory_parse_size(const char *text, size_t *bytes) {
+  if (!text) return false;
+  char *end;
+  double value = strtod(text, &end);
+  if (end == text || !(value >= 0.0)) return false;
+
+  double unit = 1.0;
+  switch (toupper((unsigned char)*end)) {
+    case 'K': unit = 1024.0; end++; break;
+    case 'M': unit = 1024.0 * 1024.0; end++; break;
+    case 'G': unit = 1024.0 * 1024.0 * 1024.0; end++; break;
+    case 'T': unit = 1024.0 * 1024.0 * 1024.0 * 1024.0; end++; break;
+    default: break;
+  }
+  if (unit > 1.0 && toupper((unsigned char)*end) == 'B') end++;   // "512MB"
+  if (*end != '\0' || value * unit >= (double)SIZE_MAX) return false;
+  *bytes = (size_t)llround(value * unit);
+  return true;
+}
+
+bool seq_memory_enable(const char *size) {
+  size_t bytes;
+  if (!seq_memory_parse_size(size, &bytes) || bytes == 0) {
+    warnx("Invalid memory budget '%s'. Use a size such as 512M or 2G", size);
+    return false;
+  }
+  seq_memory_set_budget(bytes);
+  return true;
+}
+
+void seq_memory_reserve(size_t bytes) {
+  size_t now = atomic_fetch_add_explicit(&used, bytes, memory_order_relaxed) + bytes;
+  size_t high = atomic_load_explicit(&peak, memory_order_relaxed);
+  while (now > high && !atomic_compare_exchange_weak_explicit(&peak, &high, now, memory_order_relaxed,
+                                                               memory_order_relaxed)) {
+  }
+}
+
+void seq_memory_release(size_t bytes) {
+  atomic_fetch_sub_explicit(&used, bytes, memory_order_relaxed);
+}
+
+size_t seq_memory_used(void) {
+  return atomic_load_explicit(&used, memory_order_relaxed);
+}
+
+size_t seq_memory_peak(void) {
+  return atomic_load_explicit(&peak, memory_order_relaxed);
+}
+
+bool seq_memory_over_budget(void) {
+  return budget > 0 && seq_memory_used() >= budget;
+}
+
+size_t seq_memory_available(void) {
+  if (budget == 0) return SIZE_MAX;
+  size_t now = seq_memory_used();
+  return now < budget ? budget - now : 0;
+}
+
+void seq_memory_record_stall(uint64_t ns) {
+  atomic_fetch_add_explicit(&stalls, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&stall_ns, ns, memory_order_relaxed);
+}
+
+uint64_t seq_memory_stalls(void) {
+  return atomic_load_explicit(&stalls, memory_order_relaxed);
+}
+
+uint64_t seq_memory_stall_ns(void) {
+  return atomic_load_explicit(&stall_ns, memory_order_relaxed);
+}
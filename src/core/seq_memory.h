@@ -0,0 +1,51 @@
+// **********************************************************************
+// core/seq_memory.h - Process-Wide Memory Budget (--max-memory)
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+//
+// One byte count shared by every subcommand: the large allocators (tensor
+// data, shard sections, kept read metadata, plot input copies) report what
+// they hold, and the code that decides how much to keep in memory asks
+// whether the budget is reached. Nothing fails when it is: allocation never
+// blocks, instead
+//   - seq_pipeline's source stops reading while items are in flight, so
+//     reads wait in the queues until the sink has written some out
+//   - stages that gather (fast5 -s summary rows, plot input from a pipe)
+//     spill to temporary files or switch to their streaming form
+// Without a budget (the default) only the usage and peak are kept, for --profile.
+#ifndef SEQUELIZER_SEQ_MEMORY_H
+#define SEQUELIZER_SEQ_MEMORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// 0 = no budget. Call before any worker thread starts
+void   seq_memory_set_budget(size_t bytes);
+size_t seq_memory_budget(void);
+
+// Parse "512M", "2G", "1.5G", "64k" or plain bytes (binary units); false on anything else
+bool   seq_memory_parse_size(const char *text, size_t *bytes);
+
+// Set the budget from a --max-memory argument; false (with a warning) unless it is a positive size
+bool   seq_memory_enable(const char *size);
+
+// Count bytes taken or given back by an allocator (thread-safe, never blocks)
+void   seq_memory_reserve(size_t bytes);
+void   seq_memory_release(size_t bytes);
+
+size_t seq_memory_used(void);
+size_t seq_memory_peak(void);
+
+// Usage has reached the budget (always false without one)
+bool   seq_memory_over_budget(void);
+
+// Bytes left before the budget is reached (SIZE_MAX without one, 0 once over it)
+size_t seq_memory_available(void);
+
+// Record time a reader spent blocked by the budget (reported by --profile)
+void   seq_memory_record_stall(uint64_t ns);
+uint64_t seq_memory_stalls(void);
+uint64_t seq_memory_stall_ns(void);
+
+#endif // SEQUELIZER_SEQ_MEMORY_H
@@ -0,0 +1,587 @@
+// **********************************************************************
+// core/seq_nn.c - Small Feed-Forward Network Runtime on seq_tensor
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_nn.h"
+#include "seq_kernels.h"
+#include <err.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SEQUELIZER_HAVE_OPENBLAS
+#include <cblas.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SEQ_NN_BIG_ENDIAN 1
+#endif
+
+// Rows per GEMM: bounds the im2col and INT8 scratch while keeping each GEMM large
+#define SEQ_NN_TILE_ROWS 2048
+
+// Sanity limits for model files (a corrupt header should not allocate gigabytes)
+#define SEQ_NN_MAX_CHANNELS 4096
+#define SEQ_NN_MAX_WINDOW   255
+#define SEQ_NN_MAX_LAYERS   64
+#define SEQ_NN_MAX_NAME     1024
+
+// Largest window * in, so an INT8 dot product (at most 255 * 255 per term) fits int32
+#define SEQ_NN_MAX_FAN_IN   32768
+
+// **********************************************************************
+// Building
+// **********************************************************************
+
+seq_nn_model* seq_nn_model_create(const char *name, float current_scale, float current_offset) {
+  seq_nn_model *model = calloc(1, sizeof(seq_nn_model));
+  if (!model) return NULL;
+  model->name = strdup(name ? name : "");
+  if (!model->name) {
+    free(model);
+    return NULL;
+  }
+  model->current_scale = current_scale;
+  model->current_offset = current_offset;
+  return model;
+}
+
+size_t seq_nn_model_outputs(const seq_nn_model *model) {
+  return (model && model->num_layers > 0) ? model->layers[model->num_layers - 1].out : 0;
+}
+
+static void free_layer(seq_nn_layer *layer) {
+  seq_tensor_free(layer->weights);
+  seq_tensor_free(layer->bias);
+  free(layer->column_sums);
+}
+
+void seq_nn_model_free(seq_nn_model *model) {
+  if (!model) return;
+  for (size_t i = 0; i < model->num_layers; i++) {
+    free_layer(&model->layers[i]);
+  }
+  free(model->layers);
+  free(model->name);
+  free(model);
+}
+
+// Shape checks shared by add_layer and the loader
+static bool check_layer_shape(const seq_nn_model *model, seq_nn_layer_kind kind, size_t in, size_t out,
+                              size_t window) {
+  size_t expected_in = model->num_layers ? model->layers[model->num_layers - 1].out : SEQ_NN_INPUT_CHANNELS;
+  if (kind != SEQ_NN_DENSE && kind != SEQ_NN_CONV1D) {
+    warnx("Unknown network layer kind %d", (int)kind);
+    return false;
+  }
+  if (in != expected_in) {
+    warnx("Layer %zu takes %zu channels but its input has %zu", model->num_layers + 1, in, expected_in);
+    return false;
+  }
+  if (out == 0 || out > SEQ_NN_MAX_CHANNELS || window == 0 || window > SEQ_NN_MAX_WINDOW ||
+      (kind == SEQ_NN_DENSE && window != 1) || window * in > SEQ_NN_MAX_FAN_IN) {
+    warnx("Layer %zu has an invalid shape (%zu outputs, window %zu)", model->num_layers + 1, out, window);
+    return false;
+  }
+  return true;
+}
+
+// New zeroed layer at the end of the stack (not counted until the caller fills it)
+static seq_nn_layer* reserve_layer(seq_nn_model *model) {
+  seq_nn_layer *grown = realloc(model->layers, (model->num_layers + 1) * sizeof(seq_nn_layer));
+  if (!grown) return NULL;
+  model->layers = grown;
+  memset(&grown[model->num_layers], 0, sizeof(seq_nn_layer));
+  return &grown[model->num_layers];
+}
+
+// Per-column sums of INT8 weights, for the activation zero-point correction
+static bool compute_column_sums(seq_nn_layer *layer) {
+  size_t k = layer->window * layer->in;
+  const int8_t *w = seq_tensor_data_int8(layer->weights);
+  layer->column_sums = calloc(layer->out, sizeof(int32_t));
+  if (!layer->column_sums) return false;
+  for (size_t p = 0; p < k; p++) {
+    for (size_t j = 0; j < layer->out; j++) {
+      layer->column_sums[j] += w[p * layer->out + j];
+    }
+  }
+  return true;
+}
+
+bool seq_nn_model_add_layer(seq_nn_model *model, seq_nn_layer_kind kind, seq_nn_activation activation,
+                            size_t in, size_t out, size_t window, const float *weights, const float *bias) {
+  if (!model || !weights || !bias || !check_layer_shape(model, kind, in, out, window)) return false;
+
+  seq_nn_layer *layer = reserve_layer(model);
+  if (!layer) return false;
+  layer->kind = kind;
+  layer->activation = activation;
+  layer->in = in;
+  layer->out = out;
+  layer->window = window;
+  layer->weights = seq_tensor_create_float_uninit(2, (size_t[]){window * in, out});
+  layer->bias = seq_tensor_create_float_uninit(1, (size_t[]){out});
+  if (!layer->weights || !layer->bias) {
+    free_layer(layer);
+    return false;
+  }
+  memcpy(seq_tensor_data_float(layer->weights), weights, window * in * out * sizeof(float));
+  memcpy(seq_tensor_data_float(layer->bias), bias, out * sizeof(float));
+  model->num_layers++;
+  return true;
+}
+
+bool seq_nn_model_quantise(seq_nn_model *model) {
+  if (!model) return false;
+  for (size_t i = 0; i < model->num_layers; i++) {
+    seq_nn_layer *layer = &model->layers[i];
+    if (layer->weights->dtype != SEQ_TENSOR_FLT32) continue;
+
+    // Asymmetric range covering zero, so zero weights stay exact
+    float lo, hi;
+    seq_kernel_minmax_f32(seq_tensor_data_float(layer->weights), layer->weights->size, &lo, &hi);
+    lo = fminf(lo, 0.0f);
+    hi = fmaxf(hi, 0.0f);
+    float scale = hi > lo ? (hi - lo) / 255.0f : 1.0f;
+    int32_t zero_point = (int32_t)lrintf(-128.0f - lo / scale);
+    if (zero_point < -128) zero_point = -128;
+    if (zero_point > 127) zero_point = 127;
+
+    seq_tensor *quantised = seq_tensor_quantize(layer->weights, SEQ_TENSOR_INT8, scale, zero_point);
+    if (!quantised) return false;
+    seq_tensor_free(layer->weights);
+    layer->weights = quantised;
+    if (!compute_column_sums(layer)) return false;
+  }
+  return true;
+}
+
+// **********************************************************************
+// Model Files
+// **********************************************************************
+
+static bool read_bytes(FILE *file, void *data, size_t size) {
+  return fread(data, 1, size, file) == size;
+}
+
+static bool read_u32(FILE *file, uint32_t *value) {
+  uint8_t b[4];
+  if (!read_bytes(file, b, 4)) return false;
+  *value = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+  return true;
+}
+
+static bool read_f32(FILE *file, float *value) {
+  uint32_t bits;
+  if (!read_u32(file, &bits)) return false;
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+
+// Bulk little-endian float32 array
+static bool read_f32_array(FILE *file, float *values, size_t n) {
+  if (!read_bytes(file, values, n * sizeof(float))) return false;
+#ifdef SEQ_NN_BIG_ENDIAN
+  uint32_t *bits = (uint32_t*)values;
+  for (size_t i = 0; i < n; i++) bits[i] = __builtin_bswap32(bits[i]);
+#endif
+  return true;
+}
+
+static bool write_u32(FILE *file, uint32_t value) {
+  uint8_t b[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+  return fwrite(b, 1, 4, file) == 4;
+}
+
+static bool write_f32(FILE *file, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return write_u32(file, bits);
+}
+
+static bool write_f32_array(FILE *file, const float *values, size_t n) {
+#ifdef SEQ_NN_BIG_ENDIAN
+  for (size_t i = 0; i < n; i++) {
+    if (!write_f32(file, values[i])) return false;
+  }
+  return true;
+#else
+  return fwrite(values, sizeof(float), n, file) == n;
+#endif
+}
+
+// One layer record (the header fields are already validated)
+static bool load_layer(FILE *file, seq_nn_model *model, const char *path) {
+  uint32_t kind, activation, in, out, window, dtype;
+  if (!read_u32(file, &kind) || !read_u32(file, &activation) || !read_u32(file, &in) ||
+      !read_u32(file, &out) || !read_u32(file, &window) || !read_u32(file, &dtype)) {
+    warnx("Truncated layer header in network \"%s\"", path);
+    return false;
+  }
+  if (!check_layer_shape(model, (seq_nn_layer_kind)kind, in, out, window)) return false;
+  if (activation > SEQ_NN_SIGMOID || dtype > 1) {
+    warnx("Layer %zu of network \"%s\" has an unknown activation or weight type", model->num_layers + 1, path);
+    return false;
+  }
+
+  seq_nn_layer *layer = reserve_layer(model);
+  if (!layer) return false;
+  layer->kind = (seq_nn_layer_kind)kind;
+  layer->activation = (seq_nn_activation)activation;
+  layer->in = in;
+  layer->out = out;
+  layer->window = window;
+
+  size_t shape[2] = {(size_t)window * in, out};
+  bool ok;
+  if (dtype == 1) {
+    float scale;
+    uint32_t zero_point;
+    ok = read_f32(file, &scale) && read_u32(file, &zero_point) && scale > 0.0f;
+    layer->weights = ok ? seq_tensor_create_int8(2, shape, scale, (int32_t)zero_point) : NULL;
+    ok = layer->weights && read_bytes(file, seq_tensor_data_int8(layer->weights), shape[0] * shape[1]) &&
+         compute_column_sums(layer);
+  } else {
+    layer->weights = seq_tensor_create_float_uninit(2, shape);
+    ok = layer->weights && read_f32_array(file, seq_tensor_data_float(layer->weights), shape[0] * shape[1]);
+  }
+  layer->bias = ok ? seq_tensor_create_float_uninit(1, (size_t[]){out}) : NULL;
+  ok = ok && layer->bias && read_f32_array(file, seq_tensor_data_float(layer->bias), out);
+  if (!ok) {
+    warnx("Failed to read weights of layer %zu from network \"%s\"", model->num_layers + 1, path);
+    free_layer(layer);
+    return false;
+  }
+  model->num_layers++;
+  return true;
+}
+
+seq_nn_model* seq_nn_model_load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    warnx("Cannot open network weights \"%s\"", path);
+    return NULL;
+  }
+
+  char magic[4];
+  uint32_t version, name_length, num_layers;
+  if (!read_bytes(file, magic, 4) || memcmp(magic, SEQ_NN_MAGIC, 4) != 0 ||
+      !read_u32(file, &version) || version != SEQ_NN_VERSION ||
+      !read_u32(file, &name_length) || name_length > SEQ_NN_MAX_NAME) {
+    warnx("\"%s\" is not a version %d network weights file", path, SEQ_NN_VERSION);
+    fclose(file);
+    return NULL;
+  }
+
+  char name[SEQ_NN_MAX_NAME + 1];
+  float current_scale, current_offset;
+  bool ok = read_bytes(file, name, name_length) && read_f32(file, &current_scale) &&
+            read_f32(file, &current_offset) && read_u32(file, &num_layers) &&
+            num_layers > 0 && num_layers <= SEQ_NN_MAX_LAYERS;
+  if (!ok) {
+    warnx("Invalid header in network weights \"%s\"", path);
+    fclose(file);
+    return NULL;
+  }
+  name[name_length] = '\0';
+
+  seq_nn_model *model = seq_nn_model_create(name, current_scale, current_offset);
+  for (uint32_t i = 0; model && i < num_layers; i++) {
+    if (!load_layer(file, model, path)) {
+      seq_nn_model_free(model);
+      model = NULL;
+    }
+  }
+  fclose(file);
+  return model;
+}
+
+bool seq_nn_model_save(const seq_nn_model *model, const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    warnx("Cannot create network weights \"%s\"", path);
+    return false;
+  }
+
+  size_t name_length = strlen(model->name);
+  bool ok = fwrite(SEQ_NN_MAGIC, 1, 4, file) == 4 && write_u32(file, SEQ_NN_VERSION) &&
+            write_u32(file, (uint32_t)name_length) && fwrite(model->name, 1, name_length, file) == name_length &&
+            write_f32(file, model->current_scale) && write_f32(file, model->current_offset) &&
+            write_u32(file, (uint32_t)model->num_layers);
+
+  for (size_t i = 0; ok && i < model->num_layers; i++) {
+    const seq_nn_layer *layer = &model->layers[i];
+    bool int8 = layer->weights->dtype == SEQ_TENSOR_INT8;
+    size_t n = layer->weights->size;
+    ok = write_u32(file, layer->kind) && write_u32(file, layer->activation) &&
+         write_u32(file, (uint32_t)layer->in) && write_u32(file, (uint32_t)layer->out) &&
+         write_u32(file, (uint32_t)layer->window) && write_u32(file, int8 ? 1 : 0);
+    if (ok && int8) {
+      ok = write_f32(file, layer->weights->scale) && write_u32(file, (uint32_t)layer->weights->zero_point) &&
+           fwrite(seq_tensor_data_int8(layer->weights), 1, n, file) == n;
+    } else if (ok) {
+      ok = write_f32_array(file, seq_tensor_data_float(layer->weights), n);
+    }
+    ok = ok && write_f32_array(file, seq_tensor_data_float(layer->bias), layer->out);
+  }
+
+  if (fclose(file) != 0) ok = false;
+  if (!ok) warnx("Failed to write network weights \"%s\"", path);
+  return ok;
+}
+
+// **********************************************************************
+// GEMM Kernels
+// **********************************************************************
+
+#ifdef SEQUELIZER_HAVE_OPENBLAS
+// Reads are spread over the pipeline's workers, so each GEMM runs on its
+// caller's thread rather than contending for OpenBLAS's own pool
+static pthread_once_t blas_threads_once = PTHREAD_ONCE_INIT;
+static void limit_blas_threads(void) {
+  openblas_set_num_threads(1);
+}
+#endif
+
+// c[m × n] = a[m × k] · b[k × n], all row-major and dense
+static void gemm_f32(const float *a, const float *b, float *c, size_t m, size_t n, size_t k) {
+#ifdef SEQUELIZER_HAVE_OPENBLAS
+  pthread_once(&blas_threads_once, limit_blas_threads);
+  cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, (int)m, (int)n, (int)k,
+              1.0f, a, (int)k, b, (int)n, 0.0f, c, (int)n);
+#else
+  for (size_t i = 0; i < m; i++) {
+    float *restrict row = c + i * n;
+    memset(row, 0, n * sizeof(float));
+    for (size_t p = 0; p < k; p++) {
+      float av = a[i * k + p];
+      if (av == 0.0f) continue;  // One-hot inputs and ReLU outputs are mostly zero
+      const float *restrict brow = b + p * n;
+      for (size_t j = 0; j < n; j++) row[j] += av * brow[j];
+    }
+  }
+#endif
+}
+
+// c[m × n] = a[m × k] · b[k × n] in int32 (BLAS has no integer GEMM); the
+// inner loop is a contiguous widening multiply-add the compiler vectorises
+static void gemm_s8s8s32(const int8_t *a, const int8_t *b, int32_t *c, size_t m, size_t n, size_t k) {
+  for (size_t i = 0; i < m; i++) {
+    int32_t *restrict row = c + i * n;
+    memset(row, 0, n * sizeof(int32_t));
+    for (size_t p = 0; p < k; p++) {
+      int32_t av = a[i * k + p];
+      if (av == 0) continue;
+      const int8_t *restrict brow = b + p * n;
+      for (size_t j = 0; j < n; j++) row[j] += av * brow[j];
+    }
+  }
+}
+
+// **********************************************************************
+// Forward Pass
+// **********************************************************************
+
+// Per-call scratch, sized for the widest layer
+typedef struct {
+  float *columns;          // im2col rows [SEQ_NN_TILE_ROWS × max window * in]
+  seq_tensor *quantised;   // INT8 activation tile (scale/zero_point set per tile)
+  seq_tensor *accumulator; // INT32 products for the INT8 tile
+} forward_scratch_t;
+
+// Gather window taps for rows [row, row + m) into columns; taps outside a
+// row's own read are zero, so reads in a batch never see each other
+static void im2col(const seq_nn_layer *layer, const float *x, size_t row, size_t m,
+                   const size_t *offsets, size_t *segment, float *columns) {
+  size_t in = layer->in;
+  size_t half = layer->window / 2;
+  for (size_t i = 0; i < m; i++) {
+    size_t t = row + i;
+    while (offsets[*segment + 1] <= t) (*segment)++;
+    size_t begin = offsets[*segment], end = offsets[*segment + 1];
+
+    float *dst = columns + i * layer->window * in;
+    for (size_t w = 0; w < layer->window; w++, dst += in) {
+      // Source row t - half + w, kept unsigned
+      if (t + w < begin + half || t + w - half >= end) {
+        memset(dst, 0, in * sizeof(float));
+      } else {
+        memcpy(dst, x + (t + w - half) * in, in * sizeof(float));
+      }
+    }
+  }
+}
+
+// y[m × out] (before bias) from INT8 weights: quantise the tile, integer GEMM,
+// correct for both zero points, dequantise
+static void forward_int8_tile(const seq_nn_layer *layer, const float *a, size_t m, float *y,
+                              forward_scratch_t *scratch) {
+  size_t k = layer->window * layer->in, n = layer->out;
+  const seq_tensor *w = layer->weights;
+
+  float lo, hi;
+  seq_kernel_minmax_f32(a, m * k, &lo, &hi);
+  lo = fminf(lo, 0.0f);
+  hi = fmaxf(hi, 0.0f);
+  seq_tensor *qa = scratch->quantised;
+  qa->scale = hi > lo ? (hi - lo) / 255.0f : 1.0f;
+  float zero = lrintf(-128.0f - lo / qa->scale);
+  qa->zero_point = (int32_t)fminf(fmaxf(zero, -128.0f), 127.0f);
+  int8_t *q = seq_tensor_data_int8(qa);
+  seq_kernel_quantise_f32_i8(a, q, m * k, 1.0f / qa->scale, (float)qa->zero_point);
+
+  seq_tensor *acc = scratch->accumulator;
+  int32_t *c = seq_tensor_data_int32(acc);
+  gemm_s8s8s32(q, seq_tensor_data_int8((seq_tensor*)w), c, m, n, k);
+
+  // sum (qa - za)(qw - zw) = sum qa qw - zw sum qa - za sum qw + k za zw
+  int64_t za = qa->zero_point, zw = w->zero_point;
+  int64_t constant = (int64_t)k * za * zw;
+  for (size_t i = 0; i < m; i++) {
+    int64_t row_sum = 0;
+    for (size_t p = 0; p < k; p++) row_sum += q[i * k + p];
+    int32_t *row = c + i * n;
+    for (size_t j = 0; j < n; j++) {
+      row[j] = (int32_t)(row[j] + constant - zw * row_sum - za * layer->column_sums[j]);
+    }
+  }
+  acc->scale = qa->scale * w->scale;
+  acc->zero_point = 0;
+  seq_kernel_affine_i32_f32(c, y, m * n, acc->scale, 0.0f);
+}
+
+static void add_bias_and_activate(float *y, size_t m, size_t n, const float *bias, seq_nn_activation activation) {
+  for (size_t i = 0; i < m; i++) {
+    float *row = y + i * n;
+    for (size_t j = 0; j < n; j++) {
+      float v = row[j] + bias[j];
+      switch (activation) {
+        case SEQ_NN_RELU:    v = fmaxf(v, 0.0f); break;
+        case SEQ_NN_TANH:    v = tanhf(v); break;
+        case SEQ_NN_SIGMOID: v = 1.0f / (1.0f + expf(-v)); break;
+        case SEQ_NN_LINEAR:  break;
+      }
+      row[j] = v;
+    }
+  }
+}
+
+// x [rows × in] -> y [rows × out], one GEMM per tile of rows
+static void forward_layer(const seq_nn_layer *layer, const float *x, float *y, size_t rows,
+                          const size_t *offsets, forward_scratch_t *scratch) {
+  size_t k = layer->window * layer->in;
+  bool int8 = layer->weights->dtype == SEQ_TENSOR_INT8;
+  size_t segment = 0;
+
+  for (size_t row = 0; row < rows; row += SEQ_NN_TILE_ROWS) {
+    size_t m = rows - row < SEQ_NN_TILE_ROWS ? rows - row : SEQ_NN_TILE_ROWS;
+    const float *a = x + row * layer->in;  // Dense layers use the activations as they are
+    if (layer->window > 1) {
+      im2col(layer, x, row, m, offsets, &segment, scratch->columns);
+      a = scratch->columns;
+    }
+
+    float *tile = y + row * layer->out;
+    if (int8) {
+      forward_int8_tile(layer, a, m, tile, scratch);
+    } else {
+      gemm_f32(a, seq_tensor_data_float(layer->weights), tile, m, layer->out, k);
+    }
+    add_bias_and_activate(tile, m, layer->out, seq_tensor_data_float(layer->bias), layer->activation);
+  }
+}
+
+bool seq_nn_forward(const seq_nn_model *model, const seq_packed *const *sequences, size_t count,
+                    seq_tensor **outputs) {
+  if (!model || model->num_layers == 0 || !sequences || !outputs) return false;
+  for (size_t r = 0; r < count; r++) outputs[r] = NULL;
+
+  // Reads laid end to end: read r is rows [offsets[r], offsets[r + 1])
+  size_t *offsets = malloc((count + 1) * sizeof(size_t));
+  if (!offsets) return false;
+  offsets[0] = 0;
+  for (size_t r = 0; r < count; r++) {
+    if (sequences[r]->length == 0) {
+      warnx("Cannot run network \"%s\" on an empty sequence", model->name);
+      free(offsets);
+      return false;
+    }
+    offsets[r + 1] = offsets[r] + sequences[r]->length;
+  }
+  size_t rows = offsets[count];
+
+  // Scratch sized for the widest layer
+  size_t max_channels = SEQ_NN_INPUT_CHANNELS, max_k = 0, max_int8_k = 0, max_int8_n = 0;
+  for (size_t i = 0; i < model->num_layers; i++) {
+    const seq_nn_layer *layer = &model->layers[i];
+    size_t k = layer->window * layer->in;
+    if (layer->out > max_channels) max_channels = layer->out;
+    if (layer->window > 1 && k > max_k) max_k = k;
+    if (layer->weights->dtype == SEQ_TENSOR_INT8) {
+      if (k > max_int8_k) max_int8_k = k;
+      if (layer->out > max_int8_n) max_int8_n = layer->out;
+    }
+  }
+  size_t tile = rows < SEQ_NN_TILE_ROWS ? rows : SEQ_NN_TILE_ROWS;
+
+  forward_scratch_t scratch = {0};
+  float *x = malloc(rows * max_channels * sizeof(float));
+  float *y = malloc(rows * max_channels * sizeof(float));
+  bool ok = x && y;
+  if (ok && max_k > 0) {
+    scratch.columns = malloc(tile * max_k * sizeof(float));
+    ok = scratch.columns != NULL;
+  }
+  if (ok && max_int8_k > 0) {
+    scratch.quantised = seq_tensor_create_int8(2, (size_t[]){tile, max_int8_k}, 1.0f, 0);
+    scratch.accumulator = seq_tensor_create_int32(2, (size_t[]){tile, max_int8_n}, 1.0f, 0);
+    ok = scratch.quantised && scratch.accumulator;
+  }
+
+  if (ok) {
+    // One-hot bases
+    memset(x, 0, rows * SEQ_NN_INPUT_CHANNELS * sizeof(float));
+    for (size_t r = 0; r < count; r++) {
+      float *base_rows = x + offsets[r] * SEQ_NN_INPUT_CHANNELS;
+      for (size_t i = 0; i < sequences[r]->length; i++) {
+        base_rows[i * SEQ_NN_INPUT_CHANNELS + seq_packed_base(sequences[r], i)] = 1.0f;
+      }
+    }
+
+    for (size_t i = 0; i < model->num_layers; i++) {
+      forward_layer(&model->layers[i], x, y, rows, offsets, &scratch);
+      float *swap = x; x = y; y = swap;
+    }
+
+    // Split the batch back into reads
+    size_t width = seq_nn_model_outputs(model);
+    for (size_t r = 0; ok && r < count; r++) {
+      size_t length = sequences[r]->length;
+      outputs[r] = seq_tensor_create_float_uninit(2, (size_t[]){length, width});
+      if (!outputs[r]) {
+        ok = false;
+        break;
+      }
+      memcpy(seq_tensor_data_float(outputs[r]), x + offsets[r] * width, length * width * sizeof(float));
+    }
+  }
+  if (!ok) {
+    warnx("Memory allocation failed for network \"%s\" on %zu reads", model->name, count);
+    for (size_t r = 0; r < count; r++) {
+      seq_tensor_free(outputs[r]);
+      outputs[r] = NULL;
+    }
+  }
+
+  seq_tensor_free(scratch.accumulator);
+  seq_tensor_free(scratch.quantised);
+  free(scratch.columns);
+  free(x);
+  free(y);
+  free(offsets);
+  return ok;
+}
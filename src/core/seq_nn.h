@@ -0,0 +1,109 @@
+// **********************************************************************
+// core/seq_nn.h - Small Feed-Forward Network Runtime on seq_tensor
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Inference for the neural squiggle models: a stack of conv1d/dense layers
+// over one-hot bases, weights held in seq_tensor (FLT32, or INT8 with
+// scale/zero_point), evaluated as GEMMs. A batch of reads is concatenated
+// into one [sum of lengths × channels] activation matrix, so each layer is
+// one GEMM over many sequences (tiled by rows to bound scratch memory);
+// convolutions are zero-padded at read boundaries so a read's outputs do not
+// depend on which reads share its batch. Float GEMMs go to OpenBLAS
+// (cblas_sgemm) when built with it, a portable loop otherwise. INT8 layers
+// quantise each activation tile (per-tensor, asymmetric) and accumulate
+// int8 x int8 in INT32 before dequantising.
+//
+// Model files (.sqnn), little-endian:
+//   "SQNN", u32 version (1)
+//   u32 name_length, name bytes
+//   f32 current_scale, f32 current_offset      (see seq_nn_model)
+//   u32 num_layers, then per layer:
+//     u32 kind, u32 activation, u32 in, u32 out, u32 window, u32 dtype (0 f32, 1 int8)
+//     int8 only: f32 scale, i32 zero_point
+//     weights [window * in × out] row-major (tap-major, then input channel), f32 or int8
+//     bias [out] f32
+#ifndef SEQUELIZER_SEQ_NN_H
+#define SEQUELIZER_SEQ_NN_H
+
+#include "seq_tensor.h"
+#include "seq_packed.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SEQ_NN_MAGIC "SQNN"
+#define SEQ_NN_VERSION 1
+
+// Input channels: one-hot A, C, G, T
+#define SEQ_NN_INPUT_CHANNELS 4
+
+typedef enum {
+  SEQ_NN_DENSE,            // window 1
+  SEQ_NN_CONV1D            // Centred window: taps t - window/2 .. t + (window - 1)/2
+} seq_nn_layer_kind;
+
+typedef enum {
+  SEQ_NN_LINEAR,
+  SEQ_NN_RELU,
+  SEQ_NN_TANH,
+  SEQ_NN_SIGMOID
+} seq_nn_activation;
+
+typedef struct {
+  seq_nn_layer_kind kind;
+  seq_nn_activation activation;
+  size_t in;               // Input channels
+  size_t out;              // Output channels
+  size_t window;           // Taps (1 for dense)
+  seq_tensor *weights;     // [window * in × out], FLT32 or INT8
+  seq_tensor *bias;        // [out] FLT32
+  int32_t *column_sums;    // INT8 only: sum of each weight column (zero-point correction)
+} seq_nn_layer;
+
+// Outputs per base are the last layer's channels. Squiggle models have three:
+// current (normalised; pA = current * current_scale + current_offset),
+// log stddev (pA = exp() * current_scale) and log dwell (exp() samples at 4 kHz)
+typedef struct seq_nn_model {
+  char *name;
+  float current_scale;
+  float current_offset;
+  seq_nn_layer *layers;
+  size_t num_layers;
+} seq_nn_model;
+
+// **********************************************************************
+// Building, Loading and Saving
+// **********************************************************************
+
+// Empty model; NULL if out of memory
+seq_nn_model* seq_nn_model_create(const char *name, float current_scale, float current_offset);
+
+// Append a float layer (weights [window * in × out] row-major, bias [out], both
+// copied). in must match the previous layer's out (SEQ_NN_INPUT_CHANNELS first)
+bool seq_nn_model_add_layer(seq_nn_model *model, seq_nn_layer_kind kind, seq_nn_activation activation,
+                            size_t in, size_t out, size_t window, const float *weights, const float *bias);
+
+// Read/write a .sqnn file; load returns NULL with a warning on failure
+seq_nn_model* seq_nn_model_load(const char *path);
+bool          seq_nn_model_save(const seq_nn_model *model, const char *path);
+
+// Quantise every float layer's weights to INT8 in place (per-tensor asymmetric)
+bool seq_nn_model_quantise(seq_nn_model *model);
+
+void seq_nn_model_free(seq_nn_model *model);
+
+// Channels per base of the model's output (0 for an empty model)
+size_t seq_nn_model_outputs(const seq_nn_model *model);
+
+// **********************************************************************
+// Inference
+// **********************************************************************
+
+// Run count reads as one batch: outputs[r] becomes a new FLT32 tensor
+// [sequences[r]->length × outputs]. False (outputs all NULL) on failure.
+// Thread-safe: the model is only read
+bool seq_nn_forward(const seq_nn_model *model, const seq_packed *const *sequences, size_t count,
+                    seq_tensor **outputs);
+
+#endif // SEQUELIZER_SEQ_NN_H
@@ -0,0 +1,240 @@
+// **********************************************************************
+// core/seq_output.c - Block-Buffered Text and Binary Output
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_output.h"
+#include "seq_profile.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+// **********************************************************************
+// Format Selection
+// **********************************************************************
+bool seq_output_parse_format(const char *name, seq_output_format *format) {
+  if (!name) return false;
+  if (strcmp(name, "text") == 0) {
+    *format = SEQ_OUTPUT_TEXT;
+    return true;
+  }
+  if (strcmp(name, "bin") == 0) {
+    *format = SEQ_OUTPUT_BIN;
+    return true;
+  }
+  return false;
+}
+
+const char* seq_output_format_extension(seq_output_format format) {
+  return format == SEQ_OUTPUT_BIN ? ".bin" : ".txt";
+}
+
+// **********************************************************************
+// Buffer Management
+// **********************************************************************
+bool seq_output_init(seq_output_t *out, FILE *stream, size_t capacity) {
+  out->stream = stream;
+  out->used = 0;
+  out->capacity = capacity ? capacity : SEQ_OUTPUT_BUFFER_SIZE;
+  out->failed = false;
+  out->buffer = malloc(out->capacity);
+  if (!out->buffer) {
+    out->capacity = 0;
+    return false;
+  }
+  return true;
+}
+
+static void drain(seq_output_t *out) {
+  if (out->used && !out->failed && fwrite(out->buffer, 1, out->used, out->stream) != out->used)
+    out->failed = true;
+  SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_WRITTEN, out->used);
+  out->used = 0;
+}
+
+int seq_output_flush(seq_output_t *out) {
+  if (!out->stream) return -1;
+  drain(out);
+  if (fflush(out->stream) != 0) out->failed = true;
+  return out->failed ? -1 : 0;
+}
+
+int seq_output_close(seq_output_t *out) {
+  int status = out->buffer ? seq_output_flush(out) : (out->failed ? -1 : 0);
+  free(out->buffer);
+  out->buffer = NULL;
+  out->used = 0;
+  out->capacity = 0;
+  return status;
+}
+
+char* seq_output_reserve_slow(seq_output_t *out, size_t n) {
+  if (!out->buffer || n > out->capacity) {
+    out->failed = true;
+    return NULL;
+  }
+  drain(out);
+  return out->failed ? NULL : out->buffer;
+}
+
+// **********************************************************************
+// Bytes and Strings
+// **********************************************************************
+void seq_output_write(seq_output_t *out, const void *data, size_t n) {
+  const char *bytes = data;
+  while (n > 0 && !out->failed) {
+    size_t room = out->capacity - out->used;
+    if (room == 0) {
+      // Large payloads bypass the buffer once it has been drained
+      drain(out);
+      if (n >= out->capacity) {
+        if (fwrite(bytes, 1, n, out->stream) != n) out->failed = true;
+        SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_WRITTEN, n);
+        return;
+      }
+      continue;
+    }
+    size_t chunk = n < room ? n : room;
+    memcpy(out->buffer + out->used, bytes, chunk);
+    out->used += chunk;
+    bytes += chunk;
+    n -= chunk;
+  }
+}
+
+void seq_output_str(seq_output_t *out, const char *s) {
+  seq_output_write(out, s, strlen(s));
+}
+
+void seq_output_printf(seq_output_t *out, const char *format, ...) {
+  if (out->failed) return;
+  va_list args;
+  va_start(args, format);
+  size_t room = out->capacity - out->used;
+  int len = vsnprintf(out->buffer + out->used, room, format, args);
+  va_end(args);
+  if (len < 0) {
+    out->failed = true;
+    return;
+  }
+  if ((size_t)len < room) {
+    out->used += (size_t)len;
+    return;
+  }
+
+  // Did not fit: format into a temporary and copy through
+  char *text = malloc((size_t)len + 1);
+  if (!text) {
+    out->failed = true;
+    return;
+  }
+  va_start(args, format);
+  vsnprintf(text, (size_t)len + 1, format, args);
+  va_end(args);
+  seq_output_write(out, text, (size_t)len);
+  free(text);
+}
+
+// **********************************************************************
+// Number Formatting
+// **********************************************************************
+// Digits of value into the end of a 20-byte scratch area; returns the first digit
+static char* format_digits(char *end, uint64_t value) {
+  char *p = end;
+  do {
+    *--p = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+  return p;
+}
+
+void seq_output_uint(seq_output_t *out, uint64_t value) {
+  char scratch[20];
+  char *end = scratch + sizeof(scratch);
+  char *start = format_digits(end, value);
+  size_t len = (size_t)(end - start);
+  char *p = seq_output_reserve(out, len);
+  if (!p) return;
+  memcpy(p, start, len);
+  out->used += len;
+}
+
+void seq_output_int(seq_output_t *out, int64_t value) {
+  if (value < 0) {
+    seq_output_char(out, '-');
+    seq_output_uint(out, (uint64_t)0 - (uint64_t)value);
+  } else {
+    seq_output_uint(out, (uint64_t)value);
+  }
+}
+
+// |x| * 1e6 stays exact in double for a float x below this, and the integer
+// part fits the digit buffer; larger or non-finite values go through printf
+#define FIXED6_LIMIT 1.0e9
+
+void seq_output_fixed6(seq_output_t *out, float value) {
+  double magnitude = fabs((double)value);
+  if (!(magnitude < FIXED6_LIMIT)) {
+    seq_output_printf(out, "%.6f", value);
+    return;
+  }
+
+  // A float has at most 24 significant bits, so value * 1e6 (< 2^50 here) is
+  // computed exactly in double and rint() rounds it the way printf does:
+  // to nearest, ties to even (ties occur only for dyadic values like 2^-7)
+  uint64_t units = (uint64_t)rint(magnitude * 1e6);
+  uint64_t whole = units / 1000000;
+  uint32_t frac = (uint32_t)(units % 1000000);
+
+  char *p = seq_output_reserve(out, 24);
+  if (!p) return;
+  char *start = p;
+  if (signbit(value)) *p++ = '-';   // printf keeps the sign of -0 and of values rounding to zero
+
+  char scratch[20];
+  char *end = scratch + sizeof(scratch);
+  char *digits = format_digits(end, whole);
+  size_t len = (size_t)(end - digits);
+  memcpy(p, digits, len);
+  p += len;
+
+  *p++ = '.';
+  for (int i = 5; i >= 0; i--) {
+    p[i] = (char)('0' + frac % 10);
+    frac /= 10;
+  }
+  p += 6;
+  out->used += (size_t)(p - start);
+}
+
+// **********************************************************************
+// Binary Samples
+// **********************************************************************
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SEQ_OUTPUT_BIG_ENDIAN 1
+#endif
+
+void seq_output_f32le(seq_output_t *out, const float *values, size_t n) {
+#ifdef SEQ_OUTPUT_BIG_ENDIAN
+  for (size_t i = 0; i < n; i++) {
+    uint32_t bits;
+    memcpy(&bits, &values[i], sizeof(bits));
+    bits = __builtin_bswap32(bits);
+    seq_output_write(out, &bits, sizeof(bits));
+  }
+#else
+  seq_output_write(out, values, n * sizeof(float));
+#endif
+}
+
+void seq_output_i16le(seq_output_t *out, const int16_t *values, size_t n) {
+#ifdef SEQ_OUTPUT_BIG_ENDIAN
+  for (size_t i = 0; i < n; i++) {
+    uint16_t bits = __builtin_bswap16((uint16_t)values[i]);
+    seq_output_write(out, &bits, sizeof(bits));
+  }
+#else
+  seq_output_write(out, values, n * sizeof(int16_t));
+#endif
+}
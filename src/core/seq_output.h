@@ -0,0 +1,79 @@
+// **********************************************************************
+// core/seq_output.h - Block-Buffered Text and Binary Output
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Output layer for per-sample emitters (seqgen signals, convert dumps).
+// Bytes collect in a large buffer and reach the FILE in block-sized
+// fwrite calls. Numbers are formatted by hand rather than through printf
+// and produce exactly the same text: seq_output_fixed6(v) == "%.6f" of a
+// float, seq_output_uint/int == "%zu"/"%d". Binary output is raw
+// little-endian samples regardless of host byte order.
+#ifndef SEQUELIZER_SEQ_OUTPUT_H
+#define SEQUELIZER_SEQ_OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define SEQ_OUTPUT_BUFFER_SIZE (1u << 20)
+
+// Signal encoding selected with --format
+typedef enum {
+  SEQ_OUTPUT_TEXT = 0,  // Tab-separated text with headers
+  SEQ_OUTPUT_BIN        // Raw little-endian samples (float32 or int16), no headers
+} seq_output_format;
+
+// "text" / "bin" -> format; false for anything else
+bool        seq_output_parse_format(const char *name, seq_output_format *format);
+const char* seq_output_format_extension(seq_output_format format);   // ".txt" / ".bin"
+
+typedef struct {
+  FILE *stream;      // Destination (not owned, never closed here)
+  char *buffer;
+  size_t used;
+  size_t capacity;
+  bool failed;       // Sticky: set on the first failed write
+} seq_output_t;
+
+// capacity 0 = SEQ_OUTPUT_BUFFER_SIZE; returns false on allocation failure
+bool seq_output_init(seq_output_t *out, FILE *stream, size_t capacity);
+
+// Write buffered bytes to the stream (and fflush it); 0 on success, -1 if any write failed
+int  seq_output_flush(seq_output_t *out);
+
+// Flush and release the buffer (the stream stays open); 0 or -1 as above
+int  seq_output_close(seq_output_t *out);
+
+// Room for n more bytes (n <= capacity), flushing first if needed; NULL after a failure
+char* seq_output_reserve_slow(seq_output_t *out, size_t n);
+static inline char* seq_output_reserve(seq_output_t *out, size_t n) {
+  if (out->capacity - out->used >= n) return out->buffer + out->used;
+  return seq_output_reserve_slow(out, n);
+}
+
+// Raw bytes, strings and characters
+void seq_output_write(seq_output_t *out, const void *data, size_t n);
+void seq_output_str(seq_output_t *out, const char *s);
+static inline void seq_output_char(seq_output_t *out, char c) {
+  char *p = seq_output_reserve(out, 1);
+  if (p) {
+    *p = c;
+    out->used++;
+  }
+}
+
+// printf-style formatting for headers and other low-volume lines
+void seq_output_printf(seq_output_t *out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+// Hand-rolled number formatting
+void seq_output_uint(seq_output_t *out, uint64_t value);    // "%zu" / "%u"
+void seq_output_int(seq_output_t *out, int64_t value);      // "%d"
+void seq_output_fixed6(seq_output_t *out, float value);     // "%.6f" (and "%3.6f")
+
+// Little-endian binary samples
+void seq_output_f32le(seq_output_t *out, const float *values, size_t n);
+void seq_output_i16le(seq_output_t *out, const int16_t *values, size_t n);
+
+#endif // SEQUELIZER_SEQ_OUTPUT_H
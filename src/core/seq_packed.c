@@ -0,0 +1,88 @@
+// **********************************************************************
+// core/seq_packed.c - 2-bit Packed Nucleotide Sequences
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+
+#include "seq_packed.h"
+#include "../../include/sequelizer.h"  // for RETURN_NULL_IF, warnx
+#include <stdlib.h>
+#include <string.h>
+
+// Bases encoded per pass: the code/validity loop over a block has no branches
+// or table lookups, so it vectorises
+#define PACK_BLOCK 64
+
+// ASCII -> 2-bit code with bit arithmetic: A/a=0x41 C=0x43 G=0x47 T=0x54 give
+// ((c >> 1) & 3) ^ ((c >> 2) & 1) = 0,1,2,3 (case bit 0x20 is ignored)
+static inline uint8_t base_code(uint8_t c) {
+  return (uint8_t)(((c >> 1) & 3) ^ ((c >> 2) & 1));
+}
+
+static inline uint8_t is_acgt(uint8_t c) {
+  uint8_t u = c & 0xDF;  // fold lower case
+  return (uint8_t)((u == 'A') | (u == 'C') | (u == 'G') | (u == 'T'));
+}
+
+seq_packed* seq_pack(const char *sequence, size_t length) {
+  RETURN_NULL_IF(NULL == sequence, NULL);
+
+  seq_packed *packed = malloc(sizeof(seq_packed));
+  RETURN_NULL_IF(NULL == packed, NULL);
+  packed->length = length;
+  packed->offset = 0;
+  packed->reverse = false;
+  packed->data = calloc((length + 3) / 4 + 1, 1);
+  if (NULL == packed->data) {
+    free(packed);
+    return NULL;
+  }
+
+  const uint8_t *in = (const uint8_t*)sequence;
+  uint8_t codes[PACK_BLOCK];
+
+  for (size_t start = 0; start < length; start += PACK_BLOCK) {
+    size_t block = (length - start < PACK_BLOCK) ? length - start : PACK_BLOCK;
+
+    uint8_t valid = 1;
+    for (size_t i = 0; i < block; i++) {
+      codes[i] = base_code(in[start + i]);
+      valid &= is_acgt(in[start + i]);
+    }
+    if (!valid) {
+      for (size_t i = 0; i < block; i++) {
+        if (!is_acgt(in[start + i])) {
+          warnx("Unrecognised base '%c' at position %zu", in[start + i], start + i);
+          break;
+        }
+      }
+      seq_packed_free(packed);
+      return NULL;
+    }
+
+    // start is a multiple of 4, so each block fills whole bytes (except the tail)
+    uint8_t *out = packed->data + start / 4;
+    for (size_t i = 0; i < block; i++) {
+      out[i >> 2] |= (uint8_t)(codes[i] << (6 - 2 * (i & 3)));
+    }
+  }
+
+  return packed;
+}
+
+void seq_packed_free(seq_packed *packed) {
+  if (!packed) return;
+  free(packed->data);
+  free(packed);
+}
+
+char* seq_unpack(const seq_packed *packed) {
+  RETURN_NULL_IF(NULL == packed, NULL);
+
+  char *sequence = malloc(packed->length + 1);
+  RETURN_NULL_IF(NULL == sequence, NULL);
+  for (size_t i = 0; i < packed->length; i++) {
+    sequence[i] = "ACGT"[seq_packed_base(packed, i)];
+  }
+  sequence[packed->length] = '\0';
+  return sequence;
+}
@@ -0,0 +1,84 @@
+// **********************************************************************
+// core/seq_packed.h - 2-bit Packed Nucleotide Sequences
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Sequences stored 4 bases per byte (A,C,G,T -> 0,1,2,3, first base in the
+// high bits), 16x smaller than one int per base, plus a rolling k-mer
+// iterator that updates the lexicographic k-mer index by shift-and-mask in
+// O(1) per position instead of re-encoding k bases. A seq_packed can also be
+// a view into a larger packed sequence (a window of a reference genome, read
+// forwards or as its reverse complement) without copying any bases.
+#ifndef SEQUELIZER_SEQ_PACKED_H
+#define SEQUELIZER_SEQ_PACKED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest k the 32-bit rolling index supports
+#define SEQ_PACKED_MAX_K 16
+
+typedef struct {
+  uint8_t *data;    // (offset + length + 3) / 4 bytes
+  size_t length;    // Number of bases
+  size_t offset;    // First base within data (0 for seq_pack() results)
+  bool reverse;     // Read as the reverse complement of data[offset, offset + length)
+} seq_packed;
+
+// Pack an ASCII sequence (upper or lower case A,C,G,T); returns NULL (with a
+// warning naming the position) on any other character
+seq_packed* seq_pack(const char *sequence, size_t length);
+void        seq_packed_free(seq_packed *packed);
+
+// ASCII copy of the bases as read (upper case, NUL-terminated); NULL if out of memory
+char*       seq_unpack(const seq_packed *packed);
+
+// Window [start, start + length) of a packed sequence (reverse: its reverse
+// complement) sharing the parent's data; never pass a view to seq_packed_free
+static inline seq_packed seq_packed_view(const seq_packed *packed, size_t start, size_t length, bool reverse) {
+  seq_packed view = {packed->data, length, packed->offset + start, reverse};
+  return view;
+}
+
+// Base i as 0..3 (complement is 3 - code with A,C,G,T -> 0,1,2,3)
+static inline unsigned seq_packed_base(const seq_packed *packed, size_t i) {
+  size_t p = packed->reverse ? packed->offset + packed->length - 1 - i : packed->offset + i;
+  unsigned base = (packed->data[p >> 2] >> (6 - 2 * (p & 3))) & 3u;
+  return packed->reverse ? 3u - base : base;
+}
+
+// Rolling k-mer iterator: yields the index of every k-mer in order
+// (n - k + 1 of them), most-significant base on the left
+typedef struct {
+  const seq_packed *seq;
+  size_t next;      // Next base to shift in
+  uint32_t index;
+  uint32_t mask;    // 4^k - 1
+} seq_kmer_iter;
+
+// Number of k-mers a sequence of length n yields
+static inline size_t seq_kmer_count(size_t n, int k) {
+  return (k > 0 && n >= (size_t)k) ? n - (size_t)k + 1 : 0;
+}
+
+static inline void seq_kmer_iter_init(seq_kmer_iter *it, const seq_packed *seq, int k) {
+  it->seq = seq;
+  it->mask = (k >= SEQ_PACKED_MAX_K) ? UINT32_MAX : ((uint32_t)1 << (2 * k)) - 1;
+  it->index = 0;
+  it->next = 0;
+  // Prime with the first k - 1 bases
+  for (; it->next + 1 < (size_t)k && it->next < seq->length; it->next++) {
+    it->index = (it->index << 2) | seq_packed_base(seq, it->next);
+  }
+}
+
+static inline bool seq_kmer_iter_next(seq_kmer_iter *it, uint32_t *kmer_index) {
+  if (it->next >= it->seq->length) return false;
+  it->index = ((it->index << 2) | seq_packed_base(it->seq, it->next)) & it->mask;
+  it->next++;
+  *kmer_index = it->index;
+  return true;
+}
+
+#endif // SEQUELIZER_SEQ_PACKED_H
@@ -0,0 +1,426 @@
+// **********************************************************************
+// core/seq_pipeline.c - Lock-Free Queues and Ordered Pipeline Stages
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_pipeline.h"
+#include "seq_memory.h"
+#include "seq_profile.h"
+#include <err.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Attempts before a blocking push/pop parks on its condition variable
+#define SEQ_QUEUE_SPIN 128
+
+// Keeps the producer and consumer indices on separate cache lines
+#define SEQ_CACHE_LINE 64
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax() __asm__ __volatile__("yield")
+#else
+#define cpu_relax() ((void)0)
+#endif
+
+// **********************************************************************
+// Parking (only touched when a thread actually has to sleep)
+// **********************************************************************
+
+// A waiter registers, re-checks and sleeps under the mutex; a notifier
+// publishes its change, then (seq_cst fence) checks for waiters. One of the
+// two always sees the other, so no wakeup is lost.
+typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  atomic_int waiters;
+} parking_t;
+
+static void parking_init(parking_t *parking) {
+  pthread_mutex_init(&parking->mutex, NULL);
+  pthread_cond_init(&parking->cond, NULL);
+  atomic_init(&parking->waiters, 0);
+}
+
+static void parking_destroy(parking_t *parking) {
+  pthread_cond_destroy(&parking->cond);
+  pthread_mutex_destroy(&parking->mutex);
+}
+
+static void parking_notify(parking_t *parking) {
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&parking->waiters, memory_order_relaxed) > 0) {
+    pthread_mutex_lock(&parking->mutex);
+    pthread_cond_broadcast(&parking->cond);
+    pthread_mutex_unlock(&parking->mutex);
+  }
+}
+
+// Retry attempt(arg) until it succeeds or *closed is set (closed may be NULL);
+// returns whether it succeeded
+static bool parking_wait(parking_t *parking, bool (*attempt)(void *arg), void *arg, atomic_bool *closed) {
+  for (int spin = 0; spin < SEQ_QUEUE_SPIN; spin++) {
+    if (attempt(arg)) return true;
+    if (closed && atomic_load(closed)) return attempt(arg);
+    cpu_relax();
+  }
+
+  pthread_mutex_lock(&parking->mutex);
+  atomic_fetch_add(&parking->waiters, 1);
+  atomic_thread_fence(memory_order_seq_cst);
+  bool ok;
+  while (!(ok = attempt(arg)) && !(closed && atomic_load(closed))) {
+    pthread_cond_wait(&parking->cond, &parking->mutex);
+  }
+  if (!ok) ok = attempt(arg);  // Closed: take anything queued before the close
+  atomic_fetch_sub(&parking->waiters, 1);
+  pthread_mutex_unlock(&parking->mutex);
+  return ok;
+}
+
+// **********************************************************************
+// Bounded Queues
+// **********************************************************************
+
+typedef struct {
+  atomic_size_t sequence;  // MPMC cell turn: pos (free for push) or pos + 1 (full, for pop)
+  void *item;
+} queue_cell_t;
+
+struct seq_queue {
+  seq_queue_kind kind;
+  size_t mask;
+  void **items;            // SPSC storage
+  queue_cell_t *cells;     // MPMC storage
+  atomic_bool closed;
+  parking_t not_empty;
+  parking_t not_full;
+
+  char pad0[SEQ_CACHE_LINE];
+  atomic_size_t head;      // Next position to pop
+  char pad1[SEQ_CACHE_LINE - sizeof(atomic_size_t)];
+  atomic_size_t tail;      // Next position to push
+  char pad2[SEQ_CACHE_LINE - sizeof(atomic_size_t)];
+};
+
+seq_queue_t* seq_queue_create(size_t capacity, seq_queue_kind kind) {
+  size_t size = 2;
+  while (size < capacity) size *= 2;
+
+  seq_queue_t *queue = calloc(1, sizeof(seq_queue_t));
+  if (!queue) return NULL;
+  queue->kind = kind;
+  queue->mask = size - 1;
+  if (kind == SEQ_QUEUE_SPSC) {
+    queue->items = calloc(size, sizeof(void*));
+  } else {
+    queue->cells = calloc(size, sizeof(queue_cell_t));
+    for (size_t i = 0; queue->cells && i < size; i++) {
+      atomic_init(&queue->cells[i].sequence, i);
+    }
+  }
+  if (!queue->items && !queue->cells) {
+    free(queue);
+    return NULL;
+  }
+
+  atomic_init(&queue->head, 0);
+  atomic_init(&queue->tail, 0);
+  atomic_init(&queue->closed, false);
+  parking_init(&queue->not_empty);
+  parking_init(&queue->not_full);
+  return queue;
+}
+
+void seq_queue_free(seq_queue_t *queue) {
+  if (!queue) return;
+  parking_destroy(&queue->not_full);
+  parking_destroy(&queue->not_empty);
+  free(queue->items);
+  free(queue->cells);
+  free(queue);
+}
+
+static bool spsc_push(seq_queue_t *queue, void *item) {
+  size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  if (tail - head > queue->mask) return false;
+  queue->items[tail & queue->mask] = item;
+  atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+static bool spsc_pop(seq_queue_t *queue, void **item) {
+  size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  if (head == tail) return false;
+  *item = queue->items[head & queue->mask];
+  atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+  return true;
+}
+
+static bool mpmc_push(seq_queue_t *queue, void *item) {
+  size_t position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  for (;;) {
+    queue_cell_t *cell = &queue->cells[position & queue->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        cell->item = item;
+        atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;  // Full: the cell still holds an item from a lap ago
+    } else {
+      position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    }
+  }
+}
+
+static bool mpmc_pop(seq_queue_t *queue, void **item) {
+  size_t position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  for (;;) {
+    queue_cell_t *cell = &queue->cells[position & queue->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)(position + 1);
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        *item = cell->item;
+        atomic_store_explicit(&cell->sequence, position + queue->mask + 1, memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;  // Empty
+    } else {
+      position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    }
+  }
+}
+
+bool seq_queue_try_push(seq_queue_t *queue, void *item) {
+  bool ok = queue->kind == SEQ_QUEUE_SPSC ? spsc_push(queue, item) : mpmc_push(queue, item);
+  if (ok) parking_notify(&queue->not_empty);
+  return ok;
+}
+
+bool seq_queue_try_pop(seq_queue_t *queue, void **item) {
+  bool ok = queue->kind == SEQ_QUEUE_SPSC ? spsc_pop(queue, item) : mpmc_pop(queue, item);
+  if (ok) parking_notify(&queue->not_full);
+  return ok;
+}
+
+typedef struct {
+  seq_queue_t *queue;
+  void *item;
+} queue_op_t;
+
+static bool attempt_push(void *arg) {
+  queue_op_t *op = (queue_op_t*)arg;
+  if (atomic_load(&op->queue->closed)) return false;
+  return op->queue->kind == SEQ_QUEUE_SPSC ? spsc_push(op->queue, op->item) : mpmc_push(op->queue, op->item);
+}
+
+static bool attempt_pop(void *arg) {
+  queue_op_t *op = (queue_op_t*)arg;
+  return op->queue->kind == SEQ_QUEUE_SPSC ? spsc_pop(op->queue, &op->item) : mpmc_pop(op->queue, &op->item);
+}
+
+bool seq_queue_push(seq_queue_t *queue, void *item) {
+  queue_op_t op = {queue, item};
+  if (!parking_wait(&queue->not_full, attempt_push, &op, &queue->closed)) return false;
+  parking_notify(&queue->not_empty);
+  return true;
+}
+
+bool seq_queue_pop(seq_queue_t *queue, void **item) {
+  queue_op_t op = {queue, NULL};
+  if (!parking_wait(&queue->not_empty, attempt_pop, &op, &queue->closed)) return false;
+  *item = op.item;
+  parking_notify(&queue->not_full);
+  return true;
+}
+
+void seq_queue_close(seq_queue_t *queue) {
+  atomic_store(&queue->closed, true);
+  // Take each mutex so a waiter between its check and its sleep still gets the broadcast
+  pthread_mutex_lock(&queue->not_empty.mutex);
+  pthread_cond_broadcast(&queue->not_empty.cond);
+  pthread_mutex_unlock(&queue->not_empty.mutex);
+  pthread_mutex_lock(&queue->not_full.mutex);
+  pthread_cond_broadcast(&queue->not_full.cond);
+  pthread_mutex_unlock(&queue->not_full.mutex);
+}
+
+// **********************************************************************
+// Ordered Pipeline
+// **********************************************************************
+
+// Slots circulate free -> (source) -> work + order -> (worker) done -> (sink) -> free.
+// The order queue carries slots in source order, so the sink only has to wait
+// for each one's done flag: reassembly needs no sequence numbers or sorting.
+// Over the --max-memory budget the source reads nothing new while any item is
+// still in flight (waking as the sink finishes each one), so one item at a
+// time always gets through and the pipeline cannot stall on itself.
+typedef struct {
+  const seq_pipeline_config *config;
+  uint8_t *items;
+  atomic_bool *done;
+  seq_queue_t *free_slots;   // Sink -> source (SPSC)
+  seq_queue_t *work;         // Source -> workers (MPMC)
+  seq_queue_t *order;        // Source -> sink (SPSC)
+  parking_t done_parking;
+  atomic_size_t in_flight;   // Items read but not yet through the sink
+  parking_t sunk_parking;    // Source waiting for the budget
+} pipeline_t;
+
+typedef struct {
+  pipeline_t *pipeline;
+  size_t slot;
+} done_wait_t;
+
+static size_t slot_index(const pipeline_t *pipeline, const void *item) {
+  return (size_t)((const uint8_t*)item - pipeline->items) / pipeline->config->item_size;
+}
+
+static bool attempt_within_budget(void *arg) {
+  pipeline_t *pipeline = (pipeline_t*)arg;
+  return !seq_memory_over_budget() || atomic_load(&pipeline->in_flight) == 0;
+}
+
+static void* pipeline_source(void *arg) {
+  pipeline_t *pipeline = (pipeline_t*)arg;
+  const seq_pipeline_config *config = pipeline->config;
+
+  void *item;
+  while (seq_queue_pop(pipeline->free_slots, &item)) {
+    if (!attempt_within_budget(pipeline)) {
+      uint64_t stall_start = seq_profile_now_ns();
+      parking_wait(&pipeline->sunk_parking, attempt_within_budget, pipeline, NULL);
+      seq_memory_record_stall(seq_profile_now_ns() - stall_start);
+    }
+    if (!config->source(config->context, item)) break;
+    atomic_store_explicit(&pipeline->done[slot_index(pipeline, item)], false, memory_order_relaxed);
+    atomic_fetch_add(&pipeline->in_flight, 1);
+    seq_queue_push(pipeline->order, item);
+    seq_queue_push(pipeline->work, item);
+  }
+  seq_queue_close(pipeline->work);
+  seq_queue_close(pipeline->order);
+  return NULL;
+}
+
+static void* pipeline_worker(void *arg) {
+  pipeline_t *pipeline = (pipeline_t*)arg;
+  const seq_pipeline_config *config = pipeline->config;
+
+  void *item;
+  while (seq_queue_pop(pipeline->work, &item)) {
+    if (config->transform) config->transform(config->context, item);
+    atomic_store_explicit(&pipeline->done[slot_index(pipeline, item)], true, memory_order_release);
+    parking_notify(&pipeline->done_parking);
+  }
+  return NULL;
+}
+
+static bool attempt_done(void *arg) {
+  done_wait_t *wait = (done_wait_t*)arg;
+  return atomic_load_explicit(&wait->pipeline->done[wait->slot], memory_order_acquire);
+}
+
+static bool run_inline(const seq_pipeline_config *config) {
+  void *item = malloc(config->item_size);
+  if (!item) {
+    warnx("Memory allocation failed for pipeline item");
+    return false;
+  }
+  while (config->source(config->context, item)) {
+    if (config->transform) config->transform(config->context, item);
+    config->sink(config->context, item);
+  }
+  free(item);
+  return true;
+}
+
+static void free_pipeline(pipeline_t *pipeline, pthread_t *workers) {
+  parking_destroy(&pipeline->done_parking);
+  parking_destroy(&pipeline->sunk_parking);
+  free(workers);
+  seq_queue_free(pipeline->order);
+  seq_queue_free(pipeline->work);
+  seq_queue_free(pipeline->free_slots);
+  free(pipeline->done);
+  free(pipeline->items);
+}
+
+bool seq_pipeline_run(const seq_pipeline_config *config) {
+  if (config->num_workers <= 1) {
+    return run_inline(config);
+  }
+
+  size_t capacity = config->max_in_flight ? config->max_in_flight : 4 * (size_t)config->num_workers;
+  pipeline_t pipeline = {
+    .config = config,
+    .items = malloc(capacity * config->item_size),
+    .done = calloc(capacity, sizeof(atomic_bool)),
+    .free_slots = seq_queue_create(capacity, SEQ_QUEUE_SPSC),
+    .work = seq_queue_create(capacity, SEQ_QUEUE_MPMC),
+    .order = seq_queue_create(capacity, SEQ_QUEUE_SPSC)
+  };
+  pthread_t *workers = calloc(config->num_workers, sizeof(pthread_t));
+  parking_init(&pipeline.done_parking);
+  parking_init(&pipeline.sunk_parking);
+  if (!pipeline.items || !pipeline.done || !pipeline.free_slots || !pipeline.work || !pipeline.order || !workers) {
+    // Nothing has been read yet, so the calling thread can still do it all
+    warnx("Memory allocation failed for pipeline, running on one thread");
+    free_pipeline(&pipeline, workers);
+    return run_inline(config);
+  }
+  atomic_init(&pipeline.in_flight, 0);
+  for (size_t i = 0; i < capacity; i++) {
+    seq_queue_try_push(pipeline.free_slots, pipeline.items + i * config->item_size);
+  }
+
+  // Fewer workers than asked for only slows the run; without any, or without
+  // the source thread, it falls back to running inline
+  int started = 0;
+  while (started < config->num_workers &&
+         pthread_create(&workers[started], NULL, pipeline_worker, &pipeline) == 0) {
+    started++;
+  }
+  pthread_t source;
+  if (started == 0 || pthread_create(&source, NULL, pipeline_source, &pipeline) != 0) {
+    warnx("Failed to create pipeline threads, running on one thread");
+    seq_queue_close(pipeline.work);
+    for (int t = 0; t < started; t++) {
+      pthread_join(workers[t], NULL);
+    }
+    free_pipeline(&pipeline, workers);
+    return run_inline(config);
+  }
+
+  // Sink: strictly in source order
+  void *item;
+  while (seq_queue_pop(pipeline.order, &item)) {
+    done_wait_t wait = {&pipeline, slot_index(&pipeline, item)};
+    parking_wait(&pipeline.done_parking, attempt_done, &wait, NULL);
+    config->sink(config->context, item);
+    seq_queue_push(pipeline.free_slots, item);
+    atomic_fetch_sub(&pipeline.in_flight, 1);
+    parking_notify(&pipeline.sunk_parking);
+  }
+
+  pthread_join(source, NULL);
+  for (int t = 0; t < started; t++) {
+    pthread_join(workers[t], NULL);
+  }
+
+  free_pipeline(&pipeline, workers);
+  return true;
+}
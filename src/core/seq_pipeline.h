@@ -0,0 +1,76 @@
+// **********************************************************************
+// core/seq_pipeline.h - Lock-Free Queues and Ordered Pipeline Stages
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Shared threading plumbing for subcommands that stream items through
+//   source (one thread) -> transform (N workers, any order) -> sink (in order)
+// so each one does not grow its own mutex/condvar ring.
+//
+// seq_queue_t is a bounded queue of pointers: single-producer/single-consumer
+// (two atomic indices) or multi-producer/multi-consumer (per-cell sequence
+// numbers, after D. Vyukov). The try_ operations never lock; the blocking
+// ones spin briefly and then park, and a push or pop only takes the parking
+// mutex when someone is actually parked on the other side.
+//
+// Payload buffers (seq_tensor signals) are recycled by seq_tensor_pool,
+// which transforms can draw from and sinks return to with seq_tensor_free().
+// Under a --max-memory budget (seq_memory.h) the source blocks once usage
+// reaches it, until the sink has drained what is in flight.
+#ifndef SEQUELIZER_SEQ_PIPELINE_H
+#define SEQUELIZER_SEQ_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// **********************************************************************
+// Bounded Queues
+// **********************************************************************
+
+typedef enum {
+  SEQ_QUEUE_SPSC,          // Exactly one pushing and one popping thread
+  SEQ_QUEUE_MPMC           // Any number of either
+} seq_queue_kind;
+
+typedef struct seq_queue seq_queue_t;
+
+// Capacity is rounded up to a power of two; NULL if out of memory
+seq_queue_t* seq_queue_create(size_t capacity, seq_queue_kind kind);
+void         seq_queue_free(seq_queue_t *queue);
+
+// Non-blocking: false if full (push) or empty (pop)
+bool seq_queue_try_push(seq_queue_t *queue, void *item);
+bool seq_queue_try_pop(seq_queue_t *queue, void **item);
+
+// Blocking: push waits for space (false once closed), pop waits for an item
+// (false once closed and drained)
+bool seq_queue_push(seq_queue_t *queue, void *item);
+bool seq_queue_pop(seq_queue_t *queue, void **item);
+
+// No more pushes; wakes every waiter. Items already queued can still be popped
+void seq_queue_close(seq_queue_t *queue);
+
+// **********************************************************************
+// Ordered Pipeline
+// **********************************************************************
+
+// Items are item_size bytes of per-slot storage owned by the pipeline: source
+// fills one in place, transform works on it, sink must take what it keeps
+// before returning (the slot is then reused)
+typedef struct {
+  bool (*source)(void *context, void *item);     // Next item in order; false at the end (one thread)
+  void (*transform)(void *context, void *item);  // Worker threads, any order; NULL to skip
+  void (*sink)(void *context, void *item);       // Calling thread, strictly in source order
+  void *context;
+  size_t item_size;
+  int num_workers;         // <= 1 runs all three stages inline on the calling thread
+  size_t max_in_flight;    // Items between source and sink (0 = 4 per worker)
+} seq_pipeline_config;
+
+// Run source -> transform -> sink until the source is exhausted. Output order
+// never depends on num_workers. Short of memory or threads it runs on fewer
+// workers or inline; false (after a warning) only if not even one item fits,
+// in which case the source was never called
+bool seq_pipeline_run(const seq_pipeline_config *config);
+
+#endif // SEQUELIZER_SEQ_PIPELINE_H
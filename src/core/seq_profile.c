@@ -0,0 +1,110 @@
+// **********************************************************************
+// core/seq_profile.c - Stage Timers and Counters for --profile
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_profile.h"
+#include "seq_memory.h"
+#include <err.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+bool seq_profile_active = false;
+
+static const char *stage_names[SEQ_PROFILE_NUM_STAGES] = {
+  "discovery", "h5fopen", "metadata", "signal_read", "kmer_lookup", "noise", "format", "fast5_write"
+};
+static const char *counter_names[SEQ_PROFILE_NUM_COUNTERS] = {
+  "hdf5_calls", "bytes_read", "bytes_written"
+};
+
+// Relaxed atomics: probes only add, and the report runs once every worker is done
+static atomic_uint_fast64_t stage_ns[SEQ_PROFILE_NUM_STAGES];
+static atomic_uint_fast64_t stage_calls[SEQ_PROFILE_NUM_STAGES];
+static atomic_uint_fast64_t counters[SEQ_PROFILE_NUM_COUNTERS];
+
+static uint64_t start_ns;
+static bool report_json;
+
+uint64_t seq_profile_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void seq_profile_record(seq_profile_stage stage, uint64_t start) {
+  atomic_fetch_add_explicit(&stage_ns[stage], seq_profile_now_ns() - start, memory_order_relaxed);
+  atomic_fetch_add_explicit(&stage_calls[stage], 1, memory_order_relaxed);
+}
+
+void seq_profile_add(seq_profile_counter counter, uint64_t amount) {
+  atomic_fetch_add_explicit(&counters[counter], amount, memory_order_relaxed);
+}
+
+static void report_profile(void) {
+  double wall = (double)(seq_profile_now_ns() - start_ns) * 1e-9;
+  FILE *out = stderr;
+
+  if (report_json) {
+    fprintf(out, "{\"wall_seconds\": %.6f, \"stages\": {", wall);
+    for (int s = 0; s < SEQ_PROFILE_NUM_STAGES; s++) {
+      fprintf(out, "%s\"%s\": {\"calls\": %llu, \"seconds\": %.6f}", s ? ", " : "", stage_names[s],
+              (unsigned long long)atomic_load(&stage_calls[s]), (double)atomic_load(&stage_ns[s]) * 1e-9);
+    }
+    fprintf(out, "}, \"counters\": {");
+    for (int c = 0; c < SEQ_PROFILE_NUM_COUNTERS; c++) {
+      fprintf(out, "%s\"%s\": %llu", c ? ", " : "", counter_names[c], (unsigned long long)atomic_load(&counters[c]));
+    }
+    fprintf(out, "}, \"memory\": {\"current_bytes\": %zu, \"peak_bytes\": %zu, \"budget_bytes\": %zu, "
+            "\"stalls\": %llu, \"stall_seconds\": %.6f}}\n", seq_memory_used(), seq_memory_peak(), seq_memory_budget(),
+            (unsigned long long)seq_memory_stalls(), (double)seq_memory_stall_ns() * 1e-9);
+    return;
+  }
+
+  fprintf(out, "\n=== Profile (wall %.3f s; stage times summed over threads) ===\n", wall);
+  fprintf(out, "%-14s %12s %12s %8s\n", "stage", "calls", "seconds", "% wall");
+  for (int s = 0; s < SEQ_PROFILE_NUM_STAGES; s++) {
+    uint64_t calls = atomic_load(&stage_calls[s]);
+    if (calls == 0) continue;
+    double seconds = (double)atomic_load(&stage_ns[s]) * 1e-9;
+    fprintf(out, "%-14s %12llu %12.6f %8.1f\n", stage_names[s], (unsigned long long)calls, seconds,
+            wall > 0 ? 100.0 * seconds / wall : 0.0);
+  }
+  for (int c = 0; c < SEQ_PROFILE_NUM_COUNTERS; c++) {
+    fprintf(out, "%-14s %12llu\n", counter_names[c], (unsigned long long)atomic_load(&counters[c]));
+  }
+
+  // Tracked allocations (tensor data, shards, kept metadata), not the whole RSS
+  fprintf(out, "%-14s %12.1f MB now, %.1f MB peak", "memory", seq_memory_used() / 1e6, seq_memory_peak() / 1e6);
+  if (seq_memory_budget() > 0) {
+    fprintf(out, " of %.1f MB budget; readers blocked %llu times (%.3f s)", seq_memory_budget() / 1e6,
+            (unsigned long long)seq_memory_stalls(), (double)seq_memory_stall_ns() * 1e-9);
+  }
+  fprintf(out, "\n");
+}
+
+bool seq_profile_enable(const char *format) {
+#ifdef SEQUELIZER_PROFILE
+  if (format && strcmp(format, "json") != 0 && strcmp(format, "table") != 0) {
+    warnx("Invalid profile format '%s'. Supported formats: table, json", format);
+    return false;
+  }
+  if (seq_profile_active) return true;
+  report_json = format && strcmp(format, "json") == 0;
+  start_ns = seq_profile_now_ns();
+  seq_profile_active = true;
+  if (atexit(report_profile) != 0) {
+    warnx("Cannot register the profile report");
+    return false;
+  }
+  return true;
+#else
+  (void)format;
+  (void)report_profile;
+  warnx("Profiling is compiled out of this build (configure with -DSEQUELIZER_PROFILE=ON)");
+  return false;
+#endif
+}
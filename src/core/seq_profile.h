@@ -0,0 +1,69 @@
+// **********************************************************************
+// core/seq_profile.h - Stage Timers and Counters for --profile
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Low-overhead instrumentation shared by every subcommand: a fixed set of
+// stages timed with the monotonic clock and a few atomic counters, reported
+// on stderr at exit (table or JSON) once --profile turns them on, together
+// with the current and peak tracked memory from seq_memory.h.
+//
+// Probes are macros. Built with SEQUELIZER_PROFILE (the CMake option of the
+// same name, on by default) an inactive probe costs one predictable branch;
+// without it they compile to nothing. Stage times are summed over threads
+// (so with N workers a stage can exceed the wall time) and probes never
+// nest: each stage times its own work, not its callees'.
+//
+//   uint64_t start = SEQ_PROFILE_START();
+//   ... read the signal ...
+//   SEQ_PROFILE_STOP(SEQ_PROFILE_SIGNAL_READ, start);
+//   SEQ_PROFILE_COUNT(SEQ_PROFILE_BYTES_READ, length * sizeof(int16_t));
+#ifndef SEQUELIZER_SEQ_PROFILE_H
+#define SEQUELIZER_SEQ_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  SEQ_PROFILE_DISCOVERY,     // Finding input files
+  SEQ_PROFILE_H5FOPEN,       // Opening (and classifying) Fast5 files
+  SEQ_PROFILE_METADATA,      // Metadata enhancers (tracking_id, channel_id, calibration...)
+  SEQ_PROFILE_SIGNAL_READ,   // Signal dataset reads
+  SEQ_PROFILE_KMER_LOOKUP,   // k-mer model table lookups
+  SEQ_PROFILE_NOISE,         // Gaussian noise generation
+  SEQ_PROFILE_FORMAT,        // Text formatting of signals and squiggles
+  SEQ_PROFILE_FAST5_WRITE,   // Fast5 file creation and Signal writes
+  SEQ_PROFILE_NUM_STAGES
+} seq_profile_stage;
+
+typedef enum {
+  SEQ_PROFILE_HDF5_CALLS,    // File opens/creates plus dataset and attribute reads/writes
+  SEQ_PROFILE_BYTES_READ,    // Signal bytes read from Fast5 datasets
+  SEQ_PROFILE_BYTES_WRITTEN, // Signal bytes written to Fast5 plus buffered text/binary output
+  SEQ_PROFILE_NUM_COUNTERS
+} seq_profile_counter;
+
+// Turn profiling on and report at exit; format is "table" (NULL) or "json".
+// False (with a warning) for an unknown format or a build without SEQUELIZER_PROFILE.
+// Call before any worker thread starts
+bool seq_profile_enable(const char *format);
+
+// Probe back ends (use the macros below)
+extern bool seq_profile_active;
+uint64_t seq_profile_now_ns(void);
+void     seq_profile_record(seq_profile_stage stage, uint64_t start_ns);
+void     seq_profile_add(seq_profile_counter counter, uint64_t amount);
+
+#ifdef SEQUELIZER_PROFILE
+#define SEQ_PROFILE_START() (seq_profile_active ? seq_profile_now_ns() : (uint64_t)0)
+#define SEQ_PROFILE_STOP(stage, start) \
+  do { if (start) seq_profile_record((stage), (start)); } while (0)
+#define SEQ_PROFILE_COUNT(counter, amount) \
+  do { if (seq_profile_active) seq_profile_add((counter), (uint64_t)(amount)); } while (0)
+#else
+#define SEQ_PROFILE_START() ((uint64_t)0)
+#define SEQ_PROFILE_STOP(stage, start) ((void)(start))
+#define SEQ_PROFILE_COUNT(counter, amount) ((void)0)
+#endif
+
+#endif // SEQUELIZER_SEQ_PROFILE_H
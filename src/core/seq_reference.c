@@ -0,0 +1,346 @@
+// **********************************************************************
+// core/seq_reference.c - Packed Reference Genomes for Read Sampling
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_reference.h"
+#include "seq_input.h"
+#include <err.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Chunk size for compressed input (plain files are scanned straight from the mapping)
+#define SEQ_REFERENCE_READ_SIZE (256 * 1024)
+
+// Rejection sampling gives up after this many draws land on a contig end or an N run
+#define SEQ_REFERENCE_MAX_DRAWS 10000
+
+// Ambiguous bases [begin, end) in packed genome coordinates
+typedef struct {
+  size_t begin;
+  size_t end;
+} ambiguous_run_t;
+
+struct seq_reference {
+  seq_packed genome;             // Owns data; every contig is a window of it
+  size_t capacity;               // Bytes allocated for genome.data
+
+  seq_reference_contig *contigs;
+  size_t num_contigs;
+  size_t contig_capacity;
+
+  ambiguous_run_t *runs;         // Sorted, non-overlapping
+  size_t num_runs;
+  size_t run_capacity;
+  size_t ambiguous_bases;
+};
+
+// FASTA scanner state carried across input chunks
+typedef enum {
+  SCAN_START,                    // Nothing but blank lines so far
+  SCAN_NAME,                     // Header, collecting the contig name
+  SCAN_HEADER,                   // Rest of the header line (description)
+  SCAN_SEQUENCE                  // Sequence lines
+} scan_state_t;
+
+typedef struct {
+  seq_reference_t *reference;
+  scan_state_t state;
+  bool line_start;
+  char *name;
+  size_t name_length;
+  size_t name_capacity;
+  const char *path;
+} scanner_t;
+
+// **********************************************************************
+// Building
+// **********************************************************************
+
+static void* grow(void *array, size_t *capacity, size_t needed, size_t element_size) {
+  if (needed <= *capacity) return array;
+  size_t new_capacity = *capacity ? *capacity : 64;
+  while (new_capacity < needed) new_capacity *= 2;
+  void *grown = realloc(array, new_capacity * element_size);
+  if (!grown) {
+    errx(EXIT_FAILURE, "Memory allocation failed for reference genome");
+  }
+  *capacity = new_capacity;
+  return grown;
+}
+
+static void append_base(seq_reference_t *reference, uint8_t c) {
+  size_t position = reference->genome.length++;
+  size_t old_capacity = reference->capacity;
+  reference->genome.data = grow(reference->genome.data, &reference->capacity, position / 4 + 1, 1);
+  if (reference->capacity > old_capacity) {
+    memset(reference->genome.data + old_capacity, 0, reference->capacity - old_capacity);
+  }
+
+  uint8_t u = c & 0xDF;  // fold lower case (soft-masked repeats are ordinary bases)
+  uint8_t code;
+  switch (u) {
+    case 'A': code = 0; break;
+    case 'C': code = 1; break;
+    case 'G': code = 2; break;
+    case 'T': code = 3; break;
+    default:
+      // Packed as A; sampling steps around it
+      code = 0;
+      reference->ambiguous_bases++;
+      if (reference->num_runs > 0 && reference->runs[reference->num_runs - 1].end == position) {
+        reference->runs[reference->num_runs - 1].end++;
+      } else {
+        reference->runs = grow(reference->runs, &reference->run_capacity, reference->num_runs + 1,
+                               sizeof(ambiguous_run_t));
+        reference->runs[reference->num_runs++] = (ambiguous_run_t){position, position + 1};
+      }
+      break;
+  }
+  reference->genome.data[position >> 2] |= (uint8_t)(code << (6 - 2 * (position & 3)));
+}
+
+static void begin_contig(scanner_t *scanner) {
+  seq_reference_t *reference = scanner->reference;
+  char *name = malloc(scanner->name_length + 1);
+  if (!name) {
+    errx(EXIT_FAILURE, "Memory allocation failed for contig name");
+  }
+  memcpy(name, scanner->name, scanner->name_length);
+  name[scanner->name_length] = '\0';
+
+  reference->contigs = grow(reference->contigs, &reference->contig_capacity, reference->num_contigs + 1,
+                            sizeof(seq_reference_contig));
+  reference->contigs[reference->num_contigs++] = (seq_reference_contig){name, reference->genome.length, 0};
+}
+
+// Feed the next bytes of the file; false (with a warning) if it is not FASTA
+static bool scan_bytes(scanner_t *scanner, const uint8_t *bytes, size_t size) {
+  seq_reference_t *reference = scanner->reference;
+
+  for (size_t i = 0; i < size; i++) {
+    uint8_t c = bytes[i];
+    bool newline = (c == '\n');
+
+    switch (scanner->state) {
+      case SCAN_SEQUENCE:
+        if (scanner->line_start && c == '>') {
+          reference->contigs[reference->num_contigs - 1].length =
+            reference->genome.length - reference->contigs[reference->num_contigs - 1].start;
+          scanner->state = SCAN_NAME;
+          scanner->name_length = 0;
+        } else if (c > ' ') {
+          append_base(reference, c);
+        }
+        break;
+      case SCAN_START:
+        if (c == '>') {
+          scanner->state = SCAN_NAME;
+          scanner->name_length = 0;
+        } else if (c > ' ') {
+          warnx("Reference \"%s\" is not a FASTA file (expected '>' before '%c')", scanner->path, c);
+          return false;
+        }
+        break;
+      case SCAN_NAME:
+        if (c <= ' ') {
+          begin_contig(scanner);
+          scanner->state = newline ? SCAN_SEQUENCE : SCAN_HEADER;
+        } else {
+          scanner->name = grow(scanner->name, &scanner->name_capacity, scanner->name_length + 1, 1);
+          scanner->name[scanner->name_length++] = (char)c;
+        }
+        break;
+      case SCAN_HEADER:
+        if (newline) scanner->state = SCAN_SEQUENCE;
+        break;
+    }
+    scanner->line_start = newline;
+  }
+  return true;
+}
+
+static bool finish_scan(scanner_t *scanner) {
+  seq_reference_t *reference = scanner->reference;
+  if (scanner->state == SCAN_NAME) {
+    begin_contig(scanner);  // Header on the last line, no sequence
+  }
+  if (reference->num_contigs > 0) {
+    reference->contigs[reference->num_contigs - 1].length =
+      reference->genome.length - reference->contigs[reference->num_contigs - 1].start;
+  }
+  if (reference->genome.length == reference->ambiguous_bases) {
+    warnx("Reference \"%s\" has no A/C/G/T bases", scanner->path);
+    return false;
+  }
+  return true;
+}
+
+// Plain files: scan the mapping directly, no read buffers or copies
+static bool scan_mapped(scanner_t *scanner, int fd, size_t size) {
+  if (size == 0) return true;
+  void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    warnx("Failed to map reference \"%s\"", scanner->path);
+    return false;
+  }
+  madvise(map, size, MADV_SEQUENTIAL);
+
+  // Packed genome is at most a quarter of the file
+  scanner->reference->genome.data = grow(scanner->reference->genome.data, &scanner->reference->capacity,
+                                         size / 4 + 1, 1);
+  memset(scanner->reference->genome.data, 0, scanner->reference->capacity);
+
+  bool ok = scan_bytes(scanner, map, size);
+  munmap(map, size);
+  return ok;
+}
+
+// gzip/BGZF: decompressed chunks from seq_input
+static bool scan_stream(scanner_t *scanner, seq_input_t *input) {
+  uint8_t *buffer = malloc(SEQ_REFERENCE_READ_SIZE);
+  if (!buffer) {
+    errx(EXIT_FAILURE, "Memory allocation failed for reference input buffer");
+  }
+
+  bool ok = true;
+  int n;
+  while (ok && (n = seq_input_read(input, buffer, SEQ_REFERENCE_READ_SIZE)) > 0) {
+    ok = scan_bytes(scanner, buffer, (size_t)n);
+  }
+  if (ok && n < 0) {
+    ok = false;  // seq_input has already reported it
+  }
+  free(buffer);
+  return ok;
+}
+
+seq_reference_t* seq_reference_open(const char *path, int threads) {
+  seq_reference_t *reference = calloc(1, sizeof(seq_reference_t));
+  if (!reference) {
+    errx(EXIT_FAILURE, "Memory allocation failed for reference genome");
+  }
+  scanner_t scanner = {
+    .reference = reference,
+    .state = SCAN_START,
+    .line_start = true,
+    .path = path
+  };
+
+  // seq_input detects the compression from the contents
+  seq_input_t *input = seq_input_open(path, threads);
+  if (!input) {
+    free(reference);
+    return NULL;
+  }
+
+  bool ok;
+  if (seq_input_get_format(input) == SEQ_INPUT_PLAIN) {
+    seq_input_close(input);
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+      warnx("Cannot open reference \"%s\"", path);
+      ok = false;
+    } else {
+      ok = scan_mapped(&scanner, fd, (size_t)st.st_size);
+    }
+    if (fd >= 0) close(fd);
+  } else {
+    ok = scan_stream(&scanner, input);
+    seq_input_close(input);
+  }
+  ok = ok && finish_scan(&scanner);
+  free(scanner.name);
+
+  if (!ok) {
+    seq_reference_close(reference);
+    return NULL;
+  }
+  return reference;
+}
+
+void seq_reference_close(seq_reference_t *reference) {
+  if (!reference) return;
+  for (size_t i = 0; i < reference->num_contigs; i++) {
+    free(reference->contigs[i].name);
+  }
+  free(reference->contigs);
+  free(reference->runs);
+  free(reference->genome.data);
+  free(reference);
+}
+
+// **********************************************************************
+// Queries and Sampling
+// **********************************************************************
+
+size_t seq_reference_num_contigs(const seq_reference_t *reference) {
+  return reference->num_contigs;
+}
+
+const seq_reference_contig* seq_reference_get_contig(const seq_reference_t *reference, size_t index) {
+  return index < reference->num_contigs ? &reference->contigs[index] : NULL;
+}
+
+size_t seq_reference_total_length(const seq_reference_t *reference) {
+  return reference->genome.length;
+}
+
+size_t seq_reference_ambiguous_bases(const seq_reference_t *reference) {
+  return reference->ambiguous_bases;
+}
+
+// Contig holding genome position (last contig starting at or before it, skipping empty ones)
+static size_t contig_at(const seq_reference_t *reference, size_t position) {
+  size_t lo = 0, hi = reference->num_contigs;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (reference->contigs[mid].start <= position) lo = mid; else hi = mid;
+  }
+  return lo;
+}
+
+// Does [begin, end) touch an ambiguous run?
+static bool overlaps_ambiguous(const seq_reference_t *reference, size_t begin, size_t end) {
+  // First run ending after begin
+  size_t lo = 0, hi = reference->num_runs;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (reference->runs[mid].end <= begin) lo = mid + 1; else hi = mid;
+  }
+  return lo < reference->num_runs && reference->runs[lo].begin < end;
+}
+
+bool seq_reference_sample(const seq_reference_t *reference, size_t length, seq_rng *rng,
+                          seq_reference_read *read) {
+  size_t total = reference->genome.length;
+  if (length == 0 || length > total) return false;
+
+  // A uniform start over the whole genome, kept only when the window fits in its
+  // contig and avoids N runs, is uniform over exactly the valid windows
+  for (int draw = 0; draw < SEQ_REFERENCE_MAX_DRAWS; draw++) {
+    size_t position = (size_t)(seq_rng_next(rng) % total);
+    size_t contig = contig_at(reference, position);
+    const seq_reference_contig *c = &reference->contigs[contig];
+    if (position + length > c->start + c->length) continue;
+    if (overlaps_ambiguous(reference, position, position + length)) continue;
+
+    read->contig = contig;
+    read->start = position - c->start;
+    read->length = length;
+    read->reverse = (seq_rng_next(rng) >> 63) != 0;
+    return true;
+  }
+  return false;
+}
+
+seq_packed seq_reference_read_bases(const seq_reference_t *reference, const seq_reference_read *read) {
+  return seq_packed_view(&reference->genome, reference->contigs[read->contig].start + read->start,
+                         read->length, read->reverse);
+}
@@ -0,0 +1,57 @@
+// **********************************************************************
+// core/seq_reference.h - Packed Reference Genomes for Read Sampling
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// A FASTA reference is scanned once (memory-mapped when uncompressed, through
+// seq_input for gzip/BGZF) into a single 2-bit packed genome plus a contig
+// table. Reads are then drawn as (contig, start, length, strand) windows and
+// read back as seq_packed views of the genome: no bases are copied and the
+// reverse strand is complemented on the fly as the view is read.
+//
+// Bases other than A,C,G,T (N runs, IUPAC codes) are recorded as ambiguous
+// intervals; sampled windows never overlap them.
+#ifndef SEQUELIZER_SEQ_REFERENCE_H
+#define SEQUELIZER_SEQ_REFERENCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "seq_packed.h"
+#include "seq_rng.h"
+
+typedef struct {
+  char *name;       // FASTA header up to the first whitespace
+  size_t start;     // First base within the packed genome
+  size_t length;    // Number of bases
+} seq_reference_contig;
+
+// One sampled read: bases [start, start + length) of a contig, on either strand
+typedef struct {
+  size_t contig;
+  size_t start;     // 0-based within the contig
+  size_t length;
+  bool reverse;     // Reverse-complement strand
+} seq_reference_read;
+
+typedef struct seq_reference seq_reference_t;
+
+// Load and pack a FASTA reference; threads inflate BGZF input (see seq_input_open).
+// NULL with a warning on failure
+seq_reference_t* seq_reference_open(const char *path, int threads);
+void             seq_reference_close(seq_reference_t *reference);
+
+size_t                      seq_reference_num_contigs(const seq_reference_t *reference);
+const seq_reference_contig* seq_reference_get_contig(const seq_reference_t *reference, size_t index);
+size_t                      seq_reference_total_length(const seq_reference_t *reference);
+size_t                      seq_reference_ambiguous_bases(const seq_reference_t *reference);
+
+// Draw a read of length bases uniformly over every unambiguous window of every
+// contig, strand chosen with equal odds. Reads only the reference (thread-safe
+// for distinct rngs). False if no such window was found
+bool seq_reference_sample(const seq_reference_t *reference, size_t length, seq_rng *rng,
+                          seq_reference_read *read);
+
+// The read's bases as a view into the packed genome (valid until close)
+seq_packed seq_reference_read_bases(const seq_reference_t *reference, const seq_reference_read *read);
+
+#endif // SEQUELIZER_SEQ_REFERENCE_H
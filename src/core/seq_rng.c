@@ -0,0 +1,114 @@
+// **********************************************************************
+// core/seq_rng.c - Reentrant Random Number Streams
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+
+#include "seq_rng.h"
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+// Box-Muller pairs computed per block: the bit draws run first, then a
+// branch-free transform loop over the block that the compiler can vectorise
+#define GAUSSIAN_BLOCK_PAIRS 64
+
+// Inverse Gaussian samples per block (one Gaussian and one uniform each)
+#define INVERSE_GAUSSIAN_BLOCK 128
+
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void seq_rng_init(seq_rng *rng, uint64_t seed, uint64_t stream) {
+  // Mix seed and stream separately so nearby (seed, stream) pairs land far apart
+  uint64_t a = seed;
+  uint64_t b = stream ^ 0xD1B54A32D192ED03ULL;
+  uint64_t x = splitmix64(&a) ^ (splitmix64(&b) * 0xFF51AFD7ED558CCDULL);
+  for (int i = 0; i < 4; i++) {
+    rng->s[i] = splitmix64(&x);
+  }
+  // All-zero state is the one fixed point of xoshiro
+  if (!(rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3])) rng->s[0] = 1;
+}
+
+uint64_t seq_rng_entropy_seed(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  uint64_t x = ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec ^ ((uint64_t)getpid() << 16);
+  return splitmix64(&x);
+}
+
+void seq_rng_fill_gaussian(seq_rng *rng, float *out, size_t n) {
+  float u1[GAUSSIAN_BLOCK_PAIRS];
+  float u2[GAUSSIAN_BLOCK_PAIRS];
+
+  while (n > 0) {
+    size_t pairs = (n + 1) / 2;
+    if (pairs > GAUSSIAN_BLOCK_PAIRS) pairs = GAUSSIAN_BLOCK_PAIRS;
+
+    // One 64-bit draw gives both 24-bit uniforms; u1 in (0, 1] keeps log() finite
+    for (size_t k = 0; k < pairs; k++) {
+      uint64_t bits = seq_rng_next(rng);
+      u1[k] = (float)((bits >> 40) + 1) * 0x1.0p-24f;
+      u2[k] = (float)((bits >> 16) & 0xFFFFFF) * 0x1.0p-24f;
+    }
+
+    size_t full = (2 * pairs <= n) ? pairs : pairs - 1;
+    for (size_t k = 0; k < full; k++) {
+      float r = sqrtf(-2.0f * logf(u1[k]));
+      float theta = 6.28318530717958647692f * u2[k];
+      out[2 * k] = r * cosf(theta);
+      out[2 * k + 1] = r * sinf(theta);
+    }
+
+    // Odd tail: one sample from the last pair
+    if (full < pairs) {
+      float r = sqrtf(-2.0f * logf(u1[full]));
+      out[2 * full] = r * cosf(6.28318530717958647692f * u2[full]);
+    }
+
+    size_t written = 2 * full + (full < pairs);
+    out += written;
+    n -= written;
+  }
+}
+
+void seq_rng_fill_inverse_gaussian(seq_rng *rng, const float *mean, const float *shape, float *out, size_t n) {
+  float z[INVERSE_GAUSSIAN_BLOCK];
+  float u[INVERSE_GAUSSIAN_BLOCK + 1];
+
+  while (n > 0) {
+    size_t count = n < INVERSE_GAUSSIAN_BLOCK ? n : INVERSE_GAUSSIAN_BLOCK;
+
+    seq_rng_fill_gaussian(rng, z, count);
+    for (size_t k = 0; k < count; k += 2) {
+      uint64_t bits = seq_rng_next(rng);
+      u[k] = (float)((bits >> 40) + 1) * 0x1.0p-24f;
+      u[k + 1] = (float)(((bits >> 16) & 0xFFFFFF) + 1) * 0x1.0p-24f;
+    }
+
+    // Michael-Schucany-Haas: the smaller root x of the chi-square(1) draw y = z^2,
+    // kept with probability mu / (mu + x), else its partner mu^2 / x. The root is
+    // taken as 4 mu lambda a / (a + s)^2 rather than mu + mu (a - s) / (2 lambda),
+    // which cancels for large y. Selects instead of branches so the loop vectorises
+    for (size_t k = 0; k < count; k++) {
+      float mu = mean[k];
+      float lambda = shape[k];
+      float a = mu * z[k] * z[k];
+      float s = sqrtf(a * (a + 4.0f * lambda));
+      float root = 4.0f * mu * lambda * a / ((a + s) * (a + s));
+      float x = (a > 0.0f) ? root : mu;
+      float partner = mu * mu / x;
+      float sample = (u[k] * (mu + x) <= mu) ? x : partner;
+      out[k] = ((mu > 0.0f) & (lambda > 0.0f)) ? sample : mu;
+    }
+
+    mean += count;
+    shape += count;
+    out += count;
+    n -= count;
+  }
+}
@@ -0,0 +1,59 @@
+// **********************************************************************
+// core/seq_rng.h - Reentrant Random Number Streams
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// xoshiro256** generator with explicit state (no hidden statics, no libc
+// rand()), so every caller owns its stream. Streams are derived from a
+// (seed, stream id) pair rather than from a shared sequence: read i of a
+// run seeded with S always draws from stream (S, i), whatever order or
+// thread the reads are generated in.
+#ifndef SEQUELIZER_SEQ_RNG_H
+#define SEQUELIZER_SEQ_RNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  uint64_t s[4];
+} seq_rng;
+
+// Initialise rng as stream `stream` of `seed` (splitmix64 expansion of both)
+void seq_rng_init(seq_rng *rng, uint64_t seed, uint64_t stream);
+
+// Seed derived from the clock and pid, for runs without --seed
+uint64_t seq_rng_entropy_seed(void);
+
+// Next 64 random bits
+static inline uint64_t seq_rng_next(seq_rng *rng) {
+  uint64_t *s = rng->s;
+  const uint64_t x = s[1] * 5;
+  const uint64_t result = ((x << 7) | (x >> 57)) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return result;
+}
+
+// Uniform double in [0, 1)
+static inline double seq_rng_uniform(seq_rng *rng) {
+  return (seq_rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+// Uniform integer in [0, n) (Lemire's multiply-shift, negligible bias for small n)
+static inline uint32_t seq_rng_below(seq_rng *rng, uint32_t n) {
+  return (uint32_t)(((seq_rng_next(rng) >> 32) * (uint64_t)n) >> 32);
+}
+
+// Fill out[0..n) with standard normal samples (batched Box-Muller, both outputs used)
+void seq_rng_fill_gaussian(seq_rng *rng, float *out, size_t n);
+
+// Fill out[0..n) with inverse Gaussian samples, out[i] ~ IG(mean[i], shape[i]), batched
+// like seq_rng_fill_gaussian (no log per sample). Non-positive parameters yield mean[i]
+void seq_rng_fill_inverse_gaussian(seq_rng *rng, const float *mean, const float *shape, float *out, size_t n);
+
+#endif // SEQUELIZER_SEQ_RNG_H
@@ -0,0 +1,363 @@
+// **********************************************************************
+// core/seq_shard.c - Memory-Mappable Training Shards
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+//
+#include "seq_shard.h"
+#include "seq_kernels.h"
+#include "seq_memory.h"
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A growing section of the shard being assembled
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+} shard_buffer_t;
+
+struct seq_shard_writer {
+  char *directory;
+  char *filename;            // Current shard
+  float sample_rate_khz;
+  uint32_t kmer_size;
+  size_t shard_bytes;
+  shard_buffer_t sections[SEQ_SHARD_NUM_SECTIONS];
+  uint64_t num_reads;        // In the current shard
+  uint64_t num_samples;
+  uint64_t num_bases;
+  uint64_t num_events;
+  seq_shard_stats_t stats;
+  bool failed;
+};
+
+static size_t page_round(size_t bytes) {
+  return (bytes + SEQ_SHARD_PAGE - 1) / SEQ_SHARD_PAGE * SEQ_SHARD_PAGE;
+}
+
+// Room for bytes more; false if out of memory (the buffer is left as it was)
+static bool buffer_reserve(shard_buffer_t *buffer, size_t bytes) {
+  if (buffer->size + bytes > buffer->capacity) {
+    size_t capacity = buffer->capacity ? buffer->capacity : SEQ_SHARD_PAGE;
+    while (capacity < buffer->size + bytes) capacity *= 2;
+    uint8_t *data = realloc(buffer->data, capacity);
+    if (!data) return false;
+    seq_memory_reserve(capacity - buffer->capacity);
+    buffer->data = data;
+    buffer->capacity = capacity;
+  }
+  return true;
+}
+
+// Only after buffer_reserve() has made the room
+static void* buffer_extend(shard_buffer_t *buffer, size_t bytes) {
+  void *p = buffer->data + buffer->size;
+  buffer->size += bytes;
+  return p;
+}
+
+// File size of the current shard with extra bytes added to each section
+static size_t shard_file_bytes(const seq_shard_writer_t *writer, const size_t extra[SEQ_SHARD_NUM_SECTIONS]) {
+  size_t bytes = SEQ_SHARD_PAGE;
+  for (int s = 0; s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    bytes += page_round(writer->sections[s].size + (extra ? extra[s] : 0));
+  }
+  return bytes;
+}
+
+// **********************************************************************
+// Writer
+// **********************************************************************
+
+static bool write_padded(FILE *file, const void *data, size_t bytes) {
+  static const uint8_t zeros[SEQ_SHARD_PAGE] = {0};
+  size_t padding = page_round(bytes) - bytes;
+  return (bytes == 0 || fwrite(data, 1, bytes, file) == bytes) &&
+         (padding == 0 || fwrite(zeros, 1, padding, file) == padding);
+}
+
+// Write the reads gathered so far as the next shard and start an empty one
+static void flush_shard(seq_shard_writer_t *writer) {
+  if (writer->num_reads == 0 || writer->failed) return;
+
+  size_t name_size = strlen(writer->directory) + 32;
+  free(writer->filename);
+  writer->filename = malloc(name_size);
+  if (!writer->filename) {
+    warnx("Memory allocation failed for shard name");
+    writer->failed = true;
+    return;
+  }
+  snprintf(writer->filename, name_size, "%s/shard_%05zu%s", writer->directory, writer->stats.shards,
+           SEQ_SHARD_EXTENSION);
+
+  seq_shard_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SEQ_SHARD_MAGIC, sizeof(header.magic));
+  header.version = SEQ_SHARD_VERSION;
+  header.page_size = SEQ_SHARD_PAGE;
+  header.num_reads = writer->num_reads;
+  header.num_samples = writer->num_samples;
+  header.num_bases = writer->num_bases;
+  header.num_events = writer->num_events;
+  header.sample_rate_khz = writer->sample_rate_khz;
+  header.kmer_size = writer->kmer_size;
+  uint64_t offset = SEQ_SHARD_PAGE;
+  for (int s = 0; s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    header.sections[s].offset = offset;
+    header.sections[s].bytes = writer->sections[s].size;
+    offset += page_round(writer->sections[s].size);
+  }
+
+  FILE *file = fopen(writer->filename, "wb");
+  bool ok = file != NULL && write_padded(file, &header, sizeof(header));
+  for (int s = 0; ok && s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    ok = write_padded(file, writer->sections[s].data, writer->sections[s].size);
+  }
+  if (file && fclose(file) != 0) ok = false;
+  if (!ok) {
+    warnx("Failed to write shard: %s", writer->filename);
+    writer->failed = true;
+    return;
+  }
+
+  writer->stats.shards++;
+  writer->stats.file_bytes += offset;
+  // Buffers are kept for the next shard unless memory is short
+  bool give_back = seq_memory_over_budget();
+  for (int s = 0; s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    shard_buffer_t *buffer = &writer->sections[s];
+    buffer->size = 0;
+    if (give_back) {
+      free(buffer->data);
+      seq_memory_release(buffer->capacity);
+      buffer->data = NULL;
+      buffer->capacity = 0;
+    }
+  }
+  writer->num_reads = writer->num_samples = writer->num_bases = writer->num_events = 0;
+}
+
+seq_shard_writer_t* seq_shard_writer_open(const char *directory, float sample_rate_khz, int kmer_size,
+                                          size_t shard_bytes) {
+  const uint16_t probe = 1;
+  if (*(const uint8_t *)&probe != 1) {
+    warnx("Shards are written in little-endian layout; this host is big-endian");
+    return NULL;
+  }
+  if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+    warnx("Cannot create shard directory: %s", directory);
+    return NULL;
+  }
+
+  seq_shard_writer_t *writer = calloc(1, sizeof(seq_shard_writer_t));
+  if (writer) writer->directory = strdup(directory);
+  if (!writer || !writer->directory) {
+    warnx("Memory allocation failed for shard writer");
+    free(writer);
+    return NULL;
+  }
+  writer->sample_rate_khz = sample_rate_khz;
+  writer->kmer_size = kmer_size > 0 ? (uint32_t)kmer_size : 1;
+  writer->shard_bytes = shard_bytes ? shard_bytes : SEQ_SHARD_DEFAULT_BYTES;
+  return writer;
+}
+
+// Per-read int16 quantisation over the read's own range (65535 steps from min to max)
+static void quantise_signal(const float *signal, size_t n, int16_t *out, float *scale, float *offset) {
+  float min_value = 0.0f, max_value = 0.0f;
+  if (n > 0) seq_kernel_minmax_f32(signal, n, &min_value, &max_value);
+  *scale = max_value > min_value ? (max_value - min_value) / 65535.0f : 1.0f;
+  *offset = min_value + 32768.0f * *scale;
+  float inverse = 1.0f / *scale;
+  for (size_t i = 0; i < n; i++) {
+    long q = lrintf((signal[i] - *offset) * inverse);
+    out[i] = (int16_t)(q < INT16_MIN ? INT16_MIN : q > INT16_MAX ? INT16_MAX : q);
+  }
+}
+
+int seq_shard_writer_append(seq_shard_writer_t *writer, const char *name, const float *signal, size_t num_samples,
+                            const seq_packed *bases, const uint32_t *event_samples, size_t num_events) {
+  if (writer->failed) return -1;
+  if (num_samples > UINT32_MAX || bases->length > UINT32_MAX || num_events > UINT32_MAX) {
+    warnx("Read %s is too long for a shard", name);
+    return -1;
+  }
+
+  size_t name_bytes = strlen(name) + 1;
+  size_t packed_bytes = (bases->length + 3) / 4;
+  size_t extra[SEQ_SHARD_NUM_SECTIONS] = {
+    [SEQ_SHARD_INDEX] = sizeof(seq_shard_read_t),
+    [SEQ_SHARD_SIGNAL] = num_samples * sizeof(int16_t),
+    [SEQ_SHARD_BASES] = packed_bytes,
+    [SEQ_SHARD_EVENTS] = num_events * sizeof(seq_shard_event_t),
+    [SEQ_SHARD_NAMES] = name_bytes
+  };
+  // A read that alone exceeds the limit still gets a shard of its own; over the
+  // --max-memory budget shards are written early (smaller) instead
+  if (writer->num_reads > 0 &&
+      (shard_file_bytes(writer, extra) > writer->shard_bytes || seq_memory_over_budget())) {
+    flush_shard(writer);
+    if (writer->failed) return -1;
+  }
+  if (writer->sections[SEQ_SHARD_NAMES].size + name_bytes > UINT32_MAX) {
+    warnx("Too many read names for one shard");
+    return -1;
+  }
+  // All or nothing: out of memory the read is skipped and the shard stays intact
+  for (int s = 0; s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    if (!buffer_reserve(&writer->sections[s], extra[s])) {
+      warnx("Memory allocation failed for shard section, skipping read %s", name);
+      return -1;
+    }
+  }
+
+  seq_shard_read_t *entry = buffer_extend(&writer->sections[SEQ_SHARD_INDEX], sizeof(seq_shard_read_t));
+  entry->signal_offset = writer->num_samples;
+  entry->bases_offset = writer->sections[SEQ_SHARD_BASES].size;
+  entry->events_offset = writer->num_events;
+  entry->num_samples = (uint32_t)num_samples;
+  entry->num_bases = (uint32_t)bases->length;
+  entry->num_events = (uint32_t)num_events;
+  entry->name_offset = (uint32_t)writer->sections[SEQ_SHARD_NAMES].size;
+
+  int16_t *samples = buffer_extend(&writer->sections[SEQ_SHARD_SIGNAL], num_samples * sizeof(int16_t));
+  quantise_signal(signal, num_samples, samples, &entry->scale, &entry->offset);
+
+  // Repack so every read starts on a byte boundary, forwards (bases may be a reverse view)
+  uint8_t *packed = buffer_extend(&writer->sections[SEQ_SHARD_BASES], packed_bytes);
+  memset(packed, 0, packed_bytes);
+  for (size_t i = 0; i < bases->length; i++) {
+    packed[i >> 2] |= (uint8_t)(seq_packed_base(bases, i) << (6 - 2 * (i & 3)));
+  }
+
+  seq_shard_event_t *events = buffer_extend(&writer->sections[SEQ_SHARD_EVENTS],
+                                            num_events * sizeof(seq_shard_event_t));
+  uint64_t start = 0;
+  for (size_t i = 0; i < num_events; i++) {
+    events[i].start = (uint32_t)start;
+    events[i].samples = event_samples[i];
+    start += event_samples[i];
+  }
+  if (start != num_samples) {
+    warnx("Events of read %s cover %llu samples, the signal has %zu", name, (unsigned long long)start, num_samples);
+  }
+
+  memcpy(buffer_extend(&writer->sections[SEQ_SHARD_NAMES], name_bytes), name, name_bytes);
+
+  writer->num_reads++;
+  writer->num_samples += num_samples;
+  writer->num_bases += bases->length;
+  writer->num_events += num_events;
+  writer->stats.reads++;
+  writer->stats.signal_bytes += num_samples * sizeof(int16_t);
+  return 0;
+}
+
+int seq_shard_writer_close(seq_shard_writer_t *writer, seq_shard_stats_t *stats) {
+  if (!writer) return -1;
+  flush_shard(writer);
+  int status = writer->failed ? -1 : 0;
+  if (stats) *stats = writer->stats;
+
+  for (int s = 0; s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    free(writer->sections[s].data);
+    seq_memory_release(writer->sections[s].capacity);
+  }
+  free(writer->filename);
+  free(writer->directory);
+  free(writer);
+  return status;
+}
+
+// **********************************************************************
+// Reader
+// **********************************************************************
+
+struct seq_shard {
+  uint8_t *map;
+  size_t size;
+  const seq_shard_header_t *header;
+  const seq_shard_read_t *index;
+};
+
+seq_shard_t* seq_shard_map(const char *filename) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    warnx("Cannot open shard: %s", filename);
+    return NULL;
+  }
+  struct stat st;
+  void *map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= SEQ_SHARD_PAGE) {
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    warnx("Cannot map shard: %s", filename);
+    return NULL;
+  }
+
+  size_t size = (size_t)st.st_size;
+  const seq_shard_header_t *header = map;
+  bool valid = memcmp(header->magic, SEQ_SHARD_MAGIC, sizeof(header->magic)) == 0 &&
+               header->version == SEQ_SHARD_VERSION && header->page_size == SEQ_SHARD_PAGE;
+  for (int s = 0; valid && s < SEQ_SHARD_NUM_SECTIONS; s++) {
+    const seq_shard_section_t *section = &header->sections[s];
+    valid = section->offset % SEQ_SHARD_PAGE == 0 && section->offset <= size &&
+            section->bytes <= size - section->offset;
+  }
+  valid = valid && header->sections[SEQ_SHARD_INDEX].bytes == header->num_reads * sizeof(seq_shard_read_t) &&
+          header->sections[SEQ_SHARD_SIGNAL].bytes == header->num_samples * sizeof(int16_t) &&
+          header->sections[SEQ_SHARD_EVENTS].bytes == header->num_events * sizeof(seq_shard_event_t);
+  if (!valid) {
+    warnx("Not a version %d shard: %s", SEQ_SHARD_VERSION, filename);
+    munmap(map, size);
+    return NULL;
+  }
+
+  seq_shard_t *shard = calloc(1, sizeof(seq_shard_t));
+  if (!shard) {
+    warnx("Memory allocation failed for shard: %s", filename);
+    munmap(map, size);
+    return NULL;
+  }
+  shard->map = map;
+  shard->size = size;
+  shard->header = header;
+  shard->index = (const seq_shard_read_t *)(shard->map + header->sections[SEQ_SHARD_INDEX].offset);
+  return shard;
+}
+
+void seq_shard_unmap(seq_shard_t *shard) {
+  if (!shard) return;
+  munmap(shard->map, shard->size);
+  free(shard);
+}
+
+const seq_shard_header_t* seq_shard_header(const seq_shard_t *shard) {
+  return shard->header;
+}
+
+void seq_shard_read(const seq_shard_t *shard, size_t r, seq_shard_read_view_t *read) {
+  const seq_shard_section_t *sections = shard->header->sections;
+  const seq_shard_read_t *entry = &shard->index[r];
+  read->name = (const char *)(shard->map + sections[SEQ_SHARD_NAMES].offset + entry->name_offset);
+  read->signal = (const int16_t *)(shard->map + sections[SEQ_SHARD_SIGNAL].offset) + entry->signal_offset;
+  read->num_samples = entry->num_samples;
+  read->scale = entry->scale;
+  read->offset = entry->offset;
+  read->bases = (seq_packed){shard->map + sections[SEQ_SHARD_BASES].offset + entry->bases_offset,
+                             entry->num_bases, 0, false};
+  read->events = (const seq_shard_event_t *)(shard->map + sections[SEQ_SHARD_EVENTS].offset) +
+                 entry->events_offset;
+  read->num_events = entry->num_events;
+}
@@ -0,0 +1,141 @@
+// **********************************************************************
+// core/seq_shard.h - Memory-Mappable Training Shards
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+//
+// Simulated reads packaged for basecaller training: signal, bases and the
+// sample-to-base alignment of every read, in files a data loader can mmap
+// and index directly (no parsing, no per-read seeks). Reads are appended as
+// they are simulated; a shard is written once adding the next read would
+// take it past the size limit, so memory is one shard whatever the run size
+// (less under a --max-memory budget, which writes shards early once reached).
+// Shards are DIR/shard_00000.sqs, DIR/shard_00001.sqs, ...
+//
+// Layout (host byte order, little-endian hosts only; every section starts on
+// a SEQ_SHARD_PAGE boundary and is zero-padded to one, so file sizes are
+// whole pages):
+//
+//   page 0     seq_shard_header_t (zero-padded)
+//   INDEX      seq_shard_read_t[num_reads]
+//   SIGNAL     int16 samples, reads back to back; pA = scale * q + offset (per read)
+//   BASES      2-bit bases as seq_packed (A,C,G,T -> 0..3, first base in the
+//              high bits), each read starting on a byte boundary
+//   EVENTS     seq_shard_event_t per event: event i of a read covers bases
+//              [i, i + kmer_size) and samples [start, start + samples)
+//   NAMES      NUL-terminated read names
+//
+// Offsets in seq_shard_read_t are in elements of their section (samples,
+// bytes, events, bytes), so read r's signal is
+//   (const int16_t *)(map + header->sections[SEQ_SHARD_SIGNAL].offset) + index[r].signal_offset
+#ifndef SEQUELIZER_SEQ_SHARD_H
+#define SEQUELIZER_SEQ_SHARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "seq_packed.h"
+
+#define SEQ_SHARD_MAGIC "SQSHARD1"
+#define SEQ_SHARD_VERSION 1
+#define SEQ_SHARD_PAGE 4096
+#define SEQ_SHARD_EXTENSION ".sqs"
+#define SEQ_SHARD_DEFAULT_BYTES ((size_t)64 << 20)
+
+typedef enum {
+  SEQ_SHARD_INDEX = 0,
+  SEQ_SHARD_SIGNAL,
+  SEQ_SHARD_BASES,
+  SEQ_SHARD_EVENTS,
+  SEQ_SHARD_NAMES,
+  SEQ_SHARD_NUM_SECTIONS
+} seq_shard_section_id;
+
+typedef struct {
+  uint64_t offset;            // From the start of the file (a multiple of SEQ_SHARD_PAGE)
+  uint64_t bytes;             // Used bytes, before the padding
+} seq_shard_section_t;
+
+typedef struct {
+  char magic[8];              // SEQ_SHARD_MAGIC
+  uint32_t version;
+  uint32_t page_size;
+  uint64_t num_reads;
+  uint64_t num_samples;
+  uint64_t num_bases;
+  uint64_t num_events;
+  float sample_rate_khz;
+  uint32_t kmer_size;         // Bases per event (1 for neural models)
+  seq_shard_section_t sections[SEQ_SHARD_NUM_SECTIONS];
+} seq_shard_header_t;
+
+typedef struct {
+  uint64_t signal_offset;     // First sample
+  uint64_t bases_offset;      // First byte of the packed bases
+  uint64_t events_offset;     // First event
+  uint32_t num_samples;
+  uint32_t num_bases;
+  uint32_t num_events;
+  uint32_t name_offset;       // First byte of the name
+  float scale;                // pA = scale * q + offset
+  float offset;
+} seq_shard_read_t;
+
+// One event's run of samples (start relative to the read's first sample);
+// starts are the move table, samples the dwell table
+typedef struct {
+  uint32_t start;
+  uint32_t samples;
+} seq_shard_event_t;
+
+// **********************************************************************
+// Writer
+// **********************************************************************
+
+typedef struct seq_shard_writer seq_shard_writer_t;
+
+typedef struct {
+  size_t reads;
+  size_t shards;
+  size_t file_bytes;
+  size_t signal_bytes;        // int16 samples stored
+} seq_shard_stats_t;
+
+// Creates directory if needed; shard_bytes 0 = SEQ_SHARD_DEFAULT_BYTES. NULL (with a warning) on failure
+seq_shard_writer_t* seq_shard_writer_open(const char *directory, float sample_rate_khz, int kmer_size,
+                                          size_t shard_bytes);
+
+// Append one read: signal[num_samples] in pA, its bases, and the samples of each of its
+// num_events events (summing to num_samples). 0 on success, -1 on a write error
+int seq_shard_writer_append(seq_shard_writer_t *writer, const char *name, const float *signal, size_t num_samples,
+                            const seq_packed *bases, const uint32_t *event_samples, size_t num_events);
+
+// Write the last shard, close and free; stats (may be NULL) receives the run totals
+int seq_shard_writer_close(seq_shard_writer_t *writer, seq_shard_stats_t *stats);
+
+// **********************************************************************
+// Reader
+// **********************************************************************
+
+typedef struct seq_shard seq_shard_t;
+
+// mmap a shard read-only after checking its header and section bounds; NULL (with a warning) otherwise
+seq_shard_t* seq_shard_map(const char *filename);
+void         seq_shard_unmap(seq_shard_t *shard);
+
+const seq_shard_header_t* seq_shard_header(const seq_shard_t *shard);
+
+// Read r of the shard (r < num_reads); pointers are into the mapping
+typedef struct {
+  const char *name;
+  const int16_t *signal;
+  size_t num_samples;
+  float scale;
+  float offset;
+  seq_packed bases;           // View of the mapped bases (never seq_packed_free it)
+  const seq_shard_event_t *events;
+  size_t num_events;
+} seq_shard_read_view_t;
+
+void seq_shard_read(const seq_shard_t *shard, size_t r, seq_shard_read_view_t *read);
+
+#endif // SEQUELIZER_SEQ_SHARD_H
@@ -0,0 +1,239 @@
+// **********************************************************************
+// core/seq_stream.c - Chunked Signal Streams for Real-Time Consumers
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "seq_stream.h"
+#include <err.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SEQ_STREAM_BIG_ENDIAN 1
+#endif
+
+#define SEQ_STREAM_HEADER_SIZE 32
+
+// The ring holds whole records: one producer reserves space past head and
+// copies into it unlocked, the writer thread drains [tail, head)
+struct seq_stream {
+  int fd;
+  uint8_t *ring;
+  size_t capacity;
+  uint64_t head;           // Bytes queued (monotonic)
+  uint64_t tail;           // Bytes written to fd (monotonic)
+  bool drop_when_full;
+  bool closing;
+  bool failed;             // A write to fd failed; later chunks are discarded
+
+  seq_stream_stats_t stats;
+
+  pthread_t writer;
+  pthread_mutex_t lock;
+  pthread_cond_t data_ready;
+  pthread_cond_t space_free;
+};
+
+static double now_seconds(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Write all of buffer, retrying partial writes and interrupts
+static bool write_full(int fd, const uint8_t *buffer, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(fd, buffer, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    buffer += n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+static void* stream_writer(void *arg) {
+  seq_stream_t *stream = (seq_stream_t*)arg;
+
+  pthread_mutex_lock(&stream->lock);
+  for (;;) {
+    while (stream->head == stream->tail && !stream->closing) {
+      pthread_cond_wait(&stream->data_ready, &stream->lock);
+    }
+    if (stream->head == stream->tail) break;
+
+    // Largest contiguous run from tail (the ring may wrap)
+    size_t start = (size_t)(stream->tail % stream->capacity);
+    size_t length = (size_t)(stream->head - stream->tail);
+    if (length > stream->capacity - start) length = stream->capacity - start;
+    bool failed = stream->failed;
+    pthread_mutex_unlock(&stream->lock);
+
+    bool ok = failed || write_full(stream->fd, stream->ring + start, length);
+
+    pthread_mutex_lock(&stream->lock);
+    if (!ok && !stream->failed) {
+      warnx("Signal stream write failed: %s", strerror(errno));
+      stream->failed = true;
+    }
+    stream->tail += length;
+    pthread_cond_signal(&stream->space_free);
+  }
+  pthread_mutex_unlock(&stream->lock);
+  return NULL;
+}
+
+seq_stream_t* seq_stream_open(int fd, size_t buffer_bytes, bool drop_when_full) {
+  seq_stream_t *stream = calloc(1, sizeof(seq_stream_t));
+  if (!stream) return NULL;
+  stream->fd = fd;
+  stream->capacity = buffer_bytes;
+  stream->drop_when_full = drop_when_full;
+  stream->ring = malloc(buffer_bytes);
+  if (!stream->ring) {
+    free(stream);
+    return NULL;
+  }
+
+  pthread_mutex_init(&stream->lock, NULL);
+  pthread_cond_init(&stream->data_ready, NULL);
+  pthread_cond_init(&stream->space_free, NULL);
+  if (pthread_create(&stream->writer, NULL, stream_writer, stream) != 0) {
+    warnx("Failed to create stream writer thread");
+    pthread_cond_destroy(&stream->space_free);
+    pthread_cond_destroy(&stream->data_ready);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream->ring);
+    free(stream);
+    return NULL;
+  }
+  return stream;
+}
+
+int seq_stream_connect_unix(const char *path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    warnx("UNIX socket path too long: %s", path);
+    return -1;
+  }
+  strcpy(address.sun_path, path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+    warnx("Cannot connect to UNIX socket %s: %s", path, strerror(errno));
+    if (fd >= 0) close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// **********************************************************************
+// Chunk Records
+// **********************************************************************
+
+// Copy into the ring at byte position (wrapping at the end)
+static void ring_copy(seq_stream_t *stream, uint64_t position, const void *data, size_t size) {
+  if (size == 0) return;
+  size_t start = (size_t)(position % stream->capacity);
+  size_t first = stream->capacity - start < size ? stream->capacity - start : size;
+  memcpy(stream->ring + start, data, first);
+  memcpy(stream->ring, (const uint8_t*)data + first, size - first);
+}
+
+static void put_le16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put_le32(uint8_t *p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static void put_le64(uint8_t *p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+
+int seq_stream_send(seq_stream_t *stream, uint16_t channel, uint32_t read_number, uint16_t flags,
+                    uint64_t start_sample, const char *name, const float *samples, uint32_t num_samples) {
+  uint32_t name_length = (name && (flags & SEQ_STREAM_READ_START)) ? (uint32_t)strlen(name) : 0;
+  size_t record_size = SEQ_STREAM_HEADER_SIZE + name_length + (size_t)num_samples * sizeof(float);
+  if (record_size > stream->capacity) {
+    warnx("Signal chunk of %zu bytes does not fit the %zu-byte stream buffer", record_size, stream->capacity);
+    return -1;
+  }
+
+  // Reserve space (or give up on this chunk in drop mode)
+  pthread_mutex_lock(&stream->lock);
+  if (stream->failed) {
+    pthread_mutex_unlock(&stream->lock);
+    return -1;
+  }
+  if (stream->capacity - (size_t)(stream->head - stream->tail) < record_size) {
+    if (stream->drop_when_full) {
+      stream->stats.chunks_dropped++;
+      pthread_mutex_unlock(&stream->lock);
+      return 1;
+    }
+    double wait_start = now_seconds();
+    while (stream->capacity - (size_t)(stream->head - stream->tail) < record_size) {
+      pthread_cond_wait(&stream->space_free, &stream->lock);
+    }
+    stream->stats.blocked_seconds += now_seconds() - wait_start;
+  }
+  uint64_t position = stream->head;
+  pthread_mutex_unlock(&stream->lock);
+
+  // Only this thread writes past head, so the copy needs no lock
+  uint8_t header[SEQ_STREAM_HEADER_SIZE] = {0};
+  memcpy(header, SEQ_STREAM_MAGIC, 4);
+  put_le16(header + 4, channel);
+  put_le16(header + 6, flags);
+  put_le32(header + 8, read_number);
+  put_le32(header + 12, num_samples);
+  put_le64(header + 16, start_sample);
+  put_le32(header + 24, name_length);
+  ring_copy(stream, position, header, sizeof(header));
+  position += sizeof(header);
+  ring_copy(stream, position, name, name_length);
+  position += name_length;
+#ifdef SEQ_STREAM_BIG_ENDIAN
+  for (uint32_t i = 0; i < num_samples; i++) {
+    uint32_t bits;
+    memcpy(&bits, &samples[i], sizeof(bits));
+    bits = __builtin_bswap32(bits);
+    ring_copy(stream, position, &bits, sizeof(bits));
+    position += sizeof(bits);
+  }
+#else
+  ring_copy(stream, position, samples, (size_t)num_samples * sizeof(float));
+#endif
+
+  pthread_mutex_lock(&stream->lock);
+  stream->head += record_size;
+  stream->stats.chunks_sent++;
+  stream->stats.bytes_sent += record_size;
+  pthread_cond_signal(&stream->data_ready);
+  pthread_mutex_unlock(&stream->lock);
+  return 0;
+}
+
+int seq_stream_close(seq_stream_t *stream, seq_stream_stats_t *stats) {
+  if (!stream) return -1;
+
+  pthread_mutex_lock(&stream->lock);
+  stream->closing = true;
+  pthread_cond_signal(&stream->data_ready);
+  pthread_mutex_unlock(&stream->lock);
+  pthread_join(stream->writer, NULL);
+
+  int status = stream->failed ? -1 : 0;
+  if (stats) *stats = stream->stats;
+
+  pthread_cond_destroy(&stream->space_free);
+  pthread_cond_destroy(&stream->data_ready);
+  pthread_mutex_destroy(&stream->lock);
+  free(stream->ring);
+  free(stream);
+  return status;
+}
@@ -0,0 +1,64 @@
+// **********************************************************************
+// core/seq_stream.h - Chunked Signal Streams for Real-Time Consumers
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Carries fixed-size signal chunks from many channels to one file
+// descriptor (pipe, FIFO, file or connected UNIX socket). The producer
+// serialises chunks into a bounded in-memory ring and a writer thread
+// drains it, so a slow reader either holds the producer back
+// (backpressure) or, in drop mode, costs chunks that are counted.
+//
+// Wire format, little-endian, one record per chunk:
+//   seq_stream_chunk_header   32 bytes (below)
+//   read name                 name_length bytes, first chunk of a read only
+//   samples                   num_samples float32 (pA)
+#ifndef SEQUELIZER_SEQ_STREAM_H
+#define SEQUELIZER_SEQ_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SEQ_STREAM_MAGIC "SQCK"
+
+// Chunk flags
+#define SEQ_STREAM_READ_START 0x1  // First chunk of a read (carries its name)
+#define SEQ_STREAM_READ_END   0x2  // Last chunk of a read
+
+typedef struct {
+  char magic[4];           // SEQ_STREAM_MAGIC
+  uint16_t channel;        // 1-based, as channel_number in Fast5 channel_id
+  uint16_t flags;
+  uint32_t read_number;    // Per-channel read counter, as read_number in Fast5
+  uint32_t num_samples;
+  uint64_t start_sample;   // Offset of the first sample within the read
+  uint32_t name_length;
+  uint32_t reserved;
+} seq_stream_chunk_header;
+
+typedef struct {
+  uint64_t chunks_sent;
+  uint64_t chunks_dropped;   // Drop mode: chunks discarded because the ring was full
+  uint64_t bytes_sent;
+  double blocked_seconds;    // Backpressure mode: time the producer waited for ring space
+} seq_stream_stats_t;
+
+typedef struct seq_stream seq_stream_t;
+
+// Stream to fd (not closed by the stream) through a ring of buffer_bytes;
+// drop_when_full discards chunks instead of waiting. NULL on failure
+seq_stream_t* seq_stream_open(int fd, size_t buffer_bytes, bool drop_when_full);
+
+// Connected SOCK_STREAM socket to the UNIX socket at path, -1 with a warning on failure
+int seq_stream_connect_unix(const char *path);
+
+// Queue one chunk: 0 queued, 1 dropped (drop mode), -1 if the destination failed
+int seq_stream_send(seq_stream_t *stream, uint16_t channel, uint32_t read_number, uint16_t flags,
+                    uint64_t start_sample, const char *name, const float *samples, uint32_t num_samples);
+
+// Drain everything queued, stop the writer and free the stream; 0 or -1 if
+// any write failed. stats may be NULL
+int seq_stream_close(seq_stream_t *stream, seq_stream_stats_t *stats);
+
+#endif // SEQUELIZER_SEQ_STREAM_H
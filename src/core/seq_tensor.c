@@ -4,10 +4,13 @@
 // Sebastian Claudiusz Magierowski Nov 10 2025
 
 #include "seq_tensor.h"
+#include "seq_kernels.h"
+#include "seq_memory.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
+#include <pthread.h>
 
 // **********************************************************************
 // Internal Helper Functions
@@ -44,112 +47,146 @@ static size_t calculate_total_size(size_t ndim, const size_t *shape) {
 }
 
 /**
- * Allocate aligned memory for tensor data
+ * Allocate aligned memory for tensor data (SEQ_TENSOR_ALIGNMENT bytes)
+ * zero_fill = false leaves the contents indeterminate (caller overwrites them)
+ * Counted against the --max-memory budget until release_data
  * Returns NULL on failure
  */
-static void* allocate_aligned_data(size_t num_elements, size_t element_size) {
-  size_t total_bytes = num_elements * element_size;
+static void* allocate_aligned_data(size_t total_bytes, bool zero_fill) {
   if (total_bytes == 0) return NULL;
 
   void *ptr = NULL;
 
 #ifdef _POSIX_C_SOURCE
-  // Try 16-byte aligned allocation for SIMD
-  if (posix_memalign(&ptr, 16, total_bytes) != 0) {
+  // Cache-line (64-byte) alignment covers SSE/NEON, AVX2 and AVX-512 loads
+  if (posix_memalign(&ptr, SEQ_TENSOR_ALIGNMENT, total_bytes) != 0) {
     return NULL;
   }
-  // Zero-initialize the memory
-  memset(ptr, 0, total_bytes);
 #else
-  // Fallback to calloc (zero-initialized)
-  ptr = calloc(num_elements, element_size);
+  // C11 aligned_alloc needs a size that is a multiple of the alignment
+  size_t rounded = (total_bytes + SEQ_TENSOR_ALIGNMENT - 1) / SEQ_TENSOR_ALIGNMENT * SEQ_TENSOR_ALIGNMENT;
+  ptr = aligned_alloc(SEQ_TENSOR_ALIGNMENT, rounded);
+  if (ptr == NULL) {
+    return NULL;
+  }
 #endif
+  // Zero-initialize the memory
+  if (zero_fill) memset(ptr, 0, total_bytes);
 
+  seq_memory_reserve(total_bytes);
   return ptr;
 }
 
-// **********************************************************************
-// Core Creation Functions
-// **********************************************************************
+/**
+ * Free data from allocate_aligned_data (total_bytes as allocated)
+ */
+static void release_data(void *data, size_t total_bytes) {
+  if (data == NULL) return;
+  free(data);
+  seq_memory_release(total_bytes);
+}
 
 /**
- * Create a float32 tensor with specified shape
+ * Element size for a dtype
  */
-seq_tensor* seq_tensor_create_float(size_t ndim, const size_t *shape) {
-  if (ndim == 0 || shape == NULL) {
-    return NULL;
-  }
+static size_t dtype_element_size(seq_tensor_dtype dtype) {
+  switch (dtype) {
+    case SEQ_TENSOR_INT8:  return sizeof(int8_t);
+    case SEQ_TENSOR_INT16: return sizeof(int16_t);
+    case SEQ_TENSOR_INT32: return sizeof(int32_t);
+    case SEQ_TENSOR_FLT32: return sizeof(float);
+  }
+  return 0;
+}
 
-  // Validate shape (all dimensions must be > 0)
+/**
+ * Validate a shape (ndim > 0, all dimensions > 0)
+ */
+static bool valid_shape(size_t ndim, const size_t *shape) {
+  if (ndim == 0 || shape == NULL) return false;
   for (size_t i = 0; i < ndim; i++) {
-    if (shape[i] == 0) {
-      return NULL;
-    }
+    if (shape[i] == 0) return false;
   }
+  return true;
+}
 
-  // Allocate tensor structure
-  seq_tensor *t = (seq_tensor*)calloc(1, sizeof(seq_tensor));
-  if (t == NULL) {
-    return NULL;
+/**
+ * Point shape/stride at inline storage (or malloc them for large ndim),
+ * copy shape and compute C-order strides and total size
+ */
+static bool set_tensor_dims(seq_tensor *t, size_t ndim, const size_t *shape) {
+  if (ndim <= SEQ_TENSOR_INLINE_DIMS) {
+    t->shape = t->shape_inline;
+    t->stride = t->stride_inline;
+  } else {
+    t->shape = (size_t*)malloc(ndim * sizeof(size_t));
+    t->stride = (size_t*)malloc(ndim * sizeof(size_t));
+    if (t->shape == NULL || t->stride == NULL) {
+      free(t->shape);
+      free(t->stride);
+      t->shape = t->stride = NULL;
+      return false;
+    }
   }
 
-  // Set basic properties
   t->ndim = ndim;
-  t->dtype = SEQ_TENSOR_FLT32;
-  t->ext_dtype = SEQ_TENSOR_EXT_NONE;  // Standard tensor
-  t->element_size = sizeof(float);
-  t->scale = 1.0f;
-  t->zero_point = 0;
-
-  // Allocate and copy shape array
-  t->shape = (size_t*)malloc(ndim * sizeof(size_t));
-  if (t->shape == NULL) {
-    free(t);
-    return NULL;
-  }
   memcpy(t->shape, shape, ndim * sizeof(size_t));
-
-  // Allocate and calculate stride array
-  t->stride = (size_t*)malloc(ndim * sizeof(size_t));
-  if (t->stride == NULL) {
-    free(t->shape);
-    free(t);
-    return NULL;
-  }
   calculate_c_strides(ndim, shape, t->stride);
-
-  // Calculate total size
   t->size = calculate_total_size(ndim, shape);
+  return true;
+}
 
-  // Allocate data array (16-byte aligned for SIMD)
-  t->data = allocate_aligned_data(t->size, t->element_size);
-  if (t->data == NULL) {
-    free(t->stride);
-    free(t->shape);
-    free(t);
-    return NULL;
-  }
+/**
+ * Release shape/stride arrays that are not inline
+ */
+static void release_tensor_dims(seq_tensor *t) {
+  if (t->shape != t->shape_inline) free(t->shape);
+  if (t->stride != t->stride_inline) free(t->stride);
+  t->shape = t->stride = NULL;
+}
 
-  // Set flags
-  t->flags = SEQ_TENSOR_OWNS_DATA | SEQ_TENSOR_ALIGNED_16;
+/**
+ * Free the tensor struct, its dims and (if owned) its data
+ */
+static void destroy_tensor(seq_tensor *t) {
+  release_tensor_dims(t);
+  if (t->data != NULL && (t->flags & SEQ_TENSOR_OWNS_DATA)) {
+    release_data(t->data, t->capacity);
+  }
+  free(t);
+}
 
-  return t;
+/**
+ * Alignment flags for a data pointer
+ */
+static uint32_t alignment_flags(const void *data) {
+  uintptr_t address = (uintptr_t)data;
+  uint32_t flags = 0;
+  if (address % 16 == 0) flags |= SEQ_TENSOR_ALIGNED_16;
+  if (address % 32 == 0) flags |= SEQ_TENSOR_ALIGNED_32;
+  if (address % 64 == 0) flags |= SEQ_TENSOR_ALIGNED_64;
+  return flags;
 }
 
 /**
- * Create an int8 quantized tensor
+ * Number of elements between the first and last addressable element + 1
+ * (equals size for dense layouts, larger when rows are padded)
  */
-seq_tensor* seq_tensor_create_int8(size_t ndim, const size_t *shape,
-                   float scale, int32_t zero_point) {
-  if (ndim == 0 || shape == NULL) {
-    return NULL;
+static size_t tensor_span(const seq_tensor *t) {
+  size_t span = 1;
+  for (size_t i = 0; i < t->ndim; i++) {
+    span += (t->shape[i] - 1) * t->stride[i];
   }
+  return span;
+}
 
-  // Validate shape
-  for (size_t i = 0; i < ndim; i++) {
-    if (shape[i] == 0) {
-      return NULL;
-    }
+/**
+ * Common constructor: struct, dims (inline) and 16-byte aligned data
+ */
+static seq_tensor* create_tensor(size_t ndim, const size_t *shape, seq_tensor_dtype dtype,
+                                 float scale, int32_t zero_point, bool zero_fill) {
+  if (!valid_shape(ndim, shape)) {
+    return NULL;
   }
 
   // Allocate tensor structure
@@ -159,46 +196,82 @@ seq_tensor* seq_tensor_create_int8(size_t ndim, const size_t *shape,
   }
 
   // Set basic properties
-  t->ndim = ndim;
-  t->dtype = SEQ_TENSOR_INT8;
+  t->dtype = dtype;
   t->ext_dtype = SEQ_TENSOR_EXT_NONE;  // Standard tensor
-  t->element_size = sizeof(int8_t);
+  t->element_size = dtype_element_size(dtype);
   t->scale = scale;
   t->zero_point = zero_point;
 
-  // Allocate and copy shape array
-  t->shape = (size_t*)malloc(ndim * sizeof(size_t));
-  if (t->shape == NULL) {
+  // Shape, strides, total size
+  if (!set_tensor_dims(t, ndim, shape)) {
     free(t);
     return NULL;
   }
-  memcpy(t->shape, shape, ndim * sizeof(size_t));
 
-  // Allocate and calculate stride array
-  t->stride = (size_t*)malloc(ndim * sizeof(size_t));
-  if (t->stride == NULL) {
-    free(t->shape);
+  // Allocate data array (aligned for SIMD)
+  t->capacity = t->size * t->element_size;
+  t->data = allocate_aligned_data(t->capacity, zero_fill);
+  if (t->data == NULL) {
+    release_tensor_dims(t);
     free(t);
     return NULL;
   }
-  calculate_c_strides(ndim, shape, t->stride);
 
-  // Calculate total size
-  t->size = calculate_total_size(ndim, shape);
+  // Set flags
+  t->flags = SEQ_TENSOR_OWNS_DATA | alignment_flags(t->data);
 
-  // Allocate data array
-  t->data = allocate_aligned_data(t->size, t->element_size);
-  if (t->data == NULL) {
-    free(t->stride);
-    free(t->shape);
+  return t;
+}
+
+/**
+ * Struct and dims only (no data) for views
+ */
+static seq_tensor* create_tensor_header(size_t ndim, const size_t *shape, seq_tensor_dtype dtype) {
+  if (!valid_shape(ndim, shape)) {
+    return NULL;
+  }
+
+  seq_tensor *t = (seq_tensor*)calloc(1, sizeof(seq_tensor));
+  if (t == NULL) {
+    return NULL;
+  }
+  t->dtype = dtype;
+  t->ext_dtype = SEQ_TENSOR_EXT_NONE;
+  t->element_size = dtype_element_size(dtype);
+  t->scale = 1.0f;
+  t->zero_point = 0;
+  if (!set_tensor_dims(t, ndim, shape)) {
     free(t);
     return NULL;
   }
+  return t;
+}
 
-  // Set flags
-  t->flags = SEQ_TENSOR_OWNS_DATA | SEQ_TENSOR_ALIGNED_16;
+// **********************************************************************
+// Core Creation Functions
+// **********************************************************************
 
-  return t;
+/**
+ * Create a float32 tensor with specified shape
+ */
+seq_tensor* seq_tensor_create_float(size_t ndim, const size_t *shape) {
+  return create_tensor(ndim, shape, SEQ_TENSOR_FLT32, 1.0f, 0, true);
+}
+
+/**
+ * Create an int8 quantized tensor
+ */
+seq_tensor* seq_tensor_create_int8(size_t ndim, const size_t *shape,
+                   float scale, int32_t zero_point) {
+  return create_tensor(ndim, shape, SEQ_TENSOR_INT8, scale, zero_point, true);
+}
+
+/**
+ * Create an int16 tensor (native Fast5 ADC samples)
+ */
+seq_tensor* seq_tensor_create_int16(size_t ndim, const size_t *shape,
+                    float scale, int32_t zero_point) {
+  return create_tensor(ndim, shape, SEQ_TENSOR_INT16, scale, zero_point, true);
 }
 
 /**
@@ -206,66 +279,71 @@ seq_tensor* seq_tensor_create_int8(size_t ndim, const size_t *shape,
  */
 seq_tensor* seq_tensor_create_int32(size_t ndim, const size_t *shape,
                   float scale, int32_t zero_point) {
-  if (ndim == 0 || shape == NULL) {
-    return NULL;
-  }
+  return create_tensor(ndim, shape, SEQ_TENSOR_INT32, scale, zero_point, true);
+}
 
-  // Validate shape
-  for (size_t i = 0; i < ndim; i++) {
-    if (shape[i] == 0) {
-      return NULL;
-    }
+/**
+ * Create float32 / int16 tensors without zero-fill
+ */
+seq_tensor* seq_tensor_create_float_uninit(size_t ndim, const size_t *shape) {
+  return create_tensor(ndim, shape, SEQ_TENSOR_FLT32, 1.0f, 0, false);
+}
+
+seq_tensor* seq_tensor_create_int16_uninit(size_t ndim, const size_t *shape,
+                                           float scale, int32_t zero_point) {
+  return create_tensor(ndim, shape, SEQ_TENSOR_INT16, scale, zero_point, false);
+}
+
+/**
+ * Create a zero-filled tensor with aligned, padded rows
+ */
+seq_tensor* seq_tensor_create_padded(seq_tensor_dtype dtype, size_t ndim, const size_t *shape,
+                                     size_t alignment, float scale, int32_t zero_point) {
+  if (alignment != 16 && alignment != 32 && alignment != 64) {
+    return NULL;
   }
 
-  // Allocate tensor structure
-  seq_tensor *t = (seq_tensor*)calloc(1, sizeof(seq_tensor));
+  seq_tensor *t = create_tensor_header(ndim, shape, dtype);
   if (t == NULL) {
     return NULL;
   }
-
-  // Set basic properties
-  t->ndim = ndim;
-  t->dtype = SEQ_TENSOR_INT32;
-  t->ext_dtype = SEQ_TENSOR_EXT_NONE;  // Standard tensor
-  t->element_size = sizeof(int32_t);
   t->scale = scale;
   t->zero_point = zero_point;
 
-  // Allocate and copy shape array
-  t->shape = (size_t*)malloc(ndim * sizeof(size_t));
-  if (t->shape == NULL) {
-    free(t);
-    return NULL;
+  // Row pitch rounded up to whole alignment units, outer strides follow from it
+  size_t per_unit = alignment / t->element_size;
+  size_t pitch = (shape[ndim - 1] + per_unit - 1) / per_unit * per_unit;
+  if (ndim > 1) {
+    t->stride[ndim - 2] = pitch;
+    for (int i = (int)ndim - 3; i >= 0; i--) {
+      t->stride[i] = t->stride[i + 1] * shape[i + 1];
+    }
   }
-  memcpy(t->shape, shape, ndim * sizeof(size_t));
-
-  // Allocate and calculate stride array
-  t->stride = (size_t*)malloc(ndim * sizeof(size_t));
-  if (t->stride == NULL) {
-    free(t->shape);
-    free(t);
-    return NULL;
+  if (pitch != shape[ndim - 1]) {
+    t->ext_dtype = SEQ_TENSOR_EXT_PADDED;
   }
-  calculate_c_strides(ndim, shape, t->stride);
-
-  // Calculate total size
-  t->size = calculate_total_size(ndim, shape);
 
-  // Allocate data array
-  t->data = allocate_aligned_data(t->size, t->element_size);
+  // Allocate whole rows so vector loops may run over the padding
+  size_t rows = t->size / shape[ndim - 1];
+  t->capacity = rows * pitch * t->element_size;
+  t->data = allocate_aligned_data(t->capacity, true);
   if (t->data == NULL) {
-    free(t->stride);
-    free(t->shape);
+    release_tensor_dims(t);
     free(t);
     return NULL;
   }
-
-  // Set flags
-  t->flags = SEQ_TENSOR_OWNS_DATA | SEQ_TENSOR_ALIGNED_16;
-
+  t->flags = SEQ_TENSOR_OWNS_DATA | alignment_flags(t->data);
   return t;
 }
 
+/**
+ * True if elements are densely packed
+ */
+bool seq_tensor_is_dense(const seq_tensor *t) {
+  assert(t != NULL);
+  return tensor_span(t) == t->size;
+}
+
 /**
  * Convenience: Create 2D float matrix with column-major layout
  *
@@ -315,6 +393,8 @@ seq_tensor* seq_tensor_create_2d_float_rm(size_t rows, size_t cols) {
   return t;
 }
 
+static void pool_return(seq_tensor_pool *pool, seq_tensor *t);
+
 /**
  * Free tensor and all associated memory
  */
@@ -323,23 +403,185 @@ void seq_tensor_free(seq_tensor *tensor) {
     return;
   }
 
-  // Free shape array
-  if (tensor->shape != NULL) {
-    free(tensor->shape);
+  // Pooled tensors are recycled rather than freed
+  if (tensor->pool != NULL) {
+    pool_return(tensor->pool, tensor);
+    return;
   }
 
-  // Free stride array
-  if (tensor->stride != NULL) {
-    free(tensor->stride);
+  destroy_tensor(tensor);
+}
+
+// **********************************************************************
+// View Functions
+// **********************************************************************
+
+/**
+ * Wrap external data without copying
+ */
+seq_tensor* seq_tensor_wrap(void *data, seq_tensor_dtype dtype, size_t ndim, const size_t *shape) {
+  if (data == NULL) {
+    return NULL;
+  }
+
+  seq_tensor *t = create_tensor_header(ndim, shape, dtype);
+  if (t == NULL) {
+    return NULL;
+  }
+  t->data = data;
+  t->flags = alignment_flags(data);   // No SEQ_TENSOR_OWNS_DATA
+  return t;
+}
+
+/**
+ * View a row range of base along axis 0
+ */
+seq_tensor* seq_tensor_view_rows(seq_tensor *base, size_t start, size_t count) {
+  if (base == NULL || base->data == NULL || count == 0 ||
+      start >= base->shape[0] || count > base->shape[0] - start) {
+    return NULL;
   }
 
-  // Free data array if we own it
-  if (tensor->data != NULL && (tensor->flags & SEQ_TENSOR_OWNS_DATA)) {
-    free(tensor->data);
+  seq_tensor *t = create_tensor_header(base->ndim, base->shape, base->dtype);
+  if (t == NULL) {
+    return NULL;
   }
 
-  // Free tensor structure
-  free(tensor);
+  // Keep the base layout (e.g. column-major strides), only the row count changes
+  memcpy(t->stride, base->stride, base->ndim * sizeof(size_t));
+  t->shape[0] = count;
+  t->size = base->size / base->shape[0] * count;
+  t->ext_dtype = base->ext_dtype;
+  t->scale = base->scale;
+  t->zero_point = base->zero_point;
+  t->zero_point_frac = base->zero_point_frac;
+  t->data = (char*)base->data + start * base->stride[0] * base->element_size;
+  t->flags = alignment_flags(t->data);
+  return t;
+}
+
+// **********************************************************************
+// Tensor Pool
+// **********************************************************************
+
+#define SEQ_TENSOR_POOL_DEFAULT_CACHED 16
+
+struct seq_tensor_pool {
+  pthread_mutex_t mutex;
+  seq_tensor **idle;        // Returned tensors awaiting reuse
+  size_t idle_count;
+  size_t max_cached;
+};
+
+seq_tensor_pool* seq_tensor_pool_create(size_t max_cached) {
+  seq_tensor_pool *pool = (seq_tensor_pool*)calloc(1, sizeof(seq_tensor_pool));
+  if (pool == NULL) {
+    return NULL;
+  }
+
+  pool->max_cached = max_cached > 0 ? max_cached : SEQ_TENSOR_POOL_DEFAULT_CACHED;
+  pool->idle = (seq_tensor**)calloc(pool->max_cached, sizeof(seq_tensor*));
+  if (pool->idle == NULL) {
+    free(pool);
+    return NULL;
+  }
+  pthread_mutex_init(&pool->mutex, NULL);
+  return pool;
+}
+
+void seq_tensor_pool_free(seq_tensor_pool *pool) {
+  if (pool == NULL) {
+    return;
+  }
+
+  for (size_t i = 0; i < pool->idle_count; i++) {
+    destroy_tensor(pool->idle[i]);
+  }
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool->idle);
+  free(pool);
+}
+
+// Round a buffer size up to a power of two so similar-sized requests share buffers
+static size_t pool_buffer_size(size_t bytes) {
+  size_t capacity = 64;
+  while (capacity < bytes) capacity <<= 1;
+  return capacity;
+}
+
+seq_tensor* seq_tensor_pool_acquire_float(seq_tensor_pool *pool, size_t ndim, const size_t *shape) {
+  if (pool == NULL) {
+    return seq_tensor_create_float_uninit(ndim, shape);
+  }
+  if (!valid_shape(ndim, shape)) {
+    return NULL;
+  }
+  size_t bytes = calculate_total_size(ndim, shape) * sizeof(float);
+
+  // Smallest idle buffer that fits; failing that, the largest (its buffer is regrown)
+  pthread_mutex_lock(&pool->mutex);
+  size_t fit = SIZE_MAX, largest = SIZE_MAX;
+  for (size_t i = 0; i < pool->idle_count; i++) {
+    size_t capacity = pool->idle[i]->capacity;
+    if (capacity >= bytes && (fit == SIZE_MAX || capacity < pool->idle[fit]->capacity)) fit = i;
+    if (largest == SIZE_MAX || capacity > pool->idle[largest]->capacity) largest = i;
+  }
+  size_t pick = (fit != SIZE_MAX) ? fit : largest;
+  seq_tensor *t = NULL;
+  if (pick != SIZE_MAX) {
+    t = pool->idle[pick];
+    pool->idle[pick] = pool->idle[--pool->idle_count];
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  if (t == NULL) {
+    t = (seq_tensor*)calloc(1, sizeof(seq_tensor));
+    if (t == NULL) {
+      return NULL;
+    }
+  }
+
+  if (t->capacity < bytes) {
+    release_data(t->data, t->capacity);
+    t->capacity = pool_buffer_size(bytes);
+    t->data = allocate_aligned_data(t->capacity, false);
+    if (t->data == NULL) {
+      free(t);
+      return NULL;
+    }
+  }
+
+  if (!set_tensor_dims(t, ndim, shape)) {
+    release_data(t->data, t->capacity);
+    free(t);
+    return NULL;
+  }
+  t->dtype = SEQ_TENSOR_FLT32;
+  t->ext_dtype = SEQ_TENSOR_EXT_NONE;
+  t->element_size = sizeof(float);
+  t->scale = 1.0f;
+  t->zero_point = 0;
+  t->zero_point_frac = 0.0f;
+  t->flags = SEQ_TENSOR_OWNS_DATA | alignment_flags(t->data);
+  t->pool = pool;
+  return t;
+}
+
+// Called by seq_tensor_free for pooled tensors: keep the buffer if there is room
+static void pool_return(seq_tensor_pool *pool, seq_tensor *t) {
+  release_tensor_dims(t);
+
+  pthread_mutex_lock(&pool->mutex);
+  // Over the --max-memory budget idle buffers are given back rather than cached
+  if (pool->idle_count < pool->max_cached && !seq_memory_over_budget()) {
+    pool->idle[pool->idle_count++] = t;
+    t = NULL;
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  if (t != NULL) {
+    destroy_tensor(t);
+  }
 }
 
 // **********************************************************************
@@ -364,6 +606,15 @@ int8_t* seq_tensor_data_int8(seq_tensor *t) {
   return (int8_t*)t->data;
 }
 
+/**
+ * Get typed pointer to int16 data
+ */
+int16_t* seq_tensor_data_int16(seq_tensor *t) {
+  assert(t != NULL);
+  assert(t->dtype == SEQ_TENSOR_INT16);
+  return (int16_t*)t->data;
+}
+
 /**
  * Get typed pointer to int32 data
  */
@@ -373,6 +624,260 @@ int32_t* seq_tensor_data_int32(seq_tensor *t) {
   return (int32_t*)t->data;
 }
 
+// **********************************************************************
+// Conversion Functions
+// **********************************************************************
+
+/**
+ * Elements as contiguous runs: one run for dense tensors, otherwise one per
+ * row of the last dimension (padded layouts); false for other strided layouts
+ */
+typedef struct {
+  size_t count;   // Number of runs
+  size_t length;  // Elements per run
+  bool dense;
+} tensor_runs_t;
+
+static bool tensor_runs(const seq_tensor *t, tensor_runs_t *runs) {
+  runs->dense = seq_tensor_is_dense(t);
+  if (runs->dense) {
+    runs->count = 1;
+    runs->length = t->size;
+    return true;
+  }
+  if (t->stride[t->ndim - 1] != 1) return false;
+  runs->length = t->shape[t->ndim - 1];
+  runs->count = t->size / runs->length;
+  return true;
+}
+
+// Element offset of run r (row index over all dimensions but the last)
+static size_t run_offset(const seq_tensor *t, const tensor_runs_t *runs, size_t r) {
+  if (runs->dense) return 0;
+  size_t offset = 0;
+  for (size_t d = t->ndim - 1; d-- > 0;) {
+    offset += (r % t->shape[d]) * t->stride[d];
+    r /= t->shape[d];
+  }
+  return offset;
+}
+
+/**
+ * New tensor of dtype with the shape and strides (padding included) of t
+ */
+static seq_tensor* create_tensor_like(const seq_tensor *t, seq_tensor_dtype dtype,
+                                      float scale, int32_t zero_point, float zero_point_frac) {
+  if (seq_tensor_is_dense(t)) {
+    seq_tensor *out = create_tensor(t->ndim, t->shape, dtype, scale, zero_point, false);
+    if (out != NULL) {
+      memcpy(out->stride, t->stride, t->ndim * sizeof(size_t));
+      out->zero_point_frac = zero_point_frac;
+    }
+    return out;
+  }
+
+  seq_tensor *out = create_tensor_header(t->ndim, t->shape, dtype);
+  if (out == NULL) {
+    return NULL;
+  }
+  memcpy(out->stride, t->stride, t->ndim * sizeof(size_t));
+  out->ext_dtype = t->ext_dtype;
+  out->scale = scale;
+  out->zero_point = zero_point;
+  out->zero_point_frac = zero_point_frac;
+  out->capacity = tensor_span(t) * out->element_size;
+  out->data = allocate_aligned_data(out->capacity, true);   // Padding stays zero
+  if (out->data == NULL) {
+    release_tensor_dims(out);
+    free(out);
+    return NULL;
+  }
+  out->flags = SEQ_TENSOR_OWNS_DATA | alignment_flags(out->data);
+  return out;
+}
+
+/**
+ * Dequantize to float32: real = scale * (q - zero_point - zero_point_frac) = q * scale + bias
+ * One multiply-add per element in the dispatched kernels (seq_kernels.h)
+ */
+seq_tensor* seq_tensor_dequantize(const seq_tensor *t) {
+  tensor_runs_t runs;
+  if (t == NULL || t->data == NULL || !tensor_runs(t, &runs)) {
+    return NULL;
+  }
+
+  seq_tensor *out = create_tensor_like(t, SEQ_TENSOR_FLT32, 1.0f, 0, 0.0f);  // Every element is written below
+  if (out == NULL) {
+    return NULL;
+  }
+
+  const float scale = t->scale;
+  const float bias = -t->scale * ((float)t->zero_point + t->zero_point_frac);
+
+  for (size_t r = 0; r < runs.count; r++) {
+    size_t offset = run_offset(t, &runs, r);
+    float *dst = (float*)out->data + offset;
+    const char *src = (const char*)t->data + offset * t->element_size;
+
+    switch (t->dtype) {
+      case SEQ_TENSOR_INT8:
+        seq_kernel_affine_i8_f32((const int8_t*)src, dst, runs.length, scale, bias);
+        break;
+      case SEQ_TENSOR_INT16:
+        seq_kernel_affine_i16_f32((const int16_t*)src, dst, runs.length, scale, bias);
+        break;
+      case SEQ_TENSOR_INT32:
+        seq_kernel_affine_i32_f32((const int32_t*)src, dst, runs.length, scale, bias);
+        break;
+      case SEQ_TENSOR_FLT32:
+        memcpy(dst, src, runs.length * sizeof(float));
+        break;
+    }
+  }
+
+  return out;
+}
+
+/**
+ * Quantize to an integer dtype: q = saturate(round(real * (1 / scale) + zero_point + zero_point_frac)),
+ * where an integer input's zero_point_frac carries over to the output
+ */
+seq_tensor* seq_tensor_quantize(const seq_tensor *t, seq_tensor_dtype dtype,
+                                float scale, int32_t zero_point) {
+  if (t == NULL || t->data == NULL || scale == 0.0f) {
+    return NULL;
+  }
+  if (dtype == SEQ_TENSOR_FLT32) {
+    return seq_tensor_dequantize(t);
+  }
+
+  // Integer input goes through real values first
+  seq_tensor *real = NULL;
+  const seq_tensor *src = t;
+  const float zero_point_frac = (t->dtype != SEQ_TENSOR_FLT32) ? t->zero_point_frac : 0.0f;
+  if (t->dtype != SEQ_TENSOR_FLT32) {
+    real = seq_tensor_dequantize(t);
+    if (real == NULL) {
+      return NULL;
+    }
+    src = real;
+  }
+
+  tensor_runs_t runs;
+  seq_tensor *out = tensor_runs(src, &runs) ? create_tensor_like(src, dtype, scale, zero_point, zero_point_frac) : NULL;
+  if (out != NULL) {
+    const float inv_scale = 1.0f / scale;
+    const float offset_q = (float)zero_point + zero_point_frac;
+
+    for (size_t r = 0; r < runs.count; r++) {
+      size_t offset = run_offset(src, &runs, r);
+      const float *in = (const float*)src->data + offset;
+      char *dst = (char*)out->data + offset * out->element_size;
+
+      switch (dtype) {
+        case SEQ_TENSOR_INT8:
+          seq_kernel_quantise_f32_i8(in, (int8_t*)dst, runs.length, inv_scale, offset_q);
+          break;
+        case SEQ_TENSOR_INT16:
+          seq_kernel_quantise_f32_i16(in, (int16_t*)dst, runs.length, inv_scale, offset_q);
+          break;
+        case SEQ_TENSOR_INT32:
+          seq_kernel_quantise_f32_i32(in, (int32_t*)dst, runs.length, inv_scale, offset_q);
+          break;
+        case SEQ_TENSOR_FLT32:
+          break;
+      }
+    }
+  }
+
+  seq_tensor_free(real);
+  return out;
+}
+
+/**
+ * Deep copy with the same dtype and layout
+ */
+seq_tensor* seq_tensor_copy(const seq_tensor *t) {
+  tensor_runs_t runs;
+  if (t == NULL || t->data == NULL || !tensor_runs(t, &runs)) {
+    return NULL;
+  }
+
+  seq_tensor *out = create_tensor_like(t, t->dtype, t->scale, t->zero_point, t->zero_point_frac);
+  if (out == NULL) {
+    return NULL;
+  }
+  out->ext_dtype = t->ext_dtype;
+
+  for (size_t r = 0; r < runs.count; r++) {
+    size_t offset = run_offset(t, &runs, r) * t->element_size;
+    memcpy((char*)out->data + offset, (const char*)t->data + offset, runs.length * t->element_size);
+  }
+  return out;
+}
+
+// **********************************************************************
+// Reduction Functions
+// **********************************************************************
+
+// Mean and squared deviations of one run of raw (not dequantized) values
+static void run_moments(const seq_tensor *t, const void *data, size_t n, double *mean, double *m2) {
+  switch (t->dtype) {
+    case SEQ_TENSOR_FLT32:
+      seq_kernel_moments_f32((const float*)data, n, mean, m2);
+      return;
+    case SEQ_TENSOR_INT16:
+      seq_kernel_moments_i16((const int16_t*)data, n, mean, m2);
+      return;
+    case SEQ_TENSOR_INT8:
+    case SEQ_TENSOR_INT32: {
+      double sum = 0.0;
+      for (size_t i = 0; i < n; i++) {
+        sum += (t->dtype == SEQ_TENSOR_INT8) ? ((const int8_t*)data)[i] : ((const int32_t*)data)[i];
+      }
+      double mu = sum / (double)n, acc = 0.0;
+      for (size_t i = 0; i < n; i++) {
+        double v = (t->dtype == SEQ_TENSOR_INT8) ? ((const int8_t*)data)[i] : ((const int32_t*)data)[i];
+        acc += (v - mu) * (v - mu);
+      }
+      *mean = mu;
+      *m2 = acc;
+      return;
+    }
+  }
+}
+
+/**
+ * Mean and population variance, runs merged with Chan's parallel update
+ */
+int seq_tensor_moments(const seq_tensor *t, double *mean, double *variance) {
+  tensor_runs_t runs;
+  if (t == NULL || t->data == NULL || t->size == 0 || !tensor_runs(t, &runs)) {
+    return -1;
+  }
+
+  double total_mean = 0.0, total_m2 = 0.0;
+  size_t total_n = 0;
+  for (size_t r = 0; r < runs.count; r++) {
+    double run_mean = 0.0, run_m2 = 0.0;
+    const char *data = (const char*)t->data + run_offset(t, &runs, r) * t->element_size;
+    run_moments(t, data, runs.length, &run_mean, &run_m2);
+
+    size_t n = total_n + runs.length;
+    double delta = run_mean - total_mean;
+    total_mean += delta * (double)runs.length / (double)n;
+    total_m2 += run_m2 + delta * delta * (double)total_n * (double)runs.length / (double)n;
+    total_n = n;
+  }
+
+  // Integer tensors report calibrated values: real = scale * (q - zero_point - zero_point_frac)
+  double scale = (t->dtype == SEQ_TENSOR_FLT32) ? 1.0 : (double)t->scale;
+  double zero_point = (t->dtype == SEQ_TENSOR_FLT32) ? 0.0 : (double)t->zero_point + t->zero_point_frac;
+  if (mean) *mean = scale * (total_mean - zero_point);
+  if (variance) *variance = scale * scale * total_m2 / (double)total_n;
+  return 0;
+}
+
 // **********************************************************************
 // Dimension Query Functions
 // **********************************************************************
@@ -398,6 +903,16 @@ size_t seq_tensor_total_size(const seq_tensor *t) {
 // Debug/Display Functions
 // **********************************************************************
 
+// Offset of logical (C-order) element i, following the tensor's strides
+static size_t element_offset(const seq_tensor *t, size_t i) {
+  size_t offset = 0;
+  for (size_t d = t->ndim; d-- > 0;) {
+    offset += (i % t->shape[d]) * t->stride[d];
+    i /= t->shape[d];
+  }
+  return offset;
+}
+
 /**
  * Print tensor shape and first few elements
  */
@@ -411,6 +926,7 @@ void seq_tensor_print(const seq_tensor *t) {
   const char *dtype_name;
   switch (t->dtype) {
     case SEQ_TENSOR_INT8:  dtype_name = "int8";   break;
+    case SEQ_TENSOR_INT16: dtype_name = "int16";  break;
     case SEQ_TENSOR_INT32: dtype_name = "int32";  break;
     case SEQ_TENSOR_FLT32: dtype_name = "float32"; break;
     default:               dtype_name = "unknown"; break;
@@ -434,21 +950,28 @@ void seq_tensor_print(const seq_tensor *t) {
     case SEQ_TENSOR_FLT32: {
       float *data = (float*)t->data;
       for (size_t i = 0; i < num_to_print; i++) {
-        printf("%.4f ", data[i]);
+        printf("%.4f ", data[element_offset(t, i)]);
       }
       break;
     }
     case SEQ_TENSOR_INT8: {
       int8_t *data = (int8_t*)t->data;
       for (size_t i = 0; i < num_to_print; i++) {
-        printf("%d ", data[i]);
+        printf("%d ", data[element_offset(t, i)]);
+      }
+      break;
+    }
+    case SEQ_TENSOR_INT16: {
+      int16_t *data = (int16_t*)t->data;
+      for (size_t i = 0; i < num_to_print; i++) {
+        printf("%d ", data[element_offset(t, i)]);
       }
       break;
     }
     case SEQ_TENSOR_INT32: {
       int32_t *data = (int32_t*)t->data;
       for (size_t i = 0; i < num_to_print; i++) {
-        printf("%d ", data[i]);
+        printf("%d ", data[element_offset(t, i)]);
       }
       break;
     }
@@ -456,7 +979,7 @@ void seq_tensor_print(const seq_tensor *t) {
   printf("\n");
 
   // Print quantization info if applicable
-  if (t->dtype == SEQ_TENSOR_INT8 || t->dtype == SEQ_TENSOR_INT32) {
-    printf("  Quantization: scale=%.6f zero_point=%d\n", t->scale, t->zero_point);
+  if (t->dtype == SEQ_TENSOR_INT8 || t->dtype == SEQ_TENSOR_INT16 || t->dtype == SEQ_TENSOR_INT32) {
+    printf("  Quantization: scale=%.6f zero_point=%g\n", t->scale, t->zero_point + (double)t->zero_point_frac);
   }
 }
@@ -5,7 +5,7 @@
 //
 // Unified tensor structure supporting:
 // - N-dimensional arrays (matrices are 2D tensors)
-// - Multiple data types (int8, int32, float32)
+// - Multiple data types (int8, int16, int32, float32)
 // - Quantization metadata for ML inference
 // - SIMD-aligned memory allocation
 //
@@ -27,7 +27,8 @@
 typedef enum {
 	SEQ_TENSOR_INT8,      // 8-bit signed integer (quantized inference)
 	SEQ_TENSOR_INT32,     // 32-bit signed integer (accumulators)
-	SEQ_TENSOR_FLT32      // 32-bit floating point (standard)
+	SEQ_TENSOR_FLT32,     // 32-bit floating point (standard)
+	SEQ_TENSOR_INT16      // 16-bit signed integer (native Fast5 ADC samples)
 } seq_tensor_dtype;
 
 // **********************************************************************
@@ -52,17 +53,22 @@ typedef enum {
  *     → Floats packed into SSE vectors (defined in ciren)
  */
 typedef enum {
-	SEQ_TENSOR_EXT_NONE = 0  // Standard tensor, no extensions
+	SEQ_TENSOR_EXT_NONE = 0,  // Standard tensor, no extensions
+	SEQ_TENSOR_EXT_PADDED     // Rows (last dimension) padded so each starts on an alignment boundary
 } seq_tensor_ext_dtype;
 
 // **********************************************************************
 // Core Tensor Structure
 // **********************************************************************
+#define SEQ_TENSOR_INLINE_DIMS 4   // shape/stride live in the struct up to this ndim (malloc'd beyond)
+
+struct seq_tensor_pool;
+
 typedef struct seq_tensor {
 	// Dimensionality
 	size_t ndim;            // num of dim (2 for matrix, 3+ for tensors)
-	size_t *shape;          // dim sizes [malloc'd]   (2D [C,R] C: col size;           R: row size)
-	size_t *stride;         // mem strides [malloc'd] (2D [c,r] c: strd to nxt C elem; r: strd to nxt R elem)
+	size_t *shape;          // dim sizes [inline/malloc'd]   (2D [C,R] C: col size;           R: row size)
+	size_t *stride;         // mem strides [inline/malloc'd] (2D [c,r] c: strd to nxt C elem; r: strd to nxt R elem)
 	size_t size;            // total number of elements
 
 	// Data type information
@@ -70,22 +76,34 @@ typedef struct seq_tensor {
 	seq_tensor_ext_dtype ext_dtype;  // Extension type (platform-specific optimizations)
 	size_t element_size;             // sizeof(element) in bytes
 
-	// Quantization parameters (only used for INT8/INT32 types)
+	// Quantization parameters (only used for INT8/INT16/INT32 types)
 	float scale;            // Quantization scale factor
 	int32_t zero_point;     // Quantization zero point
+	float zero_point_frac;  // Non-integral part of the zero point (Fast5 calibration offsets):
+	                        // real = scale * (q - zero_point - zero_point_frac)
 
 	// Data storage
 	void *data;             // Pointer to actual data (malloc'd)
 
 	// Memory metadata
 	uint32_t flags;         // Memory properties (alignment, ownership)
+	size_t capacity;        // Bytes allocated at data (0 for views)
+	struct seq_tensor_pool *pool;  // Pool the tensor returns to on seq_tensor_free (NULL if none)
+
+	// Inline dimension storage (avoids two mallocs per tensor)
+	size_t shape_inline[SEQ_TENSOR_INLINE_DIMS];
+	size_t stride_inline[SEQ_TENSOR_INLINE_DIMS];
 } seq_tensor;
 
 // **********************************************************************
 // Memory Layout Flags
 // **********************************************************************
 #define SEQ_TENSOR_OWNS_DATA  0x8000   // Tensor owns data pointer
-#define SEQ_TENSOR_ALIGNED_16 0x1000   // Data is 16-byte aligned (SIMD)
+#define SEQ_TENSOR_ALIGNED_16 0x1000   // Data is 16-byte aligned (SSE/NEON)
+#define SEQ_TENSOR_ALIGNED_32 0x2000   // Data is 32-byte aligned (AVX2)
+#define SEQ_TENSOR_ALIGNED_64 0x4000   // Data is 64-byte aligned (cache line, AVX-512)
+
+#define SEQ_TENSOR_ALIGNMENT  64       // Alignment of all tensor allocations
 
 // **********************************************************************
 // Construction Functions
@@ -114,6 +132,22 @@ seq_tensor* seq_tensor_create_float(size_t ndim, const size_t *shape);
 seq_tensor* seq_tensor_create_int8(size_t ndim, const size_t *shape,
 																	 float scale, int32_t zero_point);
 
+/**
+ * Create an int16 tensor (raw ADC samples with calibration as quantization)
+ *
+ * For Fast5 signals: scale = range / digitisation, zero_point = -offset, so
+ * pA = scale * (raw - zero_point) = (raw + offset) * range / digitisation
+ * (a non-integral offset keeps its remainder in t->zero_point_frac)
+ *
+ * @param ndim Number of dimensions
+ * @param shape Array of dimension sizes
+ * @param scale Quantization scale
+ * @param zero_point Quantization zero point
+ * @return Newly allocated tensor or NULL on failure
+ */
+seq_tensor* seq_tensor_create_int16(size_t ndim, const size_t *shape,
+																		float scale, int32_t zero_point);
+
 /**
  * Create an int32 accumulator tensor
  *
@@ -142,11 +176,100 @@ seq_tensor* seq_tensor_create_2d_float_cm(size_t rows, size_t cols);
  */
 seq_tensor* seq_tensor_create_2d_float_rm(size_t rows, size_t cols);
 
+/**
+ * Create a float32 / int16 tensor without zero-filling the data
+ *
+ * For buffers the caller overwrites completely (generated signals, HDF5 reads);
+ * contents are indeterminate until written. Otherwise as the _create functions.
+ */
+seq_tensor* seq_tensor_create_float_uninit(size_t ndim, const size_t *shape);
+seq_tensor* seq_tensor_create_int16_uninit(size_t ndim, const size_t *shape,
+																					 float scale, int32_t zero_point);
+
+/**
+ * Create a zero-filled tensor whose rows (last dimension) are padded so that
+ * every row starts on an alignment boundary (16, 32 or 64 bytes)
+ *
+ * Strides are C-order over the padded row pitch and ext_dtype is
+ * SEQ_TENSOR_EXT_PADDED; size counts logical elements only. Padding stays
+ * zero, so whole-row vector loops may read it. Use the stride-aware
+ * functions below (or stride[]) rather than indexing data as a flat array.
+ *
+ * @return Newly allocated tensor or NULL on failure
+ */
+seq_tensor* seq_tensor_create_padded(seq_tensor_dtype dtype, size_t ndim, const size_t *shape,
+																		 size_t alignment, float scale, int32_t zero_point);
+
+/**
+ * True if elements are densely packed (size elements, any axis order)
+ */
+bool seq_tensor_is_dense(const seq_tensor *t);
+
 /**
  * Free tensor and all associated memory
+ *
+ * Data is released only when SEQ_TENSOR_OWNS_DATA is set; tensors taken from
+ * a seq_tensor_pool go back to their pool instead of being freed.
  */
 void seq_tensor_free(seq_tensor *tensor);
 
+// **********************************************************************
+// Views (non-owning)
+// **********************************************************************
+
+/**
+ * Wrap external data in a tensor without copying (C-order strides)
+ *
+ * SEQ_TENSOR_OWNS_DATA is clear, so seq_tensor_free releases only the tensor
+ * itself; data must outlive the view.
+ *
+ * @return Newly allocated view or NULL on failure
+ */
+seq_tensor* seq_tensor_wrap(void *data, seq_tensor_dtype dtype, size_t ndim, const size_t *shape);
+
+/**
+ * View rows [start, start + count) of base along axis 0, sharing its data
+ *
+ * Shape, strides and quantization are inherited; only shape[0] changes.
+ * seq_tensor_view_rows(t, 0, t->shape[0]) views the whole tensor.
+ * The view must not outlive base.
+ *
+ * @return Newly allocated view or NULL if the range is out of bounds
+ */
+seq_tensor* seq_tensor_view_rows(seq_tensor *base, size_t start, size_t count);
+
+// **********************************************************************
+// Tensor Pool
+// **********************************************************************
+
+/**
+ * seq_tensor_pool: recycles tensors (struct and data buffer) of varying size
+ *
+ * Tensors acquired from a pool are ordinary owning tensors, except that
+ * seq_tensor_free() returns them to the pool, so they can be handed to code
+ * that frees them (e.g. fast5_writer_append_read). Buffers are reused
+ * best-fit and grown to a power of two, so a stream of similar-sized reads
+ * settles into zero allocations per read. The pool is internally locked and
+ * may be shared between threads; it must outlive every tensor taken from it.
+ */
+typedef struct seq_tensor_pool seq_tensor_pool;
+
+/**
+ * Create a pool keeping at most max_cached idle tensors (0 = default of 16)
+ */
+seq_tensor_pool* seq_tensor_pool_create(size_t max_cached);
+
+/**
+ * Free the pool and its idle tensors
+ */
+void seq_tensor_pool_free(seq_tensor_pool *pool);
+
+/**
+ * Take a float32 tensor of the given shape; data is not zero-filled
+ * pool may be NULL, giving seq_tensor_create_float_uninit()
+ */
+seq_tensor* seq_tensor_pool_acquire_float(seq_tensor_pool *pool, size_t ndim, const size_t *shape);
+
 // **********************************************************************
 // Data Access Functions
 // **********************************************************************
@@ -163,12 +286,65 @@ float* seq_tensor_data_float(seq_tensor *t);
  */
 int8_t* seq_tensor_data_int8(seq_tensor *t);
 
+/**
+ * Get typed pointer to int16 data
+ * Asserts that tensor dtype is INT16 in debug builds
+ */
+int16_t* seq_tensor_data_int16(seq_tensor *t);
+
 /**
  * Get typed pointer to int32 data
  * Asserts that tensor dtype is INT32 in debug builds
  */
 int32_t* seq_tensor_data_int32(seq_tensor *t);
 
+// **********************************************************************
+// Conversion Functions
+// **********************************************************************
+
+/**
+ * Dequantize an integer tensor to a new float32 tensor of the same shape
+ *
+ * real_value = scale * (quantized - zero_point - zero_point_frac); FLT32 input is copied.
+ * Intended to be called lazily, only when calibrated values are needed.
+ *
+ * @return Newly allocated float32 tensor or NULL on failure
+ */
+seq_tensor* seq_tensor_dequantize(const seq_tensor *t);
+
+/**
+ * Quantize to a new int8/int16/int32 tensor with the given scale/zero_point
+ *
+ * q = saturate(round(real / scale + zero_point + zero_point_frac)); integer
+ * input is dequantized first, so this also converts between integer dtypes,
+ * and its zero_point_frac carries over to the result.
+ * FLT32 as target dtype gives seq_tensor_dequantize().
+ *
+ * @return Newly allocated tensor or NULL on failure
+ */
+seq_tensor* seq_tensor_quantize(const seq_tensor *t, seq_tensor_dtype dtype,
+																float scale, int32_t zero_point);
+
+/**
+ * Deep copy (same dtype, layout and quantization); views become owning
+ *
+ * @return Newly allocated tensor or NULL on failure
+ */
+seq_tensor* seq_tensor_copy(const seq_tensor *t);
+
+// **********************************************************************
+// Reduction Functions
+// **********************************************************************
+
+/**
+ * Mean and population variance of the (dequantized) values over all elements
+ *
+ * Uses the dispatched kernels (see seq_kernels.h); int16 sums are exact.
+ *
+ * @return 0 on success, -1 for an empty or unsupported tensor
+ */
+int seq_tensor_moments(const seq_tensor *t, double *mean, double *variance);
+
 // **********************************************************************
 // Dimension Query Functions
 // **********************************************************************
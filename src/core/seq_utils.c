@@ -8,27 +8,33 @@
  letters A,C,G,T) as well as extract k-mer equivalents from reads and represent
 k-mers as integer indexes representing lexicographical order. */
 #include <string.h>
-#include <stdlib.h>    // need this for rand
-#include <time.h>      // need this for time
+#include <stdlib.h>
 #include <unistd.h>    // on macOS POSIX read() lives in <unistd.h>, not in <stdio.h>
 #include <ctype.h>     // for toupper
 
 #include "../../include/sequelizer.h"  // for RETURN_NULL_IF, warnx (via err.h)
 #include "kseq.h"      // for KSEQ_INIT
 #include "seq_utils.h"
+#include "seq_packed.h"
 
 // generates a random string of length len that only
 // consists of letters drawn from the alphabet: A,C,G,T
 // e.g., generates: AAACAAGCCT
 char* random_str(int len) {
-  char alphabet[] = "ACGT";
-  int alphabet_size = strlen(alphabet);
+  seq_rng rng;
+  seq_rng_init(&rng, seq_rng_entropy_seed(), 0);
+  return random_str_rng(len, &rng);
+}
+
+// generates a random string of length len from A,C,G,T drawing
+// from the caller's random stream (reentrant; no global reseeding)
+char* random_str_rng(int len, seq_rng *rng) {
+  static const char alphabet[] = "ACGT";
 
   char* result = (char*)malloc((len + 1) * sizeof(char));
-  srand(time(NULL));
+  RETURN_NULL_IF(NULL == result, NULL);
   for (int i = 0; i < len; i++) {
-    int random_index = rand() % alphabet_size;
-    result[i] = alphabet[random_index];
+    result[i] = alphabet[seq_rng_below(rng, 4)];
   }
 
   result[len] = '\0';
@@ -39,21 +45,26 @@ char* random_str(int len) {
 /* generates a random string of length len that only
  consists of letters drawn from the alphabet: A,C,G,T
 and also asks you to choose the random
-e.g., generates: GTCTGCCAGC */
+e.g., generates: GTCTGCCAGC. Draws from stream 0 of seed,
+so other threads' draws never change the result */
 char* random_str_seed(int len, unsigned int seed) {
-  char alphabet[] = "ACGT";
-  int alphabet_size = strlen(alphabet);
+  seq_rng rng;
+  seq_rng_init(&rng, seed, 0);
+  return random_str_rng(len, &rng);
+}
 
-  char* result = (char*)malloc((len + 1) * sizeof(char));
-  srand(seed); // seed the random number generator
-  for (int i = 0; i < len; i++) {
-    int random_index = rand() % alphabet_size;
-    result[i] = alphabet[random_index];
-  }
+// Array of num_examples strings of length len, string i from stream i of seed
+static char** random_str_batch_streams(int len, int num_examples, uint64_t seed) {
+  char** results = (char**)malloc(num_examples * sizeof(char*));
+  RETURN_NULL_IF(NULL == results, NULL);
 
-  result[len] = '\0';
+  for (int i = 0; i < num_examples; i++) {
+    seq_rng rng;
+    seq_rng_init(&rng, seed, (uint64_t)i);
+    results[i] = random_str_rng(len, &rng);
+  }
 
-  return result;
+  return results;
 }
 
 // This updated function returns an array of num_examples
@@ -61,23 +72,7 @@ char* random_str_seed(int len, unsigned int seed) {
 // to free the allocated memory after you are done using
 // the generated strings.
 char** random_str_batch(int len, int num_examples) {
-  char alphabet[] = "ACGT";
-  int alphabet_size = strlen(alphabet);
-
-  char** results = (char**)malloc(num_examples * sizeof(char*));
-  srand(time(NULL));
-
-  for (int i = 0; i < num_examples; i++) {
-    char* result = (char*)malloc((len + 1) * sizeof(char));
-    for (int j = 0; j < len; j++) {
-      int random_index = rand() % alphabet_size;
-      result[j] = alphabet[random_index];
-    }
-    result[len] = '\0';
-    results[i] = result;
-  }
-
-  return results;
+  return random_str_batch_streams(len, num_examples, seq_rng_entropy_seed());
 }
 
 // This updated function returns an array of num_examples
@@ -85,23 +80,7 @@ char** random_str_batch(int len, int num_examples) {
 // to free the allocated memory after you are done using
 // the generated strings.
 char** random_str_batch_seed(int len, int num_examples, unsigned int seed) {
-  char alphabet[] = "ACGT";
-  int alphabet_size = strlen(alphabet);
-
-  char** results = (char**)malloc(num_examples * sizeof(char*));
-  srand(seed); // seed the random number generator
-
-  for (int i = 0; i < num_examples; i++) {
-    char* result = (char*)malloc((len + 1) * sizeof(char));
-    for (int j = 0; j < len; j++) {
-      int random_index = rand() % alphabet_size;
-      result[j] = alphabet[random_index];
-    }
-    result[len] = '\0';
-    results[i] = result;
-  }
-
-  return results;
+  return random_str_batch_streams(len, num_examples, seed);
 }
 
 // Convert a sequence consisting of letters (drawn from the
@@ -195,22 +174,33 @@ void int_to_kmer(int len, int index, char* kmer) {
 // k: the size of the k-mers that you want to break it into
 // num_ints: the number of k-mers in the sequence
 // ints: array of integer representations of your kmers
+// (packs the sequence and rolls the index, so no per-k-mer strings; NULL with
+// *num_ints = 0 if the sequence holds anything other than A,C,G,T)
 int* seq_kmers_to_ints(const char* sequence, int k, int* num_ints) {
-  int num_kmers;
-  char** kmers = seq_kmers(sequence, k, &num_kmers); // generates all possible kmers from the sequence
-
-  int* ints = (int*)malloc(num_kmers * sizeof(int));
+  *num_ints = 0;
+  seq_packed *packed = seq_pack(sequence, strlen(sequence));
+  RETURN_NULL_IF(NULL == packed, NULL);
+
+  size_t num_kmers = seq_kmer_count(packed->length, k);
+  int* ints = (int*)malloc((num_kmers ? num_kmers : 1) * sizeof(int));
+  if (NULL == ints) {
+    seq_packed_free(packed);
+    return NULL;
+  }
 
-  for (int i = 0; i < num_kmers; i++) {
-    ints[i] = kmer_to_int(kmers[i]); // converts a kmer string to an integer index in lexicographical order
+  seq_kmer_iter it;
+  uint32_t index;
+  size_t i = 0;
+  seq_kmer_iter_init(&it, packed, k);
+  while (i < num_kmers && seq_kmer_iter_next(&it, &index)) {
+    ints[i++] = (int)index; // integer index in lexicographical order
   }
 
-  *num_ints = num_kmers;
-  free_kmers(kmers, num_kmers);
+  *num_ints = (int)num_kmers;
+  seq_packed_free(packed);
   return ints;
 }
 
-static int nbase = 4;
 KSEQ_INIT(int, read);
 
 /**  Converts a nucleotide base into integer
@@ -251,25 +241,28 @@ int base_to_int(char base, bool allow_lower){
  *   invalid base was encountered
  **/
 int * encode_bases_to_integers(char const * seq, size_t n, size_t state_len){
-  const size_t nstate = n - state_len + 1;
+  const size_t nstate = seq_kmer_count(n, (int)state_len);
+  RETURN_NULL_IF(0 == nstate, NULL);
+
+  seq_packed *packed = seq_pack(seq, n);
+  RETURN_NULL_IF(NULL == packed, NULL);
 
   int * iseq = calloc(nstate, sizeof(int));
-  RETURN_NULL_IF(NULL == iseq, NULL);
-  for(size_t i=0 ; i < nstate ; i++){
-    int ib = 0;
-    for(size_t j=0 ; j < state_len ; j++){
-      int newbase = base_to_int(seq[i + j], true);
-      if(-1 == newbase){
-        free(iseq);
-        return NULL;
-      }
-
-      ib *= nbase;
-      ib += newbase;
-    }
-    iseq[i] = ib;
+  if(NULL == iseq){
+    seq_packed_free(packed);
+    return NULL;
+  }
+
+  // Rolling state index: one shift-and-mask per base instead of state_len multiplies
+  seq_kmer_iter it;
+  uint32_t ib;
+  size_t i = 0;
+  seq_kmer_iter_init(&it, packed, (int)state_len);
+  while(i < nstate && seq_kmer_iter_next(&it, &ib)){
+    iseq[i++] = (int)ib;
   }
 
+  seq_packed_free(packed);
   return iseq;
 }
 
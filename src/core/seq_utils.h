@@ -9,11 +9,14 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include "seq_rng.h"
 
 char* random_str(int len);
 
 char* random_str_seed(int len, unsigned int seed);
 
+char* random_str_rng(int len, seq_rng *rng);
+
 char** random_str_batch(int len, int num_examples);
 
 char** random_str_batch_seed(int len, int num_examples, unsigned int seed);
@@ -6,11 +6,13 @@
 #include "seqgen_models.h"
 #include "kmer_model_loader.h"
 #include "seq_utils.h"
+#include "seq_profile.h"
 #include "../../include/sequelizer.h"
 #include <string.h>
 #include <stdlib.h>
 #include <err.h>
 #include <math.h>
+#include <pthread.h>
 
 // **********************************************************************
 // String to Model Type Conversion
@@ -54,13 +56,272 @@ seqgen_func_ptr get_seqgen_func(const seqgen_model_type model_type) {
   return NULL;
 }
 
+// **********************************************************************
+// K-mer Lookup Kernels
+// **********************************************************************
+// Rows [current, stddev, dwell] for every k-mer of a sequence whose bases are
+// already known to be 0..3, read from the interleaved level table. The common
+// model sizes (5, 6 and 9) get kernels with k fixed at compile time: the mask
+// is a constant and the k - 1 priming shifts unroll. Other k share one kernel
+// with the same loop and a runtime k.
+
+typedef void (*kmer_rows_int_fn)(const int *sequence, size_t n, int kmer_size,
+                                 const seqgen_kmer_level *levels, float dwell, float *row);
+typedef void (*kmer_rows_packed_fn)(const seq_packed *sequence, int kmer_size,
+                                    const seqgen_kmer_level *levels, float dwell, float *row);
+
+typedef struct {
+  kmer_rows_int_fn rows_int;
+  kmer_rows_packed_fn rows_packed;
+} kmer_kernels_t;
+
+#define KMER_INT_BASE(j) sequence[j]
+#define KMER_PACKED_BASE(j) seq_packed_base(sequence, j)
+
+// Rolling K-mer index over bases 0..N-1, one row per k-mer from row onwards
+#define KMER_ROWS_BODY(K, BASE, N)                                          \
+  const uint32_t mask = ((uint32_t)1 << (2 * (K))) - 1;                     \
+  uint32_t index = 0;                                                       \
+  for (size_t j = 0; j + 1 < (size_t)(K); j++) {                            \
+    index = (index << 2) | (uint32_t)BASE(j);                               \
+  }                                                                         \
+  for (size_t j = (size_t)(K) - 1; j < (N); j++, row += 3) {                \
+    index = ((index << 2) | (uint32_t)BASE(j)) & mask;                      \
+    const seqgen_kmer_level level = levels[index];                          \
+    row[0] = level.mean;                                                    \
+    row[1] = level.stddev;                                                  \
+    row[2] = dwell;                                                         \
+  }
+
+#define KMER_KERNELS(K)                                                                        \
+  static void kmer_rows_int_##K(const int *sequence, size_t n, int kmer_size,                  \
+                                const seqgen_kmer_level *levels, float dwell, float *row) {    \
+    (void)kmer_size;                                                                           \
+    KMER_ROWS_BODY(K, KMER_INT_BASE, n)                                                        \
+  }                                                                                            \
+  static void kmer_rows_packed_##K(const seq_packed *sequence, int kmer_size,                  \
+                                   const seqgen_kmer_level *levels, float dwell, float *row) { \
+    (void)kmer_size;                                                                           \
+    KMER_ROWS_BODY(K, KMER_PACKED_BASE, sequence->length)                                      \
+  }
+
+KMER_KERNELS(5)
+KMER_KERNELS(6)
+KMER_KERNELS(9)
+
+static void kmer_rows_int_any(const int *sequence, size_t n, int kmer_size,
+                              const seqgen_kmer_level *levels, float dwell, float *row) {
+  KMER_ROWS_BODY(kmer_size, KMER_INT_BASE, n)
+}
+
+static void kmer_rows_packed_any(const seq_packed *sequence, int kmer_size,
+                                 const seqgen_kmer_level *levels, float dwell, float *row) {
+  KMER_ROWS_BODY(kmer_size, KMER_PACKED_BASE, sequence->length)
+}
+
+// Kernel pair for a k-mer size: picked once per read when its tables are resolved,
+// the way get_seqgen_func() picks the model
+static const kmer_kernels_t* get_kmer_kernels(int kmer_size) {
+  static const kmer_kernels_t specialised[SEQGEN_KMER_MAX_SIZE + 1] = {
+    [5] = {kmer_rows_int_5, kmer_rows_packed_5},
+    [6] = {kmer_rows_int_6, kmer_rows_packed_6},
+    [9] = {kmer_rows_int_9, kmer_rows_packed_9}
+  };
+  static const kmer_kernels_t generic = {kmer_rows_int_any, kmer_rows_packed_any};
+
+  if (kmer_size > 0 && kmer_size <= SEQGEN_KMER_MAX_SIZE && specialised[kmer_size].rows_int) {
+    return &specialised[kmer_size];
+  }
+  return &generic;
+}
+
 // **********************************************************************
 // K-mer Lookup Model Implementation
 // **********************************************************************
 
-seq_tensor* squiggle_kmer(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params) {
-  if (!sequence || !params) return NULL;
+// Average groups of 4^(K-k) consecutive levels of the K-mer table into the k-mer table
+static float* decimate_levels(const float *levels, int loaded_kmer_size, int kmer_size) {
+  size_t num_kmers = (size_t)1 << (2 * kmer_size);
+  size_t decimation_factor = (size_t)1 << (2 * (loaded_kmer_size - kmer_size));
+
+  float *table = malloc(num_kmers * sizeof(float));
+  if (!table) return NULL;
+
+  for (size_t k_idx = 0; k_idx < num_kmers; k_idx++) {
+    const float *group = levels + k_idx * decimation_factor;
+    float sum = 0.0f;
+    for (size_t i = 0; i < decimation_factor; i++) {
+      sum += group[i];
+    }
+    table[k_idx] = sum / decimation_factor;
+  }
+  return table;
+}
+
+// Interleave a k-mer table's means and stddevs (default_stddev where the model has none)
+static seqgen_kmer_level* interleave_levels(const float *mean, const float *stddev, float default_stddev,
+                                            int kmer_size) {
+  size_t num_kmers = (size_t)1 << (2 * kmer_size);
+  size_t bytes = (num_kmers * sizeof(seqgen_kmer_level) + 63) & ~(size_t)63;   // aligned_alloc wants a multiple
+
+  seqgen_kmer_level *levels = aligned_alloc(64, bytes);
+  if (!levels) return NULL;
+
+  for (size_t k_idx = 0; k_idx < num_kmers; k_idx++) {
+    levels[k_idx].mean = mean[k_idx];
+    levels[k_idx].stddev = stddev ? stddev[k_idx] : default_stddev;
+  }
+  return levels;
+}
+
+// Interleave a k-mer table's noise level distributions. Entries without a usable
+// distribution (a zero ig_lambda from a short row) fall back to the fixed level stddev
+static seqgen_kmer_noise* interleave_noise(const float *sd_mean, const float *ig_lambda,
+                                           const seqgen_kmer_level *levels, int kmer_size) {
+  size_t num_kmers = (size_t)1 << (2 * kmer_size);
+  size_t bytes = (num_kmers * sizeof(seqgen_kmer_noise) + 63) & ~(size_t)63;
+
+  seqgen_kmer_noise *noise = aligned_alloc(64, bytes);
+  if (!noise) return NULL;
+
+  for (size_t k_idx = 0; k_idx < num_kmers; k_idx++) {
+    bool usable = sd_mean[k_idx] > 0.0f && ig_lambda[k_idx] > 0.0f;
+    noise[k_idx].mean = usable ? sd_mean[k_idx] : levels[k_idx].stddev;
+    noise[k_idx].lambda = usable ? ig_lambda[k_idx] : 0.0f;
+  }
+  return noise;
+}
+
+// Noise table for k, decimating the model's sd_mean and ig_lambda like the levels
+static seqgen_kmer_noise* build_noise_table(const kmer_model_t *model, const seqgen_kmer_level *levels,
+                                            int kmer_size) {
+  if (kmer_size == model->kmer_size) {
+    return interleave_noise(model->sd_mean, model->ig_lambda, levels, kmer_size);
+  }
+
+  float *sd_mean = decimate_levels(model->sd_mean, model->kmer_size, kmer_size);
+  float *ig_lambda = decimate_levels(model->ig_lambda, model->kmer_size, kmer_size);
+  seqgen_kmer_noise *noise = (sd_mean && ig_lambda) ? interleave_noise(sd_mean, ig_lambda, levels, kmer_size)
+                                                    : NULL;
+  free(sd_mean);
+  free(ig_lambda);
+  return noise;
+}
+
+seqgen_kmer_context* seqgen_kmer_context_create(const char *models_dir, const char *model_name) {
+  if (!models_dir || !model_name) return NULL;
+
+  seqgen_kmer_context *context = calloc(1, sizeof(seqgen_kmer_context));
+  if (!context) return NULL;
+
+  size_t id_len = strlen(models_dir) + strlen(model_name) + 2;
+  context->model_id = malloc(id_len);
+  context->model = load_kmer_model(models_dir, model_name);
+  if (!context->model_id || !context->model) {
+    seqgen_kmer_context_free(context);
+    return NULL;
+  }
+  snprintf(context->model_id, id_len, "%s/%s", models_dir, model_name);
+
+  const kmer_model_t *model = context->model;
+  if (model->kmer_size <= 0 || model->kmer_size > SEQGEN_KMER_MAX_SIZE) {
+    warnx("Model %s has unsupported k-mer size %d", context->model_id, model->kmer_size);
+    seqgen_kmer_context_free(context);
+    return NULL;
+  }
+  context->max_kmer_size = model->kmer_size;
+  context->default_stddev = model->default_stddev;
+
+  // Full-size tables come straight from the model; smaller k are decimated once here
+  context->mean[model->kmer_size] = model->level_mean;
+  context->stddev[model->kmer_size] = model->level_stddev;
+  for (int k = 1; k < model->kmer_size; k++) {
+    context->mean[k] = decimate_levels(model->level_mean, model->kmer_size, k);
+    if (model->level_stddev) {
+      context->stddev[k] = decimate_levels(model->level_stddev, model->kmer_size, k);
+    }
+    if (!context->mean[k] || (model->level_stddev && !context->stddev[k])) {
+      seqgen_kmer_context_free(context);
+      return NULL;
+    }
+  }
+  for (int k = 1; k <= model->kmer_size; k++) {
+    context->levels[k] = interleave_levels(context->mean[k], context->stddev[k], context->default_stddev, k);
+    if (!context->levels[k]) {
+      seqgen_kmer_context_free(context);
+      return NULL;
+    }
+    if (model->sd_mean && model->ig_lambda) {
+      context->noise[k] = build_noise_table(model, context->levels[k], k);
+      if (!context->noise[k]) {
+        seqgen_kmer_context_free(context);
+        return NULL;
+      }
+    }
+  }
+
+  return context;
+}
+
+void seqgen_kmer_context_free(seqgen_kmer_context *context) {
+  if (!context) return;
 
+  int max_kmer_size = context->model ? context->model->kmer_size : 0;
+  for (int k = 1; k < max_kmer_size && k <= SEQGEN_KMER_MAX_SIZE; k++) {
+    free(context->mean[k]);
+    free(context->stddev[k]);
+  }
+  for (int k = 1; k <= SEQGEN_KMER_MAX_SIZE; k++) {
+    free(context->levels[k]);
+    free(context->noise[k]);
+  }
+  free_kmer_model(context->model);
+  free(context->model_id);
+  free(context);
+}
+
+// Contexts for callers that pass no context: one per model, created on first use
+// and kept for the life of the process so pointers handed out stay valid
+static seqgen_kmer_context **shared_contexts = NULL;
+static size_t shared_context_count = 0;
+static pthread_mutex_t shared_context_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const seqgen_kmer_context* get_shared_kmer_context(const char *models_dir, const char *model_name) {
+  char model_id[1024];
+  snprintf(model_id, sizeof(model_id), "%s/%s", models_dir, model_name);
+
+  seqgen_kmer_context *found = NULL;
+  pthread_mutex_lock(&shared_context_mutex);
+  for (size_t i = 0; i < shared_context_count; i++) {
+    if (strcmp(shared_contexts[i]->model_id, model_id) == 0) {
+      found = shared_contexts[i];
+      break;
+    }
+  }
+  if (!found) {
+    seqgen_kmer_context **grown = realloc(shared_contexts, (shared_context_count + 1) * sizeof(*grown));
+    if (grown) {
+      shared_contexts = grown;
+      found = seqgen_kmer_context_create(models_dir, model_name);
+      if (found) shared_contexts[shared_context_count++] = found;
+    }
+  }
+  pthread_mutex_unlock(&shared_context_mutex);
+  return found;
+}
+
+// Lookup table, kernels and per-row constants resolved once per read
+typedef struct {
+  const seqgen_kmer_level *levels;
+  const seqgen_kmer_noise *noise;
+  const kmer_kernels_t *kernels;
+  float dwell;
+  int kmer_size;
+} kmer_squiggle_tables_t;
+
+// Validate parameters and resolve the model context's tables for the requested k
+static bool resolve_kmer_tables(size_t n, const struct seqgen_model_params *params,
+                                kmer_squiggle_tables_t *tables) {
   // Extract k-mer model parameters
   const char *model_name = params->params.kmer.model_name;     // e.g., "dna_r10.4.1_e8.2_260bps"
   const char *models_dir = params->params.kmer.models_dir;     // base directory (default: "kmer_models")
@@ -70,165 +331,470 @@ seq_tensor* squiggle_kmer(int const * sequence, size_t n, bool transform_units,
   // Validate model k-mer size
   if (kmer_size <= 0 || kmer_size > 9) {
     warnx("K-mer size %d out of range [1-9]", kmer_size);
-    return NULL;
+    return false;
   }
 
   // Ensure sequence is long enough to extract at least one k-mer
   if (n < (size_t)kmer_size) {
     warnx("Sequence length %zu shorter than k-mer size %d", n, kmer_size);
-    return NULL;
+    return false;
   }
 
   // ========================================================================
-  // STEP 1: LOAD k-mer model file (with caching to avoid reloading)
+  // STEP 1: GET model context (caller's, or the shared one for this model)
   // ========================================================================
-  static kmer_model_t *cached_model = NULL;
-  static char cached_model_id[512] = {0};
-
-  char model_id[512];
-  snprintf(model_id, sizeof(model_id), "%s/%s", models_dir, model_name);
+  const seqgen_kmer_context *context = params->params.kmer.context;
+  if (!context) {
+    context = get_shared_kmer_context(models_dir, model_name);
+    if (!context) return false;
+  }
 
-  if (!cached_model || strcmp(cached_model_id, model_id) != 0) {
-    if (cached_model) {
-      free_kmer_model(cached_model);
-    }
-    cached_model = load_kmer_model(models_dir, model_name);
-    if (!cached_model) {
-      warnx("Failed to load k-mer model: %s", model_id);
-      return NULL;
-    }
-    strncpy(cached_model_id, model_id, sizeof(cached_model_id) - 1);
-    cached_model_id[sizeof(cached_model_id) - 1] = '\0';
+  // ========================================================================
+  // STEP 2: SELECT precomputed lookup table for the requested k-mer size
+  // ========================================================================
+  if (kmer_size > context->max_kmer_size) {
+    warnx("Requested k-mer size %d larger than loaded model size %d", kmer_size, context->max_kmer_size);
+    return false;
   }
+  tables->levels = context->levels[kmer_size];
+  tables->noise = context->noise[kmer_size];
+  tables->kernels = get_kmer_kernels(kmer_size);
+  tables->dwell = 10.0f * (sample_rate_khz / 4.0f);   // dwell time (scaled), we're assuming 400 bp/s translocation rate, hence 10 4-kHz samples per level
+  tables->kmer_size = kmer_size;
+  return true;
+}
 
-  int loaded_kmer_size = cached_model->kmer_size;
+// Resolve tables and allocate the [n_kmers × 3] output; NULL on failure
+static seq_tensor* begin_kmer_squiggle(size_t n, const struct seqgen_model_params *params,
+                                       kmer_squiggle_tables_t *tables) {
+  if (!resolve_kmer_tables(n, params, tables)) return NULL;
 
   // ========================================================================
-  // STEP 2: CREATE target k-mer lookup table (decimation if needed)
+  // STEP 3: ALLOCATE output tensor [num_sequence_kmers × 3]
   // ========================================================================
-  float *lookup_mean = NULL;
-  float *lookup_stddev = NULL;
-  int num_kmers = 1;
-  for (int i = 0; i < kmer_size; i++) num_kmers *= 4; // 4^kmer_size, # of desired kmer states
-
-  if (kmer_size == loaded_kmer_size) {
-    // Direct use - no decimation needed
-    lookup_mean = cached_model->level_mean;
-    lookup_stddev = cached_model->level_stddev;
-  } else if (kmer_size < loaded_kmer_size) {
-    // Decimate: average multiple k-mers from larger model
-    int decimation_factor = 1;
-    for (int i = 0; i < (loaded_kmer_size - kmer_size); i++) {
-      decimation_factor *= 4;
-    }
-
-    lookup_mean = calloc(num_kmers, sizeof(float));
-    if (cached_model->level_stddev) {
-      lookup_stddev = calloc(num_kmers, sizeof(float));
-    }
-
-    if (!lookup_mean || (cached_model->level_stddev && !lookup_stddev)) {
-      free(lookup_mean);
-      free(lookup_stddev);
-      return NULL;
-    }
+  size_t num_sequence_kmers = n - tables->kmer_size + 1;  // # of kmer signal points
+  size_t shape[2] = {num_sequence_kmers, 3};              // param: current, stddev, dwell
+  return seq_tensor_create_float_uninit(2, shape);        // make tensor w/ (ndim, dim sizes), every row is written
+}
 
-    // Average groups of k-mers
-    for (int k_idx = 0; k_idx < num_kmers; k_idx++) {
-      float sum_mean = 0.0f;
-      float sum_stddev = 0.0f;
-      int base_idx = k_idx * decimation_factor;
+seq_tensor* squiggle_kmer(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params) {
+  if (!sequence || !params) return NULL;
 
-      for (int i = 0; i < decimation_factor; i++) {
-        sum_mean += cached_model->level_mean[base_idx + i];
-        if (cached_model->level_stddev) {
-          sum_stddev += cached_model->level_stddev[base_idx + i];
-        }
-      }
+  kmer_squiggle_tables_t tables;
+  seq_tensor *result = begin_kmer_squiggle(n, params, &tables);
+  if (!result) return NULL;
 
-      lookup_mean[k_idx] = sum_mean / decimation_factor;
-      if (lookup_stddev) {
-        lookup_stddev[k_idx] = sum_stddev / decimation_factor;
-      }
+  // ========================================================================
+  // STEP 4: VALIDATE every base once, so the kernel never has to
+  // ========================================================================
+  for (size_t j = 0; j < n; j++) {
+    if (sequence[j] < 0 || sequence[j] > 3) {             // in case you have a wonky base number
+      seq_tensor_free(result);
+      warnx("Invalid base %d at position %zu", sequence[j], j);
+      return NULL;
     }
-  } else {
-    // kmer_size > loaded_kmer_size - not supported
-    warnx("Requested k-mer size %d larger than loaded model size %d", kmer_size, loaded_kmer_size);
-    return NULL;
   }
 
   // ========================================================================
-  // STEP 3: ALLOCATE output tensor [num_sequence_kmers × 3]
+  // STEP 5: PROCESS input sequence with a rolling k-mer index (O(1) per base)
   // ========================================================================
-  size_t num_sequence_kmers = n - kmer_size + 1;          // # of kmer signal points
-  size_t shape[2] = {num_sequence_kmers, 3};              // param: current, stddev, dwell
-  seq_tensor *result = seq_tensor_create_float(2, shape); // make tensor w/ (ndim, dim sizes)
-  if (!result) {
-    if (kmer_size != loaded_kmer_size) {
-      free(lookup_mean);
-      free(lookup_stddev);
-    }
-    return NULL;
+  uint64_t profile_start = SEQ_PROFILE_START();
+  tables.kernels->rows_int(sequence, n, tables.kmer_size, tables.levels, tables.dwell, seq_tensor_data_float(result));
+  SEQ_PROFILE_STOP(SEQ_PROFILE_KMER_LOOKUP, profile_start);
+
+  return result;
+}
+
+seq_tensor* squiggle_kmer_packed(const seq_packed *sequence, bool transform_units, const struct seqgen_model_params *params) {
+  if (!sequence || !params) return NULL;
+
+  kmer_squiggle_tables_t tables;
+  seq_tensor *result = begin_kmer_squiggle(sequence->length, params, &tables);
+  if (!result) return NULL;
+
+  // Packed bases are valid by construction, so the kernel is just shift-mask-lookup
+  uint64_t profile_start = SEQ_PROFILE_START();
+  tables.kernels->rows_packed(sequence, tables.kmer_size, tables.levels, tables.dwell, seq_tensor_data_float(result));
+  SEQ_PROFILE_STOP(SEQ_PROFILE_KMER_LOOKUP, profile_start);
+
+  return result;
+}
+
+// **********************************************************************
+// Fused K-mer Signal Generation (no squiggle intermediate)
+// **********************************************************************
+
+// Samples per k-mer level, computed exactly as squiggle_to_raw() derives them from the squiggle dwell
+static size_t kmer_samples_per_level(float dwell, float sample_rate_khz) {
+  return (size_t)ceil(dwell * (sample_rate_khz / 4.0f));
+}
+
+size_t kmer_signal_length(size_t n, const struct seqgen_model_params *params, float sample_rate_khz) {
+  int kmer_size = params->params.kmer.kmer_size;
+  if (kmer_size <= 0 || n < (size_t)kmer_size) return 0;
+
+  float dwell = 10.0f * (params->params.kmer.sample_rate_khz / 4.0f);
+  return (n - kmer_size + 1) * kmer_samples_per_level(dwell, sample_rate_khz);
+}
+
+int kmer_signal_packed(const seq_packed *sequence, const struct seqgen_model_params *params,
+                       float sample_rate_khz, seq_rng *rng,
+                       float *out, size_t capacity, size_t *num_samples) {
+  if (!sequence || !params || !out) return -1;
+
+  kmer_squiggle_tables_t tables;
+  if (!resolve_kmer_tables(sequence->length, params, &tables)) return -1;
+
+  const size_t per_level = kmer_samples_per_level(tables.dwell, sample_rate_khz);
+  const size_t total = seq_kmer_count(sequence->length, tables.kmer_size) * per_level;
+  if (total > capacity) {
+    warnx("Signal buffer too small: %zu samples needed, %zu available", total, capacity);
+    return -1;
   }
 
-  float *data = seq_tensor_data_float(result);            // assign size to tensor's data field
+  // Raw: unit noise for the whole read in one batch, then scaled per level in place
+  if (rng) {
+    uint64_t noise_start = SEQ_PROFILE_START();
+    seq_rng_fill_gaussian(rng, out, total);
+    SEQ_PROFILE_STOP(SEQ_PROFILE_NOISE, noise_start);
+  }
 
-  // ========================================================================
-  // STEP 4: PROCESS input sequence and generate squiggle tensor
-  // ========================================================================
-  for (size_t i = 0; i < num_sequence_kmers; i++) {       // loop over kmer equivalents in i/p seq
-    // Convert k-mer to index (base-4 encoding)
-    int kmer_index = 0;
-    for (int j = 0; j < kmer_size; j++) {
-      int base = sequence[i + j];
-      if (base < 0 || base > 3) {                         // in case you have a wonky base number
-        seq_tensor_free(result);
-        if (kmer_size != loaded_kmer_size) {
-          free(lookup_mean);
-          free(lookup_stddev);
-        }
-        warnx("Invalid base %d at position %zu", base, i + j);
-        return NULL;
+  uint64_t profile_start = SEQ_PROFILE_START();
+  seq_kmer_iter it;
+  uint32_t kmer_index;
+  float *run = out;
+  seq_kmer_iter_init(&it, sequence, tables.kmer_size);
+  while (seq_kmer_iter_next(&it, &kmer_index)) {
+    const seqgen_kmer_level level = tables.levels[kmer_index];
+    const float current = level.mean;
+    if (rng) {
+      const float stddev = level.stddev;
+      for (size_t j = 0; j < per_level; j++) {
+        run[j] = current + stddev * run[j];
       }
-      kmer_index = kmer_index * 4 + base;                 // compose # for kmer equivalent in i/p seq
+    } else {
+      for (size_t j = 0; j < per_level; j++) {
+        run[j] = current;
+      }
+    }
+    run += per_level;
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_KMER_LOOKUP, profile_start);
+
+  if (num_samples) *num_samples = total;
+  return 0;
+}
+
+// **********************************************************************
+// Stochastic K-mer Events
+// **********************************************************************
+
+static bool reserve_event_plan(seqgen_event_plan *plan, size_t num_events) {
+  if (num_events <= plan->capacity) return true;
+
+  float *current = realloc(plan->current, num_events * sizeof(float));
+  if (current) plan->current = current;
+  float *stddev = realloc(plan->stddev, num_events * sizeof(float));
+  if (stddev) plan->stddev = stddev;
+  uint32_t *samples = realloc(plan->samples, num_events * sizeof(uint32_t));
+  if (samples) plan->samples = samples;
+  bool ok = current && stddev && samples;
+  for (int i = 0; i < 3; i++) {
+    float *scratch = realloc(plan->scratch[i], num_events * sizeof(float));
+    if (scratch) plan->scratch[i] = scratch;
+    ok = ok && scratch;
+  }
+  if (!ok) {
+    warnx("Cannot allocate event plan for %zu events", num_events);
+    return false;
+  }
+  plan->capacity = num_events;
+  return true;
+}
+
+int kmer_plan_events(const seq_packed *sequence, const struct seqgen_model_params *params,
+                     float sample_rate_khz, float dwell_cv, seq_rng *rng, seqgen_event_plan *plan) {
+  if (!sequence || !params || !rng || !plan || dwell_cv < 0.0f) return -1;
+
+  kmer_squiggle_tables_t tables;
+  if (!resolve_kmer_tables(sequence->length, params, &tables)) return -1;
+
+  const size_t n = seq_kmer_count(sequence->length, tables.kmer_size);
+  if (!reserve_event_plan(plan, n)) return -1;
+  float *mu = plan->scratch[0];
+  float *lambda = plan->scratch[1];
+
+  // Table lookups first; the samplers below then run over flat per-event arrays
+  uint64_t profile_start = SEQ_PROFILE_START();
+  seq_kmer_iter it;
+  uint32_t kmer_index;
+  size_t e = 0;
+  seq_kmer_iter_init(&it, sequence, tables.kmer_size);
+  while (seq_kmer_iter_next(&it, &kmer_index)) {
+    const seqgen_kmer_level level = tables.levels[kmer_index];
+    plan->current[e] = level.mean;
+    plan->stddev[e] = level.stddev;
+    if (tables.noise) {
+      mu[e] = tables.noise[kmer_index].mean;
+      lambda[e] = tables.noise[kmer_index].lambda;
+    }
+    e++;
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_KMER_LOOKUP, profile_start);
+
+  uint64_t noise_start = SEQ_PROFILE_START();
+  if (tables.noise) {
+    // level_stdv spreads the event level; the noise within the event is a draw of its own
+    float *jitter = plan->scratch[2];
+    seq_rng_fill_gaussian(rng, jitter, n);
+    for (size_t i = 0; i < n; i++) {
+      plan->current[i] += plan->stddev[i] * jitter[i];
     }
+    seq_rng_fill_inverse_gaussian(rng, mu, lambda, plan->stddev, n);
+  }
 
-    // Populate row [current, stddev, dwell]
-    data[i * 3 + 0] = lookup_mean[kmer_index];            // current from (decimated) model
+  // Dwell in the squiggle's 4 kHz units, whole samples as squiggle_to_raw() counts them.
+  // A fixed dwell draws nothing, so the noise that follows matches kmer_signal_packed()
+  const float dwell_shape = dwell_cv > 0.0f ? tables.dwell / (dwell_cv * dwell_cv) : 0.0f;
+  for (size_t i = 0; i < n; i++) {
+    mu[i] = tables.dwell;
+    lambda[i] = dwell_shape;
+  }
+  float *dwell = mu;
+  if (dwell_cv > 0.0f) {
+    dwell = plan->scratch[2];
+    seq_rng_fill_inverse_gaussian(rng, mu, lambda, dwell, n);
+  }
 
-    if (lookup_stddev) {
-      data[i * 3 + 1] = lookup_stddev[kmer_index];        // stdev from (decimated) model
+  // Sampled dwells are whole squiggle units first; a fixed one (fractional away from
+  // 4 kHz, e.g. 12.5 at 5 kHz) is counted exactly as kmer_signal_packed() counts it
+  const float rate_scale = sample_rate_khz / 4.0f;
+  size_t total = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (dwell_cv > 0.0f) {
+      plan->samples[i] = (uint32_t)ceilf(fmaxf(1.0f, rintf(dwell[i])) * rate_scale);
     } else {
-      data[i * 3 + 1] = cached_model->default_stddev;     // stddev default value
+      plan->samples[i] = (uint32_t)kmer_samples_per_level(dwell[i], sample_rate_khz);
     }
+    total += plan->samples[i];
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_NOISE, noise_start);
+
+  plan->total_samples = total;
+  plan->num_events = n;
+  return 0;
+}
+
+void kmer_render_events(const seqgen_event_plan *plan, seq_rng *rng, float *out) {
+  if (!plan || !out) return;
 
-    data[i * 3 + 2] = 10.0f * (sample_rate_khz / 4.0f);   // dwell time (scaled), we're assuming 400 bp/s translocation rate, hence 10 4-kHz samples per level
+  // Same shape as kmer_signal_packed: one noise batch for the read, scaled per event
+  if (rng) {
+    uint64_t noise_start = SEQ_PROFILE_START();
+    seq_rng_fill_gaussian(rng, out, plan->total_samples);
+    SEQ_PROFILE_STOP(SEQ_PROFILE_NOISE, noise_start);
   }
 
-  // Clean up decimated lookup tables if we created them
-  if (kmer_size != loaded_kmer_size) {
-    free(lookup_mean);
-    free(lookup_stddev);
+  float *run = out;
+  for (size_t e = 0; e < plan->num_events; e++) {
+    const float current = plan->current[e];
+    const uint32_t count = plan->samples[e];
+    if (rng) {
+      const float stddev = plan->stddev[e];
+      for (uint32_t j = 0; j < count; j++) {
+        run[j] = current + stddev * run[j];
+      }
+    } else {
+      for (uint32_t j = 0; j < count; j++) {
+        run[j] = current;
+      }
+    }
+    run += count;
   }
+}
 
-  return result;
+void seqgen_event_plan_free(seqgen_event_plan *plan) {
+  if (!plan) return;
+  free(plan->current);
+  free(plan->stddev);
+  free(plan->samples);
+  for (int i = 0; i < 3; i++) {
+    free(plan->scratch[i]);
+  }
+  memset(plan, 0, sizeof(*plan));
 }
 
 // **********************************************************************
-// Neural Network Model Stubs (Future Implementation)
+// Neural Network Models
 // **********************************************************************
 
+const char* seqgen_neural_model_name(seqgen_model_type model_type) {
+  switch (model_type) {
+    case SEQGEN_MODEL_R9_4:     return "squiggle_r94";
+    case SEQGEN_MODEL_R9_4_RNA: return "squiggle_r94_rna";
+    case SEQGEN_MODEL_R10:      return "squiggle_r10";
+    default:                    return NULL;
+  }
+}
+
+// Networks for callers that pass no model: one per (weights file, int8), loaded
+// on first use and kept for the life of the process, like the k-mer contexts
+typedef struct {
+  char *path;
+  bool int8;
+  seq_nn_model *model;
+} shared_network_t;
+
+static shared_network_t *shared_networks = NULL;
+static size_t shared_network_count = 0;
+static pthread_mutex_t shared_network_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const seq_nn_model* get_shared_network(const char *path, bool int8) {
+  const seq_nn_model *found = NULL;
+  pthread_mutex_lock(&shared_network_mutex);
+  for (size_t i = 0; i < shared_network_count; i++) {
+    if (shared_networks[i].int8 == int8 && strcmp(shared_networks[i].path, path) == 0) {
+      found = shared_networks[i].model;
+      break;
+    }
+  }
+  if (!found) {
+    shared_network_t *grown = realloc(shared_networks, (shared_network_count + 1) * sizeof(*grown));
+    seq_nn_model *model = grown ? seq_nn_model_load(path) : NULL;
+    if (grown) shared_networks = grown;
+    if (model && int8 && !seq_nn_model_quantise(model)) {
+      seq_nn_model_free(model);
+      model = NULL;
+    }
+    char *key = model ? strdup(path) : NULL;
+    if (key) {
+      shared_networks[shared_network_count++] = (shared_network_t){key, int8, model};
+      found = model;
+    } else {
+      seq_nn_model_free(model);
+    }
+  }
+  pthread_mutex_unlock(&shared_network_mutex);
+  return found;
+}
+
+size_t seqgen_models_free_shared(void) {
+  size_t freed = 0;
+  pthread_mutex_lock(&shared_context_mutex);
+  for (size_t i = 0; i < shared_context_count; i++) {
+    seqgen_kmer_context_free(shared_contexts[i]);
+  }
+  freed += shared_context_count;
+  free(shared_contexts);
+  shared_contexts = NULL;
+  shared_context_count = 0;
+  pthread_mutex_unlock(&shared_context_mutex);
+
+  pthread_mutex_lock(&shared_network_mutex);
+  for (size_t i = 0; i < shared_network_count; i++) {
+    seq_nn_model_free(shared_networks[i].model);
+    free(shared_networks[i].path);
+  }
+  freed += shared_network_count;
+  free(shared_networks);
+  shared_networks = NULL;
+  shared_network_count = 0;
+  pthread_mutex_unlock(&shared_network_mutex);
+  return freed;
+}
+
+// The caller's network, or the shared one for its weights file
+static const seq_nn_model* resolve_network(const struct seqgen_model_params *params) {
+  const struct neural_gen_model_params *neural = &params->params.neural;
+  if (neural->model) return neural->model;
+
+  const char *name = seqgen_neural_model_name(params->model_type);
+  if (!neural->weights_path && !name) {
+    warnx("Model type %d is not a neural network model", params->model_type);
+    return NULL;
+  }
+  char path[1024];
+  if (neural->weights_path) {
+    snprintf(path, sizeof(path), "%s", neural->weights_path);
+  } else {
+    snprintf(path, sizeof(path), "%s/%s%s", neural->models_dir ? neural->models_dir : "kmer_models",
+             name, SEQGEN_NEURAL_WEIGHTS_EXTENSION);
+  }
+  return get_shared_network(path, neural->int8);
+}
+
+bool squiggle_neural_batch(const seq_packed *const *sequences, size_t count, bool transform_units,
+                           const struct seqgen_model_params *params, seq_tensor **squiggles) {
+  if (!sequences || !params || !squiggles) return false;
+  const seq_nn_model *network = resolve_network(params);
+  if (!network) return false;
+  if (seq_nn_model_outputs(network) != 3) {
+    warnx("Network \"%s\" has %zu outputs per base (a squiggle model needs 3)",
+          network->name, seq_nn_model_outputs(network));
+    return false;
+  }
+
+  // One forward pass for the whole batch
+  if (!seq_nn_forward(network, sequences, count, squiggles)) return false;
+
+  // Network units -> [current, stddev, dwell]; log outputs keep stddev and dwell positive
+  for (size_t r = 0; r < count; r++) {
+    float *data = seq_tensor_data_float(squiggles[r]);
+    size_t n = seq_tensor_dim(squiggles[r], 0);
+    for (size_t i = 0; i < n; i++) {
+      float *row = data + i * 3;
+      row[1] = expf(row[1]);
+      row[2] = expf(row[2]);
+      if (transform_units) {
+        row[0] = row[0] * network->current_scale + network->current_offset;
+        row[1] *= network->current_scale;
+      }
+    }
+  }
+  return true;
+}
+
+// One read through the batched path (the dispatcher's int-per-base interface)
+static seq_tensor* squiggle_neural(int const *sequence, size_t n, bool transform_units,
+                                   const struct seqgen_model_params *params) {
+  if (!sequence || !params) {
+    warnx("Invalid parameters to neural squiggle model");
+    return NULL;
+  }
+  seq_packed *packed = calloc(1, sizeof(seq_packed));
+  uint8_t *data = calloc((n + 3) / 4 + 1, 1);
+  if (!packed || !data) {
+    free(packed);
+    free(data);
+    return NULL;
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (sequence[i] < 0 || sequence[i] > 3) {
+      warnx("Invalid base code %d at position %zu", sequence[i], i);
+      free(packed);
+      free(data);
+      return NULL;
+    }
+    data[i >> 2] |= (uint8_t)(sequence[i] << (6 - 2 * (i & 3)));
+  }
+  packed->data = data;
+  packed->length = n;
+
+  const seq_packed *batch[1] = {packed};
+  seq_tensor *squiggle = NULL;
+  squiggle_neural_batch(batch, 1, transform_units, params, &squiggle);
+  seq_packed_free(packed);
+  return squiggle;
+}
+
 seq_tensor* squiggle_r94(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params) {
-  warnx("Neural network model R9.4 not yet implemented in sequelizer");
-  return NULL;
+  return squiggle_neural(sequence, n, transform_units, params);
 }
 
 seq_tensor* squiggle_r94_rna(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params) {
-  warnx("Neural network model R9.4 RNA not yet implemented in sequelizer");
-  return NULL;
+  return squiggle_neural(sequence, n, transform_units, params);
 }
 
 seq_tensor* squiggle_r10(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params) {
-  warnx("Neural network model R10 not yet implemented in sequelizer");
-  return NULL;
+  return squiggle_neural(sequence, n, transform_units, params);
 }
@@ -11,6 +11,10 @@ Dispatcher pattern for signal generation models. Allows different model
 #define SEQGEN_MODELS_H
 
 #include "seq_tensor.h"
+#include "seq_nn.h"
+#include "kmer_model_loader.h"
+#include "seq_packed.h"
+#include "seq_rng.h"
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -31,16 +35,64 @@ typedef enum {
 // Model Parameters
 // **********************************************************************
 
+// Largest k-mer size a model context keeps lookup tables for
+#define SEQGEN_KMER_MAX_SIZE 9
+
+// One k-mer's level: mean and stddev side by side, so a lookup touches one cache line
+// (a 9-mer table is 2 MB interleaved instead of two 1 MB arrays read at the same index)
+typedef struct {
+  float mean;
+  float stddev;
+} seqgen_kmer_level;
+
+// One k-mer's within-event noise level distribution, IG(mean, lambda), from a legacy
+// model's sd_mean and ig_lambda (lambda 0: always mean, the k-mer's level stddev)
+typedef struct {
+  float mean;
+  float lambda;
+} seqgen_kmer_noise;
+
+// Loaded k-mer model plus its lookup tables for every usable k (1..model k).
+// Built once by seqgen_kmer_context_create() and read-only afterwards, so one
+// context can be shared by any number of threads; several may coexist.
+typedef struct seqgen_kmer_context {
+  char *model_id;                           // "<models_dir>/<model_name>"
+  kmer_model_t *model;
+  int max_kmer_size;                        // k of the loaded model
+  float *mean[SEQGEN_KMER_MAX_SIZE + 1];    // mean[k]: 4^k levels (mean[max] aliases the model)
+  float *stddev[SEQGEN_KMER_MAX_SIZE + 1];  // NULL when the model has no per-k-mer stddev
+  seqgen_kmer_level *levels[SEQGEN_KMER_MAX_SIZE + 1];  // levels[k]: both, default_stddev filled in (64-byte aligned)
+  seqgen_kmer_noise *noise[SEQGEN_KMER_MAX_SIZE + 1];   // NULL when the model has no sd_mean/ig_lambda
+  float default_stddev;
+} seqgen_kmer_context;
+
+// Load a model and precompute its decimated tables; NULL on failure
+seqgen_kmer_context* seqgen_kmer_context_create(const char *models_dir, const char *model_name);
+void seqgen_kmer_context_free(seqgen_kmer_context *context);
+
+// Free the process-wide k-mer contexts and networks that calls without a preloaded
+// model fill on first use; returns how many were freed. Only safe while no such
+// call is running (pointers they handed out die). Services holding their own
+// models (seq_context.h) never need this
+size_t seqgen_models_free_shared(void);
+
 // USE k-mer model (may differ from LOAD k-mer model in kmer_model_loader.h by chosen k-mer size)
 struct kmer_gen_model_params {
   const char *model_name;     // e.g., "dna_r10.4.1_e8.2_260bps"
   const char *models_dir;     // base directory (default: "kmer_models")
   int kmer_size;              // k-mer size: CAN CHOOSE if not > kmer_size of model you LOAD (5, 6, or 9)
   float sample_rate_khz;      // Default: 4.0
+  const seqgen_kmer_context *context;  // Preloaded model (NULL: looked up/loaded by models_dir/model_name)
 };
 
+// Neural squiggle models run a seq_nn network (.sqnn weights, see seq_nn.h)
+#define SEQGEN_NEURAL_WEIGHTS_EXTENSION ".sqnn"
+
 struct neural_gen_model_params {
-  int placeholder;            // for future use
+  const char *weights_path;   // Network file (NULL: "<models_dir>/<model>.sqnn", e.g. squiggle_r10.sqnn)
+  const char *models_dir;     // base directory for the default weights (default: "kmer_models")
+  bool int8;                  // Quantise float weights to INT8 when the network is loaded here
+  const seq_nn_model *model;  // Preloaded network (NULL: looked up/loaded from the weights file, shared)
 };
 
 struct seqgen_model_params {
@@ -80,12 +132,60 @@ seqgen_func_ptr get_seqgen_func(const seqgen_model_type model_type);
 // Model-Specific Functions
 // **********************************************************************
 
-// Neural network implementations (future)
+// Neural network implementations (one read; see squiggle_neural_batch)
 seq_tensor* squiggle_r94(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params);
 seq_tensor* squiggle_r94_rna(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params);
 seq_tensor* squiggle_r10(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params);
 
+// Neural squiggles for count reads in one batched forward pass (one GEMM per
+// layer covers all of them): squiggles[r] becomes [length × 3] [current, stddev,
+// dwell], in pA when transform_units. False (all NULL) on failure. A read's
+// squiggle matches running it alone up to float rounding (INT8 networks
+// quantise activations per batch tile, so slightly more)
+bool squiggle_neural_batch(const seq_packed *const *sequences, size_t count, bool transform_units,
+                           const struct seqgen_model_params *params, seq_tensor **squiggles);
+
+// Default weights file name for a neural model type ("squiggle_r10"), NULL for others
+const char* seqgen_neural_model_name(seqgen_model_type model_type);
+
 // K-mer lookup implementation
 seq_tensor* squiggle_kmer(int const * sequence, size_t n, bool transform_units, const struct seqgen_model_params * params);
 
+// K-mer lookup on a 2-bit packed sequence (what sequence_to_squiggle uses for k-mer models)
+seq_tensor* squiggle_kmer_packed(const seq_packed *sequence, bool transform_units, const struct seqgen_model_params *params);
+
+// Fused k-mer signal generation straight from the packed sequence (no [n_kmers × 3]
+// squiggle): kmer_signal_length() is the exact sample count for a sequence of n
+// bases; kmer_signal_packed() writes raw samples (rng != NULL, Gaussian noise from
+// rng) or event samples (rng == NULL) into out[capacity]. Returns 0 or -1.
+size_t kmer_signal_length(size_t n, const struct seqgen_model_params *params, float sample_rate_khz);
+int    kmer_signal_packed(const seq_packed *sequence, const struct seqgen_model_params *params,
+                          float sample_rate_khz, seq_rng *rng,
+                          float *out, size_t capacity, size_t *num_samples);
+
+// Stochastic k-mer events: per event, a dwell drawn from IG(nominal dwell,
+// nominal dwell / dwell_cv^2) and, for models with sd_mean/ig_lambda, a level drawn
+// from N(level_mean, level_stdv) and a noise level from IG(sd_mean, ig_lambda);
+// other models keep the table level and stddev. Sampled a whole read at a time,
+// so total_samples is known before any signal buffer is allocated
+typedef struct {
+  float *current;            // Event level
+  float *stddev;             // Within-event noise level
+  uint32_t *samples;         // Samples at the output rate (at least 1)
+  size_t num_events;
+  size_t total_samples;
+
+  float *scratch[3];         // Sampler parameters and draws
+  size_t capacity;
+} seqgen_event_plan;
+
+// Sample plan (zero-initialised before first use, reusable) for a packed sequence
+// from rng; dwell_cv 0 keeps the nominal dwell and draws nothing for it, so a
+// model without noise tables then renders exactly as kmer_signal_packed(). Returns 0 or -1
+int  kmer_plan_events(const seq_packed *sequence, const struct seqgen_model_params *params,
+                      float sample_rate_khz, float dwell_cv, seq_rng *rng, seqgen_event_plan *plan);
+// Write plan's raw samples (rng != NULL) or event samples (rng == NULL) into out[plan->total_samples]
+void kmer_render_events(const seqgen_event_plan *plan, seq_rng *rng, float *out);
+void seqgen_event_plan_free(seqgen_event_plan *plan);
+
 #endif // SEQGEN_MODELS_H
@@ -7,38 +7,13 @@
 #include "seqgen_models.h"
 #include "seq_tensor.h"
 #include "seq_utils.h"
+#include "seq_profile.h"
 #include "../../include/sequelizer.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <err.h>
 
-// **********************************************************************
-// Gaussian Random Number Generator
-// **********************************************************************
-
-double gaussian_random(void) {
-  static int has_spare = 0;
-  static double spare;
-
-  if (has_spare) {
-      has_spare = 0;
-      return spare;
-  }
-
-  has_spare = 1;
-  double u, v, s;
-  do {
-      u = (rand() / ((double)RAND_MAX)) * 2.0 - 1.0;
-      v = (rand() / ((double)RAND_MAX)) * 2.0 - 1.0;
-      s = u * u + v * v;
-  } while (s >= 1.0 || s == 0.0);
-
-  s = sqrt(-2.0 * log(s) / s);
-  spare = v * s;
-  return u * s;
-}
-
 // **********************************************************************
 // Sequence to Squiggle Conversion (High-Level Wrapper)
 // **********************************************************************
@@ -50,19 +25,44 @@ seq_tensor* sequence_to_squiggle(const char *sequence, size_t length, bool resca
     return NULL;
   }
 
-  int *encoded = calloc(length, sizeof(int));
+  // Pack A,C,G,T -> 0,1,2,3 at 2 bits per base (rejects any other character)
+  seq_packed *packed = seq_pack(sequence, length);
+  if (!packed) {
+    return NULL;
+  }
+
+  seq_tensor *squiggle = packed_to_squiggle(packed, rescale, params);
+  seq_packed_free(packed);
+  return squiggle;
+}
+
+seq_tensor* packed_to_squiggle(const seq_packed *packed, bool rescale, const struct seqgen_model_params *params) {
+  if (!packed || !params) {
+    warnx("Invalid parameters to packed_to_squiggle");
+    return NULL;
+  }
+
+  // K-mer models read the packed bases directly with a rolling k-mer index
+  if (params->model_type == SEQGEN_MODEL_KMER) {
+    return squiggle_kmer_packed(packed, rescale, params);
+  }
+
+  // Neural models take packed reads too (a batch of one)
+  if (seqgen_neural_model_name(params->model_type)) {
+    seq_tensor *squiggle = NULL;
+    squiggle_neural_batch(&packed, 1, rescale, params, &squiggle);
+    return squiggle;
+  }
+
+  // Other models take one int per base through the dispatcher
+  size_t length = packed->length;
+  int *encoded = calloc(length ? length : 1, sizeof(int));
   if (!encoded) {
     warnx("Failed to allocate memory for sequence encoding");
     return NULL;
   }
-  // Encode A,C,G,T -> 0,1,2,3
   for (size_t i = 0; i < length; i++) {
-    encoded[i] = base_to_int(sequence[i], true);
-    if (encoded[i] < 0) {
-      warnx("Invalid base '%c' at position %zu", sequence[i], i);
-      free(encoded);
-      return NULL;
-    }
+    encoded[i] = (int)seq_packed_base(packed, i);
   }
 
   // Get appropriate model function via dispatcher
@@ -82,16 +82,128 @@ seq_tensor* sequence_to_squiggle(const char *sequence, size_t length, bool resca
   return squiggle;
 }
 
+// **********************************************************************
+// Fused Sequence to Signal Generation
+// **********************************************************************
+
+size_t predict_signal_length(size_t length, const struct seqgen_model_params *params, float sample_rate_khz) {
+  if (!params || params->model_type != SEQGEN_MODEL_KMER) return 0;
+  return kmer_signal_length(length, params, sample_rate_khz);
+}
+
+// Models without a fused path: squiggle, then the two-pass conversion
+static seq_tensor* signal_via_squiggle(const char *sequence, size_t length, bool rescale,
+                                       const struct seqgen_model_params *params,
+                                       float sample_rate_khz, seq_rng *rng) {
+  seq_tensor *squiggle = sequence_to_squiggle(sequence, length, rescale, params);
+  if (!squiggle) return NULL;
+  seq_tensor *signal = rng ? squiggle_to_raw(squiggle, sample_rate_khz, rng)
+                           : squiggle_to_event(squiggle, sample_rate_khz);
+  seq_tensor_free(squiggle);
+  return signal;
+}
+
+int sequence_to_signal_into(const char *sequence, size_t length, bool rescale,
+                            const struct seqgen_model_params *params, float sample_rate_khz,
+                            seq_rng *rng, float *out, size_t capacity, size_t *num_samples) {
+  if (!sequence || !params || !out) {
+    warnx("Invalid parameters to sequence_to_signal_into");
+    return -1;
+  }
+
+  seq_packed *packed = seq_pack(sequence, length);
+  if (!packed) return -1;
+  int status = packed_to_signal_into(packed, rescale, params, sample_rate_khz, rng, out, capacity, num_samples);
+  seq_packed_free(packed);
+  return status;
+}
+
+int packed_to_signal_into(const seq_packed *packed, bool rescale,
+                          const struct seqgen_model_params *params, float sample_rate_khz,
+                          seq_rng *rng, float *out, size_t capacity, size_t *num_samples) {
+  if (!packed || !params || !out) {
+    warnx("Invalid parameters to packed_to_signal_into");
+    return -1;
+  }
+
+  if (params->model_type == SEQGEN_MODEL_KMER) {
+    return kmer_signal_packed(packed, params, sample_rate_khz, rng, out, capacity, num_samples);
+  }
+
+  // Models without a fused path: squiggle, then the two-pass conversion
+  seq_tensor *squiggle = packed_to_squiggle(packed, rescale, params);
+  if (!squiggle) return -1;
+  seq_tensor *signal = rng ? squiggle_to_raw(squiggle, sample_rate_khz, rng)
+                           : squiggle_to_event(squiggle, sample_rate_khz);
+  seq_tensor_free(squiggle);
+  if (!signal) return -1;
+
+  size_t n = seq_tensor_dim(signal, 0);
+  int status = (n <= capacity) ? 0 : -1;
+  if (status == 0) {
+    memcpy(out, seq_tensor_data_float(signal), n * sizeof(float));
+    if (num_samples) *num_samples = n;
+  }
+  seq_tensor_free(signal);
+  return status;
+}
+
+// Allocate [predicted × 1] and fill it in one pass
+static seq_tensor* sequence_to_signal(const char *sequence, size_t length, bool rescale,
+                                      const struct seqgen_model_params *params,
+                                      float sample_rate_khz, seq_rng *rng) {
+  if (!sequence || !params) {
+    warnx("Invalid parameters to sequence_to_signal");
+    return NULL;
+  }
+  if (params->model_type != SEQGEN_MODEL_KMER) {
+    return signal_via_squiggle(sequence, length, rescale, params, sample_rate_khz, rng);
+  }
+
+  seq_packed *packed = seq_pack(sequence, length);
+  if (!packed) return NULL;
+
+  size_t shape[2] = {kmer_signal_length(length, params, sample_rate_khz), 1};
+  seq_tensor *signal = seq_tensor_create_float_uninit(2, shape);  // every sample is written
+  if (!signal ||
+      kmer_signal_packed(packed, params, sample_rate_khz, rng,
+                         seq_tensor_data_float(signal), shape[0], NULL) < 0) {
+    seq_tensor_free(signal);
+    signal = NULL;
+  }
+  seq_packed_free(packed);
+  return signal;
+}
+
+seq_tensor* sequence_to_raw(const char *sequence, size_t length, bool rescale,
+                            const struct seqgen_model_params *params,
+                            float sample_rate_khz, seq_rng *rng) {
+  if (!rng) {
+    warnx("sequence_to_raw requires a random stream");
+    return NULL;
+  }
+  return sequence_to_signal(sequence, length, rescale, params, sample_rate_khz, rng);
+}
+
+seq_tensor* sequence_to_event(const char *sequence, size_t length, bool rescale,
+                              const struct seqgen_model_params *params, float sample_rate_khz) {
+  return sequence_to_signal(sequence, length, rescale, params, sample_rate_khz, NULL);
+}
+
 // **********************************************************************
 // Squiggle to Raw Signal Conversion
 // **********************************************************************
 
-seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz) {
+seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz, seq_rng *rng) {
   // Validate input
   if (!squiggle || squiggle->ndim != 2 || squiggle->shape[1] != 3) {
     warnx("Invalid squiggle tensor (expected [n × 3])");
     return NULL;
   }
+  if (!rng) {
+    warnx("squiggle_to_raw requires a random stream");
+    return NULL;
+  }
 
   float *squiggle_data = seq_tensor_data_float((seq_tensor*)squiggle);
   size_t num_events = squiggle->shape[0];
@@ -107,7 +219,7 @@ seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz) {
 
   // Create output tensor [total_samples × 1]
   size_t shape[2] = {total_samples, 1};
-  seq_tensor *raw = seq_tensor_create_float(2, shape);
+  seq_tensor *raw = seq_tensor_create_float_uninit(2, shape);  // overwritten by the noise fill
   if (!raw) {
     warnx("Failed to allocate raw signal tensor");
     return NULL;
@@ -115,7 +227,11 @@ seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz) {
 
   float *raw_data = seq_tensor_data_float(raw);
 
-  // Generate raw signal with Gaussian noise
+  // Draw unit Gaussian noise for the whole read in one batch
+  uint64_t profile_start = SEQ_PROFILE_START();
+  seq_rng_fill_gaussian(rng, raw_data, total_samples);
+
+  // Scale and shift each dwell run to its event's current level
   size_t sample_idx = 0;
   for (size_t i = 0; i < num_events; i++) {
     float current = squiggle_data[i * 3 + 0];
@@ -123,13 +239,14 @@ seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz) {
     float dwell = squiggle_data[i * 3 + 2];
 
     size_t num_samples = (size_t)ceil(dwell * (sample_rate_khz / 4.0f));
+    float *restrict run = raw_data + sample_idx;
 
-    // Generate noisy samples for this event
-    for (size_t j = 0; j < num_samples && sample_idx < total_samples; j++) {
-      raw_data[sample_idx] = current + stddev * gaussian_random();
-      sample_idx++;
+    for (size_t j = 0; j < num_samples; j++) {
+      run[j] = current + stddev * run[j];
     }
+    sample_idx += num_samples;
   }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_NOISE, profile_start);
 
   return raw;
 }
@@ -158,7 +275,7 @@ seq_tensor* squiggle_to_event(const seq_tensor *squiggle, float sample_rate_khz)
 
   // Create output tensor [total_samples × 1]
   size_t shape[2] = {total_samples, 1};
-  seq_tensor *event = seq_tensor_create_float(2, shape);
+  seq_tensor *event = seq_tensor_create_float_uninit(2, shape);  // every sample is written
   if (!event) {
     warnx("Failed to allocate event signal tensor");
     return NULL;
@@ -183,3 +300,20 @@ seq_tensor* squiggle_to_event(const seq_tensor *squiggle, float sample_rate_khz)
 
   return event;
 }
+
+// **********************************************************************
+// Squiggle Event Alignment
+// **********************************************************************
+
+size_t squiggle_event_samples(const seq_tensor *squiggle, float sample_rate_khz, uint32_t *samples) {
+  const float *squiggle_data = seq_tensor_data_float((seq_tensor*)squiggle);
+  size_t num_events = squiggle->shape[0];
+  size_t total_samples = 0;
+  for (size_t i = 0; i < num_events; i++) {
+    // Same rounding as squiggle_to_raw(), so the runs tile its output exactly
+    size_t num_samples = (size_t)ceil(squiggle_data[i * 3 + 2] * (sample_rate_khz / 4.0f));
+    samples[i] = (uint32_t)num_samples;
+    total_samples += num_samples;
+  }
+  return total_samples;
+}
@@ -16,6 +16,7 @@ Shared utilities for signal generation from DNA sequences, used by both
 
 #include "seq_tensor.h"
 #include "seqgen_models.h"
+#include "seq_rng.h"
 #include <stdbool.h>
 
 // Generate squiggle from DNA/RNA sequence (high-level wrapper)
@@ -27,13 +28,39 @@ seq_tensor* sequence_to_squiggle(
   const struct seqgen_model_params *params
 );
 
-// Convert squiggle to raw signal with Gaussian noise
-seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz);
+// Same from an already packed sequence or view (e.g. a window of a sampled reference)
+seq_tensor* packed_to_squiggle(const seq_packed *packed, bool rescale, const struct seqgen_model_params *params);
+
+// Fused sequence -> signal (k-mer models skip the [n_kmers × 3] squiggle and
+// write samples directly; other models go through sequence_to_squiggle).
+// Output is identical to squiggle_to_raw/_event of sequence_to_squiggle.
+// predict_signal_length: exact sample count for k-mer models (0 if unknown)
+size_t predict_signal_length(size_t length, const struct seqgen_model_params *params, float sample_rate_khz);
+
+// Returns a new [n_samples × 1] tensor, NULL on failure
+seq_tensor* sequence_to_raw(const char *sequence, size_t length, bool rescale,
+                            const struct seqgen_model_params *params,
+                            float sample_rate_khz, seq_rng *rng);
+seq_tensor* sequence_to_event(const char *sequence, size_t length, bool rescale,
+                              const struct seqgen_model_params *params, float sample_rate_khz);
+
+// Into a caller-provided buffer (raw when rng != NULL, event otherwise); 0 or -1
+int sequence_to_signal_into(const char *sequence, size_t length, bool rescale,
+                            const struct seqgen_model_params *params, float sample_rate_khz,
+                            seq_rng *rng, float *out, size_t capacity, size_t *num_samples);
+int packed_to_signal_into(const seq_packed *packed, bool rescale,
+                          const struct seqgen_model_params *params, float sample_rate_khz,
+                          seq_rng *rng, float *out, size_t capacity, size_t *num_samples);
+
+// Convert squiggle to raw signal with Gaussian noise drawn from rng
+// (the caller's stream, so output is reproducible per (seed, stream) and reentrant)
+seq_tensor* squiggle_to_raw(const seq_tensor *squiggle, float sample_rate_khz, seq_rng *rng);
 
 // Convert squiggle to event signal (piecewise constant, no noise)
 seq_tensor* squiggle_to_event(const seq_tensor *squiggle, float sample_rate_khz);
 
-// Gaussian random number generator
-double gaussian_random(void);
+// Samples each squiggle event occupies in squiggle_to_raw/_event output (the dwell
+// column at sample_rate_khz), written to samples[n_kmers]; returns their total
+size_t squiggle_event_samples(const seq_tensor *squiggle, float sample_rate_khz, uint32_t *samples);
 
 #endif // SEQUELIZER_SEQGEN_UTILS_H
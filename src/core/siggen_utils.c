@@ -3,6 +3,8 @@
 // **********************************************************************
 // Sebastian Claudiusz Magierowski Nov 12 2025
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -122,21 +124,28 @@ ciren_matrix sequence_to_squiggle(const char *base_seq, size_t n, bool rescale,
   return squiggle;
 }
 
-// Implement Box-Muller transform for Gaussian random numbers
-double gaussian_random(void) {
-  static int has_spare = 0;
-  static double spare;
+// Implement Box-Muller transform for Gaussian random numbers. Each thread
+// draws from its own stream (and keeps its own spare), never from rand()
+static _Thread_local bool gaussian_seeded = false;
+static _Thread_local seq_rng gaussian_rng;
+static _Thread_local bool has_spare = false;
+static _Thread_local double spare;
 
+double gaussian_random(void) {
   if (has_spare) {
-    has_spare = 0;
+    has_spare = false;
     return spare;
   }
+  if (!gaussian_seeded) {
+    seq_rng_init(&gaussian_rng, seq_rng_entropy_seed(), (uint64_t)(uintptr_t)&gaussian_rng);
+    gaussian_seeded = true;
+  }
 
-  has_spare = 1;
-  static double u, v, s;
+  has_spare = true;
+  double u, v, s;
   do {
-    u = (rand() / ((double) RAND_MAX)) * 2.0 - 1.0;
-    v = (rand() / ((double) RAND_MAX)) * 2.0 - 1.0;
+    u = seq_rng_uniform(&gaussian_rng) * 2.0 - 1.0;
+    v = seq_rng_uniform(&gaussian_rng) * 2.0 - 1.0;
     s = u * u + v * v;
   } while (s >= 1.0 || s == 0.0);
 
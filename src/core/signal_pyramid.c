@@ -0,0 +1,279 @@
+// **********************************************************************
+// core/signal_pyramid.c - Multi-Resolution Min/Max Signal Pyramids
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "signal_pyramid.h"
+#include <err.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Sidecar layout (host byte order; it is a local cache, not an exchange format):
+//   header: magic[8], int64 mtime, int64 size       (of the Fast5 file)
+//   record: uint32 id_length, id, uint64 signal_length,
+//           per level: uint64 length, int16 min[length], int16 max[length]
+static const char PYRAMID_MAGIC[8] = {'S', 'Q', 'P', 'Y', 'R', '0', '1', '\n'};
+
+// **********************************************************************
+// Construction
+// **********************************************************************
+size_t signal_pyramid_bucket_size(int level) {
+  size_t size = SIGNAL_PYRAMID_FACTOR;
+  for (int l = 0; l < level; l++) size *= SIGNAL_PYRAMID_FACTOR;
+  return size;
+}
+
+static signal_pyramid_t* allocate_pyramid(size_t signal_length, const size_t *lengths) {
+  signal_pyramid_t *pyramid = calloc(1, sizeof(signal_pyramid_t));
+  if (!pyramid) return NULL;
+  pyramid->signal_length = signal_length;
+  for (int l = 0; l < SIGNAL_PYRAMID_LEVELS; l++) {
+    pyramid->length[l] = lengths[l];
+    pyramid->min[l] = malloc((lengths[l] ? lengths[l] : 1) * sizeof(int16_t));
+    pyramid->max[l] = malloc((lengths[l] ? lengths[l] : 1) * sizeof(int16_t));
+    if (!pyramid->min[l] || !pyramid->max[l]) {
+      signal_pyramid_free(pyramid);
+      return NULL;
+    }
+  }
+  return pyramid;
+}
+
+signal_pyramid_t* signal_pyramid_build(const int16_t *signal, size_t signal_length) {
+  if (!signal || signal_length == 0) return NULL;
+
+  size_t lengths[SIGNAL_PYRAMID_LEVELS];
+  for (int l = 0; l < SIGNAL_PYRAMID_LEVELS; l++) {
+    size_t bucket = signal_pyramid_bucket_size(l);
+    lengths[l] = (signal_length + bucket - 1) / bucket;
+  }
+  signal_pyramid_t *pyramid = allocate_pyramid(signal_length, lengths);
+  if (!pyramid) return NULL;
+
+  // Level 0 from the samples, each further level from the one below it
+  for (size_t b = 0; b < lengths[0]; b++) {
+    size_t first = b * SIGNAL_PYRAMID_FACTOR;
+    size_t last = first + SIGNAL_PYRAMID_FACTOR < signal_length ? first + SIGNAL_PYRAMID_FACTOR : signal_length;
+    int16_t lo = signal[first], hi = signal[first];
+    for (size_t i = first + 1; i < last; i++) {
+      if (signal[i] < lo) lo = signal[i];
+      if (signal[i] > hi) hi = signal[i];
+    }
+    pyramid->min[0][b] = lo;
+    pyramid->max[0][b] = hi;
+  }
+  for (int l = 1; l < SIGNAL_PYRAMID_LEVELS; l++) {
+    const int16_t *below_min = pyramid->min[l - 1], *below_max = pyramid->max[l - 1];
+    for (size_t b = 0; b < lengths[l]; b++) {
+      size_t first = b * SIGNAL_PYRAMID_FACTOR;
+      size_t last = first + SIGNAL_PYRAMID_FACTOR < lengths[l - 1] ? first + SIGNAL_PYRAMID_FACTOR : lengths[l - 1];
+      int16_t lo = below_min[first], hi = below_max[first];
+      for (size_t i = first + 1; i < last; i++) {
+        if (below_min[i] < lo) lo = below_min[i];
+        if (below_max[i] > hi) hi = below_max[i];
+      }
+      pyramid->min[l][b] = lo;
+      pyramid->max[l][b] = hi;
+    }
+  }
+  return pyramid;
+}
+
+void signal_pyramid_free(signal_pyramid_t *pyramid) {
+  if (!pyramid) return;
+  for (int l = 0; l < SIGNAL_PYRAMID_LEVELS; l++) {
+    free(pyramid->min[l]);
+    free(pyramid->max[l]);
+  }
+  free(pyramid);
+}
+
+// **********************************************************************
+// Window Queries
+// **********************************************************************
+int signal_pyramid_level_for(size_t samples_per_column) {
+  int level = -1;
+  for (int l = 0; l < SIGNAL_PYRAMID_LEVELS && signal_pyramid_bucket_size(l) <= samples_per_column; l++) {
+    level = l;
+  }
+  return level;
+}
+
+size_t signal_pyramid_window(const signal_pyramid_t *pyramid, int level, size_t start, size_t count,
+                             size_t columns, int16_t *column_min, int16_t *column_max) {
+  if (!pyramid || level < 0 || level >= SIGNAL_PYRAMID_LEVELS || columns == 0) return 0;
+  if (start >= pyramid->signal_length) return 0;
+  if (count > pyramid->signal_length - start) count = pyramid->signal_length - start;
+  if (columns > count) columns = count;
+
+  size_t bucket = signal_pyramid_bucket_size(level);
+  const int16_t *lo = pyramid->min[level], *hi = pyramid->max[level];
+  for (size_t c = 0; c < columns; c++) {
+    size_t first = start + count * c / columns;
+    size_t last = start + count * (c + 1) / columns;
+    size_t b = first / bucket, b_end = (last + bucket - 1) / bucket;
+    if (b_end <= b) b_end = b + 1;
+    if (b_end > pyramid->length[level]) b_end = pyramid->length[level];
+
+    int16_t column_lo = lo[b], column_hi = hi[b];
+    for (size_t i = b + 1; i < b_end; i++) {
+      if (lo[i] < column_lo) column_lo = lo[i];
+      if (hi[i] > column_hi) column_hi = hi[i];
+    }
+    column_min[c] = column_lo;
+    column_max[c] = column_hi;
+  }
+  return columns;
+}
+
+// **********************************************************************
+// Sidecar Cache
+// **********************************************************************
+char* signal_pyramid_sidecar_path(const char *fast5_path) {
+  if (!fast5_path) return NULL;
+  size_t len = strlen(fast5_path);
+  char *path = malloc(len + sizeof(SIGNAL_PYRAMID_SIDECAR_SUFFIX));
+  if (!path) return NULL;
+  memcpy(path, fast5_path, len);
+  memcpy(path + len, SIGNAL_PYRAMID_SIDECAR_SUFFIX, sizeof(SIGNAL_PYRAMID_SIDECAR_SUFFIX));
+  return path;
+}
+
+static bool fast5_stat(const char *fast5_path, int64_t *mtime, int64_t *size) {
+  struct stat st;
+  if (stat(fast5_path, &st) != 0) return false;
+  *mtime = (int64_t)st.st_mtime;
+  *size = (int64_t)st.st_size;
+  return true;
+}
+
+// Open a sidecar whose header matches the Fast5 file's current stat; NULL otherwise
+static FILE* open_valid_sidecar(const char *sidecar, const char *fast5_path) {
+  int64_t mtime, size, cached_mtime, cached_size;
+  if (!fast5_stat(fast5_path, &mtime, &size)) return NULL;
+
+  FILE *in = fopen(sidecar, "rb");
+  if (!in) return NULL;
+  char magic[sizeof(PYRAMID_MAGIC)];
+  if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, PYRAMID_MAGIC, sizeof(magic)) != 0 ||
+      fread(&cached_mtime, sizeof(cached_mtime), 1, in) != 1 || fread(&cached_size, sizeof(cached_size), 1, in) != 1 ||
+      cached_mtime != mtime || cached_size != size) {
+    fclose(in);
+    return NULL;
+  }
+  return in;
+}
+
+signal_pyramid_t* signal_pyramid_load(const char *fast5_path, const char *read_id) {
+  if (!fast5_path || !read_id) return NULL;
+  char *sidecar = signal_pyramid_sidecar_path(fast5_path);
+  FILE *in = sidecar ? open_valid_sidecar(sidecar, fast5_path) : NULL;
+  free(sidecar);
+  if (!in) return NULL;
+
+  signal_pyramid_t *found = NULL;
+  size_t id_capacity = strlen(read_id) + 1;
+  char *id = malloc(id_capacity);
+  uint32_t id_length;
+  uint64_t signal_length;
+
+  while (id && !found && fread(&id_length, sizeof(id_length), 1, in) == 1) {
+    bool match = id_length + 1 == id_capacity;
+    if (match) {
+      if (fread(id, 1, id_length, in) != id_length) break;
+      match = memcmp(id, read_id, id_length) == 0;
+    } else if (fseek(in, (long)id_length, SEEK_CUR) != 0) {
+      break;
+    }
+    if (fread(&signal_length, sizeof(signal_length), 1, in) != 1) break;
+
+    uint64_t lengths[SIGNAL_PYRAMID_LEVELS];
+    signal_pyramid_t *pyramid = NULL;
+    bool ok = true;
+    for (int l = 0; ok && l < SIGNAL_PYRAMID_LEVELS; l++) {
+      ok = fread(&lengths[l], sizeof(lengths[l]), 1, in) == 1;
+      if (!ok) break;
+      if (!match) {
+        ok = fseek(in, (long)(lengths[l] * 2 * sizeof(int16_t)), SEEK_CUR) == 0;
+        continue;
+      }
+      if (l == 0) {
+        size_t expected[SIGNAL_PYRAMID_LEVELS];
+        for (int k = 0; k < SIGNAL_PYRAMID_LEVELS; k++) {
+          size_t bucket = signal_pyramid_bucket_size(k);
+          expected[k] = (size_t)((signal_length + bucket - 1) / bucket);
+        }
+        pyramid = allocate_pyramid((size_t)signal_length, expected);
+        if (!pyramid) ok = false;
+      }
+      ok = ok && lengths[l] == pyramid->length[l] &&
+           fread(pyramid->min[l], sizeof(int16_t), lengths[l], in) == lengths[l] &&
+           fread(pyramid->max[l], sizeof(int16_t), lengths[l], in) == lengths[l];
+    }
+    if (!ok) {
+      signal_pyramid_free(pyramid);
+      break;
+    }
+    found = pyramid;
+  }
+
+  free(id);
+  fclose(in);
+  return found;
+}
+
+int signal_pyramid_save(const char *fast5_path, const char *read_id, const signal_pyramid_t *pyramid) {
+  if (!fast5_path || !read_id || !pyramid) return -1;
+  int64_t mtime, size;
+  if (!fast5_stat(fast5_path, &mtime, &size)) return -1;
+
+  char *sidecar = signal_pyramid_sidecar_path(fast5_path);
+  if (!sidecar) return -1;
+
+  // Rewrite through a temporary file so readers never see a partial record;
+  // records of a still-valid sidecar are carried over, a stale one is dropped
+  char tmp_path[PATH_MAX];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", sidecar);
+  FILE *out = fopen(tmp_path, "wb");
+  if (!out) {
+    warnx("Cannot create pyramid cache: %s", tmp_path);
+    free(sidecar);
+    return -1;
+  }
+
+  bool ok = fwrite(PYRAMID_MAGIC, 1, sizeof(PYRAMID_MAGIC), out) == sizeof(PYRAMID_MAGIC) &&
+            fwrite(&mtime, sizeof(mtime), 1, out) == 1 && fwrite(&size, sizeof(size), 1, out) == 1;
+
+  FILE *in = ok ? open_valid_sidecar(sidecar, fast5_path) : NULL;
+  if (in) {
+    char buffer[1 << 16];
+    size_t got;
+    while (ok && (got = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+      ok = fwrite(buffer, 1, got, out) == got;
+    }
+    fclose(in);
+  }
+
+  uint32_t id_length = (uint32_t)strlen(read_id);
+  uint64_t signal_length = pyramid->signal_length;
+  ok = ok && fwrite(&id_length, sizeof(id_length), 1, out) == 1 && fwrite(read_id, 1, id_length, out) == id_length &&
+       fwrite(&signal_length, sizeof(signal_length), 1, out) == 1;
+  for (int l = 0; ok && l < SIGNAL_PYRAMID_LEVELS; l++) {
+    uint64_t length = pyramid->length[l];
+    ok = fwrite(&length, sizeof(length), 1, out) == 1 &&
+         fwrite(pyramid->min[l], sizeof(int16_t), length, out) == length &&
+         fwrite(pyramid->max[l], sizeof(int16_t), length, out) == length;
+  }
+
+  if (fclose(out) != 0 || !ok || rename(tmp_path, sidecar) != 0) {
+    warnx("Cannot write pyramid cache: %s", sidecar);
+    remove(tmp_path);
+    free(sidecar);
+    return -1;
+  }
+  free(sidecar);
+  return 0;
+}
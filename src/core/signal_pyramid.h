@@ -0,0 +1,52 @@
+// **********************************************************************
+// core/signal_pyramid.h - Multi-Resolution Min/Max Signal Pyramids
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// A decimation ladder over a read's int16 samples: level l keeps the min and
+// max of every SIGNAL_PYRAMID_FACTOR^(l+1) consecutive samples (1/16, 1/256,
+// 1/4096). Drawing any window at screen resolution then touches at most a few
+// thousand buckets of the coarsest level that is still finer than one pixel,
+// never the full signal. Pyramids are cached per Fast5 file in a binary
+// "<file>.pyr" sidecar, invalidated by the Fast5 file's mtime/size.
+#ifndef SEQUELIZER_SIGNAL_PYRAMID_H
+#define SEQUELIZER_SIGNAL_PYRAMID_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIGNAL_PYRAMID_FACTOR 16
+#define SIGNAL_PYRAMID_LEVELS 3
+#define SIGNAL_PYRAMID_SIDECAR_SUFFIX ".pyr"
+
+typedef struct {
+  size_t signal_length;
+  size_t length[SIGNAL_PYRAMID_LEVELS];   // Buckets per level (the last bucket may be partial)
+  int16_t *min[SIGNAL_PYRAMID_LEVELS];
+  int16_t *max[SIGNAL_PYRAMID_LEVELS];
+} signal_pyramid_t;
+
+// Construction and cleanup
+signal_pyramid_t* signal_pyramid_build(const int16_t *signal, size_t signal_length);
+void              signal_pyramid_free(signal_pyramid_t *pyramid);
+
+// Samples per bucket at a level (16, 256, 4096)
+size_t signal_pyramid_bucket_size(int level);
+
+// Coarsest level whose buckets are no wider than samples_per_column; -1 if even
+// level 0 is too coarse (the caller should read the samples themselves)
+int signal_pyramid_level_for(size_t samples_per_column);
+
+// Min/max of [start, start + count) in `columns` equal columns using one level
+// (column edges snap to that level's buckets); returns the number of columns written
+size_t signal_pyramid_window(const signal_pyramid_t *pyramid, int level, size_t start, size_t count,
+                             size_t columns, int16_t *column_min, int16_t *column_max);
+
+// Sidecar cache: "<fast5_path>.pyr" (caller must free the returned path)
+char*             signal_pyramid_sidecar_path(const char *fast5_path);
+signal_pyramid_t* signal_pyramid_load(const char *fast5_path, const char *read_id);          // NULL if absent/stale
+int               signal_pyramid_save(const char *fast5_path, const char *read_id,
+                                      const signal_pyramid_t *pyramid);                     // 0 or -1
+
+#endif // SEQUELIZER_SIGNAL_PYRAMID_H
@@ -0,0 +1,632 @@
+// **********************************************************************
+// core/slow5_writer.c - SLOW5/BLOW5 Output with Random-Access Index
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+#include "slow5_writer.h"
+#include <err.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#ifdef SEQUELIZER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define SLOW5_VERSION_MAJOR 0
+#define SLOW5_VERSION_MINOR 2
+#define SLOW5_VERSION_PATCH 0
+#define SLOW5_VERSION_STRING "0.2.0"
+
+#define BLOW5_HEADER_SIZE 64       // Fixed part, zero padded (then the text header)
+#define SLOW5_INDEX_HEADER_SIZE 64
+
+static const char BLOW5_MAGIC[] = {'B', 'L', 'O', 'W', '5', '\1'};
+static const char BLOW5_EOF[] = {'5', 'W', 'O', 'L', 'B'};
+static const char SLOW5_INDEX_MAGIC[] = {'S', 'L', 'O', 'W', '5', 'I', 'D', 'X', '\1'};
+static const char SLOW5_INDEX_EOF[] = {'X', 'D', 'I', 'W', 'O', 'L', 'S'};
+
+// Column types and names: primary fields, then the auxiliary fields we fill
+static const char SLOW5_COLUMN_TYPES[] =
+  "#char*\tuint32_t\tdouble\tdouble\tdouble\tdouble\tuint64_t\tint16_t*"
+  "\tchar*\tdouble\tint32_t\tuint64_t\n";
+static const char SLOW5_COLUMN_NAMES[] =
+  "#read_id\tread_group\tdigitisation\toffset\trange\tsampling_rate\tlen_raw_signal\traw_signal"
+  "\tchannel_number\tmedian_before\tread_number\tstart_time\n";
+
+// **********************************************************************
+// Option Parsing
+// **********************************************************************
+bool slow5_zstd_available(void) {
+#ifdef SEQUELIZER_HAVE_ZSTD
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool slow5_parse_format(const char *name, slow5_format_t *format) {
+  if (!name) return false;
+  if (strcmp(name, "slow5") == 0) {
+    *format = SLOW5_FORMAT_ASCII;
+  } else if (strcmp(name, "blow5") == 0) {
+    *format = SLOW5_FORMAT_BINARY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool slow5_parse_record_compression(const char *name, slow5_record_compression_t *compression) {
+  if (!name) return false;
+  if (strcmp(name, "none") == 0) {
+    *compression = SLOW5_RECORD_NONE;
+  } else if (strcmp(name, "zlib") == 0) {
+    *compression = SLOW5_RECORD_ZLIB;
+  } else if (strcmp(name, "zstd") == 0 && slow5_zstd_available()) {
+    *compression = SLOW5_RECORD_ZSTD;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool slow5_parse_signal_compression(const char *name, slow5_signal_compression_t *compression) {
+  if (!name) return false;
+  if (strcmp(name, "none") == 0) {
+    *compression = SLOW5_SIGNAL_NONE;
+  } else if (strcmp(name, "svb-zd") == 0) {
+    *compression = SLOW5_SIGNAL_SVB_ZD;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// **********************************************************************
+// Byte Buffer
+// **********************************************************************
+void slow5_buffer_free(slow5_buffer_t *buffer) {
+  if (!buffer) return;
+  free(buffer->data);
+  buffer->data = NULL;
+  buffer->size = 0;
+  buffer->capacity = 0;
+}
+
+// Room for n more bytes; NULL on allocation failure
+static uint8_t* buffer_reserve(slow5_buffer_t *buffer, size_t n) {
+  if (buffer->capacity - buffer->size < n) {
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity - buffer->size < n) capacity *= 2;
+    uint8_t *grown = realloc(buffer->data, capacity);
+    if (!grown) return NULL;
+    buffer->data = grown;
+    buffer->capacity = capacity;
+  }
+  return buffer->data + buffer->size;
+}
+
+static bool buffer_append(slow5_buffer_t *buffer, const void *data, size_t n) {
+  uint8_t *p = buffer_reserve(buffer, n);
+  if (!p) return false;
+  memcpy(p, data, n);
+  buffer->size += n;
+  return true;
+}
+
+static bool buffer_str(slow5_buffer_t *buffer, const char *s) {
+  return buffer_append(buffer, s, strlen(s));
+}
+
+// Little-endian fixed-width integers (BLOW5 is little-endian on every host)
+static bool buffer_le(slow5_buffer_t *buffer, uint64_t value, size_t bytes) {
+  uint8_t *p = buffer_reserve(buffer, bytes);
+  if (!p) return false;
+  for (size_t i = 0; i < bytes; i++) {
+    p[i] = (uint8_t)(value >> (8 * i));
+  }
+  buffer->size += bytes;
+  return true;
+}
+
+static bool buffer_double_le(slow5_buffer_t *buffer, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return buffer_le(buffer, bits, sizeof(bits));
+}
+
+// Decimal text: hand-rolled, the signal column is most of a SLOW5 file
+static bool buffer_uint_text(slow5_buffer_t *buffer, uint64_t value) {
+  char digits[20];
+  size_t n = 0;
+  do {
+    digits[n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+  uint8_t *p = buffer_reserve(buffer, n);
+  if (!p) return false;
+  for (size_t i = 0; i < n; i++) {
+    p[i] = (uint8_t)digits[n - 1 - i];
+  }
+  buffer->size += n;
+  return true;
+}
+
+static bool buffer_int_text(slow5_buffer_t *buffer, int64_t value) {
+  if (value < 0) {
+    if (!buffer_append(buffer, "-", 1)) return false;
+    return buffer_uint_text(buffer, (uint64_t)0 - (uint64_t)value);
+  }
+  return buffer_uint_text(buffer, (uint64_t)value);
+}
+
+// Shortest "%g" text that reads back as the same double
+static bool buffer_double_text(slow5_buffer_t *buffer, double value) {
+  char text[32];
+  for (int precision = 6; precision <= 17; precision++) {
+    snprintf(text, sizeof(text), "%.*g", precision, value);
+    if (strtod(text, NULL) == value) break;
+  }
+  return buffer_str(buffer, text);
+}
+
+// **********************************************************************
+// Header
+// **********************************************************************
+struct slow5_header {
+  uint32_t num_groups;
+  size_t num_keys;
+  char **keys;             // Attribute names in first-set order
+  char ***values;          // values[group][key] (NULL = unset)
+};
+
+slow5_header_t* slow5_header_create(void) {
+  return calloc(1, sizeof(slow5_header_t));
+}
+
+void slow5_header_free(slow5_header_t *header) {
+  if (!header) return;
+  for (uint32_t g = 0; g < header->num_groups; g++) {
+    for (size_t k = 0; k < header->num_keys; k++) {
+      free(header->values[g][k]);
+    }
+    free(header->values[g]);
+  }
+  for (size_t k = 0; k < header->num_keys; k++) {
+    free(header->keys[k]);
+  }
+  free(header->values);
+  free(header->keys);
+  free(header);
+}
+
+uint32_t slow5_header_add_group(slow5_header_t *header) {
+  char ***values = realloc(header->values, (header->num_groups + 1) * sizeof(char**));
+  if (values) {
+    header->values = values;
+    header->values[header->num_groups] = calloc(header->num_keys ? header->num_keys : 1, sizeof(char*));
+  }
+  if (!values || !header->values[header->num_groups]) {
+    warnx("Memory allocation failed for SLOW5 header");
+    return SLOW5_NO_GROUP;
+  }
+  return header->num_groups++;
+}
+
+uint32_t slow5_header_num_groups(const slow5_header_t *header) {
+  return header ? header->num_groups : 0;
+}
+
+// Header values are tab- and newline-delimited: anything else is kept as is
+static bool is_header_text(const char *s) {
+  return s[0] != '\0' && strpbrk(s, "\t\n\r") == NULL;
+}
+
+int slow5_header_set(slow5_header_t *header, uint32_t group, const char *key, const char *value) {
+  if (!header || group >= header->num_groups || !key || !value) return -1;
+  if (!is_header_text(key) || !is_header_text(value)) return -1;
+
+  size_t k = 0;
+  while (k < header->num_keys && strcmp(header->keys[k], key) != 0) k++;
+  if (k == header->num_keys) {
+    // New key: every group gains an (unset) slot for it
+    char **keys = realloc(header->keys, (header->num_keys + 1) * sizeof(char*));
+    if (!keys) return -1;
+    header->keys = keys;
+    for (uint32_t g = 0; g < header->num_groups; g++) {
+      char **row = realloc(header->values[g], (header->num_keys + 1) * sizeof(char*));
+      if (!row) return -1;
+      row[header->num_keys] = NULL;
+      header->values[g] = row;
+    }
+    header->keys[k] = strdup(key);
+    if (!header->keys[k]) return -1;
+    header->num_keys++;
+  }
+
+  char *copy = strdup(value);
+  if (!copy) return -1;
+  free(header->values[group][k]);
+  header->values[group][k] = copy;
+  return 0;
+}
+
+// "@key\tvalue0\tvalue1...\n" lines followed by the column type and name lines
+static bool header_text(const slow5_header_t *header, slow5_buffer_t *buffer) {
+  bool ok = true;
+  for (size_t k = 0; k < header->num_keys && ok; k++) {
+    ok = buffer_str(buffer, "@") && buffer_str(buffer, header->keys[k]);
+    for (uint32_t g = 0; g < header->num_groups && ok; g++) {
+      const char *value = header->values[g][k];
+      ok = buffer_str(buffer, "\t") && buffer_str(buffer, value ? value : ".");
+    }
+    ok = ok && buffer_str(buffer, "\n");
+  }
+  return ok && buffer_str(buffer, SLOW5_COLUMN_TYPES) && buffer_str(buffer, SLOW5_COLUMN_NAMES);
+}
+
+// **********************************************************************
+// Record Encoding
+// **********************************************************************
+
+// svb-zd: zigzag-encoded deltas (starting from 0), StreamVByte packed: a uint32
+// value count, 2-bit byte-length codes (four per control byte), then the
+// little-endian value bytes
+static bool encode_svb_zd(const int16_t *signal, uint64_t length, slow5_buffer_t *buffer) {
+  if (length > UINT32_MAX) return false;
+  size_t control_bytes = (size_t)((length + 3) / 4);
+  uint8_t *out = buffer_reserve(buffer, 4 + control_bytes + 4 * (size_t)length);
+  if (!out) return false;
+
+  for (size_t i = 0; i < 4; i++) {
+    out[i] = (uint8_t)(length >> (8 * i));
+  }
+  uint8_t *control = out + 4;
+  uint8_t *data = control + control_bytes;
+  memset(control, 0, control_bytes);
+
+  int32_t previous = 0;
+  for (size_t i = 0; i < length; i++) {
+    int32_t delta = (int32_t)signal[i] - previous;
+    previous = signal[i];
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+    uint32_t code = zigzag < (1u << 8) ? 0 : zigzag < (1u << 16) ? 1 : zigzag < (1u << 24) ? 2 : 3;
+    control[i >> 2] |= (uint8_t)(code << ((i & 3) * 2));
+    for (uint32_t b = 0; b <= code; b++) {
+      *data++ = (uint8_t)(zigzag >> (8 * b));
+    }
+  }
+  buffer->size += (size_t)(data - out);
+  return true;
+}
+
+static bool encode_text(const slow5_record_t *record, slow5_buffer_t *buffer) {
+  bool ok = buffer_str(buffer, record->read_id) && buffer_str(buffer, "\t") &&
+            buffer_uint_text(buffer, record->read_group) && buffer_str(buffer, "\t") &&
+            buffer_double_text(buffer, record->digitisation) && buffer_str(buffer, "\t") &&
+            buffer_double_text(buffer, record->offset) && buffer_str(buffer, "\t") &&
+            buffer_double_text(buffer, record->range) && buffer_str(buffer, "\t") &&
+            buffer_double_text(buffer, record->sampling_rate) && buffer_str(buffer, "\t") &&
+            buffer_uint_text(buffer, record->signal_length) && buffer_str(buffer, "\t");
+
+  // Samples are comma-separated ("." for an empty signal)
+  if (ok && record->signal_length == 0) ok = buffer_str(buffer, ".");
+  for (uint64_t i = 0; i < record->signal_length && ok; i++) {
+    if (i > 0) ok = buffer_append(buffer, ",", 1);
+    ok = ok && buffer_int_text(buffer, record->signal[i]);
+  }
+
+  ok = ok && buffer_str(buffer, "\t") && buffer_str(buffer, record->channel_number ? record->channel_number : ".");
+  ok = ok && buffer_str(buffer, "\t");
+  ok = ok && (record->has_median_before ? buffer_double_text(buffer, record->median_before) : buffer_str(buffer, "."));
+  ok = ok && buffer_str(buffer, "\t");
+  ok = ok && (record->has_read_number ? buffer_int_text(buffer, record->read_number) : buffer_str(buffer, "."));
+  ok = ok && buffer_str(buffer, "\t");
+  ok = ok && (record->has_start_time ? buffer_uint_text(buffer, record->start_time) : buffer_str(buffer, "."));
+  return ok && buffer_str(buffer, "\n");
+}
+
+// Uncompressed binary record body; missing auxiliary values use the SLOW5
+// sentinels (empty string, NaN, INT32_MAX, UINT64_MAX)
+static bool encode_binary_body(const slow5_options_t *options, const slow5_record_t *record,
+                               slow5_buffer_t *buffer) {
+  size_t id_length = strlen(record->read_id);
+  if (id_length > UINT16_MAX) return false;
+
+  bool ok = buffer_le(buffer, id_length, 2) && buffer_append(buffer, record->read_id, id_length) &&
+            buffer_le(buffer, record->read_group, 4) &&
+            buffer_double_le(buffer, record->digitisation) &&
+            buffer_double_le(buffer, record->offset) &&
+            buffer_double_le(buffer, record->range) &&
+            buffer_double_le(buffer, record->sampling_rate) &&
+            buffer_le(buffer, record->signal_length, 8);
+  if (!ok) return false;
+
+  if (options->signal_compression == SLOW5_SIGNAL_SVB_ZD) {
+    ok = encode_svb_zd(record->signal, record->signal_length, buffer);
+  } else {
+    uint8_t *p = buffer_reserve(buffer, (size_t)record->signal_length * 2);
+    ok = p != NULL;
+    for (uint64_t i = 0; i < record->signal_length && ok; i++) {
+      uint16_t sample = (uint16_t)record->signal[i];
+      p[2 * i] = (uint8_t)sample;
+      p[2 * i + 1] = (uint8_t)(sample >> 8);
+    }
+    if (ok) buffer->size += (size_t)record->signal_length * 2;
+  }
+
+  size_t channel_length = record->channel_number ? strlen(record->channel_number) : 0;
+  ok = ok && buffer_le(buffer, channel_length, 8) &&
+       buffer_append(buffer, record->channel_number ? record->channel_number : "", channel_length);
+  ok = ok && buffer_double_le(buffer, record->has_median_before ? record->median_before : NAN);
+  ok = ok && buffer_le(buffer, (uint32_t)(record->has_read_number ? record->read_number : INT32_MAX), 4);
+  ok = ok && buffer_le(buffer, record->has_start_time ? record->start_time : UINT64_MAX, 8);
+  return ok;
+}
+
+// Compress body[0, size) onto buffer (which must not be the body's own buffer)
+static bool compress_record(slow5_record_compression_t compression, const uint8_t *body, size_t size,
+                            slow5_buffer_t *buffer) {
+  if (compression == SLOW5_RECORD_ZLIB) {
+    uLongf bound = compressBound((uLong)size);
+    uint8_t *out = buffer_reserve(buffer, bound);
+    if (!out || compress2(out, &bound, body, (uLong)size, Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+    buffer->size += bound;
+    return true;
+  }
+#ifdef SEQUELIZER_HAVE_ZSTD
+  if (compression == SLOW5_RECORD_ZSTD) {
+    size_t bound = ZSTD_compressBound(size);
+    uint8_t *out = buffer_reserve(buffer, bound);
+    if (!out) return false;
+    size_t written = ZSTD_compress(out, bound, body, size, ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(written)) return false;
+    buffer->size += written;
+    return true;
+  }
+#endif
+  return buffer_append(buffer, body, size);
+}
+
+int slow5_encode_record(const slow5_options_t *options, const slow5_record_t *record,
+                        slow5_buffer_t *buffer, size_t *record_size) {
+  if (!options || !record || !record->read_id || !buffer) return -1;
+  if (record->signal_length > 0 && !record->signal) return -1;
+  size_t start = buffer->size;
+
+  if (options->format == SLOW5_FORMAT_ASCII) {
+    if (!encode_text(record, buffer)) {
+      buffer->size = start;
+      return -1;
+    }
+  } else {
+    // uint64 record size, then the (compressed) record body
+    bool ok = buffer_le(buffer, 0, 8);
+    if (ok && options->record_compression == SLOW5_RECORD_NONE) {
+      ok = encode_binary_body(options, record, buffer);
+    } else if (ok) {
+      slow5_buffer_t body = {0};
+      ok = encode_binary_body(options, record, &body) &&
+           compress_record(options->record_compression, body.data, body.size, buffer);
+      slow5_buffer_free(&body);
+    }
+    if (!ok) {
+      buffer->size = start;
+      return -1;
+    }
+    uint64_t body_size = buffer->size - start - 8;
+    for (size_t i = 0; i < 8; i++) {
+      buffer->data[start + i] = (uint8_t)(body_size >> (8 * i));
+    }
+  }
+
+  if (record_size) *record_size = buffer->size - start;
+  return 0;
+}
+
+// **********************************************************************
+// Writer
+// **********************************************************************
+typedef struct {
+  size_t id_offset;        // Into ids
+  uint16_t id_length;
+  uint64_t offset;
+  uint64_t size;
+} index_entry_t;
+
+struct slow5_writer {
+  FILE *file;
+  char *filename;
+  slow5_options_t options;
+  uint64_t position;       // Bytes written so far
+  bool failed;
+
+  // Index entries, read ids packed back to back
+  index_entry_t *entries;
+  size_t num_entries;
+  size_t entries_capacity;
+  char *ids;
+  size_t ids_size;
+  size_t ids_capacity;
+};
+
+static bool writer_put(slow5_writer_t *writer, const void *data, size_t size) {
+  if (!writer->failed && size > 0 && fwrite(data, 1, size, writer->file) != size) {
+    writer->failed = true;
+  }
+  writer->position += size;
+  return !writer->failed;
+}
+
+static bool write_header(slow5_writer_t *writer, const slow5_header_t *header) {
+  slow5_buffer_t text = {0};
+  bool ok;
+
+  if (writer->options.format == SLOW5_FORMAT_ASCII) {
+    ok = buffer_str(&text, "#slow5_version\t" SLOW5_VERSION_STRING "\n#num_read_groups\t") &&
+         buffer_uint_text(&text, header->num_groups) && buffer_str(&text, "\n") &&
+         header_text(header, &text);
+  } else {
+    // Fixed 64-byte part, then the text header prefixed with its uint32 size
+    slow5_buffer_t fixed = {0};
+    ok = buffer_append(&fixed, BLOW5_MAGIC, sizeof(BLOW5_MAGIC)) &&
+         buffer_le(&fixed, SLOW5_VERSION_MAJOR, 1) && buffer_le(&fixed, SLOW5_VERSION_MINOR, 1) &&
+         buffer_le(&fixed, SLOW5_VERSION_PATCH, 1) &&
+         buffer_le(&fixed, writer->options.record_compression, 1) &&
+         buffer_le(&fixed, header->num_groups, 4) &&
+         buffer_le(&fixed, writer->options.signal_compression, 1);
+    uint8_t *padding = ok ? buffer_reserve(&fixed, BLOW5_HEADER_SIZE - fixed.size) : NULL;
+    if (padding) {
+      memset(padding, 0, BLOW5_HEADER_SIZE - fixed.size);
+      fixed.size = BLOW5_HEADER_SIZE;
+    }
+    slow5_buffer_t hdr = {0};
+    ok = padding && header_text(header, &hdr) && hdr.size <= UINT32_MAX &&
+         buffer_append(&text, fixed.data, fixed.size) && buffer_le(&text, hdr.size, 4) &&
+         buffer_append(&text, hdr.data, hdr.size);
+    slow5_buffer_free(&hdr);
+    slow5_buffer_free(&fixed);
+  }
+
+  ok = ok && writer_put(writer, text.data, text.size);
+  slow5_buffer_free(&text);
+  return ok;
+}
+
+slow5_writer_t* slow5_writer_open(const char *filename, const slow5_options_t *options,
+                                  const slow5_header_t *header) {
+  if (!filename || !options || !header || header->num_groups == 0) return NULL;
+
+  slow5_writer_t *writer = calloc(1, sizeof(slow5_writer_t));
+  if (!writer) {
+    warnx("Memory allocation failed for SLOW5 writer");
+    return NULL;
+  }
+  writer->options = *options;
+  if (writer->options.format == SLOW5_FORMAT_ASCII) {
+    writer->options.record_compression = SLOW5_RECORD_NONE;
+    writer->options.signal_compression = SLOW5_SIGNAL_NONE;
+  }
+
+  writer->filename = strdup(filename);
+  writer->file = fopen(filename, "wb");
+  if (!writer->filename || !writer->file) {
+    warnx("Cannot create output file: %s", filename);
+    if (writer->file) fclose(writer->file);
+    free(writer->filename);
+    free(writer);
+    return NULL;
+  }
+
+  if (!write_header(writer, header)) {
+    warnx("Failed to write SLOW5 header: %s", filename);
+    fclose(writer->file);
+    free(writer->filename);
+    free(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+int slow5_writer_write(slow5_writer_t *writer, const char *read_id, const void *record, size_t size) {
+  if (!writer || !read_id) return -1;
+  size_t id_length = strlen(read_id);
+  if (id_length > UINT16_MAX) return -1;
+
+  if (writer->num_entries == writer->entries_capacity) {
+    size_t capacity = writer->entries_capacity ? writer->entries_capacity * 2 : 4096;
+    index_entry_t *grown = realloc(writer->entries, capacity * sizeof(index_entry_t));
+    if (!grown) return -1;
+    writer->entries = grown;
+    writer->entries_capacity = capacity;
+  }
+  if (writer->ids_capacity - writer->ids_size < id_length) {
+    size_t capacity = writer->ids_capacity ? writer->ids_capacity : 4096 * 36;
+    while (capacity - writer->ids_size < id_length) capacity *= 2;
+    char *grown = realloc(writer->ids, capacity);
+    if (!grown) return -1;
+    writer->ids = grown;
+    writer->ids_capacity = capacity;
+  }
+
+  index_entry_t *entry = &writer->entries[writer->num_entries++];
+  entry->id_offset = writer->ids_size;
+  entry->id_length = (uint16_t)id_length;
+  entry->offset = writer->position;
+  entry->size = size;
+  memcpy(writer->ids + writer->ids_size, read_id, id_length);
+  writer->ids_size += id_length;
+
+  return writer_put(writer, record, size) ? 0 : -1;
+}
+
+size_t slow5_writer_records_written(const slow5_writer_t *writer) {
+  return writer ? writer->num_entries : 0;
+}
+
+// <filename>.idx: magic, version, padding to 64 bytes, then per record the
+// uint16 read_id length, read_id, uint64 offset and uint64 size; end marker
+static int write_index(const slow5_writer_t *writer) {
+  size_t path_length = strlen(writer->filename) + sizeof(".idx");
+  char *index_path = malloc(path_length);
+  if (!index_path) return -1;
+  snprintf(index_path, path_length, "%s.idx", writer->filename);
+
+  FILE *f = fopen(index_path, "wb");
+  if (!f) {
+    warnx("Cannot create index file: %s", index_path);
+    free(index_path);
+    return -1;
+  }
+
+  slow5_buffer_t out = {0};
+  bool ok = buffer_append(&out, SLOW5_INDEX_MAGIC, sizeof(SLOW5_INDEX_MAGIC)) &&
+            buffer_le(&out, SLOW5_VERSION_MAJOR, 1) && buffer_le(&out, SLOW5_VERSION_MINOR, 1) &&
+            buffer_le(&out, SLOW5_VERSION_PATCH, 1);
+  uint8_t *padding = ok ? buffer_reserve(&out, SLOW5_INDEX_HEADER_SIZE - out.size) : NULL;
+  ok = padding != NULL;
+  if (ok) {
+    memset(padding, 0, SLOW5_INDEX_HEADER_SIZE - out.size);
+    out.size = SLOW5_INDEX_HEADER_SIZE;
+  }
+  for (size_t i = 0; i < writer->num_entries && ok; i++) {
+    const index_entry_t *entry = &writer->entries[i];
+    ok = buffer_le(&out, entry->id_length, 2) &&
+         buffer_append(&out, writer->ids + entry->id_offset, entry->id_length) &&
+         buffer_le(&out, entry->offset, 8) && buffer_le(&out, entry->size, 8);
+  }
+  ok = ok && buffer_append(&out, SLOW5_INDEX_EOF, sizeof(SLOW5_INDEX_EOF));
+  ok = ok && fwrite(out.data, 1, out.size, f) == out.size;
+  if (fclose(f) != 0) ok = false;
+  if (!ok) {
+    warnx("Failed to write index file: %s", index_path);
+  }
+
+  slow5_buffer_free(&out);
+  free(index_path);
+  return ok ? 0 : -1;
+}
+
+int slow5_writer_close(slow5_writer_t *writer) {
+  if (!writer) return -1;
+
+  if (writer->options.format == SLOW5_FORMAT_BINARY) {
+    writer_put(writer, BLOW5_EOF, sizeof(BLOW5_EOF));
+  }
+  int status = writer->failed ? -1 : 0;
+  if (fclose(writer->file) != 0) status = -1;
+  if (status < 0) {
+    warnx("Failed to write output file: %s", writer->filename);
+  } else if (write_index(writer) < 0) {
+    status = -1;
+  }
+
+  free(writer->entries);
+  free(writer->ids);
+  free(writer->filename);
+  free(writer);
+  return status;
+}
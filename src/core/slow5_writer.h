@@ -0,0 +1,124 @@
+// **********************************************************************
+// core/slow5_writer.h - SLOW5/BLOW5 Output with Random-Access Index
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+//
+// Writer for the SLOW5 nanopore signal format (version 0.2.0): tab-separated
+// text (.slow5) or binary (.blow5), one record per read. BLOW5 records can be
+// compressed as a whole (zlib, or zstd when built with libzstd) and their
+// signal stored as svb-zd (zigzag delta + StreamVByte). The writer keeps the
+// byte offset and size of every record and writes <output>.idx on close, the
+// read_id -> record index slow5lib/slow5tools use for random access.
+//
+// Records are encoded into memory by slow5_encode_record(), which touches no
+// shared state, so many threads can encode while one writes them in order.
+#ifndef SEQUELIZER_SLOW5_WRITER_H
+#define SEQUELIZER_SLOW5_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  SLOW5_FORMAT_ASCII,      // .slow5
+  SLOW5_FORMAT_BINARY      // .blow5
+} slow5_format_t;
+
+// Values are the on-disk codes in the BLOW5 header. slow5lib reads both header
+// bytes through one press-method enum (none 0, zlib 1, svb-zd 2, zstd 3), so
+// the two enums share that numbering
+typedef enum {
+  SLOW5_RECORD_NONE = 0,
+  SLOW5_RECORD_ZLIB = 1,
+  SLOW5_RECORD_ZSTD = 3
+} slow5_record_compression_t;
+
+typedef enum {
+  SLOW5_SIGNAL_NONE = 0,
+  SLOW5_SIGNAL_SVB_ZD = 2
+} slow5_signal_compression_t;
+
+typedef struct {
+  slow5_format_t format;
+  slow5_record_compression_t record_compression;   // Binary only
+  slow5_signal_compression_t signal_compression;   // Binary only
+} slow5_options_t;
+
+// "slow5"/"blow5", "none"/"zlib"/"zstd", "none"/"svb-zd"; false for anything else
+// (zstd is rejected when the build has no libzstd)
+bool slow5_parse_format(const char *name, slow5_format_t *format);
+bool slow5_parse_record_compression(const char *name, slow5_record_compression_t *compression);
+bool slow5_parse_signal_compression(const char *name, slow5_signal_compression_t *compression);
+bool slow5_zstd_available(void);
+
+// **********************************************************************
+// Header (read groups and their attributes)
+// **********************************************************************
+
+// One read group per run; every group lists every attribute key ("." where unset)
+typedef struct slow5_header slow5_header_t;
+#define SLOW5_NO_GROUP UINT32_MAX
+
+slow5_header_t* slow5_header_create(void);
+void     slow5_header_free(slow5_header_t *header);
+uint32_t slow5_header_add_group(slow5_header_t *header); // New group's index; SLOW5_NO_GROUP out of memory
+uint32_t slow5_header_num_groups(const slow5_header_t *header);
+int      slow5_header_set(slow5_header_t *header, uint32_t group, const char *key, const char *value); // 0 or -1
+
+// **********************************************************************
+// Records
+// **********************************************************************
+
+// One read: the primary SLOW5 fields plus the channel_number, median_before,
+// read_number and start_time auxiliary fields (NULL / has_* false = missing)
+typedef struct {
+  const char *read_id;
+  uint32_t read_group;
+  double digitisation;
+  double offset;
+  double range;
+  double sampling_rate;
+  const int16_t *signal;
+  uint64_t signal_length;
+  const char *channel_number;
+  bool has_median_before;
+  double median_before;
+  bool has_read_number;
+  int32_t read_number;
+  bool has_start_time;
+  uint64_t start_time;
+} slow5_record_t;
+
+// Growable byte buffer the encoder appends to
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+} slow5_buffer_t;
+
+void slow5_buffer_free(slow5_buffer_t *buffer);
+
+// Append the record exactly as it goes on disk (text line, or size-prefixed
+// binary record); *record_size receives its length. 0 on success, -1 on failure
+int slow5_encode_record(const slow5_options_t *options, const slow5_record_t *record,
+                        slow5_buffer_t *buffer, size_t *record_size);
+
+// **********************************************************************
+// Writer
+// **********************************************************************
+typedef struct slow5_writer slow5_writer_t;
+
+// Create the file and write its header; NULL with a warning on failure
+slow5_writer_t* slow5_writer_open(const char *filename, const slow5_options_t *options,
+                                  const slow5_header_t *header);
+
+// Append size bytes of records produced by slow5_encode_record (one per read_id)
+int slow5_writer_write(slow5_writer_t *writer, const char *read_id, const void *record, size_t size);
+
+size_t slow5_writer_records_written(const slow5_writer_t *writer);
+
+// Finish the file (BLOW5 end-of-file marker), write <filename>.idx and free the
+// writer; 0 on success, -1 if any write failed
+int slow5_writer_close(slow5_writer_t *writer);
+
+#endif // SEQUELIZER_SLOW5_WRITER_H
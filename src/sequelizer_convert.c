@@ -7,32 +7,61 @@
 // cmake ..
 // cmake --build .
 // ./sequelizer convert --help
-// ./sequelizer convert input.fast5 --to metadata -o output.txt
+// ./sequelizer convert input.fast5 --to metadata -o output.tsv
 // ./sequelizer convert /path/to/fast5_files/ --to raw --recursive -o output.txt
 // ./sequelizer convert /Users/seb/Research/Scraps/scrappie_2016_11_28_73e3/reads/read_ch228_file118.fast5 --to raw -o signal.txt
 // ./sequelizer convert /Users/seb/Documents/GitHub/SquiggleFilter/data/lambda/fast5/FAL11227_e2243762ddcab66a4299cc8b21f76b3f66c41f01_0.fast5 --to raw -o signals/
 // ./sequelizer convert /Users/seb/Documents/GitHub/SquiggleFilter/data/lambda/fast5/FAL11227_e2243762ddcab66a4299cc8b21f76b3f66c41f01_0.fast5 --to raw -o signals/ --all
 // ./sequelizer convert /Users/seb/Documents/GitHub/slow5tools/test/data/ --to raw --recursive -o converted/
+// ./sequelizer convert /Users/seb/Documents/GitHub/slow5tools/test/data/ --recursive --to blow5 -o reads.blow5
 
 #include "sequelizer_convert.h"
 #include "core/fast5_io.h"
 #include "core/fast5_utils.h"
 #include "core/fast5_convert.h"
+#include "core/fast5_index.h"
 #include "core/util.h"
+#include "core/seq_profile.h"
+#include "core/seq_memory.h"
 #include <string.h>
 #include <sys/stat.h>
 #include <stdint.h>
 #include <sys/time.h>
 #include <argp.h>
 #include <err.h>
+#include <unistd.h>
 
 
 // **********************************************************************
 // Format Conversion Functions
 // **********************************************************************
 
-static int convert_to_raw(char **files, size_t file_count, const char *output_file, bool verbose, bool all_reads) {
-  return extract_raw_signals(files, file_count, output_file, all_reads, verbose);
+static int convert_to_raw(char **files, size_t file_count, const char *output_file, bool verbose, bool all_reads,
+                          seq_output_format format) {
+  return extract_raw_signals(files, file_count, output_file, all_reads, format, verbose);
+}
+
+// Default SLOW5/BLOW5 name: the input's base name with .fast5 (or a trailing /) replaced
+static void default_slow5_name(const char *input_path, slow5_format_t format, char *name, size_t size) {
+  size_t length = strlen(input_path);
+  while (length > 1 && input_path[length - 1] == '/') length--;
+  const char *base = input_path;
+  for (size_t i = 0; i < length; i++) {
+    if (input_path[i] == '/' && i + 1 < length) base = input_path + i + 1;
+  }
+  size_t base_length = (size_t)(input_path + length - base);
+  if (base_length > 6 && strncmp(base + base_length - 6, ".fast5", 6) == 0) base_length -= 6;
+  snprintf(name, size, "%.*s%s", (int)base_length, base, format == SLOW5_FORMAT_BINARY ? ".blow5" : ".slow5");
+}
+
+static int convert_to_slow5(char **files, size_t file_count, const char *input_path, const char *output_file,
+                            bool verbose, const slow5_options_t *options, int threads) {
+  char default_name[512];
+  if (!output_file) {
+    default_slow5_name(input_path, options->format, default_name, sizeof(default_name));
+    output_file = default_name;
+  }
+  return export_slow5(files, file_count, output_file, options, threads, verbose);
 }
 
 // **********************************************************************
@@ -43,28 +72,91 @@ static char doc[] = "sequelizer convert -- Extract raw signals from Fast5 files\
 "EXAMPLES:\n"
 "  sequelizer convert single.fast5 --to raw -o signal.txt\n"
 "  sequelizer convert multi.fast5 --to raw -o signals/\n"
-"  sequelizer convert multi.fast5 --to raw -o signals/ --all";
+"  sequelizer convert multi.fast5 --to raw -o signals/ --all\n"
+"  sequelizer convert fast5_dir/ --to raw --read-id READ_ID -o read.txt\n"
+"  sequelizer convert single.fast5 --to raw --format bin -o signal.bin\n"
+"  sequelizer convert fast5_dir/ --recursive --to blow5 -o reads.blow5   # writes reads.blow5.idx too\n"
+"  sequelizer convert multi.fast5 --to slow5 -o reads.slow5\n"
+"  sequelizer convert fast5_dir/ --to chunks --normalise -o chunks.f32   # writes chunks.f32.tsv too\n"
+"  sequelizer convert single_reads/ --to multi-read -o combined.fast5     # 4000 reads per file\n"
+"  sequelizer convert multi.fast5 --to single-read -o reads/\n"
+"  sequelizer convert multi.fast5 --recompress --compression 6 -o packed.fast5\n"
+"  sequelizer convert fast5_dir/ --to metadata --format csv --combine -o metadata.csv\n"
+"  sequelizer convert fast5_dir/ --to metadata --format bin-columnar -o metadata/   # one table per file";
 
 static char args_doc[] = "INPUT";
 
 static struct argp_option options[] = {
-  {"to",            't', "FORMAT",  0, "Output format: raw (default)"},
+  {"to",            't', "FORMAT",  0, "Output format: raw (default), slow5 or blow5 (all reads, one file plus .idx), chunks (float32 basecaller batches plus .tsv), multi-read or single-read (Fast5 repack), metadata (one row per read)"},
+  {"format",        'f', "ENCODING", 0, "Signal encoding: text (default) or bin (little-endian int16, no header); for --to metadata: tsv (default), csv, json or bin-columnar"},
   {"output",        'o', "FILE",    0, "Output file or directory"},
   {"all",           'a', 0,         0, "Extract all reads (default: first 3 for multi-read)"},
   {"recursive",     'r', 0,         0, "Search directories recursively"},
   {"verbose",       'v', 0,         0, "Show detailed information"},
+  {"read-id",       'i', "ID",      0, "Extract only this read (uses a read-id index; cached as " FAST5_INDEX_SIDECAR_NAME " for directories)"},
+  {"io-mode",        1,  "MODE",    0, "Fast5 read mode: posix (default), core (whole file into memory) or paged (large page reads, for remote/FUSE mounts)"},
+  {"page-size",      2,  "BYTES",   0, "Page size for --io-mode paged, allocation step for core (default: 262144)"},
+  {"prefetch",       3,  "PAGES",   0, "Pages read ahead on each paged-mode cache miss (default: 4)"},
+  {"compress",      'c', "METHOD",  0, "BLOW5 record compression: zlib (default), zstd (if built with libzstd) or none"},
+  {"sig-compress",  's', "METHOD",  0, "BLOW5 signal compression: svb-zd (default) or none"},
+  {"threads",        4,  "N",       0, "Worker threads for slow5/blow5, repack and metadata conversion, or for signal decompression otherwise (default: online CPUs)"},
+  {"chunk-size",     5,  "SAMPLES", 0, "Samples per window for --to chunks (default: 4000)"},
+  {"overlap",        6,  "SAMPLES", 0, "Samples shared by consecutive windows (default: 500)"},
+  {"batch-size",     7,  "N",       0, "Windows per batch; only complete batches are written (default: 64)"},
+  {"normalise",      8,  0,         0, "Scale each read to (pA - median) / (1.4826 * MAD) before cutting"},
+  {"profile",        9,  "FORMAT",  OPTION_ARG_OPTIONAL, "Report time per stage and HDF5/byte counters on stderr at exit: table (default) or json"},
+  {"recompress",    10,  0,         0, "Repack: decode and re-encode every Signal (without --to multi-read/single-read, keeps the input layout)"},
+  {"compression",   11,  "METHOD",  0, "Repack: Signal compression for --recompress: gzip (deflate level 1, default), a deflate level 0-9, or none"},
+  {"reads-per-file", 12, "N",       0, "Repack: reads per multi-read file, later files numbered _0, _1... (default: 4000, 0 = one file)"},
+  {"combine",       13,  0,         0, "Metadata: one table for every input file (default with several files and -o: one per file in the -o directory)"},
+  {"max-memory",    14,  "SIZE",    0, "Memory budget (e.g. 2G): past it, worker threads stop taking reads (or BLOW5 batches) until the writer catches up"},
   {0}
 };
 
 struct arguments {
   char *input_path;
   char *output_format;
+  char *encoding_name;
+  seq_output_format encoding;
+  fast5_metadata_format_t metadata_format;
+  bool combine;
   char *output_file;
   bool all;
   bool recursive;
   bool verbose;
+  char *read_id;
+  fast5_io_options_t io;
+  slow5_options_t slow5;
+  int threads;
+  seq_chunker_options chunks;
+  fast5_repack_options_t repack;
+  bool compression_given;
 };
 
+// Repack Signal compression: gzip (level 1), none, or a deflate level
+static bool parse_repack_compression(const char *arg, int *level) {
+  if (strcmp(arg, "gzip") == 0) {
+    *level = 1;
+  } else if (strcmp(arg, "none") == 0) {
+    *level = 0;
+  } else if (arg[0] >= '0' && arg[0] <= '9' && arg[1] == '\0') {
+    *level = arg[0] - '0';
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Non-negative byte or page count for the Fast5 I/O options
+static size_t parse_io_count(const char *arg, const char *what) {
+  char *end;
+  long long value = strtoll(arg, &end, 10);
+  if (*end != '\0' || value < 0) {
+    errx(EXIT_FAILURE, "%s must be a non-negative number, got %s", what, arg);
+  }
+  return (size_t)value;
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
   struct arguments *arguments = state->input;
   
@@ -72,6 +164,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case 't':
       arguments->output_format = arg;
       break;
+    case 'f':
+      arguments->encoding_name = arg;   // Signal encoding or metadata format, depending on --to
+      break;
     case 'o':
       arguments->output_file = arg;
       break;
@@ -84,6 +179,70 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case 'v':
       arguments->verbose = true;
       break;
+    case 'i':
+      arguments->read_id = arg;
+      break;
+    case 1:
+      if (!fast5_parse_io_mode(arg, &arguments->io.mode)) {
+        errx(EXIT_FAILURE, "Invalid I/O mode '%s'. Supported modes: posix, core, paged", arg);
+      }
+      break;
+    case 2:
+      arguments->io.page_size = parse_io_count(arg, "Page size");
+      break;
+    case 3:
+      arguments->io.prefetch_pages = parse_io_count(arg, "Prefetch");
+      break;
+    case 'c':
+      if (!slow5_parse_record_compression(arg, &arguments->slow5.record_compression)) {
+        errx(EXIT_FAILURE, "Invalid record compression '%s'. Supported methods: none, zlib%s", arg,
+             slow5_zstd_available() ? ", zstd" : " (zstd needs a build with libzstd)");
+      }
+      break;
+    case 's':
+      if (!slow5_parse_signal_compression(arg, &arguments->slow5.signal_compression)) {
+        errx(EXIT_FAILURE, "Invalid signal compression '%s'. Supported methods: none, svb-zd", arg);
+      }
+      break;
+    case 4:
+      arguments->threads = atoi(arg);
+      if (arguments->threads <= 0) {
+        errx(EXIT_FAILURE, "Thread count must be positive, got %d", arguments->threads);
+      }
+      break;
+    case 5:
+      arguments->chunks.chunk_length = parse_io_count(arg, "Chunk size");
+      break;
+    case 6:
+      arguments->chunks.overlap = parse_io_count(arg, "Overlap");
+      break;
+    case 7:
+      arguments->chunks.batch_size = parse_io_count(arg, "Batch size");
+      break;
+    case 8:
+      arguments->chunks.normalise = true;
+      break;
+    case 9:
+      if (!seq_profile_enable(arg)) exit(EXIT_FAILURE);
+      break;
+    case 14:
+      if (!seq_memory_enable(arg)) exit(EXIT_FAILURE);
+      break;
+    case 10:
+      arguments->repack.recompress = true;
+      break;
+    case 11:
+      if (!parse_repack_compression(arg, &arguments->repack.compression_level)) {
+        errx(EXIT_FAILURE, "Invalid Signal compression '%s'. Supported: gzip, none, or a deflate level 0-9", arg);
+      }
+      arguments->compression_given = true;
+      break;
+    case 12:
+      arguments->repack.reads_per_file = parse_io_count(arg, "Reads per file");
+      break;
+    case 13:
+      arguments->combine = true;
+      break;
     case ARGP_KEY_ARG:
       if (state->arg_num >= 1) {
         argp_usage(state);
@@ -117,23 +276,90 @@ int main_convert(int argc, char *argv[]) {
   // Set sensible defaults for all configuration options
   arguments.input_path = NULL;
   arguments.output_format = "raw";
+  arguments.encoding_name = NULL;
+  arguments.encoding = SEQ_OUTPUT_TEXT;
+  arguments.metadata_format = FAST5_METADATA_TSV;
+  arguments.combine = false;
   arguments.output_file = NULL;
   arguments.all = false;
   arguments.recursive = false;
   arguments.verbose = false;
+  arguments.read_id = NULL;
+  arguments.io.mode = FAST5_IO_POSIX;
+  arguments.io.page_size = FAST5_IO_DEFAULT_PAGE_SIZE;
+  arguments.io.prefetch_pages = FAST5_IO_DEFAULT_PREFETCH_PAGES;
+  arguments.io.decode_threads = 1;
+  arguments.slow5.format = SLOW5_FORMAT_BINARY;
+  arguments.slow5.record_compression = SLOW5_RECORD_ZLIB;
+  arguments.slow5.signal_compression = SLOW5_SIGNAL_SVB_ZD;
+  arguments.threads = 0;
+  seq_chunker_options_init(&arguments.chunks);
+  fast5_repack_options_init(&arguments.repack);
+  arguments.compression_given = false;
   
   // Parse command line arguments using argp framework
   argp_parse(&convert_argp, argc, argv, 0, 0, &arguments);
+
+  if (arguments.threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    arguments.threads = cpus > 0 ? (int)cpus : 1;
+  }
+  bool to_slow5 = slow5_parse_format(arguments.output_format, &arguments.slow5.format);
+  bool to_multi = strcmp(arguments.output_format, "multi-read") == 0;
+  bool to_single = strcmp(arguments.output_format, "single-read") == 0;
+  bool to_raw = strcmp(arguments.output_format, "raw") == 0;
+  bool to_metadata = strcmp(arguments.output_format, "metadata") == 0;
+  bool repack = to_multi || to_single || (arguments.repack.recompress && to_raw);
+
+  // SLOW5 export and repack spread reads over their workers; the one-thread paths spread each read's chunks
+  if (!to_slow5 && !repack && !to_metadata) arguments.io.decode_threads = arguments.threads;
+
+  // Applies to every Fast5 open from here on (set before any worker starts)
+  fast5_set_io_options(&arguments.io);
   
   // ========================================================================
   // STEP 2: VALIDATE ARGUMENTS
   // ========================================================================
   
   // Validate output format
-  if (strcmp(arguments.output_format, "raw") != 0) {
-    errx(EXIT_FAILURE, "Invalid output format '%s'. Supported formats: raw", 
+  bool to_chunks = strcmp(arguments.output_format, "chunks") == 0;
+  if (!to_slow5 && !to_chunks && !to_raw && !to_multi && !to_single && !to_metadata) {
+    errx(EXIT_FAILURE, "Invalid output format '%s'. Supported formats: raw, slow5, blow5, chunks, multi-read, single-read, metadata", 
          arguments.output_format);
   }
+  if (to_metadata && arguments.encoding_name &&
+      !fast5_parse_metadata_format(arguments.encoding_name, &arguments.metadata_format)) {
+    errx(EXIT_FAILURE, "Invalid metadata format '%s'. Supported formats: tsv, csv, json, bin-columnar",
+         arguments.encoding_name);
+  }
+  if (!to_metadata && arguments.encoding_name && !seq_output_parse_format(arguments.encoding_name, &arguments.encoding)) {
+    errx(EXIT_FAILURE, "Invalid signal encoding '%s'. Supported encodings: text, bin", arguments.encoding_name);
+  }
+  if (to_metadata && arguments.metadata_format == FAST5_METADATA_COLUMNAR && !arguments.output_file) {
+    errx(EXIT_FAILURE, "--format bin-columnar needs an output file or directory (-o)");
+  }
+  if (arguments.combine && !to_metadata) {
+    errx(EXIT_FAILURE, "--combine applies to --to metadata only");
+  }
+  if ((to_slow5 || to_chunks || repack || to_metadata) && arguments.read_id) {
+    errx(EXIT_FAILURE, "--read-id applies to --to raw only");
+  }
+  if (repack && !arguments.output_file) {
+    errx(EXIT_FAILURE, "Repacking needs an output %s (-o)", to_single ? "directory" : "file");
+  }
+  if (arguments.compression_given && !arguments.repack.recompress) {
+    errx(EXIT_FAILURE, "--compression applies to --recompress only");
+  }
+  if (arguments.repack.recompress && !repack) {
+    errx(EXIT_FAILURE, "--recompress writes Fast5: use it with --to multi-read, --to single-read or on its own");
+  }
+  if (to_chunks && !arguments.output_file) {
+    errx(EXIT_FAILURE, "--to chunks needs an output file (-o)");
+  }
+  if (to_chunks && (arguments.chunks.chunk_length == 0 || arguments.chunks.batch_size == 0 ||
+                    arguments.chunks.overlap >= arguments.chunks.chunk_length)) {
+    errx(EXIT_FAILURE, "Chunk size and batch size must be positive and the overlap smaller than the chunk size");
+  }
   
   // ========================================================================
   // STEP 3: DISCOVER AND ENUMERATE INPUT FILES
@@ -141,8 +367,12 @@ int main_convert(int argc, char *argv[]) {
   size_t file_count = 0;
   char **input_files = find_fast5_files(arguments.input_path, arguments.recursive, &file_count);
   
-  // Handle case where no files are found
-  if (!input_files || file_count == 0) {
+  // find_fast5_files() has already said why when it returns NULL
+  if (!input_files) {
+    return EXIT_FAILURE;
+  }
+  if (file_count == 0) {
+    free_file_list(input_files, 0);
     printf("No Fast5 files found.\n");
     return EXIT_SUCCESS;
   }
@@ -160,7 +390,27 @@ int main_convert(int argc, char *argv[]) {
   // STEP 4: PERFORM FORMAT CONVERSION
   // ========================================================================
   
-  int result = convert_to_raw(input_files, file_count, arguments.output_file, arguments.verbose, arguments.all);
+  int result;
+  if (to_slow5) {
+    result = convert_to_slow5(input_files, file_count, arguments.input_path, arguments.output_file,
+                              arguments.verbose, &arguments.slow5, arguments.threads);
+  } else if (repack) {
+    arguments.repack.layout = to_multi ? FAST5_REPACK_MULTI : to_single ? FAST5_REPACK_SINGLE : FAST5_REPACK_KEEP;
+    arguments.repack.num_threads = arguments.threads;
+    result = repack_fast5(input_files, file_count, arguments.output_file, &arguments.repack, arguments.verbose);
+  } else if (to_metadata) {
+    result = extract_metadata(input_files, file_count, arguments.output_file, arguments.metadata_format,
+                              arguments.combine, arguments.threads, arguments.verbose);
+  } else if (to_chunks) {
+    result = export_chunks(input_files, file_count, arguments.output_file, &arguments.chunks, arguments.verbose);
+  } else if (arguments.read_id) {
+    result = extract_raw_signal_by_id(input_files, file_count, arguments.input_path,
+                                      arguments.read_id, arguments.output_file, arguments.encoding,
+                                      arguments.verbose);
+  } else {
+    result = convert_to_raw(input_files, file_count, arguments.output_file, arguments.verbose, arguments.all,
+                            arguments.encoding);
+  }
   
   // ========================================================================
   // STEP 5: CLEANUP ALL ALLOCATED RESOURCES
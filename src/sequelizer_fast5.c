@@ -7,20 +7,37 @@ Fast5 file operations for Sequelizer.  Reads in Fast5 files and tells you what's
 Example uses:
 ./sequelizer fast5 /Users/seb/Documents/GitHub/SquiggleFilter/data/lambda/fast5/ --recursive --verbose
 ./sequelizer fast5 /Users/seb/Documents/GitHub/slow5tools/test/data --recursive --verbose 
+Parallel analysis:
+./sequelizer fast5 /path/to/run/ --recursive --threads 16
 TODO:
   - Add some partial verbose mode that shows file stats, but does not list the reads, the current 
 */
 #include "sequelizer_fast5.h"
 #include "core/fast5_io.h"
+#include "core/fast5_discovery.h"
 #include "core/fast5_utils.h"
 #include "core/fast5_stats.h"
+#include "core/fast5_signal_stats.h"
 #include "core/util.h"
+#include "core/seq_profile.h"
+#include "core/seq_memory.h"
 #include <string.h>
 #include <sys/stat.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <pthread.h>
 #include <argp.h>
 #include <err.h>
+#include <errno.h>
+#include <dirent.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 // Helper function to debug HDF5 file structure
 static void debug_fast5_file(const char *filename) {
@@ -39,14 +56,18 @@ static void debug_fast5_file(const char *filename) {
   // Try to open with HDF5
   printf("Attempting HDF5 open...\n");
   
-  hid_t file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-  if (file_id < 0) {
+  fast5_reader_t *reader = fast5_reader_open(filename, NULL);
+  if (!reader) {
     printf("FAILED: Cannot open as HDF5 file\n");
     printf("This file may be corrupted or not a valid Fast5 file\n\n");
     return;
   }
+  hid_t file_id = fast5_reader_file_id(reader);
   
   printf("SUCCESS: HDF5 file opened\n");
+  printf("Detected format: %s (%zu reads)\n",
+         fast5_reader_is_multi_read(reader) ? "multi-read" : "single-read",
+         fast5_reader_num_reads(reader));
   
   // Check for common Fast5 attributes
   printf("\nChecking file attributes:\n");
@@ -92,7 +113,7 @@ static void debug_fast5_file(const char *filename) {
     printf("Error: Cannot enumerate root objects\n");
   }
   
-  H5Fclose(file_id);
+  fast5_reader_close(reader);
   printf("\n");
 }
 
@@ -107,6 +128,10 @@ static char doc[] = "sequelizer fast5 -- Fast5 file analysis and debugging\v"
 "EXAMPLES:\n"
 "  sequelizer fast5 data.fast5\n"
 "  sequelizer fast5 /path/to/fast5_files/ --recursive --verbose\n"
+"  sequelizer fast5 /path/to/fast5_files/ --recursive --threads 8\n"
+"  sequelizer fast5 /path/to/run/ --recursive --cache      # later runs skip unchanged files\n"
+"  sequelizer fast5 /path/to/run/ --recursive --watch      # follow a run while it is written\n"
+"  sequelizer fast5 /path/to/run/ --recursive --signal-stats  # add pA, clipping and event QC\n"
 "  sequelizer fast5 debug problematic.fast5";
 
 static char args_doc[] = "INPUT";
@@ -116,6 +141,16 @@ static struct argp_option options[] = {
   {"verbose",       'v', 0,            0, "Show detailed information"},
   {"debug",         'd', 0,            0, "Show detailed HDF5 structure for debugging"},
   {"summary",       's', "PATH",       OPTION_ARG_OPTIONAL, "Write summary to file (default: sequelizer_summary.txt)"},
+  {"threads",       't', "N",          0, "Number of worker threads for file analysis (default: 1)"},
+  {"io-mode",        1,  "MODE",       0, "Fast5 read mode: posix (default), core (whole file into memory) or paged (large page reads, for remote/FUSE mounts)"},
+  {"page-size",      2,  "BYTES",      0, "Page size for --io-mode paged, allocation step for core (default: 262144)"},
+  {"prefetch",       3,  "PAGES",      0, "Pages read ahead on each paged-mode cache miss (default: 4)"},
+  {"cache",          4,  "PATH",       OPTION_ARG_OPTIONAL, "Reuse per-file statistics of files whose size and mtime are unchanged (default: " FAST5_STATS_CACHE_DEFAULT_PATH ")"},
+  {"watch",         'w', 0,            0, "Keep running after the summary and update it as files are added, rewritten or removed (implies --cache; Ctrl-C to stop)"},
+  {"watch-interval", 5,  "SECONDS",    0, "Rescan period for --watch where file change events are unavailable (default: 10)"},
+  {"profile",        6,  "FORMAT",     OPTION_ARG_OPTIONAL, "Report time per stage and HDF5/byte counters on stderr at exit: table (default) or json"},
+  {"signal-stats",   7,  0,            0, "Also scan every read's signal once: pA mean/std dev, median/MAD, clipped samples and t-test event count"},
+  {"max-memory",     8,  "SIZE",       0, "Memory budget (e.g. 2G): past it, --summary rows are spilled to a temporary file instead of kept in memory"},
   {0}
 };
 
@@ -126,8 +161,24 @@ struct arguments {
   bool debug;
   bool write_summary;
   char *summary_path;
+  int threads;
+  fast5_io_options_t io;
+  char *cache_path;        // NULL: no statistics cache
+  bool watch;
+  double watch_interval;
+  bool signal_stats;       // Scan the signals as well as the metadata
 };
 
+// Non-negative byte or page count for the Fast5 I/O options
+static size_t parse_io_count(const char *arg, const char *what) {
+  char *end;
+  long long value = strtoll(arg, &end, 10);
+  if (*end != '\0' || value < 0) {
+    errx(EXIT_FAILURE, "%s must be a non-negative number, got %s", what, arg);
+  }
+  return (size_t)value;
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
   struct arguments *arguments = state->input;
 
@@ -145,6 +196,46 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
       arguments->write_summary = true;
       arguments->summary_path = arg ? arg : "sequelizer_summary.txt";
       break;
+    case 't':
+      arguments->threads = atoi(arg);
+      if (arguments->threads <= 0) {
+        errx(EXIT_FAILURE, "Thread count must be positive, got %d", arguments->threads);
+      }
+      break;
+    case 1:
+      if (!fast5_parse_io_mode(arg, &arguments->io.mode)) {
+        errx(EXIT_FAILURE, "Invalid I/O mode '%s'. Supported modes: posix, core, paged", arg);
+      }
+      break;
+    case 2:
+      arguments->io.page_size = parse_io_count(arg, "Page size");
+      break;
+    case 3:
+      arguments->io.prefetch_pages = parse_io_count(arg, "Prefetch");
+      break;
+    case 4:
+      arguments->cache_path = arg ? arg : FAST5_STATS_CACHE_DEFAULT_PATH;
+      break;
+    case 'w':
+      arguments->watch = true;
+      break;
+    case 5: {
+      char *end;
+      arguments->watch_interval = strtod(arg, &end);
+      if (*end != '\0' || !(arguments->watch_interval > 0)) {
+        errx(EXIT_FAILURE, "Watch interval must be a positive number of seconds, got %s", arg);
+      }
+      break;
+    }
+    case 6:
+      if (!seq_profile_enable(arg)) exit(EXIT_FAILURE);
+      break;
+    case 7:
+      arguments->signal_stats = true;
+      break;
+    case 8:
+      if (!seq_memory_enable(arg)) exit(EXIT_FAILURE);
+      break;
     case ARGP_KEY_ARG:
       if (state->arg_num >= 1) {
         argp_usage(state);
@@ -155,6 +246,12 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
       if (state->arg_num < 1) {
         argp_usage(state);
       }
+      if (arguments->watch && (arguments->write_summary || arguments->debug)) {
+        errx(EXIT_FAILURE, "--watch cannot be combined with --summary or --debug");
+      }
+      if (arguments->watch && !arguments->cache_path) {
+        arguments->cache_path = FAST5_STATS_CACHE_DEFAULT_PATH;
+      }
       break;
     default:
       return ARGP_ERR_UNKNOWN;
@@ -168,53 +265,308 @@ static struct argp argp = {options, parse_opt, args_doc, doc};
 // Helper Functions for Modular Architecture
 // **********************************************************************
 
-// Helper function to initialize data structures for file processing
-static void initialize_data_structures(size_t file_count, fast5_metadata_t ***results, int **results_count) {
-  *results = calloc(file_count, sizeof(fast5_metadata_t*));
-  *results_count = calloc(file_count, sizeof(int));
+// **********************************************************************
+// Metadata Enhancer (Carrier Function)
+// **********************************************************************
 
-  if (!*results || !*results_count) {
-    errx(EXIT_FAILURE, "Memory allocation failed for data structures");
+void metadata_enhancer(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
+  extract_tracking_id(read, metadata); // run_id
+  extract_channel_id(read, metadata);  // channel_number
+  extract_raw(read, metadata);         // median_before, start_time
+}
+
+// --signal-stats: the scan reports pA, so it needs the calibration too
+static void signal_stats_enhancer(const fast5_read_handles_t *read, fast5_metadata_t *metadata) {
+  metadata_enhancer(read, metadata);
+  extract_calibration_parameters(read, metadata);
+}
+
+// Metadata of every read in path, with the signal QC fields when scan is given
+static fast5_metadata_t* read_file_metadata(const char *path, size_t *count, pthread_mutex_t *hdf5_mutex,
+                                            fast5_signal_scan_t *scan) {
+  if (scan) {
+    return read_fast5_metadata_with_signal_stats(path, count, signal_stats_enhancer, hdf5_mutex, scan);
   }
+  return read_fast5_metadata_thread_safe(path, count, metadata_enhancer, hdf5_mutex);
 }
 
 // **********************************************************************
-// Metadata Enhancer (Carrier Function)
+// Streaming File Processing (worker pool fed by the discovery stream)
 // **********************************************************************
 
-void metadata_enhancer(hid_t file_id, hid_t signal_dataset_id, fast5_metadata_t *metadata) {
-  extract_tracking_id(file_id, signal_dataset_id, metadata); // run_id
-  extract_channel_id(file_id, signal_dataset_id, metadata);  // channel_number
-  extract_raw(file_id, signal_dataset_id, metadata);         // median_before, start_time
+// Per-file details are printed for at most this many files
+#define FAST5_DETAIL_FILES 10
+
+// State shared by all workers. Paths arrive from the discovery walkers while
+// they are still listing directories, so analysis overlaps discovery; each
+// worker folds its files into its own statistics accumulator and appends the
+// path under queue_mutex, and the lists are put into path order once
+// everything is in. Read metadata is only kept where it will be printed or
+// written to the summary file, so memory does not grow with the read count;
+// past the --max-memory budget even summary reads are not kept, their rows go
+// to a spill file at once and are copied into the summary in path order.
+// With a statistics cache, files whose size and mtime match their cache
+// entry are merged from it and never opened
+typedef struct {
+  fast5_discovery_t *discovery;
+  char **fast5_files;
+  fast5_metadata_t **results;
+  int *results_count;
+  off_t *spill_offsets;          // Summary rows of files not kept (-1: none)
+  size_t *spill_lengths;
+  FILE *spill;                   // Temporary file, opened on first use
+  size_t metadata_bytes;         // Kept metadata counted against the memory budget
+  size_t files_count;            // Files analysed so far (entries in the three lists)
+  size_t files_capacity;
+  bool verbose;
+  bool keep_metadata;            // -s: every file's reads are needed for the summary file
+  bool signal_stats;             // --signal-stats: each worker scans the signals it reads
+  fast5_stats_accumulator_t stats; // All workers' partials, merged as they finish
+  fast5_stats_cache_t *cache;    // NULL without --cache; guarded by queue_mutex
+  size_t cache_hits;
+  pthread_mutex_t queue_mutex;   // Guards the result lists and progress output
+  pthread_mutex_t *hdf5_mutex;   // Non-NULL only when HDF5 is not thread-safe
+} fast5_worker_pool_t;
+
+// Heap held by one file's metadata (the array and its strings)
+static size_t metadata_memory(const fast5_metadata_t *metadata, size_t count) {
+  size_t bytes = count * sizeof(fast5_metadata_t);
+  for (size_t r = 0; r < count; r++) {
+    const char *strings[] = {metadata[r].read_id, metadata[r].file_path, metadata[r].compression_method,
+                             metadata[r].run_id, metadata[r].channel_number};
+    for (size_t s = 0; s < sizeof(strings) / sizeof(strings[0]); s++) {
+      if (strings[s]) bytes += strlen(strings[s]) + 1;
+    }
+  }
+  return bytes;
 }
 
-// Helper function to process files sequentially with progress tracking (your big for-loop)
-static void process_files_sequentially(char **fast5_files, size_t files_count,
-                                      fast5_metadata_t **results, int *results_count,
-                                      bool verbose) {
-  // Show initial progress bar
-  display_progress_simple(0, (int)files_count, verbose, "analyzing Fast5 files");
+static void write_summary_rows(FILE *fp, const char *filename, const fast5_metadata_t *metadata, int count);
 
-  // Process each file and collect results
-  for (size_t i = 0; i < files_count; i++) {
-    // Read metadata
-    size_t metadata_count = 0;
-    fast5_metadata_t *metadata = read_fast5_metadata_with_enhancer(fast5_files[i], &metadata_count, metadata_enhancer);
+// Write file i's summary rows to the spill file now (caller holds queue_mutex)
+static void spill_summary_rows(fast5_worker_pool_t *pool, size_t i, const char *path,
+                               const fast5_metadata_t *metadata, int count) {
+  if (!pool->spill) {
+    pool->spill = tmpfile();
+    if (!pool->spill) {
+      errx(EXIT_FAILURE, "Cannot create a temporary file for summary rows");
+    }
+  }
+  pool->spill_offsets[i] = ftello(pool->spill);
+  write_summary_rows(pool->spill, path, metadata, count);
+  pool->spill_lengths[i] = (size_t)(ftello(pool->spill) - pool->spill_offsets[i]);
+}
+
+// Worker: analyse discovered files until the stream runs dry
+static void* fast5_worker_thread(void *arg) {
+  fast5_worker_pool_t *pool = (fast5_worker_pool_t*)arg;
 
-    if (metadata && metadata_count > 0) {
-      results[i] = metadata;
-      results_count[i] = (int)metadata_count;
+  fast5_stats_accumulator_t *partial = malloc(sizeof(fast5_stats_accumulator_t));
+  if (!partial) {
+    errx(EXIT_FAILURE, "Memory allocation failed for worker statistics");
+  }
+  fast5_stats_accumulator_init(partial);
+  fast5_stats_accumulator_t *file_stats = NULL;  // One file's statistics, for the cache
+  if (pool->cache) {
+    file_stats = malloc(sizeof(fast5_stats_accumulator_t));
+    if (!file_stats) {
+      errx(EXIT_FAILURE, "Memory allocation failed for worker statistics");
+    }
+  }
+
+  fast5_signal_scan_t *scan = NULL;
+  if (pool->signal_stats) {
+    scan = fast5_signal_scan_create();
+    if (!scan) {
+      errx(EXIT_FAILURE, "Memory allocation failed for signal statistics");
+    }
+  }
+
+  char *path;
+  while ((path = fast5_discovery_next(pool->discovery)) != NULL) {
+    // stat before reading: a file modified meanwhile no longer matches its entry next time
+    struct stat st;
+    bool cacheable = pool->cache && stat(path, &st) == 0;
+    fast5_cache_status_t cached = FAST5_CACHE_MISS;
+    int cached_reads = 0;
+    if (cacheable && !pool->keep_metadata) {
+      pthread_mutex_lock(&pool->queue_mutex);
+      cached = fast5_stats_cache_lookup(pool->cache, path, &st, partial, &cached_reads);
+      if (cached == FAST5_CACHE_HIT) pool->cache_hits++;
+      pthread_mutex_unlock(&pool->queue_mutex);
+    }
+
+    size_t metadata_count = 0;
+    fast5_metadata_t *metadata = NULL;
+    if (cached == FAST5_CACHE_HIT) {
+      metadata_count = (size_t)cached_reads;
     } else {
-      results[i] = NULL;
-      results_count[i] = 0;
+      metadata = read_file_metadata(path, &metadata_count, pool->hdf5_mutex, scan);
+      if (!metadata || metadata_count == 0) {
+        free_fast5_metadata(metadata, metadata_count);
+        metadata = NULL;
+        metadata_count = 0;
+      }
+      if (cacheable) {
+        fast5_stats_accumulator_init(file_stats);
+        fast5_stats_accumulator_add_file(file_stats, path, metadata, (int)metadata_count);
+        pthread_mutex_lock(&pool->queue_mutex);
+        fast5_stats_cache_store(pool->cache, path, &st, file_stats);
+        pthread_mutex_unlock(&pool->queue_mutex);
+        fast5_stats_accumulator_merge(partial, file_stats);
+        fast5_stats_accumulator_free(file_stats);
+      } else {
+        fast5_stats_accumulator_add_file(partial, path, metadata, (int)metadata_count);
+      }
     }
 
-    // Update progress bar
-    display_progress_simple((int)(i + 1), (int)files_count, verbose, "analyzing Fast5 files");
+    pthread_mutex_lock(&pool->queue_mutex);
+    if (pool->files_count == pool->files_capacity) {
+      size_t capacity = pool->files_capacity ? pool->files_capacity * 2 : 1024;
+      char **files = realloc(pool->fast5_files, capacity * sizeof(char*));
+      fast5_metadata_t **results = realloc(pool->results, capacity * sizeof(fast5_metadata_t*));
+      int *counts = realloc(pool->results_count, capacity * sizeof(int));
+      off_t *offsets = realloc(pool->spill_offsets, capacity * sizeof(off_t));
+      size_t *lengths = realloc(pool->spill_lengths, capacity * sizeof(size_t));
+      if (files) pool->fast5_files = files;
+      if (results) pool->results = results;
+      if (counts) pool->results_count = counts;
+      if (offsets) pool->spill_offsets = offsets;
+      if (lengths) pool->spill_lengths = lengths;
+      if (!files || !results || !counts || !offsets || !lengths) {
+        errx(EXIT_FAILURE, "Memory allocation failed for data structures");
+      }
+      pool->files_capacity = capacity;
+    }
+    size_t i = pool->files_count++;
+    bool keep = metadata && (pool->keep_metadata || i < FAST5_DETAIL_FILES);
+    pool->spill_offsets[i] = -1;
+    pool->spill_lengths[i] = 0;
+    if (keep && pool->keep_metadata) {
+      size_t bytes = metadata_memory(metadata, metadata_count);
+      if (seq_memory_available() < bytes) {
+        // The detail view, if wanted, re-reads the file
+        spill_summary_rows(pool, i, path, metadata, (int)metadata_count);
+        keep = false;
+      } else {
+        seq_memory_reserve(bytes);
+        pool->metadata_bytes += bytes;
+      }
+    }
+    pool->fast5_files[i] = path;
+    pool->results[i] = keep ? metadata : NULL;
+    pool->results_count[i] = (int)metadata_count;
+
+    // The total grows while discovery is still running
+    display_progress_simple((int)pool->files_count, (int)fast5_discovery_found(pool->discovery),
+                            pool->verbose, "analyzing Fast5 files");
+    pthread_mutex_unlock(&pool->queue_mutex);
+
+    if (!keep) {
+      free_fast5_metadata(metadata, metadata_count);
+    }
+  }
+
+  pthread_mutex_lock(&pool->queue_mutex);
+  fast5_stats_accumulator_merge(&pool->stats, partial);
+  pthread_mutex_unlock(&pool->queue_mutex);
+  fast5_stats_accumulator_free(partial);
+  free(partial);
+  free(file_stats);
+  fast5_signal_scan_free(scan);
+  return NULL;
+}
+
+// Helper function to analyse the discovery stream with num_threads workers
+// (one worker runs on the calling thread)
+static void process_discovered_files(fast5_worker_pool_t *pool, int num_threads) {
+  pthread_mutex_init(&pool->queue_mutex, NULL);
+  pool->hdf5_mutex = NULL;
+  fast5_stats_accumulator_init(&pool->stats);
+
+  // Non-thread-safe HDF5 builds: serialise only the HDF5 sessions, the rest runs in parallel
+  pthread_mutex_t hdf5_mutex;
+  if (num_threads > 1 && !fast5_hdf5_is_threadsafe()) {
+    pthread_mutex_init(&hdf5_mutex, NULL);
+    pool->hdf5_mutex = &hdf5_mutex;
+    if (pool->verbose) {
+      printf("HDF5 library is not thread-safe: serialising HDF5 access\n");
+    }
   }
 
+  pthread_t *threads = NULL;
+  if (num_threads > 1) {
+    threads = calloc(num_threads - 1, sizeof(pthread_t));
+    if (!threads) {
+      errx(EXIT_FAILURE, "Memory allocation failed for worker threads");
+    }
+  }
+  for (int t = 0; t < num_threads - 1; t++) {
+    if (pthread_create(&threads[t], NULL, fast5_worker_thread, pool) != 0) {
+      errx(EXIT_FAILURE, "Failed to create worker thread %d", t);
+    }
+  }
+  fast5_worker_thread(pool);
+  for (int t = 0; t < num_threads - 1; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  free(threads);
+
+  if (pool->hdf5_mutex) {
+    pthread_mutex_destroy(pool->hdf5_mutex);
+  }
+  pthread_mutex_destroy(&pool->queue_mutex);
+
   // Complete progress bar and move to next line
-  printf("\n\n");
+  if (pool->files_count > 0) {
+    printf("\n\n");
+  }
+}
+
+// Put the analysed files (and their results) into path order, the order a
+// sorted directory listing would give, independent of worker scheduling
+static fast5_worker_pool_t *sort_pool;
+
+static int compare_result_paths(const void *a, const void *b) {
+  return strcmp(sort_pool->fast5_files[*(const size_t*)a], sort_pool->fast5_files[*(const size_t*)b]);
+}
+
+static void sort_results_by_path(fast5_worker_pool_t *pool) {
+  size_t n = pool->files_count;
+  if (n < 2) return;
+
+  size_t *order = malloc(n * sizeof(size_t));
+  char **files = malloc(n * sizeof(char*));
+  fast5_metadata_t **results = malloc(n * sizeof(fast5_metadata_t*));
+  int *counts = malloc(n * sizeof(int));
+  off_t *offsets = malloc(n * sizeof(off_t));
+  size_t *lengths = malloc(n * sizeof(size_t));
+  if (!order || !files || !results || !counts || !offsets || !lengths) {
+    errx(EXIT_FAILURE, "Memory allocation failed for data structures");
+  }
+  for (size_t i = 0; i < n; i++) order[i] = i;
+  sort_pool = pool;
+  qsort(order, n, sizeof(size_t), compare_result_paths);
+  sort_pool = NULL;
+
+  for (size_t i = 0; i < n; i++) {
+    files[i] = pool->fast5_files[order[i]];
+    results[i] = pool->results[order[i]];
+    counts[i] = pool->results_count[order[i]];
+    offsets[i] = pool->spill_offsets[order[i]];
+    lengths[i] = pool->spill_lengths[order[i]];
+  }
+  free(pool->fast5_files);
+  free(pool->results);
+  free(pool->results_count);
+  free(pool->spill_offsets);
+  free(pool->spill_lengths);
+  pool->fast5_files = files;
+  pool->results = results;
+  pool->results_count = counts;
+  pool->spill_offsets = offsets;
+  pool->spill_lengths = lengths;
+  free(order);
 }
 
 // Helper function to display single file info using pre-loaded metadata (avoids re-reading)
@@ -296,9 +648,50 @@ static void print_file_info_human(fast5_metadata_t *metadata, int count,
 // **********************************************************************
 // Summary File Writing
 // **********************************************************************
-// sequelizer_summary.txt
-static void write_summary_file(const char *summary_path, fast5_metadata_t **results,
-                               int *results_count, char **filenames, size_t file_count) {
+// One file's rows
+static void write_summary_rows(FILE *fp, const char *filename, const fast5_metadata_t *metadata, int count) {
+  // Extract basename from filename
+  const char *basename = strrchr(filename, '/');
+  basename = basename ? basename + 1 : filename;
+
+  for (int j = 0; j < count; j++) {
+    // Calculate translocation_time and start_time in seconds
+    double translocation_time = metadata[j].sample_rate > 0 ? metadata[j].duration / metadata[j].sample_rate : 0.0;
+    double start_time = metadata[j].sample_rate > 0 ? metadata[j].start_time / metadata[j].sample_rate : 0.0;
+
+    // Parse channel number
+    int channel = metadata[j].channel_number ? atoi(metadata[j].channel_number) : 0;
+
+    // Get median_before (use median_before if available)
+    double median_before = metadata[j].pore_level_available ? metadata[j].median_before : 0.0;
+
+    // Write the row
+    fprintf(fp, "%s\t%s\t%s\t%4d\t%7.1f\t%6.1f\t%6u\t%7.2f\n",
+            basename,
+            metadata[j].read_id ? metadata[j].read_id : "unknown",
+            metadata[j].run_id ? metadata[j].run_id : "unknown",
+            channel,
+            start_time,
+            translocation_time,
+            metadata[j].duration,
+            median_before);
+  }
+}
+
+// Copy length bytes of spilled rows from offset
+static bool copy_spilled_rows(FILE *spill, off_t offset, size_t length, FILE *fp) {
+  char buffer[1 << 16];
+  if (fseeko(spill, offset, SEEK_SET) != 0) return false;
+  while (length > 0) {
+    size_t want = length < sizeof(buffer) ? length : sizeof(buffer);
+    if (fread(buffer, 1, want, spill) != want || fwrite(buffer, 1, want, fp) != want) return false;
+    length -= want;
+  }
+  return true;
+}
+
+// sequelizer_summary.txt (files in order; kept metadata or rows spilled by the workers)
+static void write_summary_file(const char *summary_path, const fast5_worker_pool_t *pool) {
   // Open summary file
   FILE *fp = fopen(summary_path, "w");
   if (!fp) {
@@ -311,34 +704,12 @@ static void write_summary_file(const char *summary_path, fast5_metadata_t **resu
   fprintf(fp, "filename\tread_id\trun_id\tchannel\tstart_time\ttranslocation_time\tnum_samples\tmedian_before\n");
 
   // Iterate through all files and reads
-  for (size_t i = 0; i < file_count; i++) {
-    if (results[i] && results_count[i] > 0) {
-      for (int j = 0; j < results_count[i]; j++) {
-        // Extract basename from filename
-        const char *basename = strrchr(filenames[i], '/');
-        basename = basename ? basename + 1 : filenames[i];
-
-        // Calculate translocation_time and start_time in seconds
-        double translocation_time = results[i][j].sample_rate > 0 ? results[i][j].duration / results[i][j].sample_rate : 0.0;
-        double start_time = results[i][j].sample_rate > 0 ? results[i][j].start_time / results[i][j].sample_rate : 0.0;
-
-        // Parse channel number
-        int channel = results[i][j].channel_number ? atoi(results[i][j].channel_number) : 0;
-
-        // Get median_before (use median_before if available)
-        double median_before = results[i][j].pore_level_available ? results[i][j].median_before : 0.0;
-
-        // Write the row
-        fprintf(fp, "%s\t%s\t%s\t%4d\t%7.1f\t%6.1f\t%6u\t%7.2f\n",
-                basename,
-                results[i][j].read_id ? results[i][j].read_id : "unknown",
-                results[i][j].run_id ? results[i][j].run_id : "unknown",
-                channel,
-                start_time,
-                translocation_time,
-                results[i][j].duration,
-                median_before);
-      }
+  for (size_t i = 0; i < pool->files_count; i++) {
+    if (pool->results[i] && pool->results_count[i] > 0) {
+      write_summary_rows(fp, pool->fast5_files[i], pool->results[i], pool->results_count[i]);
+    } else if (pool->spill_lengths[i] > 0 &&
+               !copy_spilled_rows(pool->spill, pool->spill_offsets[i], pool->spill_lengths[i], fp)) {
+      errx(EXIT_FAILURE, "Failed to read back spilled summary rows of %s", pool->fast5_files[i]);
     }
   }
 
@@ -346,6 +717,316 @@ static void write_summary_file(const char *summary_path, fast5_metadata_t **resu
   printf("Summary written to: %s\n", summary_path);
 }
 
+// **********************************************************************
+// Watch Mode (--watch)
+// **********************************************************************
+// After the first pass only new, rewritten or removed files are looked at.
+// On Linux inotify names them; elsewhere (or for a single-file input) the
+// tree is relisted every --watch-interval seconds and each file is checked
+// against the cache by size and mtime, still without opening unchanged ones.
+// New files are merged into the running totals; a rewrite or removal
+// rebuilds the totals from the cache, which never opens a file either.
+
+static volatile sig_atomic_t watch_stopping = 0;
+
+static void watch_stop(int signum) {
+  (void)signum;
+  watch_stopping = 1;
+}
+
+typedef struct {
+  const struct arguments *arguments;
+  fast5_stats_cache_t *cache;
+  fast5_stats_accumulator_t *total;
+  fast5_stats_accumulator_t file_stats;  // One file being (re)read
+  fast5_signal_scan_t *scan;             // NULL without --signal-stats
+  bool rebuild;              // A file changed or went away: re-merge totals from the cache
+  int files_changed;         // Since the last status line
+} fast5_watch_t;
+
+// Bring one path up to date with the cache and the totals
+static void watch_update_file(fast5_watch_t *watch, const char *path) {
+  struct stat st;
+  if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+    if (fast5_stats_cache_remove(watch->cache, path)) {
+      watch->rebuild = true;
+      watch->files_changed++;
+    }
+    return;
+  }
+  fast5_cache_status_t status = fast5_stats_cache_lookup(watch->cache, path, &st, NULL, NULL);
+  if (status == FAST5_CACHE_HIT) return;
+  if (status == FAST5_CACHE_STALE) watch->rebuild = true;
+
+  // A file still being written may not open yet; it is read again when it changes
+  size_t count = 0;
+  fast5_metadata_t *metadata = read_file_metadata(path, &count, NULL, watch->scan);
+  fast5_stats_accumulator_init(&watch->file_stats);
+  fast5_stats_accumulator_add_file(&watch->file_stats, path, metadata, metadata ? (int)count : 0);
+  free_fast5_metadata(metadata, count);
+  fast5_stats_cache_store(watch->cache, path, &st, &watch->file_stats);
+  if (!watch->rebuild) {
+    fast5_stats_accumulator_merge(watch->total, &watch->file_stats);
+  }
+  fast5_stats_accumulator_free(&watch->file_stats);
+  watch->files_changed++;
+}
+
+// Relist the whole input: files not found any more leave the cache
+static void watch_rescan(fast5_watch_t *watch) {
+  fast5_discovery_options_t options = {
+    .recursive = watch->arguments->recursive,
+    .check_signature = true,
+    .threads = 0
+  };
+  fast5_stats_cache_begin_scan(watch->cache);
+
+  // An input that has disappeared takes all its files with it
+  struct stat st;
+  fast5_discovery_t *discovery = NULL;
+  if (stat(watch->arguments->input_path, &st) == 0) {
+    discovery = fast5_discovery_start(watch->arguments->input_path, &options);
+  }
+  if (discovery) {
+    char *path;
+    while ((path = fast5_discovery_next(discovery)) != NULL) {
+      watch_update_file(watch, path);
+      free(path);
+    }
+    fast5_discovery_close(discovery);
+  }
+
+  size_t gone = fast5_stats_cache_sweep(watch->cache);
+  if (gone > 0) {
+    watch->rebuild = true;
+    watch->files_changed += (int)gone;
+  }
+}
+
+// One status line for everything that changed since the last one
+static void watch_report(fast5_watch_t *watch) {
+  if (watch->rebuild) {
+    fast5_stats_accumulator_free(watch->total);
+    fast5_stats_accumulator_init(watch->total);
+    fast5_stats_cache_merge_all(watch->cache, watch->total);
+    watch->rebuild = false;
+  }
+  if (watch->files_changed == 0) return;
+
+  fast5_dataset_statistics_t *stats = calc_fast5_dataset_stats_from_accumulator(watch->total);
+  if (!stats) {
+    errx(EXIT_FAILURE, "Memory allocation failed for dataset statistics");
+  }
+  char stamp[16];
+  time_t now = time(NULL);
+  strftime(stamp, sizeof(stamp), "%H:%M:%S", localtime(&now));
+  printf("[%s] %d file%s updated: %zu files, %d reads, %.1f reads/minute", stamp, watch->files_changed,
+         watch->files_changed == 1 ? "" : "s", fast5_stats_cache_count(watch->cache), stats->total_reads,
+         stats->global_reads_per_minute);
+  if (stats->peak_throughput_experiment) {
+    printf(", peak %.2f reads/sensor/minute (%s)", stats->peak_throughput, stats->peak_throughput_experiment);
+  }
+  printf("\n");
+  fflush(stdout);
+  free_fast5_dataset_stats(stats);
+
+  fast5_stats_cache_save(watch->cache, watch->arguments->cache_path);
+  watch->files_changed = 0;
+}
+
+static void watch_by_polling(fast5_watch_t *watch) {
+  struct timespec interval;
+  interval.tv_sec = (time_t)watch->arguments->watch_interval;
+  interval.tv_nsec = (long)((watch->arguments->watch_interval - interval.tv_sec) * 1e9);
+  while (!watch_stopping) {
+    if (nanosleep(&interval, NULL) != 0 && watch_stopping) break;
+    watch_rescan(watch);
+    watch_report(watch);
+  }
+}
+
+#ifdef __linux__
+// Directory of each inotify watch descriptor, to turn events back into paths
+typedef struct {
+  int fd;
+  char **dirs;
+  int capacity;
+} watch_inotify_t;
+
+static char* watch_join(const char *directory, const char *name) {
+  char path[PATH_MAX];
+  int length = snprintf(path, sizeof(path), "%s/%s", directory, name);
+  if (length < 0 || (size_t)length >= sizeof(path)) {
+    warnx("Path too long: %s/%s", directory, name);
+    return NULL;
+  }
+  return strdup(path);
+}
+
+// Watch directory (and, with --recursive, everything below it), bringing any
+// Fast5 files already in it up to date
+static void watch_add_tree(watch_inotify_t *notify, fast5_watch_t *watch, const char *directory) {
+  int wd = inotify_add_watch(notify->fd, directory,
+                             IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR);
+  if (wd < 0) {
+    warnx("Cannot watch %s: %s", directory, strerror(errno));
+    return;
+  }
+  if (wd >= notify->capacity) {
+    int capacity = notify->capacity ? notify->capacity : 64;
+    while (capacity <= wd) capacity *= 2;
+    char **dirs = realloc(notify->dirs, capacity * sizeof(char*));
+    if (!dirs) {
+      errx(EXIT_FAILURE, "Memory allocation failed for watch list");
+    }
+    memset(dirs + notify->capacity, 0, (capacity - notify->capacity) * sizeof(char*));
+    notify->dirs = dirs;
+    notify->capacity = capacity;
+  }
+  free(notify->dirs[wd]);
+  notify->dirs[wd] = strdup(directory);
+
+  DIR *dir = opendir(directory);
+  if (!dir) return;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+    char *path = watch_join(directory, entry->d_name);
+    if (!path) continue;
+    bool is_dir = entry->d_type == DT_DIR;
+    if (entry->d_type == DT_UNKNOWN) {
+      struct stat st;
+      is_dir = stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+    }
+    if (is_dir && watch->arguments->recursive) {
+      watch_add_tree(notify, watch, path);
+    } else if (!is_dir && is_fast5_file(entry->d_name)) {
+      watch_update_file(watch, path);
+    }
+    free(path);
+  }
+  closedir(dir);
+}
+
+// false if inotify is unavailable (the caller polls instead)
+static bool watch_with_inotify(fast5_watch_t *watch) {
+  watch_inotify_t notify = {0};
+  notify.fd = inotify_init1(IN_CLOEXEC);
+  if (notify.fd < 0) return false;
+  watch_add_tree(&notify, watch, watch->arguments->input_path);
+  watch_report(watch);  // Anything that changed between the first pass and the watches
+
+  // Events for one batch arrive together; report once they pause for a second
+  char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+  while (!watch_stopping) {
+    struct pollfd pfd = {notify.fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, (watch->files_changed > 0 || watch->rebuild) ? 1000 : -1);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      warnx("Waiting for file events failed: %s", strerror(errno));
+      break;
+    }
+    if (ready == 0) {
+      watch_report(watch);
+      continue;
+    }
+    ssize_t n = read(notify.fd, buffer, sizeof(buffer));
+    if (n <= 0) continue;
+
+    bool rescan = false;
+    for (char *p = buffer; p < buffer + n; ) {
+      const struct inotify_event *event = (const struct inotify_event*)p;
+      p += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        rescan = true;  // Events were lost
+        continue;
+      }
+      if (event->wd < 0 || event->wd >= notify.capacity || !notify.dirs[event->wd]) continue;
+      if (event->mask & IN_IGNORED) {
+        free(notify.dirs[event->wd]);
+        notify.dirs[event->wd] = NULL;
+        continue;
+      }
+      if (event->len == 0) continue;
+
+      char *path = watch_join(notify.dirs[event->wd], event->name);
+      if (!path) continue;
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          if (watch->arguments->recursive) watch_add_tree(&notify, watch, path);
+        } else if (event->mask & IN_MOVED_FROM) {
+          rescan = true;  // Its files left with it
+        }
+      } else if (is_fast5_file(event->name)) {
+        watch_update_file(watch, path);
+      }
+      free(path);
+    }
+    if (rescan) watch_rescan(watch);
+  }
+
+  for (int i = 0; i < notify.capacity; i++) free(notify.dirs[i]);
+  free(notify.dirs);
+  close(notify.fd);
+  return true;
+}
+#endif
+
+// Follow the input until interrupted, then print the final summary
+static void run_watch(const struct arguments *arguments, fast5_stats_cache_t *cache,
+                      fast5_stats_accumulator_t *total) {
+  fast5_watch_t *watch = calloc(1, sizeof(fast5_watch_t));
+  if (!watch) {
+    errx(EXIT_FAILURE, "Memory allocation failed for watch state");
+  }
+  watch->arguments = arguments;
+  watch->cache = cache;
+  watch->total = total;
+  if (arguments->signal_stats) {
+    watch->scan = fast5_signal_scan_create();
+    if (!watch->scan) {
+      errx(EXIT_FAILURE, "Memory allocation failed for signal statistics");
+    }
+  }
+
+  // No SA_RESTART: a signal must break out of poll() and nanosleep()
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = watch_stop;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  printf("Watching %s for new and changed Fast5 files (Ctrl-C to stop)...\n", arguments->input_path);
+  fflush(stdout);
+
+  bool watched = false;
+#ifdef __linux__
+  struct stat st;
+  if (stat(arguments->input_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+    watched = watch_with_inotify(watch);
+  }
+#endif
+  if (!watched) {
+    watch_by_polling(watch);
+  }
+  watch_report(watch);
+  printf("\n");
+
+  fast5_dataset_statistics_t *stats = calc_fast5_dataset_stats_from_accumulator(total);
+  if (!stats) {
+    errx(EXIT_FAILURE, "Memory allocation failed for dataset statistics");
+  }
+  fast5_analysis_summary_t *summary = calc_analysis_summary_with_enhancer(stats, (int)fast5_stats_cache_count(cache), 0.0, NULL);
+  print_comprehensive_summary_human(summary);
+  free_comprehensive_summary(summary);
+  free_fast5_dataset_stats(stats);
+  fast5_stats_cache_save(cache, arguments->cache_path);
+  fast5_signal_scan_free(watch->scan);
+  free(watch);
+}
+
 // **********************************************************************
 // Main Function
 // **********************************************************************
@@ -363,45 +1044,99 @@ int main_fast5(int argc, char *argv[]) {
   arguments.debug = false;
   arguments.write_summary = false;
   arguments.summary_path = NULL;
+  arguments.threads = 1;
+  arguments.io.mode = FAST5_IO_POSIX;
+  arguments.io.page_size = FAST5_IO_DEFAULT_PAGE_SIZE;
+  arguments.io.prefetch_pages = FAST5_IO_DEFAULT_PREFETCH_PAGES;
+  arguments.io.decode_threads = 1;
+  arguments.cache_path = NULL;
+  arguments.watch = false;
+  arguments.watch_interval = 10.0;
+  arguments.signal_stats = false;
   
   // Parse command line arguments using argp framework
   argp_parse(&argp, argc, argv, 0, 0, &arguments);
 
+  // Applies to every Fast5 open from here on (set before any worker starts)
+  fast5_set_io_options(&arguments.io);
+
   // ========================================================================
-  // STEP 2: DISCOVER AND ENUMERATE FAST5 FILES
+  // STEP 2: START STREAMING FAST5 FILE DISCOVERY
   // ========================================================================
-  printf("Discovering Fast5 files...\n");
+  // Walkers list directories in the background; workers start on the first
+  // files found instead of waiting for the whole tree. Files without an HDF5
+  // signature are dropped by the walkers, before any HDF5 open
+  printf("Discovering and analyzing Fast5 files...\n");
   fflush(stdout);
 
-  size_t file_count = 0;
-  char **fast5_files = find_fast5_files(arguments.input_path, arguments.recursive, &file_count);
-  
-  // Handle case where no Fast5 files are found
-  if (!fast5_files || file_count == 0) {
-    printf("No Fast5 files found.\n");
-    return EXIT_SUCCESS;
+  fast5_discovery_options_t discovery_options = {
+    .recursive = arguments.recursive,
+    .check_signature = true,
+    .threads = 0
+  };
+  fast5_discovery_t *discovery = fast5_discovery_start(arguments.input_path, &discovery_options);
+  if (!discovery) {
+    return EXIT_FAILURE;
+  }
+
+  // Statistics of files unchanged since the last run come from the cache
+  fast5_stats_cache_t *cache = NULL;
+  if (arguments.cache_path) {
+    cache = fast5_stats_cache_load(arguments.cache_path);
+    if (!cache) {
+      errx(EXIT_FAILURE, "Cannot load statistics cache: %s", arguments.cache_path);
+    }
+    fast5_stats_cache_begin_scan(cache);
+    fast5_stats_cache_require_signal_stats(cache, arguments.signal_stats);
   }
 
-  printf("Found %zu files, analyzing...\n", file_count);
-  fflush(stdout);
-  
   // ========================================================================
-  // STEP 3: INITIALIZE TIMING AND DATA STRUCTURES
+  // STEP 3: INITIALIZE TIMING
   // ========================================================================
   // Start timing for performance measurement
   struct timeval start_time, end_time;
   gettimeofday(&start_time, NULL);
-  
-  // Initialize shared arrays for storing results from file processing
-  fast5_metadata_t **results = NULL;
-  int *results_count = NULL;
-  initialize_data_structures(file_count, &results, &results_count);
 
   // ========================================================================
-  // STEP 4: PROCESS FILES SEQUENTIALLY WITH PROGRESS TRACKING
+  // STEP 4: PROCESS FILES AS THEY ARE DISCOVERED (ONE OR MORE WORKERS)
   // ========================================================================
-  // Process each file and collect metadata results (single-threaded)
-  process_files_sequentially(fast5_files, file_count, results, results_count, arguments.verbose);
+  fast5_worker_pool_t pool = {
+    .discovery = discovery,
+    .verbose = arguments.verbose,
+    .keep_metadata = arguments.write_summary,
+    .signal_stats = arguments.signal_stats,
+    .cache = cache
+  };
+  process_discovered_files(&pool, arguments.threads);
+
+  size_t rejected = fast5_discovery_rejected(discovery);
+  fast5_discovery_close(discovery);
+  if (rejected > 0) {
+    printf("Skipped %zu .fast5 file%s without an HDF5 signature\n", rejected, rejected == 1 ? "" : "s");
+  }
+  if (cache) {
+    // Files that have gone since the last run leave the cache
+    fast5_stats_cache_sweep(cache);
+    fast5_stats_cache_save(cache, arguments.cache_path);
+    printf("Statistics cache: %zu of %zu files unchanged\n", pool.cache_hits, pool.files_count);
+  }
+
+  // Handle case where no Fast5 files are found
+  size_t file_count = pool.files_count;
+  if (file_count == 0 && !arguments.watch) {
+    fast5_stats_accumulator_free(&pool.stats);
+    fast5_stats_cache_free(cache);
+    printf("No Fast5 files found.\n");
+    return EXIT_SUCCESS;
+  }
+  sort_results_by_path(&pool);
+  char **fast5_files = pool.fast5_files;
+  fast5_metadata_t **results = pool.results;
+  int *results_count = pool.results_count;
+
+  // Report at most as many workers as there were files to hand out
+  int threads_used = arguments.threads;
+  if ((size_t)threads_used > file_count) threads_used = (int)file_count;
 
   // Calculate total processing time for summary
   gettimeofday(&end_time, NULL);
@@ -411,12 +1146,17 @@ int main_fast5(int argc, char *argv[]) {
   // ========================================================================
   // STEP 5: CALCULATE FAST5 DATASET STATISTICS
   // ========================================================================
-  fast5_dataset_statistics_t *stats = calc_fast5_dataset_stats_with_enhancer(results, results_count, fast5_files, file_count, NULL);
+  // Already accumulated by the workers while they scanned
+  fast5_dataset_statistics_t *stats = calc_fast5_dataset_stats_from_accumulator(&pool.stats);
+  if (!stats) {
+    errx(EXIT_FAILURE, "Memory allocation failed for dataset statistics");
+  }
 
   // ========================================================================
   // STEP 6: CREATE ANALYSIS SUMMARY
   // ========================================================================
   fast5_analysis_summary_t* summary = calc_analysis_summary_with_enhancer(stats, file_count, processing_time_ms, NULL);
+  summary->threads_used = threads_used;
 
   // ========================================================================
   // STEP 7: OUTPUT RESULTS IN REQUESTED FORMAT
@@ -433,8 +1173,14 @@ int main_fast5(int argc, char *argv[]) {
   }
 
   // Normal output: individual file details for small datasets or verbose mode
-  if ((file_count == 1) || (arguments.verbose && file_count <= 10)) {
+  if ((file_count == 1) || (arguments.verbose && file_count <= FAST5_DETAIL_FILES)) {
     for (size_t i = 0; i < file_count; i++) {
+      if (!results[i] && results_count[i] > 0) {
+        // Statistics came from the cache; the details need the file itself
+        size_t count = 0;
+        results[i] = read_fast5_metadata_with_enhancer(fast5_files[i], &count, metadata_enhancer);
+        results_count[i] = results[i] ? (int)count : 0;
+      }
       if (results[i] && results_count[i] > 0) {
         print_file_info_human(results[i], results_count[i], fast5_files[i], arguments.verbose);
       }
@@ -444,10 +1190,16 @@ int main_fast5(int argc, char *argv[]) {
   // Always show comprehensive summary (except debug mode which already returned)
   print_comprehensive_summary_human(summary);
   free_comprehensive_summary(summary);
+  free_fast5_dataset_stats(stats);
 
   // Write summary file if requested
   if (arguments.write_summary) {
-    write_summary_file(arguments.summary_path, results, results_count, fast5_files, file_count);
+    write_summary_file(arguments.summary_path, &pool);
+  }
+
+  // Keep following the run (returns on Ctrl-C)
+  if (arguments.watch) {
+    run_watch(&arguments, cache, &pool.stats);
   }
 
   // ========================================================================
@@ -460,10 +1212,17 @@ int main_fast5(int argc, char *argv[]) {
     }
   }
   
+  seq_memory_release(pool.metadata_bytes);
+  if (pool.spill) fclose(pool.spill);
+
   // Free main data structure arrays
   free(results);
   free(results_count);
+  free(pool.spill_offsets);
+  free(pool.spill_lengths);
   free_file_list(fast5_files, file_count);
+  fast5_stats_accumulator_free(&pool.stats);
+  fast5_stats_cache_free(cache);
   
   return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -21,6 +21,9 @@ file format detection happens in plot_utils.c/h
 #include "core/fast5_utils.h"
 #include "core/util.h"
 #include "core/plot_utils.h"
+#include "core/seq_output.h"
+#include "core/seq_profile.h"
+#include "core/seq_memory.h"
 #include <string.h>
 #include <sys/stat.h>
 #include <stdint.h>
@@ -37,7 +40,10 @@ static char doc[] = "sequelizer plot -- Signal visualization and plotting\v"
 "  sequelizer plot data.txt --output plot.png\n"
 "  sequelizer plot --png signals.txt\n"
 "  sequelizer plot --title \"My Data\" file.txt\n"
-"  sequelizer plot --limit 5 --verbose file1.txt file2.txt";
+"  sequelizer plot --limit 5 --verbose file1.txt file2.txt\n"
+"  sequelizer plot --width 0 signal.txt     # every sample, no decimation\n"
+"  sequelizer plot reads.fast5 --read-id READ_ID --start 100000 --length 50000\n"
+"  sequelizer plot --pyramid long_read.fast5 # cache a min/max pyramid for fast zooming";
 
 static char args_doc[] = "data_file [data_file ...]";
 
@@ -47,7 +53,14 @@ static struct argp_option options[] = {
   {"png",           'p', 0,         0, "Generate PNG files instead of interactive plots"},
   {"title",         't', "STRING",  0, "Plot title"},
   {"text-only",      1,  0,         0, "Output parsed data as text only (no plots)"},
+  {"width",         'w', "PIXELS",  0, "Decimate raw signals to min/max per pixel column (default: 2000, 0 = every sample)"},
   {"verbose",       'v', 0,         0, "Show detailed information"},
+  {"read-id",       'i', "ID",      0, "Fast5 inputs: read to plot (default: first read of each file)"},
+  {"start",          2,  "SAMPLE",  0, "Fast5 inputs: first sample of the plotted window (default: 0)"},
+  {"length",         3,  "SAMPLES", 0, "Fast5 inputs: samples in the window (default: to the end of the read)"},
+  {"pyramid",        4,  0,         0, "Fast5 inputs: cache a min/max pyramid per read (<file>.pyr) for fast zooming"},
+  {"profile",        5,  "FORMAT",  OPTION_ARG_OPTIONAL, "Report time per stage and HDF5/byte counters on stderr at exit: table (default) or json"},
+  {"max-memory",     6,  "SIZE",    0, "Memory budget (e.g. 512M): piped input past it goes to a temporary file, and --width 0 traces past it are decimated"},
   {0}
 };
 
@@ -58,9 +71,24 @@ struct arguments {
   bool png_mode;
   bool text_only;
   bool verbose;
+  size_t width;
+  char *read_id;
+  size_t window_start;
+  size_t window_length;
+  bool use_pyramid;
   char **files;
 };
 
+// Non-negative sample count or position
+static size_t parse_samples(const char *arg, const char *what) {
+  char *end;
+  long long value = strtoll(arg, &end, 10);
+  if (*end != '\0' || value < 0) {
+    errx(EXIT_FAILURE, "%s must be a non-negative number of samples, got %s", what, arg);
+  }
+  return (size_t)value;
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
   struct arguments *arguments = state->input;
 
@@ -84,6 +112,33 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case 'v':
       arguments->verbose = true;
       break;
+    case 'w': {
+      char *end;
+      long width = strtol(arg, &end, 10);
+      if (*end != '\0' || width < 0) {
+        errx(EXIT_FAILURE, "Plot width must be a non-negative number of pixels, got %s", arg);
+      }
+      arguments->width = (size_t)width;
+      break;
+    }
+    case 'i':
+      arguments->read_id = arg;
+      break;
+    case 2:
+      arguments->window_start = parse_samples(arg, "Window start");
+      break;
+    case 3:
+      arguments->window_length = parse_samples(arg, "Window length");
+      break;
+    case 4:
+      arguments->use_pyramid = true;
+      break;
+    case 5:
+      if (!seq_profile_enable(arg)) exit(EXIT_FAILURE);
+      break;
+    case 6:
+      if (!seq_memory_enable(arg)) exit(EXIT_FAILURE);
+      break;
     case ARGP_KEY_NO_ARGS:
       argp_usage(state);
       break;
@@ -103,21 +158,21 @@ static struct argp plot_argp = {options, parse_opt, args_doc, doc};
 // Plot Function
 // **********************************************************************
 // Takes parsed data arary, constructs feedgnuplot command, pipes data to feedgnuplot for rendering
-static int plot_raw_data(raw_data_t *data, int count, const char *title) {
+static int plot_raw_data(raw_data_t *data, size_t count, const char *title) {
   char cmd[512];
   const char *plot_title = title ? title : "Raw Signal Data";
 
   // Calculate x-axis range from data
-  int min_index = data[0].sample_index;
-  int max_index = data[0].sample_index;
-  for (int i = 1; i < count; i++) {
+  size_t min_index = data[0].sample_index;
+  size_t max_index = data[0].sample_index;
+  for (size_t i = 1; i < count; i++) {
     if (data[i].sample_index < min_index) min_index = data[i].sample_index;
     if (data[i].sample_index > max_index) max_index = data[i].sample_index;
   }
 
   // Use feedgnuplot for interactive plotting
   snprintf(cmd, sizeof(cmd),
-           "feedgnuplot --lines --domain --title \"%s\" --xlabel \"Sample Index\" --ylabel \"Raw Value\" --xmin %d --xmax %d",
+           "feedgnuplot --lines --domain --title \"%s\" --xlabel \"Sample Index\" --ylabel \"Raw Value\" --xmin %zu --xmax %zu",
            plot_title, min_index, max_index);
 
   FILE *pipe = popen(cmd, "w");
@@ -127,10 +182,22 @@ static int plot_raw_data(raw_data_t *data, int count, const char *title) {
     return -1;
   }
 
-  // Send data to feedgnuplot
-  fprintf(pipe, "# sample_index raw_value\n");
-  for (int i = 0; i < count; i++) {
-    fprintf(pipe, "%d %f\n", data[i].sample_index, data[i].raw_value);
+  // Send data to feedgnuplot (block-buffered, same text as "%zu %f")
+  seq_output_t out;
+  if (!seq_output_init(&out, pipe, 0)) {
+    fprintf(stderr, "Memory allocation failed\n");
+    pclose(pipe);
+    return -1;
+  }
+  seq_output_str(&out, "# sample_index raw_value\n");
+  for (size_t i = 0; i < count; i++) {
+    seq_output_uint(&out, data[i].sample_index);
+    seq_output_char(&out, ' ');
+    seq_output_fixed6(&out, data[i].raw_value);
+    seq_output_char(&out, '\n');
+  }
+  if (seq_output_close(&out) < 0) {
+    fprintf(stderr, "Warning: failed to send all points to feedgnuplot\n");
   }
 
   int result = pclose(pipe);
@@ -157,6 +224,11 @@ int main_plot(int argc, char *argv[]) {
   arguments.png_mode = false;
   arguments.text_only = false;
   arguments.verbose = false;
+  arguments.width = 2000;
+  arguments.read_id = NULL;
+  arguments.window_start = 0;
+  arguments.window_length = 0;
+  arguments.use_pyramid = false;
   arguments.files = NULL;
 
   // Parse command line arguments using argp framework
@@ -165,8 +237,8 @@ int main_plot(int argc, char *argv[]) {
   // ========================================================================
   // STEP 2: DETERMINE NUMBER OF INPUT FILES TO PROCESS
   // ========================================================================
-  // Note: Unlike other sequelizer commands, plot works on text files (not Fast5)
-  // following Ciren's pattern of accepting direct file arguments
+  // Note: Unlike other sequelizer commands, plot takes direct file arguments (text
+  // signal files or Fast5 files) following Ciren's pattern rather than discovering them
   int file_count = 0;
   for (; arguments.files[file_count]; file_count++) ;
 
@@ -185,6 +257,9 @@ int main_plot(int argc, char *argv[]) {
     if (arguments.limit > 0) {
       printf("Read limit: %d\n", arguments.limit);
     }
+    if (arguments.width > 0) {
+      printf("Decimation: min/max over %zu pixel columns\n", arguments.width);
+    }
     printf("\n");
   }
 
@@ -199,7 +274,12 @@ int main_plot(int argc, char *argv[]) {
     .verbose = arguments.verbose,
     .png_mode = arguments.png_mode,
     .title = arguments.title,
-    .output_file = arguments.output_file
+    .output_file = arguments.output_file,
+    .width = arguments.width,
+    .read_id = arguments.read_id,
+    .window_start = arguments.window_start,
+    .window_length = arguments.window_length,
+    .use_pyramid = arguments.use_pyramid
   };
 
   // Configure plotting callbacks
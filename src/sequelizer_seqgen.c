@@ -18,8 +18,17 @@ Generates signals from read sequences: squiggle, raw, and event sequences.
  Generate raw:                   sequelizer seqgen -g -r -L 200 -o raw_data200.txt
  Generate 5 squiggle:            sequelizer seqgen -g --num-sequences 5 --seq-length 100
  Generate 10 squiggle to file:   sequelizer seqgen --generate --num-sequences 10 --seq-length 50 -o output.txt
+ Sample reads from a genome:     sequelizer seqgen --raw --sample-from genome.fa --num-sequences 100000 --seq-length 2000 --seed 7 -o raw.txt
  Multiple FASTA to one o/p:      sequelizer seqgen file1.fa file2.fa file3.fa -o combined_output.txt
+ Compressed input (gzip/BGZF):   sequelizer seqgen --raw --threads 8 reference.fa.gz -o raw.txt
  Run a size 3 kmer model:        sequelizer seqgen --generate --model rna_r9.4_180mv_70bps --kmer-size 3 --seq-length 10
+ Variable dwells and noise:      sequelizer seqgen --raw --stochastic --model legacy/legacy_r9.4_180mv_450bps_6mer --kmer-size 6 -g -N 100 -L 2000 -S 3
+
+ Real-time streaming (--stream, raw/event only): N pore channels each play one read at a time as
+ fixed-size chunks paced at --srate, interleaved chunk by chunk; binary records described in core/seq_stream.h
+ 512 channels to a basecaller:   sequelizer seqgen --raw --stream 512 --sample-from genome.fa -N 100000 -L 8000 -t 4 | basecaller
+ UNIX socket, drop if behind:    sequelizer seqgen --raw --stream 512 --socket /tmp/basecaller.sock --drop -g -N 100000 -L 5000
+ As fast as possible to a file:  sequelizer seqgen --raw --stream 64 --speed 0 -g -N 1000 -o chunks.bin
 
  Fast5/HDF5 output examples (requires --raw, --fast5, -o):
  Generate single synthetic read:     sequelizer seqgen --raw --fast5 --generate --seq-length 100 -o synthetic.fast5
@@ -32,9 +41,16 @@ Generates signals from read sequences: squiggle, raw, and event sequences.
  Fast5 with read limit:              sequelizer seqgen --raw --fast5 --limit 3 ../reads/many_reads.fa -o limited.fast5
  Limit and multiple i/p files:       sequelizer seqgen --raw --fast5 --limit 100 file1.fa file2.fa file3.fa -o limited.fast5
  Fast5 with reproducible generation: sequelizer seqgen --raw --fast5 --generate --seed 42 --num-sequences 10 -o reproducible.fast5
+ Parallel simulation (same output):  sequelizer seqgen --raw --fast5 --generate --seed 42 --num-sequences 10000 --threads 8 -o corpus.fast5
+ Sampled genome reads to Fast5:      sequelizer seqgen --raw --fast5 --sample-from genome.fa.gz -N 10000 -L 5000 --threads 8 -o sampled.fast5
  Fast5 with kmer model:              sequelizer seqgen --raw --fast5 --generate --model dna_r10.4.1_e8.2_260bps --kmer-size 9 -o kmer.fast5
  Save BOTH fast5 & txt:              sequelizer seqgen --raw --fast5 --save-text --generate --seq-length 50 --num-sequences 1 --reference debug_ref.fa -o debug_signals.fast5
 
+ Binary output (--format bin): raw little-endian float32 with no headers or read names, reads concatenated
+ in order (the "seq length" lines on stderr give each read's extent); raw/event write one value per sample,
+ squiggle writes (current, sd, dwell) triplets per position.
+ Raw float32 stream:                 sequelizer seqgen --raw --format bin --generate --num-sequences 100 -o signals.bin
+
  Notes:
   - design: Input (FASTA or synthetic) -> sequelizer_seqgen.c (CLI tool) -> seqgen_utils.c (high-level wrapper) ->
             seqgen_models.c (dispatcher) -> squiggle_kmer() (k-mer lookup table) -> 
@@ -57,6 +73,9 @@ Generates signals from read sequences: squiggle, raw, and event sequences.
 #include <argp.h>
 #include <dirent.h>     // For directory scanning (--list_models)
 #include <sys/stat.h>   // For stat() to check if directory (--list_models)
+#include <sys/time.h>   // For gettimeofday() (Fast5 write throughput)
+#include <signal.h>     // For ignoring SIGPIPE while streaming
+#include <time.h>       // For nanosleep() (--stream pacing)
 
 #include "core/seqgen_models.h"
 #include "core/seqgen_utils.h"
@@ -64,69 +83,20 @@ Generates signals from read sequences: squiggle, raw, and event sequences.
 #include "core/seq_tensor.h"
 #include "core/kseq.h"         // lightweight FASTA/FASTQ parser from klib
 #include "core/fast5_io.h"     // Fast5 file writing functions
+#include "core/seq_output.h"   // Buffered text/binary signal output
+#include "core/seq_input.h"    // Plain, gzip or BGZF input (BGZF blocks inflated in parallel)
+#include "core/seq_reference.h" // Packed reference genome for --sample-from
+#include "core/seq_stream.h"    // Chunked multi-channel signal stream for --stream
+#include "core/seq_pipeline.h"  // Ordered source -> workers -> writer stages for --threads
+#include "core/seq_profile.h"   // --profile stage timers and counters
+#include "core/seq_memory.h"
+#include "core/seq_shard.h"     // mmap-able training shards for --shards
 
-KSEQ_INIT(int, read) // create a kseq parser that reads from an int fd using the standard C read() system call
-
-// **********************************************************************
-// Helper functions for kseq synthetic sequences
-// **********************************************************************
-
-// Initialize a kseq_t structure for manual population (without file I/O)
-static kseq_t* kseq_init_synthetic(void) {
-  kseq_t *seq = calloc(1, sizeof(kseq_t));
-  if (seq == NULL) return NULL;
-
-  // Initialize the kstring_t structures
-  seq->name.l = seq->name.m = 0;
-  seq->name.s = NULL;
-  seq->comment.l = seq->comment.m = 0;
-  seq->comment.s = NULL;
-  seq->seq.l = seq->seq.m = 0;
-  seq->seq.s = NULL;
-  seq->qual.l = seq->qual.m = 0;
-  seq->qual.s = NULL;
-
-  return seq;
-}
-
-// Set the sequence name in a kseq_t structure
-static void kseq_set_name(kseq_t *seq, const char *name) {
-  if (seq == NULL || name == NULL) return;
-
-  size_t len = strlen(name);
-  if (seq->name.m < len + 1) {
-    seq->name.m = len + 1;
-    seq->name.s = realloc(seq->name.s, seq->name.m);
-  }
-  strcpy(seq->name.s, name);
-  seq->name.l = len;
-}
-
-// Set the sequence data in a kseq_t structure (takes ownership of sequence string)
-static void kseq_set_seq(kseq_t *seq, char *sequence, size_t length) {
-  if (seq == NULL) return;
-
-  // Free existing sequence if any
-  if (seq->seq.s != NULL) {
-    free(seq->seq.s);
-  }
-
-  // Take ownership of the provided sequence
-  seq->seq.s = sequence;
-  seq->seq.l = length;
-  seq->seq.m = length + 1;
-}
-
-// Clean up a synthetic kseq_t (simpler than full kseq_destroy since no file stream)
-static void kseq_destroy_synthetic(kseq_t *seq) {
-  if (seq == NULL) return;
+KSEQ_INIT(seq_input_t*, seq_input_read) // kseq parser over a seq_input stream (decompresses .gz/BGZF transparently)
 
-  if (seq->name.s) free(seq->name.s);
-  if (seq->comment.s) free(seq->comment.s);
-  if (seq->seq.s) free(seq->seq.s);
-  if (seq->qual.s) free(seq->qual.s);
-  free(seq);
-}
+// Reads per pipeline item (--batch): largest allowed, and the default for neural models
+#define SEQGEN_MAX_BATCH    64
+#define SEQGEN_NEURAL_BATCH 16
 
 // **********************************************************************
 // Helper functions for model discovery
@@ -227,45 +197,27 @@ static void list_available_models(const char *models_dir) {
     printf("  (No k-mer models found)\n");
   }
 
+  // Networks are looked for as <models_dir>/<name>.sqnn unless --weights names a file
   printf("\nNeural Network Models:\n");
-  printf("  squiggle_r94 (not yet implemented)\n");
-  printf("  squiggle_r94_rna (not yet implemented)\n");
-  printf("  squiggle_r10 (not yet implemented)\n");
+  const seqgen_model_type neural_models[] = {SEQGEN_MODEL_R9_4, SEQGEN_MODEL_R9_4_RNA, SEQGEN_MODEL_R10};
+  for (size_t i = 0; i < sizeof(neural_models) / sizeof(neural_models[0]); i++) {
+    const char *name = seqgen_neural_model_name(neural_models[i]);
+    char weights_path[1024];
+    snprintf(weights_path, sizeof(weights_path), "%s/%s%s", models_dir, name, SEQGEN_NEURAL_WEIGHTS_EXTENSION);
+    printf("  %s (%s)\n", name, access(weights_path, R_OK) == 0 ? "weights installed" : "needs --weights");
+  }
 
   printf("\nDefault model: rna_r9.4_180mv_70bps (5-mer)\n");
   printf("\nUsage:\n");
   printf("  --model <name>           Specify model name\n");
   printf("  --kmer-size <5|6|9>      Specify k-mer size (default: 5)\n");
   printf("  --models-dir <path>      Custom models directory (default: kmer_models)\n");
+  printf("  --weights <file.sqnn>    Network weights for a neural model\n");
 
   printf("\nExamples:\n");
   printf("  sequelizer seqgen --model dna_r10.4.1_e8.2_260bps --kmer-size 9 input.fa\n");
   printf("  sequelizer seqgen --model legacy/legacy_r9.4_180mv_450bps_6mer --kmer-size 6 input.fa\n");
-}
-
-// **********************************************************************
-// Helper function to count sequences across files
-// **********************************************************************
-
-static int count_total_sequences(char **files, int nfile) {
-  int total = 0;
-
-  for (int i = 0; i < nfile; i++) {
-    FILE *fp = fopen(files[i], "r");
-    if (fp == NULL) {
-      warnx("Failed to open file for counting: %s", files[i]);
-      continue;
-    }
-
-    kseq_t *seq = kseq_init(fileno(fp));
-    while (kseq_read(seq) >= 0) {
-      total++;
-    }
-    kseq_destroy(seq);
-    fclose(fp);
-  }
-
-  return total;
+  printf("  sequelizer seqgen --model squiggle_r10 --weights r10.sqnn --batch 32 --raw input.fa\n");
 }
 
 // **********************************************************************
@@ -274,14 +226,19 @@ static int count_total_sequences(char **files, int nfile) {
 static char doc[] = "sequelizer seqgen -- Signal generation from DNA sequence reads\v"
 "EXAMPLES:\n"
 "  sequelizer seqgen reads.fa\n"
+"  sequelizer seqgen --raw --threads 8 reads.fa.gz   # gzip or BGZF input\n"
 "  sequelizer seqgen -g --num-sequences 5 --seq-length 100\n"
+"  sequelizer seqgen --raw --sample-from genome.fa -N 1000 -L 2000   # reads from both strands\n"
 "  sequelizer seqgen --list-models\n"
-"  sequelizer seqgen --model dna_r10.4.1_e8.2_260bps --kmer-size 9 reads.fa";
+"  sequelizer seqgen --model dna_r10.4.1_e8.2_260bps --kmer-size 9 reads.fa\n"
+"  sequelizer seqgen --raw --stochastic --dwell-cv 0.8 --seed 3 reads.fa\n"
+"  sequelizer seqgen --raw --sample-from genome.fa -N 100000 -L 4000 --shards train/   # training shards\n"
+"  sequelizer seqgen --model squiggle_r10 --weights r10.sqnn --raw --threads 4 reads.fa";
 
-static char args_doc[] = "fasta [fasta ...]";
+static char args_doc[] = "fasta[.gz] [fasta[.gz] ...]";
 
 static struct argp_option options[] = {
-  {"model",         'm', "name",       0, "K-mer model name (e.g., 'rna_r9.4_180mv_70bps', 'dna_r10.4.1_e8.2_260bps')"},
+  {"model",         'm', "name",       0, "K-mer model name (e.g., 'rna_r9.4_180mv_70bps', 'dna_r10.4.1_e8.2_260bps') or neural model (squiggle_r94, squiggle_r94_rna, squiggle_r10)"},
   {"models-dir",    'd', "path",       0, "K-mer models directory (default: 'kmer_models')"},
   {"kmer-size",     'k', "size",       0, "K-mer size for k-mer model (default: 5)"},
   {"limit",         'l', "nreads",     0, "Maximum number of reads to call (0 is unlimited)"},
@@ -300,6 +257,26 @@ static struct argp_option options[] = {
   {"reference",     'R', "filename",   0, "Save sequences to reference FASTA file (use with --generate or multiple inputs)"},
   {"save-text",     'T', 0,            0, "Also save text format when using --fast5 (creates .txt companion file)"},
   {"list-models",   'M', 0,            0, "List available k-mer models and exit"},
+  {"compression",    3,  "level",      0, "Fast5 Signal deflate level 0-9 (default: 1, 0 = uncompressed)"},
+  {"float-signal",   4,  0,            0, "Store Fast5 Signal as float32 instead of calibrated int16"},
+  {"reads-per-file", 5,  "count",      0, "Roll Fast5 output over to numbered files every count reads (default: 4000, 0 = one file)"},
+  {"threads",       't', "N",          0, "Number of simulation worker threads, also used to inflate BGZF input (default: 1; output is identical for any N)"},
+  {"format",         6,  "FORMAT",     0, "Signal output encoding: text (default) or bin (little-endian float32, no headers)"},
+  {"stream",         8,  "channels",   0, "Stream raw/event signal as interleaved chunks from this many simulated pore channels, paced at --srate"},
+  {"chunk-samples",  9,  "count",      0, "Samples per channel per --stream chunk (default: 400)"},
+  {"speed",         10,  "factor",     0, "--stream pacing relative to real time (default: 1, 0 = as fast as possible)"},
+  {"socket",        11,  "path",       0, "Send the --stream chunks to this UNIX socket instead of -o/stdout"},
+  {"drop",          12,  0,            0, "Drop --stream chunks when the consumer falls behind instead of waiting for it"},
+  {"sample-from",    7,  "genome.fa",  0, "Generate --num-sequences reads of --seq-length bases sampled from both strands of this FASTA[.gz] reference (implies --generate)"},
+  {"weights",       13,  "file",       0, "Network weights (.sqnn) for a neural --model (default: <models-dir>/<model>.sqnn)"},
+  {"int8",          14,  0,            0, "Run the neural network with INT8 quantised weights and activations"},
+  {"profile",       16,  "format",     OPTION_ARG_OPTIONAL, "Report time per stage and HDF5/byte counters on stderr at exit: table (default) or json"},
+  {"batch",         15,  "reads",      0, "Reads simulated together by one worker; neural models run one batched forward pass per batch (default: 16 for neural models, 1 otherwise)"},
+  {"stochastic",    17,  0,            0, "Draw each event's dwell (and, for legacy k-mer models, its level and noise level) instead of using the model's fixed values (--raw/--event, k-mer models)"},
+  {"dwell-cv",      18,  "cv",         0, "Coefficient of variation of --stochastic dwells (default: 0.5, 0 = fixed dwell)"},
+  {"shards",        19,  "dir",        0, "Write reads as mmap-able training shards (int16 signal, 2-bit bases, per-event sample runs) into this directory (requires --raw)"},
+  {"shard-size",    20,  "MB",         0, "Start a new --shards file before one would exceed this size (default: 64)"},
+  {"max-memory",    21,  "size",       0, "Memory budget (e.g. 2G): past it, reading waits until simulated reads are written and --shards files are written early"},
   {0}
 };
 
@@ -324,6 +301,25 @@ struct arguments {
   char *reference_filename;
   FILE *reference_file;
   bool save_text;
+  int compression_level;
+  bool float_signal;
+  int reads_per_file;
+  int threads;
+  seq_output_format format;
+  char *sample_reference;
+  int stream_channels;
+  int chunk_samples;
+  double stream_speed;
+  char *stream_socket;
+  bool stream_drop;
+  char *weights_path;
+  bool int8;
+  int batch_size;
+  bool stochastic;
+  float dwell_cv;
+  bool dwell_cv_set;
+  char *shards_dir;
+  int shard_mb;
   char **files;
 };
 
@@ -409,6 +405,97 @@ static int parse_arg(int key, char *arg, struct argp_state *state) {
     case 'T':
       arguments->save_text = true;
       break;
+    case 3:
+      arguments->compression_level = atoi(arg);
+      if (arguments->compression_level < 0 || arguments->compression_level > 9) {
+        errx(EXIT_FAILURE, "Compression level must be between 0 and 9, got %d", arguments->compression_level);
+      }
+      break;
+    case 4:
+      arguments->float_signal = true;
+      break;
+    case 5:
+      arguments->reads_per_file = atoi(arg);
+      if (arguments->reads_per_file < 0) {
+        errx(EXIT_FAILURE, "Reads per file must be non-negative, got %d", arguments->reads_per_file);
+      }
+      break;
+    case 't':
+      arguments->threads = atoi(arg);
+      if (arguments->threads <= 0) {
+        errx(EXIT_FAILURE, "Thread count must be positive, got %d", arguments->threads);
+      }
+      break;
+    case 6:
+      if (!seq_output_parse_format(arg, &arguments->format)) {
+        errx(EXIT_FAILURE, "Unknown output format \"%s\" (expected text or bin)", arg);
+      }
+      break;
+    case 7:
+      arguments->sample_reference = arg;
+      arguments->generate_sequences = true;
+      break;
+    case 8:
+      arguments->stream_channels = atoi(arg);
+      if (arguments->stream_channels <= 0 || arguments->stream_channels > UINT16_MAX) {
+        errx(EXIT_FAILURE, "Channel count must be between 1 and %d, got %s", UINT16_MAX, arg);
+      }
+      break;
+    case 9:
+      arguments->chunk_samples = atoi(arg);
+      if (arguments->chunk_samples <= 0) {
+        errx(EXIT_FAILURE, "Chunk size must be positive, got %d", arguments->chunk_samples);
+      }
+      break;
+    case 10:
+      arguments->stream_speed = atof(arg);
+      if (arguments->stream_speed < 0.0) {
+        errx(EXIT_FAILURE, "Stream speed must be non-negative, got %f", arguments->stream_speed);
+      }
+      break;
+    case 11:
+      arguments->stream_socket = arg;
+      break;
+    case 12:
+      arguments->stream_drop = true;
+      break;
+    case 13:
+      arguments->weights_path = arg;
+      break;
+    case 14:
+      arguments->int8 = true;
+      break;
+    case 15:
+      arguments->batch_size = atoi(arg);
+      if (arguments->batch_size <= 0 || arguments->batch_size > SEQGEN_MAX_BATCH) {
+        errx(EXIT_FAILURE, "Batch size must be between 1 and %d, got %s", SEQGEN_MAX_BATCH, arg);
+      }
+      break;
+    case 16:
+      if (!seq_profile_enable(arg)) exit(EXIT_FAILURE);
+      break;
+    case 17:
+      arguments->stochastic = true;
+      break;
+    case 18:
+      arguments->dwell_cv = atof(arg);
+      arguments->dwell_cv_set = true;
+      if (!(arguments->dwell_cv >= 0.0f) || arguments->dwell_cv > 10.0f) {
+        errx(EXIT_FAILURE, "Dwell coefficient of variation must be between 0 and 10, got %s", arg);
+      }
+      break;
+    case 19:
+      arguments->shards_dir = arg;
+      break;
+    case 20:
+      arguments->shard_mb = atoi(arg);
+      if (arguments->shard_mb <= 0) {
+        errx(EXIT_FAILURE, "Shard size must be a positive number of MB, got %s", arg);
+      }
+      break;
+    case 21:
+      if (!seq_memory_enable(arg)) exit(EXIT_FAILURE);
+      break;
     case 'M':
       // List models and exit
       list_available_models(arguments->models_dir);
@@ -430,6 +517,665 @@ static int parse_arg(int key, char *arg, struct argp_state *state) {
 
 static struct argp argp = { options, parse_arg, args_doc, doc };
 
+// **********************************************************************
+// Read Simulation Stages (source -> simulate -> emit)
+// **********************************************************************
+
+// Random streams: read i draws its sequence from stream 2i and its noise from
+// stream 2i+1 of the run seed, so output depends only on (seed, read index)
+#define SEQGEN_SEQUENCE_STREAM(i) (2 * (uint64_t)(i))
+#define SEQGEN_NOISE_STREAM(i)    (2 * (uint64_t)(i) + 1)
+
+// One read travelling through the pipeline (owns all of its buffers)
+typedef struct {
+  int index;               // 0-based read index (selects the random streams)
+  char *name;
+  char *sequence;          // NULL until generated (synthetic mode generates in the worker)
+  bool sampled;            // --sample-from: the read is bases, a view into the reference (sequence stays NULL)
+  seq_packed bases;
+  size_t length;
+  seq_tensor *squiggle;    // [n_kmers × 3] (squiggle mode only), NULL if generation failed
+  seq_tensor *signal;      // raw or event signal (raw/event modes), NULL if generation failed
+  uint32_t *event_samples; // --shards: samples of each event of signal (the alignment)
+  size_t num_events;
+} seqgen_job_t;
+
+// Read source: synthetic read names or FASTA/FASTQ records, in order
+typedef struct {
+  const struct arguments *args;
+  struct seqgen_model_params model_params;
+  uint64_t rng_seed;
+  int num_iterations;            // Synthetic mode only: file mode runs until the inputs are exhausted
+  int next_index;
+  seq_tensor_pool *signal_pool;  // Recycles signal buffers (freed by the writer, reused by workers)
+  seq_reference_t *reference;    // --sample-from: synthetic reads are windows of this genome
+
+  // File-based mode
+  kseq_t **file_parsers;
+  int nfile;
+  int current_file_idx;
+} seqgen_source_t;
+
+// Ordered output stage state
+typedef struct {
+  struct arguments *args;
+  seq_output_t output;           // Buffered text/binary signal output (args->output)
+  struct seqgen_streamer *streamer;  // --stream: reads go to channels instead of output
+  fast5_writer_t *fast5_writer;
+  seq_shard_writer_t *shard_writer;
+  int reads_started;
+  int fast5_read_count;
+  double write_seconds;
+  float total_dwell_time;
+  size_t total_positions;
+} seqgen_sink_t;
+
+// Fetch the next read; returns false when the input (or --limit) is exhausted
+static bool seqgen_next_job(seqgen_source_t *source, seqgen_job_t *job) {
+  const struct arguments *args = source->args;
+  if (args->generate_sequences && source->next_index >= source->num_iterations) return false;
+  if (args->limit > 0 && source->next_index >= args->limit) return false;
+
+  memset(job, 0, sizeof(*job));
+  job->index = source->next_index;
+
+  if (source->reference) {
+    // SAMPLED MODE: draw the window here (it is cheap) so the name can say where it came from
+    seq_reference_read read;
+    seq_rng rng;
+    seq_rng_init(&rng, source->rng_seed, SEQGEN_SEQUENCE_STREAM(job->index));
+    if (!seq_reference_sample(source->reference, (size_t)args->seq_length, &rng, &read)) {
+      errx(EXIT_FAILURE, "No %d-base window free of ambiguous bases found in reference \"%s\"",
+           args->seq_length, args->sample_reference);
+    }
+    const char *contig = seq_reference_get_contig(source->reference, read.contig)->name;
+    size_t name_size = strlen(contig) + 48;
+    job->name = malloc(name_size);
+    if (job->name) {
+      snprintf(job->name, name_size, "%s:%zu-%zu:%c", contig, read.start + 1, read.start + read.length,
+               read.reverse ? '-' : '+');
+    }
+    job->sampled = true;
+    job->bases = seq_reference_read_bases(source->reference, &read);
+    job->length = read.length;
+  } else if (args->generate_sequences) {
+    // SYNTHETIC MODE: the sequence itself is drawn by the worker
+    char seq_name[32];
+    snprintf(seq_name, sizeof(seq_name), "generated_%03d", job->index + 1);
+    job->name = strdup(seq_name);
+    job->length = (size_t)args->seq_length;
+  } else {
+    // FILE-BASED MODE: Read next sequence, moving on when the current file is exhausted
+    kseq_t *seq = NULL;
+    while (source->current_file_idx < source->nfile) {
+      kseq_t *parser = source->file_parsers[source->current_file_idx];
+      int status = parser != NULL ? kseq_read(parser) : -1;
+      if (status >= 0) {
+        seq = parser;
+        break;
+      }
+      if (status < -1) {
+        warnx("Stopped reading \"%s\": %s", args->files[source->current_file_idx],
+              status == -2 ? "truncated quality string" : "read or decompression error");
+      }
+      source->current_file_idx++;
+    }
+    if (seq == NULL) {
+      // No more sequences available
+      return false;
+    }
+    // kseq reuses its buffers, so the job takes copies
+    job->name = strdup(seq->name.s ? seq->name.s : "");
+    job->sequence = strdup(seq->seq.s);
+    job->length = seq->seq.l;
+    if (NULL == job->sequence) {
+      errx(EXIT_FAILURE, "Failed to copy sequence %d", job->index + 1);
+    }
+  }
+  if (NULL == job->name) {
+    errx(EXIT_FAILURE, "Failed to allocate read name %d", job->index + 1);
+  }
+
+  source->next_index++;
+  return true;
+}
+
+// Sequence -> squiggle -> raw/event signal (thread-safe; touches only the job)
+// Raw (rng != NULL) or event signal for one read; the exact length is known up
+// front for k-mer models, so samples go straight into a recycled pool buffer
+static seq_tensor* seqgen_signal(const seqgen_source_t *source, const seqgen_job_t *job, seq_rng *rng) {
+  const struct arguments *args = source->args;
+  size_t num_samples = predict_signal_length(job->length, &source->model_params, args->sample_rate_khz);
+  if (num_samples == 0) {
+    // Length not known up front (rare): go through the allocating path on an ASCII copy
+    char *unpacked = job->sampled ? seq_unpack(&job->bases) : NULL;
+    const char *sequence = job->sampled ? unpacked : job->sequence;
+    if (NULL == sequence) return NULL;
+    seq_tensor *signal = rng ? sequence_to_raw(sequence, job->length, args->rescale, &source->model_params,
+                                               args->sample_rate_khz, rng)
+                             : sequence_to_event(sequence, job->length, args->rescale, &source->model_params,
+                                                 args->sample_rate_khz);
+    free(unpacked);
+    return signal;
+  }
+
+  seq_tensor *signal = seq_tensor_pool_acquire_float(source->signal_pool, 2, (size_t[]){num_samples, 1});
+  if (NULL == signal) return NULL;
+  float *out = seq_tensor_data_float(signal);
+  int status = job->sampled
+    ? packed_to_signal_into(&job->bases, args->rescale, &source->model_params, args->sample_rate_khz,
+                            rng, out, num_samples, NULL)
+    : sequence_to_signal_into(job->sequence, job->length, args->rescale, &source->model_params,
+                              args->sample_rate_khz, rng, out, num_samples, NULL);
+  if (status < 0) {
+    seq_tensor_free(signal);
+    signal = NULL;
+  }
+  return signal;
+}
+
+// --stochastic: sample the read's events first, so its signal buffer is taken
+// from the pool once at the sampled length. Raw samples (noise) draw from rng
+// after the events; event mode uses it for the events only. With --shards the
+// job keeps the plan's per-event samples as its alignment
+static seq_tensor* seqgen_stochastic_signal(const seqgen_source_t *source, seqgen_job_t *job,
+                                            seq_rng *rng, bool noise) {
+  const struct arguments *args = source->args;
+  seq_packed *owned = job->sampled ? NULL : seq_pack(job->sequence, job->length);
+  const seq_packed *bases = job->sampled ? &job->bases : owned;
+  if (NULL == bases) return NULL;
+
+  seqgen_event_plan plan = {0};
+  seq_tensor *signal = NULL;
+  if (kmer_plan_events(bases, &source->model_params, args->sample_rate_khz, args->dwell_cv, rng, &plan) == 0) {
+    signal = seq_tensor_pool_acquire_float(source->signal_pool, 2, (size_t[]){plan.total_samples, 1});
+    if (signal) kmer_render_events(&plan, noise ? rng : NULL, seq_tensor_data_float(signal));
+    if (signal && args->shards_dir) {
+      job->event_samples = plan.samples;
+      job->num_events = plan.num_events;
+      plan.samples = NULL;
+    }
+  }
+  seqgen_event_plan_free(&plan);
+  seq_packed_free(owned);
+  return signal;
+}
+
+// Synthetic reads draw their sequence here, from the read's own stream
+static void seqgen_prepare_sequence(const seqgen_source_t *source, seqgen_job_t *job) {
+  if (NULL == job->sequence && !job->sampled) {
+    seq_rng rng;
+    seq_rng_init(&rng, source->rng_seed, SEQGEN_SEQUENCE_STREAM(job->index));
+    job->sequence = random_str_rng(source->args->seq_length, &rng);
+    if (NULL == job->sequence) {
+      errx(EXIT_FAILURE, "Failed to generate synthetic sequence %d", job->index + 1);
+    }
+  }
+}
+
+// Raw signal of a squiggle plus the samples of each of its events (--shards)
+static void seqgen_align_squiggle(const seqgen_source_t *source, seqgen_job_t *job, const seq_tensor *squiggle,
+                                  seq_rng *rng) {
+  if (NULL == squiggle) return;
+  size_t num_events = seq_tensor_dim(squiggle, 0);
+  job->event_samples = malloc((num_events ? num_events : 1) * sizeof(uint32_t));
+  if (NULL == job->event_samples) {
+    errx(EXIT_FAILURE, "Memory allocation failed for the events of read %s", job->name);
+  }
+  job->num_events = num_events;
+  squiggle_event_samples(squiggle, source->args->sample_rate_khz, job->event_samples);
+  job->signal = squiggle_to_raw(squiggle, source->args->sample_rate_khz, rng);
+}
+
+static void seqgen_simulate_job(const seqgen_source_t *source, seqgen_job_t *job) {
+  const struct arguments *args = source->args;
+  seq_rng rng;
+
+  seqgen_prepare_sequence(source, job);
+
+  if (args->generate_raw) {
+    // RAW MODE: sequence straight to time-series samples with Gaussian noise (no squiggle tensor)
+    seq_rng_init(&rng, source->rng_seed, SEQGEN_NOISE_STREAM(job->index));
+    if (args->shards_dir && !args->stochastic) {
+      // --shards: the squiggle's dwell column is the alignment, so keep the squiggle step
+      seq_tensor *squiggle = job->sampled
+        ? packed_to_squiggle(&job->bases, args->rescale, &source->model_params)
+        : sequence_to_squiggle(job->sequence, job->length, args->rescale, &source->model_params);
+      seqgen_align_squiggle(source, job, squiggle, &rng);
+      seq_tensor_free(squiggle);
+    } else {
+      job->signal = args->stochastic ? seqgen_stochastic_signal(source, job, &rng, true)
+                                     : seqgen_signal(source, job, &rng);
+    }
+  } else if (args->generate_event) {
+    // EVENT MODE: sequence straight to piecewise-constant signal (no noise)
+    if (args->stochastic) {
+      seq_rng_init(&rng, source->rng_seed, SEQGEN_NOISE_STREAM(job->index));
+      job->signal = seqgen_stochastic_signal(source, job, &rng, false);
+    } else {
+      job->signal = seqgen_signal(source, job, NULL);
+    }
+  } else {
+    // SQUIGGLE MODE: sequence_to_squiggle() -> dispatcher -> squiggle_kmer()
+    job->squiggle = job->sampled
+      ? packed_to_squiggle(&job->bases, args->rescale, &source->model_params)
+      : sequence_to_squiggle(job->sequence, job->length, args->rescale, &source->model_params);
+  }
+}
+
+// Neural models: every read of the batch goes through one forward pass, then
+// each squiggle is turned into its read's raw/event signal on its own noise stream
+static void seqgen_simulate_neural(const seqgen_source_t *source, seqgen_job_t *jobs, int count) {
+  const struct arguments *args = source->args;
+  const seq_packed *batch[SEQGEN_MAX_BATCH];
+  seq_packed *owned[SEQGEN_MAX_BATCH];
+  seq_tensor *squiggles[SEQGEN_MAX_BATCH];
+  seqgen_job_t *batch_jobs[SEQGEN_MAX_BATCH];
+  int n = 0;
+
+  for (int i = 0; i < count; i++) {
+    seqgen_job_t *job = &jobs[i];
+    seqgen_prepare_sequence(source, job);
+    owned[n] = job->sampled ? NULL : seq_pack(job->sequence, job->length);
+    if (!job->sampled && (NULL == owned[n] || job->length == 0)) {
+      seq_packed_free(owned[n]);
+      continue;  // Not A/C/G/T (already reported): the read is emitted without a signal
+    }
+    batch[n] = job->sampled ? &job->bases : owned[n];
+    batch_jobs[n++] = job;
+  }
+
+  bool ok = n > 0 && squiggle_neural_batch(batch, (size_t)n, args->rescale, &source->model_params, squiggles);
+  for (int i = 0; i < n; i++) {
+    seqgen_job_t *job = batch_jobs[i];
+    seq_packed_free(owned[i]);
+    if (!ok) continue;
+
+    if (args->generate_raw) {
+      seq_rng rng;
+      seq_rng_init(&rng, source->rng_seed, SEQGEN_NOISE_STREAM(job->index));
+      if (args->shards_dir) {
+        seqgen_align_squiggle(source, job, squiggles[i], &rng);
+      } else {
+        job->signal = squiggle_to_raw(squiggles[i], args->sample_rate_khz, &rng);
+      }
+      seq_tensor_free(squiggles[i]);
+    } else if (args->generate_event) {
+      job->signal = squiggle_to_event(squiggles[i], args->sample_rate_khz);
+      seq_tensor_free(squiggles[i]);
+    } else {
+      job->squiggle = squiggles[i];
+    }
+  }
+}
+
+// One raw/event signal: text rows "index<TAB>value" under a header, or float32 samples
+static void emit_signal(seq_output_t *out, seq_tensor *signal, const char *header, bool text) {
+  const float *values = seq_tensor_data_float(signal);
+  size_t num_samples = seq_tensor_dim(signal, 0);
+  uint64_t profile_start = SEQ_PROFILE_START();
+  if (!text) {
+    seq_output_f32le(out, values, num_samples);
+  } else {
+    seq_output_str(out, header);
+    for (size_t j = 0; j < num_samples; j++) {
+      seq_output_uint(out, j);
+      seq_output_char(out, '\t');
+      seq_output_fixed6(out, values[j]);
+      seq_output_char(out, '\n');
+    }
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FORMAT, profile_start);
+}
+
+// Free everything a finished job owns
+static void seqgen_release_job(seqgen_job_t *job) {
+  if (job->signal) seq_tensor_free(job->signal);
+  if (job->squiggle) seq_tensor_free(job->squiggle);
+  free(job->event_samples);
+  free(job->sequence);
+  free(job->name);
+}
+
+// **********************************************************************
+// Streaming Channels (--stream)
+// **********************************************************************
+
+// Ring buffer between the channel scheduler and the stream writer thread
+#define SEQGEN_STREAM_BUFFER_BYTES (64 * 1024 * 1024)
+
+// Each channel plays one read at a time; every tick (chunk_samples / sample
+// rate seconds of signal) all busy channels send their next chunk, in channel
+// order. Reads arrive in read order and take the lowest free channel.
+typedef struct {
+  seqgen_job_t job;          // Read being played (valid while busy)
+  bool busy;
+  size_t next_sample;
+  uint32_t read_number;      // Reads started on this channel
+} seqgen_channel_t;
+
+typedef struct seqgen_streamer {
+  seq_stream_t *stream;
+  seqgen_channel_t *channels;
+  int num_channels;
+  int busy_channels;
+  size_t chunk_samples;
+  double tick_seconds;       // Wall time per tick (0 = unpaced)
+  struct timespec start;
+  uint64_t ticks;
+  uint64_t late_ticks;       // Ticks that started after their deadline
+  double max_lag;            // Furthest behind schedule, in seconds
+  uint64_t reads_streamed;
+  uint64_t samples_streamed;
+} seqgen_streamer_t;
+
+static double seconds_since(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// One chunk from every busy channel, then wait for the next tick's deadline
+static void seqgen_stream_tick(seqgen_streamer_t *streamer) {
+  if (streamer->tick_seconds > 0.0) {
+    double wait = streamer->ticks * streamer->tick_seconds - seconds_since(&streamer->start);
+    if (wait > 0.0) {
+      struct timespec pause = {(time_t)wait, (long)((wait - (time_t)wait) * 1e9)};
+      nanosleep(&pause, NULL);
+    } else if (streamer->ticks > 0) {
+      streamer->late_ticks++;
+      if (-wait > streamer->max_lag) streamer->max_lag = -wait;
+    }
+  }
+
+  for (int c = 0; c < streamer->num_channels; c++) {
+    seqgen_channel_t *channel = &streamer->channels[c];
+    if (!channel->busy) continue;
+
+    size_t total = seq_tensor_dim(channel->job.signal, 0);
+    size_t count = total - channel->next_sample;
+    if (count > streamer->chunk_samples) count = streamer->chunk_samples;
+    uint16_t flags = (channel->next_sample == 0 ? SEQ_STREAM_READ_START : 0) |
+                     (channel->next_sample + count == total ? SEQ_STREAM_READ_END : 0);
+    if (seq_stream_send(streamer->stream, (uint16_t)(c + 1), channel->read_number, flags, channel->next_sample,
+                        channel->job.name, seq_tensor_data_float(channel->job.signal) + channel->next_sample,
+                        (uint32_t)count) < 0) {
+      errx(EXIT_FAILURE, "Signal stream closed while sending read %s", channel->job.name);
+    }
+    channel->next_sample += count;
+    streamer->samples_streamed += count;
+
+    if (channel->next_sample == total) {
+      seqgen_release_job(&channel->job);
+      channel->busy = false;
+      streamer->busy_channels--;
+    }
+  }
+  streamer->ticks++;
+}
+
+// Hand a simulated read to the lowest free channel, ticking until one frees up
+static void seqgen_stream_read(seqgen_streamer_t *streamer, seqgen_job_t *job) {
+  if (NULL == job->signal || seq_tensor_dim(job->signal, 0) == 0) {
+    seqgen_release_job(job);
+    return;
+  }
+  while (streamer->busy_channels == streamer->num_channels) {
+    seqgen_stream_tick(streamer);
+  }
+
+  for (int c = 0; c < streamer->num_channels; c++) {
+    seqgen_channel_t *channel = &streamer->channels[c];
+    if (channel->busy) continue;
+    channel->job = *job;
+    channel->busy = true;
+    channel->next_sample = 0;
+    channel->read_number++;
+    streamer->busy_channels++;
+    streamer->reads_streamed++;
+    return;
+  }
+}
+
+static seqgen_streamer_t* seqgen_stream_open(const struct arguments *args, int fd) {
+  seqgen_streamer_t *streamer = calloc(1, sizeof(seqgen_streamer_t));
+  if (!streamer) {
+    errx(EXIT_FAILURE, "Memory allocation failed for signal stream");
+  }
+  streamer->channels = calloc(args->stream_channels, sizeof(seqgen_channel_t));
+  streamer->stream = seq_stream_open(fd, SEQGEN_STREAM_BUFFER_BYTES, args->stream_drop);
+  if (!streamer->channels || !streamer->stream) {
+    errx(EXIT_FAILURE, "Memory allocation failed for signal stream");
+  }
+  streamer->num_channels = args->stream_channels;
+  streamer->chunk_samples = (size_t)args->chunk_samples;
+  streamer->tick_seconds = args->stream_speed > 0.0
+    ? args->chunk_samples / (args->sample_rate_khz * 1000.0) / args->stream_speed : 0.0;
+  clock_gettime(CLOCK_MONOTONIC, &streamer->start);
+  return streamer;
+}
+
+// Play out every read still on a channel, drain the stream and report (on stderr,
+// since stdout may be the stream)
+static void seqgen_stream_close(seqgen_streamer_t *streamer) {
+  while (streamer->busy_channels > 0) {
+    seqgen_stream_tick(streamer);
+  }
+  double elapsed = seconds_since(&streamer->start);
+
+  seq_stream_stats_t stats;
+  if (seq_stream_close(streamer->stream, &stats) < 0) {
+    errx(EXIT_FAILURE, "Signal stream write failed");
+  }
+
+  fprintf(stderr, "Streamed %llu reads on %d channels: %llu chunks (%.1f MB), %llu dropped, in %.2f s\n",
+          (unsigned long long)streamer->reads_streamed, streamer->num_channels,
+          (unsigned long long)stats.chunks_sent, stats.bytes_sent / 1e6,
+          (unsigned long long)stats.chunks_dropped, elapsed);
+  if (elapsed > 0.0) {
+    fprintf(stderr, "  Throughput: %.2f Msamples/s (%.0f samples/s per channel)\n",
+            streamer->samples_streamed / elapsed / 1e6,
+            streamer->samples_streamed / elapsed / streamer->num_channels);
+  }
+  if (streamer->tick_seconds > 0.0) {
+    fprintf(stderr, "  Lag: %llu of %llu ticks late, at most %.3f s behind; waited %.3f s on the consumer\n",
+            (unsigned long long)streamer->late_ticks, (unsigned long long)streamer->ticks,
+            streamer->max_lag, stats.blocked_seconds);
+  }
+
+  free(streamer->channels);
+  free(streamer);
+}
+
+// Append a read and its event alignment to the current training shard
+static void seqgen_shard_job(seqgen_sink_t *sink, const seqgen_job_t *job) {
+  seq_packed *owned = job->sampled ? NULL : seq_pack(job->sequence, job->length);
+  const seq_packed *bases = job->sampled ? &job->bases : owned;
+  if (NULL == bases) return;  // Not A/C/G/T (already reported)
+
+  uint64_t profile_start = SEQ_PROFILE_START();
+  if (seq_shard_writer_append(sink->shard_writer, job->name, seq_tensor_data_float(job->signal),
+                              seq_tensor_dim(job->signal, 0), bases, job->event_samples, job->num_events) < 0) {
+    errx(EXIT_FAILURE, "Failed to write read %s to shards in %s", job->name, sink->args->shards_dir);
+  }
+  SEQ_PROFILE_STOP(SEQ_PROFILE_FORMAT, profile_start);
+  seq_packed_free(owned);
+}
+
+// Write one finished read (called in read order) and release the job
+static void seqgen_emit_job(seqgen_sink_t *sink, seqgen_job_t *job) {
+  struct arguments *args = sink->args;
+  sink->reads_started++;
+
+  // Write sequence to reference file if requested
+  if (args->reference_file != NULL) {
+    char *unpacked = job->sampled ? seq_unpack(&job->bases) : NULL;
+    const char *sequence = job->sampled ? unpacked : job->sequence;
+    if (NULL == sequence) {
+      errx(EXIT_FAILURE, "Failed to allocate sequence for read %s", job->name);
+    }
+    if (job->name[0] != '\0') {
+      fprintf(args->reference_file, ">%s\n%s\n", job->name, sequence);
+    } else {
+      fprintf(args->reference_file, ">sequence_%d\n%s\n", sink->reads_started, sequence);
+    }
+    free(unpacked);
+  }
+
+  // --stream: the read plays out on a channel (which releases it when done)
+  if (sink->streamer) {
+    seqgen_stream_read(sink->streamer, job);
+    return;
+  }
+
+  // Debug output: show sequence length (on stderr for --format bin, whose stdout is float32 only)
+  fprintf(args->format == SEQ_OUTPUT_TEXT ? stdout : stderr, "seq length %zu\n", job->length);
+
+  if (NULL != job->squiggle || NULL != job->signal) {
+    seq_output_t *out = &sink->output;
+    bool text = args->format == SEQ_OUTPUT_TEXT;
+    // Signals go to the output unless written to Fast5 or shards (--save-text keeps a copy)
+    bool signal_output = (!args->output_fast5 && !args->shards_dir) || args->save_text;
+
+    // Write sequence identifier to output (skip for Fast5 mode unless save_text is enabled)
+    if (text && signal_output) {
+      seq_output_char(out, '#');
+      seq_output_str(out, job->name);
+      seq_output_char(out, '\n');
+    }
+
+    if (args->generate_raw) {
+      if (NULL != job->signal) {
+        // Signal output (always without --fast5, alongside Fast5 with --save-text)
+        if (signal_output) {
+          emit_signal(out, job->signal, "sample_index\traw_value\n", text);
+        }
+
+        if (args->output_fast5) {
+          // Fast5 mode: hand the tensor to the streaming writer (it frees it once written)
+          struct timeval write_start, write_end;
+          gettimeofday(&write_start, NULL);
+          if (fast5_writer_append_read(sink->fast5_writer, job->signal, job->name) < 0) {
+            errx(EXIT_FAILURE, "Failed to write read %s to Fast5 file: %s",
+                 job->name, fast5_writer_current_filename(sink->fast5_writer));
+          }
+          gettimeofday(&write_end, NULL);
+          sink->write_seconds += (write_end.tv_sec - write_start.tv_sec) +
+                                 (write_end.tv_usec - write_start.tv_usec) / 1000000.0;
+          sink->fast5_read_count++;
+          job->signal = NULL;
+        }
+
+        if (sink->shard_writer) {
+          seqgen_shard_job(sink, job);
+        }
+      }
+    } else if (args->generate_event) {
+      if (NULL != job->signal) {
+        emit_signal(out, job->signal, "sample_index\tevent_value\n", text);
+      }
+    } else {
+      // SQUIGGLE MODE (default): Output the three squiggle features
+      float *data = seq_tensor_data_float(job->squiggle);
+      size_t num_positions = seq_tensor_dim(job->squiggle, 0);
+
+      uint64_t profile_start = SEQ_PROFILE_START();
+      if (text) {
+        seq_output_str(out, "pos\tbase\tcurrent\tsd\tdwell\n");
+        for (size_t j = 0; j < num_positions; j++) {
+          seq_output_uint(out, j);
+          seq_output_char(out, '\t');
+          seq_output_char(out, job->sampled ? "ACGT"[seq_packed_base(&job->bases, j)] : job->sequence[j]);
+          for (int f = 0; f < 3; f++) {
+            seq_output_char(out, '\t');
+            seq_output_fixed6(out, data[j * 3 + f]);
+          }
+          seq_output_char(out, '\n');
+        }
+      } else {
+        seq_output_f32le(out, data, num_positions * 3);
+      }
+      SEQ_PROFILE_STOP(SEQ_PROFILE_FORMAT, profile_start);
+
+      // Accumulate dwell time statistics
+      for (size_t j = 0; j < num_positions; j++) {
+        sink->total_dwell_time += data[j * 3 + 2];
+        sink->total_positions++;
+      }
+    }
+
+    // Hand each read to the stream before the next "seq length" line so text output stays interleaved
+    if (seq_output_flush(out) < 0) {
+      errx(EXIT_FAILURE, "Failed to write signal output for read %s", job->name);
+    }
+  }
+
+  seqgen_release_job(job);
+}
+
+// **********************************************************************
+// Parallel Pipeline (reader thread -> N simulation workers -> ordered writer)
+// **********************************************************************
+
+typedef struct {
+  seqgen_source_t *source;
+  seqgen_sink_t *sink;
+} seqgen_stages_t;
+
+// Pipeline item: up to --batch consecutive reads, simulated by one worker
+typedef struct {
+  int count;
+  seqgen_job_t jobs[SEQGEN_MAX_BATCH];
+} seqgen_batch_t;
+
+// The source is only touched by the pipeline's source thread
+static bool seqgen_source_stage(void *context, void *item) {
+  seqgen_source_t *source = ((seqgen_stages_t*)context)->source;
+  seqgen_batch_t *batch = (seqgen_batch_t*)item;
+  batch->count = 0;
+  while (batch->count < source->args->batch_size && seqgen_next_job(source, &batch->jobs[batch->count])) {
+    batch->count++;
+  }
+  return batch->count > 0;
+}
+
+static void seqgen_simulate_stage(void *context, void *item) {
+  const seqgen_source_t *source = ((seqgen_stages_t*)context)->source;
+  seqgen_batch_t *batch = (seqgen_batch_t*)item;
+  if (seqgen_neural_model_name(source->model_params.model_type)) {
+    seqgen_simulate_neural(source, batch->jobs, batch->count);
+    return;
+  }
+  for (int i = 0; i < batch->count; i++) {
+    seqgen_simulate_job(source, &batch->jobs[i]);
+  }
+}
+
+// Emit takes over the jobs' buffers (the slot is reused once this returns)
+static void seqgen_emit_stage(void *context, void *item) {
+  seqgen_batch_t *batch = (seqgen_batch_t*)item;
+  for (int i = 0; i < batch->count; i++) {
+    seqgen_emit_job(((seqgen_stages_t*)context)->sink, &batch->jobs[i]);
+  }
+}
+
+// Run the whole read stream through the stages; output order and content do not depend on num_threads
+static void run_seqgen_pipeline(seqgen_source_t *source, seqgen_sink_t *sink, int num_threads) {
+  seqgen_stages_t stages = {source, sink};
+  seq_pipeline_config config = {
+    .source = seqgen_source_stage,
+    .transform = seqgen_simulate_stage,
+    .sink = seqgen_emit_stage,
+    .context = &stages,
+    .item_size = sizeof(seqgen_batch_t),
+    .num_workers = num_threads,
+    .max_in_flight = 4 * (size_t)num_threads  // Batches; matches the signal pool sizing in main
+  };
+  if (!seq_pipeline_run(&config)) {
+    errx(EXIT_FAILURE, "Cannot run the simulation pipeline");
+  }
+}
+
 // **********************************************************************
 // Main Function
 // **********************************************************************
@@ -461,6 +1207,25 @@ int main_seqgen(int argc, char *argv[]) {
   arguments.reference_filename = NULL;
   arguments.reference_file = NULL;
   arguments.save_text = false;
+  arguments.compression_level = 1;
+  arguments.float_signal = false;
+  arguments.reads_per_file = 4000;
+  arguments.threads = 1;
+  arguments.format = SEQ_OUTPUT_TEXT;
+  arguments.sample_reference = NULL;
+  arguments.stream_channels = 0;
+  arguments.chunk_samples = 400;
+  arguments.stream_speed = 1.0;
+  arguments.stream_socket = NULL;
+  arguments.stream_drop = false;
+  arguments.weights_path = NULL;
+  arguments.int8 = false;
+  arguments.batch_size = 0;  // Chosen by model type below
+  arguments.stochastic = false;
+  arguments.dwell_cv = 0.5f;
+  arguments.dwell_cv_set = false;
+  arguments.shards_dir = NULL;
+  arguments.shard_mb = 0;
   arguments.files = NULL;
 
   // ========================================================================
@@ -478,6 +1243,46 @@ int main_seqgen(int argc, char *argv[]) {
     }
   }
 
+  // Validate --shards constraints (shards hold raw signal with its alignment)
+  if (arguments.shards_dir) {
+    if (!arguments.generate_raw) {
+      errx(EXIT_FAILURE, "--shards requires --raw");
+    }
+    if (arguments.output_fast5 || arguments.stream_channels > 0) {
+      errx(EXIT_FAILURE, "--shards cannot be combined with --fast5 or --stream");
+    }
+  } else if (arguments.shard_mb > 0) {
+    errx(EXIT_FAILURE, "--shard-size applies to --shards only");
+  }
+
+  // Validate --sample-from constraints
+  if (arguments.sample_reference && arguments.files) {
+    errx(EXIT_FAILURE, "--sample-from generates its reads from the reference; it cannot be combined with input files");
+  }
+
+  // Validate --stream constraints (chunks are raw or event samples)
+  bool streaming = arguments.stream_channels > 0;
+  if (streaming && !arguments.generate_raw && !arguments.generate_event) {
+    errx(EXIT_FAILURE, "--stream requires --raw or --event");
+  }
+  if (streaming && arguments.output_fast5) {
+    errx(EXIT_FAILURE, "--stream cannot be combined with --fast5");
+  }
+  if (!streaming && (arguments.stream_socket || arguments.stream_drop)) {
+    errx(EXIT_FAILURE, "--socket and --drop apply to --stream only");
+  }
+
+  // Validate --stochastic constraints (it samples signal events, not squiggles)
+  if (arguments.stochastic && !arguments.generate_raw && !arguments.generate_event) {
+    errx(EXIT_FAILURE, "--stochastic requires --raw or --event");
+  }
+  if (arguments.dwell_cv_set && !arguments.stochastic) {
+    errx(EXIT_FAILURE, "--dwell-cv applies to --stochastic only");
+  }
+
+  // Status lines go to stderr while streaming, stdout may carry the stream
+  FILE *info = streaming ? stderr : stdout;
+
   // Validate --save-text constraints
   if (arguments.save_text && !arguments.output_fast5) {
     errx(EXIT_FAILURE, "--save-text flag requires --fast5 flag (text output is automatic without --fast5)");
@@ -485,14 +1290,15 @@ int main_seqgen(int argc, char *argv[]) {
 
   // Set up text output file for --save-text mode
   if (arguments.save_text) {
-    // Create companion text file by replacing .fast5 extension with .txt
+    // Create companion file by replacing .fast5 extension with .txt (.bin for --format bin)
+    const char *companion_ext = seq_output_format_extension(arguments.format);
     char *text_filename = malloc(strlen(arguments.output_filename) + 10);
     strcpy(text_filename, arguments.output_filename);
     char *ext = strrchr(text_filename, '.');
     if (ext && strcmp(ext, ".fast5") == 0) {
-      strcpy(ext, ".txt");
+      strcpy(ext, companion_ext);
     } else {
-      strcat(text_filename, ".txt");
+      strcat(text_filename, companion_ext);
     }
     arguments.output = fopen(text_filename, "w");
     if (NULL == arguments.output) {
@@ -505,295 +1311,209 @@ int main_seqgen(int argc, char *argv[]) {
   }
 
   // ========================================================================
-  // STEP 3: Initialize counters and pointers, determine loop parameters
+  // STEP 3: Set up the read source, model parameters and output sink
   // ========================================================================
-  int reads_started = 0;
-  const int reads_limit = arguments.limit;
+  // Load the model once (k-mer tables or network weights), shared read-only by all workers
+  seqgen_model_type model_type = get_seqgen_model(arguments.model_name);
+  bool neural = seqgen_neural_model_name(model_type) != NULL;
+  if (!neural && (arguments.weights_path || arguments.int8)) {
+    errx(EXIT_FAILURE, "--weights and --int8 apply to the neural models (squiggle_r94, squiggle_r94_rna, squiggle_r10)");
+  }
+  if (neural && arguments.stochastic) {
+    errx(EXIT_FAILURE, "--stochastic applies to the k-mer models (neural models predict their own dwells)");
+  }
+  if (arguments.batch_size == 0) {
+    arguments.batch_size = neural ? SEQGEN_NEURAL_BATCH : 1;
+  }
 
-  // Determine loop count and Fast5 capacity based on mode
-  int num_iterations;  // Total number of sequences to process
-  int nfile = 0;       // Number of input files (file-based mode only)
-  int fast5_capacity;  // Initial capacity for Fast5 arrays
+  seqgen_kmer_context *kmer_context = NULL;
+  seq_nn_model *network = NULL;
+  struct seqgen_model_params model_params;
+
+  if (neural) {
+    char weights_path[1024];
+    snprintf(weights_path, sizeof(weights_path), "%s/%s%s", arguments.models_dir, arguments.model_name,
+             SEQGEN_NEURAL_WEIGHTS_EXTENSION);
+    const char *path = arguments.weights_path ? arguments.weights_path : weights_path;
+    network = seq_nn_model_load(path);
+    if (NULL == network) {
+      errx(EXIT_FAILURE, "Failed to load network weights for \"%s\" (use --weights FILE)", arguments.model_name);
+    }
+    if (seq_nn_model_outputs(network) != 3) {
+      errx(EXIT_FAILURE, "Network \"%s\" has %zu outputs per base, a squiggle model needs 3",
+           path, seq_nn_model_outputs(network));
+    }
+    if (arguments.int8 && !seq_nn_model_quantise(network)) {
+      errx(EXIT_FAILURE, "Failed to quantise network \"%s\" to INT8", path);
+    }
+    model_params = (struct seqgen_model_params){
+      .model_type = model_type,
+      .params.neural = {
+        .weights_path = path,
+        .models_dir = arguments.models_dir,
+        .int8 = arguments.int8,
+        .model = network
+      }
+    };
+  } else {
+    kmer_context = seqgen_kmer_context_create(arguments.models_dir, arguments.model_name);
+    if (NULL == kmer_context) {
+      errx(EXIT_FAILURE, "Failed to load k-mer model \"%s\" from %s", arguments.model_name, arguments.models_dir);
+    }
+    if (arguments.kmer_size > kmer_context->max_kmer_size) {
+      errx(EXIT_FAILURE, "K-mer size %d is larger than the %d-mer model \"%s\"",
+           arguments.kmer_size, kmer_context->max_kmer_size, arguments.model_name);
+    }
+    model_params = (struct seqgen_model_params){
+      .model_type = SEQGEN_MODEL_KMER,
+      .params.kmer = {
+        .model_name = arguments.model_name,
+        .models_dir = arguments.models_dir,
+        .kmer_size = arguments.kmer_size,
+        .sample_rate_khz = arguments.sample_rate_khz,
+        .context = kmer_context
+      }
+    };
+  }
+
+  size_t reads_in_flight = 4 * (size_t)(arguments.threads > 1 ? arguments.threads : 1) * (size_t)arguments.batch_size;
+  seqgen_source_t source = {
+    .args = &arguments,
+    .model_params = model_params,
+    // Without --seed every run draws a fresh seed
+    .rng_seed = arguments.use_seed ? (uint64_t)arguments.seed : seq_rng_entropy_seed(),
+    .next_index = 0,
+    // Enough idle buffers for every read in flight (pipeline ring + the writer's held batch)
+    .signal_pool = seq_tensor_pool_create(reads_in_flight + (size_t)arguments.batch_size + 1)
+  };
+  if (NULL == source.signal_pool) {
+    errx(EXIT_FAILURE, "Memory allocation failed for signal buffer pool");
+  }
 
   // File-based mode: need to track current file and sequence parser
-  FILE **file_handles = NULL;
-  kseq_t **file_parsers = NULL;
-  int current_file_idx = 0;
-  kseq_t *current_seq = NULL;
+  seq_input_t **file_handles = NULL;
+  int nfile = 0;       // Number of input files (file-based mode only)
 
   if (arguments.generate_sequences) {
     // SYNTHETIC MODE: loop count = number of sequences to generate
-    num_iterations = arguments.num_sequences;
-    fast5_capacity = (reads_limit > 0) ? reads_limit : num_iterations;
+    source.num_iterations = arguments.num_sequences;
+
+    // Packed once; every read is a view into it, so nothing is copied per read
+    if (arguments.sample_reference) {
+      source.reference = seq_reference_open(arguments.sample_reference, arguments.threads);
+      if (NULL == source.reference) {
+        errx(EXIT_FAILURE, "Failed to load reference \"%s\"", arguments.sample_reference);
+      }
+      fprintf(info, "Sampling reads from %s: %zu contigs, %zu bases (%zu ambiguous)\n", arguments.sample_reference,
+             seq_reference_num_contigs(source.reference), seq_reference_total_length(source.reference),
+             seq_reference_ambiguous_bases(source.reference));
+    }
   } else {
-    // FILE-BASED MODE: count files and total sequences
+    // FILE-BASED MODE: one pass over the inputs, reads are simulated as they are parsed
     for (; arguments.files[nfile]; nfile++); // count files
 
-    // Pre-count total sequences across all files
-    int total_sequences = count_total_sequences(arguments.files, nfile);
-    num_iterations = total_sequences;
-    fast5_capacity = (reads_limit > 0) ? reads_limit : total_sequences;
-
     // Open all files and initialize parsers
-    file_handles = calloc(nfile, sizeof(FILE*));
-    file_parsers = calloc(nfile, sizeof(kseq_t*));
+    file_handles = calloc(nfile, sizeof(seq_input_t*));
+    source.file_parsers = calloc(nfile, sizeof(kseq_t*));
+    source.nfile = nfile;
+    if (nfile > 0 && (NULL == file_handles || NULL == source.file_parsers)) {
+      errx(EXIT_FAILURE, "Memory allocation failed for input parsers");
+    }
 
-    // Open files & create kseq parsers
+    // Open files & create kseq parsers (gzip/BGZF inputs are detected from their contents)
     for (int i = 0; i < nfile; i++) {
-      file_handles[i] = fopen(arguments.files[i], "r");
+      file_handles[i] = seq_input_open(arguments.files[i], arguments.threads);
       if (NULL == file_handles[i]) {
-        warnx("Failed to open \"%s\" for input", arguments.files[i]);
         continue;
       }
-      file_parsers[i] = kseq_init(fileno(file_handles[i]));
-    }
-
-    // Find first valid file & select its kseq_t parser
-    current_file_idx = 0;
-    while (current_file_idx < nfile && file_parsers[current_file_idx] == NULL) {
-      current_file_idx++;
-    }
-    if (current_file_idx < nfile) {
-      current_seq = file_parsers[current_file_idx];
+      source.file_parsers[i] = kseq_init(file_handles[i]);
     }
   }
 
-  // Add dwell time tracking variables
-  float total_dwell_time = 0.0f;
-  size_t total_positions = 0;
-
-  // Initialize random seed if requested
-  if (arguments.use_seed) {
-    srand(arguments.seed);
+  seqgen_sink_t sink = {
+    .args = &arguments
+  };
+  if (!seq_output_init(&sink.output, arguments.output, 0)) {
+    errx(EXIT_FAILURE, "Memory allocation failed for output buffer");
   }
 
-  // Fast5 mode: prepare arrays to collect data
-  seq_tensor **fast5_raw_signals = NULL;
-  const char **fast5_read_names = NULL;
-  int fast5_read_count = 0;
+  // Fast5 mode: open a streaming writer, each read is written (and freed) as it is generated
+  fast5_write_options_t write_options;
 
   if (arguments.output_fast5) {
-    fast5_raw_signals = calloc(fast5_capacity, sizeof(seq_tensor*));
-    fast5_read_names = calloc(fast5_capacity, sizeof(char*));
-    if (NULL == fast5_raw_signals || NULL == fast5_read_names) {
-      errx(EXIT_FAILURE, "Failed to allocate memory for Fast5 data collection");
+    fast5_write_options_init(&write_options);
+    write_options.compression_level = arguments.compression_level;
+    write_options.quantise_int16 = !arguments.float_signal;
+
+    sink.fast5_writer = fast5_writer_open(arguments.output_filename, arguments.sample_rate_khz,
+                                          &write_options, (size_t)arguments.reads_per_file);
+    if (NULL == sink.fast5_writer) {
+      errx(EXIT_FAILURE, "Failed to open Fast5 writer for: %s", arguments.output_filename);
     }
   }
 
-  // ========================================================================
-  // STEP 4: FLAT UNIFIED PROCESSING LOOP (handles both synthetic and file-based modes)
-  // ========================================================================
-  for (int i = 0; i < num_iterations; i++) {
-    // Respect user-specified read limit
-    if (reads_limit > 0 && reads_started >= reads_limit) {
-      break;
-    }
-    reads_started += 1;
-
-    // ======================================================================
-    // STEP 4.1: Obtain next sequence (either synthetic or from file)
-    // ======================================================================
-    kseq_t *seq = NULL;
-    bool is_synthetic = false;
-
-    if (arguments.generate_sequences) {
-      // SYNTHETIC MODE: Create a new sequence
-      seq = kseq_init_synthetic();
-      if (NULL == seq) {
-        errx(EXIT_FAILURE, "Failed to allocate kseq_t for synthetic sequence %d", i + 1);
-      }
-      is_synthetic = true;
-
-      // Generate synthetic DNA sequence and populate kseq_t
-      char *generated_sequence = random_str(arguments.seq_length);
-      if (NULL == generated_sequence) {
-        kseq_destroy_synthetic(seq);
-        errx(EXIT_FAILURE, "Failed to generate synthetic sequence %d", i + 1);
-      }
-
-      // Populate kseq_t fields
-      char seq_name[32];
-      snprintf(seq_name, sizeof(seq_name), "generated_%03d", i + 1);
-      kseq_set_name(seq, seq_name);
-      kseq_set_seq(seq, generated_sequence, arguments.seq_length);
-    } else {
-      // FILE-BASED MODE: Read next sequence from current file
-      // Find next file with sequences if current file is exhausted
-      while (current_file_idx < nfile) {
-        if (current_seq != NULL && kseq_read(current_seq) >= 0) {
-          seq = current_seq;
-          break;
-        }
-        // Current file exhausted, move to next file
-        current_file_idx++;
-        if (current_file_idx < nfile) {
-          current_seq = file_parsers[current_file_idx];
-        }
-      }
-
-      if (seq == NULL) {
-        // No more sequences available
-        break;
-      }
-    }
-
-    // Write sequence to reference file if requested
-    if (arguments.reference_file != NULL) {
-      if (seq->name.l > 0) {
-        fprintf(arguments.reference_file, ">%s\n%s\n", seq->name.s, seq->seq.s);
-      } else {
-        fprintf(arguments.reference_file, ">sequence_%d\n%s\n", reads_started, seq->seq.s);
-      }
+  // Shard mode: reads are gathered into the current shard, written out as each fills
+  if (arguments.shards_dir) {
+    sink.shard_writer = seq_shard_writer_open(arguments.shards_dir, arguments.sample_rate_khz,
+                                              neural ? 1 : arguments.kmer_size,
+                                              (size_t)arguments.shard_mb << 20);
+    if (NULL == sink.shard_writer) {
+      errx(EXIT_FAILURE, "Failed to open shard writer for: %s", arguments.shards_dir);
     }
+  }
 
-    // Debug output: show sequence length
-    printf("seq length %zu\n", seq->seq.l);
-
-    // ======================================================================
-    // STEP 4.2: Set up model parameters for k-mer dispatcher
-    // ======================================================================
-    struct seqgen_model_params model_params = {
-      .model_type = SEQGEN_MODEL_KMER,
-      .params = {
-        .kmer = {
-          .model_name = arguments.model_name,
-          .models_dir = arguments.models_dir,
-          .kmer_size = arguments.kmer_size,
-          .sample_rate_khz = arguments.sample_rate_khz
-        }
-      }
-    };
-
-    // ======================================================================
-    // STEP 4.3: Generate squiggle data from sequence
-    // This calls sequence_to_squiggle() -> dispatcher -> squiggle_kmer()
-    // ======================================================================
-    seq_tensor *squiggle = sequence_to_squiggle(
-      seq->seq.s,
-      seq->seq.l,
-      arguments.rescale,
-      &model_params
-    );
-
-    if (NULL != squiggle) {
-      // Write sequence identifier to output (skip for Fast5 mode unless save_text is enabled)
-      if (!arguments.output_fast5 || arguments.save_text) {
-        fprintf(arguments.output, "#%s\n", seq->name.s);
-      }
-
-      // ====================================================================
-      // STEP 4.4: Generate final output based on user's requested format
-      // ====================================================================
-      if (arguments.generate_raw) {
-        // RAW MODE: Convert squiggle events to time-series samples with Gaussian noise
-        seq_tensor *raw_signal = squiggle_to_raw(squiggle, arguments.sample_rate_khz);
-        if (NULL != raw_signal) {
-          if (arguments.output_fast5) {
-            // Fast5 mode: check capacity and expand if needed
-            if (fast5_read_count >= fast5_capacity) {
-              fast5_capacity *= 2;
-              fast5_raw_signals = realloc(fast5_raw_signals, fast5_capacity * sizeof(seq_tensor*));
-              fast5_read_names = realloc(fast5_read_names, fast5_capacity * sizeof(char*));
-              if (NULL == fast5_raw_signals || NULL == fast5_read_names) {
-                errx(EXIT_FAILURE, "Failed to expand Fast5 data arrays");
-              }
-            }
-
-            // Store the tensor and read name (we own these now)
-            fast5_raw_signals[fast5_read_count] = raw_signal;
-            fast5_read_names[fast5_read_count] = strdup(seq->name.s);
-            fast5_read_count++;
-
-            // Also output text if save_text is enabled
-            if (arguments.save_text) {
-              fprintf(arguments.output, "sample_index\traw_value\n");
-              float *raw_data = seq_tensor_data_float(raw_signal);
-              size_t num_samples = seq_tensor_dim(raw_signal, 0);
-              for (size_t j = 0; j < num_samples; j++) {
-                fprintf(arguments.output, "%zu\t%3.6f\n", j, raw_data[j]);
-              }
-            }
-          } else {
-            // Text mode: output to file/stdout then free
-            fprintf(arguments.output, "sample_index\traw_value\n");
-            float *raw_data = seq_tensor_data_float(raw_signal);
-            size_t num_samples = seq_tensor_dim(raw_signal, 0);
-            for (size_t j = 0; j < num_samples; j++) {
-              fprintf(arguments.output, "%zu\t%3.6f\n", j, raw_data[j]);
-            }
-            seq_tensor_free(raw_signal);
-          }
-        }
-      } else if (arguments.generate_event) {
-        // EVENT MODE: Convert squiggle to piecewise-constant signal (no noise)
-        seq_tensor *event_signal = squiggle_to_event(squiggle, arguments.sample_rate_khz);
-        if (NULL != event_signal) {
-          fprintf(arguments.output, "sample_index\tevent_value\n");
-          float *event_data = seq_tensor_data_float(event_signal);
-          size_t num_samples = seq_tensor_dim(event_signal, 0);
-          for (size_t j = 0; j < num_samples; j++) {
-            fprintf(arguments.output, "%zu\t%3.6f\n", j, event_data[j]);
-          }
-          seq_tensor_free(event_signal);
-        }
-      } else {
-        // SQUIGGLE MODE (default): Output the three squiggle features
-        fprintf(arguments.output, "pos\tbase\tcurrent\tsd\tdwell\n");
-        float *data = seq_tensor_data_float(squiggle);
-        size_t num_positions = seq_tensor_dim(squiggle, 0);
-
-        for (size_t j = 0; j < num_positions; j++) {
-          float current = data[j * 3 + 0];
-          float stddev = data[j * 3 + 1];
-          float dwell_time = data[j * 3 + 2];
-
-          fprintf(arguments.output, "%zu\t%c\t%3.6f\t%3.6f\t%3.6f\n",
-                  j,
-                  seq->seq.s[j],
-                  current,
-                  stddev,
-                  dwell_time);
-
-          // Accumulate dwell time statistics
-          total_dwell_time += dwell_time;
-          total_positions++;
-        }
-      }
-
-      seq_tensor_free(squiggle);
+  // Stream mode: chunks go to the UNIX socket, or the -o file/FIFO (stdout by default)
+  int stream_fd = -1;
+  if (streaming) {
+    signal(SIGPIPE, SIG_IGN);  // A consumer hanging up is reported as a write error
+    stream_fd = arguments.stream_socket ? seq_stream_connect_unix(arguments.stream_socket)
+                                        : fileno(arguments.output);
+    if (stream_fd < 0) {
+      errx(EXIT_FAILURE, "Failed to open signal stream destination");
     }
+    sink.streamer = seqgen_stream_open(&arguments, stream_fd);
+  }
 
-    // Clean up sequence structure (only for synthetic sequences)
-    if (is_synthetic) {
-      kseq_destroy_synthetic(seq);
-    }
-  } // end for loop
+  // ========================================================================
+  // STEP 4: PROCESS all reads (handles both synthetic and file-based modes)
+  // Reads flow source -> simulate -> emit; with --threads N simulation runs on
+  // N workers while reading and output stay ordered on their own threads
+  // ========================================================================
+  run_seqgen_pipeline(&source, &sink, arguments.threads);
+  if (sink.streamer) {
+    seqgen_stream_close(sink.streamer);
+    if (arguments.stream_socket) close(stream_fd);
+  }
 
   // ========================================================================
   // STEP 5: CLEANUP AND FINALIZATION (common to both modes)
   // ========================================================================
 
   // Clean up file-based mode resources
-  if (!arguments.generate_sequences && file_parsers != NULL) {
+  if (!arguments.generate_sequences && source.file_parsers != NULL) {
     for (int i = 0; i < nfile; i++) {
-      if (file_parsers[i] != NULL) {
-        kseq_destroy(file_parsers[i]);
+      if (source.file_parsers[i] != NULL) {
+        kseq_destroy(source.file_parsers[i]);
       }
       if (file_handles[i] != NULL) {
-        fclose(file_handles[i]);
+        seq_input_close(file_handles[i]);
       }
     }
-    free(file_parsers);
+    free(source.file_parsers);
     free(file_handles);
   }
 
+  seq_reference_close(source.reference);
+  seqgen_kmer_context_free(kmer_context);
+  seq_nn_model_free(network);
+
   // Print average dwell time statistics if we processed sequences in SQUIGGLE mode
   if (!arguments.generate_raw && !arguments.generate_event) {
-    if (total_positions > 0) {
-      float average_dwell_time = total_dwell_time / total_positions;
-      size_t total_samples = (size_t)ceil(average_dwell_time * total_positions);
+    if (sink.total_positions > 0) {
+      float average_dwell_time = sink.total_dwell_time / sink.total_positions;
+      size_t total_samples = (size_t)ceil(average_dwell_time * sink.total_positions);
       printf("Average dwell time: %.6f (across %zu positions and %zu samples)\n",
-             average_dwell_time, total_positions, total_samples);
+             average_dwell_time, sink.total_positions, total_samples);
     } else {
       printf("No sequences processed - no dwell time data available\n");
     }
@@ -803,50 +1523,70 @@ int main_seqgen(int argc, char *argv[]) {
   if (arguments.reference_file != NULL) {
     fflush(arguments.reference_file);
     if (arguments.generate_sequences) {
-      printf("Wrote %d generated sequences to reference file: %s\n",
-             reads_started, arguments.reference_filename);
+      fprintf(info, "Wrote %d generated sequences to reference file: %s\n",
+              sink.reads_started, arguments.reference_filename);
     } else {
-      printf("Wrote %d sequences from input files to reference file: %s\n",
-             reads_started, arguments.reference_filename);
+      fprintf(info, "Wrote %d sequences from input files to reference file: %s\n",
+              sink.reads_started, arguments.reference_filename);
     }
   }
 
-  // Write Fast5 file if requested
-  if (arguments.output_fast5 && fast5_read_count > 0) {
-    if (fast5_read_count == 1) {
-      seq_write_fast5_single(arguments.output_filename,
-                            fast5_raw_signals,
-                            fast5_read_names,
-                            fast5_read_count,
-                            arguments.sample_rate_khz);
-    } else {
-      seq_write_fast5_multi(arguments.output_filename,
-                           fast5_raw_signals,
-                           fast5_read_names,
-                           fast5_read_count,
-                           arguments.sample_rate_khz);
+  // Finish Fast5 output (flushes the last file; a lone read becomes a single-read file)
+  if (NULL != sink.fast5_writer) {
+    size_t files_written = fast5_writer_files_written(sink.fast5_writer);
+    fast5_write_stats_t write_stats;
+
+    struct timeval write_start, write_end;
+    gettimeofday(&write_start, NULL);
+    if (fast5_writer_close(sink.fast5_writer, &write_stats) < 0) {
+      errx(EXIT_FAILURE, "Failed to finish Fast5 file: %s", arguments.output_filename);
     }
+    gettimeofday(&write_end, NULL);
+    sink.write_seconds += (write_end.tv_sec - write_start.tv_sec) +
+                     (write_end.tv_usec - write_start.tv_usec) / 1000000.0;
 
-    printf("Wrote %d reads to Fast5 file: %s\n",
-           fast5_read_count, arguments.output_filename);
+    if (sink.fast5_read_count > 0) {
+      double file_mb = write_stats.file_bytes / (1000.0 * 1000.0);
 
-    // Clean up Fast5 data
-    for (int i = 0; i < fast5_read_count; i++) {
-      if (fast5_raw_signals[i]) {
-        seq_tensor_free(fast5_raw_signals[i]);
+      if (files_written > 1) {
+        printf("Wrote %d reads to %zu Fast5 files (%d reads per file) based on: %s\n",
+               sink.fast5_read_count, files_written, arguments.reads_per_file, arguments.output_filename);
+      } else {
+        printf("Wrote %d reads to Fast5 file: %s\n",
+               sink.fast5_read_count, arguments.output_filename);
       }
-      if (fast5_read_names[i]) {
-        free((void*)fast5_read_names[i]);
+      printf("  Output size: %.2f MB (signal %.2f MB stored / %.2f MB %s, deflate %d)\n",
+             file_mb, write_stats.stored_bytes / 1e6, write_stats.logical_bytes / 1e6,
+             write_options.quantise_int16 ? "int16" : "float32", write_options.compression_level);
+      if (sink.write_seconds > 0.0) {
+        printf("  Write time: %.3f seconds (%.0f reads/s, %.1f MB/s)\n", sink.write_seconds,
+               sink.fast5_read_count / sink.write_seconds, file_mb / sink.write_seconds);
       }
     }
-    free(fast5_raw_signals);
-    free(fast5_read_names);
   }
 
+  // Finish shard output (writes the last, partly filled shard)
+  if (NULL != sink.shard_writer) {
+    seq_shard_stats_t shard_stats;
+    if (seq_shard_writer_close(sink.shard_writer, &shard_stats) < 0) {
+      errx(EXIT_FAILURE, "Failed to finish shards in: %s", arguments.shards_dir);
+    }
+    printf("Wrote %zu reads to %zu shards in: %s\n", shard_stats.reads, shard_stats.shards, arguments.shards_dir);
+    printf("  Shard size: %.2f MB (signal %.2f MB int16)\n", shard_stats.file_bytes / 1e6,
+           shard_stats.signal_bytes / 1e6);
+  }
+
+  // Every pooled signal has been written and returned by now
+  seq_tensor_pool_free(source.signal_pool);
+
   // Close reference file if it was opened
   if (arguments.reference_file != NULL) {
     fclose(arguments.reference_file);
-    printf("Closed reference file: %s\n", arguments.reference_filename);
+    fprintf(info, "Closed reference file: %s\n", arguments.reference_filename);
+  }
+
+  if (seq_output_close(&sink.output) < 0) {
+    errx(EXIT_FAILURE, "Failed to write signal output");
   }
 
   // Close text output file if we opened it for --save-text
@@ -0,0 +1,217 @@
+// **********************************************************************
+// test_fast5_chunks.c - Test off-lock Signal chunk decoding against H5Dread
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+// compile: build % cmake --build
+// run:     build % ./test_fast5_chunks
+
+#include "../src/core/fast5_chunks.h"
+#include "../src/core/fast5_io.h"
+#include "../src/core/seq_rng.h"
+#include <hdf5.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FAST5 "test_fast5_chunks.fast5"
+#define N_SAMPLES 4500     // Not a multiple of CHUNK_SAMPLES: the last chunk is partial
+#define CHUNK_SAMPLES 1000
+
+typedef struct {
+  const char *read_id;
+  bool chunked;
+  bool shuffle;
+  bool deflate;
+  bool decodable;          // Fetched as raw chunks (otherwise left to H5Dread)
+} signal_layout_t;
+
+static const signal_layout_t layouts[] = {
+  {"shuffle_deflate", true,  true,  true,  true},
+  {"deflate_only",    true,  false, true,  true},
+  {"chunked_plain",   true,  false, false, true},
+  {"contiguous",      false, false, false, false},
+};
+#define N_LAYOUTS (sizeof(layouts) / sizeof(layouts[0]))
+
+static void set_read_id(hid_t group_id, const char *read_id) {
+  hid_t type_id = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type_id, strlen(read_id) + 1);
+  hid_t space_id = H5Screate(H5S_SCALAR);
+  hid_t attr_id = H5Acreate2(group_id, "read_id", type_id, space_id, H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr_id, type_id, read_id);
+  H5Aclose(attr_id);
+  H5Sclose(space_id);
+  H5Tclose(type_id);
+}
+
+// Multi-read Fast5 with one read per layout: /read_<id>/Raw/Signal
+static bool write_test_file(const int16_t *signal) {
+  hid_t file_id = H5Fcreate(TEST_FAST5, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  if (file_id < 0) return false;
+
+  bool ok = true;
+  for (size_t l = 0; l < N_LAYOUTS && ok; l++) {
+    char path[128];
+    snprintf(path, sizeof(path), "read_%s", layouts[l].read_id);
+    hid_t read_id = H5Gcreate2(file_id, path, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t raw_id = H5Gcreate2(read_id, "Raw", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    set_read_id(raw_id, layouts[l].read_id);
+
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    if (layouts[l].chunked) {
+      hsize_t chunk_dim = CHUNK_SAMPLES;
+      H5Pset_chunk(dcpl, 1, &chunk_dim);
+      if (layouts[l].shuffle) H5Pset_shuffle(dcpl);
+      if (layouts[l].deflate) H5Pset_deflate(dcpl, 1);
+    }
+    hsize_t dims = N_SAMPLES;
+    hid_t space_id = H5Screate_simple(1, &dims, NULL);
+    hid_t dataset_id = H5Dcreate2(raw_id, "Signal", H5T_STD_I16LE, space_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    ok = dataset_id >= 0 && H5Dwrite(dataset_id, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, signal) >= 0;
+    if (dataset_id >= 0) H5Dclose(dataset_id);
+    H5Sclose(space_id);
+    H5Pclose(dcpl);
+    H5Gclose(raw_id);
+    H5Gclose(read_id);
+  }
+  H5Fclose(file_id);
+  return ok;
+}
+
+static bool read_whole(hid_t file_id, const char *read_id, int16_t *out) {
+  char path[128];
+  snprintf(path, sizeof(path), "/read_%s/Raw/Signal", read_id);
+  hid_t dataset_id = H5Dopen2(file_id, path, H5P_DEFAULT);
+  if (dataset_id < 0) return false;
+  bool ok = H5Dread(dataset_id, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, out) >= 0;
+  H5Dclose(dataset_id);
+  return ok;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int tests_failed = 0;
+
+  printf("Testing Fast5 Signal chunk decoding...\n\n");
+
+  // Full-range samples, so a swapped byte order or misplaced shuffle plane shows
+  static int16_t signal[N_SAMPLES], expected[N_SAMPLES], decoded[N_SAMPLES];
+  seq_rng rng;
+  seq_rng_init(&rng, 32, 0);
+  for (size_t i = 0; i < N_SAMPLES; i++) signal[i] = (int16_t)(seq_rng_next(&rng) >> 48);
+  signal[0] = INT16_MIN;
+  signal[N_SAMPLES - 1] = INT16_MAX;
+
+  if (!write_test_file(signal)) {
+    printf("✗ Cannot write %s\n", TEST_FAST5);
+    return 1;
+  }
+  hid_t file_id = H5Fopen(TEST_FAST5, H5F_ACC_RDONLY, H5P_DEFAULT);
+
+  // Test 1: fetch + decode on 1 and 3 threads equals H5Dread, partial last chunk included
+  printf("Test 1: Raw chunk decode vs H5Dread...\n");
+  bool decode_ok = file_id >= 0;
+  fast5_raw_signal_t raw = {0};
+  for (size_t l = 0; l < N_LAYOUTS && decode_ok; l++) {
+    char path[128];
+    snprintf(path, sizeof(path), "/read_%s/Raw/Signal", layouts[l].read_id);
+    hid_t dataset_id = H5Dopen2(file_id, path, H5P_DEFAULT);
+    decode_ok = dataset_id >= 0 && read_whole(file_id, layouts[l].read_id, expected) &&
+                memcmp(expected, signal, sizeof(signal)) == 0;
+    bool fetched = decode_ok && fast5_raw_signal_fetch(dataset_id, N_SAMPLES, &raw);
+    decode_ok = decode_ok && fetched == layouts[l].decodable;
+    for (int threads = 1; threads <= 3 && decode_ok && fetched; threads += 2) {
+      memset(decoded, 0, sizeof(decoded));
+      decode_ok = raw.num_chunks == (N_SAMPLES + CHUNK_SAMPLES - 1) / CHUNK_SAMPLES &&
+                  (raw.shuffle_filter >= 0) == layouts[l].shuffle && (raw.deflate_filter >= 0) == layouts[l].deflate &&
+                  fast5_raw_signal_decode(&raw, decoded, threads) && memcmp(decoded, expected, sizeof(expected)) == 0;
+    }
+    if (!decode_ok) printf("  %s failed\n", layouts[l].read_id);
+    if (dataset_id >= 0) H5Dclose(dataset_id);
+  }
+  if (!decode_ok) {
+    printf("✗ Decoded chunks differ from H5Dread\n");
+    tests_failed++;
+  } else {
+    printf("✓ Shuffled+deflated, deflate-only and unfiltered chunks match H5Dread; contiguous left to H5Dread\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 2: the reader's deferred decode returns the same samples as its inline path
+  printf("Test 2: Deferred-decode reader...\n");
+  bool reader_ok = true;
+  for (int defer = 0; defer <= 1 && reader_ok; defer++) {
+    fast5_reader_t *reader = fast5_reader_open(TEST_FAST5, NULL);
+    reader_ok = reader && fast5_reader_num_reads(reader) == N_LAYOUTS;
+    if (reader) fast5_reader_defer_decode(reader, defer);
+    fast5_metadata_t metadata;
+    size_t reads = 0;
+    while (reader_ok && fast5_reader_next(reader, &metadata, true) == 1) {
+      size_t length = 0;
+      if (defer) fast5_reader_decode_signal(reader);
+      const int16_t *samples = fast5_reader_signal(reader, &length);
+      reader_ok = metadata.read_id && read_whole(file_id, metadata.read_id, expected) &&
+                  samples && length == N_SAMPLES && memcmp(samples, expected, sizeof(expected)) == 0;
+      if (!reader_ok) printf("  %s failed (deferred %d)\n", metadata.read_id ? metadata.read_id : "?", defer);
+      clear_fast5_metadata(&metadata);
+      reads++;
+    }
+    reader_ok = reader_ok && reads == N_LAYOUTS;
+    fast5_reader_close(reader);
+  }
+  if (!reader_ok) {
+    printf("✗ Reader signal differs from H5Dread\n");
+    tests_failed++;
+  } else {
+    printf("✓ Inline and deferred reader signals match H5Dread for every layout\n");
+    tests_passed++;
+  }
+  printf("\n");
+  if (file_id >= 0) H5Fclose(file_id);
+
+  // Test 3: encoded chunks written directly read back through HDF5's own filters
+  printf("Test 3: Encode + direct chunk write vs H5Dread...\n");
+  bool encode_ok = true;
+  file_id = H5Fcreate(TEST_FAST5, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  for (int shuffle = 0; shuffle <= 1 && encode_ok; shuffle++) {
+    encode_ok = file_id >= 0 && fast5_raw_signal_encode(signal, N_SAMPLES, CHUNK_SAMPLES, shuffle, 1, &raw);
+    hid_t dcpl = encode_ok ? fast5_raw_signal_create_plist(&raw) : -1;
+    hsize_t dims = N_SAMPLES;
+    hid_t space_id = H5Screate_simple(1, &dims, NULL);
+    hid_t dataset_id = dcpl >= 0 ? H5Dcreate2(file_id, shuffle ? "shuffled" : "deflated", H5T_STD_I16LE, space_id,
+                                              H5P_DEFAULT, dcpl, H5P_DEFAULT) : -1;
+    memset(expected, 0, sizeof(expected));
+    encode_ok = dataset_id >= 0 && fast5_raw_signal_write(dataset_id, &raw) &&
+                H5Dread(dataset_id, H5T_NATIVE_INT16, H5S_ALL, H5S_ALL, H5P_DEFAULT, expected) >= 0 &&
+                memcmp(expected, signal, sizeof(signal)) == 0;
+    if (dataset_id >= 0) H5Dclose(dataset_id);
+    H5Sclose(space_id);
+    if (dcpl >= 0) H5Pclose(dcpl);
+  }
+  if (file_id >= 0) H5Fclose(file_id);
+  fast5_raw_signal_free(&raw);
+  remove(TEST_FAST5);
+  if (!encode_ok) {
+    printf("✗ Encoded chunks read back differently through H5Dread\n");
+    tests_failed++;
+  } else {
+    printf("✓ Shuffled and deflate-only encodes read back exactly through HDF5's filters\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Summary
+  printf("======================\n");
+  printf("Tests passed: %d\n", tests_passed);
+  printf("Tests failed: %d\n", tests_failed);
+  printf("======================\n");
+
+  if (tests_failed == 0) {
+    printf("\n✓ All tests passed!\n");
+    return 0;
+  } else {
+    printf("\n✗ Some tests failed!\n");
+    return 1;
+  }
+}
@@ -0,0 +1,155 @@
+// **********************************************************************
+// test_fast5_stats.c - Test the streaming moments and quantile sketch
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+// compile: build % cmake --build
+// run:     build % ./test_fast5_stats
+
+#include "../src/core/fast5_stats.h"
+#include "../src/core/seq_rng.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_VALUES 100000
+#define N_PARTS 7          // Per-thread partials of uneven size
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+// Read lengths: log-normal around ~8 kb, like a real run
+static void fill_lengths(double *values, size_t n, double offset) {
+  static float gaussian[N_VALUES];
+  seq_rng rng;
+  seq_rng_init(&rng, 26, 0);
+  seq_rng_fill_gaussian(&rng, gaussian, n);
+  for (size_t i = 0; i < n; i++) values[i] = offset + exp(9.0 + 0.8 * gaussian[i]);
+}
+
+// Merged partials against a serial pass and an exact two-pass reference
+static bool check_moments(const double *values, size_t n, double *worst) {
+  fast5_moments_t serial = {0}, merged = {0};
+  for (size_t i = 0; i < n; i++) fast5_moments_add(&serial, values[i]);
+
+  size_t start = 0;
+  for (int p = 0; p < N_PARTS; p++) {
+    size_t end = p == N_PARTS - 1 ? n : start + (n / N_PARTS) * (p + 1) / 4 + 1;   // Uneven splits
+    fast5_moments_t part = {0};
+    for (size_t i = start; i < end; i++) fast5_moments_add(&part, values[i]);
+    fast5_moments_merge(&merged, &part);
+    start = end;
+  }
+  fast5_moments_t empty = {0};
+  fast5_moments_merge(&merged, &empty);    // Empty partials change nothing
+
+  double mean = 0.0, m2 = 0.0, lo = values[0], hi = values[0];
+  for (size_t i = 0; i < n; i++) mean += values[i];
+  mean /= (double)n;
+  for (size_t i = 0; i < n; i++) {
+    m2 += (values[i] - mean) * (values[i] - mean);
+    lo = fmin(lo, values[i]);
+    hi = fmax(hi, values[i]);
+  }
+  double stddev = sqrt(m2 / (double)(n - 1));
+
+  double error = fmax(fmax(fabs(merged.mean - mean) / fabs(mean), fabs(serial.mean - mean) / fabs(mean)),
+                      fmax(fabs(fast5_moments_stddev(&merged) - stddev) / stddev,
+                           fabs(fast5_moments_stddev(&serial) - stddev) / stddev));
+  *worst = fmax(*worst, error);
+  return merged.count == n && serial.count == n && merged.min == lo && merged.max == hi && error < 1e-9;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int tests_failed = 0;
+
+  printf("Testing streaming statistics...\n\n");
+
+  double *values = malloc(N_VALUES * sizeof(double));
+  double *sorted = malloc(N_VALUES * sizeof(double));
+  if (!values || !sorted) {
+    printf("✗ Out of memory\n");
+    return 1;
+  }
+
+  // Test 1: Welford partials merged with Chan's update equal a serial pass
+  printf("Test 1: Merged moments...\n");
+  double worst = 0.0;
+  fill_lengths(values, N_VALUES, 0.0);
+  bool moments_ok = check_moments(values, N_VALUES, &worst);
+  fill_lengths(values, N_VALUES, 1e9);     // Large offset, small spread: naive sum-of-squares would cancel
+  moments_ok = moments_ok && check_moments(values, N_VALUES, &worst);
+  if (!moments_ok) {
+    printf("✗ Merged moments differ from a serial pass (relative error %.3g)\n", worst);
+    tests_failed++;
+  } else {
+    printf("✓ %d partials merge to the serial mean and stddev (relative error %.3g)\n", N_PARTS, worst);
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 2: Sketch quantiles within FAST5_SKETCH_ALPHA of the exact order statistics
+  printf("Test 2: Quantile sketch...\n");
+  fill_lengths(values, N_VALUES, 0.0);
+  static fast5_sketch_t serial_sketch, merged_sketch, part_sketch;
+  memset(&serial_sketch, 0, sizeof(serial_sketch));
+  memset(&merged_sketch, 0, sizeof(merged_sketch));
+  for (size_t i = 0; i < N_VALUES; i++) fast5_sketch_add(&serial_sketch, values[i]);
+  for (int p = 0; p < N_PARTS; p++) {
+    memset(&part_sketch, 0, sizeof(part_sketch));
+    for (size_t i = p; i < N_VALUES; i += N_PARTS) fast5_sketch_add(&part_sketch, values[i]);
+    fast5_sketch_merge(&merged_sketch, &part_sketch);
+  }
+
+  memcpy(sorted, values, N_VALUES * sizeof(double));
+  qsort(sorted, N_VALUES, sizeof(double), compare_doubles);
+  const double quantiles[] = {0.0, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1.0};
+  double worst_relative = 0.0;
+  for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+    double exact = sorted[(size_t)(quantiles[i] * (N_VALUES - 1))];
+    double estimate = fast5_sketch_quantile(&merged_sketch, quantiles[i]);
+    worst_relative = fmax(worst_relative, fabs(estimate - exact) / exact);
+  }
+  bool same_buckets = memcmp(&serial_sketch, &merged_sketch, sizeof(fast5_sketch_t)) == 0;
+
+  // Values under the sketch's minimum count, and report as 0
+  fast5_sketch_t *small = calloc(1, sizeof(fast5_sketch_t));
+  bool small_ok = small != NULL;
+  if (small) {
+    for (int i = 0; i < 10; i++) fast5_sketch_add(small, i < 3 ? 0.0 : 100.0);
+    small_ok = small->below_min == 3 && fast5_sketch_quantile(small, 0.1) == 0.0 &&
+               fabs(fast5_sketch_quantile(small, 0.9) - 100.0) <= FAST5_SKETCH_ALPHA * 100.0;
+  }
+  free(small);
+
+  if (!same_buckets || worst_relative > FAST5_SKETCH_ALPHA * (1.0 + 1e-9) || !small_ok) {
+    printf("✗ Sketch: merge exact %d, worst relative error %.4f (limit %.2f), small values %d\n",
+           same_buckets, worst_relative, FAST5_SKETCH_ALPHA, small_ok);
+    tests_failed++;
+  } else {
+    printf("✓ Merged sketch equals the serial one; quantiles within %.4f (limit %.2f)\n",
+           worst_relative, FAST5_SKETCH_ALPHA);
+    tests_passed++;
+  }
+  printf("\n");
+
+  free(values);
+  free(sorted);
+
+  // Summary
+  printf("======================\n");
+  printf("Tests passed: %d\n", tests_passed);
+  printf("Tests failed: %d\n", tests_failed);
+  printf("======================\n");
+
+  if (tests_failed == 0) {
+    printf("\n✓ All tests passed!\n");
+    return 0;
+  } else {
+    printf("\n✗ Some tests failed!\n");
+    return 1;
+  }
+}
@@ -6,6 +6,7 @@
 // run:     build % ./test_kmer_loader
 
 #include "../src/core/kmer_model_loader.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -79,6 +80,11 @@ int main(void) {
     } else if (!model3->level_mean || !model3->level_stddev) {
       printf("✗ Missing level_mean or level_stddev arrays\n");
       tests_failed++;
+    } else if (fabsf(model3->weight[0] - 4739.559f) > 0.01f ||
+               fabsf(model3->ig_lambda[0] - 0.941478f * 0.941478f * 0.941478f / (0.609357f * 0.609357f)) > 1e-4f) {
+      // This table has no ig_lambda column: weight is column 6, ig_lambda comes from sd_mean and sd_stdv
+      printf("✗ Wrong weight/ig_lambda: %.3f, %.4f\n", model3->weight[0], model3->ig_lambda[0]);
+      tests_failed++;
     } else {
       printf("✓ Loaded %s: %d-mer, %zu kmers\n",
        model3->name, model3->kmer_size, model3->num_kmers);
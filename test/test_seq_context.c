@@ -0,0 +1,168 @@
+// **********************************************************************
+// test_seq_context.c - Test the reentrant library context
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+
+#include "../src/core/seq_context.h"
+#include "../src/core/seqgen_models.h"
+#include "../src/core/seq_tensor.h"
+#include "../src/core/seq_packed.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_THREADS 8
+#define MODEL_NAME "rna_r9.4_180mv_70bps"
+
+typedef struct {
+  seq_context *ctx;
+  const seq_packed *sequence;
+  seq_tensor *reference;
+  uint64_t first_draw;       // From stream 7 of the context
+  bool same;
+} worker_t;
+
+// Every worker acquires the shared model, generates the same squiggle and releases it
+static void* worker(void *arg) {
+  worker_t *w = (worker_t*)arg;
+  const seqgen_kmer_context *model = seq_context_acquire_kmer_model(w->ctx, MODEL_NAME);
+  struct seqgen_model_params params = {
+    .model_type = SEQGEN_MODEL_KMER,
+    .params.kmer = {.model_name = MODEL_NAME, .kmer_size = 5, .sample_rate_khz = 4.0f, .context = model}
+  };
+  seq_tensor *squiggle = model ? squiggle_kmer_packed(w->sequence, false, &params) : NULL;
+  w->same = squiggle && seq_tensor_dim(squiggle, 0) == seq_tensor_dim(w->reference, 0) &&
+            memcmp(seq_tensor_data_float(squiggle), seq_tensor_data_float(w->reference),
+                   seq_tensor_dim(squiggle, 0) * 3 * sizeof(float)) == 0;
+  seq_tensor_free(squiggle);
+  seq_context_release_model(w->ctx, model);
+
+  seq_rng rng;
+  seq_context_rng(w->ctx, 7, &rng);
+  w->first_draw = seq_rng_next(&rng);
+  return NULL;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int tests_failed = 0;
+
+  printf("Testing reentrant library context...\n\n");
+
+  seq_context_options options = {.seed = 42, .models_dir = "kmer_models", .max_idle_models = 0};
+  seq_context *ctx = seq_context_create(&options);
+  if (!ctx) {
+    printf("✗ Failed to create context\n");
+    return 1;
+  }
+
+  // Test 1: Threads sharing one context share one model and get identical results
+  printf("Test 1: Concurrent model use...\n");
+  const char *bases = "ACGTTGCAAGCTTAGCCGATACGGATCCATGCAATTGGCCA";
+  seq_packed *sequence = seq_pack(bases, strlen(bases));
+  const seqgen_kmer_context *model = seq_context_acquire_kmer_model(ctx, MODEL_NAME);
+  struct seqgen_model_params params = {
+    .model_type = SEQGEN_MODEL_KMER,
+    .params.kmer = {.model_name = MODEL_NAME, .kmer_size = 5, .sample_rate_khz = 4.0f, .context = model}
+  };
+  seq_tensor *reference = sequence && model ? squiggle_kmer_packed(sequence, false, &params) : NULL;
+  seq_context_release_model(ctx, model);
+
+  worker_t workers[N_THREADS];
+  pthread_t threads[N_THREADS];
+  for (int t = 0; t < N_THREADS; t++) {
+    workers[t] = (worker_t){ctx, sequence, reference, 0, false};
+    pthread_create(&threads[t], NULL, worker, &workers[t]);
+  }
+  bool all_same = reference != NULL;
+  for (int t = 0; t < N_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    all_same = all_same && workers[t].same && workers[t].first_draw == workers[0].first_draw;
+  }
+  if (!all_same || seq_context_cached_models(ctx) != 1) {
+    printf("✗ Threads disagree or the model was loaded more than once (%zu cached)\n",
+           seq_context_cached_models(ctx));
+    tests_failed++;
+  } else {
+    printf("✓ %d threads shared one cached model and one RNG stream\n", N_THREADS);
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 2: Streams depend only on (seed, stream)
+  printf("Test 2: RNG streams...\n");
+  seq_context *twin = seq_context_create(&options);
+  seq_rng a, b, c, d;
+  seq_context_rng(ctx, 3, &a);
+  seq_context_rng(twin, 3, &b);
+  seq_context_new_rng(ctx, &c);
+  seq_context_new_rng(ctx, &d);
+  uint64_t va = seq_rng_next(&a), vb = seq_rng_next(&b), vc = seq_rng_next(&c), vd = seq_rng_next(&d);
+  if (va != vb || vc == vd || va == vc) {
+    printf("✗ Streams are not reproducible or not independent\n");
+    tests_failed++;
+  } else {
+    printf("✓ Same (seed, stream) draws agree; new streams differ\n");
+    tests_passed++;
+  }
+  seq_context_free(twin);
+  printf("\n");
+
+  // Test 3: Failures go to the context's error stack
+  printf("Test 3: Error stack...\n");
+  const seqgen_kmer_context *missing = seq_context_acquire_kmer_model(ctx, "no_such_model");
+  fast5_reader_t *reader = seq_context_reader_open(ctx, "no_such_file.fast5", NULL);
+  char message[SEQ_CONTEXT_ERROR_LENGTH];
+  bool popped = seq_context_error_pop(ctx, message, sizeof(message));
+  if (missing || reader || !popped || !strstr(message, "no_such_file.fast5") || seq_context_error_count(ctx) != 1) {
+    printf("✗ Errors were not recorded newest first\n");
+    tests_failed++;
+  } else {
+    printf("✓ Newest error: %s\n", message);
+    tests_passed++;
+  }
+  for (int i = 0; i < SEQ_CONTEXT_MAX_ERRORS + 5; i++) seq_context_error(ctx, "error %d", i);
+  if (seq_context_error_count(ctx) != SEQ_CONTEXT_MAX_ERRORS) {
+    printf("✗ Error stack grew past its limit\n");
+    tests_failed++;
+  } else {
+    printf("✓ Error stack keeps the newest %d messages\n", SEQ_CONTEXT_MAX_ERRORS);
+    tests_passed++;
+  }
+  seq_context_error_clear(ctx);
+  printf("\n");
+
+  // Test 4: Cache lifetime
+  printf("Test 4: Cache trimming...\n");
+  model = seq_context_acquire_kmer_model(ctx, MODEL_NAME);
+  size_t freed_in_use = seq_context_trim(ctx, 0);
+  seq_context_release_model(ctx, model);
+  size_t freed_idle = seq_context_trim(ctx, 0);
+  if (freed_in_use != 0 || freed_idle != 1 || seq_context_cached_models(ctx) != 0) {
+    printf("✗ Trim freed %zu models in use and %zu idle\n", freed_in_use, freed_idle);
+    tests_failed++;
+  } else {
+    printf("✓ Models in use survive trimming; idle ones are freed\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  seq_tensor_free(reference);
+  seq_packed_free(sequence);
+  seq_context_free(ctx);
+
+  // Summary
+  printf("======================\n");
+  printf("Tests passed: %d\n", tests_passed);
+  printf("Tests failed: %d\n", tests_failed);
+  printf("======================\n");
+
+  if (tests_failed == 0) {
+    printf("\n✓ All tests passed!\n");
+    return 0;
+  } else {
+    printf("\n✗ Some tests failed!\n");
+    return 1;
+  }
+}
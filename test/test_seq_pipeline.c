@@ -0,0 +1,343 @@
+// **********************************************************************
+// test_seq_pipeline.c - Test the lock-free queues and the ordered pipeline
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+// compile: build % cmake --build
+// run:     build % ./test_seq_pipeline
+
+#include "../src/core/seq_pipeline.h"
+#include "../src/core/seq_memory.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_STREAM 200000        // Items through the blocking SPSC queue
+#define N_PRODUCERS 4
+#define N_CONSUMERS 4
+#define N_PER_PRODUCER 50000
+#define N_ITEMS 5000           // Items through each pipeline run
+
+static void sleep_ms(long ms) {
+  struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+// Items are 1-based so NULL never goes through a queue
+#define TO_ITEM(v) ((void*)(uintptr_t)(v))
+#define FROM_ITEM(p) ((uintptr_t)(p))
+
+// **********************************************************************
+// Queue Workers
+// **********************************************************************
+
+typedef struct {
+  seq_queue_t *queue;
+  size_t count;
+  bool ok;
+} stream_t;
+
+static void* stream_producer(void *arg) {
+  stream_t *s = arg;
+  for (size_t i = 1; i <= s->count; i++) {
+    if (!seq_queue_push(s->queue, TO_ITEM(i))) return NULL;
+  }
+  seq_queue_close(s->queue);
+  return NULL;
+}
+
+static void* stream_consumer(void *arg) {
+  stream_t *s = arg;
+  void *item;
+  size_t expected = 1;
+  s->ok = true;
+  while (seq_queue_pop(s->queue, &item)) {
+    s->ok &= FROM_ITEM(item) == expected++;
+  }
+  s->ok &= expected == s->count + 1;
+  return NULL;
+}
+
+typedef struct {
+  seq_queue_t *queue;
+  bool result;
+  atomic_bool returned;
+} blocked_t;
+
+static void* blocked_pop(void *arg) {
+  blocked_t *b = arg;
+  void *item;
+  b->result = seq_queue_pop(b->queue, &item);
+  atomic_store(&b->returned, true);
+  return NULL;
+}
+
+static void* blocked_push(void *arg) {
+  blocked_t *b = arg;
+  b->result = seq_queue_push(b->queue, TO_ITEM(1));
+  atomic_store(&b->returned, true);
+  return NULL;
+}
+
+typedef struct {
+  seq_queue_t *queue;
+  int producer;
+} mpmc_producer_t;
+
+typedef struct {
+  seq_queue_t *queue;
+  atomic_int *seen;            // Times each value was popped
+  bool in_order;               // Every producer's values arrived in order at this consumer
+} mpmc_consumer_t;
+
+static void* mpmc_produce(void *arg) {
+  mpmc_producer_t *p = arg;
+  for (size_t i = 0; i < N_PER_PRODUCER; i++) {
+    seq_queue_push(p->queue, TO_ITEM((size_t)p->producer * N_PER_PRODUCER + i + 1));
+  }
+  return NULL;
+}
+
+static void* mpmc_consume(void *arg) {
+  mpmc_consumer_t *c = arg;
+  size_t last[N_PRODUCERS] = {0};
+  void *item;
+  c->in_order = true;
+  while (seq_queue_pop(c->queue, &item)) {
+    size_t value = FROM_ITEM(item) - 1;
+    size_t producer = value / N_PER_PRODUCER, i = value % N_PER_PRODUCER + 1;
+    c->in_order &= producer < N_PRODUCERS && i > last[producer];
+    if (producer < N_PRODUCERS) last[producer] = i;
+    atomic_fetch_add(&c->seen[value], 1);
+  }
+  return NULL;
+}
+
+// **********************************************************************
+// Pipeline Stages
+// **********************************************************************
+
+typedef struct {
+  size_t index;
+  uint64_t value;
+} item_t;
+
+typedef struct {
+  size_t next;
+  size_t sunk;
+  uint64_t *out;
+  bool reserve;                // Transform holds memory until the sink (budget runs)
+} run_t;
+
+static bool source(void *context, void *item) {
+  run_t *run = context;
+  if (run->next == N_ITEMS) return false;
+  ((item_t*)item)->index = run->next++;
+  return true;
+}
+
+// Uneven work per item, so workers finish out of order
+static void transform(void *context, void *item) {
+  run_t *run = context;
+  item_t *it = item;
+  uint64_t x = it->index + 1;
+  for (size_t i = 0; i < 1 + (it->index * 7919) % 400; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  it->value = x;
+  if (run->reserve) seq_memory_reserve(4096);
+}
+
+static void sink(void *context, void *item) {
+  run_t *run = context;
+  const item_t *it = item;
+  run->out[run->sunk++] = it->value ^ ((uint64_t)it->index << 48);
+  if (run->reserve) seq_memory_release(4096);
+}
+
+static bool run_pipeline(int num_workers, size_t max_in_flight, bool reserve, uint64_t *out) {
+  run_t run = {.out = out, .reserve = reserve};
+  seq_pipeline_config config = {
+    .source = source, .transform = transform, .sink = sink, .context = &run,
+    .item_size = sizeof(item_t), .num_workers = num_workers, .max_in_flight = max_in_flight
+  };
+  seq_pipeline_run(&config);
+  return run.sunk == N_ITEMS;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int tests_failed = 0;
+
+  printf("Testing queues and ordered pipeline...\n\n");
+
+  // Test 1: Non-blocking operations on both queue kinds
+  printf("Test 1: try_push / try_pop...\n");
+  const seq_queue_kind kinds[] = {SEQ_QUEUE_SPSC, SEQ_QUEUE_MPMC};
+  const char *kind_names[] = {"SPSC", "MPMC"};
+  for (int k = 0; k < 2; k++) {
+    seq_queue_t *queue = seq_queue_create(3, kinds[k]);   // Rounded up to 4
+    bool ok = queue != NULL;
+    void *item = NULL;
+    ok = ok && !seq_queue_try_pop(queue, &item);
+    for (size_t lap = 0; ok && lap < 3; lap++) {           // Wraps the indices
+      for (size_t i = 1; i <= 4; i++) ok &= seq_queue_try_push(queue, TO_ITEM(lap * 4 + i));
+      ok = ok && !seq_queue_try_push(queue, TO_ITEM(99));
+      for (size_t i = 1; i <= 4; i++) ok = ok && seq_queue_try_pop(queue, &item) && FROM_ITEM(item) == lap * 4 + i;
+      ok = ok && !seq_queue_try_pop(queue, &item);
+    }
+    if (!ok) {
+      printf("✗ %s try operations wrong\n", kind_names[k]);
+      tests_failed++;
+    } else {
+      printf("✓ %s: capacity 3 holds 4, FIFO across laps, full and empty refuse\n", kind_names[k]);
+      tests_passed++;
+    }
+    seq_queue_free(queue);
+  }
+  printf("\n");
+
+  // Test 2: Blocking SPSC stream through a small queue (both sides park)
+  printf("Test 2: Blocking push / pop...\n");
+  stream_t stream = {seq_queue_create(8, SEQ_QUEUE_SPSC), N_STREAM, false};
+  pthread_t producer, consumer;
+  pthread_create(&consumer, NULL, stream_consumer, &stream);
+  pthread_create(&producer, NULL, stream_producer, &stream);
+  pthread_join(producer, NULL);
+  pthread_join(consumer, NULL);
+  seq_queue_free(stream.queue);
+  if (!stream.ok) {
+    printf("✗ Items lost or reordered\n");
+    tests_failed++;
+  } else {
+    printf("✓ %d items in order through an 8-slot queue, pop ends after close\n", N_STREAM);
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 3: Close wakes parked threads; items queued before the close still pop
+  printf("Test 3: Close while parked...\n");
+  bool close_ok = true;
+  for (int k = 0; k < 2; k++) {
+    blocked_t popper = {seq_queue_create(2, kinds[k]), true, false};
+    pthread_t thread;
+    pthread_create(&thread, NULL, blocked_pop, &popper);
+    sleep_ms(50);                                           // Long past the spin phase
+    close_ok &= !atomic_load(&popper.returned);
+    seq_queue_close(popper.queue);
+    pthread_join(thread, NULL);
+    close_ok &= !popper.result;
+    seq_queue_free(popper.queue);
+
+    blocked_t pusher = {seq_queue_create(2, kinds[k]), true, false};
+    close_ok &= seq_queue_try_push(pusher.queue, TO_ITEM(7)) && seq_queue_try_push(pusher.queue, TO_ITEM(8));
+    pthread_create(&thread, NULL, blocked_push, &pusher);
+    sleep_ms(50);
+    close_ok &= !atomic_load(&pusher.returned);
+    seq_queue_close(pusher.queue);
+    pthread_join(thread, NULL);
+    void *item = NULL;
+    close_ok &= !pusher.result && seq_queue_pop(pusher.queue, &item) && FROM_ITEM(item) == 7 &&
+                seq_queue_pop(pusher.queue, &item) && FROM_ITEM(item) == 8 && !seq_queue_pop(pusher.queue, &item);
+    seq_queue_free(pusher.queue);
+  }
+  if (!close_ok) {
+    printf("✗ Parked threads not released correctly by close\n");
+    tests_failed++;
+  } else {
+    printf("✓ Parked pop and push return false on close; queued items drain first\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 4: Several producers and consumers on one MPMC queue
+  printf("Test 4: MPMC with %d producers and %d consumers...\n", N_PRODUCERS, N_CONSUMERS);
+  seq_queue_t *mpmc = seq_queue_create(16, SEQ_QUEUE_MPMC);
+  atomic_int *seen = calloc((size_t)N_PRODUCERS * N_PER_PRODUCER, sizeof(atomic_int));
+  mpmc_producer_t producers[N_PRODUCERS];
+  mpmc_consumer_t consumers[N_CONSUMERS];
+  pthread_t producer_threads[N_PRODUCERS], consumer_threads[N_CONSUMERS];
+  for (int c = 0; c < N_CONSUMERS; c++) {
+    consumers[c] = (mpmc_consumer_t){mpmc, seen, false};
+    pthread_create(&consumer_threads[c], NULL, mpmc_consume, &consumers[c]);
+  }
+  for (int p = 0; p < N_PRODUCERS; p++) {
+    producers[p] = (mpmc_producer_t){mpmc, p};
+    pthread_create(&producer_threads[p], NULL, mpmc_produce, &producers[p]);
+  }
+  for (int p = 0; p < N_PRODUCERS; p++) pthread_join(producer_threads[p], NULL);
+  seq_queue_close(mpmc);
+  bool mpmc_ok = true;
+  for (int c = 0; c < N_CONSUMERS; c++) {
+    pthread_join(consumer_threads[c], NULL);
+    mpmc_ok &= consumers[c].in_order;
+  }
+  for (size_t i = 0; i < (size_t)N_PRODUCERS * N_PER_PRODUCER; i++) mpmc_ok &= atomic_load(&seen[i]) == 1;
+  free(seen);
+  seq_queue_free(mpmc);
+  if (!mpmc_ok) {
+    printf("✗ Items lost, duplicated or reordered per producer\n");
+    tests_failed++;
+  } else {
+    printf("✓ Every item popped exactly once, each producer's items in order\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 5: Sink order never depends on the worker count or the in-flight limit
+  printf("Test 5: Ordered pipeline...\n");
+  uint64_t *reference = calloc(N_ITEMS, sizeof(uint64_t));
+  uint64_t *out = calloc(N_ITEMS, sizeof(uint64_t));
+  bool order_ok = reference && out && run_pipeline(1, 0, false, reference);
+  const int workers[] = {1, 2, 8};
+  const size_t in_flight[] = {0, 1, 2, 3};
+  for (int w = 0; order_ok && w < 3; w++) {
+    for (int f = 0; order_ok && f < 4; f++) {
+      memset(out, 0, N_ITEMS * sizeof(uint64_t));
+      order_ok = run_pipeline(workers[w], in_flight[f], false, out) &&
+                 memcmp(out, reference, N_ITEMS * sizeof(uint64_t)) == 0;
+      if (!order_ok) printf("  %d workers, max_in_flight %zu differs\n", workers[w], in_flight[f]);
+    }
+  }
+  if (!order_ok) {
+    printf("✗ Sink order depends on the run configuration\n");
+    tests_failed++;
+  } else {
+    printf("✓ Same sink sequence for 1, 2 and 8 workers with max_in_flight 0-3\n");
+    tests_passed++;
+  }
+
+  // Under a memory budget the source waits for the sink instead of deadlocking
+  seq_memory_set_budget(1);
+  memset(out, 0, N_ITEMS * sizeof(uint64_t));
+  bool budget_ok = order_ok && run_pipeline(8, 0, true, out) &&
+                   memcmp(out, reference, N_ITEMS * sizeof(uint64_t)) == 0 && seq_memory_used() == 0;
+  seq_memory_set_budget(0);
+  if (!budget_ok) {
+    printf("✗ Budgeted run lost order or items\n");
+    tests_failed++;
+  } else {
+    printf("✓ Budgeted run completes in order (%llu source stalls)\n", (unsigned long long)seq_memory_stalls());
+    tests_passed++;
+  }
+  free(reference);
+  free(out);
+  printf("\n");
+
+  // Summary
+  printf("======================\n");
+  printf("Tests passed: %d\n", tests_passed);
+  printf("Tests failed: %d\n", tests_failed);
+  printf("======================\n");
+
+  if (tests_failed == 0) {
+    printf("\n✓ All tests passed!\n");
+    return 0;
+  } else {
+    printf("\n✗ Some tests failed!\n");
+    return 1;
+  }
+}
@@ -0,0 +1,329 @@
+// **********************************************************************
+// test_seq_tensor.c - Test tensor layouts and dispatched kernels
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 14 2026
+// compile: build % cmake --build
+// run:     build % ./test_seq_tensor
+
+#include "../src/core/seq_tensor.h"
+#include "../src/core/seq_kernels.h"
+#include "../src/core/seq_rng.h"
+#include "../src/core/seq_chunk.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_VALUES 1037   // Odd length exercises the vector tails
+#define N_LONG 70001    // Past the vector rail counters' flush interval
+
+int main(void) {
+  int tests_passed = 0;
+  int tests_failed = 0;
+
+  printf("Testing tensor layouts and kernels...\n\n");
+
+  // Inputs: pA-like floats plus saturation and rounding edge cases
+  float in_f32[N_VALUES];
+  int16_t in_i16[N_VALUES];
+  int8_t in_i8[N_VALUES];
+  int32_t in_i32[N_VALUES];
+  seq_rng rng;
+  seq_rng_init(&rng, 42, 0);
+  for (size_t i = 0; i < N_VALUES; i++) {
+    in_f32[i] = (float)(seq_rng_uniform(&rng) * 400.0 - 100.0);
+    in_i16[i] = (int16_t)(seq_rng_next(&rng) >> 48);
+    in_i8[i] = (int8_t)(seq_rng_next(&rng) >> 56);
+    in_i32[i] = (int32_t)(seq_rng_next(&rng) >> 32);
+  }
+  const float edges[] = {0.5f, 1.5f, 2.5f, -0.5f, -1.5f, 1e9f, -1e9f, NAN, 32767.5f, -32768.5f};
+  memcpy(in_f32, edges, sizeof(edges));
+  static int16_t long_i16[N_LONG];
+  for (size_t i = 0; i < N_LONG; i++) long_i16[i] = in_i16[i % N_VALUES];
+
+  // Test 1: Every backend matches the scalar kernels bit for bit
+  printf("Test 1: Backends against scalar reference (active: %s)...\n",
+         seq_kernel_backend_name(seq_kernel_backend_active()));
+  static float ref_f[4][N_VALUES], got_f[4][N_VALUES];
+  static int8_t ref_q8[N_VALUES], got_q8[N_VALUES];
+  static int16_t ref_q16[N_VALUES], got_q16[N_VALUES];
+  static int32_t ref_q32[N_VALUES], got_q32[N_VALUES];
+  double ref_mean_f = 0.0, ref_m2_f = 0.0, ref_mean_i = 0.0, ref_m2_i = 0.0;
+  float ref_min = 0.0f, ref_max = 0.0f;
+  seq_kernel_i16_summary ref_sum[2];
+
+  seq_kernel_backend original = seq_kernel_backend_active();
+  for (int b = SEQ_KERNEL_SCALAR; b <= SEQ_KERNEL_NEON; b++) {
+    if (!seq_kernel_set_backend((seq_kernel_backend)b)) continue;
+    bool is_ref = (b == SEQ_KERNEL_SCALAR);
+    float (*f)[N_VALUES] = is_ref ? ref_f : got_f;
+    int8_t *q8 = is_ref ? ref_q8 : got_q8;
+    int16_t *q16 = is_ref ? ref_q16 : got_q16;
+    int32_t *q32 = is_ref ? ref_q32 : got_q32;
+
+    seq_kernel_affine_i8_f32(in_i8, f[0], N_VALUES, 0.25f, -3.0f);
+    seq_kernel_affine_i16_f32(in_i16, f[1], N_VALUES, 0.185f, 12.5f);
+    seq_kernel_affine_i32_f32(in_i32, f[2], N_VALUES, 1e-6f, 1.0f);
+    seq_kernel_affine_f32_f32(in_f32, f[3], N_VALUES, 2.0f, -1.0f);
+    seq_kernel_quantise_f32_i8(in_f32, q8, N_VALUES, 1.0f, 0.0f);
+    seq_kernel_quantise_f32_i16(in_f32, q16, N_VALUES, 1.0f, 0.0f);
+    seq_kernel_quantise_f32_i32(in_f32, q32, N_VALUES, 4.0f, 7.0f);
+
+    double mean_f, m2_f, mean_i, m2_i;
+    float lo, hi;
+    seq_kernel_moments_f32(in_f32 + 10, N_VALUES - 10, &mean_f, &m2_f);   // Finite values only
+    seq_kernel_moments_i16(in_i16, N_VALUES, &mean_i, &m2_i);
+    seq_kernel_minmax_f32(in_f32 + 10, N_VALUES - 10, &lo, &hi);
+    seq_kernel_i16_summary sum[2];
+    seq_kernel_summary_i16(in_i16, N_VALUES, -20000, 20000, &sum[0]);
+    seq_kernel_summary_i16(long_i16, N_LONG, INT16_MIN, 0, &sum[1]);
+
+    if (is_ref) {
+      ref_mean_f = mean_f; ref_m2_f = m2_f; ref_mean_i = mean_i; ref_m2_i = m2_i;
+      ref_min = lo; ref_max = hi;
+      memcpy(ref_sum, sum, sizeof(sum));
+      continue;
+    }
+
+    bool same = memcmp(ref_f, got_f, sizeof(ref_f)) == 0 && memcmp(ref_q8, got_q8, sizeof(ref_q8)) == 0 &&
+                memcmp(ref_q16, got_q16, sizeof(ref_q16)) == 0 && memcmp(ref_q32, got_q32, sizeof(ref_q32)) == 0 &&
+                mean_i == ref_mean_i && m2_i == ref_m2_i && lo == ref_min && hi == ref_max &&
+                memcmp(sum, ref_sum, sizeof(sum)) == 0 &&
+                fabs(mean_f - ref_mean_f) <= 1e-9 * fabs(ref_mean_f) && fabs(m2_f - ref_m2_f) <= 1e-9 * ref_m2_f;
+    if (!same) {
+      printf("✗ %s kernels differ from scalar\n", seq_kernel_backend_name((seq_kernel_backend)b));
+      tests_failed++;
+    } else {
+      printf("✓ %s kernels match scalar\n", seq_kernel_backend_name((seq_kernel_backend)b));
+      tests_passed++;
+    }
+  }
+  seq_kernel_set_backend(original);
+
+  // Rounding is half-to-even and out-of-range values saturate
+  if (ref_q16[0] != 0 || ref_q16[1] != 2 || ref_q16[2] != 2 || ref_q16[3] != 0 || ref_q16[4] != -2 ||
+      ref_q16[5] != 32767 || ref_q16[6] != -32768 || ref_q16[7] != -32768 || ref_q8[5] != 127 || ref_q8[6] != -128) {
+    printf("✗ Quantisation rounding/saturation wrong\n");
+    tests_failed++;
+  } else {
+    printf("✓ Quantisation rounds half to even and saturates\n");
+    tests_passed++;
+  }
+
+  // The scalar summary agrees with a direct count (rails are inclusive)
+  int64_t direct_sum = 0;
+  uint64_t direct_below = 0, direct_above = 0;
+  int16_t direct_min = INT16_MAX, direct_max = INT16_MIN;
+  for (size_t i = 0; i < N_VALUES; i++) {
+    direct_sum += in_i16[i];
+    direct_below += in_i16[i] <= -20000;
+    direct_above += in_i16[i] >= 20000;
+    if (in_i16[i] < direct_min) direct_min = in_i16[i];
+    if (in_i16[i] > direct_max) direct_max = in_i16[i];
+  }
+  uint64_t direct_long_above = 0;
+  for (size_t i = 0; i < N_LONG; i++) direct_long_above += long_i16[i] >= 0;
+  if (ref_sum[0].sum != direct_sum || ref_sum[0].below != direct_below || ref_sum[0].above != direct_above ||
+      ref_sum[0].min != direct_min || ref_sum[0].max != direct_max ||
+      ref_sum[1].above != direct_long_above) {
+    printf("✗ Signal summary disagrees with a direct count\n");
+    tests_failed++;
+  } else {
+    printf("✓ Signal summary matches a direct count (%llu low, %llu high)\n",
+           (unsigned long long)direct_below, (unsigned long long)direct_above);
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 2: Padded layout
+  printf("Test 2: Padded rows...\n");
+  seq_tensor *padded = seq_tensor_create_padded(SEQ_TENSOR_INT16, 2, (size_t[]){3, 37}, 64, 0.5f, -10);
+  if (!padded || padded->stride[0] != 64 || padded->ext_dtype != SEQ_TENSOR_EXT_PADDED ||
+      !(padded->flags & SEQ_TENSOR_ALIGNED_64) || seq_tensor_is_dense(padded)) {
+    printf("✗ Wrong padded layout\n");
+    tests_failed++;
+  } else {
+    int16_t *rows = seq_tensor_data_int16(padded);
+    bool aligned = true;
+    for (size_t r = 0; r < 3; r++) {
+      aligned &= ((uintptr_t)(rows + r * padded->stride[0]) % 64) == 0;
+      memcpy(rows + r * padded->stride[0], in_i16 + r * 37, 37 * sizeof(int16_t));
+    }
+
+    // Dequantize keeps the padded layout; quantize back recovers the raw samples
+    seq_tensor *real = seq_tensor_dequantize(padded);
+    seq_tensor *back = real ? seq_tensor_quantize(real, SEQ_TENSOR_INT16, 0.5f, -10) : NULL;
+    seq_tensor *copy = seq_tensor_copy(padded);
+    bool round_trip = aligned && real && back && copy && real->stride[0] == 64;
+    for (size_t r = 0; round_trip && r < 3; r++) {
+      const float *real_row = seq_tensor_data_float(real) + r * 64;
+      for (size_t c = 0; c < 37; c++) {
+        int16_t q = in_i16[r * 37 + c];
+        round_trip &= real_row[c] == (float)q * 0.5f + 5.0f;
+        round_trip &= seq_tensor_data_int16(back)[r * 64 + c] == q;
+        round_trip &= seq_tensor_data_int16(copy)[r * 64 + c] == q;
+      }
+    }
+
+    double mean, variance, ref_mean = 0.0, ref_var = 0.0;
+    for (size_t i = 0; i < 111; i++) ref_mean += 0.5 * (in_i16[i] + 10);
+    ref_mean /= 111;
+    for (size_t i = 0; i < 111; i++) ref_var += pow(0.5 * (in_i16[i] + 10) - ref_mean, 2);
+    ref_var /= 111;
+    bool moments_ok = seq_tensor_moments(padded, &mean, &variance) == 0 &&
+                      fabs(mean - ref_mean) < 1e-9 * fabs(ref_mean) + 1e-9 && fabs(variance - ref_var) < 1e-9 * ref_var;
+
+    if (!round_trip || !moments_ok) {
+      printf("✗ Padded conversion or moments wrong (round trip %d, moments %d)\n", round_trip, moments_ok);
+      tests_failed++;
+    } else {
+      printf("✓ Rows 64-byte aligned, conversions keep layout, moments match\n");
+      tests_passed++;
+    }
+    seq_tensor_free(copy);
+    seq_tensor_free(back);
+    seq_tensor_free(real);
+  }
+  seq_tensor_free(padded);
+
+  // A non-integral Fast5 offset (pA = scale * (raw + 4.3)) is not rounded away
+  seq_tensor *calibrated = seq_tensor_create_int16(2, (size_t[]){N_VALUES, 1}, 0.185f, -4);
+  seq_tensor *calibrated_copy = NULL, *calibrated_pa = NULL, *requantized = NULL;
+  if (calibrated) {
+    calibrated->zero_point_frac = -0.3f;
+    memcpy(seq_tensor_data_int16(calibrated), in_i16, sizeof(in_i16));
+    calibrated_copy = seq_tensor_copy(calibrated);
+    calibrated_pa = calibrated_copy ? seq_tensor_dequantize(calibrated_copy) : NULL;
+    requantized = seq_tensor_quantize(calibrated, SEQ_TENSOR_INT16, calibrated->scale, calibrated->zero_point);
+  }
+  // Re-quantizing with the same scale and zero point gives back the same samples and fraction
+  bool requantized_ok = requantized && requantized->zero_point_frac == calibrated->zero_point_frac &&
+                        memcmp(seq_tensor_data_int16(requantized), in_i16, sizeof(in_i16)) == 0;
+  double calibrated_mean = 0.0, expected_mean = 0.0;
+  bool calibrated_ok = calibrated_pa && seq_tensor_moments(calibrated, &calibrated_mean, NULL) == 0;
+  for (size_t i = 0; calibrated_ok && i < N_VALUES; i++) {
+    double pa = 0.185 * (in_i16[i] + 4.3);
+    calibrated_ok &= fabs(seq_tensor_data_float(calibrated_pa)[i] - pa) <= 1e-6 * fabs(pa) + 1e-3;
+    expected_mean += pa / N_VALUES;
+  }
+  if (!calibrated_ok || !requantized_ok || fabs(calibrated_mean - expected_mean) > 1e-6 * fabs(expected_mean) + 1e-6) {
+    printf("✗ Fractional zero point lost in copy, dequantize, quantize or moments\n");
+    tests_failed++;
+  } else {
+    printf("✓ Fractional zero point kept by copy, dequantize, quantize and moments\n");
+    tests_passed++;
+  }
+  seq_tensor_free(requantized);
+  seq_tensor_free(calibrated_pa);
+  seq_tensor_free(calibrated_copy);
+  seq_tensor_free(calibrated);
+  printf("\n");
+
+  // Test 3: Ragged batches
+  printf("Test 3: Ragged batches...\n");
+  seq_ragged *ragged = seq_ragged_create(3);
+  float rows[3 * 5000];
+  for (size_t i = 0; i < 3 * 5000; i++) rows[i] = (float)i;
+  bool ragged_ok = ragged != NULL;
+  for (size_t i = 0; ragged_ok && i < 40; i++) {
+    ragged_ok = seq_ragged_append(ragged, rows, 1 + (i * 131) % 4999);   // Grows both buffers
+  }
+  for (size_t i = 0; ragged_ok && i < 40; i++) {
+    size_t length = 1 + (i * 131) % 4999;
+    seq_tensor *view = seq_ragged_view(ragged, i);
+    ragged_ok = view && view->shape[0] == length && view->shape[1] == 3 &&
+                seq_ragged_length(ragged, i) == length &&
+                memcmp(seq_tensor_data_float(view), rows, length * 3 * sizeof(float)) == 0;
+    seq_tensor_free(view);
+  }
+  seq_tensor *wrong_width = seq_tensor_create_float(2, (size_t[]){4, 2});
+  ragged_ok &= !seq_ragged_append_tensor(ragged, wrong_width);
+  seq_tensor_free(wrong_width);
+  if (ragged_ok) {
+    seq_ragged_clear(ragged);
+    ragged_ok = ragged->count == 0 && seq_ragged_append(ragged, rows + 3, 2) &&
+                seq_ragged_item(ragged, 0)[0] == 3.0f && ragged->offsets[1] == 2;
+  }
+  if (!ragged_ok) {
+    printf("✗ Ragged items do not round-trip\n");
+    tests_failed++;
+  } else {
+    printf("✓ 40 items of varying length append, view and clear\n");
+    tests_passed++;
+  }
+  seq_ragged_free(ragged);
+  printf("\n");
+
+  // Test 4: Chunker windows and batches
+  printf("Test 4: Signal chunker...\n");
+  seq_chunker_options chunk_options;
+  seq_chunker_options_init(&chunk_options);
+  chunk_options.chunk_length = 100;
+  chunk_options.overlap = 20;
+  chunk_options.batch_size = 4;
+  seq_chunker *chunker = seq_chunker_create(&chunk_options);
+  float ramp[1000];
+  for (size_t i = 0; i < 1000; i++) ramp[i] = (float)i;
+
+  // 340 samples: windows at 0, 80, 160, 240 (end-aligned); 100: one window; 99: too short
+  bool chunk_ok = chunker && seq_chunker_add_read(chunker, 0, ramp, 340) &&
+                  seq_chunker_add_read(chunker, 1, ramp, 99) &&
+                  seq_chunker_add_read(chunker, 2, ramp, 100);
+  const size_t expected_start[5] = {0, 80, 160, 240, 0};
+  const seq_chunk_batch *batch = chunk_ok ? seq_chunker_next(chunker) : NULL;
+  chunk_ok = batch && batch->count == 4;
+  for (size_t w = 0; chunk_ok && w < 4; w++) {
+    chunk_ok = batch->origins[w].read == 0 && batch->origins[w].start == expected_start[w] &&
+               seq_tensor_data_float(batch->signal)[w * 100] == (float)expected_start[w] &&
+               seq_tensor_data_float(batch->signal)[w * 100 + 99] == (float)(expected_start[w] + 99);
+  }
+  chunk_ok &= chunk_ok && seq_chunker_next(chunker) == NULL;   // One window waits for a full batch
+  batch = chunk_ok ? seq_chunker_finish(chunker) : NULL;
+  chunk_ok = batch && batch->count == 1 && batch->origins[0].read == 2 &&
+             seq_tensor_data_float(batch->signal)[100] == 0.0f && seq_chunker_finish(chunker) == NULL;
+  seq_chunker_stats chunk_stats = {0};
+  if (chunker) seq_chunker_get_stats(chunker, &chunk_stats);
+  chunk_ok &= chunk_stats.reads == 2 && chunk_stats.reads_too_short == 1 && chunk_stats.windows == 5 &&
+              chunk_stats.batches == 2;
+  seq_chunker_free(chunker);
+
+  // Normalised int16 reads: median 0 and MAD 1/1.4826 per read, whatever the calibration
+  chunk_options.normalise = true;
+  chunk_options.batch_size = 1;
+  chunker = seq_chunker_create(&chunk_options);
+  int16_t adc[101];
+  for (size_t i = 0; i < 101; i++) adc[i] = (int16_t)(3 * i + 200);
+  batch = chunker && seq_chunker_add_read_int16(chunker, 7, adc, 101, 0.25f, 40.0f) ? seq_chunker_next(chunker) : NULL;
+  if (batch) {
+    float *window = seq_tensor_data_float(batch->signal);   // Samples 0..99 of 101: median at 50
+    chunk_ok &= batch->origins[0].read == 7 && fabsf(window[50]) < 1e-5f &&
+                fabsf(window[51] - window[50] - 1.0f / (25.0f * 1.4826f)) < 1e-5f;
+  } else {
+    chunk_ok = false;
+  }
+  seq_chunker_free(chunker);
+  chunk_options.overlap = chunk_options.chunk_length;
+  chunk_ok &= seq_chunker_create(&chunk_options) == NULL;
+  if (!chunk_ok) {
+    printf("✗ Wrong windows, batches or normalisation\n");
+    tests_failed++;
+  } else {
+    printf("✓ Overlapping and end-aligned windows, complete batches first, median/MAD normalisation\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Summary
+  printf("======================\n");
+  printf("Tests passed: %d\n", tests_passed);
+  printf("Tests failed: %d\n", tests_failed);
+  printf("======================\n");
+
+  if (tests_failed == 0) {
+    printf("\n✓ All tests passed!\n");
+    return 0;
+  } else {
+    printf("\n✗ Some tests failed!\n");
+    return 1;
+  }
+}
@@ -8,9 +8,60 @@
 #include "../src/core/seqgen_utils.h"
 #include "../src/core/seqgen_models.h"
 #include "../src/core/seq_tensor.h"
+#include "../src/core/seq_shard.h"
+#include "../src/sequelizer_seqgen.h"
+#include <fcntl.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Run `sequelizer seqgen args...` in a child process (main_seqgen keeps global state
+// and may exit), its stdout going to stdout_path and its stderr discarded
+static bool run_seqgen(const char *const *args, const char *stdout_path) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    int out = open(stdout_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int null = open("/dev/null", O_WRONLY);
+    if (out < 0 || null < 0 || dup2(out, STDOUT_FILENO) < 0 || dup2(null, STDERR_FILENO) < 0) _exit(127);
+    char *argv[64];
+    int argc = 0;
+    argv[argc++] = "seqgen";
+    while (args[argc - 1] && argc < 63) {
+      argv[argc] = (char*)args[argc - 1];
+      argc++;
+    }
+    argv[argc] = NULL;
+    int status = main_seqgen(argc, argv);
+    fflush(stdout);
+    _exit(status);
+  }
+  int status;
+  return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static long file_size(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+// Byte-for-byte file comparison
+static bool same_file(const char *a, const char *b) {
+  FILE *fa = fopen(a, "rb"), *fb = fopen(b, "rb");
+  bool same = fa && fb;
+  for (int ca = 0; same && ca != EOF;) {
+    ca = fgetc(fa);
+    same = ca == fgetc(fb);
+  }
+  if (fa) fclose(fa);
+  if (fb) fclose(fb);
+  return same;
+}
 
 int main(void) {
   int tests_passed = 0;
@@ -60,7 +111,9 @@ int main(void) {
   // Test 2: Squiggle to raw signal
   if (squiggle) {
     printf("Test 2: Squiggle to raw signal...\n");
-    seq_tensor *raw = squiggle_to_raw(squiggle, 4.0f);
+    seq_rng rng;
+    seq_rng_init(&rng, 42, 0);
+    seq_tensor *raw = squiggle_to_raw(squiggle, 4.0f, &rng);
     if (!raw) {
       printf("✗ Failed to generate raw signal\n");
       tests_failed++;
@@ -69,7 +122,19 @@ int main(void) {
       float *raw_data = seq_tensor_data_float(raw);
       printf("✓ First 5 samples: %.4f, %.4f, %.4f, %.4f, %.4f\n",
        raw_data[0], raw_data[1], raw_data[2], raw_data[3], raw_data[4]);
-      tests_passed++;
+
+      // Same (seed, stream) must reproduce the signal exactly
+      seq_rng_init(&rng, 42, 0);
+      seq_tensor *again = squiggle_to_raw(squiggle, 4.0f, &rng);
+      if (again && again->shape[0] == raw->shape[0] &&
+          memcmp(seq_tensor_data_float(again), raw_data, raw->shape[0] * sizeof(float)) == 0) {
+        printf("✓ Raw signal reproducible for the same seed and stream\n");
+        tests_passed++;
+      } else {
+        printf("✗ Raw signal differs for the same seed and stream\n");
+        tests_failed++;
+      }
+      seq_tensor_free(again);
       seq_tensor_free(raw);
     }
     printf("\n");
@@ -142,6 +207,165 @@ int main(void) {
   }
   printf("\n");
 
+  // Test 5: Pooled signal buffers and views
+  printf("Test 5: Pooled signal buffers and views...\n");
+  seq_tensor_pool *pool = seq_tensor_pool_create(2);
+  size_t pooled_len = predict_signal_length(seq_len, &params, 4.0f);
+  seq_tensor *pooled = seq_tensor_pool_acquire_float(pool, 2, (size_t[]){pooled_len, 1});
+  seq_rng pool_rng, ref_rng;
+  seq_rng_init(&pool_rng, 7, 0);
+  seq_rng_init(&ref_rng, 7, 0);
+  seq_tensor *reference = sequence_to_raw(seq, seq_len, false, &params, 4.0f, &ref_rng);
+  if (!pooled || !reference ||
+      sequence_to_signal_into(seq, seq_len, false, &params, 4.0f, &pool_rng,
+                              seq_tensor_data_float(pooled), pooled_len, NULL) < 0 ||
+      memcmp(pooled->data, reference->data, pooled_len * sizeof(float)) != 0) {
+    printf("✗ Pooled signal differs from sequence_to_raw\n");
+    tests_failed++;
+    seq_tensor_free(pooled);
+  } else {
+    // A view shares rows without copying; freeing the pooled tensor recycles its buffer
+    seq_tensor *view = seq_tensor_view_rows(pooled, 10, 5);
+    bool view_ok = view && !(view->flags & SEQ_TENSOR_OWNS_DATA) && view->shape[0] == 5 &&
+                   seq_tensor_data_float(view) == seq_tensor_data_float(pooled) + 10;
+    seq_tensor_free(view);
+
+    void *buffer = pooled->data;
+    seq_tensor_free(pooled);
+    seq_tensor *again = seq_tensor_pool_acquire_float(pool, 2, (size_t[]){pooled_len / 2, 1});
+    if (!view_ok || !again || again->data != buffer) {
+      printf("✗ View or buffer reuse failed\n");
+      tests_failed++;
+    } else {
+      printf("✓ Pooled signal matches, view shares data, buffer reused\n");
+      tests_passed++;
+    }
+    seq_tensor_free(again);
+  }
+  seq_tensor_free(reference);
+  seq_tensor_pool_free(pool);
+  printf("\n");
+
+  // Test 6: Training shards round trip (signal, bases and squiggle alignment)
+  printf("Test 6: Training shards...\n");
+  seq_tensor *shard_squiggle = sequence_to_squiggle(seq, seq_len, false, &params);
+  seq_rng shard_rng;
+  seq_rng_init(&shard_rng, 11, 0);
+  seq_tensor *shard_signal = shard_squiggle ? squiggle_to_raw(shard_squiggle, 4.0f, &shard_rng) : NULL;
+  seq_packed *shard_bases = seq_pack(seq, seq_len);
+  seq_packed reversed = shard_bases ? seq_packed_view(shard_bases, 0, seq_len, true) : (seq_packed){0};
+  bool shard_ok = shard_signal != NULL && shard_bases != NULL;
+  size_t num_events = shard_ok ? seq_tensor_dim(shard_squiggle, 0) : 0;
+  uint32_t event_samples[16];
+  size_t num_samples = shard_ok ? seq_tensor_dim(shard_signal, 0) : 0;
+  shard_ok = shard_ok && num_events <= 16 &&
+             squiggle_event_samples(shard_squiggle, 4.0f, event_samples) == num_samples;
+
+  // A 1-byte limit puts every read in a shard of its own
+  seq_shard_writer_t *shard_writer = shard_ok ? seq_shard_writer_open("test_shards", 4.0f, 5, 1) : NULL;
+  seq_shard_stats_t shard_stats = {0};
+  shard_ok = shard_writer != NULL &&
+             seq_shard_writer_append(shard_writer, "forward", seq_tensor_data_float(shard_signal), num_samples,
+                                     shard_bases, event_samples, num_events) == 0 &&
+             seq_shard_writer_append(shard_writer, "reverse", seq_tensor_data_float(shard_signal), num_samples,
+                                     &reversed, event_samples, num_events) == 0 &&
+             seq_shard_writer_close(shard_writer, &shard_stats) == 0 && shard_stats.shards == 2;
+
+  seq_shard_t *shard = shard_ok ? seq_shard_map("test_shards/shard_00001.sqs") : NULL;
+  if (shard) {
+    const seq_shard_header_t *header = seq_shard_header(shard);
+    seq_shard_read_view_t read;
+    seq_shard_read(shard, 0, &read);
+    char *bases = seq_unpack(&read.bases);
+    char *expected = seq_unpack(&reversed);
+    float max_error = 0.0f;
+    const float *signal = seq_tensor_data_float(shard_signal);
+    for (size_t i = 0; i < read.num_samples; i++) {
+      max_error = fmaxf(max_error, fabsf(read.scale * read.signal[i] + read.offset - signal[i]));
+    }
+    shard_ok = header->num_reads == 1 && strcmp(read.name, "reverse") == 0 && read.num_samples == num_samples &&
+               bases && expected && strcmp(bases, expected) == 0 && read.num_events == num_events &&
+               read.events[num_events - 1].start + read.events[num_events - 1].samples == num_samples &&
+               max_error <= read.scale && header->sections[SEQ_SHARD_SIGNAL].offset % SEQ_SHARD_PAGE == 0;
+    free(bases);
+    free(expected);
+    seq_shard_unmap(shard);
+  }
+  if (!shard) shard_ok = false;
+  remove("test_shards/shard_00000.sqs");
+  remove("test_shards/shard_00001.sqs");
+  remove("test_shards");
+  if (!shard_ok) {
+    printf("✗ Shard did not round-trip\n");
+    tests_failed++;
+  } else {
+    printf("✓ Two reads in two page-aligned shards, signal within one quantisation step\n");
+    tests_passed++;
+  }
+  seq_packed_free(shard_bases);
+  seq_tensor_free(shard_signal);
+  seq_tensor_free(shard_squiggle);
+  printf("\n");
+
+  // Test 7: --format bin on stdout is float32 samples and nothing else
+  printf("Test 7: Binary output on stdout...\n");
+  const char *text_args[] = {"--raw", "--generate", "--num-sequences", "2", "--seq-length", "20",
+                             "-d", "kmer_models", "--seed", "1", NULL};
+  const char *bin_args[] = {"--raw", "--format", "bin", "--generate", "--num-sequences", "2", "--seq-length", "20",
+                            "-d", "kmer_models", "--seed", "1", NULL};
+  long total_samples = 0;
+  bool cli_ok = run_seqgen(text_args, "test_seqgen_text.txt") && run_seqgen(bin_args, "test_seqgen_bin.bin");
+  FILE *text_out = cli_ok ? fopen("test_seqgen_text.txt", "r") : NULL;
+  if (text_out) {
+    char line[256];
+    while (fgets(line, sizeof(line), text_out)) {
+      if (line[0] >= '0' && line[0] <= '9' && strchr(line, '\t')) total_samples++;   // sample_index<TAB>raw_value
+    }
+    fclose(text_out);
+  }
+  long bin_bytes = file_size("test_seqgen_bin.bin");
+  if (!cli_ok || total_samples == 0 || bin_bytes != 4 * total_samples) {
+    printf("✗ Binary stdout is %ld bytes for %ld samples\n", bin_bytes, total_samples);
+    tests_failed++;
+  } else {
+    printf("✓ Binary stdout is exactly 4 bytes per sample (%ld samples)\n", total_samples);
+    tests_passed++;
+  }
+  remove("test_seqgen_text.txt");
+  remove("test_seqgen_bin.bin");
+  printf("\n");
+
+  // Test 8: Output does not depend on --threads (reads are seeded by index and written in order)
+  printf("Test 8: Thread count independence...\n");
+  const char *thread_counts[] = {"1", "3", "8"};
+  bool threads_ok = true;
+  for (int stochastic = 0; stochastic < 2; stochastic++) {
+    for (int i = 0; i < 3; i++) {
+      const char *args[] = {"--raw", "--format", "bin", "--generate", "--num-sequences", "24", "--seq-length", "300",
+                            "-d", "kmer_models", "--seed", "7", "--threads", thread_counts[i],
+                            stochastic ? "--stochastic" : NULL, NULL};
+      char path[64];
+      snprintf(path, sizeof(path), "test_seqgen_threads_%s.bin", thread_counts[i]);
+      threads_ok &= run_seqgen(args, path) && file_size(path) > 0;
+      threads_ok &= i == 0 || same_file("test_seqgen_threads_1.bin", path);
+    }
+    if (!threads_ok) {
+      printf("✗ %s output differs between thread counts\n", stochastic ? "Stochastic" : "Fixed-dwell");
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "test_seqgen_threads_%s.bin", thread_counts[i]);
+    remove(path);
+  }
+  if (!threads_ok) {
+    tests_failed++;
+  } else {
+    printf("✓ 1, 3 and 8 threads give identical bytes, with and without --stochastic\n");
+    tests_passed++;
+  }
+  printf("\n");
+
   // Summary
   printf("======================\n");
   printf("Tests passed: %d\n", tests_passed);
@@ -6,6 +6,8 @@
 #include "../src/core/seqgen_models.h"
 #include "../src/core/seq_tensor.h"
 #include "../src/core/seq_utils.h"
+#include "../src/core/seq_nn.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -127,6 +129,197 @@ int main(void) {
   free(encoded_long);
   printf("\n");
 
+  // Test 4b: Explicit model context matches the implicitly loaded model
+  printf("Test 4b: Shared model context with precomputed decimated tables...\n");
+  seqgen_kmer_context *context = seqgen_kmer_context_create("kmer_models", "dna_r10.4.1_e8.2_260bps");
+  if (!context) {
+    printf("✗ Failed to create model context\n");
+    tests_failed++;
+  } else {
+    int *encoded_ctx = calloc(strlen(long_seq), sizeof(int));
+    for (size_t i = 0; i < strlen(long_seq); i++) {
+      encoded_ctx[i] = base_to_int(long_seq[i], true);
+    }
+    struct seqgen_model_params params_ctx = params_dec;
+    params_ctx.params.kmer.context = context;
+
+    seq_tensor *with_ctx = squiggle_kmer(encoded_ctx, strlen(long_seq), false, &params_ctx);
+    seq_tensor *without_ctx = squiggle_kmer(encoded_ctx, strlen(long_seq), false, &params_dec);
+    if (with_ctx && without_ctx && with_ctx->size == without_ctx->size &&
+        memcmp(with_ctx->data, without_ctx->data, with_ctx->size * sizeof(float)) == 0) {
+      printf("✓ Context (9-mer model, tables for k=1..%d) gives identical squiggle\n", context->max_kmer_size);
+      tests_passed++;
+    } else {
+      printf("✗ Context squiggle differs from implicit model squiggle\n");
+      tests_failed++;
+    }
+    seq_tensor_free(with_ctx);
+    seq_tensor_free(without_ctx);
+    free(encoded_ctx);
+    seqgen_kmer_context_free(context);
+  }
+  printf("\n");
+
+  // Test 4c: Specialised (k = 5, 6, 9) and generic kernels match the context's tables
+  printf("Test 4c: K-mer kernels for every k against the lookup tables...\n");
+  seqgen_kmer_context *tables = seqgen_kmer_context_create("kmer_models", "dna_r10.4.1_e8.2_260bps");
+  if (!tables) {
+    printf("✗ Failed to create model context\n");
+    tests_failed++;
+  } else {
+    const char *kernel_seq = "GATTACACGTTGCAACGGTACCATGCATGACTTAGGCAT";
+    size_t kernel_len = strlen(kernel_seq);
+    int *encoded_kernel = calloc(kernel_len, sizeof(int));
+    for (size_t i = 0; i < kernel_len; i++) {
+      encoded_kernel[i] = base_to_int(kernel_seq[i], true);
+    }
+    seq_packed *packed_kernel = seq_pack(kernel_seq, kernel_len);
+
+    int mismatched_k = 0;
+    for (int k = 1; k <= tables->max_kmer_size; k++) {
+      struct seqgen_model_params params_k = params_dec;
+      params_k.params.kmer.kmer_size = k;
+      params_k.params.kmer.context = tables;
+      seq_tensor *from_ints = squiggle_kmer(encoded_kernel, kernel_len, false, &params_k);
+      seq_tensor *from_packed = squiggle_kmer_packed(packed_kernel, false, &params_k);
+
+      bool match = from_ints && from_packed && from_ints->shape[0] == kernel_len - k + 1 &&
+                   from_ints->size == from_packed->size &&
+                   memcmp(from_ints->data, from_packed->data, from_ints->size * sizeof(float)) == 0;
+      for (size_t i = 0; match && i + k <= kernel_len; i++) {
+        uint32_t index = 0;
+        for (int j = 0; j < k; j++) index = (index << 2) | (uint32_t)encoded_kernel[i + j];
+        const float *row = seq_tensor_data_float(from_ints) + i * 3;
+        float stddev = tables->stddev[k] ? tables->stddev[k][index] : tables->default_stddev;
+        match = row[0] == tables->mean[k][index] && row[1] == stddev;
+      }
+      if (!match) {
+        printf("✗ k=%d rows differ from the k-mer tables\n", k);
+        mismatched_k++;
+      }
+      seq_tensor_free(from_ints);
+      seq_tensor_free(from_packed);
+    }
+    if (mismatched_k == 0) {
+      printf("✓ int and packed kernels match the tables for k=1..%d\n", tables->max_kmer_size);
+      tests_passed++;
+    } else {
+      tests_failed++;
+    }
+
+    int bad_seq[6] = {0, 1, 2, 4, 3, 0};
+    struct seqgen_model_params params_bad = params_dec;
+    params_bad.params.kmer.context = tables;
+    seq_tensor *rejected = squiggle_kmer(bad_seq, 6, false, &params_bad);
+    if (!rejected) {
+      printf("✓ Invalid base rejected before the kernel runs\n");
+      tests_passed++;
+    } else {
+      printf("✗ Invalid base was accepted\n");
+      seq_tensor_free(rejected);
+      tests_failed++;
+    }
+
+    seq_packed_free(packed_kernel);
+    free(encoded_kernel);
+    seqgen_kmer_context_free(tables);
+  }
+  printf("\n");
+
+  // Test 4d: Stochastic events (sampled dwell and noise level, exact totals)
+  printf("Test 4d: Stochastic k-mer events...\n");
+  {
+    const char *bases = "ACGTTGCAGGATCCATGACCGTAGGCTTAACGTACGGATCATTGCAGCATGCA";
+    seq_packed *packed_bases = seq_pack(bases, strlen(bases));
+    struct seqgen_model_params params_legacy = {
+      .model_type = SEQGEN_MODEL_KMER,
+      .params.kmer = {
+        .model_name = "legacy/legacy_r9.4_180mv_450bps_6mer",
+        .models_dir = "kmer_models",
+        .kmer_size = 6,
+        .sample_rate_khz = 4.0f
+      }
+    };
+
+    // Many reads' dwells: mean stays at the nominal 10 samples, spread follows dwell_cv
+    seqgen_event_plan plan = {0};
+    seq_rng rng;
+    seq_rng_init(&rng, 7, 1);
+    double sum = 0.0, sum_sq = 0.0;
+    size_t events = 0;
+    bool totals_exact = true;
+    for (int read = 0; read < 400; read++) {
+      if (kmer_plan_events(packed_bases, &params_legacy, 4.0f, 0.5f, &rng, &plan) != 0) {
+        totals_exact = false;
+        break;
+      }
+      size_t total = 0;
+      for (size_t e = 0; e < plan.num_events; e++) {
+        total += plan.samples[e];
+        sum += plan.samples[e];
+        sum_sq += (double)plan.samples[e] * plan.samples[e];
+        totals_exact = totals_exact && plan.samples[e] >= 1 && plan.stddev[e] > 0.0f;
+      }
+      totals_exact = totals_exact && total == plan.total_samples;
+      events += plan.num_events;
+    }
+    double mean = events ? sum / events : 0.0;
+    double cv = events ? sqrt(sum_sq / events - mean * mean) / mean : 0.0;
+    if (totals_exact && fabs(mean - 10.0) < 0.2 && fabs(cv - 0.5) < 0.05) {
+      printf("✓ %zu events: mean dwell %.2f samples, cv %.3f, totals exact\n", events, mean, cv);
+      tests_passed++;
+    } else {
+      printf("✗ Dwell mean %.2f cv %.3f (expected 10, 0.5), totals %s\n", mean, cv, totals_exact ? "exact" : "wrong");
+      tests_failed++;
+    }
+
+    // Same stream, same read; and a fixed dwell on a model without noise tables is the fused path
+    seq_rng a, b;
+    seq_rng_init(&a, 3, 9);
+    seq_rng_init(&b, 3, 9);
+    seqgen_event_plan again = {0};
+    bool repeatable = kmer_plan_events(packed_bases, &params_legacy, 4.0f, 0.5f, &a, &plan) == 0 &&
+                      kmer_plan_events(packed_bases, &params_legacy, 4.0f, 0.5f, &b, &again) == 0 &&
+                      plan.total_samples == again.total_samples &&
+                      memcmp(plan.samples, again.samples, plan.num_events * sizeof(uint32_t)) == 0 &&
+                      memcmp(plan.stddev, again.stddev, plan.num_events * sizeof(float)) == 0;
+
+    // At 4 kHz and at 5 kHz, where the fixed dwell (12.5) is fractional
+    bool fixed_matches = true;
+    const float rates[] = {4.0f, 5.0f};
+    for (int r = 0; r < 2 && fixed_matches; r++) {
+      struct seqgen_model_params params_modern = params_dec;
+      params_modern.params.kmer.sample_rate_khz = rates[r];
+      size_t fused_length = kmer_signal_length(packed_bases->length, &params_modern, rates[r]);
+      float *fused = calloc(fused_length, sizeof(float));
+      float *rendered = calloc(fused_length, sizeof(float));
+      seq_rng_init(&a, 5, 2);
+      seq_rng_init(&b, 5, 2);
+      fixed_matches = fused && rendered &&
+                      kmer_signal_packed(packed_bases, &params_modern, rates[r], &a, fused, fused_length, NULL) == 0 &&
+                      kmer_plan_events(packed_bases, &params_modern, rates[r], 0.0f, &b, &again) == 0 &&
+                      again.total_samples == fused_length;
+      if (fixed_matches) {
+        kmer_render_events(&again, &b, rendered);
+        fixed_matches = memcmp(fused, rendered, fused_length * sizeof(float)) == 0;
+      }
+      free(fused);
+      free(rendered);
+    }
+    if (repeatable && fixed_matches) {
+      printf("✓ Plans repeat per stream; dwell_cv 0 renders as kmer_signal_packed at 4 and 5 kHz\n");
+      tests_passed++;
+    } else {
+      printf("✗ Stochastic plans: repeatable %d, fixed dwell matches fused path %d\n", repeatable, fixed_matches);
+      tests_failed++;
+    }
+
+    seqgen_event_plan_free(&plan);
+    seqgen_event_plan_free(&again);
+    seq_packed_free(packed_bases);
+  }
+  printf("\n");
+
   // Test 5: Sample rate scaling
   printf("Test 5: Sample rate scaling...\n");
   const char *test_seq = "ACGTACGTACGTACGT";
@@ -168,6 +361,89 @@ int main(void) {
   free(encoded_test);
   printf("\n");
 
+  // Test 6: Neural squiggle runtime (conv1d + dense network written to a .sqnn file)
+  printf("Test 6: Neural squiggle network (batched, float and INT8)...\n");
+  const char *weights_file = "test_seqgen_models.sqnn";
+  seq_nn_model *network = seq_nn_model_create("test_network", 10.0f, 90.0f);
+  float conv_weights[5 * 4 * 8], conv_bias[8], dense_weights[8 * 3], dense_bias[3] = {0.0f, -1.0f, 2.3f};
+  for (size_t i = 0; i < sizeof(conv_weights) / sizeof(float); i++) conv_weights[i] = sinf((float)i) * 0.5f;
+  for (size_t i = 0; i < 8; i++) conv_bias[i] = cosf((float)i) * 0.1f;
+  for (size_t i = 0; i < sizeof(dense_weights) / sizeof(float); i++) dense_weights[i] = cosf(0.7f * i) * 0.3f;
+  bool built = network &&
+    seq_nn_model_add_layer(network, SEQ_NN_CONV1D, SEQ_NN_TANH, 4, 8, 5, conv_weights, conv_bias) &&
+    seq_nn_model_add_layer(network, SEQ_NN_DENSE, SEQ_NN_LINEAR, 8, 3, 1, dense_weights, dense_bias) &&
+    seq_nn_model_save(network, weights_file);
+  seq_nn_model_free(network);
+
+  struct seqgen_model_params params_nn = {
+    .model_type = SEQGEN_MODEL_R10,
+    .params.neural = { .weights_path = weights_file }
+  };
+  struct seqgen_model_params params_nn_int8 = params_nn;
+  params_nn_int8.params.neural.int8 = true;
+
+  const char *reads[3] = {"ACGTTGCAAGGCTTAC", "GATTACA", "CCGGTTAACCGGTTAAGGCATCGA"};
+  seq_packed *packed_reads[3];
+  for (int r = 0; r < 3; r++) packed_reads[r] = seq_pack(reads[r], strlen(reads[r]));
+  seq_tensor *batched[3] = {NULL, NULL, NULL}, *quantised[3] = {NULL, NULL, NULL};
+  bool batch_ok = built &&
+    squiggle_neural_batch((const seq_packed *const *)packed_reads, 3, true, &params_nn, batched) &&
+    squiggle_neural_batch((const seq_packed *const *)packed_reads, 3, true, &params_nn_int8, quantised);
+
+  if (!batch_ok) {
+    printf("✗ Failed to build or run the test network\n");
+    tests_failed++;
+  } else {
+    float batch_diff = 0.0f, int8_diff = 0.0f;
+    bool shapes_ok = true, units_ok = true;
+    for (int r = 0; r < 3; r++) {
+      // The same read alone through the dispatcher (int-per-base interface)
+      size_t n = strlen(reads[r]);
+      int *encoded_nn = calloc(n, sizeof(int));
+      for (size_t i = 0; i < n; i++) encoded_nn[i] = base_to_int(reads[r][i], true);
+      seq_tensor *single = get_seqgen_func(SEQGEN_MODEL_R10)(encoded_nn, n, true, &params_nn);
+      free(encoded_nn);
+
+      if (!single || seq_tensor_dim(batched[r], 0) != n || seq_tensor_dim(batched[r], 1) != 3 ||
+          seq_tensor_dim(single, 0) != n) {
+        shapes_ok = false;
+      } else {
+        float *a = seq_tensor_data_float(batched[r]), *b = seq_tensor_data_float(single);
+        float *q = seq_tensor_data_float(quantised[r]);
+        for (size_t i = 0; i < n * 3; i++) {
+          batch_diff = fmaxf(batch_diff, fabsf(a[i] - b[i]));
+          int8_diff = fmaxf(int8_diff, fabsf(a[i] - q[i]));
+        }
+        for (size_t i = 0; i < n; i++) {
+          if (a[i * 3 + 1] <= 0.0f || a[i * 3 + 2] <= 0.0f) units_ok = false;
+        }
+      }
+      seq_tensor_free(single);
+    }
+
+    if (!shapes_ok || !units_ok) {
+      printf("✗ Network squiggles have the wrong shape or non-positive stddev/dwell\n");
+      tests_failed++;
+    } else if (batch_diff > 1e-4f) {
+      printf("✗ Batched and single-read squiggles differ by %g\n", batch_diff);
+      tests_failed++;
+    } else if (int8_diff > 0.5f) {
+      printf("✗ INT8 squiggles differ from float by %g\n", int8_diff);
+      tests_failed++;
+    } else {
+      printf("✓ Network squiggles [n × 3]: batch matches single reads (max diff %g), INT8 within %.3f\n",
+             batch_diff, int8_diff);
+      tests_passed++;
+    }
+  }
+  for (int r = 0; r < 3; r++) {
+    seq_tensor_free(batched[r]);
+    seq_tensor_free(quantised[r]);
+    seq_packed_free(packed_reads[r]);
+  }
+  remove(weights_file);
+  printf("\n");
+
   // Summary
   printf("======================\n");
   printf("Tests passed: %d\n", tests_passed);
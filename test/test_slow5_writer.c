@@ -0,0 +1,215 @@
+// **********************************************************************
+// test_slow5_writer.c - Test BLOW5 records, svb-zd signals and the .idx index
+// **********************************************************************
+// Sebastian Claudiusz Magierowski Oct 15 2026
+// compile: build % cmake --build
+// run:     build % ./test_slow5_writer
+
+#include "../src/core/slow5_writer.h"
+#include "../src/core/seq_rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_BLOW5 "test_slow5_writer.blow5"
+#define TEST_INDEX TEST_BLOW5 ".idx"
+
+static uint64_t get_le(const uint8_t *p, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < bytes; i++) value |= (uint64_t)p[i] << (8 * i);
+  return value;
+}
+
+// Decode an svb-zd payload (count, control bytes, value bytes) independently of
+// the encoder; returns the bytes consumed, 0 if it does not fit in size
+static size_t decode_svb_zd(const uint8_t *p, size_t size, int16_t *out, size_t capacity, size_t *length) {
+  if (size < 4) return 0;
+  size_t count = (size_t)get_le(p, 4);
+  size_t control_bytes = (count + 3) / 4;
+  if (count > capacity || 4 + control_bytes > size) return 0;
+  const uint8_t *control = p + 4;
+  const uint8_t *data = control + control_bytes;
+  const uint8_t *end = p + size;
+  int32_t previous = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t bytes = ((control[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+    if (data + bytes > end) return 0;
+    uint32_t zigzag = (uint32_t)get_le(data, bytes);
+    data += bytes;
+    int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    previous += delta;
+    out[i] = (int16_t)previous;
+  }
+  *length = count;
+  return (size_t)(data - p);
+}
+
+static uint8_t* read_file(const char *path, size_t *size) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return NULL;
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *data = length > 0 ? malloc((size_t)length) : NULL;
+  if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  *size = data ? (size_t)length : 0;
+  return data;
+}
+
+// Uncompressed binary record: the svb-zd payload follows the fixed primary fields
+static const uint8_t* record_signal(const uint8_t *record, const char *read_id) {
+  return record + 8 + 2 + strlen(read_id) + 4 + 4 * 8 + 8;
+}
+
+int main(void) {
+  int tests_passed = 0;
+  int tests_failed = 0;
+
+  printf("Testing SLOW5/BLOW5 writer...\n\n");
+
+  // Test 1: svb-zd round trip, including negative deltas, full-range swings and
+  // lengths that are not a multiple of 4 (partial control bytes)
+  printf("Test 1: svb-zd encode / decode...\n");
+  static int16_t signal[1003], decoded[1003];
+  seq_rng rng;
+  seq_rng_init(&rng, 21, 0);
+  for (size_t i = 0; i < 1003; i++) {
+    if (i < 8) {
+      const int16_t edges[] = {0, -1, 1, INT16_MIN, INT16_MAX, INT16_MIN, -300, 70};
+      signal[i] = edges[i];
+    } else {
+      signal[i] = (int16_t)(500 + (int)seq_rng_below(&rng, 41) - 20 - (i % 97 == 0 ? 3000 : 0));
+    }
+  }
+  slow5_options_t svb = {SLOW5_FORMAT_BINARY, SLOW5_RECORD_NONE, SLOW5_SIGNAL_SVB_ZD};
+  const size_t lengths[] = {0, 1, 2, 3, 4, 5, 7, 8, 1003};
+  bool svb_ok = true;
+  for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]) && svb_ok; l++) {
+    slow5_record_t record = {.read_id = "svb", .digitisation = 8192, .range = 1400, .sampling_rate = 4000,
+                             .signal = signal, .signal_length = lengths[l]};
+    slow5_buffer_t buffer = {0};
+    size_t record_size = 0, length = SIZE_MAX;
+    svb_ok = slow5_encode_record(&svb, &record, &buffer, &record_size) == 0 && record_size == buffer.size &&
+             get_le(buffer.data, 8) == record_size - 8;
+    const uint8_t *payload = svb_ok ? record_signal(buffer.data, "svb") : NULL;
+    size_t used = svb_ok ? decode_svb_zd(payload, buffer.size - (size_t)(payload - buffer.data), decoded, 1003, &length) : 0;
+    // After the signal: empty channel string, NaN, INT32_MAX, UINT64_MAX
+    svb_ok = svb_ok && used > 0 && length == lengths[l] &&
+             memcmp(decoded, signal, lengths[l] * sizeof(int16_t)) == 0 &&
+             (size_t)(payload - buffer.data) + used + 8 + 8 + 4 + 8 == buffer.size;
+    if (!svb_ok) printf("  length %zu failed\n", lengths[l]);
+    slow5_buffer_free(&buffer);
+  }
+  if (!svb_ok) {
+    printf("✗ svb-zd did not round-trip\n");
+    tests_failed++;
+  } else {
+    printf("✓ Lengths 0-8 and 1003 decode exactly, negative and full-range deltas included\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Test 2: BLOW5 header, records, end marker and the .idx index
+  printf("Test 2: BLOW5 and index layout...\n");
+  slow5_header_t *header = slow5_header_create();
+  uint32_t group = header ? slow5_header_add_group(header) : 0;
+  bool layout_ok = header && slow5_header_set(header, group, "run_id", "run0") == 0;
+  slow5_writer_t *writer = layout_ok ? slow5_writer_open(TEST_BLOW5, &svb, header) : NULL;
+  const char *ids[] = {"read_a", "read_bb"};
+  slow5_buffer_t records = {0};
+  size_t sizes[2] = {0};
+  for (int r = 0; r < 2 && writer; r++) {
+    slow5_record_t record = {.read_id = ids[r], .digitisation = 8192, .offset = 10.5, .range = 1400,
+                             .sampling_rate = 4000, .signal = signal, .signal_length = r ? 1003 : 5,
+                             .channel_number = "7", .has_read_number = true, .read_number = r};
+    size_t start = records.size;
+    layout_ok = layout_ok && slow5_encode_record(&svb, &record, &records, &sizes[r]) == 0 &&
+                slow5_writer_write(writer, ids[r], records.data + start, sizes[r]) == 0;
+  }
+  layout_ok = layout_ok && writer && slow5_writer_records_written(writer) == 2 && slow5_writer_close(writer) == 0;
+  slow5_header_free(header);
+
+  size_t file_size = 0, index_size = 0;
+  uint8_t *file = layout_ok ? read_file(TEST_BLOW5, &file_size) : NULL;
+  uint8_t *index = layout_ok ? read_file(TEST_INDEX, &index_size) : NULL;
+  if (file && index && file_size > 68 && index_size > 64 + 7) {
+    // Fixed header: magic, version 0.2.0, record compression, group count, signal compression, zero padding.
+    // Compression bytes are slow5lib's press-method codes (none 0, zlib 1, svb-zd 2, zstd 3)
+    size_t text_size = (size_t)get_le(file + 64, 4);
+    bool padded = true;
+    for (size_t i = 15; i < 64; i++) padded &= file[i] == 0;
+    layout_ok = memcmp(file, "BLOW5\1", 6) == 0 && file[6] == 0 && file[7] == 2 && file[8] == 0 &&
+                file[9] == 0 && get_le(file + 10, 4) == 1 && file[14] == 2 &&
+                padded && 68 + text_size + sizes[0] + sizes[1] + 5 == file_size &&
+                memcmp(file + 68, "@run_id\trun0\n", 13) == 0 &&
+                memcmp(file + 68 + text_size, records.data, records.size) == 0 &&
+                memcmp(file + file_size - 5, "5WOLB", 5) == 0;
+
+    // Index: magic, version, padding to 64, then (id length, id, offset, size) per record, end marker
+    const uint8_t *p = index + 64;
+    uint64_t expected_offset = 68 + text_size;
+    layout_ok = layout_ok && memcmp(index, "SLOW5IDX\1", 9) == 0 && index[9] == 0 && index[10] == 2 && index[11] == 0;
+    for (int r = 0; r < 2 && layout_ok; r++) {
+      size_t id_length = (size_t)get_le(p, 2);
+      layout_ok = id_length == strlen(ids[r]) && memcmp(p + 2, ids[r], id_length) == 0 &&
+                  get_le(p + 2 + id_length, 8) == expected_offset && get_le(p + 10 + id_length, 8) == sizes[r] &&
+                  get_le(file + expected_offset, 8) == sizes[r] - 8;
+      expected_offset += sizes[r];
+      p += 2 + id_length + 16;
+    }
+    layout_ok = layout_ok && p + 7 == index + index_size && memcmp(p, "XDIWOLS", 7) == 0;
+  } else {
+    layout_ok = false;
+  }
+  free(file);
+  free(index);
+  slow5_buffer_free(&records);
+  remove(TEST_BLOW5);
+  remove(TEST_INDEX);
+
+  // Default zlib + svb-zd, and zstd when built in: the bytes slow5lib expects
+  slow5_record_compression_t zstd;
+  bool have_zstd = slow5_parse_record_compression("zstd", &zstd);
+  const slow5_options_t presses[] = {{SLOW5_FORMAT_BINARY, SLOW5_RECORD_ZLIB, SLOW5_SIGNAL_SVB_ZD},
+                                     {SLOW5_FORMAT_BINARY, SLOW5_RECORD_ZSTD, SLOW5_SIGNAL_NONE}};
+  const uint8_t press_bytes[][2] = {{1, 2}, {3, 0}};
+  for (int p = 0; p < (have_zstd ? 2 : 1) && layout_ok; p++) {
+    header = slow5_header_create();
+    layout_ok = header && slow5_header_add_group(header) == 0;
+    writer = layout_ok ? slow5_writer_open(TEST_BLOW5, &presses[p], header) : NULL;
+    layout_ok = layout_ok && writer && slow5_writer_close(writer) == 0;
+    slow5_header_free(header);
+    file = layout_ok ? read_file(TEST_BLOW5, &file_size) : NULL;
+    layout_ok = file && file_size > 14 && file[9] == press_bytes[p][0] && file[14] == press_bytes[p][1];
+    if (!layout_ok) printf("  press bytes wrong for option set %d\n", p);
+    free(file);
+    remove(TEST_BLOW5);
+    remove(TEST_INDEX);
+  }
+  if (!layout_ok) {
+    printf("✗ BLOW5 or index layout wrong\n");
+    tests_failed++;
+  } else {
+    printf("✓ Header, records and end marker in place; press bytes match slow5lib; index offsets point at each record\n");
+    tests_passed++;
+  }
+  printf("\n");
+
+  // Summary
+  printf("======================\n");
+  printf("Tests passed: %d\n", tests_passed);
+  printf("Tests failed: %d\n", tests_failed);
+  printf("======================\n");
+
+  if (tests_failed == 0) {
+    printf("\n✓ All tests passed!\n");
+    return 0;
+  } else {
+    printf("\n✗ Some tests failed!\n");
+    return 1;
+  }
+}